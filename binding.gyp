@@ -27,7 +27,35 @@
         [
           "OS=='win'",
           {
-            "sources": ["src/binding_windows.cpp", "src/screenshot_windows.cpp"],
+            "sources": [
+              "src/binding_windows.cpp",
+              "src/screenshot_windows.cpp",
+              "src/core/deadline_scheduler.cpp",
+              "src/core/selection_capture.cpp",
+              "src/core/content_hash.cpp",
+              "src/core/clipboard_snapshot.cpp",
+              "src/core/clipboard_descriptor.cpp",
+              "src/core/mapped_file.cpp",
+              "src/core/clipboard_history.cpp",
+              "src/core/raster.cpp",
+              "src/core/parallel.cpp",
+              "src/core/mosaic.cpp",
+              "src/core/mosaic_tiles.cpp",
+              "src/core/brush_mask.cpp",
+              "src/core/layer_cache.cpp",
+              "src/core/hit_index.cpp",
+              "src/core/damage.cpp",
+              "src/core/downscale.cpp",
+              "src/core/capture_backend.cpp",
+              "src/core/warm_frame.cpp",
+              "src/core/export_pipeline.cpp",
+              "src/core/clipboard_image.cpp",
+              "src/core/image_encoder.cpp",
+              "src/core/dim_mask.cpp",
+              "src/core/magnifier.cpp",
+              "src/core/monitor_layout.cpp",
+              "src/core/scroll_stitch.cpp"
+            ],
             "libraries": [
               "user32.lib",
               "kernel32.lib",
@@ -40,7 +68,9 @@
               "gdiplus.lib",
               "dwmapi.lib",
               "gdi32.lib",
-              "imm32.lib"
+              "imm32.lib",
+              "d3d11.lib",
+              "dxgi.lib"
             ],
             "msvs_settings": {
               "VCCLCompilerTool": {
@@ -12,7 +12,10 @@ class ClipboardMonitor {
 
   /**
    * 启动剪贴板监控
-   * @param {Function} callback - 剪贴板变化时的回调函数（无参数）
+   * @param {Function} callback - 剪贴板变化时的回调函数
+   * - Windows: callback(info)，info 为变化描述符（剪贴板被占用时为 null）：
+   *   { sequence, formats, textBytes, imageWidth, imageHeight, fileCount, hash }
+   * - macOS: 无参数
    */
   start(callback) {
     if (this._isMonitoring) {
@@ -26,9 +29,9 @@ class ClipboardMonitor {
     this._callback = callback;
     this._isMonitoring = true;
 
-    addon.startMonitor(() => {
+    addon.startMonitor((info) => {
       if (this._callback) {
-        this._callback();
+        this._callback(info);
       }
     });
   }
@@ -121,6 +124,62 @@ class ClipboardMonitor {
     }
     return false;
   }
+
+  /**
+   * 开启原生剪贴板历史（仅 Windows）：监控线程在每次变化时直接把内容写入历史，无需经过 JS
+   * - 以规范化内容的哈希去重，重复复制只刷新时间和次数
+   * - 记录追加到内存映射日志文件，写满后淘汰最旧的记录；重启后从文件恢复
+   * @param {string} path - 日志文件路径
+   * @param {number} [capacityBytes=64MB] - 日志文件大小上限
+   * @returns {boolean} 是否成功打开
+   */
+  static openHistory(path, capacityBytes) {
+    if (typeof path !== 'string' || path.length === 0) {
+      throw new TypeError('path must be a non-empty string');
+    }
+    if (platform !== 'win32') {
+      throw new Error('Clipboard history is only supported on Windows');
+    }
+    return addon.openClipboardHistory(path, capacityBytes);
+  }
+
+  /**
+   * 关闭剪贴板历史（数据保留在日志文件中）
+   */
+  static closeHistory() {
+    if (platform === 'win32') {
+      addon.closeClipboardHistory();
+    }
+  }
+
+  /**
+   * 查询剪贴板历史，结果按最近使用排序（新 -> 旧）
+   * @param {Object} [options]
+   * @param {string} [options.prefix] - 文本前缀查询
+   * @param {number} [options.from] - 时间范围起点（毫秒时间戳）
+   * @param {number} [options.to] - 时间范围终点（毫秒时间戳）
+   * @param {number} [options.offset=0] - 分页偏移（未指定 prefix/from/to 时生效）
+   * @param {number} [options.limit=50] - 最多返回条数
+   * @returns {Array<Object>} { hash, type: 'text'|'files'|'image', timestamp, copyCount, text | files | width/height/dib }
+   */
+  static queryHistory(options = {}) {
+    if (platform !== 'win32') {
+      return [];
+    }
+    return addon.queryClipboardHistory(options);
+  }
+
+  /**
+   * 按哈希读取单条历史
+   * @param {string} hash - queryHistory 返回的 16 位十六进制哈希
+   * @returns {Object|null}
+   */
+  static getHistoryItem(hash) {
+    if (platform !== 'win32') {
+      return null;
+    }
+    return addon.getClipboardHistoryItem(hash);
+  }
 }
 
 class WindowMonitor {
@@ -487,15 +546,50 @@ class ScreenCapture {
     return addon.primeScreenshotFrame();
   }
 
+  /**
+   * 开启或关闭首帧保温：后台按间隔与 CPU 预算持续刷新预抓取帧，截图开始时直接使用
+   * @param {boolean} enabled - 是否开启
+   * @param {Object} [options]
+   * @param {number} [options.ttlMs=500] - 帧年龄超过此值不再使用（同样作用于 prime() 的帧）
+   * @param {number} [options.intervalMs=250] - 两次刷新的最短间隔
+   * @param {number} [options.cpuBudget=0.05] - 抓帧耗时占墙钟的比例上限，取值 (0, 1]
+   */
+  static setWarmMode(enabled, options = {}) {
+    if (platform === 'darwin') {
+      throw new Error('ScreenCapture is not yet supported on macOS');
+    }
+
+    addon.setScreenshotWarmMode(Boolean(enabled), options);
+  }
+
+  /**
+   * 获取首帧统计（刷新次数、截图开始时的命中 / 过期次数、帧年龄、按显示器数量分组的启动耗时、最近一次交互的重绘量等，时间单位毫秒）
+   * @returns {Object}
+   */
+  static frameStats() {
+    if (platform === 'darwin') {
+      throw new Error('ScreenCapture is not yet supported on macOS');
+    }
+
+    return addon.getScreenshotFrameStats();
+  }
+
   /**
    * 启动区域截图
-   * @param {Function} callback - 截图完成时的回调函数
-   * - 参数: { success: boolean, width?: number, height?: number }
+   * @param {Function} callback - 截图完成时的回调函数（确认后立即调用，不等待编码）
+   * - 参数: { success: boolean, x?, y?, x2?, y2?, width?: number, height?: number, previewReady?: boolean, encoded?: Promise }
    * - success: 是否成功截图
    * - width: 截图宽度（成功时）
    * - height: 截图高度（成功时）
+   * - previewReady: 成品图已生成，正在后台编码并写入剪贴板
+   * - encoded: previewReady 时存在，resolve 为 { success, format, mimeType, base64?, data?, clipboard, submittedMs, encodedMs, deliveredMs }
+   *   png / jpeg 为 base64（data URL），qoi / raw 为 data（Buffer；raw 为逐行紧凑排列的 BGRA）
+   * @param {Object} [options]
+   * @param {string} [options.format='png'] - 输出格式：'png' | 'jpeg' | 'qoi' | 'raw'
+   * @param {number|string} [options.quality=90] - JPEG 质量 1-100，或预设 'high' | 'balanced' | 'small'
+   * @param {string} [options.monitor='all'] - 截图范围：'all' 整个虚拟屏幕 | 'cursor' 只截鼠标所在显示器（启动更快）
    */
-  static start(callback) {
+  static start(callback, options = {}) {
     if (platform === 'darwin') {
       // macOS 暂不支持
       throw new Error('ScreenCapture is not yet supported on macOS');
@@ -505,9 +599,65 @@ class ScreenCapture {
       throw new TypeError('Callback must be a function');
     }
 
-    addon.startRegionCaptureWithPrimedFrame((result) => {
-      callback(result);
-    });
+    addon.startRegionCaptureWithPrimedFrame(ScreenCapture._wrapCallback(callback), options);
+  }
+
+  /**
+   * 启动滚动长截图：在选区中心自动向下滚动目标窗口，逐帧找出重叠并拼接成长图，
+   * 到底、达到 maxHeight 或调用 stopScrolling() 时输出，按 Esc 取消
+   * @param {Object} region - 选区（物理像素屏幕坐标），可直接传入区域截图回调的结果
+   * @param {number} region.x
+   * @param {number} region.y
+   * @param {number} region.width
+   * @param {number} region.height
+   * @param {Function} callback - 参数与 start() 的回调相同；width / height 为拼接后的尺寸
+   * @param {Object} [options]
+   * @param {number} [options.maxHeight=20000] - 长图高度上限（像素）
+   * @param {string} [options.format='png'] - 输出格式：'png' | 'jpeg' | 'qoi' | 'raw'
+   * @param {number|string} [options.quality=90] - JPEG 质量 1-100，或预设 'high' | 'balanced' | 'small'
+   */
+  static startScrolling(region, callback, options = {}) {
+    if (platform === 'darwin') {
+      throw new Error('ScreenCapture is not yet supported on macOS');
+    }
+
+    if (typeof callback !== 'function') {
+      throw new TypeError('Callback must be a function');
+    }
+
+    const { x, y, width, height } = region || {};
+    addon.startScrollingCapture(ScreenCapture._wrapCallback(callback), { ...options, x, y, width, height });
+  }
+
+  /**
+   * 结束进行中的滚动长截图，输出已拼接的部分
+   */
+  static stopScrolling() {
+    if (platform === 'darwin') {
+      throw new Error('ScreenCapture is not yet supported on macOS');
+    }
+
+    addon.stopScrollingCapture();
+  }
+
+  // 确认后先收到尺寸事件，后台编码完成后再收到同一 exportId 的 type === 'encoded' 事件
+  static _wrapCallback(callback) {
+    const pendingExports = new Map();
+    return (event) => {
+      if (event.type === 'encoded') {
+        const resolve = pendingExports.get(event.exportId);
+        if (resolve) {
+          pendingExports.delete(event.exportId);
+          const { type, exportId, ...payload } = event;
+          resolve(payload);
+        }
+        return;
+      }
+      if (event.success && event.previewReady) {
+        event.encoded = new Promise((resolve) => pendingExports.set(event.exportId, resolve));
+      }
+      callback(event);
+    };
   }
 }
 
@@ -641,6 +791,34 @@ function getSelectedContent() {
   return addon.getSelectedContent();
 }
 
+/**
+ * 异步获取当前选中的内容，不阻塞 JS 线程
+ *
+ * Windows 上在工作线程执行：注入 Ctrl+C 后等待剪贴板序列号变化（WM_CLIPBOARDUPDATE），
+ * 一有新内容就返回，不再固定等待 100ms + 50ms；目标应用没有写剪贴板时在 timeout 后返回空数组且不改动剪贴板。
+ * 其他平台退化为 Promise 包装的同步实现。
+ *
+ * @param {{timeout?: number, settle?: number}} [options]
+ * - timeout: 等待目标应用写入剪贴板的上限（毫秒，默认 500）
+ * - settle: 首次变化后等待多格式写入完成的静默期（毫秒，默认 8）
+ * @returns {Promise<Array<{type: string, data: any}>>} 与 getSelectedContent 相同的结构
+ */
+function getSelectedContentAsync(options = {}) {
+  if (options === null || typeof options !== 'object') {
+    return Promise.reject(new TypeError('options must be an object'));
+  }
+  if (platform === 'win32') {
+    return addon.getSelectedContentAsync(options);
+  }
+  return new Promise((resolve, reject) => {
+    try {
+      resolve(addon.getSelectedContent());
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 function launchCuiShell(shell, currentDirectory) {
   if (platform !== 'win32') {
     throw new Error('launchCuiShell is only supported on Windows');
@@ -661,6 +839,7 @@ module.exports = {
   MuiResolver,
   WindowsShortcutScanner,
   getSelectedContent,
+  getSelectedContentAsync,
   launchCuiShell
 };
 
@@ -0,0 +1,65 @@
+#!/usr/bin/env node
+// 编译并运行 src/core 可移植核心的原生单元测试 / 基准测试（不依赖 node-gyp，可在 Linux 上运行）
+//   node scripts/test-native.js            运行 test/native/test_*.cpp
+//   node scripts/test-native.js --bench    运行 test/native/bench_*.cpp
+//   node scripts/test-native.js scheduler  只运行文件名包含 scheduler 的用例
+const { execSync, spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const root = path.join(__dirname, '..');
+const coreDir = path.join(root, 'src', 'core');
+const testDir = path.join(root, 'test', 'native');
+const outDir = path.join(root, 'build', 'native');
+
+const args = process.argv.slice(2);
+const bench = args.includes('--bench');
+const filters = args.filter((a) => !a.startsWith('--'));
+const prefix = bench ? 'bench_' : 'test_';
+
+const cxx = process.env.CXX || 'c++';
+const cxxflags = process.env.CXXFLAGS || '-O2';
+
+const coreSources = fs.existsSync(coreDir)
+  ? fs.readdirSync(coreDir).filter((f) => f.endsWith('.cpp')).map((f) => path.join(coreDir, f))
+  : [];
+
+const targets = fs
+  .readdirSync(testDir)
+  .filter((f) => f.startsWith(prefix) && f.endsWith('.cpp'))
+  .filter((f) => filters.length === 0 || filters.some((k) => f.includes(k)))
+  .sort();
+
+if (targets.length === 0) {
+  console.log(`⚠️  No ${prefix}*.cpp matched`);
+  process.exit(0);
+}
+
+fs.mkdirSync(outDir, { recursive: true });
+
+let failed = 0;
+for (const file of targets) {
+  const name = path.basename(file, '.cpp');
+  const exe = path.join(outDir, name);
+  console.log(`\n🔨 ${name}`);
+  try {
+    const sources = [path.join(testDir, file), ...coreSources].map((s) => `"${s}"`).join(' ');
+    execSync(`${cxx} -std=c++17 ${cxxflags} -Wall -pthread -I"${path.join(root, 'src')}" ${sources} -o "${exe}"`, {
+      stdio: 'inherit',
+    });
+  } catch (error) {
+    console.error(`❌ ${name} failed to compile`);
+    failed++;
+    continue;
+  }
+  const run = spawnSync(exe, [], { stdio: 'inherit' });
+  if (run.status !== 0) {
+    failed++;
+  }
+}
+
+if (failed > 0) {
+  console.error(`\n❌ ${failed}/${targets.length} native ${bench ? 'benchmarks' : 'tests'} failed`);
+  process.exit(1);
+}
+console.log(`\n✅ ${targets.length} native ${bench ? 'benchmarks' : 'tests'} passed`);
@@ -13,6 +13,7 @@
 #include <vector>      // For input events
 #include <memory>      // For std::unique_ptr, std::addressof
 #include <cstddef>
+#include <cstdlib>
 #include <cctype>
 #include <cwchar>
 #include <cwctype>
@@ -37,6 +38,12 @@
 #pragma comment(lib, "uiautomationcore.lib")
 
 #include "screenshot_windows.h"
+#include "core/deadline_scheduler.h"
+#include "core/selection_capture.h"
+#include "core/clipboard_snapshot.h"
+#include "core/clipboard_descriptor.h"
+#include "core/clipboard_history.h"
+#include "core/magnifier.h"
 
 // DWMWA_CLOAKED 在较新的 Windows SDK 中定义，为了兼容性手动定义
 #ifndef DWMWA_CLOAKED
@@ -64,6 +71,12 @@ static std::thread g_messageThread;
 static std::atomic<bool> g_isMonitoring(false);
 static std::atomic<bool> g_isPaused(false);  // 新增：暂停状态
 static napi_threadsafe_function g_tsfn = nullptr;
+static std::atomic<DWORD> g_clipboardSelfWriteSeq(0);  // 本模块自己恢复剪贴板后的序列号，监控据此跳过
+
+// 剪贴板历史：由监控线程直接写入，JS 线程查询，两边通过互斥锁访问
+static ztools::ClipboardHistoryStore g_clipboardHistory;
+static std::mutex g_clipboardHistoryMutex;
+static std::atomic<bool> g_clipboardHistoryOpen(false);
 
 // 剪贴板防抖：Edge 等浏览器复制时会分多次写入不同格式，
 // 每次写入都触发 WM_CLIPBOARDUPDATE，使用定时器合并为一次回调
@@ -87,19 +100,26 @@ static std::thread g_mouseMessageThread;
 static std::string g_mouseButtonType;
 static int g_mouseLongPressMs = 0;
 static std::atomic<bool> g_mouseButtonPressed(false);
-static std::chrono::steady_clock::time_point g_mousePressStartTime;
+static ztools::LongPressDetector g_mouseLongPress;  // 仅在鼠标监控线程（钩子回调同线程）访问
+static HANDLE g_mouseLongPressTimer = NULL;         // 长按截止时间的可等待定时器
+static std::atomic<DWORD> g_mouseMonitorThreadId(0);
 static std::atomic<bool> g_mouseLongPressTriggered(false);
 static bool g_mouseNeedReplay = false;
 static std::atomic<bool> g_mouseReplayOnRelease(false);
 #define MOUSE_REPLAY_MAGIC 0x5A544F4F
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 // 全局变量 - 取色器
 static HWND g_colorPickerWindow = NULL;
 static std::atomic<bool> g_isColorPickerActive(false);
 static napi_threadsafe_function g_colorPickerTsfn = nullptr;
 static std::thread g_colorPickerThread;
 static HDC g_colorPickerMemDC = NULL;
-static HBITMAP g_colorPickerBitmap = NULL;
+static HBITMAP g_colorPickerBitmap = NULL;   // 自上而下的 32bpp DIB section，g_colorPickerPixels 指向其像素
+static ztools::ImageView g_colorPickerPixels;
 static std::string g_colorPickerResult;
 static HHOOK g_colorPickerMouseHook = NULL;
 static HHOOK g_colorPickerKeyboardHook = NULL;
@@ -141,6 +161,129 @@ static bool g_optimizedShortcutRefreshCompleted = false;
 static OptimizedShortcutRefreshRequest g_optimizedShortcutRefreshRequest;
 static OptimizedShortcutRegistrationResult g_optimizedShortcutRefreshResult;
 
+// Win32 剪贴板后端：HGLOBAL 格式直接读写原始字节；CF_ENHMETAFILE 通过 Get/SetEnhMetaFileBits 序列化；
+// 其余 GDI 句柄格式（CF_BITMAP、CF_PALETTE 等）跳过，由系统从 CF_DIB 等格式重新合成
+class Win32ClipboardBackend : public ztools::ClipboardBackend {
+public:
+    bool Open() override {
+        // 目标应用可能刚写完还没关闭剪贴板，短暂重试
+        for (int attempt = 0; attempt < 10; attempt++) {
+            if (OpenClipboard(NULL)) {
+                return true;
+            }
+            Sleep(2);
+        }
+        return false;
+    }
+
+    void Close() override { CloseClipboard(); }
+
+    std::vector<std::uint32_t> EnumFormats() override {
+        std::vector<std::uint32_t> formats;
+        UINT format = 0;
+        while ((format = EnumClipboardFormats(format)) != 0) {
+            formats.push_back(format);
+        }
+        return formats;
+    }
+
+    std::string FormatName(std::uint32_t format) override {
+        wchar_t name[256] = {0};
+        int len = GetClipboardFormatNameW(format, name, 256);
+        if (len <= 0) return std::string();
+        int utf8Size = WideCharToMultiByte(CP_UTF8, 0, name, len, nullptr, 0, nullptr, nullptr);
+        std::string result(utf8Size > 0 ? utf8Size : 0, '\0');
+        if (utf8Size > 0) {
+            WideCharToMultiByte(CP_UTF8, 0, name, len, &result[0], utf8Size, nullptr, nullptr);
+        }
+        return result;
+    }
+
+    bool ReadFormat(std::uint32_t format, const std::uint8_t*& data, size_t& size) override {
+        if (format == CF_ENHMETAFILE) {
+            HENHMETAFILE hEmf = static_cast<HENHMETAFILE>(GetClipboardData(CF_ENHMETAFILE));
+            if (hEmf == NULL) return false;
+            UINT bytes = GetEnhMetaFileBits(hEmf, 0, NULL);
+            if (bytes == 0) return false;
+            scratch_.resize(bytes);
+            GetEnhMetaFileBits(hEmf, bytes, scratch_.data());
+            data = scratch_.data();
+            size = scratch_.size();
+            return true;
+        }
+
+        if (!IsHGlobalFormat(format)) return false;
+        HANDLE hData = GetClipboardData(format);
+        if (hData == NULL) return false;
+        void* p = GlobalLock(hData);
+        if (p == NULL) return false;
+        locked_ = hData;
+        data = static_cast<const std::uint8_t*>(p);
+        size = GlobalSize(hData);
+        return true;
+    }
+
+    void ReleaseFormat(std::uint32_t) override {
+        if (locked_ != NULL) {
+            GlobalUnlock(locked_);
+            locked_ = NULL;
+        }
+    }
+
+    bool EmptyClipboard() override { return ::EmptyClipboard() != FALSE; }
+
+    bool WriteFormat(std::uint32_t format, const std::uint8_t* data, size_t size) override {
+        if (format == CF_ENHMETAFILE) {
+            HENHMETAFILE hEmf = SetEnhMetaFileBits(static_cast<UINT>(size), data);
+            if (hEmf == NULL) return false;
+            if (SetClipboardData(CF_ENHMETAFILE, hEmf) == NULL) {
+                DeleteEnhMetaFile(hEmf);
+                return false;
+            }
+            return true;
+        }
+
+        HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, size > 0 ? size : 1);
+        if (hGlobal == NULL) return false;
+        void* p = GlobalLock(hGlobal);
+        if (p == NULL) {
+            GlobalFree(hGlobal);
+            return false;
+        }
+        if (size > 0) {
+            memcpy(p, data, size);
+        }
+        GlobalUnlock(hGlobal);
+        if (SetClipboardData(format, hGlobal) == NULL) {
+            GlobalFree(hGlobal); // 失败时释放内存
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static bool IsHGlobalFormat(UINT format) {
+        switch (format) {
+            case CF_BITMAP:
+            case CF_METAFILEPICT:
+            case CF_PALETTE:
+            case CF_ENHMETAFILE:
+            case CF_OWNERDISPLAY:
+            case CF_DSPBITMAP:
+            case CF_DSPMETAFILEPICT:
+            case CF_DSPENHMETAFILE:
+                return false;
+        }
+        // GDI 对象与私有句柄格式无法按字节复制
+        if (format >= CF_GDIOBJFIRST && format <= CF_GDIOBJLAST) return false;
+        if (format >= CF_PRIVATEFIRST && format <= CF_PRIVATELAST) return false;
+        return true;
+    }
+
+    HANDLE locked_ = NULL;
+    std::vector<std::uint8_t> scratch_;
+};
+
 // 窗口过程（处理剪贴板消息）
 LRESULT CALLBACK ClipboardWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
@@ -153,9 +296,42 @@ LRESULT CALLBACK ClipboardWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
         case WM_TIMER:
             if (wParam == CLIPBOARD_DEBOUNCE_TIMER_ID) {
                 KillTimer(hwnd, CLIPBOARD_DEBOUNCE_TIMER_ID);
-                // 仅在未暂停时触发回调
-                if (g_tsfn != nullptr && !g_isPaused) {
-                    napi_call_threadsafe_function(g_tsfn, nullptr, napi_tsfn_nonblocking);
+                // 仅在未暂停、且最后一次变化不是本模块恢复剪贴板造成时触发回调
+                DWORD sequence = GetClipboardSequenceNumber();
+                if (g_tsfn != nullptr && !g_isPaused && sequence != g_clipboardSelfWriteSeq) {
+                    // 在监控线程打开一次剪贴板：收集描述符，历史已开启时顺带取出规范化内容
+                    Win32ClipboardBackend backend;
+                    ztools::ClipboardDescriptor* descriptor = new ztools::ClipboardDescriptor();
+                    bool recordHistory = false;
+                    ztools::HistoryKind historyKind = ztools::HistoryKind::Text;
+                    std::string historyPayload;
+                    size_t historyLimit = 0;
+                    if (g_clipboardHistoryOpen) {
+                        std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+                        historyLimit = g_clipboardHistory.MaxPayloadBytes();
+                    }
+                    if (backend.Open()) {
+                        ztools::DescribeOpenClipboard(backend, sequence, *descriptor);
+                        if (historyLimit > 0) {
+                            recordHistory = ztools::ExtractHistoryPayload(backend, descriptor->formatIds, historyLimit,
+                                                                          historyKind, historyPayload);
+                        }
+                        backend.Close();
+                    } else {
+                        delete descriptor;
+                        descriptor = nullptr;
+                    }
+                    if (recordHistory) {
+                        // 写历史放在关闭剪贴板之后，不占用系统剪贴板锁
+                        std::uint64_t now = static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::system_clock::now().time_since_epoch()).count());
+                        std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+                        g_clipboardHistory.Insert(historyKind, historyPayload.data(), historyPayload.size(), now);
+                    }
+                    if (napi_call_threadsafe_function(g_tsfn, descriptor, napi_tsfn_nonblocking) != napi_ok) {
+                        delete descriptor;
+                    }
                 }
             }
             return 0;
@@ -167,13 +343,37 @@ LRESULT CALLBACK ClipboardWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
     return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
-// 在主线程调用 JS 回调
+// 在主线程调用 JS 回调，参数为剪贴板描述符（剪贴板被占用读不到时为 null）
 void CallJs(napi_env env, napi_value js_callback, void* context, void* data) {
+    ztools::ClipboardDescriptor* descriptor = static_cast<ztools::ClipboardDescriptor*>(data);
     if (env != nullptr && js_callback != nullptr) {
+        Napi::Env napiEnv(env);
+        Napi::Value arg = napiEnv.Null();
+        if (descriptor != nullptr) {
+            Napi::Object obj = Napi::Object::New(napiEnv);
+            obj.Set("sequence", Napi::Number::New(napiEnv, descriptor->sequence));
+            Napi::Array formats = Napi::Array::New(napiEnv, descriptor->formatNames.size());
+            for (size_t i = 0; i < descriptor->formatNames.size(); i++) {
+                const std::string& name = descriptor->formatNames[i];
+                formats.Set(uint32_t(i), name.empty() ? Napi::Value(Napi::Number::New(napiEnv, descriptor->formatIds[i]))
+                                                      : Napi::Value(Napi::String::New(napiEnv, name)));
+            }
+            obj.Set("formats", formats);
+            obj.Set("textBytes", Napi::Number::New(napiEnv, static_cast<double>(descriptor->textBytes)));
+            obj.Set("imageWidth", Napi::Number::New(napiEnv, descriptor->imageWidth));
+            obj.Set("imageHeight", Napi::Number::New(napiEnv, descriptor->imageHeight));
+            obj.Set("fileCount", Napi::Number::New(napiEnv, descriptor->fileCount));
+            char hashHex[17];
+            snprintf(hashHex, sizeof(hashHex), "%016llx", static_cast<unsigned long long>(descriptor->hash));
+            obj.Set("hash", Napi::String::New(napiEnv, hashHex));
+            arg = obj;
+        }
+        napi_value argv[1] = {arg};
         napi_value global;
         napi_get_global(env, &global);
-        napi_call_function(env, global, js_callback, 0, nullptr, nullptr);
+        napi_call_function(env, global, js_callback, 1, argv, nullptr);
     }
+    delete descriptor;
 }
 
 // 启动剪贴板监控
@@ -303,6 +503,134 @@ Napi::Value ResumeMonitor(const Napi::CallbackInfo& info) {
     return env.Undefined();
 }
 
+// ==================== 剪贴板历史 ====================
+
+static std::string HistoryHashToHex(std::uint64_t hash) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+// 历史条目转 JS 对象：文本为字符串、文件为路径数组、图像为 CF_DIB 原始字节 Buffer
+static Napi::Object HistoryItemToObject(Napi::Env env, const ztools::HistoryItem& item) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("hash", Napi::String::New(env, HistoryHashToHex(item.hash)));
+    obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(item.timestampMs)));
+    obj.Set("copyCount", Napi::Number::New(env, item.copyCount));
+    switch (item.kind) {
+        case ztools::HistoryKind::Text:
+            obj.Set("type", Napi::String::New(env, "text"));
+            obj.Set("text", Napi::String::New(env, item.payload));
+            break;
+        case ztools::HistoryKind::Files: {
+            obj.Set("type", Napi::String::New(env, "files"));
+            Napi::Array files = Napi::Array::New(env);
+            size_t start = 0;
+            uint32_t index = 0;
+            while (start <= item.payload.size()) {
+                size_t end = item.payload.find('\n', start);
+                if (end == std::string::npos) end = item.payload.size();
+                files.Set(index++, Napi::String::New(env, item.payload.substr(start, end - start)));
+                start = end + 1;
+            }
+            obj.Set("files", files);
+            break;
+        }
+        case ztools::HistoryKind::Image: {
+            obj.Set("type", Napi::String::New(env, "image"));
+            int width = 0, height = 0;
+            const std::uint8_t* dib = reinterpret_cast<const std::uint8_t*>(item.payload.data());
+            ztools::ParseDibDimensions(dib, item.payload.size(), width, height);
+            obj.Set("width", Napi::Number::New(env, width));
+            obj.Set("height", Napi::Number::New(env, height));
+            obj.Set("dib", Napi::Buffer<uint8_t>::Copy(env, dib, item.payload.size()));
+            break;
+        }
+    }
+    return obj;
+}
+
+// 打开（或创建）历史日志文件：openClipboardHistory(path, capacityBytes?)
+Napi::Value OpenClipboardHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected history file path").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    ztools::ClipboardHistoryOptions options;
+    options.path = info[0].As<Napi::String>().Utf8Value();
+    if (info.Length() >= 2 && info[1].IsNumber()) {
+        double capacity = info[1].As<Napi::Number>().DoubleValue();
+        if (capacity > 0) options.capacityBytes = static_cast<size_t>(capacity);
+    }
+
+    std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+    bool ok = g_clipboardHistory.Open(options);
+    g_clipboardHistoryOpen = ok;
+    return Napi::Boolean::New(env, ok);
+}
+
+Napi::Value CloseClipboardHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+    g_clipboardHistoryOpen = false;
+    g_clipboardHistory.Close();
+    return env.Undefined();
+}
+
+// 查询历史：{ prefix, limit } 前缀查询；{ from, to, limit } 时间范围；否则 { offset, limit } 按最近顺序分页
+Napi::Value QueryClipboardHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object options = info.Length() >= 1 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+    auto readNumber = [&](const char* key, double fallback) {
+        Napi::Value v = options.Get(key);
+        return v.IsNumber() ? v.As<Napi::Number>().DoubleValue() : fallback;
+    };
+    size_t limit = static_cast<size_t>(std::max<double>(0, readNumber("limit", 50)));
+
+    std::vector<ztools::HistoryItem> items;
+    {
+        std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+        if (g_clipboardHistory.IsOpen()) {
+            if (options.Get("prefix").IsString()) {
+                items = g_clipboardHistory.QueryTextPrefix(options.Get("prefix").As<Napi::String>().Utf8Value(), limit);
+            } else if (options.Get("from").IsNumber() || options.Get("to").IsNumber()) {
+                std::uint64_t from = static_cast<std::uint64_t>(std::max<double>(0, readNumber("from", 0)));
+                std::uint64_t to = static_cast<std::uint64_t>(std::max<double>(0, readNumber("to", 9007199254740991.0)));
+                items = g_clipboardHistory.QueryTimeRange(from, to, limit);
+            } else {
+                size_t offset = static_cast<size_t>(std::max<double>(0, readNumber("offset", 0)));
+                items = g_clipboardHistory.QueryRecent(offset, limit);
+            }
+        }
+    }
+
+    Napi::Array result = Napi::Array::New(env, items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        result.Set(uint32_t(i), HistoryItemToObject(env, items[i]));
+    }
+    return result;
+}
+
+// 按哈希（16 位十六进制）取单条历史，不存在时返回 null
+Napi::Value GetClipboardHistoryItem(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected hash string").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::uint64_t hash = std::strtoull(info[0].As<Napi::String>().Utf8Value().c_str(), nullptr, 16);
+
+    ztools::HistoryItem item;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(g_clipboardHistoryMutex);
+        found = g_clipboardHistory.IsOpen() && g_clipboardHistory.Get(hash, item);
+    }
+    return found ? Napi::Value(HistoryItemToObject(env, item)) : env.Null();
+}
+
 // ==================== 窗口监控功能 ====================
 
 // 窗口信息结构（用于线程安全传递）
@@ -1165,8 +1493,12 @@ void CheckMouseShouldBlock(napi_env env, napi_value value) {
             // 长按模式：按钮仍被按下，标记在释放时重放
             g_mouseReplayOnRelease = true;
         } else {
-            // 点击模式或按钮已释放，立即重放
+            // 点击模式或按钮已释放，立即重放（监控线程空闲时无限等待，需要唤醒）
             g_mouseNeedReplay = true;
+            const DWORD threadId = g_mouseMonitorThreadId;
+            if (threadId != 0) {
+                PostThreadMessage(threadId, WM_NULL, 0, 0);
+            }
         }
     }
 }
@@ -1221,6 +1553,33 @@ void CallMouseJs(napi_env env, napi_value js_callback, void* context, void* data
     }
 }
 
+// 设置长按定时器：负值表示相对时间，单位 100ns
+static void SetMouseLongPressTimer(ztools::LongPressDetector::Duration remaining) {
+    if (g_mouseLongPressTimer == NULL) return;
+    LARGE_INTEGER due;
+    due.QuadPart = -std::max<LONGLONG>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+    SetWaitableTimer(g_mouseLongPressTimer, &due, 0, NULL, NULL, FALSE);
+}
+
+// 按下：安排 press + 阈值 的截止时间，到期时由定时器唤醒监控线程（点击模式不安排）
+static void ArmMouseLongPress() {
+    g_mouseLongPressTriggered = false;
+    auto now = std::chrono::steady_clock::now();
+    g_mouseLongPress.OnPress(now);
+    auto remaining = g_mouseLongPress.TimeUntilDeadline(now);
+    if (remaining) {
+        SetMouseLongPressTimer(*remaining);
+    }
+}
+
+// 抬起：撤销未到期的截止时间
+static void DisarmMouseLongPress() {
+    g_mouseLongPress.OnRelease();
+    if (g_mouseLongPressTimer != NULL) {
+        CancelWaitableTimer(g_mouseLongPressTimer);
+    }
+}
+
 // 鼠标钩子回调函数
 LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
     if (nCode >= 0 && g_isMouseMonitoring) {
@@ -1237,12 +1596,12 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
         if (g_mouseButtonType == "middle") {
             if (wParam == WM_MBUTTONDOWN) {
                 g_mouseButtonPressed = true;
-                g_mousePressStartTime = std::chrono::steady_clock::now();
-                g_mouseLongPressTriggered = false;
+                ArmMouseLongPress();
                 shouldBlock = true;
             } else if (wParam == WM_MBUTTONUP) {
                 if (g_mouseButtonPressed) {
                     g_mouseButtonPressed = false;
+                    DisarmMouseLongPress();
                     if (g_mouseLongPressMs == 0) {
                         shouldBlock = true;
                         if (!g_mouseLongPressTriggered && g_mouseTsfn != nullptr) {
@@ -1262,12 +1621,12 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
         } else if (g_mouseButtonType == "right") {
             if (wParam == WM_RBUTTONDOWN) {
                 g_mouseButtonPressed = true;
-                g_mousePressStartTime = std::chrono::steady_clock::now();
-                g_mouseLongPressTriggered = false;
+                ArmMouseLongPress();
                 shouldBlock = true;
             } else if (wParam == WM_RBUTTONUP) {
                 if (g_mouseButtonPressed) {
                     g_mouseButtonPressed = false;
+                    DisarmMouseLongPress();
                     shouldBlock = true;
                     if (!g_mouseLongPressTriggered) {
                         g_mouseNeedReplay = true;
@@ -1282,8 +1641,7 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 WORD xButton = GET_XBUTTON_WPARAM(pMouseStruct->mouseData);
                 if (xButton == XBUTTON1) {
                     g_mouseButtonPressed = true;
-                    g_mousePressStartTime = std::chrono::steady_clock::now();
-                    g_mouseLongPressTriggered = false;
+                    ArmMouseLongPress();
                     shouldBlock = true;
                 }
             } else if (wParam == WM_XBUTTONUP) {
@@ -1291,6 +1649,7 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 if (xButton == XBUTTON1) {
                     if (g_mouseButtonPressed) {
                         g_mouseButtonPressed = false;
+                        DisarmMouseLongPress();
                         if (g_mouseLongPressMs == 0) {
                             shouldBlock = true;
                             if (!g_mouseLongPressTriggered && g_mouseTsfn != nullptr) {
@@ -1313,8 +1672,7 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 WORD xButton = GET_XBUTTON_WPARAM(pMouseStruct->mouseData);
                 if (xButton == XBUTTON2) {
                     g_mouseButtonPressed = true;
-                    g_mousePressStartTime = std::chrono::steady_clock::now();
-                    g_mouseLongPressTriggered = false;
+                    ArmMouseLongPress();
                     shouldBlock = true;
                 }
             } else if (wParam == WM_XBUTTONUP) {
@@ -1322,6 +1680,7 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 if (xButton == XBUTTON2) {
                     if (g_mouseButtonPressed) {
                         g_mouseButtonPressed = false;
+                        DisarmMouseLongPress();
                         if (g_mouseLongPressMs == 0) {
                             shouldBlock = true;
                             if (!g_mouseLongPressTriggered && g_mouseTsfn != nullptr) {
@@ -1350,21 +1709,40 @@ LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
     return CallNextHookEx(g_mouseHook, nCode, wParam, lParam);
 }
 
-// 鼠标监控线程（检查长按）
+// 鼠标监控线程（长按由截止时间定时器驱动，按钮抬起时不会空转唤醒）
 void MouseMonitorThread() {
+    g_mouseMonitorThreadId = GetCurrentThreadId();
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+    // 高精度可等待定时器（Win10 1803+）触发抖动在亚毫秒级，旧系统退回普通可等待定时器
+    g_mouseLongPressTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (g_mouseLongPressTimer == NULL) {
+        g_mouseLongPressTimer = CreateWaitableTimerW(NULL, FALSE, NULL);
+    }
+
     // 设置低级鼠标钩子
     g_mouseHook = SetWindowsHookExW(WH_MOUSE_LL, MouseHookProc, GetModuleHandle(NULL), 0);
 
     if (g_mouseHook == NULL) {
+        if (g_mouseLongPressTimer != NULL) {
+            CloseHandle(g_mouseLongPressTimer);
+            g_mouseLongPressTimer = NULL;
+        }
+        g_mouseMonitorThreadId = 0;
         g_isMouseMonitoring = false;
         return;
     }
 
     // 消息循环
-    MSG msg;
     while (g_isMouseMonitoring) {
-        // 等待消息到达或超时（用于长按检测），有消息时立即返回，无延迟
-        MsgWaitForMultipleObjects(0, NULL, FALSE, 10, QS_ALLINPUT);
+        // 有定时器时无限等待消息或定时器；否则按剩余时长超时（无待触发长按时同样无限等待）
+        DWORD handleCount = g_mouseLongPressTimer != NULL ? 1 : 0;
+        DWORD timeout = INFINITE;
+        if (g_mouseLongPressTimer == NULL) {
+            timeout = ztools::ToWaitMilliseconds(g_mouseLongPress.TimeUntilDeadline(std::chrono::steady_clock::now()));
+        }
+        DWORD waitResult = MsgWaitForMultipleObjects(handleCount, &g_mouseLongPressTimer, FALSE, timeout, QS_ALLINPUT);
 
         // 处理所有待处理消息
         while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
@@ -1417,16 +1795,18 @@ void MouseMonitorThread() {
             }
         }
 
-        // 检查长按
-        if (g_mouseLongPressMs > 0 && g_mouseButtonPressed && !g_mouseLongPressTriggered) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_mousePressStartTime).count();
-
-            if (elapsed >= g_mouseLongPressMs) {
-                g_mouseLongPressTriggered = true;
-                if (g_mouseTsfn != nullptr) {
-                    napi_call_threadsafe_function(g_mouseTsfn, nullptr, napi_tsfn_nonblocking);
-                }
+        // 检查长按截止时间
+        auto now = std::chrono::steady_clock::now();
+        if (g_mouseLongPress.OnTimer(now)) {
+            g_mouseLongPressTriggered = true;
+            if (g_mouseTsfn != nullptr) {
+                napi_call_threadsafe_function(g_mouseTsfn, nullptr, napi_tsfn_nonblocking);
+            }
+        } else if (waitResult == WAIT_OBJECT_0 && handleCount > 0) {
+            // 定时器比截止时间略早触发时补设剩余时长
+            auto remaining = g_mouseLongPress.TimeUntilDeadline(now);
+            if (remaining) {
+                SetMouseLongPressTimer(*remaining);
             }
         }
     }
@@ -1436,6 +1816,11 @@ void MouseMonitorThread() {
         UnhookWindowsHookEx(g_mouseHook);
         g_mouseHook = NULL;
     }
+    if (g_mouseLongPressTimer != NULL) {
+        CloseHandle(g_mouseLongPressTimer);
+        g_mouseLongPressTimer = NULL;
+    }
+    g_mouseMonitorThreadId = 0;
 }
 
 // 启动鼠标监控
@@ -1515,6 +1900,8 @@ Napi::Value StartMouseMonitor(const Napi::CallbackInfo& info) {
     g_mouseButtonPressed = false;
     g_mouseLongPressTriggered = false;
     g_mouseReplayOnRelease = false;
+    g_mouseLongPress.Reset();
+    g_mouseLongPress.SetThreshold(std::chrono::milliseconds(g_mouseLongPressMs));
     g_isMouseMonitoring = true;
 
     // 启动监控线程
@@ -1533,6 +1920,12 @@ Napi::Value StopMouseMonitor(const Napi::CallbackInfo& info) {
 
     g_isMouseMonitoring = false;
 
+    // 监控线程可能在无限等待，投递 WM_QUIT 唤醒
+    const DWORD threadId = g_mouseMonitorThreadId;
+    if (threadId != 0) {
+        PostThreadMessage(threadId, WM_QUIT, 0, 0);
+    }
+
     // 等待线程结束
     if (g_mouseMessageThread.joinable()) {
         g_mouseMessageThread.join();
@@ -1549,6 +1942,7 @@ Napi::Value StopMouseMonitor(const Napi::CallbackInfo& info) {
     g_mouseLongPressTriggered = false;
     g_mouseNeedReplay = false;
     g_mouseReplayOnRelease = false;
+    g_mouseLongPress.Reset();
     g_mouseButtonType.clear();
     g_mouseLongPressMs = 0;
 
@@ -2265,6 +2659,54 @@ std::vector<std::string> GetClipboardFilesList() {
     return result;
 }
 
+// 模拟复制方式取到的选中内容
+struct SelectedContentData {
+    std::string text;
+    std::vector<std::string> files;
+    std::string imageBase64;
+};
+
+// 读取剪贴板中刚复制进来的内容
+static void ReadSelectedContentFromClipboard(SelectedContentData& data) {
+    data.text = GetClipboardTextContent();
+    data.files = GetClipboardFilesList();
+    data.imageBase64 = GetClipboardImageContent();
+}
+
+static Napi::Array SelectedContentToArray(Napi::Env env, const SelectedContentData& data) {
+    Napi::Array result = Napi::Array::New(env);
+    uint32_t index = 0;
+
+    if (!data.text.empty()) {
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("type", "text");
+        item.Set("data", data.text);
+        result.Set(index++, item);
+    }
+
+    if (!data.files.empty()) {
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("type", "file");
+        Napi::Array fileArray = Napi::Array::New(env);
+        for (size_t i = 0; i < data.files.size(); i++) {
+            fileArray.Set(uint32_t(i), data.files[i]);
+        }
+        item.Set("data", fileArray);
+        result.Set(index++, item);
+    }
+
+    if (!data.imageBase64.empty()) {
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("type", "image");
+        item.Set("data", data.imageBase64);
+        item.Set("format", "png");
+        item.Set("encoding", "base64");
+        result.Set(index++, item);
+    }
+
+    return result;
+}
+
 // 模拟复制操作（Ctrl + C）
 bool SimulateCopyOperation() {
     INPUT inputs[4] = {};
@@ -2364,6 +2806,102 @@ std::string TryGetSelectedTextViaUIAutomation() {
     return selectedText;
 }
 
+// 同一时刻只允许一个模拟复制流程占用剪贴板
+static std::mutex g_selectedContentMutex;
+
+// Win32 剪贴板变化事件源：在调用线程上创建消息窗口监听 WM_CLIPBOARDUPDATE，
+// 等待期间由 MsgWaitForMultipleObjects 休眠，剪贴板一变化立即醒来
+class Win32ClipboardChangeSource : public ztools::ClipboardChangeSource {
+public:
+    Win32ClipboardChangeSource() {
+        hwnd_ = CreateWindowExW(0, L"STATIC", L"ZToolsSelectionCapture", 0, 0, 0, 0, 0,
+                                HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+        if (hwnd_ != NULL && !AddClipboardFormatListener(hwnd_)) {
+            DestroyWindow(hwnd_);
+            hwnd_ = NULL;
+        }
+    }
+
+    ~Win32ClipboardChangeSource() override {
+        if (hwnd_ != NULL) {
+            RemoveClipboardFormatListener(hwnd_);
+            DestroyWindow(hwnd_);
+        }
+    }
+
+    TimePoint Now() override { return Clock::now(); }
+
+    std::uint32_t SequenceNumber() override { return GetClipboardSequenceNumber(); }
+
+    std::uint32_t WaitForChange(std::uint32_t since, TimePoint deadline) override {
+        while (true) {
+            DWORD seq = GetClipboardSequenceNumber();
+            if (seq != since) return seq;
+
+            TimePoint now = Now();
+            if (now >= deadline) return seq;
+
+            DWORD timeout = ztools::ToWaitMilliseconds(deadline - now);
+            // 监听窗口创建失败时退化为 1ms 粒度轮询序列号
+            if (hwnd_ == NULL) {
+                timeout = std::min<DWORD>(timeout, 1);
+            }
+            MsgWaitForMultipleObjects(0, NULL, FALSE, timeout, QS_ALLINPUT);
+
+            // 只取监听窗口自己的消息：同步版在 JS 主线程上等待，不能替宿主分发其他窗口的消息
+            MSG msg;
+            while (hwnd_ != NULL && PeekMessageW(&msg, hwnd_, 0, 0, PM_REMOVE)) {
+                TranslateMessage(&msg);
+                DispatchMessageW(&msg);
+            }
+        }
+    }
+
+private:
+    HWND hwnd_ = NULL;
+};
+
+class SendInputCopyInjector : public ztools::CopyKeyInjector {
+public:
+    bool SendCopy() override { return SimulateCopyOperation(); }
+};
+
+// 剪贴板回退路径（同步版与异步版共用，调用方持有 g_selectedContentMutex）：
+// 模拟 Ctrl+C 后等待剪贴板序列号变化（截止时间由 options 决定，无固定 Sleep），读出内容后按原始字节恢复原剪贴板
+static void CopySelectionViaClipboard(const ztools::SelectionCaptureOptions& options, SelectedContentData& data) {
+    bool wasMonitoring = g_isMonitoring && !g_isPaused;
+    if (wasMonitoring) {
+        g_isPaused = true;
+    }
+
+    // 原始快照只用于恢复；是否有新内容由序列号判断，不再预先编码图像做比较
+    Win32ClipboardBackend clipboardBackend;
+    ztools::ClipboardSnapshot originalSnapshot;
+    bool hasSnapshot = originalSnapshot.Capture(clipboardBackend);
+
+    Win32ClipboardChangeSource source;
+    SendInputCopyInjector injector;
+    ztools::SelectionCaptureOutcome outcome = ztools::WaitForCopiedSelection(source, injector, options);
+
+    // 序列号未变说明目标应用没有写剪贴板，原内容未被触碰，无需恢复
+    if (outcome.status == ztools::SelectionCaptureStatus::Changed) {
+        ReadSelectedContentFromClipboard(data);
+
+        // 复制进来的内容与原剪贴板逐字节相同时无需写回
+        std::uint64_t copiedHash = 0;
+        if (hasSnapshot &&
+            (!ztools::HashClipboard(clipboardBackend, copiedHash) || copiedHash != originalSnapshot.Hash())) {
+            originalSnapshot.Restore(clipboardBackend);
+        }
+        g_clipboardSelfWriteSeq = GetClipboardSequenceNumber();
+    }
+
+    // 监控通过序列号识别本次恢复，可立即恢复监控而无需延时
+    if (wasMonitoring) {
+        g_isPaused = false;
+    }
+}
+
 // 获取选中内容（Windows 实现）
 Napi::Value GetSelectedContent(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -2380,151 +2918,73 @@ Napi::Value GetSelectedContent(const Napi::CallbackInfo& info) {
     }
 
     // 方法2：回退到剪贴板方法（适用于 Electron/Chromium 应用）
-    // 暂停监控以防止触发自身事件
-    bool wasMonitoring = g_isMonitoring && !g_isPaused;
-    if (wasMonitoring) {
-        g_isPaused = true;
-    }
+    // 与异步版共用同一把锁，避免两边的快照 / 恢复交错
+    std::lock_guard<std::mutex> lock(g_selectedContentMutex);
 
-    // 保存原剪贴板内容
-    std::string originalText = GetClipboardTextContent();
-    std::string originalImage = GetClipboardImageContent();
-    std::vector<std::string> originalFiles = GetClipboardFilesList();
+    // 同步版阻塞 JS 线程：剪贴板一变化就返回，没有选中内容时最多等原来固定等待的 100ms
+    ztools::SelectionCaptureOptions options;
+    options.timeout = std::chrono::milliseconds(100);
+    SelectedContentData data;
+    CopySelectionViaClipboard(options, data);
+    return SelectedContentToArray(env, data);
+}
 
-    // 清空剪贴板
-    if (OpenClipboard(NULL)) {
-        EmptyClipboard();
-        CloseClipboard();
-    }
+// ==================== 获取选中内容（异步版）====================
 
-    // 模拟 Ctrl+C
-    if (SimulateCopyOperation()) {
-        // 等待剪贴板更新
-        Sleep(100);
+// 在工作线程执行：UI Automation 优先，回退到模拟复制 + 等待剪贴板序列号变化（无固定 Sleep）
+class SelectedContentWorker : public Napi::AsyncWorker {
+    public:
+        SelectedContentWorker(Napi::Env env, Napi::Promise::Deferred deferred,
+                              const ztools::SelectionCaptureOptions& options)
+            : Napi::AsyncWorker(env), deferred_(deferred), options_(options) {}
 
-        // 读取新的剪贴板内容
-        std::string newText = GetClipboardTextContent();
-        std::string newImage = GetClipboardImageContent();
-        std::vector<std::string> newFiles = GetClipboardFilesList();
+        void Execute() override {
+            std::lock_guard<std::mutex> lock(g_selectedContentMutex);
 
-        uint32_t index = 0;
+            data_.text = TryGetSelectedTextViaUIAutomation();
+            if (!data_.text.empty()) {
+                return;
+            }
 
-        // 检查文本
-        if (!newText.empty() && newText != originalText) {
-            Napi::Object item = Napi::Object::New(env);
-            item.Set("type", "text");
-            item.Set("data", newText);
-            result.Set(index++, item);
+            CopySelectionViaClipboard(options_, data_);
         }
 
-        // 检查文件
-        if (!newFiles.empty()) {
-            bool isDifferent = (newFiles.size() != originalFiles.size());
-            if (!isDifferent) {
-                for (size_t i = 0; i < newFiles.size(); i++) {
-                    if (newFiles[i] != originalFiles[i]) {
-                        isDifferent = true;
-                        break;
-                    }
-                }
-            }
-
-            if (isDifferent) {
-                Napi::Object item = Napi::Object::New(env);
-                item.Set("type", "file");
-                Napi::Array fileArray = Napi::Array::New(env);
-                for (size_t i = 0; i < newFiles.size(); i++) {
-                    fileArray.Set(uint32_t(i), newFiles[i]);
-                }
-                item.Set("data", fileArray);
-                result.Set(index++, item);
-            }
+        void OnOK() override {
+            deferred_.Resolve(SelectedContentToArray(Env(), data_));
         }
 
-        // 检查图像
-        if (!newImage.empty() && newImage != originalImage) {
-            Napi::Object item = Napi::Object::New(env);
-            item.Set("type", "image");
-            item.Set("data", newImage);
-            item.Set("format", "png");
-            item.Set("encoding", "base64");
-            result.Set(index++, item);
-        }
-    }
-
-    // 恢复原剪贴板内容
-    if (OpenClipboard(NULL)) {
-        EmptyClipboard();
-
-        // 恢复文本
-        if (!originalText.empty()) {
-            int wideSize = MultiByteToWideChar(CP_UTF8, 0, originalText.c_str(), -1, nullptr, 0);
-            if (wideSize > 0) {
-                HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, wideSize * sizeof(wchar_t));
-                if (hGlobal != NULL) {
-                    wchar_t* pData = static_cast<wchar_t*>(GlobalLock(hGlobal));
-                    if (pData != NULL) {
-                        MultiByteToWideChar(CP_UTF8, 0, originalText.c_str(), -1, pData, wideSize);
-                        GlobalUnlock(hGlobal);
-                        if (SetClipboardData(CF_UNICODETEXT, hGlobal) == NULL) {
-                            GlobalFree(hGlobal); // 失败时释放内存
-                        }
-                    } else {
-                        GlobalFree(hGlobal); // GlobalLock 失败时释放内存
-                    }
-                }
-            }
+        void OnError(const Napi::Error& e) override {
+            deferred_.Reject(e.Value());
         }
 
-        // 恢复文件列表
-        if (!originalFiles.empty()) {
-            size_t totalSize = sizeof(DROPFILES);
-            for (const auto& file : originalFiles) {
-                int wideSize = MultiByteToWideChar(CP_UTF8, 0, file.c_str(), -1, nullptr, 0);
-                totalSize += wideSize * sizeof(wchar_t);
-            }
-            totalSize += sizeof(wchar_t); // 额外的 null terminator
-
-            HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, totalSize);
-            if (hGlobal != NULL) {
-                DROPFILES* pDropFiles = static_cast<DROPFILES*>(GlobalLock(hGlobal));
-                if (pDropFiles != NULL) {
-                    pDropFiles->pFiles = sizeof(DROPFILES);
-                    pDropFiles->pt.x = 0;
-                    pDropFiles->pt.y = 0;
-                    pDropFiles->fNC = FALSE;
-                    pDropFiles->fWide = TRUE;
-
-                    wchar_t* pData = reinterpret_cast<wchar_t*>(reinterpret_cast<BYTE*>(pDropFiles) + sizeof(DROPFILES));
-                    size_t remainingChars = (totalSize - sizeof(DROPFILES)) / sizeof(wchar_t);
-                    for (const auto& file : originalFiles) {
-                        int wideSize = MultiByteToWideChar(CP_UTF8, 0, file.c_str(), -1, pData, static_cast<int>(remainingChars));
-                        pData += wideSize;
-                        remainingChars -= wideSize;
-                    }
-                    *pData = L'\0';
+    private:
+        Napi::Promise::Deferred deferred_;
+        ztools::SelectionCaptureOptions options_;
+        SelectedContentData data_;
+};
 
-                    GlobalUnlock(hGlobal);
-                    if (SetClipboardData(CF_HDROP, hGlobal) == NULL) {
-                        GlobalFree(hGlobal); // 失败时释放内存
-                    }
-                } else {
-                    GlobalFree(hGlobal); // GlobalLock 失败时释放内存
-                }
-            }
-        }
+// N-API: getSelectedContentAsync(options?: { timeout?: number, settle?: number }) => Promise<Array>
+Napi::Value GetSelectedContentAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ztools::SelectionCaptureOptions options;
 
-        CloseClipboard();
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (opts.Has("timeout") && opts.Get("timeout").IsNumber()) {
+            int timeout = opts.Get("timeout").As<Napi::Number>().Int32Value();
+            options.timeout = std::chrono::milliseconds(std::max<int>(0, timeout));
+        }
+        if (opts.Has("settle") && opts.Get("settle").IsNumber()) {
+            int settle = opts.Get("settle").As<Napi::Number>().Int32Value();
+            options.settle = std::chrono::milliseconds(std::max<int>(0, settle));
+        }
     }
 
-    // 恢复监控状态
-    if (wasMonitoring) {
-        // 延迟恢复，避免立即触发监听
-        Sleep(50);
-        g_isPaused = false;
-    }
+    auto deferred = Napi::Promise::Deferred::New(env);
+    auto* worker = new SelectedContentWorker(env, deferred, options);
+    worker->Queue();
 
-    return result;
+    return deferred.Promise();
 }
 
 // 模拟粘贴操作（Ctrl + V）
@@ -3415,8 +3875,8 @@ static std::unique_ptr<Gdiplus::Bitmap> CreateBitmapFromIcon(
     return bitmap;
 }
 
-// 获取 PNG 编码器 CLSID
-int GetPngEncoderClsid(CLSID* pClsid) {
+// 按 MIME 类型获取 GDI+ 编码器 CLSID
+int GetEncoderClsid(const wchar_t* mimeType, CLSID* pClsid) {
     UINT num = 0u;
     UINT size = 0u;
     Gdiplus::GetImageEncodersSize(std::addressof(num), std::addressof(size));
@@ -3429,7 +3889,7 @@ int GetPngEncoderClsid(CLSID* pClsid) {
     Gdiplus::GetImageEncoders(num, size, pImageCodecInfo.get());
 
     for (UINT i = 0u; i < num; i++) {
-        if (std::wcscmp(pImageCodecInfo.get()[i].MimeType, L"image/png") == 0) {
+        if (std::wcscmp(pImageCodecInfo.get()[i].MimeType, mimeType) == 0) {
             *pClsid = pImageCodecInfo.get()[i].Clsid;
             return (int)i;
         }
@@ -3437,6 +3897,11 @@ int GetPngEncoderClsid(CLSID* pClsid) {
     return -1;
 }
 
+// 获取 PNG 编码器 CLSID
+int GetPngEncoderClsid(CLSID* pClsid) {
+    return GetEncoderClsid(L"image/png", pClsid);
+}
+
 // 将 HICON 转换为 PNG 字节数组
 static std::vector<unsigned char> HIconToPNG(HICON hIcon) {
     GdiPlusInit init;
@@ -3851,33 +4316,14 @@ void CallColorPickerJs(napi_env env, napi_value js_callback, void* context, void
     }
 }
 
-// 获取屏幕上指定位置的像素颜色
-COLORREF GetPixelColorAt(HDC memDC, int x, int y) {
-    return GetPixel(memDC, x, y);
-}
-
-// 捕获鼠标周围 9x9 像素的颜色
-void CapturePixelsAroundCursor(HDC memDC, int mouseX, int mouseY, COLORREF colors[9][9], COLORREF& centerColor) {
-    const int gridSize = 9;
-    const int halfGrid = gridSize / 2;
+// 取色器网格：鼠标周围 9x9 像素，每格放大为 16x16
+static const int kColorPickerGrid = 9;
+static const int kColorPickerCell = 16;
 
-    for (int row = 0; row < gridSize; row++) {
-        for (int col = 0; col < gridSize; col++) {
-            int px = mouseX - halfGrid + col;
-            int py = mouseY - halfGrid + row;
-            colors[row][col] = GetPixelColorAt(memDC, px, py);
-
-            if (row == halfGrid && col == halfGrid) {
-                centerColor = colors[row][col];
-            }
-        }
-    }
-}
-
-// 全局变量存储当前颜色（用于钩子访问）
-static COLORREF g_currentPixelColors[9][9];
-static COLORREF g_currentCenterColor = RGB(0, 0, 0);
-static char g_currentHexColor[8] = "#000000";
+// 当前放大结果与读数（定时器更新、WM_PAINT 与钩子读取，均在取色器线程上）。
+// 放大缓冲常驻，鼠标移动时直接从截屏 DIB 取样放大，不再逐格 GetPixel，也不分配内存
+static ztools::Magnifier g_colorPickerMagnifier;
+static ztools::ColorReadout g_currentReadout = {"#000000", "0, 0, 0", "0, 0%, 0%"};
 
 // 取色器鼠标钩子
 LRESULT CALLBACK ColorPickerMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
@@ -3890,7 +4336,7 @@ LRESULT CALLBACK ColorPickerMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 if (g_colorPickerCallbackCalled.compare_exchange_strong(expected, true)) {
                     ColorPickerResult* result = new ColorPickerResult();
                     result->success = true;
-                    result->hex = g_currentHexColor;
+                    result->hex = g_currentReadout.hex;
                     napi_call_threadsafe_function(g_colorPickerTsfn, result, napi_tsfn_nonblocking);
 
                     g_isColorPickerActive = false;
@@ -3949,14 +4395,11 @@ LRESULT CALLBACK ColorPickerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
                 POINT pt;
                 GetCursorPos(&pt);
 
-                // 捕获像素
-                CapturePixelsAroundCursor(g_colorPickerMemDC, pt.x, pt.y, g_currentPixelColors, g_currentCenterColor);
-
-                // 转换为 HEX
-                sprintf_s(g_currentHexColor, "#%02X%02X%02X",
-                    GetRValue(g_currentCenterColor),
-                    GetGValue(g_currentCenterColor),
-                    GetBValue(g_currentCenterColor));
+                // 取样放大鼠标周围像素并生成读数（屏幕外的格子为黑色）
+                const int gridPx = kColorPickerGrid * kColorPickerCell;
+                g_colorPickerMagnifier.Configure(gridPx, gridPx, kColorPickerCell);
+                g_colorPickerMagnifier.Render(g_colorPickerPixels, pt.x, pt.y, ztools::PackBgra(0, 0, 0));
+                ztools::FormatColorReadout(g_colorPickerMagnifier.Center(), g_currentReadout);
 
                 // 更新窗口位置（跟随鼠标）
                 const int offsetX = 20;
@@ -3999,8 +4442,8 @@ LRESULT CALLBACK ColorPickerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
             HBITMAP memBitmap = CreateCompatibleBitmap(hdc, clientRect.right, clientRect.bottom);
             HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, memBitmap);
 
-            const int gridSize = 9;
-            const int cellSize = 16;
+            const int gridSize = kColorPickerGrid;
+            const int cellSize = kColorPickerCell;
             const int totalGridWidth = gridSize * cellSize;
             const int labelHeight = 28;
 
@@ -4009,40 +4452,37 @@ LRESULT CALLBACK ColorPickerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
             FillRect(memDC, &clientRect, bgBrush);
             DeleteObject(bgBrush);
 
-            // 绘制 9x9 像素网格
-            for (int row = 0; row < gridSize; row++) {
-                for (int col = 0; col < gridSize; col++) {
-                    RECT cellRect = {
-                        col * cellSize,
-                        row * cellSize,
-                        (col + 1) * cellSize,
-                        (row + 1) * cellSize
-                    };
-
-                    // 填充颜色
-                    HBRUSH brush = CreateSolidBrush(g_currentPixelColors[row][col]);
-                    FillRect(memDC, &cellRect, brush);
-                    DeleteObject(brush);
-
-                    // 绘制网格线
-                    HPEN pen = CreatePen(PS_SOLID, 1, RGB(191, 191, 191));
-                    HPEN oldPen = (HPEN)SelectObject(memDC, pen);
-                    MoveToEx(memDC, cellRect.left, cellRect.top, NULL);
-                    LineTo(memDC, cellRect.right, cellRect.top);
-                    LineTo(memDC, cellRect.right, cellRect.bottom);
-                    LineTo(memDC, cellRect.left, cellRect.bottom);
-                    LineTo(memDC, cellRect.left, cellRect.top);
-                    SelectObject(memDC, oldPen);
-                    DeleteObject(pen);
-                }
+            // 9x9 像素网格：放大结果一次画上，再用同一支笔画网格线
+            const ztools::ImageView grid = g_colorPickerMagnifier.view();
+            if (!grid.Empty()) {
+                BITMAPINFO bmi = {};
+                bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+                bmi.bmiHeader.biWidth = grid.width;
+                bmi.bmiHeader.biHeight = -grid.height;  // 自上而下，与 ImageView 行序一致
+                bmi.bmiHeader.biPlanes = 1;
+                bmi.bmiHeader.biBitCount = 32;
+                bmi.bmiHeader.biCompression = BI_RGB;
+                SetDIBitsToDevice(memDC, 0, 0, grid.width, grid.height, 0, 0, 0, grid.height,
+                    grid.data, &bmi, DIB_RGB_COLORS);
+            }
+            HPEN gridPen = CreatePen(PS_SOLID, 1, RGB(191, 191, 191));
+            HPEN oldGridPen = (HPEN)SelectObject(memDC, gridPen);
+            for (int i = 0; i <= gridSize; i++) {
+                MoveToEx(memDC, i * cellSize, 0, NULL);
+                LineTo(memDC, i * cellSize, totalGridWidth + 1);
+                MoveToEx(memDC, 0, i * cellSize, NULL);
+                LineTo(memDC, totalGridWidth + 1, i * cellSize);
             }
+            SelectObject(memDC, oldGridPen);
+            DeleteObject(gridPen);
 
             // 绘制中心十字准星
+            const int center = gridSize / 2;
             RECT centerRect = {
-                4 * cellSize,
-                4 * cellSize,
-                5 * cellSize,
-                5 * cellSize
+                center * cellSize,
+                center * cellSize,
+                (center + 1) * cellSize,
+                (center + 1) * cellSize
             };
 
             // 外层黑框
@@ -4075,7 +4515,7 @@ LRESULT CALLBACK ColorPickerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
             HFONT oldFont = (HFONT)SelectObject(memDC, font);
 
             RECT textRect = { 0, totalGridWidth + 5, totalGridWidth, totalGridWidth + labelHeight };
-            DrawTextA(memDC, g_currentHexColor, -1, &textRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+            DrawTextA(memDC, g_currentReadout.hex, -1, &textRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
 
             SelectObject(memDC, oldFont);
             DeleteObject(font);
@@ -4108,11 +4548,24 @@ void ColorPickerThreadFunc() {
     int screenWidth = GetSystemMetrics(SM_CXSCREEN);
     int screenHeight = GetSystemMetrics(SM_CYSCREEN);
 
+    // 截屏存进 DIB section，取样时直接读像素
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = screenWidth;
+    bmi.bmiHeader.biHeight = -screenHeight;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
     g_colorPickerMemDC = CreateCompatibleDC(screenDC);
-    g_colorPickerBitmap = CreateCompatibleBitmap(screenDC, screenWidth, screenHeight);
+    g_colorPickerBitmap = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
     SelectObject(g_colorPickerMemDC, g_colorPickerBitmap);
     BitBlt(g_colorPickerMemDC, 0, 0, screenWidth, screenHeight, screenDC, 0, 0, SRCCOPY);
     ReleaseDC(NULL, screenDC);
+    GdiFlush();  // CPU 读取 DIB 位之前确保 BitBlt 已完成
+    g_colorPickerPixels = (g_colorPickerBitmap && bits)
+        ? ztools::ImageView(bits, screenWidth, screenHeight, screenWidth * 4)
+        : ztools::ImageView();
 
     // 注册窗口类
     WNDCLASSEXW wc = {0};
@@ -4127,6 +4580,7 @@ void ColorPickerThreadFunc() {
         DeleteObject(g_colorPickerBitmap);
         g_colorPickerMemDC = NULL;
         g_colorPickerBitmap = NULL;
+        g_colorPickerPixels = ztools::ImageView();
         g_isColorPickerActive = false;
         return;
     }
@@ -4153,6 +4607,7 @@ void ColorPickerThreadFunc() {
         DeleteObject(g_colorPickerBitmap);
         g_colorPickerMemDC = NULL;
         g_colorPickerBitmap = NULL;
+        g_colorPickerPixels = ztools::ImageView();
         g_isColorPickerActive = false;
         return;
     }
@@ -4184,6 +4639,7 @@ void ColorPickerThreadFunc() {
         DeleteObject(g_colorPickerBitmap);
         g_colorPickerMemDC = NULL;
         g_colorPickerBitmap = NULL;
+        g_colorPickerPixels = ztools::ImageView();
         g_colorPickerWindow = NULL;
         g_isColorPickerActive = false;
         return;
@@ -4214,6 +4670,7 @@ void ColorPickerThreadFunc() {
     if (g_colorPickerBitmap) {
         DeleteObject(g_colorPickerBitmap);
         g_colorPickerBitmap = NULL;
+        g_colorPickerPixels = ztools::ImageView();
     }
     UnregisterClassW(L"ZToolsColorPicker", GetModuleHandle(NULL));
     g_colorPickerWindow = NULL;
@@ -6136,6 +6593,10 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("stopMonitor", Napi::Function::New(env, StopMonitor));
     exports.Set("pauseMonitor", Napi::Function::New(env, PauseMonitor));
     exports.Set("resumeMonitor", Napi::Function::New(env, ResumeMonitor));
+    exports.Set("openClipboardHistory", Napi::Function::New(env, OpenClipboardHistory));
+    exports.Set("closeClipboardHistory", Napi::Function::New(env, CloseClipboardHistory));
+    exports.Set("queryClipboardHistory", Napi::Function::New(env, QueryClipboardHistory));
+    exports.Set("getClipboardHistoryItem", Napi::Function::New(env, GetClipboardHistoryItem));
     exports.Set("startWindowMonitor", Napi::Function::New(env, StartWindowMonitor));
     exports.Set("stopWindowMonitor", Napi::Function::New(env, StopWindowMonitor));
     exports.Set("getActiveWindow", Napi::Function::New(env, GetActiveWindowInfo));
@@ -6154,6 +6615,10 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("startRegionCapture", Napi::Function::New(env, StartRegionCapture));
     exports.Set("primeScreenshotFrame", Napi::Function::New(env, PrimeScreenshotFrame));
     exports.Set("startRegionCaptureWithPrimedFrame", Napi::Function::New(env, StartRegionCaptureWithPrimedFrame));
+    exports.Set("setScreenshotWarmMode", Napi::Function::New(env, SetScreenshotWarmMode));
+    exports.Set("getScreenshotFrameStats", Napi::Function::New(env, GetScreenshotFrameStats));
+    exports.Set("startScrollingCapture", Napi::Function::New(env, StartScrollingCapture));
+    exports.Set("stopScrollingCapture", Napi::Function::New(env, StopScrollingCapture));
     exports.Set("getClipboardFiles", Napi::Function::New(env, GetClipboardFiles));
     exports.Set("setClipboardFiles", Napi::Function::New(env, SetClipboardFiles));
     exports.Set("startMouseMonitor", Napi::Function::New(env, StartMouseMonitor));
@@ -6178,6 +6643,7 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("readBrowserWindowUrl", Napi::Function::New(env, ReadBrowserWindowUrl));
     exports.Set("launchViaExplorer", Napi::Function::New(env, LaunchViaExplorer));
     exports.Set("getSelectedContent", Napi::Function::New(env, GetSelectedContent));
+    exports.Set("getSelectedContentAsync", Napi::Function::New(env, GetSelectedContentAsync));
     exports.Set("launchCuiShell", Napi::Function::New(env, LaunchCuiShell));
     return exports;
 }
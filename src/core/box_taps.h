@@ -0,0 +1,26 @@
+#pragma once
+
+// 面积平均缩放（ScaleFilter::Box）的单轴取样表，raster.cpp 的通用缩放与 downscale.cpp 的整幅缩小共用，
+// 保证两者结果逐像素一致。仅供 core 内部使用。
+
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+// 每个目标像素对应若干源像素及其权重（权重和恒为 kBoxOne）
+constexpr int kBoxShift = 12;
+constexpr std::uint32_t kBoxOne = 1u << kBoxShift;
+
+struct BoxTaps {
+    std::vector<int> count;    // 每个目标像素对应的源像素个数
+    std::vector<int> offset;   // 在 index/weight 中的起始位置
+    std::vector<int> index;    // 源像素下标（已裁剪到源图范围）
+    std::vector<std::uint32_t> weight;
+    int maxCount = 0;
+};
+
+// 源区间 [srcStart, srcStart + srcLen) 映射到 dstLen 个目标像素；源下标裁剪到 [0, srcLimit)
+void BuildBoxTaps(int srcStart, int srcLen, int srcLimit, int dstLen, BoxTaps& taps);
+
+}  // namespace ztools
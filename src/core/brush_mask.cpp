@@ -0,0 +1,163 @@
+#include "brush_mask.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ztools {
+
+// ==== CoverageMask ====
+
+void CoverageMask::Reset(int width, int height) {
+    width_ = width > 0 ? width : 0;
+    height_ = height > 0 ? height : 0;
+    cover_.assign(static_cast<size_t>(width_) * height_, 0);
+    touched_ = IntRect();
+}
+
+void CoverageMask::ClearAll() {
+    Clear(touched_);
+    touched_ = IntRect();
+}
+
+void CoverageMask::Clear(const IntRect& rect) {
+    IntRect r = rect.Intersect(Bounds());
+    if (r.Empty()) return;
+    for (int y = r.y; y < r.Bottom(); y++) std::memset(MutableRow(y) + r.x, 0, r.w);
+}
+
+IntRect CoverageMask::FillRect(const IntRect& rect) {
+    IntRect r = rect.Intersect(Bounds());
+    if (r.Empty()) return IntRect();
+    for (int y = r.y; y < r.Bottom(); y++) std::memset(MutableRow(y) + r.x, 255, r.w);
+    Touch(r);
+    return r;
+}
+
+IntRect CoverageMask::StampCapsule(const MaskPoint& a, const MaskPoint& b, int radius) {
+    if (radius < 1) radius = 1;
+    IntRect box = IntRect::FromLTRB((std::min)(a.x, b.x) - radius - 1, (std::min)(a.y, b.y) - radius - 1,
+                                    (std::max)(a.x, b.x) + radius + 1, (std::max)(a.y, b.y) + radius + 1)
+                      .Intersect(Bounds());
+    if (box.Empty()) return IntRect();
+
+    // 覆盖率 = clamp(r + 0.5 - d, 0, 1)：d <= r - 0.5 全覆盖，d >= r + 0.5 不覆盖，中间线性过渡
+    const double r = radius;
+    const double inner2 = (r - 0.5) * (r - 0.5);
+    const double outer2 = (r + 0.5) * (r + 0.5);
+    const double dx = b.x - a.x, dy = b.y - a.y;
+    const double len2 = dx * dx + dy * dy;
+
+    IntRect hit;
+    for (int py = box.y; py < box.Bottom(); py++) {
+        std::uint8_t* row = MutableRow(py);
+        const double cy = py + 0.5 - a.y;
+        int first = -1, last = -1;
+        for (int px = box.x; px < box.Right(); px++) {
+            const double cx = px + 0.5 - a.x;
+            double t = len2 > 0 ? (cx * dx + cy * dy) / len2 : 0.0;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            const double ex = cx - t * dx, ey = cy - t * dy;
+            const double d2 = ex * ex + ey * ey;
+            if (d2 >= outer2) continue;
+            std::uint8_t cover = 255;
+            if (d2 > inner2) cover = static_cast<std::uint8_t>((r + 0.5 - std::sqrt(d2)) * 255.0 + 0.5);
+            if (cover > row[px]) row[px] = cover;
+            if (first < 0) first = px;
+            last = px;
+        }
+        if (first >= 0) hit = hit.Union(IntRect(first, py, last - first + 1, 1));
+    }
+    Touch(hit);
+    return hit;
+}
+
+void CoverageMask::MaxWith(const CoverageMask& other, const IntRect& rect) {
+    IntRect r = rect.Intersect(Bounds()).Intersect(other.Bounds());
+    if (r.Empty()) return;
+    for (int y = r.y; y < r.Bottom(); y++) {
+        std::uint8_t* dst = MutableRow(y);
+        const std::uint8_t* src = other.Row(y);
+        for (int x = r.x; x < r.Right(); x++) dst[x] = (std::max)(dst[x], src[x]);
+    }
+    Touch(r);
+}
+
+// ==== 笔画 ====
+
+IntRect StrokeRasterizer::Extend(CoverageMask& mask, const MaskPoint* pts, int count) {
+    IntRect dirty;
+    if (count < done_) done_ = 0;  // 点被撤回 / 换了笔画：调用方应重新 Begin，这里兜底从头画
+    for (int i = done_; i < count; i++) {
+        const MaskPoint& from = i == 0 ? pts[0] : pts[i - 1];
+        dirty = dirty.Union(mask.StampCapsule(from, pts[i], radius_));
+    }
+    done_ = count;
+    return dirty;
+}
+
+IntRect RasterizeStroke(CoverageMask& mask, const MaskPoint* pts, int count, int radius) {
+    StrokeRasterizer stroke;
+    stroke.Begin(radius);
+    return stroke.Extend(mask, pts, count);
+}
+
+// ==== 揭示层合成 ====
+
+void ComposeMosaicReveal(const MosaicTileCache& tiles, int blockPx, const CoverageMask& a, const CoverageMask* b,
+                         const ImageView& out, const IntRect& rect) {
+    IntRect r = rect.Intersect(out.Bounds()).Intersect(a.Bounds());
+    if (b) r = r.Intersect(b->Bounds());
+    if (r.Empty()) return;
+    for (int y = r.y; y < r.Bottom(); y++) std::memset(out.Row(y) + r.x, 0, static_cast<size_t>(r.w) * 4);
+
+    tiles.ForEachTile(blockPx, r, [&](const IntRect& tileRect, const ImageView& tile) {
+        IntRect part = tileRect.Intersect(r);
+        for (int y = part.y; y < part.Bottom(); y++) {
+            const std::uint8_t* ca = a.Row(y);
+            const std::uint8_t* cb = b ? b->Row(y) : nullptr;
+            const std::uint32_t* src = tile.Row(y - tileRect.y) - tileRect.x;
+            std::uint32_t* dst = out.Row(y);
+            for (int x = part.x; x < part.Right(); x++) {
+                std::uint32_t c = cb ? (std::max)(ca[x], cb[x]) : ca[x];
+                if (c == 0) continue;
+                std::uint32_t px = src[x];
+                if (c == 255) {
+                    dst[x] = px | 0xFF000000u;
+                    continue;
+                }
+                std::uint32_t bl = Div255((px & 0xFF) * c);
+                std::uint32_t gr = Div255(((px >> 8) & 0xFF) * c);
+                std::uint32_t rd = Div255(((px >> 16) & 0xFF) * c);
+                dst[x] = (c << 24) | (rd << 16) | (gr << 8) | bl;
+            }
+        }
+    });
+}
+
+void BlendCoverage(const CoverageMask& mask, std::uint32_t color, const ImageView& dst, const IntRect& rect) {
+    IntRect r = rect.Intersect(dst.Bounds()).Intersect(mask.Bounds());
+    if (r.Empty()) return;
+    const std::uint32_t rgb[3] = {color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF};
+    for (int y = r.y; y < r.Bottom(); y++) {
+        const std::uint8_t* cover = mask.Row(y);
+        std::uint8_t* d = reinterpret_cast<std::uint8_t*>(dst.Row(y));
+        for (int x = r.x; x < r.Right(); x++) {
+            std::uint32_t c = cover[x];
+            if (c == 0) continue;
+            std::uint8_t* p = d + x * 4;
+            if (c == 255) {
+                p[0] = static_cast<std::uint8_t>(rgb[0]);
+                p[1] = static_cast<std::uint8_t>(rgb[1]);
+                p[2] = static_cast<std::uint8_t>(rgb[2]);
+                p[3] = 255;
+                continue;
+            }
+            std::uint32_t inv = 255 - c;
+            for (int k = 0; k < 3; k++) p[k] = static_cast<std::uint8_t>(Div255(rgb[k] * c + p[k] * inv));
+            p[3] = static_cast<std::uint8_t>(c + Div255(p[3] * inv));
+        }
+    }
+}
+
+}  // namespace ztools
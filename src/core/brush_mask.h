@@ -0,0 +1,85 @@
+#pragma once
+
+// 马赛克蒙版的解析式覆盖率光栅化（平台无关）。
+// 涂抹笔画 = 沿路径的一串胶囊（线段 + 半径），按像素中心到线段的距离直接求覆盖率（1px 抗锯齿边），
+// 多个形状之间取最大值合并。笔画随鼠标点到达增量光栅化，每次只触及新线段的包围盒，
+// 调用方据此只重新合成这一小块，替代「每帧沿路径逐圆 CombineRgn」的 HRGN 方案。
+// 坐标约定：点 (x, y) 为像素边界坐标，像素 (px, py) 的中心在 (px + 0.5, py + 0.5)，
+// 与 CreateEllipticRgn(x - r, y - r, x + r, y + r) 覆盖的像素一致。
+
+#include "mosaic_tiles.h"
+#include "raster.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+struct MaskPoint {
+    int x = 0, y = 0;
+};
+
+// 8 位覆盖率画布（0 = 不揭示，255 = 完全揭示），所有写入都裁剪到画布内
+class CoverageMask {
+public:
+    void Reset(int width, int height);  // 重新分配并清零
+    void ClearAll();                    // 只清零曾写过的范围
+    void Clear(const IntRect& rect);
+
+    bool Empty() const { return width_ <= 0 || height_ <= 0; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    IntRect Bounds() const { return IntRect(0, 0, width_, height_); }
+    const std::uint8_t* Row(int y) const { return cover_.data() + static_cast<size_t>(y) * width_; }
+    std::uint8_t At(int x, int y) const { return Row(y)[x]; }
+    // 自上次 Reset / ClearAll 以来写过的范围（保守外包，Clear 不会缩小它）
+    const IntRect& Touched() const { return touched_; }
+
+    // 以下写入都与已有覆盖率取最大值，返回实际触及的矩形（已裁剪）
+    IntRect FillRect(const IntRect& rect);
+    IntRect StampCapsule(const MaskPoint& a, const MaskPoint& b, int radius);
+    // 把 other 在 rect 内的覆盖率并入（两者尺寸相同）
+    void MaxWith(const CoverageMask& other, const IntRect& rect);
+
+private:
+    std::uint8_t* MutableRow(int y) { return cover_.data() + static_cast<size_t>(y) * width_; }
+    void Touch(const IntRect& r) { touched_ = touched_.Union(r); }
+
+    std::vector<std::uint8_t> cover_;
+    int width_ = 0;
+    int height_ = 0;
+    IntRect touched_;
+};
+
+// 增量笔画：记录已经光栅化到第几个点，Extend 只补画新增的线段
+class StrokeRasterizer {
+public:
+    void Begin(int radius) {
+        radius_ = radius < 1 ? 1 : radius;
+        done_ = 0;
+    }
+    int radius() const { return radius_; }
+    int done() const { return done_; }
+
+    // 光栅化 pts[done-1 .. count) 之间的新线段（第一个点为单点圆），返回本次触及的矩形
+    IntRect Extend(CoverageMask& mask, const MaskPoint* pts, int count);
+
+private:
+    int radius_ = 1;
+    int done_ = 0;
+};
+
+// 一次性光栅化整条笔画（等价于 Begin + Extend 全部点）
+IntRect RasterizeStroke(CoverageMask& mask, const MaskPoint* pts, int count, int radius);
+
+// 在 out 的 rect 内合成马赛克揭示层：覆盖率 c = max(a, b)，
+// out = 预乘 alpha 的 base * c / 255，alpha = c（供 AlphaBlend AC_SRC_ALPHA 叠加到原图上）。
+// base 取自 tiles 的 blockPx 层，调用方需先 Ensure(blockPx, rect)；b 可为 nullptr。
+void ComposeMosaicReveal(const MosaicTileCache& tiles, int blockPx, const CoverageMask& a, const CoverageMask* b,
+                         const ImageView& out, const IntRect& rect);
+
+// 以覆盖率为 alpha 把纯色 color（0xAARRGGBB，忽略 A）src-over 叠加到 dst 的 rect（预乘结果），
+// 即按蒙版「描」一笔实色笔画；mask 与 dst 同坐标系
+void BlendCoverage(const CoverageMask& mask, std::uint32_t color, const ImageView& dst, const IntRect& rect);
+
+}  // namespace ztools
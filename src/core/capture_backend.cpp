@@ -0,0 +1,89 @@
+#include "capture_backend.h"
+
+#include "parallel.h"
+
+#include <cstring>
+#include <utility>
+
+namespace ztools {
+
+void DuplicationCapture::Reset(std::unique_ptr<CaptureBackend> backend) {
+    backend_ = std::move(backend);
+    frame_.Release();
+    bounds_ = IntRect();
+    valid_ = false;
+}
+
+bool DuplicationCapture::Update(int timeoutMs) {
+    if (!backend_) return false;
+    IntRect bounds = backend_->Bounds();
+    if (bounds.Empty()) {
+        valid_ = false;
+        return false;
+    }
+    if (bounds.w != frame_.width() || bounds.h != frame_.height()) {
+        frame_.Allocate(bounds.w, bounds.h);
+        valid_ = false;
+    }
+    bounds_ = bounds;
+
+    delta_.Clear();
+    if (!backend_->Acquire(delta_, timeoutMs)) {
+        valid_ = false;
+        return false;
+    }
+    stats_.updates++;
+    const ImageView view = frame_.view();
+    bool ok = true;
+    if (delta_.full || !valid_) {
+        ok = backend_->Read(view.Bounds(), view);
+        stats_.fullReads++;
+        stats_.pixelsRead += static_cast<std::int64_t>(view.width) * view.height;
+    } else {
+        // 与 DXGI 约定一致：移动先于脏矩形，按报告顺序逐个应用（每个移动的源是此前已更新的画面）
+        for (const FrameMove& m : delta_.moves) ApplyMove(m);
+        for (const IntRect& r : delta_.dirty) {
+            IntRect c = r.Intersect(view.Bounds());
+            if (c.Empty()) continue;
+            ok = backend_->Read(c, view) && ok;
+            stats_.pixelsRead += static_cast<std::int64_t>(c.w) * c.h;
+        }
+    }
+    backend_->Release();
+    valid_ = ok;
+    return ok;
+}
+
+bool DuplicationCapture::Snapshot(const ImageView& dst, int threads) const {
+    const ImageView src = frame_.view();
+    if (!valid_ || dst.width != src.width || dst.height != src.height) return false;
+    ParallelFor(src.height, 256, [&](int begin, int end) {
+        Copy(src, 0, begin, dst, IntRect(0, begin, src.width, end - begin));
+    }, threads);
+    return true;
+}
+
+void DuplicationCapture::ApplyMove(const FrameMove& move) {
+    const ImageView view = frame_.view();
+    IntRect src = move.source.Intersect(view.Bounds());
+    // 目标按源的裁剪同步偏移，再裁剪到帧内
+    IntRect dst(move.x + (src.x - move.source.x), move.y + (src.y - move.source.y), src.w, src.h);
+    IntRect clipped = dst.Intersect(view.Bounds());
+    if (clipped.Empty()) return;
+    src = IntRect(src.x + (clipped.x - dst.x), src.y + (clipped.y - dst.y), clipped.w, clipped.h);
+    // 源、目标可能重叠（滚动）：向下搬时自下而上逐行，行内重叠由 memmove 处理
+    const size_t bytes = static_cast<size_t>(clipped.w) * 4;
+    const int dy = src.y - clipped.y;
+    if (dy < 0) {
+        for (int y = clipped.Bottom() - 1; y >= clipped.y; y--) {
+            std::memmove(view.Row(y) + clipped.x, view.Row(y + dy) + src.x, bytes);
+        }
+    } else {
+        for (int y = clipped.y; y < clipped.Bottom(); y++) {
+            std::memmove(view.Row(y) + clipped.x, view.Row(y + dy) + src.x, bytes);
+        }
+    }
+    stats_.pixelsMoved += static_cast<std::int64_t>(clipped.w) * clipped.h;
+}
+
+}  // namespace ztools
@@ -0,0 +1,95 @@
+#pragma once
+
+// 屏幕捕获后端与持久帧缓冲（平台无关）
+// 后端按 Desktop Duplication 的方式工作：每次 Acquire 报告自上次以来的移动矩形（窗口拖动 / 滚动，
+// 内容从上一帧的 source 原样搬到目标位置）与脏矩形（内容需要重新读取），再按需读取脏区像素。
+// DuplicationCapture 常驻保存上一帧，更新时先按顺序应用移动、再只读脏矩形，
+// 桌面静止时一次更新几乎不读像素；首帧、尺寸变化或后端要求时才整帧读取。
+// Windows 上由 DXGI Output Duplication 实现（每个显示器一路），测试 / 基准用合成后端。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ztools {
+
+// 移动矩形：上一帧 source 的内容搬到左上角 (x, y)
+struct FrameMove {
+    IntRect source;
+    int x = 0;
+    int y = 0;
+};
+
+// 一次 Acquire 报告的变化；坐标为桌面物理像素，原点在后端 Bounds() 的左上角
+struct FrameDelta {
+    bool full = false;  // 整帧失效：忽略 moves / dirty，整帧重读
+    std::vector<FrameMove> moves;
+    std::vector<IntRect> dirty;
+
+    void Clear() {
+        full = false;
+        moves.clear();
+        dirty.clear();
+    }
+    bool Empty() const { return !full && moves.empty() && dirty.empty(); }
+};
+
+// 捕获后端。调用顺序：Acquire -> 若干次 Read -> Release（Acquire 失败时不调用 Release）
+class CaptureBackend {
+public:
+    virtual ~CaptureBackend() = default;
+
+    virtual const char* Name() const = 0;
+    // 桌面范围（物理像素，虚拟桌面坐标）；变化后下一次 Acquire 必须报告 full
+    virtual IntRect Bounds() const = 0;
+    // 最多等待 timeoutMs 取得下一帧的变化；没有新帧时返回 true 且 delta 为空。
+    // 失败（访问丢失、桌面切换等）返回 false，之前报告过的变化不再可信
+    virtual bool Acquire(FrameDelta& delta, int timeoutMs) = 0;
+    // 把当前帧中的 rect 读到 dst 的同一位置（dst 尺寸 = Bounds() 尺寸）
+    virtual bool Read(const IntRect& rect, const ImageView& dst) = 0;
+    virtual void Release() = 0;
+};
+
+struct CaptureStats {
+    int updates = 0;
+    int fullReads = 0;
+    std::int64_t pixelsRead = 0;   // 从后端读取的像素累计（整帧读取时为整帧面积）
+    std::int64_t pixelsMoved = 0;  // 在持久帧内搬移的像素累计
+};
+
+// 持久帧缓冲：保存后端的最新完整帧，Update 时只应用增量
+class DuplicationCapture {
+public:
+    DuplicationCapture() = default;
+
+    // 更换后端（nullptr 表示停用）；帧缓冲随之失效
+    void Reset(std::unique_ptr<CaptureBackend> backend);
+    CaptureBackend* backend() const { return backend_.get(); }
+
+    // 把帧缓冲同步到后端当前画面；失败时帧缓冲失效，返回 false
+    bool Update(int timeoutMs = 0);
+    // 下一次 Update 整帧重读（如检测到外部原因导致增量不可信）
+    void Invalidate() { valid_ = false; }
+
+    bool Valid() const { return valid_; }
+    IntRect Bounds() const { return bounds_; }
+    // 最新完整帧（Update 成功后有效，下一次 Update 前不变）
+    ImageView frame() const { return frame_.view(); }
+    const CaptureStats& stats() const { return stats_; }
+    // 把最新完整帧复制到 dst（尺寸须一致），按行分给多个线程；threads <= 0 时使用 DefaultThreadCount()
+    bool Snapshot(const ImageView& dst, int threads = 0) const;
+
+private:
+    void ApplyMove(const FrameMove& move);
+
+    std::unique_ptr<CaptureBackend> backend_;
+    Surface frame_;
+    FrameDelta delta_;
+    IntRect bounds_;
+    bool valid_ = false;
+    CaptureStats stats_;
+};
+
+}  // namespace ztools
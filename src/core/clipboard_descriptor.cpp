@@ -0,0 +1,202 @@
+#include "clipboard_descriptor.h"
+
+#include "content_hash.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+std::uint16_t ReadU16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::int32_t ReadI32(const std::uint8_t* p) {
+    std::int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t ReadU32(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 不超过 kFullHashBytes 的格式整体哈希；更大的（截图的 CF_DIB 动辄几十 MB）只取
+// 开头 kHeadBytes（含 BITMAPINFOHEADER）+ 均匀分布的 kSamples 段 kSampleBytes + 结尾 kSampleBytes，
+// 与长度一起作为指纹：监控线程持有剪贴板期间的哈希开销有上限
+const size_t kFullHashBytes = 256 * 1024;
+const size_t kHeadBytes = 64 * 1024;
+const size_t kSamples = 64;
+const size_t kSampleBytes = 1024;
+
+void HashPayload(ContentHasher& hasher, const std::uint8_t* data, size_t size) {
+    if (size <= kFullHashBytes) {
+        hasher.Update(data, size);
+        return;
+    }
+    hasher.Update(data, kHeadBytes);
+    size_t span = size - kHeadBytes - kSampleBytes;
+    for (size_t i = 0; i < kSamples; i++) hasher.Update(data + kHeadBytes + span * i / kSamples, kSampleBytes);
+    hasher.Update(data + size - kSampleBytes, kSampleBytes);
+}
+
+// 读取一个格式的原始字节并喂入哈希，同时交给 fn 解析
+template <typename Fn>
+bool WithFormat(ClipboardBackend& backend, std::uint32_t format, ContentHasher& hasher, Fn&& fn) {
+    const std::uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!backend.ReadFormat(format, data, size)) return false;
+    hasher.UpdateU32(format);
+    hasher.UpdateU64(size);
+    HashPayload(hasher, data, size);
+    fn(data, size);
+    backend.ReleaseFormat(format);
+    return true;
+}
+
+}  // namespace
+
+const char* StandardClipboardFormatName(std::uint32_t format) {
+    switch (format) {
+        case cf::kText: return "CF_TEXT";
+        case cf::kBitmap: return "CF_BITMAP";
+        case cf::kMetafilePict: return "CF_METAFILEPICT";
+        case cf::kSylk: return "CF_SYLK";
+        case cf::kDif: return "CF_DIF";
+        case cf::kTiff: return "CF_TIFF";
+        case cf::kOemText: return "CF_OEMTEXT";
+        case cf::kDib: return "CF_DIB";
+        case cf::kPalette: return "CF_PALETTE";
+        case cf::kPenData: return "CF_PENDATA";
+        case cf::kRiff: return "CF_RIFF";
+        case cf::kWave: return "CF_WAVE";
+        case cf::kUnicodeText: return "CF_UNICODETEXT";
+        case cf::kEnhMetafile: return "CF_ENHMETAFILE";
+        case cf::kHdrop: return "CF_HDROP";
+        case cf::kLocale: return "CF_LOCALE";
+        case cf::kDibV5: return "CF_DIBV5";
+        default: return "";
+    }
+}
+
+size_t Utf16ToUtf8Length(const std::uint8_t* data, size_t size) {
+    size_t bytes = 0;
+    size_t units = size / 2;
+    for (size_t i = 0; i < units; i++) {
+        std::uint16_t c = ReadU16(data + i * 2);
+        if (c == 0) break;
+        if (c < 0x80) {
+            bytes += 1;
+        } else if (c < 0x800) {
+            bytes += 2;
+        } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < units) {
+            std::uint16_t next = ReadU16(data + (i + 1) * 2);
+            if (next >= 0xDC00 && next <= 0xDFFF) {
+                bytes += 4;
+                i++;
+            } else {
+                bytes += 3;  // 孤立代理项按 U+FFFD 计
+            }
+        } else {
+            bytes += 3;
+        }
+    }
+    return bytes;
+}
+
+bool ParseDibDimensions(const std::uint8_t* data, size_t size, int& width, int& height) {
+    // BITMAPINFOHEADER: biSize(4) biWidth(4) biHeight(4) ...
+    if (size < 12) return false;
+    std::uint32_t headerSize = ReadU32(data);
+    if (headerSize < 12 || headerSize > size) return false;
+    if (headerSize == 12) {
+        // BITMAPCOREHEADER: bcWidth/bcHeight 为 16 位
+        width = ReadU16(data + 4);
+        height = ReadU16(data + 6);
+    } else {
+        width = ReadI32(data + 4);
+        height = std::abs(ReadI32(data + 8));
+    }
+    return width > 0 && height > 0;
+}
+
+int CountDropFiles(const std::uint8_t* data, size_t size) {
+    // DROPFILES: pFiles(4) pt(8) fNC(4) fWide(4)
+    if (size < 20) return 0;
+    std::uint32_t offset = ReadU32(data);
+    bool wide = ReadU32(data + 16) != 0;
+    if (offset >= size) return 0;
+
+    int count = 0;
+    if (wide) {
+        size_t i = offset;
+        while (i + 1 < size) {
+            if (ReadU16(data + i) == 0) break;  // 空串 = 列表结束
+            while (i + 1 < size && ReadU16(data + i) != 0) i += 2;
+            count++;
+            i += 2;
+        }
+    } else {
+        size_t i = offset;
+        while (i < size && data[i] != 0) {
+            while (i < size && data[i] != 0) i++;
+            count++;
+            i++;
+        }
+    }
+    return count;
+}
+
+void DescribeOpenClipboard(ClipboardBackend& backend, std::uint32_t sequence, ClipboardDescriptor& out) {
+    out = ClipboardDescriptor();
+    out.sequence = sequence;
+    out.formatIds = backend.EnumFormats();
+
+    bool hasUnicodeText = false;
+    bool hasHdrop = false;
+    std::uint32_t dibFormat = 0;  // CF_DIB 与 CF_DIBV5 互相合成，取先枚举到的（通常是原始格式）
+    out.formatNames.reserve(out.formatIds.size());
+    for (std::uint32_t format : out.formatIds) {
+        const char* standard = StandardClipboardFormatName(format);
+        out.formatNames.push_back(*standard ? std::string(standard) : backend.FormatName(format));
+        hasUnicodeText |= format == cf::kUnicodeText;
+        if (dibFormat == 0 && (format == cf::kDib || format == cf::kDibV5)) dibFormat = format;
+        hasHdrop |= format == cf::kHdrop;
+    }
+
+    // 只读取用于描述的几个主格式，哈希也只覆盖它们（应用私有格式不参与）
+    ContentHasher hasher;
+    if (hasUnicodeText) {
+        WithFormat(backend, cf::kUnicodeText, hasher, [&](const std::uint8_t* d, size_t n) {
+            out.textBytes = Utf16ToUtf8Length(d, n);
+        });
+    }
+    if (hasHdrop) {
+        WithFormat(backend, cf::kHdrop, hasher, [&](const std::uint8_t* d, size_t n) {
+            out.fileCount = CountDropFiles(d, n);
+        });
+    }
+    if (dibFormat != 0) {
+        WithFormat(backend, dibFormat, hasher, [&](const std::uint8_t* d, size_t n) {
+            int w = 0, h = 0;
+            if (ParseDibDimensions(d, n, w, h)) {
+                out.imageWidth = w;
+                out.imageHeight = h;
+            }
+        });
+    }
+    out.hash = hasher.Digest();
+}
+
+bool BuildClipboardDescriptor(ClipboardBackend& backend, std::uint32_t sequence, ClipboardDescriptor& out) {
+    if (!backend.Open()) return false;
+    DescribeOpenClipboard(backend, sequence, out);
+    backend.Close();
+    return true;
+}
+
+}  // namespace ztools
@@ -0,0 +1,70 @@
+#pragma once
+
+// 剪贴板变化描述符（平台无关）
+// 在监控线程已打开剪贴板时一次性收集：序列号、格式列表、文本长度、图像尺寸、文件数和内容哈希，
+// 随变化事件一起交给 JS，消费者无需再逐个调用原生接口重新打开剪贴板。
+
+#include "clipboard_snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ztools {
+
+// 预定义剪贴板格式 ID（与 Win32 CF_* 常量取值一致）
+namespace cf {
+const std::uint32_t kText = 1;
+const std::uint32_t kBitmap = 2;
+const std::uint32_t kMetafilePict = 3;
+const std::uint32_t kSylk = 4;
+const std::uint32_t kDif = 5;
+const std::uint32_t kTiff = 6;
+const std::uint32_t kOemText = 7;
+const std::uint32_t kDib = 8;
+const std::uint32_t kPalette = 9;
+const std::uint32_t kPenData = 10;
+const std::uint32_t kRiff = 11;
+const std::uint32_t kWave = 12;
+const std::uint32_t kUnicodeText = 13;
+const std::uint32_t kEnhMetafile = 14;
+const std::uint32_t kHdrop = 15;
+const std::uint32_t kLocale = 16;
+const std::uint32_t kDibV5 = 17;
+}  // namespace cf
+
+struct ClipboardDescriptor {
+    std::uint32_t sequence = 0;
+    std::vector<std::uint32_t> formatIds;  // EnumClipboardFormats 顺序
+    std::vector<std::string> formatNames;  // 预定义格式为 "CF_*"，注册格式为注册名
+    size_t textBytes = 0;                  // 文本按 UTF-8 编码后的字节数（不含结尾 NUL）
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int fileCount = 0;
+    std::uint64_t hash = 0;                // 文本/文件/图像原始字节的内容哈希（超过 256KB 的格式按长度 + 抽样字节）
+
+    bool hasText() const { return textBytes > 0; }
+    bool hasImage() const { return imageWidth > 0 && imageHeight > 0; }
+    bool hasFiles() const { return fileCount > 0; }
+};
+
+// 预定义格式名（"CF_UNICODETEXT" 等）；非预定义格式返回空字符串
+const char* StandardClipboardFormatName(std::uint32_t format);
+
+// UTF-16LE 文本（遇到 NUL 截止）转为 UTF-8 后的字节数，不实际转换
+size_t Utf16ToUtf8Length(const std::uint8_t* data, size_t size);
+
+// 从 BITMAPINFOHEADER / BITMAPV5HEADER 读出图像尺寸（高度取绝对值）
+bool ParseDibDimensions(const std::uint8_t* data, size_t size, int& width, int& height);
+
+// 统计 DROPFILES（CF_HDROP）中的文件数
+int CountDropFiles(const std::uint8_t* data, size_t size);
+
+// 假设剪贴板已经由调用方打开（监控线程内），收集描述符
+void DescribeOpenClipboard(ClipboardBackend& backend, std::uint32_t sequence, ClipboardDescriptor& out);
+
+// 打开剪贴板、收集描述符、关闭；打不开时返回 false
+bool BuildClipboardDescriptor(ClipboardBackend& backend, std::uint32_t sequence, ClipboardDescriptor& out);
+
+}  // namespace ztools
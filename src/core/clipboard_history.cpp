@@ -0,0 +1,517 @@
+#include "clipboard_history.h"
+
+#include "clipboard_descriptor.h"
+#include "content_hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+constexpr std::uint32_t kFileMagic = 0x5348545A;    // "ZTHS"
+constexpr std::uint32_t kFileVersion = 1;
+constexpr std::uint32_t kRecordMagic = 0x4345525A;  // "ZREC"
+constexpr size_t kFileHeaderSize = 64;
+constexpr size_t kRecordAlign = 8;
+constexpr size_t kTextKeyBytes = 32;  // 前缀索引的键长
+
+enum RecordType : std::uint8_t {
+    kRecordContent = 1,  // 内容记录：头 + 载荷
+    kRecordTouch = 2     // 去重命中：只刷新时间戳 / 次数，无载荷
+};
+
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t capacity;
+    std::uint64_t tail;
+    std::uint8_t reserved[40];
+};
+static_assert(sizeof(FileHeader) == kFileHeaderSize, "history file header must be 64 bytes");
+
+struct RecordHeader {
+    std::uint32_t magic;
+    std::uint8_t type;
+    std::uint8_t kind;
+    std::uint16_t reserved;
+    std::uint32_t size;
+    std::uint32_t count;
+    std::uint64_t hash;
+    std::uint64_t timestampMs;
+};
+static_assert(sizeof(RecordHeader) == 32, "history record header must be 32 bytes");
+
+size_t AlignRecord(size_t n) {
+    return (n + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+size_t RecordBytes(size_t payloadSize) {
+    return AlignRecord(sizeof(RecordHeader) + payloadSize);
+}
+
+std::uint64_t HashPayload(HistoryKind kind, const void* data, size_t size) {
+    // 类型作为种子：同样的字节作为文本和作为文件列表视为不同内容
+    return HashBytes(data, size, static_cast<std::uint64_t>(kind));
+}
+
+bool ValidKind(std::uint8_t kind) {
+    return kind >= static_cast<std::uint8_t>(HistoryKind::Text) && kind <= static_cast<std::uint8_t>(HistoryKind::Image);
+}
+
+std::uint16_t ReadU16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t ReadU32(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void AppendUtf8(std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// 解码 [begin, end) 的 UTF-16LE（遇到 NUL 停止），返回停止位置
+size_t DecodeUtf16(const std::uint8_t* data, size_t begin, size_t end, std::string& out, bool foldCrLf) {
+    size_t i = begin;
+    while (i + 1 < end) {
+        std::uint32_t c = ReadU16(data + i);
+        if (c == 0) break;
+        i += 2;
+        if (c >= 0xD800 && c <= 0xDBFF) {
+            std::uint32_t next = i + 1 < end ? ReadU16(data + i) : 0;
+            if (next >= 0xDC00 && next <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (next - 0xDC00);
+                i += 2;
+            } else {
+                c = 0xFFFD;
+            }
+        } else if (c >= 0xDC00 && c <= 0xDFFF) {
+            c = 0xFFFD;
+        }
+        if (foldCrLf && c == '\r' && i + 1 < end && ReadU16(data + i) == '\n') continue;
+        AppendUtf8(out, c);
+    }
+    return i;
+}
+
+}  // namespace
+
+// ==================== 规范化 ====================
+
+std::string NormalizeClipboardText(const std::uint8_t* data, size_t size) {
+    std::string out;
+    out.reserve(Utf16ToUtf8Length(data, size));
+    DecodeUtf16(data, 0, size, out, true);
+    return out;
+}
+
+std::string NormalizeDropFiles(const std::uint8_t* data, size_t size) {
+    // DROPFILES: pFiles(4) pt(8) fNC(4) fWide(4)
+    std::string out;
+    if (size < 20) return out;
+    std::uint32_t offset = ReadU32(data);
+    bool wide = ReadU32(data + 16) != 0;
+    if (offset >= size) return out;
+
+    size_t i = offset;
+    if (wide) {
+        while (i + 1 < size && ReadU16(data + i) != 0) {
+            if (!out.empty()) out.push_back('\n');
+            i = DecodeUtf16(data, i, size, out, false) + 2;
+        }
+    } else {
+        while (i < size && data[i] != 0) {
+            if (!out.empty()) out.push_back('\n');
+            while (i < size && data[i] != 0) out.push_back(static_cast<char>(data[i++]));
+            i++;
+        }
+    }
+    return out;
+}
+
+bool ExtractHistoryPayload(ClipboardBackend& backend, const std::vector<std::uint32_t>& formats, size_t maxBytes,
+                           HistoryKind& kind, std::string& payload) {
+    auto has = [&](std::uint32_t format) {
+        return std::find(formats.begin(), formats.end(), format) != formats.end();
+    };
+    auto read = [&](std::uint32_t format, std::string (*convert)(const std::uint8_t*, size_t)) {
+        const std::uint8_t* data = nullptr;
+        size_t size = 0;
+        if (!backend.ReadFormat(format, data, size)) return false;
+        // 原始字节直接入库，先比大小再复制；转换后的文本 / 路径长度与原始字节不同，转换后再比
+        if (convert) {
+            payload = convert(data, size);
+        } else if (size <= maxBytes) {
+            payload.assign(reinterpret_cast<const char*>(data), size);
+        } else {
+            payload.clear();
+        }
+        backend.ReleaseFormat(format);
+        if (payload.size() > maxBytes) payload.clear();
+        return !payload.empty();
+    };
+
+    // 文件复制时通常同时带有文本（路径），优先按文件记录
+    if (has(cf::kHdrop) && read(cf::kHdrop, NormalizeDropFiles)) {
+        kind = HistoryKind::Files;
+        return true;
+    }
+    if (has(cf::kUnicodeText) && read(cf::kUnicodeText, NormalizeClipboardText)) {
+        kind = HistoryKind::Text;
+        return true;
+    }
+    std::uint32_t dib = has(cf::kDib) ? cf::kDib : (has(cf::kDibV5) ? cf::kDibV5 : 0);
+    if (dib != 0 && read(dib, nullptr)) {
+        kind = HistoryKind::Image;
+        return true;
+    }
+    payload.clear();
+    return false;
+}
+
+// ==================== 存储 ====================
+
+bool ClipboardHistoryStore::Open(const ClipboardHistoryOptions& options) {
+    Close();
+    size_t capacity = (std::max)(options.capacityBytes, kFileHeaderSize + RecordBytes(256));
+    capacity = AlignRecord(capacity);
+    if (!file_.Open(options.path, capacity)) return false;
+    if (!LoadExisting()) {
+        tail_ = kFileHeaderSize;
+        WriteHeader();
+    }
+    return true;
+}
+
+void ClipboardHistoryStore::Close() {
+    if (file_.IsOpen()) {
+        WriteHeader();
+        file_.Flush();
+        file_.Close();
+    }
+    index_.clear();
+    recency_.clear();
+    textPrefix_.clear();
+    tail_ = 0;
+    nextOrder_ = 1;
+    stats_ = ClipboardHistoryStats();
+}
+
+void ClipboardHistoryStore::Clear() {
+    if (!file_.IsOpen()) return;
+    index_.clear();
+    recency_.clear();
+    textPrefix_.clear();
+    tail_ = kFileHeaderSize;
+    WriteHeader();
+}
+
+void ClipboardHistoryStore::WriteHeader() {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kFileMagic;
+    header.version = kFileVersion;
+    header.capacity = file_.size();
+    header.tail = tail_;
+    std::memcpy(file_.data(), &header, sizeof(header));
+}
+
+bool ClipboardHistoryStore::LoadExisting() {
+    FileHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != kFileMagic || header.version != kFileVersion) return false;
+    if (header.tail < kFileHeaderSize || header.tail > file_.size()) return false;
+
+    // 顺序重放日志：内容记录建立索引，Touch 记录刷新时间；遇到损坏的记录就从那里截断
+    const std::uint8_t* base = file_.data();
+    size_t end = static_cast<size_t>(header.tail);
+    size_t pos = kFileHeaderSize;
+    while (pos + sizeof(RecordHeader) <= end) {
+        RecordHeader rec;
+        std::memcpy(&rec, base + pos, sizeof(rec));
+        if (rec.magic != kRecordMagic) break;
+        size_t next = pos + RecordBytes(rec.size);
+        if (next > end) break;
+
+        if (rec.type == kRecordContent) {
+            if (!ValidKind(rec.kind)) break;
+            HistoryKind kind = static_cast<HistoryKind>(rec.kind);
+            const std::uint8_t* payload = base + pos + sizeof(RecordHeader);
+            if (HashPayload(kind, payload, rec.size) != rec.hash) break;  // 内容寻址：哈希即校验和
+
+            auto it = index_.find(rec.hash);
+            if (it != index_.end()) {
+                // 异常情况（压缩中断等）：以后出现的副本为准
+                recency_.erase(it->second.order);
+                UnindexText(rec.hash, it->second);
+                index_.erase(it);
+            }
+            IndexEntry entry{pos, rec.size, kind, rec.timestampMs, nextOrder_++, (std::max)(rec.count, 1u)};
+            recency_[entry.order] = rec.hash;
+            IndexText(rec.hash, entry);
+            index_.emplace(rec.hash, entry);
+        } else if (rec.type == kRecordTouch) {
+            auto it = index_.find(rec.hash);
+            if (it != index_.end()) {
+                recency_.erase(it->second.order);
+                it->second.order = nextOrder_++;
+                it->second.timestampMs = rec.timestampMs;
+                it->second.copyCount = rec.count;
+                recency_[it->second.order] = rec.hash;
+            }
+        } else {
+            break;
+        }
+        pos = next;
+    }
+
+    tail_ = pos;
+    WriteHeader();
+    return true;
+}
+
+bool ClipboardHistoryStore::AppendRecord(std::uint8_t type, HistoryKind kind, std::uint64_t hash,
+                                         std::uint64_t timestampMs, std::uint32_t count, const void* payload,
+                                         std::uint32_t size, size_t* outOffset) {
+    size_t bytes = RecordBytes(size);
+    if (tail_ + bytes > file_.size()) return false;
+
+    RecordHeader rec;
+    std::memset(&rec, 0, sizeof(rec));
+    rec.magic = kRecordMagic;
+    rec.type = type;
+    rec.kind = static_cast<std::uint8_t>(kind);
+    rec.size = size;
+    rec.count = count;
+    rec.hash = hash;
+    rec.timestampMs = timestampMs;
+
+    std::uint8_t* dst = file_.data() + tail_;
+    if (size > 0) std::memcpy(dst + sizeof(rec), payload, size);
+    std::memcpy(dst, &rec, sizeof(rec));
+    if (outOffset) *outOffset = tail_;
+    tail_ += bytes;
+    // 先写记录、后推进文件头里的尾指针：中途崩溃最多丢掉最后一条
+    WriteHeader();
+    return true;
+}
+
+void ClipboardHistoryStore::Compact(size_t needBytes) {
+    // 按最近使用顺序保留较新的记录，直到占用不超过可用空间的一半（再加上即将写入的记录），
+    // 然后按旧 -> 新的顺序重写日志：重写后的日志本身就是最近顺序，Touch 记录被合并掉
+    size_t usable = file_.size() - kFileHeaderSize;
+    size_t budget = usable / 2;
+    budget = budget > needBytes ? budget - needBytes : 0;
+
+    std::vector<std::uint64_t> keep;
+    size_t kept = 0;
+    for (auto it = recency_.rbegin(); it != recency_.rend(); ++it) {
+        const IndexEntry& entry = index_.at(it->second);
+        size_t bytes = RecordBytes(entry.size);
+        if (kept + bytes > budget) break;
+        kept += bytes;
+        keep.push_back(it->second);
+    }
+
+    std::vector<std::uint8_t> staging(kept);
+    std::vector<std::pair<std::uint64_t, size_t>> offsets;  // hash -> 新偏移
+    offsets.reserve(keep.size());
+    size_t pos = 0;
+    for (auto it = keep.rbegin(); it != keep.rend(); ++it) {
+        const IndexEntry& entry = index_.at(*it);
+        size_t bytes = RecordBytes(entry.size);
+        std::memcpy(staging.data() + pos, file_.data() + entry.offset, sizeof(RecordHeader) + entry.size);
+        RecordHeader rec;
+        std::memcpy(&rec, staging.data() + pos, sizeof(rec));
+        rec.timestampMs = entry.timestampMs;
+        rec.count = entry.copyCount;
+        std::memcpy(staging.data() + pos, &rec, sizeof(rec));
+        offsets.emplace_back(*it, kFileHeaderSize + pos);
+        pos += bytes;
+    }
+
+    stats_.evicted += index_.size() - keep.size();
+    stats_.compactions++;
+
+    // 被淘汰条目的前缀索引键要从旧日志里读，必须在覆盖日志区之前移除
+    std::unordered_map<std::uint64_t, IndexEntry> survivors;
+    survivors.reserve(offsets.size());
+    for (const auto& kv : offsets) {
+        IndexEntry entry = index_.at(kv.first);
+        entry.offset = kv.second;
+        survivors.emplace(kv.first, entry);
+    }
+    for (const auto& kv : index_) {
+        if (survivors.count(kv.first) == 0) {
+            recency_.erase(kv.second.order);
+            UnindexText(kv.first, kv.second);
+        }
+    }
+    index_.swap(survivors);
+
+    // 先把尾指针收回到文件头，再覆盖日志区：覆盖过程中崩溃只会丢失历史，不会读到半条记录
+    tail_ = kFileHeaderSize;
+    WriteHeader();
+    if (!staging.empty()) std::memcpy(file_.data() + kFileHeaderSize, staging.data(), staging.size());
+    tail_ = kFileHeaderSize + staging.size();
+    WriteHeader();
+}
+
+std::uint64_t ClipboardHistoryStore::Insert(HistoryKind kind, const void* payload, size_t size,
+                                            std::uint64_t timestampMs, bool* isNew) {
+    if (isNew) *isNew = false;
+    if (!file_.IsOpen()) return 0;
+
+    std::uint64_t hash = HashPayload(kind, payload, size);
+    auto it = index_.find(hash);
+    if (it != index_.end()) {
+        // 去重命中：先在内存里把条目移到最前、刷新时间与次数，再追加一条无载荷的 Touch 记录。
+        // 日志已满时改为压缩：压缩按最近顺序保留并把时间与次数写回内容记录，命中的条目排在最前，不会被淘汰
+        IndexEntry& entry = it->second;
+        stats_.dedupHits++;
+        recency_.erase(entry.order);
+        entry.order = nextOrder_++;
+        entry.timestampMs = timestampMs;
+        entry.copyCount++;
+        recency_[entry.order] = hash;
+        if (AppendRecord(kRecordTouch, kind, hash, timestampMs, entry.copyCount, nullptr, 0, nullptr)) return hash;
+        Compact(0);
+        if (index_.count(hash) != 0) return hash;
+        // 条目大于压缩后的保留预算（旧文件里的超大记录）时仍会被淘汰：按新内容重新写入
+    }
+
+    // 单条超过容量 1/4 的内容（超大图像等）不进历史，避免一次插入就把其余记录全部挤掉
+    if (size > MaxPayloadBytes()) {
+        stats_.rejected++;
+        return 0;
+    }
+    size_t bytes = RecordBytes(size);
+
+    size_t offset = 0;
+    std::uint32_t size32 = static_cast<std::uint32_t>(size);
+    if (!AppendRecord(kRecordContent, kind, hash, timestampMs, 1, payload, size32, &offset)) {
+        Compact(bytes);
+        if (!AppendRecord(kRecordContent, kind, hash, timestampMs, 1, payload, size32, &offset)) return 0;
+    }
+
+    IndexEntry entry{offset, size32, kind, timestampMs, nextOrder_++, 1};
+    recency_[entry.order] = hash;
+    IndexText(hash, entry);
+    index_.emplace(hash, entry);
+    stats_.inserts++;
+    if (isNew) *isNew = true;
+    return hash;
+}
+
+size_t ClipboardHistoryStore::MaxPayloadBytes() const {
+    if (!file_.IsOpen()) return 0;
+    size_t budget = ((file_.size() - kFileHeaderSize) / 4) & ~(kRecordAlign - 1);
+    return budget > sizeof(RecordHeader) ? budget - sizeof(RecordHeader) : 0;
+}
+
+// ==================== 查询 ====================
+
+std::string ClipboardHistoryStore::TextKey(const IndexEntry& entry) const {
+    const char* text = reinterpret_cast<const char*>(file_.data() + entry.offset + sizeof(RecordHeader));
+    return std::string(text, (std::min)(static_cast<size_t>(entry.size), kTextKeyBytes));
+}
+
+void ClipboardHistoryStore::IndexText(std::uint64_t hash, const IndexEntry& entry) {
+    if (entry.kind != HistoryKind::Text) return;
+    textPrefix_.emplace(TextKey(entry), hash);
+}
+
+void ClipboardHistoryStore::UnindexText(std::uint64_t hash, const IndexEntry& entry) {
+    if (entry.kind != HistoryKind::Text) return;
+    auto range = textPrefix_.equal_range(TextKey(entry));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == hash) {
+            textPrefix_.erase(it);
+            return;
+        }
+    }
+}
+
+HistoryItem ClipboardHistoryStore::MakeItem(std::uint64_t hash, const IndexEntry& entry) const {
+    HistoryItem item;
+    item.hash = hash;
+    item.kind = entry.kind;
+    item.timestampMs = entry.timestampMs;
+    item.copyCount = entry.copyCount;
+    const char* payload = reinterpret_cast<const char*>(file_.data() + entry.offset + sizeof(RecordHeader));
+    item.payload.assign(payload, entry.size);
+    return item;
+}
+
+bool ClipboardHistoryStore::Get(std::uint64_t hash, HistoryItem& out) const {
+    auto it = index_.find(hash);
+    if (it == index_.end()) return false;
+    out = MakeItem(hash, it->second);
+    return true;
+}
+
+std::vector<HistoryItem> ClipboardHistoryStore::QueryRecent(size_t offset, size_t limit) const {
+    std::vector<HistoryItem> items;
+    if (offset >= recency_.size()) return items;
+    auto it = recency_.rbegin();
+    std::advance(it, offset);
+    for (; it != recency_.rend() && items.size() < limit; ++it) {
+        items.push_back(MakeItem(it->second, index_.at(it->second)));
+    }
+    return items;
+}
+
+std::vector<HistoryItem> ClipboardHistoryStore::QueryTimeRange(std::uint64_t fromMs, std::uint64_t toMs,
+                                                               size_t limit) const {
+    std::vector<HistoryItem> items;
+    for (auto it = recency_.rbegin(); it != recency_.rend() && items.size() < limit; ++it) {
+        const IndexEntry& entry = index_.at(it->second);
+        if (entry.timestampMs >= fromMs && entry.timestampMs <= toMs) items.push_back(MakeItem(it->second, entry));
+    }
+    return items;
+}
+
+std::vector<HistoryItem> ClipboardHistoryStore::QueryTextPrefix(const std::string& prefix, size_t limit) const {
+    // 前缀索引只保存文本前 kTextKeyBytes 字节：更长的前缀先按键范围粗筛，再对全文校验
+    std::string key = prefix.substr(0, kTextKeyBytes);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> matches;  // (order, hash)
+    for (auto it = textPrefix_.lower_bound(key); it != textPrefix_.end(); ++it) {
+        if (it->first.compare(0, key.size(), key) != 0) break;
+        const IndexEntry& entry = index_.at(it->second);
+        if (prefix.size() > kTextKeyBytes) {
+            const char* text = reinterpret_cast<const char*>(file_.data() + entry.offset + sizeof(RecordHeader));
+            if (entry.size < prefix.size() || std::memcmp(text, prefix.data(), prefix.size()) != 0) continue;
+        }
+        matches.emplace_back(entry.order, it->second);
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const std::pair<std::uint64_t, std::uint64_t>& a, const std::pair<std::uint64_t, std::uint64_t>& b) {
+                  return a.first > b.first;
+              });
+
+    std::vector<HistoryItem> items;
+    for (size_t i = 0; i < matches.size() && items.size() < limit; i++) {
+        items.push_back(MakeItem(matches[i].second, index_.at(matches[i].second)));
+    }
+    return items;
+}
+
+}  // namespace ztools
@@ -0,0 +1,117 @@
+#pragma once
+
+// 内容寻址的剪贴板历史存储（平台无关）
+// - 每条记录以规范化后内容的 XXH64 为键，重复复制同一内容只刷新时间（去重）；
+// - 记录追加写入固定容量的内存映射日志，重启时顺序扫描日志重建内存索引；
+// - 日志写满时按最近使用顺序保留较新的记录并原地压缩（容量上限内淘汰最旧内容）；
+// - 支持按最近顺序分页、按时间范围、按文本前缀查询。
+
+#include "clipboard_snapshot.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ztools {
+
+enum class HistoryKind : std::uint16_t {
+    Text = 1,   // UTF-8，换行统一为 \n
+    Files = 2,  // UTF-8 路径，\n 分隔
+    Image = 3   // CF_DIB 原始字节（BITMAPINFOHEADER + 像素）
+};
+
+struct HistoryItem {
+    std::uint64_t hash = 0;
+    HistoryKind kind = HistoryKind::Text;
+    std::uint64_t timestampMs = 0;  // 最近一次出现的时间
+    std::uint32_t copyCount = 0;    // 出现次数（含去重命中）
+    std::string payload;
+};
+
+struct ClipboardHistoryOptions {
+    std::string path;                          // 为空时只保存在内存
+    size_t capacityBytes = 64 * 1024 * 1024;   // 日志文件总大小（已有文件更大时沿用文件大小，不截断）
+};
+
+struct ClipboardHistoryStats {
+    std::uint64_t inserts = 0;
+    std::uint64_t dedupHits = 0;
+    std::uint64_t evicted = 0;
+    std::uint64_t compactions = 0;
+    std::uint64_t rejected = 0;  // 单条超过容量 1/4 而拒收
+};
+
+class ClipboardHistoryStore {
+public:
+    bool Open(const ClipboardHistoryOptions& options);
+    void Close();
+    bool IsOpen() const { return file_.IsOpen(); }
+
+    // 插入一条记录，返回内容哈希；内容已存在时只刷新时间戳并把它移到最前（isNew = false）
+    std::uint64_t Insert(HistoryKind kind, const void* payload, size_t size, std::uint64_t timestampMs,
+                         bool* isNew = nullptr);
+
+    bool Get(std::uint64_t hash, HistoryItem& out) const;
+    bool Contains(std::uint64_t hash) const { return index_.count(hash) != 0; }
+
+    // 按最近使用顺序（新 -> 旧）分页
+    std::vector<HistoryItem> QueryRecent(size_t offset, size_t limit) const;
+    // 时间范围 [fromMs, toMs]，新 -> 旧
+    std::vector<HistoryItem> QueryTimeRange(std::uint64_t fromMs, std::uint64_t toMs, size_t limit) const;
+    // 文本内容以 prefix 开头的记录，新 -> 旧
+    std::vector<HistoryItem> QueryTextPrefix(const std::string& prefix, size_t limit) const;
+
+    void Clear();
+    void Flush() { file_.Flush(); }
+
+    size_t Count() const { return index_.size(); }
+    size_t UsedBytes() const { return tail_; }
+    size_t CapacityBytes() const { return file_.size(); }
+    // 单条内容的字节上限（容量的 1/4 扣除记录头），超过的 Insert 会被拒收
+    size_t MaxPayloadBytes() const;
+    const ClipboardHistoryStats& stats() const { return stats_; }
+
+private:
+    struct IndexEntry {
+        size_t offset;               // 内容记录在日志中的偏移
+        std::uint32_t size;
+        HistoryKind kind;
+        std::uint64_t timestampMs;
+        std::uint64_t order;         // 最近使用序号，越大越新
+        std::uint32_t copyCount;
+    };
+
+    bool AppendRecord(std::uint8_t type, HistoryKind kind, std::uint64_t hash, std::uint64_t timestampMs,
+                      std::uint32_t count, const void* payload, std::uint32_t size, size_t* outOffset);
+    void Compact(size_t needBytes);
+    bool LoadExisting();
+    void WriteHeader();
+    void IndexText(std::uint64_t hash, const IndexEntry& entry);
+    void UnindexText(std::uint64_t hash, const IndexEntry& entry);
+    std::string TextKey(const IndexEntry& entry) const;
+    HistoryItem MakeItem(std::uint64_t hash, const IndexEntry& entry) const;
+
+    MappedFile file_;
+    size_t tail_ = 0;  // 下一条记录的写入偏移
+    std::uint64_t nextOrder_ = 1;
+    std::unordered_map<std::uint64_t, IndexEntry> index_;
+    std::map<std::uint64_t, std::uint64_t> recency_;           // order -> hash
+    std::multimap<std::string, std::uint64_t> textPrefix_;     // 文本前若干字节 -> hash
+    ClipboardHistoryStats stats_;
+};
+
+// 把 CF_UNICODETEXT 的 UTF-16LE 字节转成规范化 UTF-8（\r\n -> \n，去掉结尾 NUL）
+std::string NormalizeClipboardText(const std::uint8_t* data, size_t size);
+// 把 CF_HDROP 的 DROPFILES 转成 \n 分隔的 UTF-8 路径列表
+std::string NormalizeDropFiles(const std::uint8_t* data, size_t size);
+
+// 从已打开的剪贴板取出历史记录内容：文件 > 文本 > 图像；没有可记录内容时返回 false。
+// 超过 maxBytes（传 MaxPayloadBytes()）的格式在复制前就跳过，不在剪贴板打开期间白拷一份大图
+bool ExtractHistoryPayload(ClipboardBackend& backend, const std::vector<std::uint32_t>& formats, size_t maxBytes,
+                           HistoryKind& kind, std::string& payload);
+
+}  // namespace ztools
@@ -0,0 +1,74 @@
+#include "clipboard_image.h"
+
+#include <cstring>
+
+namespace ztools {
+
+const char* const kPngClipboardFormatName = "PNG";
+
+namespace {
+
+const std::uint32_t kBiBitfields = 3;
+const std::uint32_t kLcsSRgb = 0x73524742;  // 'sRGB'
+const std::uint32_t kLcsGmImages = 4;
+
+void PutU16(std::uint8_t* p, std::uint16_t v) {
+    p[0] = static_cast<std::uint8_t>(v);
+    p[1] = static_cast<std::uint8_t>(v >> 8);
+}
+
+void PutU32(std::uint8_t* p, std::uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+}  // namespace
+
+size_t DibV5ByteSize(int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    return kDibV5HeaderSize + static_cast<size_t>(width) * height * 4;
+}
+
+bool WriteDibV5(const ImageView& image, DibAlpha alpha, std::uint8_t* dst, size_t size) {
+    const size_t total = DibV5ByteSize(image.width, image.height);
+    if (image.Empty() || total == 0 || !dst || size < total) return false;
+
+    // BITMAPV5HEADER：未列出的字段（分辨率、调色板、端点、伽马、配置文件）均为 0
+    std::uint8_t* h = dst;
+    std::memset(h, 0, kDibV5HeaderSize);
+    PutU32(h + 0, static_cast<std::uint32_t>(kDibV5HeaderSize));
+    PutU32(h + 4, static_cast<std::uint32_t>(image.width));
+    PutU32(h + 8, static_cast<std::uint32_t>(image.height));  // 正数：自下而上，兼容只认底朝上 DIB 的程序
+    PutU16(h + 12, 1);
+    PutU16(h + 14, 32);
+    PutU32(h + 16, kBiBitfields);
+    PutU32(h + 20, static_cast<std::uint32_t>(total - kDibV5HeaderSize));
+    PutU32(h + 40, 0x00FF0000);  // R
+    PutU32(h + 44, 0x0000FF00);  // G
+    PutU32(h + 48, 0x000000FF);  // B
+    PutU32(h + 52, 0xFF000000);  // A
+    PutU32(h + 56, kLcsSRgb);
+    PutU32(h + 108, kLcsGmImages);
+
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    std::uint8_t* pixels = dst + kDibV5HeaderSize;
+    for (int y = 0; y < image.height; y++) {
+        std::uint8_t* out = pixels + rowBytes * (image.height - 1 - y);
+        const std::uint32_t* in = image.Row(y);
+        if (alpha == DibAlpha::Keep) {
+            std::memcpy(out, in, rowBytes);
+            continue;
+        }
+        // 复制时顺带置 alpha，编译器会把这个循环向量化
+        std::uint32_t* o = reinterpret_cast<std::uint32_t*>(out);
+        for (int x = 0; x < image.width; x++) o[x] = in[x] | 0xFF000000u;
+    }
+    return true;
+}
+
+std::vector<std::uint8_t> BuildDibV5(const ImageView& image, DibAlpha alpha) {
+    std::vector<std::uint8_t> out(DibV5ByteSize(image.width, image.height));
+    if (!out.empty() && !WriteDibV5(image, alpha, out.data(), out.size())) out.clear();
+    return out;
+}
+
+}  // namespace ztools
@@ -0,0 +1,35 @@
+#pragma once
+
+// 截图写入剪贴板的图像负载（平台无关）
+// CF_DIBV5 = BITMAPV5HEADER（124 字节，BI_BITFIELDS，BGRA 掩码，sRGB）+ 自下而上的 32bpp 像素行，
+// 直接从成品像素逐行复制生成，可写进调用方提供的内存（Win32 为 GlobalLock 得到的 HGLOBAL），
+// 整个过程只有这一次复制；CF_DIB / CF_BITMAP 由系统按需从 CF_DIBV5 合成。
+// 另以注册格式 "PNG" 提供编码好的 PNG 字节（浏览器、Office 等优先读取）；截图按 32bppRGB 编码，PNG 与 DIBV5 一样是不透明的。
+
+#include "raster.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+// 注册剪贴板格式名（RegisterClipboardFormat）
+extern const char* const kPngClipboardFormatName;
+
+constexpr size_t kDibV5HeaderSize = 124;
+
+enum class DibAlpha {
+    Opaque,  // alpha 一律写 255（GDI 绘制后的 alpha 字节无定义，截图按不透明发布）
+    Keep,    // 原样保留 alpha
+};
+
+// 整个 CF_DIBV5 负载的字节数；图像为空时返回 0
+size_t DibV5ByteSize(int width, int height);
+
+// 写出 CF_DIBV5 负载到 dst（至少 DibV5ByteSize 字节）；图像为空或空间不足时返回 false
+bool WriteDibV5(const ImageView& image, DibAlpha alpha, std::uint8_t* dst, size_t size);
+
+std::vector<std::uint8_t> BuildDibV5(const ImageView& image, DibAlpha alpha);
+
+}  // namespace ztools
@@ -0,0 +1,178 @@
+#include "clipboard_snapshot.h"
+
+#include "content_hash.h"
+
+#include <cstring>
+#include <utility>
+
+namespace ztools {
+
+namespace {
+
+const std::uint32_t kSnapshotMagic = 0x50534E5A;  // "ZNSP"
+const std::uint32_t kSnapshotVersion = 1;
+
+void PutU32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    std::uint8_t b[4];
+    std::memcpy(b, &v, 4);
+    out.insert(out.end(), b, b + 4);
+}
+
+void PutU64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    std::uint8_t b[8];
+    std::memcpy(b, &v, 8);
+    out.insert(out.end(), b, b + 8);
+}
+
+bool GetU32(const std::uint8_t*& p, const std::uint8_t* end, std::uint32_t& v) {
+    if (end - p < 4) return false;
+    std::memcpy(&v, p, 4);
+    p += 4;
+    return true;
+}
+
+bool GetU64(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+    if (end - p < 8) return false;
+    std::memcpy(&v, p, 8);
+    p += 8;
+    return true;
+}
+
+}  // namespace
+
+bool ClipboardSnapshot::Capture(ClipboardBackend& backend) {
+    Clear();
+    if (!backend.Open()) return false;
+
+    std::vector<std::uint32_t> formats = backend.EnumFormats();
+    entries_.reserve(formats.size());
+    for (std::uint32_t format : formats) {
+        const std::uint8_t* data = nullptr;
+        size_t size = 0;
+        if (!backend.ReadFormat(format, data, size)) continue;
+        entries_.push_back(Entry{format, arena_.size(), size});
+        if (size > 0) arena_.insert(arena_.end(), data, data + size);
+        backend.ReleaseFormat(format);
+    }
+
+    backend.Close();
+    Rehash();
+    return true;
+}
+
+bool ClipboardSnapshot::Restore(ClipboardBackend& backend) const {
+    if (!backend.Open()) return false;
+
+    bool ok = backend.EmptyClipboard();
+    for (const Entry& e : entries_) {
+        if (!backend.WriteFormat(e.format, arena_.data() + e.offset, e.size)) {
+            ok = false;
+        }
+    }
+
+    backend.Close();
+    return ok;
+}
+
+void ClipboardSnapshot::Clear() {
+    entries_.clear();
+    arena_.clear();
+    hash_ = 0;
+}
+
+const ClipboardSnapshot::Entry* ClipboardSnapshot::Find(std::uint32_t format) const {
+    for (const Entry& e : entries_) {
+        if (e.format == format) return &e;
+    }
+    return nullptr;
+}
+
+bool ClipboardSnapshot::SameContentAs(const ClipboardSnapshot& other) const {
+    return hash_ == other.hash_ && entries_.size() == other.entries_.size() && arena_.size() == other.arena_.size();
+}
+
+void ClipboardSnapshot::Append(std::uint32_t format, const std::uint8_t* data, size_t size) {
+    entries_.push_back(Entry{format, arena_.size(), size});
+    if (size > 0) arena_.insert(arena_.end(), data, data + size);
+    Rehash();
+}
+
+void ClipboardSnapshot::Rehash() {
+    ContentHasher hasher;
+    for (const Entry& e : entries_) {
+        hasher.UpdateU32(e.format);
+        hasher.UpdateU64(e.size);
+        hasher.Update(arena_.data() + e.offset, e.size);
+    }
+    hash_ = hasher.Digest();
+}
+
+std::vector<std::uint8_t> ClipboardSnapshot::Serialize() const {
+    std::vector<std::uint8_t> out;
+    out.reserve(24 + entries_.size() * 12 + arena_.size());
+    PutU32(out, kSnapshotMagic);
+    PutU32(out, kSnapshotVersion);
+    PutU32(out, static_cast<std::uint32_t>(entries_.size()));
+    PutU64(out, hash_);
+    for (const Entry& e : entries_) {
+        PutU32(out, e.format);
+        PutU64(out, e.size);
+    }
+    out.insert(out.end(), arena_.begin(), arena_.end());
+    return out;
+}
+
+bool ClipboardSnapshot::Deserialize(const std::uint8_t* data, size_t size) {
+    Clear();
+    const std::uint8_t* p = data;
+    const std::uint8_t* end = data + size;
+
+    std::uint32_t magic = 0, version = 0, count = 0;
+    std::uint64_t hash = 0;
+    if (!GetU32(p, end, magic) || magic != kSnapshotMagic) return false;
+    if (!GetU32(p, end, version) || version != kSnapshotVersion) return false;
+    if (!GetU32(p, end, count) || !GetU64(p, end, hash)) return false;
+    if (static_cast<size_t>(end - p) / 12 < count) return false;
+
+    std::vector<Entry> entries;
+    entries.reserve(count);
+    size_t offset = 0;
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::uint32_t format = 0;
+        std::uint64_t entrySize = 0;
+        if (!GetU32(p, end, format) || !GetU64(p, end, entrySize)) return false;
+        entries.push_back(Entry{format, offset, static_cast<size_t>(entrySize)});
+        offset += static_cast<size_t>(entrySize);
+    }
+    if (static_cast<size_t>(end - p) != offset) return false;
+
+    entries_ = std::move(entries);
+    arena_.assign(p, end);
+    Rehash();
+    if (hash_ != hash) {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+bool HashClipboard(ClipboardBackend& backend, std::uint64_t& outHash) {
+    if (!backend.Open()) return false;
+
+    ContentHasher hasher;
+    for (std::uint32_t format : backend.EnumFormats()) {
+        const std::uint8_t* data = nullptr;
+        size_t size = 0;
+        if (!backend.ReadFormat(format, data, size)) continue;
+        hasher.UpdateU32(format);
+        hasher.UpdateU64(size);
+        hasher.Update(data, size);
+        backend.ReleaseFormat(format);
+    }
+
+    backend.Close();
+    outHash = hasher.Digest();
+    return true;
+}
+
+}  // namespace ztools
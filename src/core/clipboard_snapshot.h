@@ -0,0 +1,76 @@
+#pragma once
+
+// 剪贴板原始快照（平台无关）
+// 按 EnumClipboardFormats 的顺序把每个格式的原始字节复制进同一块 arena，恢复时逐字节写回，
+// 不做任何解码/重新编码（图像不再经过 PNG + base64 往返），是否变化用内容哈希判断。
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ztools {
+
+// 剪贴板访问后端：Win32 实现基于 OpenClipboard/EnumClipboardFormats/GlobalLock，测试用假剪贴板。
+// ReadFormat/WriteFormat/EnumFormats 只能在 Open 成功之后、Close 之前调用。
+class ClipboardBackend {
+public:
+    virtual ~ClipboardBackend() = default;
+
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    virtual std::vector<std::uint32_t> EnumFormats() = 0;
+    // 注册格式的名称（RegisterClipboardFormat 时的名字）；预定义格式可返回空串
+    virtual std::string FormatName(std::uint32_t /*format*/) { return std::string(); }
+    // 取得格式的原始字节（指针在 ReleaseFormat 前有效）；无法按字节表示的格式返回 false
+    virtual bool ReadFormat(std::uint32_t format, const std::uint8_t*& data, size_t& size) = 0;
+    virtual void ReleaseFormat(std::uint32_t format) = 0;
+
+    virtual bool EmptyClipboard() = 0;
+    virtual bool WriteFormat(std::uint32_t format, const std::uint8_t* data, size_t size) = 0;
+};
+
+class ClipboardSnapshot {
+public:
+    struct Entry {
+        std::uint32_t format;
+        size_t offset;  // arena 内偏移
+        size_t size;
+    };
+
+    // 打开剪贴板并复制所有可按字节表示的格式；打不开剪贴板时返回 false
+    bool Capture(ClipboardBackend& backend);
+    // 清空剪贴板并按原顺序写回全部格式；空快照会把剪贴板恢复为空
+    bool Restore(ClipboardBackend& backend) const;
+
+    void Clear();
+    bool Empty() const { return entries_.empty(); }
+    size_t ByteSize() const { return arena_.size(); }
+    const std::vector<Entry>& entries() const { return entries_; }
+    const std::uint8_t* Data(const Entry& e) const { return arena_.data() + e.offset; }
+    const Entry* Find(std::uint32_t format) const;
+
+    // 覆盖所有 (格式, 长度, 字节) 的内容哈希，Capture 时计算
+    std::uint64_t Hash() const { return hash_; }
+    bool SameContentAs(const ClipboardSnapshot& other) const;
+
+    // 序列化为单块字节：魔数 | 版本 | 条目数 | 哈希 | 条目表 (format, size) | arena
+    std::vector<std::uint8_t> Serialize() const;
+    bool Deserialize(const std::uint8_t* data, size_t size);
+
+    // 供测试/外部构造快照时追加条目（会更新哈希）
+    void Append(std::uint32_t format, const std::uint8_t* data, size_t size);
+
+private:
+    void Rehash();
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint8_t> arena_;
+    std::uint64_t hash_ = 0;
+};
+
+// 不复制数据、直接流式计算当前剪贴板的内容哈希，结果与 ClipboardSnapshot::Capture 后的 Hash() 一致
+bool HashClipboard(ClipboardBackend& backend, std::uint64_t& outHash);
+
+}  // namespace ztools
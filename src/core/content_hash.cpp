@@ -0,0 +1,130 @@
+#include "content_hash.h"
+
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+const std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+const std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+const std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t Rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t Read64(const std::uint8_t* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t Read32(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t Round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * kPrime2;
+    acc = Rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline std::uint64_t MergeRound(std::uint64_t acc, std::uint64_t val) {
+    acc ^= Round(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+std::uint64_t Finalize(std::uint64_t h, const std::uint8_t* p, size_t len) {
+    while (len >= 8) {
+        h ^= Round(0, Read64(p));
+        h = Rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+        len -= 8;
+    }
+    if (len >= 4) {
+        h ^= static_cast<std::uint64_t>(Read32(p)) * kPrime1;
+        h = Rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        h ^= (*p) * kPrime5;
+        h = Rotl(h, 11) * kPrime1;
+        p++;
+        len--;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+}  // namespace
+
+std::uint64_t HashBytes(const void* data, size_t size, std::uint64_t seed) {
+    ContentHasher hasher(seed);
+    hasher.Update(data, size);
+    return hasher.Digest();
+}
+
+ContentHasher::ContentHasher(std::uint64_t seed) : seed_(seed) {
+    acc_[0] = seed + kPrime1 + kPrime2;
+    acc_[1] = seed + kPrime2;
+    acc_[2] = seed;
+    acc_[3] = seed - kPrime1;
+}
+
+void ContentHasher::Update(const void* data, size_t size) {
+    const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
+    total_ += size;
+
+    if (buffered_ + size < 32) {
+        if (size > 0) std::memcpy(buffer_ + buffered_, p, size);
+        buffered_ += size;
+        return;
+    }
+
+    if (buffered_ > 0) {
+        size_t fill = 32 - buffered_;
+        std::memcpy(buffer_ + buffered_, p, fill);
+        for (int i = 0; i < 4; i++) acc_[i] = Round(acc_[i], Read64(buffer_ + i * 8));
+        p += fill;
+        size -= fill;
+        buffered_ = 0;
+    }
+
+    while (size >= 32) {
+        acc_[0] = Round(acc_[0], Read64(p));
+        acc_[1] = Round(acc_[1], Read64(p + 8));
+        acc_[2] = Round(acc_[2], Read64(p + 16));
+        acc_[3] = Round(acc_[3], Read64(p + 24));
+        p += 32;
+        size -= 32;
+    }
+
+    if (size > 0) {
+        std::memcpy(buffer_, p, size);
+        buffered_ = size;
+    }
+}
+
+std::uint64_t ContentHasher::Digest() const {
+    std::uint64_t h;
+    if (total_ >= 32) {
+        h = Rotl(acc_[0], 1) + Rotl(acc_[1], 7) + Rotl(acc_[2], 12) + Rotl(acc_[3], 18);
+        for (int i = 0; i < 4; i++) h = MergeRound(h, acc_[i]);
+    } else {
+        h = seed_ + kPrime5;
+    }
+    h += total_;
+    return Finalize(h, buffer_, buffered_);
+}
+
+}  // namespace ztools
@@ -0,0 +1,31 @@
+#pragma once
+
+// 快速内容哈希（XXH64 算法，平台无关）
+// 用于剪贴板快照比较、变化去重等场景：只判断"是否相同"，不用于安全用途。
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ztools {
+
+std::uint64_t HashBytes(const void* data, size_t size, std::uint64_t seed = 0);
+
+// 流式哈希：多段数据按顺序喂入，结果与把它们拼接后一次性 HashBytes 相同
+class ContentHasher {
+public:
+    explicit ContentHasher(std::uint64_t seed = 0);
+
+    void Update(const void* data, size_t size);
+    void UpdateU32(std::uint32_t v) { Update(&v, sizeof(v)); }
+    void UpdateU64(std::uint64_t v) { Update(&v, sizeof(v)); }
+    std::uint64_t Digest() const;
+
+private:
+    std::uint64_t acc_[4];
+    std::uint8_t buffer_[32];
+    size_t buffered_ = 0;
+    std::uint64_t total_ = 0;
+    std::uint64_t seed_;
+};
+
+}  // namespace ztools
@@ -0,0 +1,146 @@
+#include "damage.h"
+
+#include <algorithm>
+
+namespace ztools {
+
+namespace {
+
+std::int64_t AreaOf(const IntRect& r) {
+    return r.Empty() ? 0 : static_cast<std::int64_t>(r.w) * r.h;
+}
+
+}  // namespace
+
+void DamageTracker::Reset(const IntRect& bounds) {
+    canvas_ = bounds;
+    rects_.clear();
+}
+
+void DamageTracker::Add(const IntRect& rect) {
+    IntRect r = rect.Intersect(canvas_);
+    if (r.Empty() || Full()) return;
+    Insert(r);
+    EnforceLimit();
+    if (Area() * 100 >= AreaOf(canvas_) * kFullPercent) AddAll();
+}
+
+void DamageTracker::AddAll() {
+    rects_.clear();
+    if (!canvas_.Empty()) rects_.push_back(canvas_);
+}
+
+IntRect DamageTracker::Bounds() const {
+    IntRect b;
+    for (const IntRect& r : rects_) b = b.Union(r);
+    return b;
+}
+
+std::int64_t DamageTracker::Area() const {
+    std::int64_t sum = 0;
+    for (const IntRect& r : rects_) sum += AreaOf(r);
+    return sum;
+}
+
+void DamageTracker::Insert(IntRect r) {
+    // 1) 吸收：合成外包矩形多重绘的面积小就合并，并从头再比（外包矩形可能碰到更多矩形）
+    for (size_t i = 0; i < rects_.size();) {
+        const IntRect e = rects_[i];
+        IntRect overlap = e.Intersect(r);
+        if (overlap == r) return;  // 已被覆盖
+        std::int64_t covered = AreaOf(e) + AreaOf(r) - AreaOf(overlap);
+        std::int64_t waste = AreaOf(e.Union(r)) - covered;
+        if (overlap == e || waste <= kSmallWaste || waste * 4 <= covered) {
+            r = e.Union(r);
+            rects_.erase(rects_.begin() + i);
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+    // 2) 仍部分相交的（如选区边框的横、竖边带）不宜合并：从 r 中切掉，剩余各块直接登记
+    std::vector<IntRect> pieces(1, r), next;
+    for (const IntRect& e : rects_) {
+        if (e.Intersect(r).Empty()) continue;
+        next.clear();
+        for (const IntRect& p : pieces) SubtractRect(p, e, next);
+        pieces.swap(next);
+    }
+    rects_.insert(rects_.end(), pieces.begin(), pieces.end());
+}
+
+void DamageTracker::EnforceLimit() {
+    while (static_cast<int>(rects_.size()) > maxRects_) {
+        size_t bestA = 0, bestB = 1;
+        std::int64_t bestWaste = -1;
+        for (size_t a = 0; a < rects_.size(); a++) {
+            for (size_t b = a + 1; b < rects_.size(); b++) {
+                std::int64_t waste = AreaOf(rects_[a].Union(rects_[b])) - AreaOf(rects_[a]) - AreaOf(rects_[b]);
+                if (bestWaste < 0 || waste < bestWaste) {
+                    bestWaste = waste;
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+        IntRect u = rects_[bestA].Union(rects_[bestB]);
+        rects_.erase(rects_.begin() + bestB);
+        rects_.erase(rects_.begin() + bestA);
+        // 外包矩形会盖住别的矩形：一并吸收，保持两两不相交（每轮矩形数严格减少）
+        for (size_t i = 0; i < rects_.size();) {
+            if (!rects_[i].Intersect(u).Empty()) {
+                u = u.Union(rects_[i]);
+                rects_.erase(rects_.begin() + i);
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        rects_.push_back(u);
+    }
+}
+
+void SubtractRect(const IntRect& rect, const IntRect& hole, std::vector<IntRect>& out) {
+    if (rect.Empty()) return;
+    IntRect ov = rect.Intersect(hole);
+    if (ov.Empty()) {
+        out.push_back(rect);
+        return;
+    }
+    if (ov.y > rect.y) out.push_back(IntRect(rect.x, rect.y, rect.w, ov.y - rect.y));
+    if (ov.Bottom() < rect.Bottom()) out.push_back(IntRect(rect.x, ov.Bottom(), rect.w, rect.Bottom() - ov.Bottom()));
+    if (ov.x > rect.x) out.push_back(IntRect(rect.x, ov.y, ov.x - rect.x, ov.h));
+    if (ov.Right() < rect.Right()) out.push_back(IntRect(ov.Right(), ov.y, rect.Right() - ov.Right(), ov.h));
+}
+
+void AddRectChange(DamageTracker& damage, const IntRect& before, const IntRect& after, int edge) {
+    if (before == after) return;
+    std::vector<IntRect> parts;
+    SubtractRect(before, after, parts);
+    SubtractRect(after, before, parts);
+    if (edge > 0) {
+        const IntRect* frames[2] = {&before, &after};
+        for (const IntRect* f : frames) {
+            if (f->Empty()) continue;
+            IntRect outer(f->x - edge, f->y - edge, f->w + 2 * edge, f->h + 2 * edge);
+            IntRect inner(f->x + edge, f->y + edge, f->w - 2 * edge, f->h - 2 * edge);
+            if (inner.Empty()) {
+                parts.push_back(outer);
+            } else {
+                SubtractRect(outer, inner, parts);
+            }
+        }
+    }
+    for (const IntRect& p : parts) damage.Add(p);
+}
+
+void RepaintMeter::Record(const DamageTracker& damage) {
+    if (!active_) return;
+    stats_.frames++;
+    if (damage.Full()) stats_.fullFrames++;
+    stats_.maxRects = (std::max)(stats_.maxRects, static_cast<int>(damage.Rects().size()));
+    stats_.paintedPixels += damage.Area();
+    stats_.canvasPixels += AreaOf(damage.canvas());
+}
+
+}  // namespace ztools
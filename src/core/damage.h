@@ -0,0 +1,88 @@
+#pragma once
+
+// 覆盖层重绘的损伤区域追踪（平台无关）：一帧内各处交互上报的脏矩形集中累积在矩形列表里。
+// 上报时先裁剪到画布；被已有矩形包含的直接丢弃，包含已有矩形的替换之；
+// 合并后多出的面积很小（相邻 / 贴边）就合成外包矩形，否则与已有矩形相交的部分被切掉，
+// 列表中的矩形始终两两不相交，Area() 就是本帧实际要重绘的像素数。
+// 矩形数超过上限时合并浪费面积最小的一对；总面积接近整个画布时退化为整屏一块。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+class DamageTracker {
+public:
+    static constexpr int kDefaultMaxRects = 16;
+    static constexpr int kSmallWaste = 64 * 64;  // 合并多出的面积不超过此值时总是合并（省一次拷贝的开销）
+    static constexpr int kFullPercent = 75;      // 总面积达到画布的这个百分比时改为整屏
+
+    DamageTracker() = default;  // 非 explicit：宿主结构体会用 `= {}` 聚合初始化
+    explicit DamageTracker(int maxRects) : maxRects_(maxRects > 0 ? maxRects : 1) {}
+
+    // 设置画布范围并清空
+    void Reset(const IntRect& bounds);
+    const IntRect& canvas() const { return canvas_; }
+
+    void Add(const IntRect& rect);
+    void AddAll();
+    void Clear() { rects_.clear(); }
+
+    bool Empty() const { return rects_.empty(); }
+    bool Full() const { return rects_.size() == 1 && rects_[0] == canvas_; }
+    const std::vector<IntRect>& Rects() const { return rects_; }
+    IntRect Bounds() const;
+    std::int64_t Area() const;
+
+private:
+    void Insert(IntRect rect);
+    void EnforceLimit();
+
+    IntRect canvas_;
+    std::vector<IntRect> rects_;
+    int maxRects_ = kDefaultMaxRects;
+};
+
+// rect 减去 hole 后剩下的部分（最多 4 块：上、下整行带，中间左、右两段），写入 out（不清空）
+void SubtractRect(const IntRect& rect, const IntRect& hole, std::vector<IntRect>& out);
+
+// 矩形从 before 变为 after（拖出 / 移动 / 缩放选区）时上报的损伤：
+// 两者的对称差（遮罩明暗翻转的部分）+ 新旧矩形四条边内外各 edge 像素的边带（边框、手柄）。
+// 重叠区内部画面不变，不上报。
+void AddRectChange(DamageTracker& damage, const IntRect& before, const IntRect& after, int edge);
+
+// 单次交互（一次按下到松开）的重绘量统计
+struct RepaintStats {
+    int frames = 0;
+    int fullFrames = 0;
+    int maxRects = 0;               // 单帧最多的矩形数
+    std::int64_t paintedPixels = 0; // 实际重绘像素累计
+    std::int64_t canvasPixels = 0;  // 每帧都整屏重绘时的像素累计
+
+    // 实际重绘占整屏重绘的比例（0..1），没有帧时为 0
+    double Coverage() const { return canvasPixels > 0 ? double(paintedPixels) / double(canvasPixels) : 0.0; }
+};
+
+class RepaintMeter {
+public:
+    void Begin() {
+        stats_ = RepaintStats();
+        active_ = true;
+    }
+    bool Active() const { return active_; }
+    // 记录一帧（未 Begin 时忽略）
+    void Record(const DamageTracker& damage);
+    RepaintStats End() {
+        active_ = false;
+        return stats_;
+    }
+    const RepaintStats& stats() const { return stats_; }
+
+private:
+    RepaintStats stats_;
+    bool active_ = false;
+};
+
+}  // namespace ztools
@@ -0,0 +1,89 @@
+#include "deadline_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ztools {
+
+DeadlineScheduler::TimerId DeadlineScheduler::Schedule(TimePoint deadline) {
+    TimerId id = nextId_++;
+    auto pos = std::upper_bound(entries_.begin(), entries_.end(), deadline,
+                                [](TimePoint d, const Entry& e) { return d < e.deadline; });
+    entries_.insert(pos, Entry{deadline, id});
+    return id;
+}
+
+bool DeadlineScheduler::Cancel(TimerId id) {
+    auto it = std::find_if(entries_.begin(), entries_.end(), [id](const Entry& e) { return e.id == id; });
+    if (it == entries_.end()) return false;
+    entries_.erase(it);
+    return true;
+}
+
+void DeadlineScheduler::Clear() {
+    entries_.clear();
+}
+
+std::optional<DeadlineScheduler::TimePoint> DeadlineScheduler::NextDeadline() const {
+    if (entries_.empty()) return std::nullopt;
+    return entries_.front().deadline;
+}
+
+std::optional<DeadlineScheduler::Duration> DeadlineScheduler::TimeUntilNext(TimePoint now) const {
+    if (entries_.empty()) return std::nullopt;
+    TimePoint deadline = entries_.front().deadline;
+    return deadline > now ? deadline - now : Duration::zero();
+}
+
+std::uint32_t ToWaitMilliseconds(const std::optional<DeadlineScheduler::Duration>& remaining) {
+    if (!remaining) return std::numeric_limits<std::uint32_t>::max();
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(*remaining).count();
+    if (ms <= 0) return 0;
+    // 不能等于 INFINITE，否则一个很远的截止时间会变成永久等待
+    const long long cap = std::numeric_limits<std::uint32_t>::max() - 1;
+    return static_cast<std::uint32_t>(std::min<long long>(ms, cap));
+}
+
+void LongPressDetector::OnPress(TimePoint now) {
+    if (pending_ != 0) {
+        scheduler_.Cancel(pending_);
+        pending_ = 0;
+    }
+    pressed_ = true;
+    triggered_ = false;
+    if (threshold_ > Duration::zero()) {
+        pending_ = scheduler_.Schedule(now + threshold_);
+    }
+}
+
+bool LongPressDetector::OnRelease() {
+    if (pending_ != 0) {
+        scheduler_.Cancel(pending_);
+        pending_ = 0;
+    }
+    pressed_ = false;
+    return triggered_;
+}
+
+bool LongPressDetector::OnTimer(TimePoint now) {
+    bool fired = false;
+    scheduler_.PopExpired(now, [&](DeadlineScheduler::TimerId id) {
+        if (id == pending_) {
+            pending_ = 0;
+            if (pressed_ && !triggered_) {
+                triggered_ = true;
+                fired = true;
+            }
+        }
+    });
+    return fired;
+}
+
+void LongPressDetector::Reset() {
+    scheduler_.Clear();
+    pending_ = 0;
+    pressed_ = false;
+    triggered_ = false;
+}
+
+}  // namespace ztools
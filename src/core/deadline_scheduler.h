@@ -0,0 +1,94 @@
+#pragma once
+
+// 截止时间调度核心（平台无关）
+// 不持有线程与时钟：调用方在自己的等待循环里（Win32 为可等待定时器 + MsgWaitForMultipleObjects）
+// 传入当前时间驱动，因此可以在 Linux 上用假时钟做确定性测试。
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ztools {
+
+// 一次性截止时间队列：按 (deadline, id) 有序，空闲时 TimeUntilNext 返回 nullopt，调用方应无限等待。
+class DeadlineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+    using TimerId = std::uint64_t;
+
+    // 安排一个截止时间，返回非 0 的 id
+    TimerId Schedule(TimePoint deadline);
+    // 取消指定 id，返回是否确实移除
+    bool Cancel(TimerId id);
+    void Clear();
+
+    bool Empty() const { return entries_.empty(); }
+    size_t Size() const { return entries_.size(); }
+    std::optional<TimePoint> NextDeadline() const;
+
+    // 距最早截止时间的剩余时长（已到期返回 0）；队列为空返回 nullopt
+    std::optional<Duration> TimeUntilNext(TimePoint now) const;
+
+    // 按截止时间顺序取出所有 deadline <= now 的项并回调 fn(id)，返回触发个数
+    template <typename Fn>
+    size_t PopExpired(TimePoint now, Fn&& fn) {
+        size_t fired = 0;
+        while (!entries_.empty() && entries_.front().deadline <= now) {
+            TimerId id = entries_.front().id;
+            entries_.erase(entries_.begin());
+            ++fired;
+            fn(id);
+        }
+        return fired;
+    }
+
+private:
+    struct Entry {
+        TimePoint deadline;
+        TimerId id;
+    };
+    std::vector<Entry> entries_;  // 数量很少（通常 0~1 个），有序数组即可
+    TimerId nextId_ = 1;
+};
+
+// 把剩余时长换算成 Win32 等待用的毫秒数（向上取整，避免提前醒来再空转一次）；
+// nullopt 表示无限等待，返回 UINT32_MAX（与 INFINITE 相同）。
+std::uint32_t ToWaitMilliseconds(const std::optional<DeadlineScheduler::Duration>& remaining);
+
+// 鼠标长按检测：按下时安排 press + threshold 的截止时间，到期时恰好触发一次；
+// 按钮抬起期间没有任何截止时间，等待方不会被唤醒。
+class LongPressDetector {
+public:
+    using TimePoint = DeadlineScheduler::TimePoint;
+    using Duration = DeadlineScheduler::Duration;
+
+    explicit LongPressDetector(Duration threshold = Duration::zero()) : threshold_(threshold) {}
+
+    // threshold 为 0 表示点击模式：不安排截止时间
+    void SetThreshold(Duration threshold) { threshold_ = threshold; }
+    Duration threshold() const { return threshold_; }
+
+    void OnPress(TimePoint now);
+    // 抬起：撤销未到期的截止时间，返回长按是否已在此前触发
+    bool OnRelease();
+    // 到期检查：本次调用恰好越过截止时间时返回 true（每次按下最多一次）
+    bool OnTimer(TimePoint now);
+    void Reset();
+
+    std::optional<Duration> TimeUntilDeadline(TimePoint now) const { return scheduler_.TimeUntilNext(now); }
+
+    bool pressed() const { return pressed_; }
+    bool triggered() const { return triggered_; }
+
+private:
+    DeadlineScheduler scheduler_;
+    DeadlineScheduler::TimerId pending_ = 0;
+    Duration threshold_;
+    bool pressed_ = false;
+    bool triggered_ = false;
+};
+
+}  // namespace ztools
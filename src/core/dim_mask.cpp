@@ -0,0 +1,95 @@
+#include "dim_mask.h"
+
+#include "parallel.h"
+#include "simd.h"
+
+namespace ztools {
+
+namespace {
+
+// 每个通道：out = Div255(pre[c] + in * inv)，Div255(v) = (v + 128 + ((v + 128) >> 8)) >> 8。
+// pre[c] + 255 * inv <= 255 * 255，加上 128 与移位项后仍在 16 位以内，向量版全程用 16 位通道
+struct DimKernel {
+    std::uint16_t pre[4];  // color[c] * alpha + 128
+    std::uint16_t inv;     // 255 - alpha
+};
+
+void DimRow(std::uint8_t* p, int width, const DimKernel& k) {
+    int i = 0;
+#if defined(ZTOOLS_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i inv = _mm_set1_epi16(static_cast<short>(k.inv));
+    const __m128i pre = _mm_setr_epi16(static_cast<short>(k.pre[0]), static_cast<short>(k.pre[1]),
+                                       static_cast<short>(k.pre[2]), static_cast<short>(k.pre[3]),
+                                       static_cast<short>(k.pre[0]), static_cast<short>(k.pre[1]),
+                                       static_cast<short>(k.pre[2]), static_cast<short>(k.pre[3]));
+    for (; i + 4 <= width; i += 4) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 4));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), inv), pre);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), inv), pre);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(ZTOOLS_SIMD_NEON)
+    const uint8x8_t inv = vdup_n_u8(static_cast<std::uint8_t>(k.inv));
+    const std::uint16_t preLanes[8] = {k.pre[0], k.pre[1], k.pre[2], k.pre[3], k.pre[0], k.pre[1], k.pre[2], k.pre[3]};
+    const uint16x8_t pre = vld1q_u16(preLanes);
+    for (; i + 4 <= width; i += 4) {
+        uint8x16_t px = vld1q_u8(p + i * 4);
+        uint16x8_t lo = vaddq_u16(vmull_u8(vget_low_u8(px), inv), pre);
+        uint16x8_t hi = vaddq_u16(vmull_u8(vget_high_u8(px), inv), pre);
+        vst1q_u8(p + i * 4, vcombine_u8(vshrn_n_u16(vsraq_n_u16(lo, lo, 8), 8), vshrn_n_u16(vsraq_n_u16(hi, hi, 8), 8)));
+    }
+#endif
+    for (; i < width; i++) {
+        std::uint8_t* q = p + i * 4;
+        for (int c = 0; c < 4; c++) {
+            std::uint32_t v = k.pre[c] + q[c] * static_cast<std::uint32_t>(k.inv);
+            q[c] = static_cast<std::uint8_t>((v + (v >> 8)) >> 8);
+        }
+    }
+}
+
+// 少于这么多行时不拆给多个线程（按帧创建线程的开销在小面积上不划算）
+const int kMinRowsPerTask = 128;
+
+}  // namespace
+
+void DimRect(const ImageView& dst, const IntRect& rect, std::uint32_t color, std::uint8_t alpha, int threads) {
+    IntRect r = rect.Intersect(dst.Bounds());
+    if (r.Empty() || dst.data == nullptr || alpha == 0) return;
+    if (alpha == 255) {
+        Fill(dst, r, color);
+        return;
+    }
+    DimKernel k;
+    k.inv = static_cast<std::uint16_t>(255 - alpha);
+    for (int c = 0; c < 4; c++) k.pre[c] = static_cast<std::uint16_t>(((color >> (c * 8)) & 0xFF) * alpha + 128);
+    auto rows = [&](int begin, int end) {
+        for (int y = r.y + begin; y < r.y + end; y++) DimRow(reinterpret_cast<std::uint8_t*>(dst.Row(y) + r.x), r.w, k);
+    };
+    if (threads == 1 || r.h < kMinRowsPerTask * 2) {
+        rows(0, r.h);
+    } else {
+        ParallelFor(r.h, kMinRowsPerTask, rows, threads);
+    }
+}
+
+void DimOutside(const ImageView& dst, const IntRect& keep, const IntRect& clip, std::uint32_t color,
+                std::uint8_t alpha, int threads) {
+    IntRect c = clip.Intersect(dst.Bounds());
+    if (c.Empty()) return;
+    IntRect k = keep.Intersect(c);
+    if (k.Empty()) {
+        DimRect(dst, c, color, alpha, threads);
+        return;
+    }
+    // 与 BlendSolidOutside 相同的四块划分（上、下整行，左、右只覆盖选区高度），先裁剪到 clip
+    DimRect(dst, IntRect::FromLTRB(c.x, c.y, c.Right(), k.y), color, alpha, threads);
+    DimRect(dst, IntRect::FromLTRB(c.x, k.Bottom(), c.Right(), c.Bottom()), color, alpha, threads);
+    DimRect(dst, IntRect::FromLTRB(c.x, k.y, k.x, k.Bottom()), color, alpha, threads);
+    DimRect(dst, IntRect::FromLTRB(k.Right(), k.y, c.Right(), k.Bottom()), color, alpha, threads);
+}
+
+}  // namespace ztools
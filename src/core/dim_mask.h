@@ -0,0 +1,23 @@
+#pragma once
+
+// 截图选区外遮罩（平台无关）
+// 在后备缓冲像素上就地做常量色、常量 alpha 的变暗：dst = round((color * alpha + dst * (255 - alpha)) / 255)，
+// 与 raster.h 的 BlendSolid 逐字节一致。color * alpha 预先乘好（预乘常量），每个通道只剩一次乘加与
+// 除 255，SSE2 / NEON 一次处理 4 个像素。只处理调用方给出的裁剪矩形（本帧损伤）与选区外部的交集，
+// 不需要整屏大小的遮罩位图。
+
+#include "raster.h"
+
+#include <cstdint>
+
+namespace ztools {
+
+// 对 rect 内做常量 alpha 混合；threads <= 0 时使用 DefaultThreadCount()，1 表示单线程（小面积总是单线程）
+void DimRect(const ImageView& dst, const IntRect& rect, std::uint32_t color, std::uint8_t alpha, int threads = 1);
+
+// 对 clip 内、keep 以外的部分做 DimRect（选区外遮罩的一块损伤区）。
+// 同一帧内对两两不相交的 clip 分别调用，结果与对整屏调用一次 BlendSolidOutside 一致
+void DimOutside(const ImageView& dst, const IntRect& keep, const IntRect& clip, std::uint32_t color,
+                std::uint8_t alpha, int threads = 1);
+
+}  // namespace ztools
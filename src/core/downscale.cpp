@@ -0,0 +1,171 @@
+#include "downscale.h"
+
+#include "box_taps.h"
+#include "parallel.h"
+#include "simd.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ztools {
+
+namespace {
+
+inline std::uint32_t LoadPixel(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+// 水平一遍：源行 s 按 tx 取样成 width 个像素，每通道存 16 位（8 位结果 × 256，保留 4 位额外精度）
+void HorizontalRow(const std::uint8_t* s, const BoxTaps& tx, int width, std::uint16_t* out) {
+    int i = 0;
+#if defined(ZTOOLS_SIMD_SSE2)
+    // 两个源像素交错成 16 位通道对，madd 一次完成两项乘加；结果偏移 32768 后借有符号饱和打包成 16 位
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(8);
+    const __m128i shift32 = _mm_set1_epi32(32768);
+    const __m128i flip16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (; i + 2 <= width; i += 2) {
+        __m128i acc[2];
+        for (int h = 0; h < 2; h++) {
+            const int* idx = tx.index.data() + tx.offset[i + h];
+            const std::uint32_t* w = tx.weight.data() + tx.offset[i + h];
+            const int n = tx.count[i + h];
+            __m128i a = _mm_setzero_si128();
+            int k = 0;
+            for (; k + 2 <= n; k += 2) {
+                __m128i p0 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(LoadPixel(s + idx[k] * 4))), zero);
+                __m128i p1 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(LoadPixel(s + idx[k + 1] * 4))), zero);
+                __m128i wv = _mm_set1_epi32(static_cast<int>(w[k] | (w[k + 1] << 16)));
+                a = _mm_add_epi32(a, _mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), wv));
+            }
+            if (k < n) {
+                __m128i p0 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(LoadPixel(s + idx[k] * 4))), zero);
+                a = _mm_add_epi32(a, _mm_madd_epi16(_mm_unpacklo_epi16(p0, zero), _mm_set1_epi32(static_cast<int>(w[k]))));
+            }
+            acc[h] = _mm_sub_epi32(_mm_srli_epi32(_mm_add_epi32(a, bias), 4), shift32);
+        }
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(acc[0], acc[1]), flip16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), packed);
+    }
+#elif defined(ZTOOLS_SIMD_NEON)
+    for (; i < width; i++) {
+        const int* idx = tx.index.data() + tx.offset[i];
+        const std::uint32_t* w = tx.weight.data() + tx.offset[i];
+        uint32x4_t a = vdupq_n_u32(0);
+        for (int k = 0; k < tx.count[i]; k++) {
+            uint16x4_t p = vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(LoadPixel(s + idx[k] * 4)))));
+            a = vmlal_n_u16(a, p, static_cast<std::uint16_t>(w[k]));
+        }
+        vst1_u16(out + i * 4, vmovn_u32(vshrq_n_u32(vaddq_u32(a, vdupq_n_u32(8)), 4)));
+    }
+#endif
+    for (; i < width; i++) {
+        const int* idx = tx.index.data() + tx.offset[i];
+        const std::uint32_t* w = tx.weight.data() + tx.offset[i];
+        std::uint32_t acc[4] = {0, 0, 0, 0};
+        for (int k = 0; k < tx.count[i]; k++) {
+            const std::uint8_t* p = s + idx[k] * 4;
+            for (int c = 0; c < 4; c++) acc[c] += p[c] * w[k];
+        }
+        for (int c = 0; c < 4; c++) out[i * 4 + c] = static_cast<std::uint16_t>((acc[c] + 8) >> 4);
+    }
+}
+
+// 垂直一遍：n 行水平结果按权重 w 加权，写入 len 个字节
+void VerticalRow(const std::uint16_t* const* rows, const std::uint32_t* w, int n, int len, std::uint8_t* d) {
+    int x = 0;
+    if (n == 1) {
+        const std::uint16_t* h = rows[0];
+#if defined(ZTOOLS_SIMD_SSE2)
+        const __m128i half = _mm_set1_epi16(128);
+        for (; x + 16 <= len; x += 16) {
+            __m128i a = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + x)), half), 8);
+            __m128i b = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + x + 8)), half), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + x), _mm_packus_epi16(a, b));
+        }
+#elif defined(ZTOOLS_SIMD_NEON)
+        for (; x + 8 <= len; x += 8) vst1_u8(d + x, vshrn_n_u16(vaddq_u16(vld1q_u16(h + x), vdupq_n_u16(128)), 8));
+#endif
+        for (; x < len; x++) d[x] = static_cast<std::uint8_t>((h[x] + 128) >> 8);
+        return;
+    }
+#if defined(ZTOOLS_SIMD_SSE2)
+    // 16 位 × 16 位的完整 32 位乘积由 mullo / mulhi 两半拼出（权重 <= kBoxOne）
+    const __m128i round = _mm_set1_epi32(1 << 19);
+    for (; x + 8 <= len; x += 8) {
+        __m128i lo = round, hi = round;
+        for (int k = 0; k < n; k++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x));
+            __m128i wk = _mm_set1_epi16(static_cast<short>(w[k]));
+            __m128i pl = _mm_mullo_epi16(v, wk);
+            __m128i ph = _mm_mulhi_epu16(v, wk);
+            lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(pl, ph));
+            hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(pl, ph));
+        }
+        __m128i r16 = _mm_packs_epi32(_mm_srli_epi32(lo, 20), _mm_srli_epi32(hi, 20));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + x), _mm_packus_epi16(r16, r16));
+    }
+#elif defined(ZTOOLS_SIMD_NEON)
+    for (; x + 8 <= len; x += 8) {
+        uint32x4_t lo = vdupq_n_u32(1u << 19), hi = lo;
+        for (int k = 0; k < n; k++) {
+            uint16x8_t v = vld1q_u16(rows[k] + x);
+            lo = vmlal_n_u16(lo, vget_low_u16(v), static_cast<std::uint16_t>(w[k]));
+            hi = vmlal_n_u16(hi, vget_high_u16(v), static_cast<std::uint16_t>(w[k]));
+        }
+        uint16x8_t r16 = vcombine_u16(vmovn_u32(vshrq_n_u32(lo, 20)), vmovn_u32(vshrq_n_u32(hi, 20)));
+        vst1_u8(d + x, vmovn_u16(r16));
+    }
+#endif
+    for (; x < len; x++) {
+        std::uint32_t acc = 0;
+        for (int k = 0; k < n; k++) acc += rows[k][x] * w[k];
+        d[x] = static_cast<std::uint8_t>((acc + (1u << 19)) >> 20);
+    }
+}
+
+// 目标行 [rowBegin, rowEnd)：每段自带水平结果的环形缓存（同一目标行用到的源行连续且递增）
+void DownscaleRows(const ImageView& src, const ImageView& dst, const BoxTaps& tx, const BoxTaps& ty, int rowBegin,
+                   int rowEnd) {
+    const int rowLen = dst.width * 4;
+    const int cacheRows = ty.maxCount + 1;
+    std::vector<std::uint16_t> cache(static_cast<size_t>(cacheRows) * rowLen);
+    std::vector<int> cachedRow(cacheRows, -1);
+    std::vector<const std::uint16_t*> rows(ty.maxCount);
+
+    for (int j = rowBegin; j < rowEnd; j++) {
+        const int* idx = ty.index.data() + ty.offset[j];
+        const int n = ty.count[j];
+        for (int k = 0; k < n; k++) {
+            int sy = idx[k];
+            int slot = sy % cacheRows;
+            std::uint16_t* out = cache.data() + static_cast<size_t>(slot) * rowLen;
+            if (cachedRow[slot] != sy) {
+                HorizontalRow(reinterpret_cast<const std::uint8_t*>(src.Row(sy)), tx, dst.width, out);
+                cachedRow[slot] = sy;
+            }
+            rows[k] = out;
+        }
+        VerticalRow(rows.data(), ty.weight.data() + ty.offset[j], n, rowLen,
+                    reinterpret_cast<std::uint8_t*>(dst.Row(j)));
+    }
+}
+
+}  // namespace
+
+void DownscaleBox(const ImageView& src, const ImageView& dst, int threads) {
+    if (src.Empty() || dst.Empty()) return;
+    if (src.width == dst.width && src.height == dst.height) {
+        Copy(src, 0, 0, dst, dst.Bounds());
+        return;
+    }
+    BoxTaps tx, ty;
+    BuildBoxTaps(0, src.width, src.width, dst.width, tx);
+    BuildBoxTaps(0, src.height, src.height, dst.height, ty);
+    // 每段至少 64 行：段边界处的源行会被相邻两段各算一次水平结果
+    ParallelFor(dst.height, 64, [&](int begin, int end) { DownscaleRows(src, dst, tx, ty, begin, end); }, threads);
+}
+
+}  // namespace ztools
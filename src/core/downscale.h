@@ -0,0 +1,16 @@
+#pragma once
+
+// 整幅面积平均缩放（平台无关）：高 DPI 截图会话开始时把物理分辨率截图一次性缩成逻辑分辨率底图，
+// 之后每帧的背景恢复 / 放大镜都从底图 1:1 取，不再逐帧 StretchBlt。
+// 可分离两遍：水平取样（每像素若干源像素加权，结果存 16 位）与垂直加权（若干行 16 位结果加权），
+// 两遍都用 SSE2 / NEON 向量化；目标行按段分给多个线程（段边界的水平结果各算各的）。
+// 输出与 raster.h 的 Scale(src, src.Bounds(), dst, dst.Bounds(), ScaleFilter::Box) 逐像素一致。
+
+#include "raster.h"
+
+namespace ztools {
+
+// 把 src 整幅缩放到 dst 整幅；threads <= 0 时使用 DefaultThreadCount()，1 表示单线程
+void DownscaleBox(const ImageView& src, const ImageView& dst, int threads = 0);
+
+}  // namespace ztools
@@ -0,0 +1,118 @@
+#include "export_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace ztools {
+
+// 一次导出任务的共享状态：编码 / 发布任务各写各的字段，最后完成的一个负责 deliver 与 release
+struct ExportPipeline::State {
+    ExportJob job;
+    ExportResult result;
+    std::atomic<int> remaining{0};
+};
+
+ExportPipeline::ExportPipeline(int workers) : workerCount_((std::max)(workers, 1)) {}
+
+ExportPipeline::~ExportPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskCv_.notify_all();
+    for (std::thread& w : workers_) w.join();
+}
+
+ExportId ExportPipeline::Submit(ExportJob job) {
+    auto state = std::make_shared<State>();
+    state->job = std::move(job);
+    state->result.width = state->job.image.width;
+    state->result.height = state->job.image.height;
+    const bool hasPublish = static_cast<bool>(state->job.publish);
+    state->remaining = hasPublish ? 2 : 1;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    EnsureWorkers();
+    state->result.id = nextId_++;
+    state->result.timings.submitted = Clock::now() - state->job.confirmedAt;
+    stats_.submitted++;
+    inFlight_++;
+    stats_.maxInFlight = (std::max)(stats_.maxInFlight, inFlight_);
+
+    tasks_.push_back([this, state] {
+        const ExportJob& job = state->job;
+        ExportResult& r = state->result;
+        r.encoded = job.encode && job.encode(job.image, r.payload);
+        if (!r.encoded) r.payload.clear();
+        r.timings.encoded = Clock::now() - job.confirmedAt;
+        FinishTask(state);
+    });
+    if (hasPublish) {
+        tasks_.push_back([this, state] {
+            const ExportJob& job = state->job;
+            state->result.published = job.publish(job.image);
+            state->result.timings.published = Clock::now() - job.confirmedAt;
+            FinishTask(state);
+        });
+    }
+    const ExportId id = state->result.id;
+    lock.unlock();
+    taskCv_.notify_all();
+    return id;
+}
+
+void ExportPipeline::FinishTask(const std::shared_ptr<State>& state) {
+    if (--state->remaining > 0) return;
+    ExportResult& r = state->result;
+    const bool encodeFailed = !r.encoded;
+    const bool publishFailed = state->job.publish && !r.published;
+    r.timings.delivered = Clock::now() - state->job.confirmedAt;
+    if (state->job.deliver) state->job.deliver(std::move(r));
+    if (state->job.release) state->job.release();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_--;
+        stats_.delivered++;
+        if (encodeFailed) stats_.encodeFailures++;
+        if (publishFailed) stats_.publishFailures++;
+    }
+    idleCv_.notify_all();
+}
+
+void ExportPipeline::EnsureWorkers() {
+    if (!workers_.empty()) return;
+    workers_.reserve(workerCount_);
+    for (int i = 0; i < workerCount_; i++) workers_.emplace_back(&ExportPipeline::WorkerLoop, this);
+}
+
+void ExportPipeline::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        taskCv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        // 退出前先把队列里的任务做完（析构时等待已提交的导出）
+        if (tasks_.empty()) return;
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void ExportPipeline::Drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this] { return inFlight_ == 0; });
+}
+
+int ExportPipeline::InFlight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlight_;
+}
+
+ExportStats ExportPipeline::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace ztools
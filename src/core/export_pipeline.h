@@ -0,0 +1,104 @@
+#pragma once
+
+// 区域截图结果的后台导出流水线（平台无关）
+// 确认截图时覆盖层线程只做裁剪 / 缩放 / 合成标注，把成品像素交给流水线后立即回报尺寸并关闭窗口；
+// 编码（PNG + base64）与发布（剪贴板）是同一张图上的两个只读任务，在常驻工作线程上并行执行，
+// 两者都结束后在工作线程上回调 deliver 交出编码结果，随后调用 release 释放像素。
+// 各阶段由调用方按任务注入（Win32 为 GDI+ 编码、剪贴板与线程安全函数回调，测试为假实现）。
+
+#include "raster.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ztools {
+
+using ExportId = std::uint64_t;
+
+// 各阶段完成时刻，均相对确认截图的时刻
+struct ExportTimings {
+    using Duration = std::chrono::steady_clock::duration;
+
+    Duration submitted{};  // 交给流水线（此后覆盖层即可关闭）
+    Duration encoded{};
+    Duration published{};
+    Duration delivered{};
+};
+
+struct ExportResult {
+    ExportId id = 0;
+    int width = 0;
+    int height = 0;
+    bool encoded = false;    // 编码成功，payload 有效
+    bool published = false;  // 发布成功（未设置发布阶段时为 false）
+    std::string payload;
+    ExportTimings timings;
+};
+
+struct ExportJob {
+    using Clock = std::chrono::steady_clock;
+
+    ImageView image;                     // 成品像素，release 调用前保持有效且不再被修改
+    Clock::time_point confirmedAt{};     // 确认截图的时刻，timings 以此为起点
+    std::function<bool(const ImageView&, std::string&)> encode;  // 必需
+    std::function<bool(const ImageView&)> publish;               // 可选
+    std::function<void(ExportResult&&)> deliver;                 // 可选，在工作线程上调用
+    std::function<void()> release;                              // 可选，deliver 之后调用
+};
+
+struct ExportStats {
+    int submitted = 0;
+    int delivered = 0;
+    int encodeFailures = 0;
+    int publishFailures = 0;
+    int maxInFlight = 0;  // 同时未完成的任务数峰值
+};
+
+class ExportPipeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // workers：常驻工作线程数（首次提交时才创建），< 1 按 1 处理；2 个即可让编码与发布并行
+    explicit ExportPipeline(int workers = 2);
+    // 等待已提交的任务全部完成后退出工作线程
+    ~ExportPipeline();
+
+    ExportPipeline(const ExportPipeline&) = delete;
+    ExportPipeline& operator=(const ExportPipeline&) = delete;
+
+    // 提交后立即返回；返回的 id 同时写入 ExportResult.id（非 0）
+    ExportId Submit(ExportJob job);
+
+    // 阻塞到当前已提交的任务全部完成
+    void Drain();
+    int InFlight() const;
+    ExportStats stats() const;
+
+private:
+    struct State;
+
+    void EnsureWorkers();
+    void WorkerLoop();
+    void FinishTask(const std::shared_ptr<State>& state);
+
+    const int workerCount_;
+    mutable std::mutex mutex_;
+    std::condition_variable taskCv_;  // 有新任务 / 退出
+    std::condition_variable idleCv_;  // 有任务完成
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    int inFlight_ = 0;
+    ExportId nextId_ = 1;
+    ExportStats stats_;
+};
+
+}  // namespace ztools
@@ -0,0 +1,80 @@
+#include "hit_index.h"
+
+#include <algorithm>
+
+namespace ztools {
+
+void HitGrid::Clear() {
+    items_.clear();
+    cells_.clear();
+}
+
+void HitGrid::Unlink(int item) {
+    for (std::int64_t key : items_[item].cells) {
+        auto it = cells_.find(key);
+        if (it == cells_.end()) continue;
+        std::vector<HitCandidate>& refs = it->second;
+        refs.erase(std::remove_if(refs.begin(), refs.end(), [item](const HitCandidate& c) { return c.item == item; }),
+                   refs.end());
+        if (refs.empty()) cells_.erase(it);
+    }
+    items_[item].cells.clear();
+}
+
+void HitGrid::SetItem(int item, const std::vector<HitPart>& parts) {
+    if (item < 0) return;
+    if (item >= ItemCount()) items_.resize(item + 1);
+    Unlink(item);
+    Item& it = items_[item];
+    it.parts = parts;
+    for (int p = 0; p < static_cast<int>(parts.size()); p++) {
+        const IntRect& box = parts[p].box;
+        if (box.Empty()) continue;
+        int cx1 = CellOf(box.Right() - 1), cy1 = CellOf(box.Bottom() - 1);
+        for (int cy = CellOf(box.y); cy <= cy1; cy++) {
+            for (int cx = CellOf(box.x); cx <= cx1; cx++) {
+                std::int64_t key = CellKey(cx, cy);
+                // 格内按 (图元, 部件) 升序保存，FirstItemAt 遇到第一个命中即可返回
+                std::vector<HitCandidate>& refs = cells_[key];
+                HitCandidate ref = {item, p};
+                refs.insert(std::upper_bound(refs.begin(), refs.end(), ref,
+                                             [](const HitCandidate& a, const HitCandidate& b) {
+                                                 return a.item != b.item ? a.item < b.item : a.part < b.part;
+                                             }),
+                            ref);
+                it.cells.push_back(key);
+            }
+        }
+    }
+    std::sort(it.cells.begin(), it.cells.end());
+    it.cells.erase(std::unique(it.cells.begin(), it.cells.end()), it.cells.end());
+}
+
+void HitGrid::Truncate(int count) {
+    if (count < 0) count = 0;
+    for (int i = ItemCount() - 1; i >= count; i--) Unlink(i);
+    if (count < ItemCount()) items_.resize(count);
+}
+
+void HitGrid::Query(int x, int y, std::vector<HitCandidate>& out) const {
+    out.clear();
+    auto it = cells_.find(CellKey(CellOf(x), CellOf(y)));
+    if (it == cells_.end()) return;
+    for (const HitCandidate& c : it->second) {
+        if (items_[c.item].parts[c.part].box.Contains(x, y)) out.push_back(c);
+    }
+    std::sort(out.begin(), out.end(), [](const HitCandidate& a, const HitCandidate& b) {
+        return a.item != b.item ? a.item > b.item : a.part < b.part;
+    });
+}
+
+int HitGrid::FirstItemAt(int x, int y) const {
+    auto it = cells_.find(CellKey(CellOf(x), CellOf(y)));
+    if (it == cells_.end()) return -1;
+    for (const HitCandidate& c : it->second) {
+        if (items_[c.item].parts[c.part].box.Contains(x, y)) return c.item;
+    }
+    return -1;
+}
+
+}  // namespace ztools
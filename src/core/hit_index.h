@@ -0,0 +1,92 @@
+#pragma once
+
+// 标注命中测试的空间索引（平台无关）：均匀网格上的包围盒索引。
+// 每个图元（标注）登记若干「部件」包围盒（已按命中容差外扩）：形状标注一个部件，
+// 长折线按每 kSegmentsPerPart 段一个部件，记录其点区间，命中时只需对这些区间做精确距离测试。
+// 点查询只看该点所在的一个格子，结果按图元编号从大到小（即绘制顶层优先）返回。
+// 图元按编号增量替换 / 截断，编辑一个标注只重登记它自己的部件。
+// 也用于截图待选窗口：窗口按 z 序自顶向下编号，FirstItemAt 即鼠标下最上层的窗口。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ztools {
+
+struct HitPart {
+    IntRect box;      // 命中候选范围（含容差），点在其内才需要精确测试
+    int first = -1;   // 折线部件覆盖的点区间 [first, last]；整体部件为 -1
+    int last = -1;
+};
+
+struct HitCandidate {
+    int item = -1;
+    int part = -1;
+};
+
+class HitGrid {
+public:
+    static constexpr int kSegmentsPerPart = 16;
+
+    HitGrid() = default;  // 非 explicit：宿主结构体会用 `= {}` 聚合初始化
+    explicit HitGrid(int cellSize) : cellSize_(cellSize > 0 ? cellSize : 64) {}
+
+    void Clear();
+    int ItemCount() const { return static_cast<int>(items_.size()); }
+
+    // 替换图元 item 的全部部件（item >= ItemCount 时自动扩容，中间空出的图元没有部件）
+    void SetItem(int item, const std::vector<HitPart>& parts);
+    // 删除编号 >= count 的图元
+    void Truncate(int count);
+    const std::vector<HitPart>& Parts(int item) const { return items_[item].parts; }
+
+    // 包围盒含 (x, y) 的部件，按图元编号降序、同一图元内按部件顺序升序写入 out（先清空）
+    void Query(int x, int y, std::vector<HitCandidate>& out) const;
+    // 包围盒含 (x, y) 的编号最小的图元（格内有序，找到即返回，不分配），没有则 -1
+    int FirstItemAt(int x, int y) const;
+
+    size_t CellCount() const { return cells_.size(); }
+
+private:
+    struct Item {
+        std::vector<HitPart> parts;
+        std::vector<std::int64_t> cells;  // 登记过的格子（去重），删除时据此回收
+    };
+
+    std::int64_t CellKey(int cx, int cy) const {
+        return (static_cast<std::int64_t>(cy) << 32) ^ static_cast<std::uint32_t>(cx);
+    }
+    int CellOf(int v) const { return v >= 0 ? v / cellSize_ : -((-v + cellSize_ - 1) / cellSize_); }
+    void Unlink(int item);
+
+    int cellSize_ = 64;
+    std::vector<Item> items_;
+    std::unordered_map<std::int64_t, std::vector<HitCandidate>> cells_;
+};
+
+// 把折线 pts[0..count) 切成每 kSegmentsPerPart 段一个部件（相邻部件共享端点），包围盒外扩 pad
+template <typename Point>
+void AppendPolylineParts(const Point* pts, int count, int pad, std::vector<HitPart>& out) {
+    if (count <= 0) return;
+    for (int first = 0; first == 0 || first < count - 1; first += HitGrid::kSegmentsPerPart) {
+        int last = first + HitGrid::kSegmentsPerPart;
+        if (last > count - 1) last = count - 1;
+        int l = pts[first].x, t = pts[first].y, r = l, b = t;
+        for (int i = first + 1; i <= last; i++) {
+            if (pts[i].x < l) l = pts[i].x;
+            if (pts[i].x > r) r = pts[i].x;
+            if (pts[i].y < t) t = pts[i].y;
+            if (pts[i].y > b) b = pts[i].y;
+        }
+        HitPart part;
+        part.box = IntRect::FromLTRB(l - pad, t - pad, r + pad + 1, b + pad + 1);
+        part.first = first;
+        part.last = last;
+        out.push_back(part);
+        if (last == count - 1) break;
+    }
+}
+
+}  // namespace ztools
@@ -0,0 +1,178 @@
+#include "image_encoder.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+std::string Lower(const std::string& s) {
+    std::string out(s);
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+// ==== QOI ====
+
+const std::uint8_t kQoiOpIndex = 0x00;
+const std::uint8_t kQoiOpDiff = 0x40;
+const std::uint8_t kQoiOpLuma = 0x80;
+const std::uint8_t kQoiOpRun = 0xC0;
+const std::uint8_t kQoiOpRgb = 0xFE;
+const int kQoiHeaderSize = 14;
+const std::uint8_t kQoiEnd[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+std::uint8_t* PutU32Be(std::uint8_t* p, std::uint32_t v) {
+    p[0] = static_cast<std::uint8_t>(v >> 24);
+    p[1] = static_cast<std::uint8_t>(v >> 16);
+    p[2] = static_cast<std::uint8_t>(v >> 8);
+    p[3] = static_cast<std::uint8_t>(v);
+    return p + 4;
+}
+
+class QoiEncoder : public ImageEncoder {
+public:
+    const char* Name() const override { return "qoi"; }
+    const char* MimeType() const override { return "image/qoi"; }
+    const char* Extension() const override { return "qoi"; }
+
+    bool Encode(const ImageView& image, const EncodeOptions&, std::vector<std::uint8_t>& out) const override {
+        if (image.Empty()) return false;
+        // 最坏情况每像素一个 QOI_OP_RGB（4 字节）；先按上限分配，写完再截断，循环内不做容量检查
+        const size_t pixels = static_cast<size_t>(image.width) * image.height;
+        out.resize(kQoiHeaderSize + pixels * 4 + sizeof(kQoiEnd));
+        std::uint8_t* p = out.data();
+        std::memcpy(p, "qoif", 4);
+        p = PutU32Be(p + 4, static_cast<std::uint32_t>(image.width));
+        p = PutU32Be(p, static_cast<std::uint32_t>(image.height));
+        *p++ = 3;  // RGB
+        *p++ = 0;  // sRGB
+
+        // 像素一律按 alpha = 255 处理，因此 QOI_OP_RGBA 不会出现，哈希里的 alpha 项是常数
+        std::uint32_t index[64] = {};
+        std::uint32_t prev = 0xFF000000u;
+        int run = 0;
+        for (int y = 0; y < image.height; y++) {
+            const std::uint32_t* row = image.Row(y);
+            for (int x = 0; x < image.width; x++) {
+                const std::uint32_t px = row[x] | 0xFF000000u;
+                if (px == prev) {
+                    if (++run == 62) {
+                        *p++ = static_cast<std::uint8_t>(kQoiOpRun | (run - 1));
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0) {
+                    *p++ = static_cast<std::uint8_t>(kQoiOpRun | (run - 1));
+                    run = 0;
+                }
+                const int r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+                const int slot = (r * 3 + g * 5 + b * 7 + 255 * 11) & 63;
+                if (index[slot] == px) {
+                    *p++ = static_cast<std::uint8_t>(kQoiOpIndex | slot);
+                } else {
+                    index[slot] = px;
+                    // 通道差按 8 位回绕解释
+                    const int vr = static_cast<std::int8_t>(r - static_cast<int>((prev >> 16) & 0xFF));
+                    const int vg = static_cast<std::int8_t>(g - static_cast<int>((prev >> 8) & 0xFF));
+                    const int vb = static_cast<std::int8_t>(b - static_cast<int>(prev & 0xFF));
+                    const int vgr = vr - vg, vgb = vb - vg;
+                    if (vr >= -2 && vr <= 1 && vg >= -2 && vg <= 1 && vb >= -2 && vb <= 1) {
+                        *p++ = static_cast<std::uint8_t>(kQoiOpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                    } else if (vg >= -32 && vg <= 31 && vgr >= -8 && vgr <= 7 && vgb >= -8 && vgb <= 7) {
+                        *p++ = static_cast<std::uint8_t>(kQoiOpLuma | (vg + 32));
+                        *p++ = static_cast<std::uint8_t>((vgr + 8) << 4 | (vgb + 8));
+                    } else {
+                        p[0] = kQoiOpRgb;
+                        p[1] = static_cast<std::uint8_t>(r);
+                        p[2] = static_cast<std::uint8_t>(g);
+                        p[3] = static_cast<std::uint8_t>(b);
+                        p += 4;
+                    }
+                }
+                prev = px;
+            }
+        }
+        if (run > 0) *p++ = static_cast<std::uint8_t>(kQoiOpRun | (run - 1));
+        std::memcpy(p, kQoiEnd, sizeof(kQoiEnd));
+        p += sizeof(kQoiEnd);
+        out.resize(static_cast<size_t>(p - out.data()));
+        return true;
+    }
+};
+
+// ==== 原始 BGRA ====
+
+class RawBgraEncoder : public ImageEncoder {
+public:
+    const char* Name() const override { return "raw"; }
+    const char* MimeType() const override { return "application/octet-stream"; }
+    const char* Extension() const override { return "bgra"; }
+
+    bool Encode(const ImageView& image, const EncodeOptions&, std::vector<std::uint8_t>& out) const override {
+        if (image.Empty()) return false;
+        const size_t rowPixels = static_cast<size_t>(image.width);
+        out.resize(rowPixels * image.height * 4);
+        for (int y = 0; y < image.height; y++) {
+            const std::uint32_t* in = image.Row(y);
+            std::uint32_t* o = reinterpret_cast<std::uint32_t*>(out.data()) + rowPixels * y;
+            for (size_t x = 0; x < rowPixels; x++) o[x] = in[x] | 0xFF000000u;
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
+bool ParseQualityPreset(const std::string& name, int& quality) {
+    const std::string n = Lower(name);
+    if (n == "high") {
+        quality = 92;
+    } else if (n == "balanced") {
+        quality = 80;
+    } else if (n == "small") {
+        quality = 60;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void EncoderRegistry::Register(std::unique_ptr<ImageEncoder> encoder) {
+    if (!encoder) return;
+    for (auto& e : encoders_) {
+        if (std::strcmp(e->Name(), encoder->Name()) == 0) {
+            e = std::move(encoder);
+            return;
+        }
+    }
+    encoders_.push_back(std::move(encoder));
+}
+
+const ImageEncoder* EncoderRegistry::Find(const std::string& name) const {
+    std::string n = Lower(name);
+    if (n == "jpg") n = "jpeg";
+    for (const auto& e : encoders_) {
+        if (n == e->Name()) return e.get();
+    }
+    return nullptr;
+}
+
+std::vector<std::string> EncoderRegistry::Names() const {
+    std::vector<std::string> names;
+    for (const auto& e : encoders_) names.emplace_back(e->Name());
+    return names;
+}
+
+std::unique_ptr<ImageEncoder> MakeQoiEncoder() { return std::unique_ptr<ImageEncoder>(new QoiEncoder()); }
+
+std::unique_ptr<ImageEncoder> MakeRawBgraEncoder() { return std::unique_ptr<ImageEncoder>(new RawBgraEncoder()); }
+
+void RegisterBuiltinEncoders(EncoderRegistry& registry) {
+    registry.Register(MakeQoiEncoder());
+    registry.Register(MakeRawBgraEncoder());
+}
+
+}  // namespace ztools
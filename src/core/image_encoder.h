@@ -0,0 +1,58 @@
+#pragma once
+
+// 截图输出编码器（平台无关接口）
+// 每种输出格式一个 ImageEncoder，按名字登记在 EncoderRegistry 里，截图导出 / 保存时按用户选择的格式查找。
+// 内置两种不依赖系统库的格式：QOI（无损，单遍编码、无熵编码）与 raw（紧凑排列的 BGRA 原始像素，
+// 不编码，适合交给 OCR / 翻译等本地流程）。PNG / JPEG 由平台层登记（Win32 为 GDI+）。
+// 截图像素的 alpha 字节无定义（GDI 绘制不维护 alpha），编码器一律按不透明输出。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ztools {
+
+struct EncodeOptions {
+    int quality = 90;  // 有损格式的质量 1..100，无损格式忽略
+};
+
+// 质量预设：high = 92，balanced = 80，small = 60；未知名字返回 false 且不修改 quality
+bool ParseQualityPreset(const std::string& name, int& quality);
+
+class ImageEncoder {
+public:
+    virtual ~ImageEncoder() = default;
+
+    virtual const char* Name() const = 0;      // 小写格式名，如 "png"、"qoi"
+    virtual const char* MimeType() const = 0;
+    virtual const char* Extension() const = 0;  // 保存文件用，不含点
+    virtual bool Lossy() const { return false; }
+    // 编码整幅图像到 out（覆盖原内容）；图像为空或编码失败返回 false
+    virtual bool Encode(const ImageView& image, const EncodeOptions& options, std::vector<std::uint8_t>& out) const = 0;
+};
+
+class EncoderRegistry {
+public:
+    // 同名编码器后登记的替换先登记的
+    void Register(std::unique_ptr<ImageEncoder> encoder);
+    // 按名字查找（不区分大小写，"jpg" 视同 "jpeg"）；找不到返回 nullptr
+    const ImageEncoder* Find(const std::string& name) const;
+    // 已登记的格式名，按登记顺序
+    std::vector<std::string> Names() const;
+
+private:
+    std::vector<std::unique_ptr<ImageEncoder>> encoders_;
+};
+
+// QOI（https://qoiformat.org），3 通道 sRGB
+std::unique_ptr<ImageEncoder> MakeQoiEncoder();
+// 原始像素：height 行、每行 width * 4 字节的 BGRA（alpha = 255），不带文件头
+std::unique_ptr<ImageEncoder> MakeRawBgraEncoder();
+
+// 登记内置编码器（qoi、raw）
+void RegisterBuiltinEncoders(EncoderRegistry& registry);
+
+}  // namespace ztools
@@ -0,0 +1,141 @@
+#include "layer_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ztools {
+
+void LayerCache::Attach(const ImageView& pixels) {
+    pixels_ = pixels;
+    content_ = IntRect();
+    cols_ = pixels_.Empty() ? 0 : (pixels_.width + kCellSize - 1) / kCellSize;
+    rows_ = pixels_.Empty() ? 0 : (pixels_.height + kCellSize - 1) / kCellSize;
+    cells_.assign(static_cast<size_t>(cols_) * rows_, 0);
+    valid_ = false;
+    dirtyAll_ = true;
+}
+
+ImageView LayerCache::BeginRebuild(std::uint64_t key) {
+    if (dirtyAll_) {
+        for (int y = 0; y < pixels_.height; y++) std::memset(pixels_.Row(y), 0, static_cast<size_t>(pixels_.width) * 4);
+    } else {
+        // 按格清零（不经 ForEachRun：Invalidate 之后层已无效，但上次画过的格子仍要清掉）
+        for (int cy = 0; cy < rows_; cy++) {
+            for (int cx = 0; cx < cols_; cx++) {
+                if (!cells_[static_cast<size_t>(cy) * cols_ + cx]) continue;
+                IntRect r = IntRect(cx * kCellSize, cy * kCellSize, kCellSize, kCellSize).Intersect(pixels_.Bounds());
+                for (int y = r.y; y < r.Bottom(); y++) std::memset(pixels_.Row(y) + r.x, 0, static_cast<size_t>(r.w) * 4);
+            }
+        }
+    }
+    std::fill(cells_.begin(), cells_.end(), 0);
+    content_ = IntRect();
+    dirtyAll_ = false;
+    key_ = key;
+    valid_ = !pixels_.Empty();
+    rebuilds_++;
+    return pixels_;
+}
+
+ImageView LayerCache::BeginUpdate(std::uint64_t key, const IntRect& damage) {
+    if (!valid_ || dirtyAll_) return BeginRebuild(key);
+    IntRect r = damage.Intersect(pixels_.Bounds());
+    if (!r.Empty()) {
+        for (int y = r.y; y < r.Bottom(); y++) std::memset(pixels_.Row(y) + r.x, 0, static_cast<size_t>(r.w) * 4);
+        // 完全落在 damage 内的格子已经清空，取消登记；跨边界的格子在 damage 外可能还有内容，保留
+        for (int cy = r.y / kCellSize; cy <= (r.Bottom() - 1) / kCellSize; cy++) {
+            for (int cx = r.x / kCellSize; cx <= (r.Right() - 1) / kCellSize; cx++) {
+                IntRect cell = IntRect(cx * kCellSize, cy * kCellSize, kCellSize, kCellSize).Intersect(pixels_.Bounds());
+                if (cell.Intersect(r) == cell) cells_[static_cast<size_t>(cy) * cols_ + cx] = 0;
+            }
+        }
+    }
+    key_ = key;
+    updates_++;
+    return pixels_;
+}
+
+void LayerCache::MarkCells(const IntRect& rect) {
+    if (rect.Empty()) return;
+    int cx1 = (rect.Right() - 1) / kCellSize;
+    int cy1 = (rect.Bottom() - 1) / kCellSize;
+    for (int cy = rect.y / kCellSize; cy <= cy1; cy++) {
+        for (int cx = rect.x / kCellSize; cx <= cx1; cx++) cells_[static_cast<size_t>(cy) * cols_ + cx] = 1;
+    }
+}
+
+void LayerCache::MarkDrawn(const IntRect& rect) {
+    IntRect r = rect.Intersect(pixels_.Bounds());
+    MarkCells(r);
+    content_ = content_.Union(r);
+}
+
+void LayerCache::MarkDrawnByAlpha(const IntRect& rect) {
+    IntRect r = rect.Intersect(pixels_.Bounds());
+    if (r.Empty()) return;
+    // 逐格扫描：格子内找到第一个非透明像素即登记整格，再跳到下一格
+    for (int cy = r.y / kCellSize; cy <= (r.Bottom() - 1) / kCellSize; cy++) {
+        for (int cx = r.x / kCellSize; cx <= (r.Right() - 1) / kCellSize; cx++) {
+            IntRect cell = IntRect(cx * kCellSize, cy * kCellSize, kCellSize, kCellSize).Intersect(r);
+            int minX = cell.Right(), minY = cell.Bottom(), maxX = cell.x - 1, maxY = cell.y - 1;
+            for (int y = cell.y; y < cell.Bottom(); y++) {
+                const std::uint32_t* row = pixels_.Row(y);
+                int first = -1, last = -1;
+                for (int x = cell.x; x < cell.Right(); x++) {
+                    if (row[x] >> 24) {
+                        first = x;
+                        break;
+                    }
+                }
+                if (first < 0) continue;
+                for (int x = cell.Right() - 1; x >= first; x--) {
+                    if (row[x] >> 24) {
+                        last = x;
+                        break;
+                    }
+                }
+                minX = (std::min)(minX, first);
+                maxX = (std::max)(maxX, last);
+                minY = (std::min)(minY, y);
+                maxY = y;
+            }
+            if (maxY >= minY) MarkDrawn(IntRect::FromLTRB(minX, minY, maxX + 1, maxY + 1));
+        }
+    }
+}
+
+void LayerCache::ForEachRun(int offsetX, int offsetY, const IntRect& clip,
+                            const std::function<void(const IntRect&)>& fn) const {
+    IntRect area = CompositeRect(offsetX, offsetY, clip);
+    if (area.Empty()) return;
+    IntRect layerArea = area.Offset(-offsetX, -offsetY);
+    int cx0 = layerArea.x / kCellSize, cx1 = (layerArea.Right() - 1) / kCellSize;
+    for (int cy = layerArea.y / kCellSize; cy <= (layerArea.Bottom() - 1) / kCellSize; cy++) {
+        const std::uint8_t* row = cells_.data() + static_cast<size_t>(cy) * cols_;
+        int cx = cx0;
+        while (cx <= cx1) {
+            if (!row[cx]) {
+                cx++;
+                continue;
+            }
+            int start = cx;
+            while (cx <= cx1 && row[cx]) cx++;
+            IntRect run(start * kCellSize, cy * kCellSize, (cx - start) * kCellSize, kCellSize);
+            IntRect dst = run.Offset(offsetX, offsetY).Intersect(area);
+            if (!dst.Empty()) fn(dst);
+        }
+    }
+}
+
+IntRect LayerCache::CompositeRect(int offsetX, int offsetY, const IntRect& clip) const {
+    if (!valid_) return IntRect();
+    return content_.Offset(offsetX, offsetY).Intersect(clip);
+}
+
+void LayerCache::CompositeOnto(const ImageView& dst, int offsetX, int offsetY, const IntRect& clip) const {
+    ForEachRun(offsetX, offsetY, clip.Intersect(dst.Bounds()), [&](const IntRect& r) {
+        BlendOver(pixels_, r.x - offsetX, r.y - offsetY, dst, r);
+    });
+}
+
+}  // namespace ztools
@@ -0,0 +1,75 @@
+#pragma once
+
+// 已提交标注的栅格缓存层（平台无关）。
+// 把「内容不常变」的一组图形压平到一张预乘 alpha 的 BGRA 层上，内容签名（key）不变时
+// 每帧只需一次 BlendOver / AlphaBlend 合成，不再逐个重新光栅化；签名变化时由调用方重画。
+// 层的像素内存由调用方提供（可以是 DIB section，GDI / GDI+ 直接在上面绘制），本类只管
+// 有效性、已绘制范围与合成，不拥有内存。
+// 已绘制范围按 kCellSize 网格记录：合成与重建清零只触及有内容的格子，
+// 零散分布的标注不会让每帧合成退化成整块选区的逐像素扫描。
+// 只有少数图形变化时可以 BeginUpdate 局部更新：只清空并重画这些图形新旧范围的并集。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ztools {
+
+class LayerCache {
+public:
+    static constexpr int kCellSize = 64;
+
+    // 绑定层像素（调用方保证在使用期间有效）；原有内容视为无效，下次 BeginRebuild 会整体清零
+    void Attach(const ImageView& pixels);
+    void Detach() { Attach(ImageView()); }
+
+    bool Attached() const { return !pixels_.Empty(); }
+    const ImageView& pixels() const { return pixels_; }
+
+    // 层当前内容是否对应 key
+    bool IsValid(std::uint64_t key) const { return valid_ && key_ == key; }
+    void Invalidate() { valid_ = false; }
+
+    // 开始按 key 重建：清空上次绘制过的范围并返回层像素，调用方随后在其上绘制，
+    // 并用 MarkDrawn / MarkDrawnByAlpha 登记实际绘制的范围
+    ImageView BeginRebuild(std::uint64_t key);
+    // 局部更新到 key：层内容仍对应某个旧 key 时只清空 damage（层坐标）内的像素，
+    // 调用方随后只在 damage 内重画（裁剪到 damage）并重新登记其中的范围；
+    // 层还没有建好（刚绑定 / 已失效）时等同 BeginRebuild，调用方需用 Built() 判断是否要整层重画
+    ImageView BeginUpdate(std::uint64_t key, const IntRect& damage);
+    bool Built() const { return valid_; }
+    void MarkDrawn(const IntRect& rect);
+    // 扫描 rect 内 alpha 非零的像素并按格登记（绘制方无法给出精确范围时使用，如 GDI+ 抗锯齿 / 文字）
+    void MarkDrawnByAlpha(const IntRect& rect);
+
+    // 层上有内容的范围（层坐标，保守外包）
+    const IntRect& ContentBounds() const { return content_; }
+    // 按行优先遍历需要合成的目标矩形：有内容的格子按行合并成横向连续段，
+    // 映射到目标坐标（+offset）并与 clip、内容范围求交（GDI 侧对每段调用一次 AlphaBlend）
+    void ForEachRun(int offsetX, int offsetY, const IntRect& clip, const std::function<void(const IntRect&)>& fn) const;
+    // 层像素 (x, y) 落在 dst 的 (x + offsetX, y + offsetY)；只合成 clip（dst 坐标）与内容范围的交集
+    void CompositeOnto(const ImageView& dst, int offsetX, int offsetY, const IntRect& clip) const;
+    // 内容范围映射到目标坐标并与 clip 求交（所有合成段的外包）
+    IntRect CompositeRect(int offsetX, int offsetY, const IntRect& clip) const;
+
+    std::uint64_t Rebuilds() const { return rebuilds_; }
+    std::uint64_t Updates() const { return updates_; }
+
+private:
+    void MarkCells(const IntRect& rect);
+
+    ImageView pixels_;
+    IntRect content_;
+    std::vector<std::uint8_t> cells_;  // cy * cols_ + cx，非零 = 该格有内容
+    int cols_ = 0;
+    int rows_ = 0;
+    std::uint64_t key_ = 0;
+    bool valid_ = false;
+    bool dirtyAll_ = true;  // 刚绑定的内存内容未知，重建时整层清零
+    std::uint64_t rebuilds_ = 0;
+    std::uint64_t updates_ = 0;
+};
+
+}  // namespace ztools
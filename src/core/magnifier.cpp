@@ -0,0 +1,196 @@
+#include "magnifier.h"
+
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+// 把 px 写满 dst[x, end)：不少于 4 个像素时整组写，最后一组与前一组重叠对齐到 end，没有标量尾部
+inline void FillRun(std::uint32_t* dst, int x, int end, std::uint32_t px) {
+#if defined(ZTOOLS_SIMD_SSE2)
+    if (end - x >= 4) {
+        const __m128i v = _mm_set1_epi32(static_cast<int>(px));
+        for (; x + 4 <= end; x += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), v);
+        if (x < end) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + end - 4), v);
+        return;
+    }
+#elif defined(ZTOOLS_SIMD_NEON)
+    if (end - x >= 4) {
+        const uint32x4_t v = vdupq_n_u32(px);
+        for (; x + 4 <= end; x += 4) vst1q_u32(dst + x, v);
+        if (x < end) vst1q_u32(dst + end - 4, v);
+        return;
+    }
+#endif
+    for (; x < end; x++) dst[x] = px;
+}
+
+// 一行格子横向放大：第 i 格占输出 [i * zoom - phase, (i + 1) * zoom - phase)，裁到 [0, width)
+void ExpandRow(const std::uint32_t* cells, int cols, int phase, int zoom, std::uint32_t* dst, int width) {
+    int x = 0;
+    for (int i = 0; i < cols && x < width; i++) {
+        const int end = (std::min)((i + 1) * zoom - phase, width);
+        FillRun(dst, x, end, cells[i]);
+        x = end;
+    }
+}
+
+// 以 [0, size) 为输出、中心块起点为 size / 2 - zoom / 2，算出格子数、中心格下标与首格被裁掉的像素数
+void LayoutAxis(int size, int zoom, int& count, int& center, int& phase) {
+    const int first = size / 2 - zoom / 2;
+    const int before = first > 0 ? (first + zoom - 1) / zoom : 0;
+    const int afterStart = first + zoom;
+    const int after = size > afterStart ? (size - afterStart + zoom - 1) / zoom : 0;
+    count = before + 1 + after;
+    center = before;
+    phase = before * zoom - first;
+}
+
+char* AppendUint(char* p, unsigned v) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+char* AppendInt(char* p, int v) {
+    if (v < 0) {
+        *p++ = '-';
+        return AppendUint(p, 0u - static_cast<unsigned>(v));
+    }
+    return AppendUint(p, static_cast<unsigned>(v));
+}
+
+char* AppendSeparator(char* p) {
+    *p++ = ',';
+    *p++ = ' ';
+    return p;
+}
+
+}  // namespace
+
+// ==== 放大镜 ====
+
+void Magnifier::Configure(int width, int height, int zoom) {
+    zoom = (std::max)(zoom, 1);
+    if (width <= 0 || height <= 0) {
+        out_.Release();
+        cells_.clear();
+        zoom_ = zoom;
+        cols_ = rows_ = 0;
+        return;
+    }
+    if (width == out_.width() && height == out_.height() && zoom == zoom_) return;
+    out_.Allocate(width, height);
+    zoom_ = zoom;
+    LayoutAxis(width, zoom, cols_, centerCol_, phaseX_);
+    LayoutAxis(height, zoom, rows_, centerRow_, phaseY_);
+    cells_.assign(static_cast<size_t>(cols_) * rows_, 0);
+}
+
+void Magnifier::Render(const ImageView& src, int cx, int cy, std::uint32_t outside) {
+    if (out_.Empty()) return;
+
+    // 取样：整行落在源图内的部分直接 memcpy，其余填 outside
+    const int x0 = cx - centerCol_;
+    const int inBegin = (std::max)(0, -x0);
+    const int inEnd = src.data ? (std::min)(cols_, src.width - x0) : 0;
+    for (int j = 0; j < rows_; j++) {
+        std::uint32_t* row = &cells_[static_cast<size_t>(j) * cols_];
+        const int sy = cy - centerRow_ + j;
+        if (src.data == nullptr || sy < 0 || sy >= src.height || inBegin >= inEnd) {
+            std::fill(row, row + cols_, outside);
+            continue;
+        }
+        std::fill(row, row + inBegin, outside);
+        std::memcpy(row + inBegin, src.Row(sy) + x0 + inBegin, static_cast<size_t>(inEnd - inBegin) * 4);
+        std::fill(row + inEnd, row + cols_, outside);
+    }
+
+    // 放大：每行格子只展开一次，块内其余输出行整行复制
+    const ImageView out = out_.view();
+    const size_t rowBytes = static_cast<size_t>(out.width) * 4;
+    for (int j = 0; j < rows_; j++) {
+        const int y0 = (std::max)(j * zoom_ - phaseY_, 0);
+        const int y1 = (std::min)((j + 1) * zoom_ - phaseY_, out.height);
+        if (y0 >= y1) continue;
+        ExpandRow(&cells_[static_cast<size_t>(j) * cols_], cols_, phaseX_, zoom_, out.Row(y0), out.width);
+        for (int y = y0 + 1; y < y1; y++) std::memcpy(out.Row(y), out.Row(y0), rowBytes);
+    }
+}
+
+// ==== 取色读数 ====
+
+Hsl RgbToHsl(int r, int g, int b) {
+    const int maxC = (std::max)({r, g, b});
+    const int minC = (std::min)({r, g, b});
+    const int sum = maxC + minC;
+    const int d = maxC - minC;
+    Hsl hsl;
+    hsl.l = (sum * 100 + 255) / 510;  // sum / 510 * 100，四舍五入
+    if (d == 0) {
+        hsl.h = 0;
+        hsl.s = 0;
+        return hsl;
+    }
+    const int denom = 255 - std::abs(sum - 255);
+    hsl.s = (d * 200 + denom) / (denom * 2);
+    double h;
+    if (maxC == r) {
+        h = 60.0 * (g - b) / d;
+    } else if (maxC == g) {
+        h = 60.0 * (b - r) / d + 120.0;
+    } else {
+        h = 60.0 * (r - g) / d + 240.0;
+    }
+    int hue = static_cast<int>(std::lround(h));
+    if (hue < 0) hue += 360;
+    if (hue >= 360) hue -= 360;
+    hsl.h = hue;
+    return hsl;
+}
+
+void FormatColorReadout(std::uint32_t bgra, ColorReadout& out) {
+    static const char kHex[] = "0123456789ABCDEF";
+    const int r = (bgra >> 16) & 0xFF;
+    const int g = (bgra >> 8) & 0xFF;
+    const int b = bgra & 0xFF;
+
+    out.hex[0] = '#';
+    const int channels[3] = {r, g, b};
+    for (int i = 0; i < 3; i++) {
+        out.hex[1 + i * 2] = kHex[channels[i] >> 4];
+        out.hex[2 + i * 2] = kHex[channels[i] & 0xF];
+    }
+    out.hex[7] = '\0';
+
+    char* p = AppendUint(out.rgb, static_cast<unsigned>(r));
+    p = AppendUint(AppendSeparator(p), static_cast<unsigned>(g));
+    p = AppendUint(AppendSeparator(p), static_cast<unsigned>(b));
+    *p = '\0';
+
+    const Hsl hsl = RgbToHsl(r, g, b);
+    p = AppendUint(out.hsl, static_cast<unsigned>(hsl.h));
+    p = AppendUint(AppendSeparator(p), static_cast<unsigned>(hsl.s));
+    *p++ = '%';
+    p = AppendUint(AppendSeparator(p), static_cast<unsigned>(hsl.l));
+    *p++ = '%';
+    *p = '\0';
+}
+
+int FormatPoint(int x, int y, char* out) {
+    char* p = AppendInt(AppendSeparator(AppendInt(out, x)), y);
+    *p = '\0';
+    return static_cast<int>(p - out);
+}
+
+}  // namespace ztools
@@ -0,0 +1,72 @@
+#pragma once
+
+// 放大镜与取色读数（平台无关）
+// 截图信息面板与取色器共用：直接从截屏像素取鼠标周围的邻域，最近邻放大到一块常驻缓冲（尺寸不变时不再
+// 分配），每个源像素复制成 zoom x zoom 的块，行内用 SSE2 / NEON 一次写 4 个像素，块内其余行整行复制。
+// HEX / RGB / HSL 读数写进定长字符数组，不经过 sprintf，也不分配内存。鼠标每移动一次只需
+// Render + FormatColorReadout，整条路径零分配。
+
+#include "raster.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+class Magnifier {
+public:
+    // 输出 width x height 像素，每个源像素放大为 zoom x zoom；参数不变时什么都不做，改变时才重新分配
+    void Configure(int width, int height, int zoom);
+
+    // 以源像素 (cx, cy) 为中心取样并放大：该像素所在块的中心落在输出的 (width / 2, height / 2)。
+    // 落在 src 外的格子填 outside
+    void Render(const ImageView& src, int cx, int cy, std::uint32_t outside);
+
+    // 放大结果（stride = width * 4，可直接作为自上而下的 32bpp DIB 行数据）
+    ImageView view() const { return out_.view(); }
+    int zoom() const { return zoom_; }
+
+    // 本次取样的源像素网格：columns() x rows() 格，覆盖输出里出现的全部源像素（含边缘被裁掉一部分的格子）
+    int columns() const { return cols_; }
+    int rows() const { return rows_; }
+    std::uint32_t Cell(int col, int row) const { return cells_[static_cast<size_t>(row) * cols_ + col]; }
+    // 中心格在网格中的位置与颜色（即 (cx, cy) 处的像素，越界时为 outside）
+    int centerColumn() const { return centerCol_; }
+    int centerRow() const { return centerRow_; }
+    std::uint32_t Center() const { return Cell(centerCol_, centerRow_); }
+
+private:
+    Surface out_;
+    std::vector<std::uint32_t> cells_;
+    int zoom_ = 0;
+    int cols_ = 0;
+    int rows_ = 0;
+    int centerCol_ = 0;
+    int centerRow_ = 0;
+    int phaseX_ = 0;  // 第一列格子被输出左边缘裁掉的像素数
+    int phaseY_ = 0;
+};
+
+// 取色读数，均以 '\0' 结尾
+struct ColorReadout {
+    char hex[8];   // "#RRGGBB"
+    char rgb[16];  // "255, 255, 255"
+    char hsl[20];  // "360, 100%, 100%"
+};
+
+// 色相取 0~359 度，饱和度 / 亮度取 0~100（%），均四舍五入
+struct Hsl {
+    int h;
+    int s;
+    int l;
+};
+
+Hsl RgbToHsl(int r, int g, int b);
+
+// 由 BGRA 像素（与 raster.h 的 PackBgra 同一字节序，忽略 alpha）生成三种读数
+void FormatColorReadout(std::uint32_t bgra, ColorReadout& out);
+
+// 坐标读数 "x, y"（可为负，多显示器虚拟屏左上角不一定是原点）；out 至少 24 字节，返回不含 '\0' 的长度
+int FormatPoint(int x, int y, char* out);
+
+}  // namespace ztools
@@ -0,0 +1,119 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ztools {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path, size_t size) {
+    Close();
+    if (size == 0) return false;
+
+    if (path.empty()) {
+        anonymous_.assign(size, 0);
+        data_ = anonymous_.data();
+        size_ = size;
+        return true;
+    }
+
+#ifdef _WIN32
+    int wideLen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (wideLen <= 0) return false;
+    std::wstring widePath(wideLen, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], wideLen);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    // 只增不减：已有文件比请求的容量大时按文件大小映射，调小容量不会截掉已有内容
+    LARGE_INTEGER existing;
+    if (GetFileSizeEx(file, &existing) && static_cast<size_t>(existing.QuadPart) > size) {
+        size = static_cast<size_t>(existing.QuadPart);
+    }
+    LARGE_INTEGER li;
+    li.QuadPart = static_cast<LONGLONG>(size);
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, li.HighPart, li.LowPart, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<std::uint8_t*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    // 只增不减：已有文件比请求的容量大时按文件大小映射，调小容量不会截掉已有内容
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (static_cast<size_t>(st.st_size) > size) {
+        size = static_cast<size_t>(st.st_size);
+    } else if (static_cast<size_t>(st.st_size) < size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    data_ = static_cast<std::uint8_t*>(view);
+#endif
+    size_ = size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ == nullptr) return;
+
+    if (!anonymous_.empty()) {
+        anonymous_.clear();
+        anonymous_.shrink_to_fit();
+    } else {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(static_cast<HANDLE>(mapping_));
+        CloseHandle(static_cast<HANDLE>(file_));
+        mapping_ = nullptr;
+        file_ = nullptr;
+#else
+        ::munmap(data_, size_);
+        ::close(fd_);
+        fd_ = -1;
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::Flush() {
+    if (data_ == nullptr || !anonymous_.empty()) return;
+#ifdef _WIN32
+    FlushViewOfFile(data_, size_);
+#else
+    ::msync(data_, size_, MS_ASYNC);
+#endif
+}
+
+}  // namespace ztools
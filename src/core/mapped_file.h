@@ -0,0 +1,43 @@
+#pragma once
+
+// 固定大小的可读写内存映射文件（POSIX mmap / Win32 CreateFileMapping）
+// 容量在打开时确定（只增不减），之后不再重映射；path 为空时退化为进程内匿名缓冲，便于测试。
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ztools {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 打开（不存在则创建）并把文件扩展到至少 size 字节后映射；已有文件更大时按文件大小映射（size() 为实际大小）
+    bool Open(const std::string& path, size_t size);
+    void Close();
+    // 把脏页刷回磁盘（匿名缓冲时为空操作）
+    void Flush();
+
+    bool IsOpen() const { return data_ != nullptr; }
+    std::uint8_t* data() { return data_; }
+    const std::uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    std::uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<std::uint8_t> anonymous_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace ztools
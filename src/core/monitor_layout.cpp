@@ -0,0 +1,158 @@
+#include "monitor_layout.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ztools {
+
+namespace {
+
+// 点到矩形的距离平方（点在矩形内为 0）
+long long DistanceSquared(const IntRect& r, int x, int y) {
+    const long long dx = x < r.x ? r.x - x : (x >= r.Right() ? x - (r.Right() - 1) : 0);
+    const long long dy = y < r.y ? r.y - y : (y >= r.Bottom() ? y - (r.Bottom() - 1) : 0);
+    return dx * dx + dy * dy;
+}
+
+// 两个矩形之间的间隙距离平方（相交或相接为 0）
+long long GapSquared(const IntRect& a, const IntRect& b) {
+    const long long dx = (std::max)({0, b.x - a.Right(), a.x - b.Right()});
+    const long long dy = (std::max)({0, b.y - a.Bottom(), a.y - b.Bottom()});
+    return dx * dx + dy * dy;
+}
+
+// piece 减去 cut，剩余部分（至多 4 块，上下整宽、左右只覆盖重叠高度）追加到 out
+void Subtract(const IntRect& piece, const IntRect& cut, std::vector<IntRect>& out) {
+    const IntRect k = piece.Intersect(cut);
+    if (k.Empty()) {
+        out.push_back(piece);
+        return;
+    }
+    const IntRect parts[4] = {
+        IntRect::FromLTRB(piece.x, piece.y, piece.Right(), k.y),
+        IntRect::FromLTRB(piece.x, k.Bottom(), piece.Right(), piece.Bottom()),
+        IntRect::FromLTRB(piece.x, k.y, k.x, k.Bottom()),
+        IntRect::FromLTRB(k.Right(), k.y, piece.Right(), k.Bottom()),
+    };
+    for (const IntRect& p : parts) {
+        if (!p.Empty()) out.push_back(p);
+    }
+}
+
+}  // namespace
+
+// ==== 显示器布局 ====
+
+MonitorLayout::MonitorLayout(std::vector<MonitorDesc> monitors) {
+    for (MonitorDesc& m : monitors) {
+        if (m.bounds.Empty()) continue;
+        if (m.dpi <= 0) m.dpi = 96;
+        bounds_ = bounds_.Union(m.bounds);
+        monitors_.push_back(m);
+    }
+}
+
+int MonitorLayout::Primary() const {
+    for (int i = 0; i < count(); i++) {
+        if (monitors_[i].primary) return i;
+    }
+    return empty() ? -1 : 0;
+}
+
+bool MonitorLayout::UniformDpi() const {
+    for (const MonitorDesc& m : monitors_) {
+        if (m.dpi != monitors_.front().dpi) return false;
+    }
+    return true;
+}
+
+int MonitorLayout::IndexAt(int x, int y) const {
+    int best = -1;
+    long long bestDistance = 0;
+    for (int i = 0; i < count(); i++) {
+        const long long d = DistanceSquared(monitors_[i].bounds, x, y);
+        if (d == 0) return i;
+        if (best < 0 || d < bestDistance) {
+            best = i;
+            bestDistance = d;
+        }
+    }
+    return best;
+}
+
+int MonitorLayout::IndexForRect(const IntRect& rect) const {
+    if (empty()) return -1;
+    if (rect.Empty()) return IndexAt(rect.x, rect.y);
+    int best = -1;
+    long long bestArea = 0;
+    for (int i = 0; i < count(); i++) {
+        const IntRect k = monitors_[i].bounds.Intersect(rect);
+        const long long area = static_cast<long long>(k.w) * k.h;
+        if (!k.Empty() && area > bestArea) {
+            best = i;
+            bestArea = area;
+        }
+    }
+    if (best >= 0) return best;
+    long long bestGap = 0;
+    for (int i = 0; i < count(); i++) {
+        const long long gap = GapSquared(monitors_[i].bounds, rect);
+        if (best < 0 || gap < bestGap) {
+            best = i;
+            bestGap = gap;
+        }
+    }
+    return best;
+}
+
+int MonitorLayout::DpiAt(int x, int y) const {
+    const int index = IndexAt(x, y);
+    return index >= 0 ? monitors_[index].dpi : 96;
+}
+
+void MonitorLayout::Coverage(const IntRect& rect, std::vector<IntRect>& out) const {
+    const size_t first = out.size();
+    std::vector<IntRect> pieces, next;
+    for (const MonitorDesc& m : monitors_) {
+        pieces.assign(1, m.bounds.Intersect(rect));
+        if (pieces.front().Empty()) continue;
+        // 减去已覆盖的部分，重叠的显示器（克隆 / 异常布局）只抓一次
+        for (size_t i = first; i < out.size() && !pieces.empty(); i++) {
+            next.clear();
+            for (const IntRect& p : pieces) Subtract(p, out[i], next);
+            pieces.swap(next);
+        }
+        out.insert(out.end(), pieces.begin(), pieces.end());
+    }
+}
+
+long long MonitorLayout::CoveredArea(const IntRect& rect) const {
+    std::vector<IntRect> rects;
+    Coverage(rect, rects);
+    long long area = 0;
+    for (const IntRect& r : rects) area += static_cast<long long>(r.w) * r.h;
+    return area;
+}
+
+int ScaleForDpi(int v, int dpi) {
+    const long long scaled = static_cast<long long>(v) * dpi;
+    return static_cast<int>(scaled >= 0 ? (scaled + 48) / 96 : -((-scaled + 48) / 96));
+}
+
+// ==== 截图启动耗时 ====
+
+void CaptureStartMeter::Record(int monitors, Duration elapsed) {
+    auto it = std::lower_bound(buckets_.begin(), buckets_.end(), monitors,
+                               [](const Bucket& b, int n) { return b.monitors < n; });
+    if (it == buckets_.end() || it->monitors != monitors) {
+        Bucket bucket;
+        bucket.monitors = monitors;
+        it = buckets_.insert(it, bucket);
+    }
+    it->count++;
+    it->last = elapsed;
+    it->max = (std::max)(it->max, elapsed);
+    it->total += elapsed;
+}
+
+}  // namespace ztools
@@ -0,0 +1,84 @@
+#pragma once
+
+// 多显示器几何与 DPI 映射（平台无关）
+// Win32 侧以每显示器 DPI 感知枚举显示器（物理像素矩形 + 有效 DPI）后交给这里，负责：
+// 虚拟屏外包矩形、点 / 矩形归属哪个显示器（与 MonitorFromPoint / MonitorFromRect 的 DEFAULTTONEAREST 一致）、
+// 按所在显示器的 DPI 换算界面尺寸，以及截屏时只抓显示器实际覆盖的区域（不规则排列时外包矩形里的空洞不抓）。
+// 同时按截取的显示器数量统计截图启动耗时。
+
+#include "raster.h"
+
+#include <chrono>
+#include <vector>
+
+namespace ztools {
+
+struct MonitorDesc {
+    IntRect bounds;  // 物理像素，虚拟屏坐标
+    int dpi = 96;    // 有效 DPI（100% 缩放为 96）
+    bool primary = false;
+
+    double Scale() const { return dpi / 96.0; }
+};
+
+class MonitorLayout {
+public:
+    MonitorLayout() = default;
+    // 空矩形被丢弃，dpi <= 0 视为 96
+    explicit MonitorLayout(std::vector<MonitorDesc> monitors);
+
+    int count() const { return static_cast<int>(monitors_.size()); }
+    bool empty() const { return monitors_.empty(); }
+    const MonitorDesc& operator[](int index) const { return monitors_[index]; }
+    const std::vector<MonitorDesc>& monitors() const { return monitors_; }
+
+    // 全部显示器的外包矩形（空布局为空矩形）
+    IntRect Bounds() const { return bounds_; }
+    // 主显示器下标；没有标记主显示器时为 0，空布局为 -1
+    int Primary() const;
+    bool UniformDpi() const;
+
+    // 包含该点的显示器；不在任何显示器上时取距离最近的；空布局为 -1
+    int IndexAt(int x, int y) const;
+    // 与 rect 相交面积最大的显示器；都不相交时取离 rect 最近的；空布局为 -1
+    int IndexForRect(const IntRect& rect) const;
+    // 该点所在（或最近）显示器的 DPI，空布局为 96
+    int DpiAt(int x, int y) const;
+
+    // rect 中被显示器覆盖的部分，两两不相交（显示器重叠时只算一次），按显示器顺序追加到 out
+    void Coverage(const IntRect& rect, std::vector<IntRect>& out) const;
+    long long CoveredArea(const IntRect& rect) const;
+
+private:
+    std::vector<MonitorDesc> monitors_;
+    IntRect bounds_;
+};
+
+// 把 96 DPI 下的设计尺寸换算到 dpi 下的像素：round(v * dpi / 96)
+int ScaleForDpi(int v, int dpi);
+
+// 截图启动耗时（从开始截屏到覆盖层可以绘制），按本次截取的显示器数量分组
+class CaptureStartMeter {
+public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct Bucket {
+        int monitors = 0;
+        int count = 0;
+        Duration last{};
+        Duration max{};
+        Duration total{};
+
+        Duration Average() const { return count > 0 ? total / count : Duration::zero(); }
+    };
+
+    void Record(int monitors, Duration elapsed);
+    // 按显示器数量升序
+    const std::vector<Bucket>& buckets() const { return buckets_; }
+    void Reset() { buckets_.clear(); }
+
+private:
+    std::vector<Bucket> buckets_;
+};
+
+}  // namespace ztools
@@ -0,0 +1,207 @@
+#include "mosaic.h"
+
+#include "parallel.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ztools {
+
+namespace {
+
+// 16 位列和最多容纳 257 行（255 * 257 = 65535），超过时（极端缩放 / 超大块）走 32 位标量路径
+constexpr int kMaxRowsU16 = 257;
+
+// 把 src 中 [rowBegin, rowEnd) 行、[byteBegin, byteEnd) 字节范围纵向累加到 colSum（按字节下标对齐）
+void AccumulateRowsU16(const ImageView& src, int rowBegin, int rowEnd, int byteBegin, int byteEnd,
+                       std::uint16_t* colSum) {
+    int x = byteBegin;
+#if defined(ZTOOLS_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= byteEnd; x += 16) {
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+        for (int y = rowBegin; y < rowEnd; y++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data + static_cast<ptrdiff_t>(y) * src.stride + x));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(colSum + x), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(colSum + x + 8), hi);
+    }
+#elif defined(ZTOOLS_SIMD_NEON)
+    for (; x + 16 <= byteEnd; x += 16) {
+        uint16x8_t lo = vdupq_n_u16(0);
+        uint16x8_t hi = vdupq_n_u16(0);
+        for (int y = rowBegin; y < rowEnd; y++) {
+            uint8x16_t v = vld1q_u8(src.data + static_cast<ptrdiff_t>(y) * src.stride + x);
+            lo = vaddw_u8(lo, vget_low_u8(v));
+            hi = vaddw_u8(hi, vget_high_u8(v));
+        }
+        vst1q_u16(colSum + x, lo);
+        vst1q_u16(colSum + x + 8, hi);
+    }
+#endif
+    for (; x < byteEnd; x++) {
+        std::uint32_t sum = 0;
+        for (int y = rowBegin; y < rowEnd; y++) sum += src.data[static_cast<ptrdiff_t>(y) * src.stride + x];
+        colSum[x] = static_cast<std::uint16_t>(sum);
+    }
+}
+
+// 横向累加 [pixBegin, pixEnd) 像素的列和，得到 BGRA 四通道总和
+void SumColumnsU16(const std::uint16_t* colSum, int pixBegin, int pixEnd, std::uint32_t out[4]) {
+    int p = pixBegin;
+#if defined(ZTOOLS_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; p + 2 <= pixEnd; p += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colSum + p * 4));
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+    }
+    alignas(16) std::uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    for (int c = 0; c < 4; c++) out[c] = lanes[c];
+#elif defined(ZTOOLS_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; p + 2 <= pixEnd; p += 2) {
+        uint16x8_t v = vld1q_u16(colSum + p * 4);
+        acc = vaddw_u16(acc, vget_low_u16(v));
+        acc = vaddw_u16(acc, vget_high_u16(v));
+    }
+    vst1q_u32(out, acc);
+#else
+    out[0] = out[1] = out[2] = out[3] = 0;
+#endif
+    for (; p < pixEnd; p++) {
+        for (int c = 0; c < 4; c++) out[c] += colSum[p * 4 + c];
+    }
+}
+
+std::uint32_t DivideColor(const std::uint32_t sum[4], std::uint32_t n) {
+    std::uint32_t out = 0;
+    for (int c = 0; c < 4; c++) out |= ((sum[c] + n / 2) / n) << (c * 8);
+    return out;
+}
+
+struct BlockRowJob {
+    const ImageView* src;
+    const ImageView* dst;
+    int dstX, dstY;    // dst 左上角在逻辑画布中的位置
+    IntRect bounds;    // 逻辑画布边界（块按它裁剪）
+    double scale;
+    int blockPx;
+    IntRect rect;      // 已裁剪到画布与 dst 范围
+    int bxFirst;       // 第一个块的左边界（网格对齐）
+    int colBegin;      // 本块行需要的物理列范围
+    int colEnd;
+};
+
+void ProcessBlockRow(const BlockRowJob& job, int by, std::vector<std::uint16_t>& col16,
+                     std::vector<std::uint32_t>& col32) {
+    const ImageView& src = *job.src;
+    const ImageView& dst = *job.dst;
+    const int bp = job.blockPx;
+
+    IntRect rowBand = IntRect(0, by, job.bounds.w, bp).Intersect(job.bounds);
+    int py0 = ScaleCoord(rowBand.y, job.scale);
+    int py1 = ScaleCoord(rowBand.Bottom(), job.scale);
+    if (py1 - py0 < 1) py1 = py0 + 1;
+    int rowBegin = (std::max)(py0, 0);
+    int rowEnd = (std::min)(py1, src.height);
+    bool rowsValid = rowEnd > rowBegin;
+    bool wide = rowEnd - rowBegin > kMaxRowsU16;
+
+    if (rowsValid) {
+        int byteBegin = job.colBegin * 4;
+        int byteEnd = job.colEnd * 4;
+        if (!wide) {
+            AccumulateRowsU16(src, rowBegin, rowEnd, byteBegin, byteEnd, col16.data());
+        } else {
+            std::fill(col32.begin() + byteBegin, col32.begin() + byteEnd, 0u);
+            for (int y = rowBegin; y < rowEnd; y++) {
+                const std::uint8_t* s = src.data + static_cast<ptrdiff_t>(y) * src.stride;
+                for (int x = byteBegin; x < byteEnd; x++) col32[x] += s[x];
+            }
+        }
+    }
+
+    int fillTop = (std::max)(rowBand.y, job.rect.y);
+    int fillBottom = (std::min)(rowBand.Bottom(), job.rect.Bottom());
+    for (int bx = job.bxFirst; bx < job.rect.Right(); bx += bp) {
+        IntRect block = IntRect(bx, rowBand.y, bp, rowBand.h).Intersect(job.bounds);
+        int px0 = ScaleCoord(block.x, job.scale);
+        int px1 = ScaleCoord(block.Right(), job.scale);
+        if (px1 - px0 < 1) px1 = px0 + 1;
+        int colBegin = (std::max)(px0, 0);
+        int colEnd = (std::min)(px1, src.width);
+
+        std::uint32_t color;
+        if (!rowsValid || colEnd <= colBegin) {
+            // 块完全落在源图外：取最近的单个像素（与参考实现一致）
+            int sx = ClampInt(px0, 0, src.width - 1);
+            int sy = ClampInt(py0, 0, src.height - 1);
+            color = src.At(sx, sy);
+        } else {
+            std::uint32_t sum[4];
+            if (!wide) {
+                SumColumnsU16(col16.data(), colBegin, colEnd, sum);
+            } else {
+                sum[0] = sum[1] = sum[2] = sum[3] = 0;
+                for (int p = colBegin; p < colEnd; p++)
+                    for (int c = 0; c < 4; c++) sum[c] += col32[p * 4 + c];
+            }
+            color = DivideColor(sum, static_cast<std::uint32_t>((colEnd - colBegin) * (rowEnd - rowBegin)));
+        }
+
+        int fillLeft = (std::max)(block.x, job.rect.x);
+        int fillRight = (std::min)(block.Right(), job.rect.Right());
+        for (int y = fillTop; y < fillBottom; y++) {
+            std::uint32_t* row = dst.Row(y - job.dstY) - job.dstX;
+            std::fill(row + fillLeft, row + fillRight, color);
+        }
+    }
+}
+
+}  // namespace
+
+void MosaicInto(const ImageView& src, double scale, int logicalW, int logicalH, const IntRect& rect,
+                const ImageView& dst, int dstX, int dstY, int blockPx, int threads) {
+    if (src.Empty() || dst.Empty() || blockPx < 1 || logicalW <= 0 || logicalH <= 0) return;
+    IntRect bounds(0, 0, logicalW, logicalH);
+    IntRect r = rect.Intersect(bounds).Intersect(IntRect(dstX, dstY, dst.width, dst.height));
+    if (r.Empty()) return;
+
+    BlockRowJob job;
+    job.src = &src;
+    job.dst = &dst;
+    job.dstX = dstX;
+    job.dstY = dstY;
+    job.bounds = bounds;
+    job.scale = scale;
+    job.blockPx = blockPx;
+    job.rect = r;
+    job.bxFirst = (r.x / blockPx) * blockPx;
+    int bxLast = (std::min)(((r.Right() + blockPx - 1) / blockPx) * blockPx, logicalW);
+    job.colBegin = ClampInt(ScaleCoord(job.bxFirst, scale), 0, src.width);
+    job.colEnd = ClampInt(ScaleCoord(bxLast, scale) + 1, 0, src.width);
+
+    int byFirst = (r.y / blockPx) * blockPx;
+    int rows = (r.Bottom() - byFirst + blockPx - 1) / blockPx;
+    ParallelFor(rows, 4, [&](int begin, int end) {
+        // 每个线程一份列和缓冲，按字节下标寻址
+        std::vector<std::uint16_t> col16(static_cast<size_t>(src.width) * 4 + 16);
+        std::vector<std::uint32_t> col32;
+        if (ScaleCoord(blockPx, scale) + 1 > kMaxRowsU16) col32.resize(static_cast<size_t>(src.width) * 4);
+        for (int i = begin; i < end; i++) ProcessBlockRow(job, byFirst + i * blockPx, col16, col32);
+    }, threads);
+}
+
+void MosaicParallel(const ImageView& src, double scale, const ImageView& dst, const IntRect& rect, int blockPx,
+                    int threads) {
+    MosaicInto(src, scale, dst.width, dst.height, rect, dst, 0, 0, blockPx, threads);
+}
+
+}  // namespace ztools
@@ -0,0 +1,22 @@
+#pragma once
+
+// 马赛克内核（平台无关）：直接在截屏 DIB 位上做块平均，替代逐块两次 StretchBlt。
+// 以块行为单位：先把该块行覆盖的物理像素行纵向累加成列和（SSE2 / NEON 向量化），
+// 再对每个块横向累加列和得到平均色，最后填充目标块。块行之间互不相关，按块行多线程并行。
+// 输出与 raster.h 的参考实现 Mosaic() 逐像素一致。
+
+#include "raster.h"
+
+namespace ztools {
+
+// 参数语义同 Mosaic()；threads <= 0 时使用 DefaultThreadCount()，1 表示单线程
+void MosaicParallel(const ImageView& src, double scale, const ImageView& dst, const IntRect& rect, int blockPx,
+                    int threads = 0);
+
+// 与 MosaicParallel 相同，但目标画布（logicalW×logicalH，网格锚定其 (0,0)）只有一部分驻留在 dst 中：
+// dst 左上角对应画布 (dstX, dstY)，只写 rect ∩ dst 覆盖范围。块仍按画布边界整块取平均，
+// 因此分瓦片计算与整屏一次计算逐像素一致。
+void MosaicInto(const ImageView& src, double scale, int logicalW, int logicalH, const IntRect& rect,
+                const ImageView& dst, int dstX, int dstY, int blockPx, int threads = 0);
+
+}  // namespace ztools
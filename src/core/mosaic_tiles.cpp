@@ -0,0 +1,116 @@
+#include "mosaic_tiles.h"
+
+#include "mosaic.h"
+#include "parallel.h"
+
+namespace ztools {
+
+void MosaicTileCache::Reset(const ImageView& src, double scale, int logicalW, int logicalH) {
+    Clear();
+    src_ = src;
+    scale_ = scale;
+    width_ = logicalW > 0 ? logicalW : 0;
+    height_ = logicalH > 0 ? logicalH : 0;
+    cols_ = (width_ + kTileSize - 1) / kTileSize;
+    rows_ = (height_ + kTileSize - 1) / kTileSize;
+}
+
+void MosaicTileCache::Clear() {
+    layers_.clear();
+}
+
+MosaicTileCache::Layer* MosaicTileCache::FindLayer(int blockPx) {
+    for (Layer& layer : layers_) {
+        if (layer.blockPx == blockPx) return &layer;
+    }
+    return nullptr;
+}
+
+const MosaicTileCache::Layer* MosaicTileCache::FindLayer(int blockPx) const {
+    for (const Layer& layer : layers_) {
+        if (layer.blockPx == blockPx) return &layer;
+    }
+    return nullptr;
+}
+
+IntRect MosaicTileCache::TileRect(int tx, int ty) const {
+    return IntRect(tx * kTileSize, ty * kTileSize, kTileSize, kTileSize).Intersect(IntRect(0, 0, width_, height_));
+}
+
+bool MosaicTileCache::TileRange(const IntRect& rect, int& tx0, int& ty0, int& tx1, int& ty1) const {
+    IntRect r = rect.Intersect(IntRect(0, 0, width_, height_));
+    if (r.Empty()) return false;
+    tx0 = r.x / kTileSize;
+    ty0 = r.y / kTileSize;
+    tx1 = (r.Right() - 1) / kTileSize;
+    ty1 = (r.Bottom() - 1) / kTileSize;
+    return true;
+}
+
+int MosaicTileCache::Ensure(int blockPx, const IntRect& rect, int threads) {
+    if (!Ready() || blockPx < 1) return 0;
+    int tx0, ty0, tx1, ty1;
+    if (!TileRange(rect, tx0, ty0, tx1, ty1)) return 0;
+
+    Layer* layer = FindLayer(blockPx);
+    if (!layer) {
+        layers_.emplace_back();
+        layer = &layers_.back();
+        layer->blockPx = blockPx;
+        layer->tiles.resize(static_cast<size_t>(cols_) * rows_);
+    }
+
+    std::vector<int> missing;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            int index = ty * cols_ + tx;
+            if (!layer->tiles[index]) missing.push_back(index);
+        }
+    }
+    if (missing.empty()) return 0;
+
+    // 先在调用线程分配，工作线程只写各自瓦片的像素
+    for (int index : missing) {
+        IntRect tr = TileRect(index % cols_, index / cols_);
+        layer->tiles[index].reset(new Surface(tr.w, tr.h));
+    }
+    ParallelFor(static_cast<int>(missing.size()), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int index = missing[i];
+            IntRect tr = TileRect(index % cols_, index / cols_);
+            MosaicInto(src_, scale_, width_, height_, tr, layer->tiles[index]->view(), tr.x, tr.y, blockPx, 1);
+        }
+    }, threads);
+    return static_cast<int>(missing.size());
+}
+
+void MosaicTileCache::ForEachTile(int blockPx, const IntRect& rect,
+                                  const std::function<void(const IntRect&, const ImageView&)>& fn) const {
+    const Layer* layer = FindLayer(blockPx);
+    int tx0, ty0, tx1, ty1;
+    if (!layer || !TileRange(rect, tx0, ty0, tx1, ty1)) return;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            const std::unique_ptr<Surface>& tile = layer->tiles[ty * cols_ + tx];
+            if (tile) fn(TileRect(tx, ty), tile->view());
+        }
+    }
+}
+
+size_t MosaicTileCache::TileCount() const {
+    size_t count = 0;
+    for (const Layer& layer : layers_) {
+        for (const std::unique_ptr<Surface>& tile : layer.tiles) count += tile ? 1 : 0;
+    }
+    return count;
+}
+
+size_t MosaicTileCache::ByteSize() const {
+    size_t bytes = 0;
+    for (const Layer& layer : layers_) {
+        for (const std::unique_ptr<Surface>& tile : layer.tiles) bytes += tile ? tile->ByteSize() : 0;
+    }
+    return bytes;
+}
+
+}  // namespace ztools
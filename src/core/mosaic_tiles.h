@@ -0,0 +1,60 @@
+#pragma once
+
+// 马赛克 base 的稀疏瓦片缓存（平台无关）。
+// 整屏马赛克只在用户真正涂抹到的位置才需要：逻辑画布按 kTileSize 切成瓦片，
+// 首次揭示时才计算覆盖到的瓦片；每个块大小各有一层缓存，来回切换块大小不会重算。
+// 瓦片内容由 MosaicInto 按整画布网格生成，与一次性整屏 MosaicParallel 逐像素一致。
+
+#include "raster.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ztools {
+
+class MosaicTileCache {
+public:
+    static constexpr int kTileSize = 256;
+
+    // 绑定源图（物理像素，调用方保证在缓存使用期间有效）与逻辑画布尺寸，清空所有层
+    void Reset(const ImageView& src, double scale, int logicalW, int logicalH);
+    void Clear();
+
+    bool Ready() const { return !src_.Empty() && width_ > 0 && height_ > 0; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // 确保 blockPx 层中与 rect（逻辑坐标）相交的瓦片都已计算；返回本次新计算的瓦片数。
+    // 缺失的瓦片之间并行计算（threads 语义同 ParallelFor）。
+    int Ensure(int blockPx, const IntRect& rect, int threads = 0);
+
+    // 按行优先顺序遍历 blockPx 层中与 rect 相交且已计算的瓦片：fn(瓦片在画布中的矩形, 瓦片像素)
+    void ForEachTile(int blockPx, const IntRect& rect,
+                     const std::function<void(const IntRect&, const ImageView&)>& fn) const;
+
+    size_t TileCount() const;  // 所有层已计算的瓦片数
+    size_t ByteSize() const;   // 所有层瓦片像素占用
+
+private:
+    struct Layer {
+        int blockPx = 0;
+        std::vector<std::unique_ptr<Surface>> tiles;  // ty * cols + tx，未计算为空
+    };
+
+    Layer* FindLayer(int blockPx);
+    const Layer* FindLayer(int blockPx) const;
+    IntRect TileRect(int tx, int ty) const;
+    bool TileRange(const IntRect& rect, int& tx0, int& ty0, int& tx1, int& ty1) const;
+
+    ImageView src_;
+    double scale_ = 1.0;
+    int width_ = 0;
+    int height_ = 0;
+    int cols_ = 0;
+    int rows_ = 0;
+    std::vector<Layer> layers_;
+};
+
+}  // namespace ztools
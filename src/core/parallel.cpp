@@ -0,0 +1,40 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace ztools {
+
+int DefaultThreadCount() {
+    unsigned hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+    return static_cast<int>((std::min)(hw, 8u));
+}
+
+void ParallelFor(int count, int minPerTask, const std::function<void(int, int)>& fn, int maxThreads) {
+    if (count <= 0) return;
+    if (minPerTask < 1) minPerTask = 1;
+    int threads = maxThreads > 0 ? maxThreads : DefaultThreadCount();
+    threads = (std::min)(threads, (count + minPerTask - 1) / minPerTask);
+    if (threads <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    int begin = 0;
+    for (int t = 0; t < threads; t++) {
+        int end = static_cast<int>(static_cast<long long>(count) * (t + 1) / threads);
+        if (t == threads - 1) {
+            fn(begin, end);  // 最后一段由调用线程执行
+        } else {
+            workers.emplace_back(fn, begin, end);
+        }
+        begin = end;
+    }
+    for (std::thread& w : workers) w.join();
+}
+
+}  // namespace ztools
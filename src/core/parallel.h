@@ -0,0 +1,19 @@
+#pragma once
+
+// 简单的数据并行工具（平台无关）：把区间均分给若干 std::thread，调用线程也参与计算。
+// 截图编辑器里的整屏像素处理都是一次性的批量任务，按次创建线程的开销（数十微秒）可以忽略，
+// 因此不维护常驻线程池。
+
+#include <functional>
+
+namespace ztools {
+
+// 默认并行度：硬件线程数，上限 8（再多受内存带宽限制不再变快）
+int DefaultThreadCount();
+
+// 把 [0, count) 切成连续的段并行执行 fn(begin, end)。
+// 每段至少 minPerTask 个元素；maxThreads <= 0 时使用 DefaultThreadCount()。
+// 只有一段时直接在调用线程执行。
+void ParallelFor(int count, int minPerTask, const std::function<void(int, int)>& fn, int maxThreads = 0);
+
+}  // namespace ztools
@@ -0,0 +1,375 @@
+#include "raster.h"
+
+#include "box_taps.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+void ScaleNearest(const ImageView& src, const IntRect& srcRect, const ImageView& dst, const IntRect& dstRect,
+                  const IntRect& clip) {
+    std::vector<int> xs(clip.w);
+    for (int i = 0; i < clip.w; i++) {
+        std::int64_t t = static_cast<std::int64_t>(clip.x - dstRect.x) + i;
+        int sx = srcRect.x + static_cast<int>((2 * t + 1) * srcRect.w / (2 * static_cast<std::int64_t>(dstRect.w)));
+        xs[i] = ClampInt(sx, 0, src.width - 1);
+    }
+    for (int j = 0; j < clip.h; j++) {
+        std::int64_t t = static_cast<std::int64_t>(clip.y - dstRect.y) + j;
+        int sy = srcRect.y + static_cast<int>((2 * t + 1) * srcRect.h / (2 * static_cast<std::int64_t>(dstRect.h)));
+        const std::uint32_t* s = src.Row(ClampInt(sy, 0, src.height - 1));
+        std::uint32_t* d = dst.Row(clip.y + j) + clip.x;
+        for (int i = 0; i < clip.w; i++) d[i] = s[xs[i]];
+    }
+}
+
+void ScaleBilinear(const ImageView& src, const IntRect& srcRect, const ImageView& dst, const IntRect& dstRect,
+                   const IntRect& clip) {
+    // 像素中心对齐：srcPos = (dst + 0.5) * srcLen / dstLen - 0.5，16.16 定点，取 8 位小数做权重
+    auto position = [](std::int64_t t, int srcStart, int srcLen, int dstLen, int limit, int& i0, int& i1,
+                       std::uint32_t& frac) {
+        std::int64_t fixed = ((2 * t + 1) * srcLen * 65536) / (2 * static_cast<std::int64_t>(dstLen)) - 32768;
+        std::int64_t base = fixed >> 16;
+        frac = static_cast<std::uint32_t>((fixed - (base << 16)) >> 8);
+        i0 = ClampInt(srcStart + static_cast<int>(base), 0, limit - 1);
+        i1 = ClampInt(srcStart + static_cast<int>(base) + 1, 0, limit - 1);
+    };
+
+    std::vector<int> x0(clip.w), x1(clip.w);
+    std::vector<std::uint32_t> fx(clip.w);
+    for (int i = 0; i < clip.w; i++) {
+        position(clip.x - dstRect.x + i, srcRect.x, srcRect.w, dstRect.w, src.width, x0[i], x1[i], fx[i]);
+    }
+    for (int j = 0; j < clip.h; j++) {
+        int y0, y1;
+        std::uint32_t fy;
+        position(clip.y - dstRect.y + j, srcRect.y, srcRect.h, dstRect.h, src.height, y0, y1, fy);
+        const std::uint8_t* r0 = reinterpret_cast<const std::uint8_t*>(src.Row(y0));
+        const std::uint8_t* r1 = reinterpret_cast<const std::uint8_t*>(src.Row(y1));
+        std::uint8_t* d = reinterpret_cast<std::uint8_t*>(dst.Row(clip.y + j) + clip.x);
+        for (int i = 0; i < clip.w; i++) {
+            std::uint32_t w11 = fx[i] * fy;
+            std::uint32_t w10 = (256 - fx[i]) * fy;
+            std::uint32_t w01 = fx[i] * (256 - fy);
+            std::uint32_t w00 = (256 - fx[i]) * (256 - fy);
+            const std::uint8_t* p00 = r0 + x0[i] * 4;
+            const std::uint8_t* p01 = r0 + x1[i] * 4;
+            const std::uint8_t* p10 = r1 + x0[i] * 4;
+            const std::uint8_t* p11 = r1 + x1[i] * 4;
+            for (int c = 0; c < 4; c++) {
+                std::uint32_t v = p00[c] * w00 + p01[c] * w01 + p10[c] * w10 + p11[c] * w11;
+                d[i * 4 + c] = static_cast<std::uint8_t>((v + 32768) >> 16);
+            }
+        }
+    }
+}
+
+void ScaleBox(const ImageView& src, const IntRect& srcRect, const ImageView& dst, const IntRect& dstRect,
+              const IntRect& clip) {
+    // 可分离的面积平均：先水平（结果保留 4 位额外精度存为 16 位），再垂直
+    BoxTaps tx, ty;
+    BuildBoxTaps(srcRect.x, srcRect.w, src.width, dstRect.w, tx);
+    BuildBoxTaps(srcRect.y, srcRect.h, src.height, dstRect.h, ty);
+
+    const int cx0 = clip.x - dstRect.x;
+    const int rowLen = clip.w * 4;
+    const int cacheRows = ty.maxCount + 1;
+    std::vector<std::uint16_t> cache(static_cast<size_t>(cacheRows) * rowLen);
+    std::vector<int> cachedRow(cacheRows, -1);
+
+    auto horizontal = [&](int sy) -> const std::uint16_t* {
+        int slot = sy % cacheRows;
+        std::uint16_t* out = cache.data() + static_cast<size_t>(slot) * rowLen;
+        if (cachedRow[slot] == sy) return out;
+        cachedRow[slot] = sy;
+        const std::uint8_t* s = reinterpret_cast<const std::uint8_t*>(src.Row(sy));
+        for (int i = 0; i < clip.w; i++) {
+            int di = cx0 + i;
+            std::uint32_t acc[4] = {0, 0, 0, 0};
+            const int* idx = tx.index.data() + tx.offset[di];
+            const std::uint32_t* w = tx.weight.data() + tx.offset[di];
+            for (int k = 0; k < tx.count[di]; k++) {
+                const std::uint8_t* p = s + idx[k] * 4;
+                acc[0] += p[0] * w[k];
+                acc[1] += p[1] * w[k];
+                acc[2] += p[2] * w[k];
+                acc[3] += p[3] * w[k];
+            }
+            for (int c = 0; c < 4; c++) out[i * 4 + c] = static_cast<std::uint16_t>((acc[c] + 8) >> 4);
+        }
+        return out;
+    };
+
+    std::vector<const std::uint16_t*> rows(ty.maxCount);
+    for (int j = 0; j < clip.h; j++) {
+        int dj = clip.y - dstRect.y + j;
+        const int* idx = ty.index.data() + ty.offset[dj];
+        const std::uint32_t* w = ty.weight.data() + ty.offset[dj];
+        std::uint8_t* d = reinterpret_cast<std::uint8_t*>(dst.Row(clip.y + j) + clip.x);
+        if (ty.count[dj] == 1) {
+            const std::uint16_t* h = horizontal(idx[0]);
+            for (int i = 0; i < rowLen; i++) d[i] = static_cast<std::uint8_t>((h[i] + 128) >> 8);
+            continue;
+        }
+        // 同一目标行用到的源行连续且递增，环形缓存足以避免重复计算水平结果
+        int n = ty.count[dj];
+        for (int k = 0; k < n; k++) rows[k] = horizontal(idx[k]);
+        for (int i = 0; i < rowLen; i++) {
+            std::uint32_t acc = 0;
+            for (int k = 0; k < n; k++) acc += rows[k][i] * w[k];
+            d[i] = static_cast<std::uint8_t>((acc + (1u << 19)) >> 20);
+        }
+    }
+}
+
+}  // namespace
+
+// ==================== 面积平均取样表 ====================
+
+void BuildBoxTaps(int srcStart, int srcLen, int srcLimit, int dstLen, BoxTaps& taps) {
+    taps.count.assign(dstLen, 0);
+    taps.offset.assign(dstLen, 0);
+    taps.index.clear();
+    taps.weight.clear();
+    taps.maxCount = 0;
+
+    const std::int64_t unit = kBoxOne;
+    for (int i = 0; i < dstLen; i++) {
+        std::int64_t b0 = static_cast<std::int64_t>(i) * srcLen * unit / dstLen;
+        std::int64_t b1 = static_cast<std::int64_t>(i + 1) * srcLen * unit / dstLen;
+        if (b1 <= b0) b1 = b0 + 1;
+        std::int64_t total = b1 - b0;
+
+        taps.offset[i] = static_cast<int>(taps.index.size());
+        std::uint32_t sum = 0;
+        size_t heaviest = taps.index.size();
+        for (std::int64_t k = b0 >> kBoxShift; (k << kBoxShift) < b1; k++) {
+            std::int64_t lo = (std::max)(b0, k << kBoxShift);
+            std::int64_t hi = (std::min)(b1, (k + 1) << kBoxShift);
+            if (hi <= lo) continue;
+            std::uint32_t w = static_cast<std::uint32_t>(((hi - lo) * unit + total / 2) / total);
+            if (w == 0) continue;
+            if (taps.index.size() == heaviest || w > taps.weight[heaviest]) heaviest = taps.index.size();
+            taps.index.push_back(ClampInt(srcStart + static_cast<int>(k), 0, srcLimit - 1));
+            taps.weight.push_back(w);
+            sum += w;
+        }
+        // 取整误差补到权重最大的一项，保证权重和精确等于 kBoxOne
+        taps.weight[heaviest] += kBoxOne - sum;
+        taps.count[i] = static_cast<int>(taps.index.size()) - taps.offset[i];
+        taps.maxCount = (std::max)(taps.maxCount, taps.count[i]);
+    }
+}
+
+// ==================== 几何 ====================
+
+IntRect IntRect::Intersect(const IntRect& o) const {
+    int l = (std::max)(x, o.x);
+    int t = (std::max)(y, o.y);
+    int r = (std::min)(Right(), o.Right());
+    int b = (std::min)(Bottom(), o.Bottom());
+    if (r <= l || b <= t) return IntRect();
+    return FromLTRB(l, t, r, b);
+}
+
+IntRect IntRect::Union(const IntRect& o) const {
+    if (o.Empty()) return *this;
+    if (Empty()) return o;
+    return FromLTRB((std::min)(x, o.x), (std::min)(y, o.y), (std::max)(Right(), o.Right()),
+                    (std::max)(Bottom(), o.Bottom()));
+}
+
+IntRect ScaleRect(const IntRect& rect, double scale) {
+    return IntRect(ScaleCoord(rect.x, scale), ScaleCoord(rect.y, scale), ScaleCoord(rect.w, scale),
+                   ScaleCoord(rect.h, scale));
+}
+
+ImageView ImageView::Sub(const IntRect& rect) const {
+    IntRect r = rect.Intersect(Bounds());
+    if (r.Empty()) return ImageView();
+    return ImageView(data + static_cast<ptrdiff_t>(r.y) * stride + r.x * 4, r.w, r.h, stride);
+}
+
+void Surface::Allocate(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        Release();
+        return;
+    }
+    width_ = width;
+    height_ = height;
+    pixels_.assign(static_cast<size_t>(width) * height, 0);
+}
+
+void Surface::Release() {
+    pixels_.clear();
+    pixels_.shrink_to_fit();
+    width_ = 0;
+    height_ = 0;
+}
+
+// ==================== 基本操作 ====================
+
+void Fill(const ImageView& dst, const IntRect& rect, std::uint32_t color) {
+    IntRect r = rect.Intersect(dst.Bounds());
+    if (r.Empty() || dst.data == nullptr) return;
+    for (int y = r.y; y < r.Bottom(); y++) {
+        std::uint32_t* row = dst.Row(y) + r.x;
+        std::fill(row, row + r.w, color);
+    }
+}
+
+void Copy(const ImageView& src, int srcX, int srcY, const ImageView& dst, const IntRect& dstRect) {
+    if (src.Empty() || dst.Empty()) return;
+    // 同时裁剪到源和目标边界
+    IntRect r = dstRect.Intersect(dst.Bounds());
+    r = r.Intersect(IntRect(dstRect.x - srcX, dstRect.y - srcY, src.width, src.height));
+    if (r.Empty()) return;
+    int dx = srcX - dstRect.x;
+    int dy = srcY - dstRect.y;
+    for (int y = r.y; y < r.Bottom(); y++) {
+        std::memmove(dst.Row(y) + r.x, src.Row(y + dy) + r.x + dx, static_cast<size_t>(r.w) * 4);
+    }
+}
+
+void Scale(const ImageView& src, const IntRect& srcRect, const ImageView& dst, const IntRect& dstRect,
+           ScaleFilter filter) {
+    if (src.Empty() || dst.Empty() || srcRect.Empty() || dstRect.Empty()) return;
+    IntRect clip = dstRect.Intersect(dst.Bounds());
+    if (clip.Empty()) return;
+
+    if (srcRect.w == dstRect.w && srcRect.h == dstRect.h && srcRect.Intersect(src.Bounds()) == srcRect) {
+        Copy(src, srcRect.x + clip.x - dstRect.x, srcRect.y + clip.y - dstRect.y, dst, clip);
+        return;
+    }
+    switch (filter) {
+        case ScaleFilter::Nearest: ScaleNearest(src, srcRect, dst, dstRect, clip); break;
+        case ScaleFilter::Bilinear: ScaleBilinear(src, srcRect, dst, dstRect, clip); break;
+        case ScaleFilter::Box: ScaleBox(src, srcRect, dst, dstRect, clip); break;
+    }
+}
+
+void CopyFromPhysical(const ImageView& physical, double scale, const ImageView& dst, const IntRect& logicalRect,
+                      ScaleFilter filter) {
+    IntRect r = logicalRect.Intersect(dst.Bounds());
+    if (r.Empty()) return;
+    if (IsUnitScale(scale)) {
+        Copy(physical, r.x, r.y, dst, r);
+    } else {
+        Scale(physical, ScaleRect(r, scale), dst, r, filter);
+    }
+}
+
+// ==================== 混合 ====================
+
+void BlendSolid(const ImageView& dst, const IntRect& rect, std::uint32_t color, std::uint8_t alpha) {
+    IntRect r = rect.Intersect(dst.Bounds());
+    if (r.Empty() || dst.data == nullptr || alpha == 0) return;
+    if (alpha == 255) {
+        Fill(dst, r, color);
+        return;
+    }
+    const std::uint32_t inv = 255 - alpha;
+    std::uint32_t pre[4];
+    for (int c = 0; c < 4; c++) pre[c] = ((color >> (c * 8)) & 0xFF) * alpha;
+    for (int y = r.y; y < r.Bottom(); y++) {
+        std::uint8_t* p = reinterpret_cast<std::uint8_t*>(dst.Row(y) + r.x);
+        for (int i = 0; i < r.w * 4; i += 4) {
+            p[i + 0] = static_cast<std::uint8_t>(Div255(pre[0] + p[i + 0] * inv));
+            p[i + 1] = static_cast<std::uint8_t>(Div255(pre[1] + p[i + 1] * inv));
+            p[i + 2] = static_cast<std::uint8_t>(Div255(pre[2] + p[i + 2] * inv));
+            p[i + 3] = static_cast<std::uint8_t>(Div255(pre[3] + p[i + 3] * inv));
+        }
+    }
+}
+
+void BlendSolidOutside(const ImageView& dst, const IntRect& keep, std::uint32_t color, std::uint8_t alpha) {
+    IntRect all = dst.Bounds();
+    IntRect k = keep.Intersect(all);
+    if (k.Empty()) {
+        BlendSolid(dst, all, color, alpha);
+        return;
+    }
+    // 上、下整行，左、右只覆盖选区高度，四块互不重叠
+    BlendSolid(dst, IntRect::FromLTRB(0, 0, all.w, k.y), color, alpha);
+    BlendSolid(dst, IntRect::FromLTRB(0, k.Bottom(), all.w, all.h), color, alpha);
+    BlendSolid(dst, IntRect::FromLTRB(0, k.y, k.x, k.Bottom()), color, alpha);
+    BlendSolid(dst, IntRect::FromLTRB(k.Right(), k.y, all.w, k.Bottom()), color, alpha);
+}
+
+void BlendOver(const ImageView& src, int srcX, int srcY, const ImageView& dst, const IntRect& dstRect,
+               std::uint8_t globalAlpha) {
+    if (src.Empty() || dst.Empty() || globalAlpha == 0) return;
+    IntRect r = dstRect.Intersect(dst.Bounds());
+    r = r.Intersect(IntRect(dstRect.x - srcX, dstRect.y - srcY, src.width, src.height));
+    if (r.Empty()) return;
+    int dx = srcX - dstRect.x;
+    int dy = srcY - dstRect.y;
+    for (int y = r.y; y < r.Bottom(); y++) {
+        const std::uint8_t* s = reinterpret_cast<const std::uint8_t*>(src.Row(y + dy) + r.x + dx);
+        std::uint8_t* d = reinterpret_cast<std::uint8_t*>(dst.Row(y) + r.x);
+        for (int i = 0; i < r.w * 4; i += 4) {
+            if ((s[i] | s[i + 1] | s[i + 2] | s[i + 3]) == 0) continue;  // 全透明
+            std::uint32_t sa = globalAlpha == 255 ? s[i + 3] : Div255(s[i + 3] * globalAlpha);
+            std::uint32_t inv = 255 - sa;
+            for (int c = 0; c < 3; c++) {
+                std::uint32_t sc = globalAlpha == 255 ? s[i + c] : Div255(s[i + c] * globalAlpha);
+                std::uint32_t v = sc + Div255(d[i + c] * inv);
+                d[i + c] = static_cast<std::uint8_t>(v > 255 ? 255 : v);
+            }
+            std::uint32_t a = sa + Div255(d[i + 3] * inv);
+            d[i + 3] = static_cast<std::uint8_t>(a > 255 ? 255 : a);
+        }
+    }
+}
+
+// ==================== 马赛克 ====================
+
+std::uint32_t AverageColor(const ImageView& src, const IntRect& rect) {
+    IntRect r = rect.Intersect(src.Bounds());
+    if (r.Empty()) return 0;
+    std::uint64_t sum[4] = {0, 0, 0, 0};
+    for (int y = r.y; y < r.Bottom(); y++) {
+        const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(src.Row(y) + r.x);
+        for (int i = 0; i < r.w * 4; i += 4) {
+            sum[0] += p[i + 0];
+            sum[1] += p[i + 1];
+            sum[2] += p[i + 2];
+            sum[3] += p[i + 3];
+        }
+    }
+    std::uint64_t n = static_cast<std::uint64_t>(r.w) * r.h;
+    std::uint32_t out = 0;
+    for (int c = 0; c < 4; c++) out |= static_cast<std::uint32_t>((sum[c] + n / 2) / n) << (c * 8);
+    return out;
+}
+
+void Mosaic(const ImageView& src, double scale, const ImageView& dst, const IntRect& rect, int blockPx) {
+    if (src.Empty() || dst.Empty() || blockPx < 1) return;
+    IntRect r = rect.Intersect(dst.Bounds());
+    if (r.Empty()) return;
+
+    int by0 = (r.y / blockPx) * blockPx;
+    int bx0 = (r.x / blockPx) * blockPx;
+    for (int by = by0; by < r.Bottom(); by += blockPx) {
+        for (int bx = bx0; bx < r.Right(); bx += blockPx) {
+            IntRect block = IntRect(bx, by, blockPx, blockPx).Intersect(dst.Bounds());
+            // 块的物理区域按左右边界分别取整，相邻块之间不重叠也不留缝
+            IntRect phys = IntRect::FromLTRB(ScaleCoord(block.x, scale), ScaleCoord(block.y, scale),
+                                             ScaleCoord(block.Right(), scale), ScaleCoord(block.Bottom(), scale));
+            if (phys.w < 1) phys.w = 1;
+            if (phys.h < 1) phys.h = 1;
+            phys = phys.Intersect(src.Bounds());
+            if (phys.Empty()) {
+                int sx = ClampInt(ScaleCoord(block.x, scale), 0, src.width - 1);
+                int sy = ClampInt(ScaleCoord(block.y, scale), 0, src.height - 1);
+                phys = IntRect(sx, sy, 1, 1);
+            }
+            Fill(dst, block.Intersect(r), AverageColor(src, phys));
+        }
+    }
+}
+
+}  // namespace ztools
@@ -0,0 +1,145 @@
+#pragma once
+
+// 截图编辑器的光栅核心（平台无关）
+// 所有像素为 32bpp BGRA（与自上而下的 32bpp BI_RGB DIB 内存布局一致：B,G,R,A 字节序，
+// 即小端 uint32 值 0xAARRGGBB）。GDI 侧只负责把 DIB 位交给这里处理、再把结果呈现到 DC。
+// 所有函数都会把操作矩形裁剪到图像边界内，越界部分静默忽略。
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ztools {
+
+struct IntRect {
+    int x = 0, y = 0, w = 0, h = 0;
+
+    IntRect() = default;
+    IntRect(int x_, int y_, int w_, int h_) : x(x_), y(y_), w(w_), h(h_) {}
+    static IntRect FromLTRB(int l, int t, int r, int b) { return IntRect(l, t, r - l, b - t); }
+
+    int Right() const { return x + w; }
+    int Bottom() const { return y + h; }
+    bool Empty() const { return w <= 0 || h <= 0; }
+    bool Contains(int px, int py) const { return px >= x && px < x + w && py >= y && py < y + h; }
+    IntRect Intersect(const IntRect& o) const;
+    IntRect Union(const IntRect& o) const;  // 外包矩形；空矩形不参与
+    IntRect Offset(int dx, int dy) const { return IntRect(x + dx, y + dy, w, h); }
+    bool operator==(const IntRect& o) const { return x == o.x && y == o.y && w == o.w && h == o.h; }
+    bool operator!=(const IntRect& o) const { return !(*this == o); }
+};
+
+inline std::uint32_t PackBgra(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255) {
+    return (std::uint32_t(a) << 24) | (std::uint32_t(r) << 16) | (std::uint32_t(g) << 8) | b;
+}
+
+// 指向外部像素内存的视图，不拥有内存；stride 为每行字节数（可大于 width * 4）。
+// 作为源参数时只读取，不会写入。
+struct ImageView {
+    std::uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+
+    ImageView() = default;
+    ImageView(void* d, int w, int h, int s) : data(static_cast<std::uint8_t*>(d)), width(w), height(h), stride(s) {}
+
+    bool Empty() const { return data == nullptr || width <= 0 || height <= 0; }
+    IntRect Bounds() const { return IntRect(0, 0, width, height); }
+    std::uint32_t* Row(int y) const { return reinterpret_cast<std::uint32_t*>(data + static_cast<ptrdiff_t>(y) * stride); }
+    std::uint32_t& At(int x, int y) const { return Row(y)[x]; }
+    // 子视图（rect 会先裁剪到边界内）；坐标原点移到子矩形左上角
+    ImageView Sub(const IntRect& rect) const;
+};
+
+// 拥有像素内存的图像（紧凑行：stride = width * 4）
+class Surface {
+public:
+    Surface() = default;
+    Surface(int width, int height) { Allocate(width, height); }
+
+    // 重新分配并清零；尺寸不变时只清零
+    void Allocate(int width, int height);
+    void Release();
+
+    bool Empty() const { return width_ <= 0 || height_ <= 0; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int stride() const { return width_ * 4; }
+    size_t ByteSize() const { return pixels_.size() * 4; }
+    ImageView view() { return ImageView(pixels_.data(), width_, height_, stride()); }
+    ImageView view() const { return ImageView(const_cast<std::uint32_t*>(pixels_.data()), width_, height_, stride()); }
+
+private:
+    std::vector<std::uint32_t> pixels_;
+    int width_ = 0;
+    int height_ = 0;
+};
+
+// 物理像素 <-> 逻辑像素的坐标 / 矩形换算，取整方式与 GDI 路径一致：(int)(v * scale + 0.5)
+inline int ScaleCoord(int v, double scale) {
+    double s = v * scale;
+    return s >= 0 ? static_cast<int>(s + 0.5) : -static_cast<int>(-s + 0.5);
+}
+IntRect ScaleRect(const IntRect& rect, double scale);
+inline bool IsUnitScale(double scale) { return scale > 0.99 && scale < 1.01; }
+
+// 精确的 round(v / 255)，v <= 65535（两个 8 位量相乘后归一化；所有混合路径共用，同样的 alpha 结果一致）
+inline std::uint32_t Div255(std::uint32_t v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+inline int ClampInt(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// ---- 基本操作 ----
+
+void Fill(const ImageView& dst, const IntRect& rect, std::uint32_t color);
+
+// 把 src 中以 (srcX, srcY) 为左上角的区域拷贝到 dst 的 dstRect（等价于 BitBlt SRCCOPY）
+void Copy(const ImageView& src, int srcX, int srcY, const ImageView& dst, const IntRect& dstRect);
+
+enum class ScaleFilter {
+    Nearest,   // 最近邻（StretchBlt COLORONCOLOR）：放大镜、马赛克放大
+    Bilinear,  // 双线性：连续缩放
+    Box        // 面积平均（StretchBlt HALFTONE）：DPI 缩小，不丢细线
+};
+
+// 把 src 的 srcRect 缩放到 dst 的 dstRect；srcRect 超出 src 的部分按边缘像素延伸
+void Scale(const ImageView& src, const IntRect& srcRect, const ImageView& dst, const IntRect& dstRect,
+           ScaleFilter filter);
+
+// DPI 感知拷贝：physical 为物理像素截图，dst 为逻辑像素缓冲，二者原点相同。
+// 把逻辑矩形 logicalRect 从物理图按 scale 取样填入 dst；scale≈1 时退化为逐字节拷贝。
+void CopyFromPhysical(const ImageView& physical, double scale, const ImageView& dst, const IntRect& logicalRect,
+                      ScaleFilter filter = ScaleFilter::Box);
+
+// ---- 混合 ----
+
+// 常量 alpha 混合纯色（等价于 AlphaBlend + SourceConstantAlpha，AlphaFormat = 0）：
+// dst = (color * alpha + dst * (255 - alpha)) / 255，四个通道都参与
+void BlendSolid(const ImageView& dst, const IntRect& rect, std::uint32_t color, std::uint8_t alpha);
+
+// 对 keep 以外的区域做 BlendSolid（截图选区外遮罩）
+void BlendSolidOutside(const ImageView& dst, const IntRect& keep, std::uint32_t color, std::uint8_t alpha);
+
+// 预乘 alpha 的 src-over 合成（等价于 AlphaBlend + AC_SRC_ALPHA）：
+// dst = src * k + dst * (1 - srcA * k)，k = globalAlpha / 255
+void BlendOver(const ImageView& src, int srcX, int srcY, const ImageView& dst, const IntRect& dstRect,
+               std::uint8_t globalAlpha = 255);
+
+// ---- 马赛克 ----
+
+// 在 dst 的 rect 内按 blockPx 网格（网格原点为 dst 的 (0,0)）绘制马赛克：
+// 每个块的颜色为 src 中对应区域的平均值。src 与 dst 覆盖同一画面，src 的分辨率是 dst 的 scale 倍。
+// 与 rect 相交的块总是按整块（裁剪到图像边界）取平均，结果与 rect 如何划分无关，
+// 因此分块 / 分区域多次调用与一次整屏调用逐像素一致。
+// 这是逐块求和的标量参考实现；整屏处理请用 mosaic.h 的 MosaicParallel（结果逐像素相同）。
+void Mosaic(const ImageView& src, double scale, const ImageView& dst, const IntRect& rect, int blockPx);
+
+// 单块平均色（Mosaic 的参考实现，供测试与增量更新使用）
+std::uint32_t AverageColor(const ImageView& src, const IntRect& rect);
+
+}  // namespace ztools
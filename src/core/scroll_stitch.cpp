@@ -0,0 +1,382 @@
+#include "scroll_stitch.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ztools {
+
+namespace {
+
+// 每个线程至少哈希这么多行（1080p 宽约 1MB），再细分时线程启动开销超过收益
+const int kHashRowsPerTask = 256;
+
+// 锚点从滚动区开头按这么多行一段取，凑够 kMinAnchors 个就不再往下看（任一可行偏移在开头 minOverlap 行内
+// 都有对应行，多看的行只是多几张同样的票）；一个锚点都没有、却已有 kMinAnchors 行对不上时视为滚动过头
+const int kAnchorBandRows = 32;
+const int kMinAnchors = 16;
+
+inline std::uint64_t Read64(const std::uint8_t* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t Rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// 行签名只用于判等：4 路独立的 xor-乘累加（每 8 字节一次乘法，吞吐受内存带宽限制），
+// 最后按 MurmurHash3 的 fmix64 收尾。比 XXH64 的流式接口省掉缓冲与每字两次乘法。
+std::uint64_t HashRow(const std::uint8_t* p, size_t bytes) {
+    const std::uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t a = 0x243F6A8885A308D3ULL, b = 0x13198A2E03707344ULL;
+    std::uint64_t c = 0xA4093822299F31D0ULL, d = 0x082EFA98EC4E6C89ULL;
+    const std::uint8_t* end = p + bytes;
+    for (; end - p >= 32; p += 32) {
+        a = Rotl((a ^ Read64(p)) * kMul, 29);
+        b = Rotl((b ^ Read64(p + 8)) * kMul, 29);
+        c = Rotl((c ^ Read64(p + 16)) * kMul, 29);
+        d = Rotl((d ^ Read64(p + 24)) * kMul, 29);
+    }
+    for (; end - p >= 8; p += 8) a = Rotl((a ^ Read64(p)) * kMul, 29);
+    if (end - p >= 4) {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        b = Rotl((b ^ v) * kMul, 29);
+    }
+    std::uint64_t h = a ^ Rotl(b, 17) ^ Rotl(c, 31) ^ Rotl(d, 47) ^ bytes;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 忽略列数过大时整行参与
+void ClampIgnoredColumns(int width, int& left, int& right) {
+    left = (std::max)(0, left);
+    right = (std::max)(0, right);
+    if (left + right >= width) left = right = 0;
+}
+
+// 忽略列（滚动条等）的整帧签名：内容区没变而这里变了，说明画面滚动了、只是内容看不出滚了多少
+std::uint64_t HashIgnoredColumns(const ImageView& frame, int left, int right) {
+    left = (std::max)(0, left);
+    right = (std::max)(0, right);
+    if (left + right == 0 || left + right >= frame.width) return 0;
+    std::uint64_t h = 0;
+    for (int y = 0; y < frame.height; y++) {
+        const std::uint8_t* row = reinterpret_cast<const std::uint8_t*>(frame.Row(y));
+        h = Rotl(h, 5) ^ HashRow(row, static_cast<size_t>(left) * 4) ^
+            Rotl(HashRow(row + static_cast<size_t>(frame.width - right) * 4, static_cast<size_t>(right) * 4), 32);
+    }
+    return h;
+}
+
+}  // namespace
+
+// ==== 行签名 ====
+
+void HashRows(const ImageView& frame, int left, int right, std::vector<std::uint64_t>& out, int threads) {
+    out.resize(frame.Empty() ? 0 : static_cast<size_t>(frame.height));
+    if (frame.Empty()) return;
+    ClampIgnoredColumns(frame.width, left, right);
+    const size_t bytes = static_cast<size_t>(frame.width - left - right) * 4;
+    std::uint64_t* hashes = out.data();
+    ParallelFor(frame.height, kHashRowsPerTask, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) hashes[y] = HashRow(reinterpret_cast<const std::uint8_t*>(frame.Row(y) + left), bytes);
+    }, threads);
+}
+
+// ==== 滚动偏移匹配 ====
+
+template <typename RowHash>
+ScrollMatch ScrollMatcher::MatchRows(const std::vector<std::uint64_t>& prev, RowHash& cur, int verifyStride) {
+    ScrollMatch result;
+    const int n = static_cast<int>(prev.size());
+
+    int top = 0;
+    while (top < n && prev[top] == cur(top)) top++;
+    if (top == n) {
+        result.found = true;
+        result.top = n;
+        result.overlap = result.matched = n;
+        return result;
+    }
+    int bottom = 0;
+    while (bottom < n - top && prev[n - 1 - bottom] == cur(n - 1 - bottom)) bottom++;
+    result.top = top;
+    result.bottom = bottom;
+
+    const int end = n - bottom;
+    const int band = end - top;
+    const int maxOffset = band - (std::max)(1, options_.minOverlap);
+    if (maxOffset < 1) return result;
+
+    // 上一帧滚动区按哈希排序，锚点行在其中唯一出现时才投票
+    index_.clear();
+    for (int r = top; r < end; r++) index_.push_back({prev[r], r});
+    std::sort(index_.begin(), index_.end(), [](const Entry& a, const Entry& b) {
+        return a.hash < b.hash || (a.hash == b.hash && a.row < b.row);
+    });
+    votes_.assign(static_cast<size_t>(maxOffset) + 1, 0);
+    int anchors = 0;
+    int strays = 0;  // 在上一帧里只出现在可行偏移之外（或根本没有）的行
+    for (int r = top; r < end; r++) {
+        if (r > top && (r - top) % kAnchorBandRows == 0 &&
+            (anchors >= kMinAnchors || (anchors == 0 && strays >= kMinAnchors))) {
+            break;
+        }
+        const std::uint64_t h = cur(r);
+        // 连续相同的行（空白、分隔线）不作锚点
+        if ((r > top && cur(r - 1) == h) || (r + 1 < end && cur(r + 1) == h)) continue;
+        auto it = std::lower_bound(index_.begin(), index_.end(), h,
+                                   [](const Entry& e, std::uint64_t v) { return e.hash < v; });
+        if (it != index_.end() && it->hash == h && it + 1 != index_.end() && (it + 1)->hash == h) continue;
+        const int offset = it != index_.end() && it->hash == h ? it->row - r : 0;
+        if (offset >= 1 && offset <= maxOffset) {
+            votes_[offset]++;
+            anchors++;
+        } else {
+            strays++;
+        }
+    }
+    if (anchors == 0) return result;
+
+    // 票数最高的几个偏移逐行（或隔行抽样）复核，取一致率最高且达标的；不一致的行超出容忍数即放弃该偏移
+    const int stride = (std::max)(1, verifyStride);
+    double bestRatio = 0;
+    for (int c = 0; c < (std::max)(1, options_.maxCandidates); c++) {
+        auto best = std::max_element(votes_.begin(), votes_.end());
+        if (*best == 0) break;
+        const int offset = static_cast<int>(best - votes_.begin());
+        *best = 0;
+        const int overlap = band - offset;
+        const int samples = (overlap + stride - 1) / stride;
+        const int allowed = static_cast<int>(samples * (1.0 - options_.minMatchRatio) + 1e-9);
+        int matched = 0, misses = 0;
+        for (int r = top; r < top + overlap && misses <= allowed; r += stride) {
+            if (cur(r) == prev[r + offset]) {
+                matched++;
+            } else {
+                misses++;
+            }
+        }
+        if (misses > allowed) continue;
+        const double ratio = static_cast<double>(matched) / samples;
+        if (ratio >= options_.minMatchRatio && ratio > bestRatio) {
+            bestRatio = ratio;
+            result.found = true;
+            result.offset = offset;
+            result.overlap = overlap;
+            result.matched = matched;
+        }
+    }
+    return result;
+}
+
+ScrollMatch ScrollMatcher::Match(const std::vector<std::uint64_t>& prev, const std::vector<std::uint64_t>& cur) {
+    if (prev.empty() || cur.size() != prev.size()) return ScrollMatch();
+    auto row = [&](int r) { return cur[r]; };
+    return MatchRows(prev, row, 1);
+}
+
+ScrollMatch ScrollMatcher::Match(const std::vector<std::uint64_t>& prev, const ImageView& frame, int left, int right,
+                                 std::vector<std::uint64_t>& cur, int threads) {
+    if (prev.empty() || frame.Empty() || static_cast<size_t>(frame.height) != prev.size()) return ScrollMatch();
+    ClampIgnoredColumns(frame.width, left, right);
+    const size_t bytes = static_cast<size_t>(frame.width - left - right) * 4;
+    const int n = frame.height;
+    cur.resize(static_cast<size_t>(n));
+    hashed_.assign(static_cast<size_t>(n), false);
+    auto hashRow = [&](int r) {
+        return HashRow(reinterpret_cast<const std::uint8_t*>(frame.Row(r) + left), bytes);
+    };
+    auto row = [&](int r) {
+        if (!hashed_[r]) {
+            cur[r] = hashRow(r);
+            hashed_[r] = true;
+        }
+        return cur[r];
+    };
+    const ScrollMatch result = MatchRows(prev, row, options_.verifyStride);
+    if (!result.found) return result;
+
+    // 复核过的偏移下，没算过的重叠行就是上一帧下移 offset 的行；剩下的（新滚入的行）补算
+    for (int r = result.top; r < result.top + result.overlap && result.offset > 0; r++) {
+        if (!hashed_[r]) {
+            cur[r] = prev[r + result.offset];
+            hashed_[r] = true;
+        }
+    }
+    ParallelFor(n, kHashRowsPerTask, [&](int begin, int end) {
+        for (int r = begin; r < end; r++) {
+            if (!hashed_[r]) cur[r] = hashRow(r);
+        }
+    }, threads);
+    return result;
+}
+
+// ==== 瓦片长图 ====
+
+void TiledImage::Reset(int width) {
+    tiles_.clear();
+    width_ = (std::max)(0, width);
+    height_ = 0;
+}
+
+size_t TiledImage::ByteSize() const {
+    return tiles_.size() * static_cast<size_t>(width_) * tileRows_ * 4;
+}
+
+int TiledImage::AppendRows(const ImageView& src, int srcY, int rows) {
+    if (src.Empty() || src.width != width_ || width_ == 0) return 0;
+    const int from = (std::max)(0, srcY);
+    const int to = (std::min)(src.height, srcY + rows);
+    const size_t bytes = static_cast<size_t>(width_) * 4;
+    for (int y = from; y < to; y++) {
+        const size_t tile = static_cast<size_t>(height_ / tileRows_);
+        // 瓦片不清零：已使用的行都由追加写入，读取只到 height_
+        if (tile == tiles_.size()) tiles_.emplace_back(new std::uint32_t[static_cast<size_t>(width_) * tileRows_]);
+        std::memcpy(tiles_[tile].get() + static_cast<size_t>(height_ % tileRows_) * width_, src.Row(y), bytes);
+        height_++;
+    }
+    return (std::max)(0, to - from);
+}
+
+void TiledImage::TruncateRows(int rows) {
+    height_ -= (std::max)(0, (std::min)(rows, height_));
+    const size_t keep = static_cast<size_t>(tileCount()) + 1;
+    if (tiles_.size() > keep) tiles_.resize(keep);
+}
+
+ImageView TiledImage::Tile(int index) const {
+    if (index < 0 || index >= tileCount()) return ImageView();
+    return ImageView(tiles_[index].get(), width_, (std::min)(tileRows_, height_ - index * tileRows_), width_ * 4);
+}
+
+std::uint32_t* TiledImage::Row(int y) const {
+    return tiles_[y / tileRows_].get() + static_cast<size_t>(y % tileRows_) * width_;
+}
+
+void TiledImage::CopyTo(int srcY, const ImageView& dst) const {
+    if (dst.Empty() || width_ == 0) return;
+    const size_t bytes = static_cast<size_t>((std::min)(width_, dst.width)) * 4;
+    for (int y = 0; y < dst.height; y++) {
+        const int sy = srcY + y;
+        if (sy < 0 || sy >= height_) continue;
+        std::memcpy(dst.Row(y), Row(sy), bytes);
+    }
+}
+
+// ==== 增量拼接 ====
+
+ScrollStitcher::ScrollStitcher(const ScrollStitchOptions& options) : options_(options), matcher_(options.match) {}
+
+StitchStep ScrollStitcher::Begin(const ImageView& frame) {
+    const auto start = std::chrono::steady_clock::now();
+    StitchStep step;
+    started_ = false;
+    full_ = false;
+    stats_ = StitchStats();
+    image_.Reset(0);
+    if (frame.Empty()) return step;
+
+    frameW_ = frame.width;
+    frameH_ = frame.height;
+    HashRows(frame, options_.ignoreLeft, options_.ignoreRight, prev_, options_.threads);
+    prevIgnored_ = HashIgnoredColumns(frame, options_.ignoreLeft, options_.ignoreRight);
+    image_.Reset(frame.width);
+    const int limit = (std::max)(1, options_.maxHeight);
+    step.added = image_.AppendRows(frame, 0, (std::min)(frame.height, limit));
+    tailRows_ = step.added;
+    full_ = frame.height >= limit;
+    started_ = true;
+    step.status = frame.height > limit ? StitchStatus::Full : StitchStatus::Started;
+    step.elapsed = std::chrono::steady_clock::now() - start;
+    stats_.frames = 1;
+    stats_.busy = step.elapsed;
+    return step;
+}
+
+StitchStep ScrollStitcher::Append(const ImageView& frame) {
+    return AppendFrame(frame, nullptr);
+}
+
+StitchStep ScrollStitcher::Append(const ImageView& frame, const std::vector<std::uint64_t>& hashes) {
+    return AppendFrame(frame, &hashes);
+}
+
+StitchStep ScrollStitcher::AppendFrame(const ImageView& frame, const std::vector<std::uint64_t>* hashes) {
+    if (!started_) return Begin(frame);
+    const auto start = std::chrono::steady_clock::now();
+    StitchStep step;
+    stats_.frames++;
+    if (full_) {
+        step.status = StitchStatus::Full;
+    } else if (frame.Empty() || frame.width != frameW_ || frame.height != frameH_) {
+        stats_.misses++;
+    } else {
+        if (hashes && hashes->size() == static_cast<size_t>(frameH_)) {
+            cur_ = *hashes;
+            step.match = matcher_.Match(prev_, cur_);
+        } else {
+            step.match = matcher_.Match(prev_, frame, options_.ignoreLeft, options_.ignoreRight, cur_, options_.threads);
+        }
+        const std::uint64_t ignored = HashIgnoredColumns(frame, options_.ignoreLeft, options_.ignoreRight);
+        if (step.match.found && step.match.offset == 0 && ignored != prevIgnored_) step.match.found = false;
+        if (!step.match.found) {
+            stats_.misses++;
+        } else if (step.match.offset == 0) {
+            step.status = StitchStatus::Unchanged;
+            stats_.unchanged++;
+            prev_.swap(cur_);
+        } else {
+            // 上一帧的表尾在结果末尾：先去掉，接上新滚入的行，再补回本帧表尾。
+            // 首尾识别出的"固定"行即使只是碰巧相同的空白，这样拼出的行序也与真实内容一致。
+            const int footer = (std::min)(step.match.bottom, tailRows_);
+            const int end = frameH_ - footer;
+            const int room = options_.maxHeight - image_.height();
+            const int take = (std::min)(step.match.offset, (std::max)(0, room));
+            const int before = image_.height();
+            image_.TruncateRows(footer);
+            image_.AppendRows(frame, end - step.match.offset, take);
+            image_.AppendRows(frame, end, footer);
+            step.added = image_.height() - before;
+            // 完整追加后结果末尾即本帧去掉表头的部分
+            tailRows_ = take == step.match.offset ? frameH_ - step.match.top : footer;
+            full_ = take < step.match.offset || image_.height() >= options_.maxHeight;
+            step.status = full_ ? StitchStatus::Full : StitchStatus::Appended;
+            stats_.appended++;
+            prev_.swap(cur_);
+            prevIgnored_ = ignored;
+        }
+    }
+    step.elapsed = std::chrono::steady_clock::now() - start;
+    stats_.busy += step.elapsed;
+    return step;
+}
+
+// ==== 滚动步长 ====
+
+ScrollPacer::ScrollPacer(int frameHeight, int maxTicks)
+    : target_((std::max)(1, frameHeight / 2)), maxTicks_((std::max)(1, maxTicks)) {}
+
+void ScrollPacer::OnStep(const StitchStep& step, int ticksUsed) {
+    if (ticksUsed <= 0) return;
+    if (step.status == StitchStatus::NoOverlap) {
+        ticks_ = (std::max)(1, ticksUsed / 2);
+        return;
+    }
+    if ((step.status != StitchStatus::Appended && step.status != StitchStatus::Full) || step.match.offset <= 0) return;
+    const double observed = static_cast<double>(step.match.offset) / ticksUsed;
+    pixelsPerTick_ = pixelsPerTick_ > 0 ? (pixelsPerTick_ + observed) / 2 : observed;
+    const int ticks = static_cast<int>(std::lround(target_ / pixelsPerTick_));
+    ticks_ = (std::max)(1, (std::min)(ticks, maxTicks_));
+}
+
+}  // namespace ztools
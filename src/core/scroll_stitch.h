@@ -0,0 +1,198 @@
+#pragma once
+
+// 滚动长截图的拼接核心（平台无关）
+// Win32 侧反复截取选区、向目标窗口注入滚轮，每帧交给 ScrollStitcher：
+// 逐行算签名（64 位哈希，可忽略左右若干列，如滚动条与悬停高亮），与缓存的上一帧签名比对出滚动的行数——
+// 只在上一帧中唯一出现的行作锚点投票，候选偏移再按行复核，空白 / 重复行不会误配；
+// 本帧签名能复用就复用（Win32 侧等待画面稳定时已算过），否则只按需哈希：
+// 锚点取滚动区开头一段，复核隔行抽样，其余重叠行的签名沿用上一帧；
+// 上下不随滚动变化的行（固定表头 / 表尾）自动识别，只把新滚入的行追加到结果。
+// 结果按固定行数切成瓦片逐块增长，拼接过程中不存在整幅长图的连续缓冲，也不会因扩容整体搬移。
+
+#include "raster.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ztools {
+
+// ==== 行签名 ====
+
+// frame 每行 [left, width - right) 列的哈希写入 out（覆盖原内容）；忽略列数过大时整行参与。
+// 按行分给多个线程（threads 语义同 ParallelFor）
+void HashRows(const ImageView& frame, int left, int right, std::vector<std::uint64_t>& out, int threads = 1);
+
+// ==== 滚动偏移匹配 ====
+
+struct ScrollMatchOptions {
+    int minOverlap = 24;          // 前后两帧滚动区至少重叠的行数，少于此不认为可靠
+    double minMatchRatio = 0.9;   // 重叠段内签名一致的行占比下限（容忍光标闪烁、悬停高亮等局部重绘）
+    int maxCandidates = 4;        // 按票数复核的候选偏移个数
+    int verifyStride = 8;         // 按需哈希本帧时，复核每隔这么多行抽一行
+};
+
+struct ScrollMatch {
+    bool found = false;
+    int offset = 0;   // 内容上移的行数：cur[i] == prev[i + offset]；0 表示画面没有滚动
+    int top = 0;      // 前后两帧相同的首部行数（固定表头，也可能只是相同的空白）
+    int bottom = 0;   // 相同的尾部行数（固定表尾）
+    int overlap = 0;  // 复核的重叠行数
+    int matched = 0;  // 其中签名一致的行数（抽样复核时只计抽到的行）
+};
+
+// 复用内部缓冲，逐帧调用不再分配
+class ScrollMatcher {
+public:
+    explicit ScrollMatcher(const ScrollMatchOptions& options = {}) : options_(options) {}
+
+    const ScrollMatchOptions& options() const { return options_; }
+    // 只识别向下滚动（offset > 0）；两帧行数不同或滚动区没有可用锚点时 found = false
+    ScrollMatch Match(const std::vector<std::uint64_t>& prev, const std::vector<std::uint64_t>& cur);
+    // 本帧签名按需计算（参数语义同 HashRows）：只哈希首尾固定行、锚点所在的开头一段与复核抽到的行，
+    // 找到偏移后没算过的重叠行取上一帧对应行的签名，新滚入的行再补算。
+    // found 时 cur 为本帧完整签名（复核没抽到的重叠行按与上一帧相同计），否则内容未定义
+    ScrollMatch Match(const std::vector<std::uint64_t>& prev, const ImageView& frame, int left, int right,
+                      std::vector<std::uint64_t>& cur, int threads = 1);
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        int row;
+    };
+
+    template <typename RowHash>
+    ScrollMatch MatchRows(const std::vector<std::uint64_t>& prev, RowHash& cur, int verifyStride);
+
+    ScrollMatchOptions options_;
+    std::vector<Entry> index_;  // 上一帧滚动区的 (哈希, 行)，按哈希排序
+    std::vector<int> votes_;    // 按偏移计票
+    std::vector<bool> hashed_;  // 按需哈希时本帧哪些行已算
+};
+
+// ==== 瓦片长图 ====
+
+// 宽度固定、只在末尾增删行的图像，按 tileRows 行一块分配
+class TiledImage {
+public:
+    static constexpr int kTileRows = 256;
+
+    explicit TiledImage(int tileRows = kTileRows) : tileRows_(tileRows > 0 ? tileRows : kTileRows) {}
+
+    // 清空并设定宽度（已分配的瓦片释放）
+    void Reset(int width);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int tileRows() const { return tileRows_; }
+    int tileCount() const { return (height_ + tileRows_ - 1) / tileRows_; }  // 已使用的瓦片数
+    size_t ByteSize() const;  // 已分配的瓦片像素（含末尾一块备用）
+
+    // 把 src 的 [srcY, srcY + rows) 行追加到末尾（src 宽度须等于 width，越界部分忽略）；返回追加的行数
+    int AppendRows(const ImageView& src, int srcY, int rows);
+    // 删除末尾 rows 行；不再使用的瓦片释放（保留一块备用，去掉表尾再追加时不会反复分配）
+    void TruncateRows(int rows);
+
+    // 第 index 块瓦片中已使用的行（最后一块可能不满）
+    ImageView Tile(int index) const;
+    std::uint32_t* Row(int y) const;
+    // 把 [srcY, srcY + dst.height) 行复制到 dst（预览 / 导出时落成连续位图），越界行不写；dst 宽度取二者较小值
+    void CopyTo(int srcY, const ImageView& dst) const;
+
+private:
+    int tileRows_;
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<std::unique_ptr<std::uint32_t[]>> tiles_;  // 每块 width * tileRows 像素，行紧凑排列
+};
+
+// ==== 增量拼接 ====
+
+struct ScrollStitchOptions {
+    int ignoreLeft = 0;    // 行签名忽略的左侧列数
+    int ignoreRight = 0;   // 行签名忽略的右侧列数（滚动条）
+    int maxHeight = 20000; // 拼接结果的行数上限
+    int threads = 0;       // 行签名的并行度（语义同 ParallelFor）
+    ScrollMatchOptions match;
+};
+
+enum class StitchStatus {
+    Started,    // Begin：首帧整帧写入
+    Appended,   // 找到重叠并追加了新行
+    Unchanged,  // 画面没有滚动（连续出现说明已到底）
+    NoOverlap,  // 找不到可靠重叠（滚动过头、内容不是平移，或内容区没变而滚动条变了——滚了但看不出滚了多少），
+                // 本帧丢弃，上一帧仍作为比对基准
+    Full        // 达到 maxHeight，本帧只追加了放得下的部分，此后不再追加
+};
+
+struct StitchStep {
+    StitchStatus status = StitchStatus::NoOverlap;
+    int added = 0;  // 结果净增的行数
+    ScrollMatch match;
+    std::chrono::steady_clock::duration elapsed{};  // 签名 + 匹配 + 追加耗时
+};
+
+struct StitchStats {
+    int frames = 0;
+    int appended = 0;
+    int unchanged = 0;
+    int misses = 0;  // NoOverlap 次数
+    std::chrono::steady_clock::duration busy{};
+};
+
+class ScrollStitcher {
+public:
+    explicit ScrollStitcher(const ScrollStitchOptions& options = {});
+
+    // 以首帧开始新的拼接（清空之前的结果）；帧为空时返回 NoOverlap 且不开始
+    StitchStep Begin(const ImageView& frame);
+    // 之后每帧须与首帧同尺寸；结果 = 已拼接部分去掉上一帧的固定表尾 + 新滚入的行 + 本帧表尾
+    StitchStep Append(const ImageView& frame);
+    // hashes 为调用方已按 ignoreLeft / ignoreRight 算好的本帧行签名（如等待画面稳定时），不再重新哈希；
+    // 行数不符时按上面的重载处理
+    StitchStep Append(const ImageView& frame, const std::vector<std::uint64_t>& hashes);
+
+    bool started() const { return started_; }
+    bool full() const { return full_; }
+    const TiledImage& image() const { return image_; }
+    const StitchStats& stats() const { return stats_; }
+
+private:
+    StitchStep AppendFrame(const ImageView& frame, const std::vector<std::uint64_t>* hashes);
+
+    ScrollStitchOptions options_;
+    ScrollMatcher matcher_;
+    TiledImage image_;
+    std::vector<std::uint64_t> prev_;
+    std::vector<std::uint64_t> cur_;
+    std::uint64_t prevIgnored_ = 0;  // 上一帧忽略列的签名
+    int frameW_ = 0;
+    int frameH_ = 0;
+    int tailRows_ = 0;  // 结果末尾与上一帧末尾逐行相同的行数（去掉表尾时最多去掉这么多）
+    bool started_ = false;
+    bool full_ = false;
+    StitchStats stats_;
+};
+
+// ==== 滚动步长 ====
+
+// 每步滚轮格数：按已观测到的每格像素数，让每步滚动约半帧高（重叠足够可靠又不至于太慢）；
+// 找不到重叠时减半（调用方先把这一步滚回去再重试）
+class ScrollPacer {
+public:
+    explicit ScrollPacer(int frameHeight, int maxTicks = 10);
+
+    int ticks() const { return ticks_; }
+    // 上一步滚动了 ticksUsed 格后的拼接结果
+    void OnStep(const StitchStep& step, int ticksUsed);
+    double pixelsPerTick() const { return pixelsPerTick_; }
+
+private:
+    int target_;
+    int maxTicks_;
+    int ticks_ = 1;
+    double pixelsPerTick_ = 0;
+};
+
+}  // namespace ztools
@@ -0,0 +1,51 @@
+#include "selection_capture.h"
+
+#include <algorithm>
+
+namespace ztools {
+
+SelectionCaptureOutcome WaitForCopiedSelection(ClipboardChangeSource& source,
+                                               CopyKeyInjector& injector,
+                                               const SelectionCaptureOptions& options) {
+    SelectionCaptureOutcome outcome;
+    const auto start = source.Now();
+    const std::uint32_t before = source.SequenceNumber();
+    outcome.sequenceBefore = before;
+    outcome.sequenceAfter = before;
+
+    if (!injector.SendCopy()) {
+        outcome.status = SelectionCaptureStatus::InjectFailed;
+        outcome.totalLatency = source.Now() - start;
+        return outcome;
+    }
+
+    const auto deadline = start + options.timeout;
+    std::uint32_t seq = source.WaitForChange(before, deadline);
+    if (seq == before) {
+        outcome.status = SelectionCaptureStatus::Timeout;
+        outcome.totalLatency = source.Now() - start;
+        return outcome;
+    }
+
+    outcome.changeCount = 1;
+    outcome.firstChangeLatency = source.Now() - start;
+
+    // 静默期：多格式分批写入时等待写完，但总时长不超过 timeout + settle
+    const auto hardDeadline = deadline + options.settle;
+    while (options.settle.count() > 0) {
+        const auto now = source.Now();
+        if (now >= hardDeadline) break;
+        const auto quietDeadline = std::min<ClipboardChangeSource::TimePoint>(now + options.settle, hardDeadline);
+        const std::uint32_t next = source.WaitForChange(seq, quietDeadline);
+        if (next == seq) break;
+        seq = next;
+        outcome.changeCount++;
+    }
+
+    outcome.status = SelectionCaptureStatus::Changed;
+    outcome.sequenceAfter = seq;
+    outcome.totalLatency = source.Now() - start;
+    return outcome;
+}
+
+}  // namespace ztools
@@ -0,0 +1,61 @@
+#pragma once
+
+// 模拟复制获取选中内容的时序核心（平台无关）
+// 不再固定 Sleep：注入 Ctrl+C 后等待剪贴板序列号变化，首个变化出现后再等一个很短的静默期
+// （Edge/Chromium 会分多次写入不同格式），随即返回。
+// Win32 侧由 GetClipboardSequenceNumber + WM_CLIPBOARDUPDATE 实现事件源，测试用假剪贴板驱动。
+
+#include <chrono>
+#include <cstdint>
+
+namespace ztools {
+
+// 剪贴板变化事件源
+class ClipboardChangeSource {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+
+    virtual ~ClipboardChangeSource() = default;
+
+    virtual TimePoint Now() = 0;
+    virtual std::uint32_t SequenceNumber() = 0;
+    // 阻塞直到序列号不等于 since 或到达 deadline，返回此时的序列号
+    virtual std::uint32_t WaitForChange(std::uint32_t since, TimePoint deadline) = 0;
+};
+
+// 向前台应用注入复制快捷键
+class CopyKeyInjector {
+public:
+    virtual ~CopyKeyInjector() = default;
+    virtual bool SendCopy() = 0;
+};
+
+struct SelectionCaptureOptions {
+    // 等待目标应用写入剪贴板的上限（没有选中内容时应用不会写剪贴板，只能等到超时）
+    std::chrono::milliseconds timeout{500};
+    // 首次变化后的静默期：期间再有变化就顺延，直到静默或到达 timeout + settle
+    std::chrono::milliseconds settle{8};
+};
+
+enum class SelectionCaptureStatus {
+    Changed,       // 剪贴板已被目标应用写入
+    Timeout,       // 超时内没有任何变化
+    InjectFailed   // 快捷键注入失败
+};
+
+struct SelectionCaptureOutcome {
+    SelectionCaptureStatus status = SelectionCaptureStatus::Timeout;
+    std::uint32_t sequenceBefore = 0;
+    std::uint32_t sequenceAfter = 0;
+    int changeCount = 0;                                          // 观察到的序列号变化次数（合并后的写入批次）
+    ClipboardChangeSource::Duration firstChangeLatency{};         // 注入到首次变化
+    ClipboardChangeSource::Duration totalLatency{};               // 注入到返回
+};
+
+SelectionCaptureOutcome WaitForCopiedSelection(ClipboardChangeSource& source,
+                                               CopyKeyInjector& injector,
+                                               const SelectionCaptureOptions& options = {});
+
+}  // namespace ztools
@@ -0,0 +1,27 @@
+#pragma once
+
+// 向量指令集的编译期选择（平台无关核心共用）：x86 / x64 目标用 SSE2，ARM 目标用 NEON，其余为纯标量。
+// 各内核按 ZTOOLS_SIMD_SSE2 / ZTOOLS_SIMD_NEON 选择实现；SimdIsa() 给出当前选择，供基准输出。
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZTOOLS_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ZTOOLS_SIMD_NEON 1
+#endif
+
+namespace ztools {
+
+// 当前编译目标使用的向量指令集："sse2" / "neon" / "scalar"
+inline const char* SimdIsa() {
+#if defined(ZTOOLS_SIMD_SSE2)
+    return "sse2";
+#elif defined(ZTOOLS_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace ztools
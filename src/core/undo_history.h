@@ -0,0 +1,188 @@
+#pragma once
+
+// 结构共享的撤销 / 重做历史（平台无关，header-only 模板）。
+// 每个快照是「不可变元素节点的指针数组」：相邻快照之间未变化的元素共享同一节点，
+// 一次编辑只新建被改动元素的节点（内存 O(改动)）；撤销 / 重做时也只改写当前列表中
+// 与目标快照不同的那一段，不再整表深拷贝。
+// 编辑代码仍直接修改 std::vector<T>（原地改字段、push_back、erase 都可以），
+// 历史在 Checkpoint / Undo / Redo 时与上次同步的结果比对找出改动：
+// 按 Eq 比较对齐的公共前缀 / 后缀，中间段视为改动。
+//
+// Eq(const T&, const T&)：两元素内容是否相同（可忽略缓存类字段）
+// SizeOf(const T&)：元素占用字节估算，用于内存上限
+// Revision(const T&)（可选）：元素修订号。编辑代码每次改动元素都换一个新修订号时，
+//   修订号相同即视为未改动、不再调用 Eq，一步的比较开销只与改动元素有关，与列表总点数无关；
+//   修订号不同才用 Eq 比较内容（改了又改回原样时仍可共享节点）。
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ztools {
+
+struct UndoHistoryLimits {
+    size_t maxBytes = 32 * 1024 * 1024;  // 所有快照引用的节点总字节上限（共享节点只计一次）
+    size_t maxSteps = 200;               // 撤销步数上限
+};
+
+// 不提供修订号：每个对齐元素都用 Eq 比较
+struct NoUndoRevision {};
+
+template <typename T, typename Eq, typename SizeOf, typename Revision = NoUndoRevision>
+class SharedUndoHistory {
+public:
+    // 默认构造不能是 explicit：宿主结构体会用 `= {}` 聚合初始化（复制列表初始化）
+    SharedUndoHistory() = default;
+    explicit SharedUndoHistory(UndoHistoryLimits limits) : limits_(limits) {}
+
+    void SetLimits(const UndoHistoryLimits& limits) {
+        limits_ = limits;
+        Enforce();
+    }
+
+    // 清空历史（当前列表成为新的同步基准）
+    void Reset(const std::vector<T>& current) {
+        undo_.clear();
+        redo_.clear();
+        shadow_ = std::make_shared<const Nodes>();
+        Sync(current);
+    }
+
+    // 在修改 current 之前调用：记录当前状态为一个撤销点，并清空重做栈
+    void Checkpoint(const std::vector<T>& current) {
+        undo_.push_back(Sync(current));
+        redo_.clear();
+        Enforce();
+    }
+
+    bool Undo(std::vector<T>& current) {
+        if (undo_.empty()) return false;
+        redo_.push_back(Sync(current));
+        Snapshot target = undo_.back();
+        undo_.pop_back();
+        Apply(target, current);
+        return true;
+    }
+
+    bool Redo(std::vector<T>& current) {
+        if (redo_.empty()) return false;
+        undo_.push_back(Sync(current));
+        Snapshot target = redo_.back();
+        redo_.pop_back();
+        Apply(target, current);
+        Enforce();
+        return true;
+    }
+
+    bool CanUndo() const { return !undo_.empty(); }
+    bool CanRedo() const { return !redo_.empty(); }
+    size_t UndoDepth() const { return undo_.size(); }
+    size_t RedoDepth() const { return redo_.size(); }
+    // 仍被历史或同步基准引用的节点总字节（每个节点只计一次）
+    size_t Bytes() const { return *liveBytes_; }
+    // 累计新建的节点数（共享命中的元素不计），用于观察每步开销
+    size_t NodesCreated() const { return nodesCreated_; }
+
+private:
+    struct Node {
+        Node(const T& v, size_t b, std::shared_ptr<size_t> counter) : value(v), bytes(b), live(std::move(counter)) {
+            *live += bytes;
+        }
+        ~Node() { *live -= bytes; }
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+        T value;
+        size_t bytes;
+        std::shared_ptr<size_t> live;
+    };
+    using NodePtr = std::shared_ptr<const Node>;
+    using Nodes = std::vector<NodePtr>;
+    // 快照本身也共享：两次同步之间没有改动时沿用同一个指针数组，不再复制
+    using Snapshot = std::shared_ptr<const Nodes>;
+
+    NodePtr MakeNode(const T& value) {
+        ++nodesCreated_;
+        return std::make_shared<const Node>(value, sizeof(Node) + SizeOf()(value), liveBytes_);
+    }
+
+    static bool Same(const T& prev, const T& cur) {
+        if constexpr (!std::is_same<Revision, NoUndoRevision>::value) {
+            if (Revision()(prev) == Revision()(cur)) return true;
+        }
+        return Eq()(prev, cur);
+    }
+
+    // 让 shadow_ 与 current 一致：能对齐且内容相同的元素沿用旧节点，其余新建
+    const Snapshot& Sync(const std::vector<T>& current) {
+        const Nodes& old = *shadow_;
+        size_t n = current.size(), m = old.size();
+        Nodes next;
+        if (n == m) {
+            for (size_t i = 0; i < n; i++) {
+                if (Same(old[i]->value, current[i])) continue;
+                if (next.empty()) next = old;  // 第一处改动时才复制指针数组
+                next[i] = MakeNode(current[i]);
+            }
+            if (next.empty()) return shadow_;
+        } else {
+            size_t prefix = 0;
+            while (prefix < n && prefix < m && Same(old[prefix]->value, current[prefix])) prefix++;
+            size_t suffix = 0;
+            while (suffix < n - prefix && suffix < m - prefix
+                   && Same(old[m - 1 - suffix]->value, current[n - 1 - suffix])) {
+                suffix++;
+            }
+            next.reserve(n);
+            for (size_t i = 0; i < prefix; i++) next.push_back(old[i]);
+            for (size_t i = prefix; i < n - suffix; i++) next.push_back(MakeNode(current[i]));
+            for (size_t i = m - suffix; i < m; i++) next.push_back(old[i]);
+        }
+        shadow_ = std::make_shared<const Nodes>(std::move(next));
+        return shadow_;
+    }
+
+    // 把 current（此时与 shadow_ 一致）改写为 target：只替换节点不同的中间段
+    void Apply(const Snapshot& targetSnapshot, std::vector<T>& current) {
+        if (targetSnapshot == shadow_) return;
+        const Nodes& target = *targetSnapshot;
+        const Nodes& old = *shadow_;
+        size_t n = target.size(), m = old.size();
+        size_t prefix = 0;
+        while (prefix < n && prefix < m && target[prefix] == old[prefix]) prefix++;
+        size_t suffix = 0;
+        while (suffix < n - prefix && suffix < m - prefix && target[n - 1 - suffix] == old[m - 1 - suffix]) {
+            suffix++;
+        }
+        // 等长时逐个赋值（保留 vector 元素自身的缓冲区），否则删掉旧中间段再插入
+        if (n == m) {
+            for (size_t i = prefix; i < n - suffix; i++) {
+                if (target[i] != old[i]) current[i] = target[i]->value;
+            }
+        } else {
+            current.erase(current.begin() + prefix, current.begin() + (m - suffix));
+            std::vector<T> middle;
+            middle.reserve(n - suffix - prefix);
+            for (size_t i = prefix; i < n - suffix; i++) middle.push_back(target[i]->value);
+            current.insert(current.begin() + prefix, middle.begin(), middle.end());
+        }
+        shadow_ = targetSnapshot;
+    }
+
+    // 超出步数或内存上限时从最旧的撤销点开始丢弃（至少保留一步，便于撤销最近一次操作）
+    void Enforce() {
+        while (undo_.size() > limits_.maxSteps) undo_.pop_front();
+        while (undo_.size() > 1 && *liveBytes_ > limits_.maxBytes) undo_.pop_front();
+    }
+
+    UndoHistoryLimits limits_;
+    std::deque<Snapshot> undo_;
+    std::vector<Snapshot> redo_;
+    Snapshot shadow_ = std::make_shared<const Nodes>();  // 上次同步时 current 对应的节点
+    std::shared_ptr<size_t> liveBytes_ = std::make_shared<size_t>(0);
+    size_t nodesCreated_ = 0;
+};
+
+}  // namespace ztools
@@ -0,0 +1,80 @@
+#include "warm_frame.h"
+
+#include <algorithm>
+
+namespace ztools {
+
+void WarmFramePolicy::Configure(const WarmFrameConfig& config) {
+    if (config.ttl > Duration::zero()) config_.ttl = config.ttl;
+    if (config.minInterval > Duration::zero()) config_.minInterval = config.minInterval;
+    if (config.cpuBudget > 0.0 && config.cpuBudget <= 1.0) config_.cpuBudget = config.cpuBudget;
+}
+
+void WarmFramePolicy::SetWarm(bool warm, TimePoint now) {
+    if (warm && !warm_) earliestRefresh_ = (std::max)(earliestRefresh_, now);
+    warm_ = warm;
+}
+
+void WarmFramePolicy::Resume(TimePoint now) {
+    suspended_ = false;
+    earliestRefresh_ = (std::max)(earliestRefresh_, now);
+}
+
+std::optional<WarmFramePolicy::TimePoint> WarmFramePolicy::NextRefresh() const {
+    if (!warm_ || suspended_) return std::nullopt;
+    return earliestRefresh_;
+}
+
+std::optional<WarmFramePolicy::Duration> WarmFramePolicy::TimeUntilRefresh(TimePoint now) const {
+    std::optional<TimePoint> next = NextRefresh();
+    if (!next) return std::nullopt;
+    return *next > now ? *next - now : Duration::zero();
+}
+
+bool WarmFramePolicy::OnCaptured(TimePoint start, TimePoint end, bool ok) {
+    Duration cost = end > start ? end - start : Duration::zero();
+    stats_.busy += cost;
+    // 失败也计入节奏，避免抓不到帧时空转
+    auto budgetGap = std::chrono::duration_cast<Duration>(std::chrono::duration<double>(cost) / config_.cpuBudget);
+    Duration gap = (std::max)(config_.minInterval, budgetGap);
+    // 有效期优先：下一帧按同样耗时在本帧满 ttl 之前抓完，截图开始时手上的帧始终有效
+    if (cost < config_.ttl) gap = (std::min)(gap, config_.ttl - cost);
+    earliestRefresh_ = start + gap;
+    if (!ok) {
+        stats_.failures++;
+        return false;
+    }
+    if (suspended_) {
+        stats_.dropped++;
+        return false;
+    }
+    stats_.refreshes++;
+    hasFrame_ = true;
+    capturedAt_ = start;  // 画面内容不晚于开始时刻，年龄从这里算
+    return true;
+}
+
+bool WarmFramePolicy::Consume(TimePoint now) {
+    if (!hasFrame_) {
+        stats_.empty++;
+        return false;
+    }
+    hasFrame_ = false;
+    Duration age = now > capturedAt_ ? now - capturedAt_ : Duration::zero();
+    stats_.lastAge = age;
+    stats_.maxAge = (std::max)(stats_.maxAge, age);
+    stats_.totalAge += age;
+    if (age > config_.ttl) {
+        stats_.stale++;
+        return false;
+    }
+    stats_.hits++;
+    return true;
+}
+
+std::optional<WarmFramePolicy::Duration> WarmFramePolicy::FrameAge(TimePoint now) const {
+    if (!hasFrame_) return std::nullopt;
+    return now > capturedAt_ ? now - capturedAt_ : Duration::zero();
+}
+
+}  // namespace ztools
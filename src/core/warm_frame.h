@@ -0,0 +1,93 @@
+#pragma once
+
+// 预截屏首帧的保温策略（平台无关）
+// 不持有线程、时钟与帧本身：Win32 侧的保温线程按 TimeUntilRefresh 等待、抓帧后回报起止时间，
+// 截图开始时由 Consume 判断手上的帧是否仍在有效期内，因此可以在 Linux 上用假时钟与假抓帧做确定性测试。
+// 刷新节奏同时受两条限制：相邻两次刷新的开始至少间隔 minInterval（速率上限），
+// 且抓帧耗时占墙钟的比例不超过 cpuBudget（耗时 cost 的一次刷新开始后至少隔 cost / cpuBudget 才开始下一次）。
+// 两者都让位于有效期：只要 cost < ttl，下一次刷新最晚在 ttl - cost 后开始，保证新帧在旧帧过期前抓完
+// （抓帧很慢时宁可超出预算也不让保温帧过期；cost >= ttl 时无论如何都保不住，仍按预算节奏）。
+// 截图会话期间暂停刷新（否则会把覆盖层自己截进去），暂停期间抓到的帧一律丢弃。
+
+#include <chrono>
+#include <optional>
+
+namespace ztools {
+
+struct WarmFrameConfig {
+    using Duration = std::chrono::steady_clock::duration;
+
+    Duration ttl = std::chrono::milliseconds(500);          // 帧年龄超过此值不再交给截图
+    Duration minInterval = std::chrono::milliseconds(250);  // 保温刷新开始的最短间隔
+    double cpuBudget = 0.05;                                // 刷新耗时占墙钟的比例上限，(0, 1]（有效期优先）
+};
+
+struct WarmFrameStats {
+    using Duration = std::chrono::steady_clock::duration;
+
+    int refreshes = 0;  // 成功抓帧（含显式预抓取）
+    int failures = 0;   // 抓帧失败
+    int dropped = 0;    // 暂停期间完成、被丢弃的帧
+    int hits = 0;       // 截图开始时拿到了有效帧
+    int stale = 0;      // 有帧但已过期
+    int empty = 0;      // 没有帧
+    Duration busy{};     // 抓帧累计耗时
+    Duration lastAge{};  // 截图开始时手上帧的年龄（命中与过期都计入）
+    Duration maxAge{};
+    Duration totalAge{};
+
+    int consumes() const { return hits + stale + empty; }
+    Duration AverageAge() const {
+        int n = hits + stale;
+        return n > 0 ? totalAge / n : Duration::zero();
+    }
+};
+
+class WarmFramePolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+
+    WarmFramePolicy() = default;
+
+    // 非法值（ttl / 间隔 <= 0、预算不在 (0, 1]）保留原值
+    void Configure(const WarmFrameConfig& config);
+    const WarmFrameConfig& config() const { return config_; }
+
+    // 保温开关：开启后（满足预算时）立即刷新一次
+    void SetWarm(bool warm, TimePoint now);
+    bool warm() const { return warm_; }
+
+    // 截图会话开始 / 结束：暂停期间不刷新，恢复后立即需要新帧
+    void Suspend() { suspended_ = true; }
+    void Resume(TimePoint now);
+    bool suspended() const { return suspended_; }
+
+    // 下一次保温刷新的开始时间；未开启保温或已暂停时为 nullopt（保温线程应无限等待）
+    std::optional<TimePoint> NextRefresh() const;
+    // 距下一次刷新的时长（已到期返回 0）
+    std::optional<Duration> TimeUntilRefresh(TimePoint now) const;
+
+    // 一次抓帧（保温刷新或显式预抓取）结束。返回 false 表示调用方应丢弃这一帧（失败或处于暂停期间）
+    bool OnCaptured(TimePoint start, TimePoint end, bool ok);
+
+    // 截图开始：手上的帧年龄 <= ttl 时返回 true（命中）；无论是否命中帧都被取走
+    bool Consume(TimePoint now);
+    bool HasFrame() const { return hasFrame_; }
+    std::optional<Duration> FrameAge(TimePoint now) const;
+
+    const WarmFrameStats& stats() const { return stats_; }
+    void ResetStats() { stats_ = WarmFrameStats(); }
+
+private:
+    WarmFrameConfig config_;
+    WarmFrameStats stats_;
+    bool warm_ = false;
+    bool suspended_ = false;
+    bool hasFrame_ = false;
+    TimePoint capturedAt_{};
+    TimePoint earliestRefresh_{};  // 速率 / 预算允许的下一次刷新开始时间
+};
+
+}  // namespace ztools
@@ -3,6 +3,8 @@
 #include <windows.h>
 #include <windowsx.h>  // For GET_X_LPARAM, GET_Y_LPARAM
 #include <dwmapi.h>
+#include <d3d11.h>     // Desktop Duplication 捕获后端
+#include <dxgi1_2.h>
 #include <imm.h>       // For IME (Input Method Editor) support
 #include <commdlg.h>   // For GetSaveFileNameW（保存对话框）
 #include <shlobj.h>    // For SHGetKnownFolderPath（已知文件夹路径，如图片库）
@@ -11,9 +13,13 @@
 #include <algorithm>   // For std::min, std::max
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <cmath>      // For std::sqrt, std::fabs
+#include <cstring>    // For memcmp
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
+#include <memory>
 
 // DWMWA_CLOAKED 在较新的 Windows SDK 中定义，为了兼容性手动定义
 #ifndef DWMWA_CLOAKED
@@ -31,6 +37,24 @@ namespace Gdiplus {
 #pragma comment(lib, "msimg32.lib")
 
 #include "screenshot_windows.h"
+#include "core/brush_mask.h"
+#include "core/capture_backend.h"
+#include "core/clipboard_image.h"
+#include "core/content_hash.h"
+#include "core/damage.h"
+#include "core/dim_mask.h"
+#include "core/downscale.h"
+#include "core/export_pipeline.h"
+#include "core/hit_index.h"
+#include "core/image_encoder.h"
+#include "core/layer_cache.h"
+#include "core/magnifier.h"
+#include "core/monitor_layout.h"
+#include "core/mosaic_tiles.h"
+#include "core/raster.h"
+#include "core/scroll_stitch.h"
+#include "core/undo_history.h"
+#include "core/warm_frame.h"
 
 // ---- nanosvg：SVG 光栅化（单文件库，宏实例化）----
 // 两个 .h 必须在同一编译单元用宏实例化一次；这里在 screenshot_windows.cpp 内实例化。
@@ -47,8 +71,18 @@ static HWND g_screenshotOverlayWindow = NULL;
 static std::atomic<bool> g_isCapturing(false);
 static napi_threadsafe_function g_screenshotTsfn = nullptr;
 static std::thread g_screenshotThread;
-static const auto SC_PRIMED_FRAME_TTL = std::chrono::milliseconds(500);
+static std::atomic<std::uint64_t> g_nextExportId(1);  // 交给 JS 的导出编号，关联尺寸事件与编码事件
 
+// 本次截图的输出格式（startRegionCapture 的 options 指定，默认 PNG）；截图开始前写入，覆盖层线程只读
+struct ScreenshotOutput {
+    const ztools::ImageEncoder* encoder = nullptr;
+    ztools::EncodeOptions options;
+};
+static ScreenshotOutput g_screenshotOutput;
+// 只截鼠标所在显示器（startRegionCapture 的 options.monitor === 'cursor'）；同样在截图开始前写入
+static bool g_screenshotCursorMonitorOnly = false;
+
+// 预抓取的首帧；有效期、保温刷新节奏与帧年龄统计由 g_warmFramePolicy 决定（均受下面的互斥量保护）
 struct PrimedScreenshotFrame {
     HBITMAP bitmap = NULL;
     int vx = 0;
@@ -56,12 +90,16 @@ struct PrimedScreenshotFrame {
     int vw = 0;
     int vh = 0;
     double dpiScale = 1.0;
-    std::chrono::steady_clock::time_point capturedAt{};
     bool valid = false;
 };
 
 static PrimedScreenshotFrame g_primedScreenshotFrame;
 static std::mutex g_primedScreenshotFrameMutex;
+static ztools::WarmFramePolicy g_warmFramePolicy;
+static std::condition_variable g_warmFrameCv;  // 保温配置变化 / 截图会话结束时唤醒保温线程
+static bool g_warmFrameThreadStarted = false;
+static ztools::CaptureStartMeter g_captureStartMeter;  // 截图启动耗时，按截取的显示器数量分组（同受上面的互斥量保护）
+static ztools::RepaintStats g_lastRepaint;  // 最近一次按下到松开交互的重绘量（同受上面的互斥量保护）
 
 static void ReleasePrimedScreenshotFrameLocked() {
     if (g_primedScreenshotFrame.bitmap) {
@@ -73,7 +111,6 @@ static void ReleasePrimedScreenshotFrameLocked() {
     g_primedScreenshotFrame.vw = 0;
     g_primedScreenshotFrame.vh = 0;
     g_primedScreenshotFrame.dpiScale = 1.0;
-    g_primedScreenshotFrame.capturedAt = std::chrono::steady_clock::time_point{};
     g_primedScreenshotFrame.valid = false;
 }
 
@@ -81,7 +118,7 @@ static void ReleasePrimedScreenshotFrameLocked() {
 
 // 截图常量
 static const int SC_PANEL_WIDTH = 140;
-static const int SC_PANEL_HEIGHT = 140;
+static const int SC_PANEL_HEIGHT = 156;
 static const int SC_MAGNIFIER_HEIGHT = 74;
 static const int SC_PANEL_MARGIN = 15;
 static const int SC_PANEL_CORNER_RADIUS = 8;
@@ -163,6 +200,7 @@ struct Annotation {
                             // AT_Mosaic 框选模式的矩形起止（绝对坐标）
     std::vector<POINT> pts; // Brush 自由路径（绝对坐标）；AT_Mosaic 涂抹模式的路径（绝对坐标）
     std::wstring text;      // AT_Text 的文字内容
+    uint64_t revision;      // 内容修订号：每次改动换新值（TouchAnnotation），撤销历史据此跳过未改动的标注
     // ---- AT_Mosaic 专用 ----
     bool mosaicRect;        // true=框选区域马赛克；false=鼠标涂抹马赛克
     int mosaicSize;         // 马赛克块大小（逻辑像素）
@@ -179,6 +217,75 @@ struct Annotation {
     float textCacheW, textCacheH;        // 字形紧凑宽高
 };
 
+// 马赛克标注的蒙版签名：判断已光栅化的蒙版是否仍与标注列表对应（撤销 / 删除后需整体重建）
+struct MosaicMaskKey {
+    bool rect;
+    int x1, y1, x2, y2;
+    int radius;
+    size_t count;
+    POINT first, last;
+
+    bool operator==(const MosaicMaskKey& o) const {
+        return rect == o.rect && x1 == o.x1 && y1 == o.y1 && x2 == o.x2 && y2 == o.y2
+            && radius == o.radius && count == o.count
+            && first.x == o.first.x && first.y == o.first.y && last.x == o.last.x && last.y == o.last.y;
+    }
+    bool operator!=(const MosaicMaskKey& o) const { return !(*this == o); }
+};
+
+// 标注在命中索引中的签名：只比较几何相关字段与画笔首 / 中 / 尾点（O(1)），不同即重登记该标注。
+// 画笔只能整体平移（无缩放手柄），平移必然改变首尾点，故不必比较全部路径点。
+struct AnnotationHitKey {
+    AnnotationType type;
+    int thickness;
+    int x1, y1, x2, y2;
+    bool mosaicRect;
+    size_t count;
+    POINT first, mid, last;
+    std::wstring text;
+
+    bool operator==(const AnnotationHitKey& o) const {
+        return type == o.type && thickness == o.thickness && x1 == o.x1 && y1 == o.y1 && x2 == o.x2 && y2 == o.y2
+            && mosaicRect == o.mosaicRect && count == o.count
+            && first.x == o.first.x && first.y == o.first.y && mid.x == o.mid.x && mid.y == o.mid.y
+            && last.x == o.last.x && last.y == o.last.y && text == o.text;
+    }
+    bool operator!=(const AnnotationHitKey& o) const { return !(*this == o); }
+};
+
+// 缓存层里画着的一个标注：修订号不变则内容与绘制范围都不变，不必重新测量
+struct AnnotationLayerEntry {
+    uint64_t revision;
+    ztools::IntRect bounds;  // 包围盒 + 线宽 + 抗锯齿余量（backDC 坐标）
+};
+
+// 撤销历史比较标注内容（不含文字测量缓存：缓存只依赖 text/thickness，内容相同即可共享）
+struct AnnotationContentEq {
+    bool operator()(const Annotation& a, const Annotation& b) const {
+        return a.type == b.type && a.color == b.color && a.thickness == b.thickness
+            && a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2
+            && a.mosaicRect == b.mosaicRect && a.mosaicSize == b.mosaicSize && a.brushRadius == b.brushRadius
+            && a.pts.size() == b.pts.size()
+            && (a.pts.empty() || memcmp(a.pts.data(), b.pts.data(), a.pts.size() * sizeof(POINT)) == 0)
+            && a.text == b.text;
+    }
+};
+
+struct AnnotationHeapSize {
+    size_t operator()(const Annotation& a) const {
+        return a.pts.capacity() * sizeof(POINT) + a.text.capacity() * sizeof(wchar_t);
+    }
+};
+
+struct AnnotationRevision {
+    uint64_t operator()(const Annotation& a) const { return a.revision; }
+};
+
+// 标注撤销历史：快照间共享未改动的标注节点，每步只复制改动的标注；上限 200 步 / 32MB。
+// 修订号相同的标注直接视为未改动，只有修订号变了的才逐点比较内容
+typedef ztools::SharedUndoHistory<Annotation, AnnotationContentEq, AnnotationHeapSize, AnnotationRevision>
+    AnnotationHistory;
+
 // 粗细预设（逻辑像素，实际绘制粗细，渲染时乘 dpiScale）
 static const int SC_THICK_PRESETS[] = { 1, 2, 4 };
 static const int SC_THICK_COUNT = sizeof(SC_THICK_PRESETS) / sizeof(SC_THICK_PRESETS[0]);
@@ -328,10 +435,11 @@ static SCPanelMetrics CalcPanelMetrics(double dpiScale) {
 struct SCWindowInfo {
     HWND hwnd;
     RECT rect;
-    std::wstring title;
+    std::wstring title;    // 首次悬停时才读取（EnsureWindowTitle），枚举时不取，缩短进入截图的耗时
+    bool titleLoaded;
 };
 
-// 截图结果结构
+// 截图结果结构：确认后立即回报选区与尺寸（previewReady），编码完成后再以 isPayload 事件交出编码结果
 struct ScreenshotResult {
     bool success;
     int x;
@@ -340,7 +448,17 @@ struct ScreenshotResult {
     int y2;
     int width;
     int height;
-    std::string base64;
+    std::string base64;                // data URL；binary 时为编码后的原始字节
+    const char* format = "png";
+    const char* mimeType = "image/png";
+    bool binary = false;
+    std::uint64_t exportId = 0;
+    bool previewReady = false;
+    bool isPayload = false;
+    bool clipboard = false;
+    double submittedMs = 0;  // 确认 -> 交给导出流水线（随后覆盖层关闭）
+    double encodedMs = 0;    // 确认 -> 编码完成
+    double deliveredMs = 0;  // 确认 -> 编码与剪贴板都完成
 };
 
 // GDI 资源缓存
@@ -353,9 +471,6 @@ struct SCGdiResources {
     HFONT smallFont;
     int smallFontPx;
     int crosshairWidth;
-    // 选区外遮罩缓冲（虚拟屏幕大小，纯黑 + 常量 alpha），用于 AlphaBlend
-    HDC maskDC;
-    HBITMAP maskBitmap;
     // ---- P2 性能优化：固定样式 Pen/Brush 会话级缓存，避免每帧 Create/Delete ----
     // 工具栏分隔线笔（DrawToolbar）。
     HPEN toolbarSepPen;         // PS_SOLID, 1, RGB(230,230,230)
@@ -382,8 +497,6 @@ struct SCGdiResources {
         lf.lfCharSet = DEFAULT_CHARSET;
         wcscpy_s(lf.lfFaceName, L"微软雅黑");
         smallFont = CreateFontIndirectW(&lf);
-        maskDC = NULL;
-        maskBitmap = NULL;
         // P2：预建固定样式 Pen/Brush，会话内复用。
         toolbarSepPen = CreatePen(PS_SOLID, 1, RGB(230, 230, 230));
         textSelBrush = CreateSolidBrush(RGB(51, 153, 255));
@@ -391,29 +504,6 @@ struct SCGdiResources {
         annTextSelPen = CreatePen(PS_SOLID, 2, RGB(0, 136, 255));
     }
 
-    // 创建遮罩缓冲（纯黑位图，配合常量 alpha 实现 40%+ 半透明遮罩）
-    // 须在 CaptureContext 虚拟屏幕尺寸确定后调用
-    void InitMask(int virtualW, int virtualH) {
-        HDC screenDC = GetDC(NULL);
-        if (!screenDC) return;
-        maskDC = CreateCompatibleDC(screenDC);
-        if (maskDC) {
-            maskBitmap = CreateCompatibleBitmap(screenDC, virtualW, virtualH);
-            if (maskBitmap) {
-                SelectObject(maskDC, maskBitmap);
-                // 填充纯黑（AlphaBlend 用常量 alpha，源颜色为黑）
-                RECT rc = { 0, 0, virtualW, virtualH };
-                HBRUSH black = CreateSolidBrush(RGB(0, 0, 0));
-                FillRect(maskDC, &rc, black);
-                DeleteObject(black);
-            } else {
-                DeleteDC(maskDC);
-                maskDC = NULL;
-            }
-        }
-        ReleaseDC(NULL, screenDC);
-    }
-
     void Cleanup() {
         if (bgBrush) { DeleteObject(bgBrush); bgBrush = NULL; }
         if (borderPen) { DeleteObject(borderPen); borderPen = NULL; }
@@ -421,8 +511,6 @@ struct SCGdiResources {
         if (selectionPen) { DeleteObject(selectionPen); selectionPen = NULL; }
         if (highlightPen) { DeleteObject(highlightPen); highlightPen = NULL; }
         if (smallFont) { DeleteObject(smallFont); smallFont = NULL; }
-        if (maskBitmap) { DeleteObject(maskBitmap); maskBitmap = NULL; }
-        if (maskDC) { DeleteDC(maskDC); maskDC = NULL; }
         // P2：释放缓存的固定样式 Pen/Brush。
         if (toolbarSepPen) { DeleteObject(toolbarSepPen); toolbarSepPen = NULL; }
         if (textSelBrush) { DeleteObject(textSelBrush); textSelBrush = NULL; }
@@ -1009,13 +1097,24 @@ struct CaptureContext {
     int mouseX, mouseY;
     COLORREF currentColor;
     std::vector<SCWindowInfo> windows;
+    ztools::HitGrid windowIndex;  // windows 矩形的网格索引（编号 = z 序）
     int hoveredWindow; // -1 = none
     // 预截屏
     HBITMAP screenBitmap;
     HDC memDC;
-    // 双缓冲
+    // 预截屏像素（物理像素），供取色 / core 像素处理直接读取，由 EnsureScreenPixels 生成：
+    // 截屏位图本身就是自上而下的 32bpp DIB section 时直接指向它；否则 screenDib 为一份 DIB 副本
+    HBITMAP screenDib;
+    ztools::ImageView screenPixels;
+    // 高 DPI 下的逻辑分辨率底图：会话开始时由 screenPixels 一次性缩成，每帧恢复背景 / 放大镜都从它 1:1 取；
+    // 导出仍读物理原图（memDC）。缩放比为 1 或生成失败时为空，绘制退回 memDC
+    HBITMAP logicalBaseBitmap;
+    HDC logicalBaseDC;
+    ztools::ImageView logicalBase;
+    // 双缓冲（32bpp DIB section，backPixels 指向其像素；CPU 读写前须 GdiFlush）
     HDC backDC;
     HBITMAP backBitmap;
+    ztools::ImageView backPixels;
     // 脏区域追踪
     RECT lastPanelRect;
     RECT lastSelectionRect;
@@ -1031,11 +1130,20 @@ struct CaptureContext {
     RECT lastDrawingBox;            // 上帧 curDrawing 包围盒（绝对虚拟屏幕坐标）
     bool hasLastDrawingBox;
     bool needFullRedraw;
+    // 本帧累积的损伤矩形（backDC 坐标），WM_PAINT 只恢复 / 重绘 / 呈现这些矩形
+    ztools::DamageTracker damage;
+    // 按下到松开一次交互的重绘量统计；结束时发布到 g_lastRepaint，由 frameStats().repaint 查看
+    ztools::RepaintMeter repaintMeter;
     // DPI
     double dpiScale;
     // GDI 资源
     SCGdiResources gdi;
     SCPanelMetrics panelMetrics;
+    // 信息面板放大镜的常驻放大缓冲，面板尺寸不变时鼠标移动不再分配
+    ztools::Magnifier magnifier;
+    // 显示器布局（物理像素）与信息面板 / 尺寸标签当前所按的 DPI：混合 DPI 时跟随鼠标所在显示器
+    ztools::MonitorLayout monitors;
+    int panelDpi;
 
     // ---- 确认态：可调整选区 ----
     // 已确认的选区（绝对屏幕坐标）
@@ -1062,8 +1170,7 @@ struct CaptureContext {
 
     // ---- 标注绘制 ----
     std::vector<Annotation> annotations;   // 已提交标注
-    std::vector<std::vector<Annotation>> undoStack;
-    std::vector<std::vector<Annotation>> redoStack;
+    AnnotationHistory history;             // 撤销 / 重做（与 annotations 比对得出每步改动）
     Annotation curDrawing;                 // CS_Drawing 中正在绘制的标注
     bool hasCurDrawing;                    // curDrawing 是否有效
     int drawColorIdx;                      // 当前选中颜色索引
@@ -1079,16 +1186,31 @@ struct CaptureContext {
     HCURSOR mosaicBrushCursors[3];         // 对应 SC_MOSAIC_RADIUS_COUNT 个半径预设的光标
     bool mosaicBrushCursorsInited;
     // ---- 马赛克渲染（reveal-mask 模型，消除不连续感）----
-    // 预先把整张截图按当前块大小马赛克化得到 mosaicBase（逻辑像素，与 backDC 同尺寸）。
-    // 马赛克标注只是「蒙版」：涂抹=路径圆形区域、框选=矩形区域，揭示其背后的 mosaicBase。
-    // 这样任意区域、任意顺序叠加都连续无缝；切换块大小时只需重建 base，已揭示区域自动更新。
-    // mosaicBase 覆盖整虚拟屏幕（绝对坐标），与选区无关，resize/move 无需重建。
-    HDC mosaicBaseDC;
-    HBITMAP mosaicBaseBitmap;
-    int mosaicBaseW, mosaicBaseH;          // base 尺寸（= 虚拟屏幕逻辑尺寸）
-    int mosaicBaseBlockPx;                 // 生成 base 时的块大小（检测变更触发重建）
-    // 涂抹模式增量绘制：记录上一帧最后绘制的路径点索引（reveal 模型下未使用，保留扩展）。
-    int mosaicDrawLastIdx;
+    // 整张截图按当前块大小马赛克化得到 mosaic base（逻辑像素，与 backDC 同坐标系）。
+    // 马赛克标注只是「蒙版」：涂抹=路径圆形区域、框选=矩形区域，揭示其背后的 base。
+    // 这样任意区域、任意顺序叠加都连续无缝；切换块大小时已揭示区域自动更新。
+    // base 是按 256x256 瓦片稀疏缓存的：只在首次揭示到某瓦片时计算，每个块大小一层，
+    // 来回切换块大小不重算；与选区无关，resize/move 也无需重算。
+    ztools::MosaicTileCache mosaicTiles;
+    // 蒙版为解析式覆盖率（backDC 坐标）：mosaicMask = 已提交马赛克标注的并集（按签名缓存，追加时只画新标注），
+    // mosaicLiveMask = 正在绘制的标注（涂抹随鼠标点增量光栅化）。二者与 base 合成进揭示层 mosaicReveal
+    // （预乘 alpha），每次只重新合成变化部分的包围盒，绘制时 AlphaBlend 到目标 DC。
+    ztools::CoverageMask mosaicMask;
+    ztools::CoverageMask mosaicLiveMask;
+    ztools::StrokeRasterizer mosaicLiveStroke;
+    ztools::IntRect mosaicLiveBox;             // mosaicLiveMask 当前非零范围
+    MosaicMaskKey mosaicLiveKey;               // mosaicLiveMask 对应的标注签名
+    std::vector<MosaicMaskKey> mosaicMaskKeys; // 已并入 mosaicMask 的马赛克标注（按标注顺序）
+    HDC mosaicRevealDC;
+    HBITMAP mosaicRevealBitmap;
+    ztools::ImageView mosaicRevealView;
+    int mosaicRevealBlockPx;                   // 揭示层当前内容对应的块大小
+    // ---- 已提交标注缓存层（选区大小的预乘 alpha DIB，只重画改动标注覆盖的范围）----
+    HDC annotationLayerDC;
+    HBITMAP annotationLayerBitmap;
+    ztools::LayerCache annotationLayer;
+    ztools::IntRect annotationLayerRect;                   // 缓存层覆盖的范围（backDC 坐标，创建时的选区）
+    std::vector<AnnotationLayerEntry> annotationLayerEntries;  // 缓存层里画着的标注（按绘制顺序）
     // 粗细/颜色子菜单
     bool popupOpen;
     RECT popupRect;
@@ -1108,6 +1230,12 @@ struct CaptureContext {
     int draggingTextAnnotation;            // 正在拖动的文字标注索引（-1 表示无）
     int textDragStartX, textDragStartY;    // 文字拖动起始位置
     // ---- 非文字标注的选中/拖拽/缩放（与文字机制互斥：选中非文字时清文字选中，反之亦然）----
+    // 命中测试空间索引（按 hitKeys 比对增量重登记改动的标注，悬停查询只看鼠标所在网格）
+    ztools::HitGrid hitIndex;
+    std::vector<AnnotationHitKey> hitKeys;
+    uint64_t annotationsVersion;           // annotations 每次改动递增（MarkAnnotationsChanged）
+    uint64_t annotationRevision;           // 最近分配的标注修订号（TouchAnnotation）
+    uint64_t hitIndexVersion;              // hitIndex 已同步到的版本，相同时悬停查询不再比对签名
     int hoveredAnnotation;                 // 悬浮命中的非文字标注索引（-1=无，用于虚线框/光标即时反馈）
     int selectedAnnotation;                // 已选中的非文字标注索引（-1=无，持久保持直到点空白/进入其他操作）
     int draggingAnnotation;                // 正在拖拽的非文字标注索引（-1=无）
@@ -1135,9 +1263,20 @@ struct CaptureContext {
 // 截图上下文指针（窗口过程使用）
 static CaptureContext* g_captureCtx = nullptr;
 
+// annotations 的内容或个数改变后调用：命中索引据此判断是否需要重新比对
+static void MarkAnnotationsChanged(CaptureContext* ctx) {
+    ctx->annotationsVersion++;
+}
+
+// 新建或改动某个标注的内容后调用：换一个新修订号，下次同步撤销历史时只比较这些标注
+static void TouchAnnotation(CaptureContext* ctx, Annotation& a) {
+    a.revision = ++ctx->annotationRevision;
+}
+
+// 在修改 annotations 之前调用，记录撤销点（随后的改动与之在同一消息内完成，这里一并标记版本）
 static void PushAnnotationHistory(CaptureContext* ctx) {
-    ctx->undoStack.push_back(ctx->annotations);
-    ctx->redoStack.clear();
+    ctx->history.Checkpoint(ctx->annotations);
+    MarkAnnotationsChanged(ctx);
 }
 
 static void ResetAnnotationInteraction(CaptureContext* ctx) {
@@ -1154,19 +1293,15 @@ static void ResetAnnotationInteraction(CaptureContext* ctx) {
 }
 
 static bool UndoAnnotations(CaptureContext* ctx) {
-    if (ctx->undoStack.empty()) return false;
-    ctx->redoStack.push_back(ctx->annotations);
-    ctx->annotations = ctx->undoStack.back();
-    ctx->undoStack.pop_back();
+    if (!ctx->history.Undo(ctx->annotations)) return false;
+    MarkAnnotationsChanged(ctx);
     ResetAnnotationInteraction(ctx);
     return true;
 }
 
 static bool RedoAnnotations(CaptureContext* ctx) {
-    if (ctx->redoStack.empty()) return false;
-    ctx->undoStack.push_back(ctx->annotations);
-    ctx->annotations = ctx->redoStack.back();
-    ctx->redoStack.pop_back();
+    if (!ctx->history.Redo(ctx->annotations)) return false;
+    MarkAnnotationsChanged(ctx);
     ResetAnnotationInteraction(ctx);
     return true;
 }
@@ -1295,124 +1430,450 @@ static double GetDpiScaleFactor() {
     return 1.0;
 }
 
-// 显示器枚举回调数据
-struct MonitorEnumData {
-    LONG minLeft, minTop, maxRight, maxBottom;
-    double totalDpiScale;
-    int monitorCount;
-};
+// GetDpiForMonitor（shcore.dll，Windows 8.1+）：首次使用时解析一次，模块常驻进程，不再每个显示器 LoadLibrary / FreeLibrary
+typedef HRESULT(WINAPI* GetDpiForMonitorProc)(HMONITOR, int, UINT*, UINT*);
 
-// 显示器枚举回调
-static BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) {
-    MonitorEnumData* data = reinterpret_cast<MonitorEnumData*>(dwData);
+static GetDpiForMonitorProc ResolveGetDpiForMonitor() {
+    static const GetDpiForMonitorProc proc = []() -> GetDpiForMonitorProc {
+        HMODULE shcore = LoadLibraryW(L"shcore.dll");
+        return shcore ? (GetDpiForMonitorProc)GetProcAddress(shcore, "GetDpiForMonitor") : nullptr;
+    }();
+    return proc;
+}
+
+// 显示器的有效 DPI；接口不可用时退回系统 DPI
+static int GetMonitorDpi(HMONITOR monitor) {
+    GetDpiForMonitorProc getDpiForMonitor = ResolveGetDpiForMonitor();
+    UINT dpiX = 0, dpiY = 0;
+    if (getDpiForMonitor && SUCCEEDED(getDpiForMonitor(monitor, 0/*MDT_EFFECTIVE_DPI*/, &dpiX, &dpiY)) && dpiX > 0) {
+        return (int)dpiX;
+    }
+    return (int)(GetDpiScaleFactor() * 96 + 0.5);
+}
 
-    // 获取显示器的物理尺寸
+// 显示器枚举回调：收集物理像素矩形（每显示器 DPI 感知下 rcMonitor 即物理像素坐标）与有效 DPI
+static BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) {
+    auto* monitors = reinterpret_cast<std::vector<ztools::MonitorDesc>*>(dwData);
     MONITORINFOEXW mi;
     mi.cbSize = sizeof(MONITORINFOEXW);
     if (GetMonitorInfoW(hMonitor, &mi)) {
-        // 在 DPI 感知模式下，rcMonitor 已经是物理像素坐标
-        data->minLeft = (std::min)(data->minLeft, mi.rcMonitor.left);
-        data->minTop = (std::min)(data->minTop, mi.rcMonitor.top);
-        data->maxRight = (std::max)(data->maxRight, mi.rcMonitor.right);
-        data->maxBottom = (std::max)(data->maxBottom, mi.rcMonitor.bottom);
-        data->monitorCount++;
-
-        // 获取显示器 DPI
-        typedef HRESULT(WINAPI* GetDpiForMonitorProc)(HMONITOR, int, UINT*, UINT*);
-        HMODULE shcore = LoadLibraryW(L"shcore.dll");
-        if (shcore) {
-            auto getDpiForMonitor = (GetDpiForMonitorProc)GetProcAddress(shcore, "GetDpiForMonitor");
-            if (getDpiForMonitor) {
-                UINT dpiX, dpiY;
-                if (SUCCEEDED(getDpiForMonitor(hMonitor, 0/*MDT_EFFECTIVE_DPI*/, &dpiX, &dpiY))) {
-                    data->totalDpiScale = (std::max)(data->totalDpiScale, dpiX / 96.0);
+        ztools::MonitorDesc desc;
+        desc.bounds = ztools::IntRect::FromLTRB(mi.rcMonitor.left, mi.rcMonitor.top, mi.rcMonitor.right, mi.rcMonitor.bottom);
+        desc.dpi = GetMonitorDpi(hMonitor);
+        desc.primary = (mi.dwFlags & MONITORINFOF_PRIMARY) != 0;
+        monitors->push_back(desc);
+    }
+    return TRUE;
+}
+
+static ztools::MonitorLayout EnumerateMonitorLayout() {
+    std::vector<ztools::MonitorDesc> monitors;
+    EnumDisplayMonitors(NULL, NULL, MonitorEnumProc, reinterpret_cast<LPARAM>(&monitors));
+    return ztools::MonitorLayout(std::move(monitors));
+}
+
+// ==================== Desktop Duplication 捕获后端 ====================
+// 每个显示器一路 IDXGIOutputDuplication，AcquireNextFrame 交出自上次以来累积的移动 / 脏矩形。
+// 变化区域先在 GPU 上拷进该路常驻的 staging 纹理（始终是该显示器的完整镜像），Read 时 Map 后逐行复制。
+// 持久帧（core/capture_backend）只应用增量，预截屏从持久帧复制一份即可，不再整屏 BitBlt。
+// 旋转的显示器、创建失败（远程桌面、安全桌面等）时不可用，CaptureVirtualScreen 退回 GDI BitBlt。
+
+static HBITMAP CreateSurfaceBitmap(int w, int h, ztools::ImageView& outView);
+static bool SurfaceViewOf(HBITMAP bmp, ztools::ImageView& outView);
+
+class DxgiCaptureBackend : public ztools::CaptureBackend {
+public:
+    ~DxgiCaptureBackend() override { Close(); }
+
+    // 为所有连接桌面的输出建立复制；任一输出不支持时返回 false
+    bool Open();
+
+    const char* Name() const override { return "dxgi"; }
+    ztools::IntRect Bounds() const override { return bounds_; }
+    bool Acquire(ztools::FrameDelta& delta, int timeoutMs) override;
+    bool Read(const ztools::IntRect& rect, const ztools::ImageView& dst) override;
+    void Release() override;
+
+private:
+    struct Output {
+        ID3D11Device* device = nullptr;
+        ID3D11DeviceContext* context = nullptr;
+        IDXGIOutputDuplication* dup = nullptr;
+        ID3D11Texture2D* staging = nullptr;
+        ztools::IntRect rect;       // 在 bounds_ 内的位置（先存虚拟桌面坐标，Open 末尾换算）
+        bool primed = false;        // staging 已有完整画面
+        bool acquired = false;      // 持有 AcquireNextFrame 得到的帧
+        bool mapped = false;
+        D3D11_MAPPED_SUBRESOURCE map = {};
+        std::vector<BYTE> metadata;
+    };
+
+    void Close();
+    bool AcquireOutput(Output& o, ztools::FrameDelta& delta, int timeoutMs);
+    bool CopyToStaging(Output& o, ID3D11Texture2D* frame, const RECT& r);
+
+    std::vector<Output> outputs_;
+    ztools::IntRect bounds_;
+};
+
+bool DxgiCaptureBackend::Open() {
+    Close();
+    IDXGIFactory1* factory = nullptr;
+    if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&factory)))) return false;
+    bool ok = true;
+    for (UINT a = 0; ok; a++) {
+        IDXGIAdapter1* adapter = nullptr;
+        if (factory->EnumAdapters1(a, &adapter) != S_OK) break;
+        ID3D11Device* device = nullptr;
+        ID3D11DeviceContext* context = nullptr;
+        // 输出必须用其所属适配器上的设备复制（混合显卡笔记本上各输出可能分属不同适配器）
+        if (SUCCEEDED(D3D11CreateDevice(adapter, D3D_DRIVER_TYPE_UNKNOWN, NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+                NULL, 0, D3D11_SDK_VERSION, &device, NULL, &context))) {
+            for (UINT i = 0; ok; i++) {
+                IDXGIOutput* output = nullptr;
+                if (adapter->EnumOutputs(i, &output) != S_OK) break;
+                DXGI_OUTPUT_DESC desc = {};
+                output->GetDesc(&desc);
+                if (desc.AttachedToDesktop) {
+                    IDXGIOutput1* output1 = nullptr;
+                    Output o;
+                    if (desc.Rotation != DXGI_MODE_ROTATION_IDENTITY && desc.Rotation != DXGI_MODE_ROTATION_UNSPECIFIED) {
+                        ok = false;
+                    } else if (FAILED(output->QueryInterface(__uuidof(IDXGIOutput1), reinterpret_cast<void**>(&output1)))) {
+                        ok = false;
+                    } else if (FAILED(output1->DuplicateOutput(device, &o.dup))) {
+                        ok = false;
+                    } else {
+                        o.device = device; device->AddRef();
+                        o.context = context; context->AddRef();
+                        o.rect = ztools::IntRect::FromLTRB(desc.DesktopCoordinates.left, desc.DesktopCoordinates.top,
+                            desc.DesktopCoordinates.right, desc.DesktopCoordinates.bottom);
+                        outputs_.push_back(o);
+                    }
+                    if (output1) output1->Release();
                 }
+                output->Release();
             }
-            FreeLibrary(shcore);
+            context->Release();
+            device->Release();
         }
+        adapter->Release();
     }
-    return TRUE;
+    factory->Release();
+    if (!ok || outputs_.empty()) {
+        Close();
+        return false;
+    }
+    bounds_ = ztools::IntRect();
+    for (const Output& o : outputs_) bounds_ = bounds_.Union(o.rect);
+    for (Output& o : outputs_) o.rect = o.rect.Offset(-bounds_.x, -bounds_.y);
+    return true;
+}
+
+void DxgiCaptureBackend::Close() {
+    Release();
+    for (Output& o : outputs_) {
+        if (o.staging) o.staging->Release();
+        if (o.dup) o.dup->Release();
+        if (o.context) o.context->Release();
+        if (o.device) o.device->Release();
+    }
+    outputs_.clear();
+    bounds_ = ztools::IntRect();
 }
 
-// 截取整个虚拟屏幕到物理尺寸位图
+bool DxgiCaptureBackend::CopyToStaging(Output& o, ID3D11Texture2D* frame, const RECT& r) {
+    if (!o.staging) {
+        D3D11_TEXTURE2D_DESC td = {};
+        frame->GetDesc(&td);
+        td.Usage = D3D11_USAGE_STAGING;
+        td.BindFlags = 0;
+        td.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        td.MiscFlags = 0;
+        td.MipLevels = 1;
+        td.ArraySize = 1;
+        td.SampleDesc.Count = 1;
+        td.SampleDesc.Quality = 0;
+        if (td.Format != DXGI_FORMAT_B8G8R8A8_UNORM) return false;
+        if (FAILED(o.device->CreateTexture2D(&td, NULL, &o.staging))) return false;
+    }
+    D3D11_BOX box = { (UINT)r.left, (UINT)r.top, 0, (UINT)r.right, (UINT)r.bottom, 1 };
+    o.context->CopySubresourceRegion(o.staging, 0, r.left, r.top, 0, frame, 0, &box);
+    return true;
+}
+
+bool DxgiCaptureBackend::AcquireOutput(Output& o, ztools::FrameDelta& delta, int timeoutMs) {
+    DXGI_OUTDUPL_FRAME_INFO info = {};
+    IDXGIResource* resource = nullptr;
+    HRESULT hr = o.dup->AcquireNextFrame((UINT)(std::max)(timeoutMs, 0), &info, &resource);
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT) return o.primed;  // 无新帧；尚无完整画面时无从读取
+    if (FAILED(hr)) return false;
+    o.acquired = true;
+    ID3D11Texture2D* frame = nullptr;
+    hr = resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&frame));
+    resource->Release();
+    if (FAILED(hr)) return false;
+
+    const int ox = o.rect.x, oy = o.rect.y;
+    bool ok = true;
+    if (!o.primed) {
+        RECT all = { 0, 0, o.rect.w, o.rect.h };
+        ok = CopyToStaging(o, frame, all);
+        o.primed = ok;
+        delta.dirty.push_back(o.rect);
+    } else if (info.TotalMetadataBufferSize > 0) {
+        // 元数据缓冲：先放移动矩形，其后放脏矩形
+        o.metadata.resize(info.TotalMetadataBufferSize);
+        UINT moveBytes = 0, dirtyBytes = 0;
+        hr = o.dup->GetFrameMoveRects((UINT)o.metadata.size(),
+            reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(o.metadata.data()), &moveBytes);
+        if (SUCCEEDED(hr)) {
+            hr = o.dup->GetFrameDirtyRects((UINT)o.metadata.size() - moveBytes,
+                reinterpret_cast<RECT*>(o.metadata.data() + moveBytes), &dirtyBytes);
+        }
+        if (FAILED(hr)) {
+            ok = false;
+        } else {
+            const DXGI_OUTDUPL_MOVE_RECT* moves = reinterpret_cast<const DXGI_OUTDUPL_MOVE_RECT*>(o.metadata.data());
+            for (UINT i = 0; ok && i < moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT); i++) {
+                const RECT& d = moves[i].DestinationRect;
+                ztools::FrameMove m;
+                m.source = ztools::IntRect(moves[i].SourcePoint.x + ox, moves[i].SourcePoint.y + oy,
+                    d.right - d.left, d.bottom - d.top);
+                m.x = d.left + ox;
+                m.y = d.top + oy;
+                delta.moves.push_back(m);
+                ok = CopyToStaging(o, frame, d);
+            }
+            const RECT* dirty = reinterpret_cast<const RECT*>(o.metadata.data() + moveBytes);
+            for (UINT i = 0; ok && i < dirtyBytes / sizeof(RECT); i++) {
+                delta.dirty.push_back(ztools::IntRect::FromLTRB(dirty[i].left + ox, dirty[i].top + oy,
+                    dirty[i].right + ox, dirty[i].bottom + oy));
+                ok = CopyToStaging(o, frame, dirty[i]);
+            }
+        }
+    }
+    frame->Release();
+    return ok;
+}
+
+bool DxgiCaptureBackend::Acquire(ztools::FrameDelta& delta, int timeoutMs) {
+    // 只在第一路上等待，其余各路取已累积的变化；尚未拿到首帧的输出都要等
+    for (size_t i = 0; i < outputs_.size(); i++) {
+        int wait = (i == 0 || !outputs_[i].primed) ? timeoutMs : 0;
+        if (!AcquireOutput(outputs_[i], delta, wait)) {
+            Release();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DxgiCaptureBackend::Read(const ztools::IntRect& rect, const ztools::ImageView& dst) {
+    // 多显示器外包矩形中不属于任何显示器的空洞与 BitBlt 一致为黑色
+    if (rect == dst.Bounds()) ztools::Fill(dst, rect, 0);
+    for (Output& o : outputs_) {
+        ztools::IntRect r = rect.Intersect(o.rect).Intersect(dst.Bounds());
+        if (r.Empty()) continue;
+        if (!o.mapped) {
+            if (FAILED(o.context->Map(o.staging, 0, D3D11_MAP_READ, 0, &o.map))) return false;
+            o.mapped = true;
+        }
+        const BYTE* base = static_cast<const BYTE*>(o.map.pData);
+        for (int y = r.y; y < r.Bottom(); y++) {
+            const BYTE* src = base + (size_t)(y - o.rect.y) * o.map.RowPitch + (size_t)(r.x - o.rect.x) * 4;
+            memcpy(dst.Row(y) + r.x, src, (size_t)r.w * 4);
+        }
+    }
+    return true;
+}
+
+void DxgiCaptureBackend::Release() {
+    for (Output& o : outputs_) {
+        if (o.mapped) { o.context->Unmap(o.staging, 0); o.mapped = false; }
+        if (o.acquired) { o.dup->ReleaseFrame(); o.acquired = false; }
+    }
+}
+
+static std::mutex g_duplicationMutex;
+static std::chrono::steady_clock::time_point g_duplicationRetryAt{};
+static const auto SC_DUPLICATION_RETRY = std::chrono::seconds(5);
+static const int SC_DUPLICATION_FIRST_FRAME_MS = 100;
+
+// 进程级持久帧；进程退出时不析构，避免在加载器锁内释放 D3D 对象
+static ztools::DuplicationCapture& DuplicationInstance() {
+    static ztools::DuplicationCapture* capture = new ztools::DuplicationCapture();
+    return *capture;
+}
+
+// 用 Desktop Duplication 把 physBounds（虚拟桌面物理像素）同步进持久帧，再复制成会话私有的位图。
+// 不可用、显示器布局与 physBounds 不符或同步失败时返回 false，调用方退回 BitBlt
+static bool CaptureViaDuplication(const ztools::IntRect& physBounds, const ztools::IntRect& region,
+    HDC screenDC, HDC& outMemDC, HBITMAP& outBitmap) {
+    std::lock_guard<std::mutex> lock(g_duplicationMutex);
+    ztools::DuplicationCapture& capture = DuplicationInstance();
+    const auto now = std::chrono::steady_clock::now();
+    if (!capture.backend()) {
+        if (now < g_duplicationRetryAt) return false;
+        std::unique_ptr<DxgiCaptureBackend> backend(new DxgiCaptureBackend());
+        if (!backend->Open()) {
+            g_duplicationRetryAt = now + SC_DUPLICATION_RETRY;
+            return false;
+        }
+        capture.Reset(std::move(backend));
+    }
+    if (capture.backend()->Bounds() != physBounds) {
+        capture.Reset(nullptr);  // 显示器布局变了：下次重建
+        return false;
+    }
+    if (!capture.Update(capture.Valid() ? 0 : SC_DUPLICATION_FIRST_FRAME_MS)) {
+        capture.Reset(nullptr);
+        g_duplicationRetryAt = now + SC_DUPLICATION_RETRY;
+        return false;
+    }
+
+    // 只要一块显示器时从持久帧复制该区域，否则整帧快照
+    ztools::ImageView view;
+    HBITMAP bmp = CreateSurfaceBitmap(region.w, region.h, view);
+    if (!bmp) return false;
+    HDC dc = CreateCompatibleDC(screenDC);
+    bool copied = false;
+    if (region == physBounds) {
+        copied = capture.Snapshot(view);
+    } else if (capture.Valid()) {
+        ztools::Copy(capture.frame(), region.x - physBounds.x, region.y - physBounds.y, view, view.Bounds());
+        copied = true;
+    }
+    if (!dc || !copied) {
+        if (dc) DeleteDC(dc);
+        DeleteObject(bmp);
+        return false;
+    }
+    SelectObject(dc, bmp);
+    outMemDC = dc;
+    outBitmap = bmp;
+    return true;
+}
+
+// 当前线程是否已切到每显示器 DPI 感知（SetThreadPerMonitorDpiAware 成功后为 true）
+static thread_local bool t_perMonitorDpiAware = false;
+
+// 截取整个虚拟屏幕（cursorMonitorOnly 时只截鼠标所在显示器）到物理尺寸位图：
+// 优先从 Desktop Duplication 持久帧复制，不可用时逐显示器 BitBlt（外包矩形里没有显示器的空洞不抓，保持黑色）。
+// 每显示器 DPI 感知下窗口、鼠标与显示器矩形都是物理像素，各显示器 1:1 落在同一张外包位图上，
+// 混合 DPI 时也不需要逐显示器换算坐标（dpiScale 恒为 1，界面尺寸另按所在显示器 DPI 缩放），
+// 因此保留单张位图：跨显示器的选区、放大镜和导出都不必拼接多张表面。
 static bool CaptureVirtualScreen(HDC& outMemDC, HBITMAP& outBitmap,
-    int& vx, int& vy, int& vw, int& vh, double& dpiScale) {
-    // 获取逻辑坐标的虚拟屏幕尺寸
+    int& vx, int& vy, int& vw, int& vh, double& dpiScale, bool cursorMonitorOnly = false) {
+    // 获取虚拟屏幕尺寸（每显示器 DPI 感知时为物理像素）
     vx = GetSystemMetrics(SM_XVIRTUALSCREEN);
     vy = GetSystemMetrics(SM_YVIRTUALSCREEN);
     vw = GetSystemMetrics(SM_CXVIRTUALSCREEN);
     vh = GetSystemMetrics(SM_CYVIRTUALSCREEN);
 
     // 枚举所有显示器获取物理像素边界
-    MonitorEnumData enumData = { INT_MAX, INT_MAX, INT_MIN, INT_MIN, 1.0, 0 };
-    EnumDisplayMonitors(NULL, NULL, MonitorEnumProc, reinterpret_cast<LPARAM>(&enumData));
-
-    // 计算物理尺寸（使用枚举得到的实际物理像素边界）
-    int physVx = enumData.minLeft;
-    int physVy = enumData.minTop;
-    int physVw = enumData.maxRight - enumData.minLeft;
-    int physVh = enumData.maxBottom - enumData.minTop;
+    const ztools::MonitorLayout layout = EnumerateMonitorLayout();
+    ztools::IntRect physBounds = layout.Bounds();
 
     // 如果枚举失败，回退到 DPI 缩放计算
-    if (physVw <= 0 || physVh <= 0 || enumData.monitorCount == 0) {
-        physVx = (int)(vx * dpiScale);
-        physVy = (int)(vy * dpiScale);
-        physVw = (int)(vw * dpiScale + 0.5);
-        physVh = (int)(vh * dpiScale + 0.5);
+    if (physBounds.Empty()) {
+        physBounds = ztools::IntRect((int)(vx * dpiScale), (int)(vy * dpiScale),
+            (int)(vw * dpiScale + 0.5), (int)(vh * dpiScale + 0.5));
+    }
+    if (physBounds.Empty()) return false;
+
+    // 只截鼠标所在显示器时区域收缩到该显示器
+    ztools::IntRect region = physBounds;
+    if (cursorMonitorOnly && !layout.empty()) {
+        POINT pt;
+        GetCursorPos(&pt);
+        region = layout[layout.IndexAt(pt.x, pt.y)].bounds;
+    }
+
+    if (t_perMonitorDpiAware && !layout.empty()) {
+        // 覆盖层坐标即物理坐标：直接取（所选显示器的）物理矩形
+        vx = region.x;
+        vy = region.y;
+        vw = region.w;
+        vh = region.h;
+        dpiScale = 1.0;
+    } else if (vw > 0 && vh > 0) {
+        // 系统不支持线程级每显示器 DPI 感知（Windows 10 1607 之前）：系统本身按统一的系统 DPI
+        // 虚拟化所有显示器的坐标，只能用一个全局比例换算，混合 DPI 下非主 DPI 显示器会有偏差
+        dpiScale = (double)physBounds.w / vw;
+        double scale = dpiScale > 0 ? dpiScale : 1.0;
+        vx += (int)((region.x - physBounds.x) / scale + 0.5);
+        vy += (int)((region.y - physBounds.y) / scale + 0.5);
+        vw = (int)(region.w / scale + 0.5);
+        vh = (int)(region.h / scale + 0.5);
     }
 
     HDC screenDC = GetDC(NULL);
     if (!screenDC) return false;
 
+    if (CaptureViaDuplication(physBounds, region, screenDC, outMemDC, outBitmap)) {
+        ReleaseDC(NULL, screenDC);
+        return true;
+    }
+
     outMemDC = CreateCompatibleDC(screenDC);
     if (!outMemDC) { ReleaseDC(NULL, screenDC); return false; }
 
-    outBitmap = CreateCompatibleBitmap(screenDC, physVw, physVh);
+    // 与 Duplication 路径一样落在 DIB section 上，会话内取色 / 像素处理 / 导出都直接读其像素
+    ztools::ImageView view;
+    outBitmap = CreateSurfaceBitmap(region.w, region.h, view);
     if (!outBitmap) { DeleteDC(outMemDC); ReleaseDC(NULL, screenDC); return false; }
 
     SelectObject(outMemDC, outBitmap);
 
-    // 直接 BitBlt 物理像素（在 DPI 感知模式下，屏幕 DC 和坐标都是物理像素级别）
-    BitBlt(outMemDC, 0, 0, physVw, physVh, screenDC, physVx, physVy, SRCCOPY | CAPTUREBLT);
-
-    // 更新返回的 dpiScale 为实际的物理/逻辑比例
-    // 这样后续的坐标转换才能正确
-    if (vw > 0 && vh > 0) {
-        dpiScale = (double)physVw / vw;
+    // 直接 BitBlt 物理像素（在 DPI 感知模式下，屏幕 DC 和坐标都是物理像素级别），每块显示器一次
+    std::vector<ztools::IntRect> coverage;
+    if (!layout.empty()) {
+        layout.Coverage(region, coverage);
+    } else {
+        coverage.push_back(region);
     }
+    for (const ztools::IntRect& r : coverage) {
+        BitBlt(outMemDC, r.x - region.x, r.y - region.y, r.w, r.h, screenDC, r.x, r.y, SRCCOPY | CAPTUREBLT);
+    }
+    GdiFlush();
 
     ReleaseDC(NULL, screenDC);
     return true;
 }
 
-// 创建双缓冲
-static bool CreateBackBuffer(HDC& outDC, HBITMAP& outBmp, int w, int h) {
+// 创建双缓冲（32bpp DIB section，outView 指向其像素）
+static bool CreateBackBuffer(HDC& outDC, HBITMAP& outBmp, ztools::ImageView& outView, int w, int h) {
     HDC screenDC = GetDC(NULL);
     if (!screenDC) return false;
     outDC = CreateCompatibleDC(screenDC);
     if (!outDC) { ReleaseDC(NULL, screenDC); return false; }
-    outBmp = CreateCompatibleBitmap(screenDC, w, h);
+    outBmp = CreateSurfaceBitmap(w, h, outView);
     if (!outBmp) { DeleteDC(outDC); ReleaseDC(NULL, screenDC); return false; }
     SelectObject(outDC, outBmp);
     ReleaseDC(NULL, screenDC);
     return true;
 }
 
-// 立即抓取当前虚拟屏幕首帧，供后续截图流程复用。
+// 立即抓取当前虚拟屏幕首帧，供后续截图流程复用（显式预抓取与保温刷新共用）。
+// 截图会话期间完成的抓帧可能含覆盖层，由策略判定丢弃。
 bool PrimeScreenshotFrameNow() {
     HDC memDC = NULL;
     HBITMAP bitmap = NULL;
     int vx = 0, vy = 0, vw = 0, vh = 0;
     double dpiScale = 1.0;
-    if (!CaptureVirtualScreen(memDC, bitmap, vx, vy, vw, vh, dpiScale)) {
-        return false;
-    }
-
+    const auto start = std::chrono::steady_clock::now();
+    bool ok = CaptureVirtualScreen(memDC, bitmap, vx, vy, vw, vh, dpiScale);
+    const auto end = std::chrono::steady_clock::now();
     if (memDC) {
         DeleteDC(memDC);
     }
 
     std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+    if (!g_warmFramePolicy.OnCaptured(start, end, ok)) {
+        if (bitmap) DeleteObject(bitmap);
+        return false;
+    }
     ReleasePrimedScreenshotFrameLocked();
     g_primedScreenshotFrame.bitmap = bitmap;
     g_primedScreenshotFrame.vx = vx;
@@ -1420,20 +1881,58 @@ bool PrimeScreenshotFrameNow() {
     g_primedScreenshotFrame.vw = vw;
     g_primedScreenshotFrame.vh = vh;
     g_primedScreenshotFrame.dpiScale = dpiScale;
-    g_primedScreenshotFrame.capturedAt = std::chrono::steady_clock::now();
     g_primedScreenshotFrame.valid = true;
     return true;
 }
 
+// 截图线程与保温线程都以每显示器 DPI 感知运行，虚拟屏幕度量与 BitBlt 均为物理像素
+static void SetThreadPerMonitorDpiAware() {
+    typedef DPI_AWARENESS_CONTEXT (WINAPI *SetThreadDpiAwarenessContextProc)(DPI_AWARENESS_CONTEXT);
+    HMODULE user32 = GetModuleHandleW(L"user32.dll");
+    if (user32) {
+        auto setDpiProc = (SetThreadDpiAwarenessContextProc)GetProcAddress(user32, "SetThreadDpiAwarenessContext");
+        if (setDpiProc) {
+            t_perMonitorDpiAware = setDpiProc(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2) != NULL;
+        }
+    }
+}
+
+// 保温线程：按策略给出的时间点刷新首帧；未开启保温或截图会话期间无限等待
+static void WarmFrameThread() {
+    SetThreadPerMonitorDpiAware();
+    std::unique_lock<std::mutex> lock(g_primedScreenshotFrameMutex);
+    for (;;) {
+        auto wait = g_warmFramePolicy.TimeUntilRefresh(std::chrono::steady_clock::now());
+        if (!wait) {
+            g_warmFrameCv.wait(lock);
+            continue;
+        }
+        if (*wait > std::chrono::steady_clock::duration::zero()) {
+            g_warmFrameCv.wait_for(lock, *wait);
+            continue;
+        }
+        lock.unlock();
+        PrimeScreenshotFrameNow();
+        lock.lock();
+    }
+}
+
+// 截图会话结束：恢复保温刷新（会话期间的帧已被取走或丢弃）
+static void FinishCaptureSession() {
+    {
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        g_warmFramePolicy.Resume(std::chrono::steady_clock::now());
+    }
+    g_warmFrameCv.notify_all();
+    g_isCapturing = false;
+}
+
 static bool ConsumePrimedScreenshotFrame(HDC& outMemDC, HBITMAP& outBitmap,
     int& vx, int& vy, int& vw, int& vh, double& dpiScale) {
     std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
-    if (!g_primedScreenshotFrame.valid || !g_primedScreenshotFrame.bitmap) {
-        return false;
-    }
-
-    const auto now = std::chrono::steady_clock::now();
-    if (now - g_primedScreenshotFrame.capturedAt > SC_PRIMED_FRAME_TTL) {
+    // 策略记录帧年龄并判断有效期；无论命中与否，帧都只用一次
+    const bool fresh = g_warmFramePolicy.Consume(std::chrono::steady_clock::now());
+    if (!fresh || !g_primedScreenshotFrame.valid || !g_primedScreenshotFrame.bitmap) {
         ReleasePrimedScreenshotFrameLocked();
         return false;
     }
@@ -1463,37 +1962,37 @@ static bool ConsumePrimedScreenshotFrame(HDC& outMemDC, HBITMAP& outBitmap,
     return true;
 }
 
+// 预抓取 / 保温的帧是整个虚拟屏幕，只截鼠标所在显示器时不用它（留给下一次整屏截图）
 static bool AcquireScreenshotBase(HDC& outMemDC, HBITMAP& outBitmap,
-    int& vx, int& vy, int& vw, int& vh, double& dpiScale) {
-    if (ConsumePrimedScreenshotFrame(outMemDC, outBitmap, vx, vy, vw, vh, dpiScale)) {
+    int& vx, int& vy, int& vw, int& vh, double& dpiScale, bool cursorMonitorOnly) {
+    if (!cursorMonitorOnly && ConsumePrimedScreenshotFrame(outMemDC, outBitmap, vx, vy, vw, vh, dpiScale)) {
         return true;
     }
-    return CaptureVirtualScreen(outMemDC, outBitmap, vx, vy, vw, vh, dpiScale);
-}
-
-// 从预截屏位图读取像素颜色（逻辑坐标）
-static COLORREF GetPixelColorFromBitmap(HDC memDC, int x, int y, int vx, int vy, double dpiScale) {
-    int lx = x - vx;
-    int ly = y - vy;
-    int px = (int)(lx * dpiScale + 0.5);
-    int py = (int)(ly * dpiScale + 0.5);
-    return GetPixel(memDC, px, py);
+    return CaptureVirtualScreen(outMemDC, outBitmap, vx, vy, vw, vh, dpiScale, cursorMonitorOnly);
 }
 
-// COLORREF 转 HEX/RGB 字符串
-static void ColorrefToStrings(COLORREF color, char* hexBuf, char* rgbBuf) {
-    int r = color & 0xFF;
-    int g = (color >> 8) & 0xFF;
-    int b = (color >> 16) & 0xFF;
-    sprintf_s(hexBuf, 32, "#%02X%02X%02X", r, g, b);
-    sprintf_s(rgbBuf, 32, "%d, %d, %d", r, g, b);
+// 从预截屏读取像素颜色（逻辑坐标）：取物理像素原色，不受逻辑底图平均的影响。
+// 截屏像素视图（会话开始时由 EnsureScreenPixels 建立）直接读内存，仅在其缺失时退回 GetPixel
+static COLORREF GetPixelColorFromBitmap(const CaptureContext* ctx, int x, int y) {
+    int lx = x - ctx->virtualX;
+    int ly = y - ctx->virtualY;
+    int px = (int)(lx * ctx->dpiScale + 0.5);
+    int py = (int)(ly * ctx->dpiScale + 0.5);
+    const ztools::ImageView& pixels = ctx->screenPixels;
+    if (pixels.Empty()) return GetPixel(ctx->memDC, px, py);
+    if (px < 0 || py < 0 || px >= pixels.width || py >= pixels.height) return CLR_INVALID;
+    std::uint32_t bgra = pixels.Row(py)[px];
+    return RGB((bgra >> 16) & 0xFF, (bgra >> 8) & 0xFF, bgra & 0xFF);
 }
 
 // 枚举窗口回调
+// 进入截图前同步执行，窗口多时直接推迟遮罩出现：廉价过滤（样式 / 标题长度 / GetWindowRect 尺寸）在前，
+// DWM 查询与类名只对剩下的候选做；标题文本推迟到悬停时再读取。
 static BOOL CALLBACK SCEnumWindowsProc(HWND hwnd, LPARAM lParam) {
     auto* windows = reinterpret_cast<std::vector<SCWindowInfo>*>(lParam);
 
     if (!IsWindowVisible(hwnd)) return TRUE;
+    if (hwnd == GetDesktopWindow()) return TRUE;
 
     LONG_PTR exStyle = GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
     if (exStyle & WS_EX_TOOLWINDOW) return TRUE;
@@ -1501,11 +2000,19 @@ static BOOL CALLBACK SCEnumWindowsProc(HWND hwnd, LPARAM lParam) {
     LONG_PTR style = GetWindowLongPtrW(hwnd, GWL_STYLE);
     if (style == 0) return TRUE;
 
+    // 无标题窗口不作为候选（只取长度，不复制文本）
+    if (GetWindowTextLengthW(hwnd) == 0) return TRUE;
+
+    // DWM 扩展边框不会大于 GetWindowRect，外框已小于 50px 的窗口不必再查 DWM
+    RECT outer = {};
+    if (!GetWindowRect(hwnd, &outer)) return TRUE;
+    if (outer.right - outer.left < 50 || outer.bottom - outer.top < 50) return TRUE;
+
     // 检查是否为幽灵窗口（cloaked window）
     // 幽灵窗口虽然 IsWindowVisible 返回 true，但实际上不可见
-    BOOL isCloaked = FALSE;
-    HRESULT hrCloaked = DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &isCloaked, sizeof(isCloaked));
-    if (SUCCEEDED(hrCloaked) && isCloaked) {
+    DWORD cloaked = 0;
+    HRESULT hrCloaked = DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked));
+    if (SUCCEEDED(hrCloaked) && cloaked) {
         return TRUE; // 跳过幽灵窗口
     }
 
@@ -1529,34 +2036,16 @@ static BOOL CALLBACK SCEnumWindowsProc(HWND hwnd, LPARAM lParam) {
         }
 
         // 过滤 ApplicationFrameWindow 的空壳窗口
-        // UWP 应用在未激活时可能留下空的 ApplicationFrameWindow
+        // UWP 应用在未激活时可能留下空的 ApplicationFrameWindow（被隐藏的已由上面的 cloaked 检查跳过）
         if (wcscmp(className, L"ApplicationFrameWindow") == 0) {
-            // 检查窗口是否被最小化或隐藏
             if (IsIconic(hwnd)) return TRUE;
-
-            // 检查是否真的有内容（通过检查窗口透明度或其他属性）
-            BYTE opacity = 255;
-            DWORD cloakedReason = 0;
-            DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloakedReason, sizeof(cloakedReason));
-            if (cloakedReason != 0) return TRUE;
         }
     }
 
-    int titleLen = GetWindowTextLengthW(hwnd);
-    if (titleLen == 0) return TRUE;
-
-    std::wstring title(titleLen + 1, L'\0');
-    GetWindowTextW(hwnd, &title[0], titleLen + 1);
-    title.resize(titleLen);
-
-    if (hwnd == GetDesktopWindow()) return TRUE;
-
     // 使用 DWM 获取精确边界
-    RECT rect = {};
+    RECT rect = outer;
     HRESULT hr = DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &rect, sizeof(rect));
-    if (FAILED(hr)) {
-        if (!GetWindowRect(hwnd, &rect)) return TRUE;
-    }
+    if (FAILED(hr)) rect = outer;
 
     int w = rect.right - rect.left;
     int h = rect.bottom - rect.top;
@@ -1565,26 +2054,47 @@ static BOOL CALLBACK SCEnumWindowsProc(HWND hwnd, LPARAM lParam) {
     SCWindowInfo info;
     info.hwnd = hwnd;
     info.rect = rect;
-    info.title = title;
+    info.titleLoaded = false;
     windows->push_back(info);
     return TRUE;
 }
 
-// 枚举窗口
+// 枚举窗口（EnumWindows 按 z 序自顶向下回调，故下标越小越靠上层）
 static std::vector<SCWindowInfo> EnumWindowsForCapture() {
     std::vector<SCWindowInfo> windows;
+    windows.reserve(128);
     EnumWindows(SCEnumWindowsProc, reinterpret_cast<LPARAM>(&windows));
     return windows;
 }
 
-// 查找鼠标下方的窗口
-static int FindWindowAtPoint(const std::vector<SCWindowInfo>& windows, int x, int y) {
+// 读取窗口标题（每个窗口只读一次）
+static const std::wstring& EnsureWindowTitle(SCWindowInfo& info) {
+    if (!info.titleLoaded) {
+        info.titleLoaded = true;
+        int len = GetWindowTextLengthW(info.hwnd);
+        if (len > 0) {
+            info.title.assign(len + 1, L'\0');
+            int got = GetWindowTextW(info.hwnd, &info.title[0], len + 1);
+            info.title.resize(got > 0 ? got : 0);
+        }
+    }
+    return info.title;
+}
+
+// 待选窗口矩形建入网格索引（编号 = 下标 = z 序），鼠标移动时只查所在格子
+static void BuildWindowIndex(ztools::HitGrid& index, const std::vector<SCWindowInfo>& windows) {
+    index = ztools::HitGrid(256);  // 窗口普遍很大，用大格子减少每个窗口登记的格子数
+    std::vector<ztools::HitPart> parts(1);
     for (size_t i = 0; i < windows.size(); i++) {
         const RECT& r = windows[i].rect;
-        if (x >= r.left && x < r.right && y >= r.top && y < r.bottom)
-            return (int)i;
+        parts[0].box = ztools::IntRect::FromLTRB(r.left, r.top, r.right, r.bottom);
+        index.SetItem((int)i, parts);
     }
-    return -1;
+}
+
+// 查找鼠标下方的窗口（最上层的那个）
+static int FindWindowAtPoint(const ztools::HitGrid& index, int x, int y) {
+    return index.FirstItemAt(x, y);
 }
 
 // 计算浮窗位置（优先右下，超出则翻转）
@@ -1641,12 +2151,42 @@ static RECT UnionRectSafe(const RECT& a, const RECT& b) {
              (std::max)(a.right, b.right), (std::max)(a.bottom, b.bottom) };
 }
 
+// ---- 损伤区域 ----
+
+static ztools::IntRect ToIntRect(const RECT& r) {
+    return ztools::IntRect::FromLTRB(r.left, r.top, r.right, r.bottom);
+}
+
+static RECT ToRect(const ztools::IntRect& r) {
+    RECT rc = { r.x, r.y, r.Right(), r.Bottom() };
+    return rc;
+}
+
+// 上报损伤并安排重绘（r 为 backDC/客户区坐标，NULL 表示整屏）。
+// 覆盖层的重绘请求都经这里记入 ctx->damage，WM_PAINT 再按矩形列表局部合成。
+static void InvalidateDamage(HWND hwnd, CaptureContext* ctx, const RECT* r) {
+    if (!r) {
+        ctx->damage.AddAll();
+        InvalidateRect(hwnd, NULL, FALSE);
+        return;
+    }
+    if (!IsValidRect(*r)) return;
+    ctx->damage.Add(ToIntRect(*r));
+    InvalidateRect(hwnd, r, FALSE);
+}
+
 // ---- 绘制函数 ----
 
+static void DrawSurfaceToDC(HDC dc, int x, int y, const ztools::ImageView& view);
+
 // 绘制放大镜 + 鼠标信息面板
+// 放大镜：base 为截屏的物理像素（baseScale 为其相对逻辑坐标的比例），由常驻的 magnifier 按整数倍
+// 最近邻放大后直接画到面板上，读数取放大镜中心格，与中心块必然一致；高 DPI 下也逐物理像素取色，
+// 不读经过平均的逻辑底图。像素不可用时退回从 baseDC StretchBlt，读数用调用方给的 color。
+// 读数由 core/magnifier 写进定长缓冲，整个面板更新不分配内存
 static void DrawInfoPanel(HDC hdc, int panelX, int panelY, COLORREF color,
-    HDC memDC, int vx, int vy, int mx, int my, double dpiScale,
-    const SCGdiResources& gdi, const SCPanelMetrics& m) {
+    ztools::Magnifier& magnifier, const ztools::ImageView& base, HDC baseDC, double baseScale,
+    int vx, int vy, int mx, int my, const SCGdiResources& gdi, const SCPanelMetrics& m) {
     HGDIOBJ oldBrush = SelectObject(hdc, gdi.bgBrush);
     HGDIOBJ oldPen = SelectObject(hdc, gdi.borderPen);
 
@@ -1654,26 +2194,30 @@ static void DrawInfoPanel(HDC hdc, int panelX, int panelY, COLORREF color,
     RoundRect(hdc, panelX, panelY, panelX + m.w, panelY + m.h,
         m.radius, m.radius);
 
-    // 放大镜：从物理尺寸位图取像素
-    int srcW = m.w / SC_ZOOM_FACTOR;
-    int srcH = m.magnifierH / SC_ZOOM_FACTOR;
-    int mxLogical = mx - vx;
-    int myLogical = my - vy;
-    int mxPhysical = (int)(mxLogical * dpiScale + 0.5);
-    int myPhysical = (int)(myLogical * dpiScale + 0.5);
-    int srcWPhysical = (int)(srcW * dpiScale + 0.5);
-    int srcHPhysical = (int)(srcH * dpiScale + 0.5);
-    int srcXPhysical = mxPhysical - srcWPhysical / 2;
-    int srcYPhysical = myPhysical - srcHPhysical / 2;
-
     int magX = panelX + m.borderPad;
     int magY = panelY + m.borderPad;
     int magW = m.w - m.borderPad * 2;
     int magH = m.magnifierH - m.borderPad;
-
-    StretchBlt(hdc, magX, magY, magW, magH, memDC,
-        (std::max)(srcXPhysical, 0), (std::max)(srcYPhysical, 0),
-        srcWPhysical, srcHPhysical, SRCCOPY);
+    int mxBase = (int)((mx - vx) * baseScale + 0.5);
+    int myBase = (int)((my - vy) * baseScale + 0.5);
+
+    std::uint32_t readColor = ztools::PackBgra(GetRValue(color), GetGValue(color), GetBValue(color));
+    if (!base.Empty()) {
+        // 每个物理像素放大为 zoom x zoom 的整块；倍数按 DPI 比例缩小，视野与 100% 缩放时一致
+        int zoom = (std::max)(1, (int)(SC_ZOOM_FACTOR / baseScale + 0.5));
+        magnifier.Configure(magW, magH, zoom);
+        magnifier.Render(base, mxBase, myBase, ztools::PackBgra(0, 0, 0));
+        DrawSurfaceToDC(hdc, magX, magY, magnifier.view());
+        readColor = magnifier.Center();
+    } else {
+        int srcW = m.w / SC_ZOOM_FACTOR;
+        int srcH = m.magnifierH / SC_ZOOM_FACTOR;
+        int srcWBase = (int)(srcW * baseScale + 0.5);
+        int srcHBase = (int)(srcH * baseScale + 0.5);
+        StretchBlt(hdc, magX, magY, magW, magH, baseDC,
+            (std::max)(mxBase - srcWBase / 2, 0), (std::max)(myBase - srcHBase / 2, 0),
+            srcWBase, srcHBase, SRCCOPY);
+    }
 
     // 十字准星
     SelectObject(hdc, gdi.crosshairPen);
@@ -1687,10 +2231,10 @@ static void DrawInfoPanel(HDC hdc, int panelX, int panelY, COLORREF color,
     SetTextColor(hdc, RGB(255, 255, 255));
     HGDIOBJ oldFont = SelectObject(hdc, gdi.smallFont);
 
-    char hexBuf[32], rgbBuf[32];
-    ColorrefToStrings(color, hexBuf, rgbBuf);
-    char posBuf[64];
-    sprintf_s(posBuf, "%d, %d", mx, my);
+    ztools::ColorReadout readout;
+    ztools::FormatColorReadout(readColor, readout);
+    char posBuf[24];
+    ztools::FormatPoint(mx, my, posBuf);
 
     int labelX = panelX + m.labelPad;
     int valueRightX = panelX + m.w - m.labelPad;
@@ -1699,49 +2243,50 @@ static void DrawInfoPanel(HDC hdc, int panelX, int panelY, COLORREF color,
     SIZE textSize;
     GetTextExtentPoint32W(hdc, L"测试", 2, &textSize);
     int lineH = textSize.cy;
-    int infoY = panelY + m.h - m.labelPad - lineH * 3;
-
-    // 辅助：右对齐绘制
-    auto drawRightAligned = [&](const wchar_t* text, int len, int rx, int ry) {
+    int infoY = panelY + m.h - m.labelPad - lineH * 4;
+
+    // 辅助：ASCII 读数右对齐绘制（逐字节扩成 UTF-16，读数都是 ASCII）
+    auto drawRightAligned = [&](const char* text, int ry) {
+        wchar_t wide[24];
+        int len = 0;
+        while (text[len] && len < 23) {
+            wide[len] = (wchar_t)(unsigned char)text[len];
+            len++;
+        }
         SIZE sz;
-        GetTextExtentPoint32W(hdc, text, len, &sz);
-        TextOutW(hdc, rx - sz.cx, ry, text, len);
+        GetTextExtentPoint32W(hdc, wide, len, &sz);
+        TextOutW(hdc, valueRightX - sz.cx, ry, wide, len);
     };
 
-    // 坐标
     TextOutW(hdc, labelX, infoY, L"坐标", 2);
-    std::wstring posW(posBuf, posBuf + strlen(posBuf));
-    drawRightAligned(posW.c_str(), (int)posW.size(), valueRightX, infoY);
-
-    // HEX
+    drawRightAligned(posBuf, infoY);
     TextOutW(hdc, labelX, infoY + lineH, L"HEX", 3);
-    std::wstring hexW(hexBuf, hexBuf + strlen(hexBuf));
-    drawRightAligned(hexW.c_str(), (int)hexW.size(), valueRightX, infoY + lineH);
-
-    // RGB
+    drawRightAligned(readout.hex, infoY + lineH);
     TextOutW(hdc, labelX, infoY + lineH * 2, L"RGB", 3);
-    std::wstring rgbW(rgbBuf, rgbBuf + strlen(rgbBuf));
-    drawRightAligned(rgbW.c_str(), (int)rgbW.size(), valueRightX, infoY + lineH * 2);
+    drawRightAligned(readout.rgb, infoY + lineH * 2);
+    TextOutW(hdc, labelX, infoY + lineH * 3, L"HSL", 3);
+    drawRightAligned(readout.hsl, infoY + lineH * 3);
 
     SelectObject(hdc, oldFont);
     SelectObject(hdc, oldBrush);
     SelectObject(hdc, oldPen);
 }
 
-// 绘制尺寸标签，返回标签矩形
-static RECT DrawSizeLabel(HDC hdc, int width, int height,
+// 尺寸标签布局：生成文字并返回标签矩形（绘制与拖动时的损伤预算共用）
+static RECT LayoutSizeLabel(HDC hdc, int width, int height,
     int refLeft, int refTop, int refRight, int refBottom,
-    int virtualW, int virtualH, const SCGdiResources& gdi, const SCPanelMetrics& m) {
+    int virtualW, int virtualH, const SCGdiResources& gdi, const SCPanelMetrics& m,
+    wchar_t (&sizeBuf)[64]) {
     RECT empty = {0, 0, 0, 0};
     if (width < 0 || height < 0) return empty;
 
-    wchar_t sizeBuf[64];
     swprintf_s(sizeBuf, L"%d × %d", width, height);
     int sizeLen = (int)wcslen(sizeBuf);
 
     HGDIOBJ oldFont = SelectObject(hdc, gdi.smallFont);
     SIZE textSize;
     GetTextExtentPoint32W(hdc, sizeBuf, sizeLen, &textSize);
+    SelectObject(hdc, oldFont);
 
     int labelW = textSize.cx + m.sizeLabelPadX * 2;
     int labelH = textSize.cy + m.sizeLabelPadY;
@@ -1761,20 +2306,32 @@ static RECT DrawSizeLabel(HDC hdc, int width, int height,
     if (lx + labelW > virtualW) lx = virtualW - labelW;
     if (ly + labelH > virtualH) ly = virtualH - labelH;
 
+    RECT result = { lx, ly, lx + labelW, ly + labelH };
+    return result;
+}
+
+// 绘制尺寸标签，返回标签矩形
+static RECT DrawSizeLabel(HDC hdc, int width, int height,
+    int refLeft, int refTop, int refRight, int refBottom,
+    int virtualW, int virtualH, const SCGdiResources& gdi, const SCPanelMetrics& m) {
+    wchar_t sizeBuf[64];
+    RECT label = LayoutSizeLabel(hdc, width, height, refLeft, refTop, refRight, refBottom,
+        virtualW, virtualH, gdi, m, sizeBuf);
+    if (!IsValidRect(label)) return label;
+
+    HGDIOBJ oldFont = SelectObject(hdc, gdi.smallFont);
     HGDIOBJ oldBrush = SelectObject(hdc, gdi.bgBrush);
     HGDIOBJ oldPen = SelectObject(hdc, gdi.borderPen);
-    RoundRect(hdc, lx, ly, lx + labelW, ly + labelH, m.radius, m.radius);
+    RoundRect(hdc, label.left, label.top, label.right, label.bottom, m.radius, m.radius);
 
     SetBkMode(hdc, TRANSPARENT);
     SetTextColor(hdc, RGB(255, 255, 255));
-    TextOutW(hdc, lx + m.sizeLabelPadX, ly + m.borderPad, sizeBuf, sizeLen);
+    TextOutW(hdc, label.left + m.sizeLabelPadX, label.top + m.borderPad, sizeBuf, (int)wcslen(sizeBuf));
 
     SelectObject(hdc, oldFont);
     SelectObject(hdc, oldBrush);
     SelectObject(hdc, oldPen);
-
-    RECT result = { lx, ly, lx + labelW, ly + labelH };
-    return result;
+    return label;
 }
 
 // 绘制选区矩形边框 + 尺寸标签
@@ -1813,41 +2370,20 @@ static void DrawWindowHighlight(HDC hdc, const RECT& rect, int vx, int vy, const
 }
 
 // 绘制选区外遮罩（微信风格）
-// 在 backDC 上对"选区外部"区域 AlphaBlend 一层半透明黑色，
-// 选区内部不绘制，保持原始截图清晰。
-// rect 为相对虚拟屏幕的逻辑坐标（已减去 virtualX/virtualY）。
-static void DrawDimMask(HDC backDC, const SCGdiResources& gdi,
-    int selLeft, int selTop, int selRight, int selBottom,
-    int virtualW, int virtualH) {
-    if (!gdi.maskDC || !gdi.maskBitmap) return;
-
-    BLENDFUNCTION blend;
-    blend.BlendOp = AC_SRC_OVER;
-    blend.BlendFlags = 0;
-    blend.SourceConstantAlpha = SC_MASK_ALPHA;
-    blend.AlphaFormat = 0;  // 不使用 per-pixel alpha，仅用常量 alpha
-
-    // 将虚拟屏幕按选区划分为四周四块，逐块 AlphaBlend 遮罩
-    // 上：x ∈ [0, vw], y ∈ [0, selTop]
-    if (selTop > 0) {
-        AlphaBlend(backDC, 0, 0, virtualW, selTop,
-            gdi.maskDC, 0, 0, virtualW, selTop, blend);
-    }
-    // 下：x ∈ [0, vw], y ∈ [selBottom, vh]
-    if (selBottom < virtualH) {
-        AlphaBlend(backDC, 0, selBottom, virtualW, virtualH - selBottom,
-            gdi.maskDC, 0, selBottom, virtualW, virtualH - selBottom, blend);
-    }
-    // 左：x ∈ [0, selLeft], y ∈ [selTop, selBottom]
-    if (selLeft > 0 && selBottom > selTop) {
-        AlphaBlend(backDC, 0, selTop, selLeft, selBottom - selTop,
-            gdi.maskDC, 0, selTop, selLeft, selBottom - selTop, blend);
-    }
-    // 右：x ∈ [selRight, vw], y ∈ [selTop, selBottom]
-    if (selRight < virtualW && selBottom > selTop) {
-        AlphaBlend(backDC, selRight, selTop, virtualW - selRight, selBottom - selTop,
-            gdi.maskDC, selRight, selTop, virtualW - selRight, selBottom - selTop, blend);
+// 在后备缓冲的 DIB 像素上对"选区外部"就地变暗（core/dim_mask，常量黑 + SC_MASK_ALPHA），
+// 选区内部不处理，保持原始截图清晰。只处理本帧损伤矩形：矩形两两不相交，不会重复变暗；
+// 整屏帧按多线程处理。不再需要虚拟屏幕大小的纯黑遮罩位图。
+// sel 为相对虚拟屏幕的逻辑坐标（已减去 virtualX/virtualY）。
+static void DrawDimMask(const ztools::ImageView& back, const ztools::DamageTracker& damage, const RECT& sel) {
+    if (back.Empty()) return;
+    GdiFlush();  // 背景恢复等 GDI 批处理先落到 DIB 上，再由 CPU 直接改像素
+    const ztools::IntRect keep = ToIntRect(sel);
+    const std::uint32_t black = ztools::PackBgra(0, 0, 0);
+    if (damage.Full()) {
+        ztools::DimOutside(back, keep, back.Bounds(), black, SC_MASK_ALPHA, 0);
+        return;
     }
+    for (const ztools::IntRect& r : damage.Rects()) ztools::DimOutside(back, keep, r, black, SC_MASK_ALPHA);
 }
 
 // ---- 确认态辅助函数 ----
@@ -2259,82 +2795,160 @@ static void DrawOneAnnotation(Gdiplus::Graphics& graphics, const Annotation& a,
     }
 }
 
+// ==================== 光栅核心适配（GDI 呈现层） ====================
+// 像素处理（缩放 / 混合 / 马赛克）统一由 core/raster 在 32bpp DIB 位上完成；
+// 这里只负责创建可直接访问像素的 DIB section、从 DC 取像素、以及把结果交回 GDI。
+
+// 创建自上而下的 32bpp DIB section，outView 指向其像素（位图释放前有效）
+static HBITMAP CreateSurfaceBitmap(int w, int h, ztools::ImageView& outView) {
+    outView = ztools::ImageView();
+    if (w <= 0 || h <= 0) return NULL;
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = w;
+    bmi.bmiHeader.biHeight = -h;  // 自上而下，与 ImageView 行序一致
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    HBITMAP bmp = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    if (!bmp || !bits) {
+        if (bmp) DeleteObject(bmp);
+        return NULL;
+    }
+    outView = ztools::ImageView(bits, w, h, w * 4);
+    return bmp;
+}
+
+// 若 bmp 是自上而下的 32bpp DIB section，outView 指向其像素（不复制）；否则返回 false
+static bool SurfaceViewOf(HBITMAP bmp, ztools::ImageView& outView) {
+    outView = ztools::ImageView();
+    DIBSECTION ds = {};
+    if (!bmp || GetObject(bmp, sizeof(DIBSECTION), &ds) != sizeof(DIBSECTION)) return false;
+    if (!ds.dsBm.bmBits || ds.dsBm.bmBitsPixel != 32 || ds.dsBmih.biHeight >= 0) return false;
+    outView = ztools::ImageView(ds.dsBm.bmBits, ds.dsBm.bmWidth, ds.dsBm.bmHeight, ds.dsBm.bmWidthBytes);
+    return true;
+}
+
+// 把 srcDC 中以 (x, y) 为左上角的区域读入新建的 DIB section（尺寸 = outView 尺寸）。
+// 截屏位图是设备相关位图且已选入 DC，不能直接 GetDIBits，故经一次 BitBlt 转成 DIB。
+static HBITMAP ReadDCToSurfaceBitmap(HDC srcDC, int x, int y, int w, int h, ztools::ImageView& outView) {
+    HBITMAP bmp = CreateSurfaceBitmap(w, h, outView);
+    if (!bmp) return NULL;
+    HDC tmpDC = CreateCompatibleDC(srcDC);
+    if (!tmpDC) {
+        DeleteObject(bmp);
+        outView = ztools::ImageView();
+        return NULL;
+    }
+    HGDIOBJ old = SelectObject(tmpDC, bmp);
+    BitBlt(tmpDC, 0, 0, w, h, srcDC, x, y, SRCCOPY);
+    SelectObject(tmpDC, old);
+    DeleteDC(tmpDC);
+    GdiFlush();  // CPU 访问 DIB 位之前必须确保 GDI 批处理已完成
+    return bmp;
+}
+
+// 把紧凑行（stride = width * 4）的像素直接绘制到 dc 的 (x, y)，受 dc 当前裁剪区限制
+static void DrawSurfaceToDC(HDC dc, int x, int y, const ztools::ImageView& view) {
+    if (view.Empty()) return;
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = view.width;
+    bmi.bmiHeader.biHeight = -view.height;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    SetDIBitsToDevice(dc, x, y, view.width, view.height, 0, 0, 0, view.height, view.data, &bmi, DIB_RGB_COLORS);
+}
+
 // ==================== 马赛克渲染 ====================
-// 马赛克原理：从原始屏幕位图（srcDC = memDC，物理像素）取目标区域，按 mosaicSize 分块，
-// 每块用「缩小到 1 像素再放大」得到平均色块（StretchBlt 降采样），形成马赛克效果。
-// 目标 DC（targetDC）为逻辑像素（backDC / finalDC），源 DC（srcDC）为物理像素（memDC），
-// 二者通过 dpiScale 换算：srcX = (absX - virtualX) * dpiScale。
-
-// 对单个矩形区域做马赛克化并绘制到 targetDC。
-// dstX0/dstY0/dstW/dstH：目标逻辑像素矩形（已应用偏移到 targetDC 局部坐标）；
-// srcAbsX0/srcAbsY0：该矩形左上角的绝对虚拟屏幕坐标（用于在 memDC 取源像素）；
-// blockPx：马赛克块大小（逻辑像素）；srcDC/virtualX/virtualY/dpiScale：源参数。
-static void MosaicBlitRect(HDC targetDC, HDC srcDC,
-                           int dstX0, int dstY0, int dstW, int dstH,
-                           int srcAbsX0, int srcAbsY0,
-                           int blockPx, int virtualX, int virtualY, double dpiScale) {
-    if (dstW <= 0 || dstH <= 0 || blockPx < 1) return;
-
-    // 临时 1x1 DC：用作缩小缓冲（取块平均色）
-    HDC screenDC = GetDC(NULL);
-    if (!screenDC) return;
-    HDC onePxDC = CreateCompatibleDC(screenDC);
-    HBITMAP onePxBmp = CreateCompatibleBitmap(screenDC, 1, 1);
-    HGDIOBJ oldOne = SelectObject(onePxDC, onePxBmp);
-    ReleaseDC(NULL, screenDC);
+// 马赛克原理：原始屏幕位图（memDC，物理像素）按 mosaicSize 分块，每块填充其物理区域的平均色。
+// 块平均由 core/mosaic 在 DIB 位上完成（SIMD 列累加 + 按块行多线程），
+// 取代逐块「StretchBlt 缩到 1x1 再放大」的两次 GDI 调用；输出为逻辑像素，通过 dpiScale 换算取源。
+
+// 确保预截屏像素可直接读取：截屏位图是 DIB section（两条截屏路径都是）时直接映射，
+// 否则整张物理位图 BitBlt 成一份 DIB 副本（会话内只做一次）
+static bool EnsureScreenPixels(CaptureContext* ctx) {
+    if (!ctx->screenPixels.Empty()) return true;
+    if (SurfaceViewOf(ctx->screenBitmap, ctx->screenPixels)) {
+        GdiFlush();
+        return true;
+    }
+    BITMAP bm = {};
+    if (!ctx->screenBitmap || !GetObject(ctx->screenBitmap, sizeof(BITMAP), &bm)) return false;
+    ctx->screenDib = ReadDCToSurfaceBitmap(ctx->memDC, 0, 0, bm.bmWidth, bm.bmHeight, ctx->screenPixels);
+    return ctx->screenDib != NULL;
+}
 
-    SetStretchBltMode(onePxDC, HALFTONE);
-    SetBrushOrgEx(onePxDC, 0, 0, NULL);
-    int oldTargetMode = GetStretchBltMode(targetDC);
-    SetStretchBltMode(targetDC, COLORONCOLOR);  // 放大时取最近邻，保持块色纯净
-
-    // 按块遍历（逻辑像素步进）
-    for (int by = 0; by < dstH; by += blockPx) {
-        for (int bx = 0; bx < dstW; bx += blockPx) {
-            int dstBlockX = dstX0 + bx;
-            int dstBlockY = dstY0 + by;
-            int bw = (std::min)(blockPx, dstW - bx);
-            int bh = (std::min)(blockPx, dstH - by);
-
-            // 源像素坐标（物理）
-            int srcAbsX = srcAbsX0 + bx;
-            int srcAbsY = srcAbsY0 + by;
-            int sx = (int)((srcAbsX - virtualX) * dpiScale + 0.5);
-            int sy = (int)((srcAbsY - virtualY) * dpiScale + 0.5);
-            int sw = (int)(bw * dpiScale + 0.5);
-            int sh = (int)(bh * dpiScale + 0.5);
-            if (sw < 1) sw = 1;
-            if (sh < 1) sh = 1;
-
-            // 缩小到 1px（取整块平均色）
-            if (StretchBlt(onePxDC, 0, 0, 1, 1, srcDC, sx, sy, sw, sh, SRCCOPY)) {
-                // 放大回目标块
-                StretchBlt(targetDC, dstBlockX, dstBlockY, bw, bh,
-                           onePxDC, 0, 0, 1, 1, SRCCOPY);
-            }
-        }
+static void FreeScreenPixels(CaptureContext* ctx) {
+    if (ctx->screenDib) { DeleteObject(ctx->screenDib); ctx->screenDib = NULL; }
+    ctx->screenPixels = ztools::ImageView();
+}
+
+// ==================== 逻辑分辨率底图 ====================
+// 高 DPI 时每帧从物理截图 StretchBlt 回逻辑尺寸，代价随物理分辨率线性增长且每次重绘都要付。
+// 会话开始时用 core/downscale（SIMD 面积平均 + 多线程）一次性缩好，之后恢复背景只需 BitBlt。
+
+static void FreeLogicalBase(CaptureContext* ctx) {
+    if (ctx->logicalBaseDC) { DeleteDC(ctx->logicalBaseDC); ctx->logicalBaseDC = NULL; }
+    if (ctx->logicalBaseBitmap) { DeleteObject(ctx->logicalBaseBitmap); ctx->logicalBaseBitmap = NULL; }
+    ctx->logicalBase = ztools::ImageView();
+}
+
+static void PrepareLogicalBase(CaptureContext* ctx) {
+    if (ztools::IsUnitScale(ctx->dpiScale) || ctx->logicalBaseDC) return;
+    if (!EnsureScreenPixels(ctx)) return;
+    ctx->logicalBaseBitmap = CreateSurfaceBitmap(ctx->virtualW, ctx->virtualH, ctx->logicalBase);
+    if (!ctx->logicalBaseBitmap) return;
+    ztools::DownscaleBox(ctx->screenPixels, ctx->logicalBase);
+    ctx->logicalBaseDC = CreateCompatibleDC(ctx->memDC);
+    if (!ctx->logicalBaseDC) {
+        FreeLogicalBase(ctx);
+        return;
     }
-    SetStretchBltMode(targetDC, oldTargetMode);
+    SelectObject(ctx->logicalBaseDC, ctx->logicalBaseBitmap);
+}
+
+// 每帧取背景的源 DC 与其相对逻辑坐标的缩放比（有逻辑底图时为 1:1）
+static HDC PaintBaseDC(const CaptureContext* ctx) {
+    return ctx->logicalBaseDC ? ctx->logicalBaseDC : ctx->memDC;
+}
 
-    SelectObject(onePxDC, oldOne);
-    DeleteObject(onePxBmp);
-    DeleteDC(onePxDC);
+static double PaintBaseScale(const CaptureContext* ctx) {
+    return ctx->logicalBaseDC ? 1.0 : ctx->dpiScale;
+}
+
+// 信息面板 / 尺寸标签按鼠标所在显示器的 DPI 排版；DPI 变化时重建面板度量与字体，返回 true 表示需要整屏重绘
+static bool ApplyPanelDpiForCursor(CaptureContext* ctx) {
+    if (ctx->monitors.empty()) return false;
+    int dpi = ctx->monitors.DpiAt(ctx->mouseX, ctx->mouseY);
+    if (dpi == ctx->panelDpi) return false;
+    ctx->panelDpi = dpi;
+    ctx->panelMetrics = CalcPanelMetrics(dpi / 96.0);
+    ctx->gdi.Cleanup();
+    ctx->gdi.Init(ctx->panelMetrics.fontPx, ctx->panelMetrics.crosshair);
+    return true;
 }
 
 
 // ==================== 马赛克渲染（reveal-mask 模型） ====================
-// 核心：预先把整张选区按当前块大小做一次完整马赛克化得到 mosaicBase（逻辑像素）。
-// 马赛克标注只是「蒙版」——涂抹=路径圆形区域、框选=矩形区域——揭示其背后的 mosaicBase。
-// 任意区域、任意顺序叠加都连续无缝；切换块大小只需重建 base，已揭示区域自动更新。
+// 核心：整张截图按当前块大小马赛克化得到 mosaic base（逻辑像素，按瓦片惰性计算）。
+// 马赛克标注只是「蒙版」——涂抹=路径圆形区域、框选=矩形区域——揭示其背后的 base。
+// 任意区域、任意顺序叠加都连续无缝；切换块大小只需换一层 base，已揭示区域自动更新。
 // 不再对每个标注单独像素化，故无「松开后再处理一遍」的不连续感。
 
-// 释放马赛克 base 资源
+// 释放马赛克 base 瓦片、蒙版与揭示层
 static void FreeMosaicBase(CaptureContext* ctx) {
-    if (ctx->mosaicBaseDC) { DeleteDC(ctx->mosaicBaseDC); ctx->mosaicBaseDC = NULL; }
-    if (ctx->mosaicBaseBitmap) { DeleteObject(ctx->mosaicBaseBitmap); ctx->mosaicBaseBitmap = NULL; }
-    ctx->mosaicBaseW = 0;
-    ctx->mosaicBaseH = 0;
-    ctx->mosaicBaseBlockPx = 0;
+    if (ctx->mosaicRevealDC) { DeleteDC(ctx->mosaicRevealDC); ctx->mosaicRevealDC = NULL; }
+    if (ctx->mosaicRevealBitmap) { DeleteObject(ctx->mosaicRevealBitmap); ctx->mosaicRevealBitmap = NULL; }
+    ctx->mosaicRevealView = ztools::ImageView();
+    ctx->mosaicRevealBlockPx = 0;
+    ctx->mosaicMask.Reset(0, 0);
+    ctx->mosaicLiveMask.Reset(0, 0);
+    ctx->mosaicLiveBox = ztools::IntRect();
+    ctx->mosaicMaskKeys.clear();
+    ctx->mosaicTiles.Clear();
 }
 
 // 用 GDI+ 把单色位图转为带透明通道的 32bpp HBITMAP（用于光标）。
@@ -2415,48 +3029,20 @@ static void FreeMosaicBrushCursors(CaptureContext* ctx) {
     ctx->mosaicBrushCursorsInited = false;
 }
 
-// 生成马赛克 base：把整张虚拟屏幕原始底图按 blockPx 马赛克化，存为离屏位图。
-// base 用绝对（虚拟屏幕）坐标、尺寸 = virtualW×virtualH（与 backDC 一致），与选区无关。
-// 这样选区 resize/move 时 base 无需重建（标注蒙版用绝对坐标，任意选区下都正确对位），
-// 仅在块大小变化或初次生成时重建。代价是占一份全屏位图内存（与 backDC/memDC 同级）。
-static void RebuildMosaicBase(CaptureContext* ctx) {
-    int w = ctx->virtualW;
-    int h = ctx->virtualH;
-    if (w <= 0 || h <= 0) { FreeMosaicBase(ctx); return; }
-
+// 当前生效的马赛克块大小（逻辑像素）
+static int CurrentMosaicBlockPx(const CaptureContext* ctx) {
     int blockPx = SC_MOSAIC_SIZES[ctx->mosaicSizeIdx];
-    if (blockPx < 2) blockPx = 2;
-
-    // 尺寸/块大小变化才重建位图
-    if (w != ctx->mosaicBaseW || h != ctx->mosaicBaseH
-        || blockPx != ctx->mosaicBaseBlockPx || !ctx->mosaicBaseDC) {
-        FreeMosaicBase(ctx);
-        HDC screenDC = GetDC(NULL);
-        if (!screenDC) return;
-        ctx->mosaicBaseDC = CreateCompatibleDC(screenDC);
-        ctx->mosaicBaseBitmap = CreateCompatibleBitmap(screenDC, w, h);
-        ReleaseDC(NULL, screenDC);
-        if (!ctx->mosaicBaseDC || !ctx->mosaicBaseBitmap) { FreeMosaicBase(ctx); return; }
-        SelectObject(ctx->mosaicBaseDC, ctx->mosaicBaseBitmap);
-        ctx->mosaicBaseW = w;
-        ctx->mosaicBaseH = h;
-        ctx->mosaicBaseBlockPx = blockPx;
-    }
-
-    // 整虚拟屏幕按 blockPx 马赛克化：base 原点 = 虚拟屏幕左上角，源绝对坐标 = virtualX/virtualY。
-    MosaicBlitRect(ctx->mosaicBaseDC, ctx->memDC, 0, 0, w, h,
-                   ctx->virtualX, ctx->virtualY, blockPx,
-                   ctx->virtualX, ctx->virtualY, ctx->dpiScale);
+    return blockPx < 2 ? 2 : blockPx;
 }
 
-// 检查 base 是否需要重建（仅块大小变化 / 未生成）。
-// base 覆盖整屏且用绝对坐标，选区变化不影响 base，故 resize/move 无需重建。
-static bool MosaicBaseNeedsRebuild(const CaptureContext* ctx) {
-    int blockPx = SC_MOSAIC_SIZES[ctx->mosaicSizeIdx];
-    if (blockPx < 2) blockPx = 2;
-    bool blockChanged = (blockPx != ctx->mosaicBaseBlockPx);
-    bool sizeChanged = (ctx->mosaicBaseW != ctx->virtualW || ctx->mosaicBaseH != ctx->virtualH);
-    return blockChanged || sizeChanged || !ctx->mosaicBaseDC;
+// 绑定瓦片缓存的源图：base 用虚拟屏幕坐标（原点 = 虚拟左上角 = 物理截图原点）、
+// 尺寸 = virtualW×virtualH（与 backDC 一致），网格锚定在虚拟屏幕左上角，与选区无关。
+// 导出也复用同一份缓存，保证导出的块与预览逐像素一致。
+static bool PrepareMosaicTiles(CaptureContext* ctx) {
+    if (ctx->mosaicTiles.Ready()) return true;
+    if (ctx->virtualW <= 0 || ctx->virtualH <= 0 || !EnsureScreenPixels(ctx)) return false;
+    ctx->mosaicTiles.Reset(ctx->screenPixels, ctx->dpiScale, ctx->virtualW, ctx->virtualH);
+    return true;
 }
 
 static bool HasMosaicToRender(const std::vector<Annotation>& annotations, const Annotation* curDrawing) {
@@ -2467,172 +3053,371 @@ static bool HasMosaicToRender(const std::vector<Annotation>& annotations, const
     return false;
 }
 
-// 把单条马赛克标注对应的「蒙版区域」构建为 HRGN（选区相对坐标）。
-// ox/oy：绝对坐标 → 目标局部坐标的偏移（= -sel.left/-sel.top，因为 base/overlay 都是选区相对）。
-static HRGN BuildMosaicMaskRegion(const Annotation& a, float ox, float oy) {
+static MosaicMaskKey MakeMosaicMaskKey(const Annotation& a) {
+    MosaicMaskKey key = {};
+    key.rect = a.mosaicRect;
     if (a.mosaicRect) {
-        int absL = (std::min)(a.x1, a.x2);
-        int absT = (std::min)(a.y1, a.y2);
-        int absR = (std::max)(a.x1, a.x2);
-        int absB = (std::max)(a.y1, a.y2);
-        return CreateRectRgn((int)(absL + ox + 0.5f), (int)(absT + oy + 0.5f),
-                             (int)(absR + ox + 0.5f), (int)(absB + oy + 0.5f));
+        key.x1 = a.x1; key.y1 = a.y1; key.x2 = a.x2; key.y2 = a.y2;
     } else {
-        // 涂抹：把整条路径变为连续的「胶囊」区域（保证快速移动时不留空隙）。
-        // 做法：沿相邻点之间的线段以不超过 radius/2 的步长插值取点，每个点画一个圆并并入区域，
-        // 相邻圆重叠从而形成无缝的粗笔触轨迹。
-        int radius = a.brushRadius;
-        if (radius < 1) radius = 1;
-        HRGN rgn = CreateRectRgn(0, 0, 0, 0);
-        if (a.pts.empty()) return rgn;
-        // 步长：半径的一半，保证相邻圆重叠 ≥50%，无视觉缝隙
-        double step = (std::max)(1.0, radius * 0.5);
-
-        auto addCircle = [&](double cx, double cy) {
-            int ix = (int)(cx + 0.5);
-            int iy = (int)(cy + 0.5);
-            HRGN circle = CreateEllipticRgn(ix - radius, iy - radius,
-                                            ix + radius, iy + radius);
-            CombineRgn(rgn, rgn, circle, RGN_OR);
-            DeleteObject(circle);
-        };
+        key.radius = a.brushRadius;
+        key.count = a.pts.size();
+        if (!a.pts.empty()) { key.first = a.pts.front(); key.last = a.pts.back(); }
+    }
+    return key;
+}
 
-        // 第一个点
-        addCircle(a.pts[0].x + ox, a.pts[0].y + oy);
-        for (size_t i = 1; i < a.pts.size(); i++) {
-            double x0 = a.pts[i - 1].x + ox;
-            double y0 = a.pts[i - 1].y + oy;
-            double x1 = a.pts[i].x + ox;
-            double y1 = a.pts[i].y + oy;
-            double dx = x1 - x0, dy = y1 - y0;
-            double segLen = std::sqrt(dx * dx + dy * dy);
-            if (segLen < 0.5) {
-                addCircle(x1, y1);
-                continue;
+// 把绝对坐标的路径点转为 backDC 坐标（蒙版坐标系）
+static std::vector<ztools::MaskPoint> MosaicMaskPoints(const CaptureContext* ctx, const Annotation& a) {
+    std::vector<ztools::MaskPoint> pts(a.pts.size());
+    for (size_t i = 0; i < a.pts.size(); i++) {
+        pts[i].x = a.pts[i].x - ctx->virtualX;
+        pts[i].y = a.pts[i].y - ctx->virtualY;
+    }
+    return pts;
+}
+
+static ztools::IntRect MosaicMaskRect(const CaptureContext* ctx, const Annotation& a) {
+    return ztools::IntRect::FromLTRB((std::min)(a.x1, a.x2) - ctx->virtualX, (std::min)(a.y1, a.y2) - ctx->virtualY,
+                                     (std::max)(a.x1, a.x2) - ctx->virtualX, (std::max)(a.y1, a.y2) - ctx->virtualY);
+}
+
+// 把单条马赛克标注光栅化进蒙版：框选 = 矩形，涂抹 = 沿路径的胶囊串；返回触及的矩形
+static ztools::IntRect RasterizeMosaicAnnotation(const CaptureContext* ctx, const Annotation& a,
+                                                 ztools::CoverageMask& mask) {
+    if (a.mosaicRect) return mask.FillRect(MosaicMaskRect(ctx, a));
+    std::vector<ztools::MaskPoint> pts = MosaicMaskPoints(ctx, a);
+    return ztools::RasterizeStroke(mask, pts.data(), (int)pts.size(), a.brushRadius);
+}
+
+// 揭示层（虚拟屏幕大小的预乘 alpha DIB section）与两张蒙版按需创建
+static bool PrepareMosaicReveal(CaptureContext* ctx) {
+    if (!PrepareMosaicTiles(ctx)) return false;
+    if (ctx->mosaicRevealDC) return true;
+    ctx->mosaicRevealBitmap = CreateSurfaceBitmap(ctx->virtualW, ctx->virtualH, ctx->mosaicRevealView);
+    ctx->mosaicRevealDC = ctx->mosaicRevealBitmap ? CreateCompatibleDC(ctx->memDC) : NULL;
+    if (!ctx->mosaicRevealDC) {
+        if (ctx->mosaicRevealBitmap) { DeleteObject(ctx->mosaicRevealBitmap); ctx->mosaicRevealBitmap = NULL; }
+        ctx->mosaicRevealView = ztools::ImageView();
+        return false;
+    }
+    SelectObject(ctx->mosaicRevealDC, ctx->mosaicRevealBitmap);
+    ctx->mosaicMask.Reset(ctx->virtualW, ctx->virtualH);
+    ctx->mosaicLiveMask.Reset(ctx->virtualW, ctx->virtualH);
+    ctx->mosaicLiveBox = ztools::IntRect();
+    ctx->mosaicMaskKeys.clear();
+    ctx->mosaicRevealBlockPx = 0;
+    return true;
+}
+
+// 让揭示层与标注列表 + 正在绘制的标注保持一致，只重新合成发生变化的包围盒：
+// 1) 已提交标注：签名前缀不变时只光栅化新追加的标注（刚提交的笔画直接并入 live 蒙版，不重画）；
+//    前缀变化（撤销 / 删除）时整体重建；
+// 2) 正在绘制：涂抹只补画新到达的线段，框选按新旧矩形更新；
+// 3) 块大小变化：整个已覆盖范围重新合成（base 瓦片按层缓存，切回时不重算）。
+static void SyncMosaicReveal(CaptureContext* ctx, const std::vector<Annotation>& annotations,
+                             const Annotation* curDrawing) {
+    if (!PrepareMosaicReveal(ctx)) return;
+    ztools::IntRect dirty;
+
+    std::vector<const Annotation*> mosaics;
+    std::vector<MosaicMaskKey> keys;
+    for (const Annotation& a : annotations) {
+        if (a.type != AT_Mosaic) continue;
+        mosaics.push_back(&a);
+        keys.push_back(MakeMosaicMaskKey(a));
+    }
+    size_t keep = 0;
+    while (keep < ctx->mosaicMaskKeys.size() && keep < keys.size() && ctx->mosaicMaskKeys[keep] == keys[keep]) keep++;
+    if (keep < ctx->mosaicMaskKeys.size()) {
+        dirty = dirty.Union(ctx->mosaicMask.Touched());
+        ctx->mosaicMask.ClearAll();
+        keep = 0;
+    }
+    bool liveUsed = false;
+    for (size_t i = keep; i < mosaics.size(); i++) {
+        if (!liveUsed && !ctx->mosaicLiveBox.Empty() && keys[i] == ctx->mosaicLiveKey) {
+            ctx->mosaicMask.MaxWith(ctx->mosaicLiveMask, ctx->mosaicLiveBox);
+            dirty = dirty.Union(ctx->mosaicLiveBox);
+            liveUsed = true;
+        } else {
+            dirty = dirty.Union(RasterizeMosaicAnnotation(ctx, *mosaics[i], ctx->mosaicMask));
+        }
+    }
+    ctx->mosaicMaskKeys.swap(keys);
+    if (liveUsed) {
+        // 刚提交的笔画已并入 mosaicMask，live 蒙版让给下一笔
+        ctx->mosaicLiveMask.ClearAll();
+        ctx->mosaicLiveBox = ztools::IntRect();
+        ctx->mosaicLiveKey = MosaicMaskKey();
+    }
+
+    bool drawing = curDrawing && curDrawing->type == AT_Mosaic;
+    if (drawing) {
+        MosaicMaskKey key = MakeMosaicMaskKey(*curDrawing);
+        if (curDrawing->mosaicRect) {
+            if (key != ctx->mosaicLiveKey || ctx->mosaicLiveBox.Empty()) {
+                dirty = dirty.Union(ctx->mosaicLiveBox);
+                ctx->mosaicLiveMask.ClearAll();
+                ctx->mosaicLiveBox = ctx->mosaicLiveMask.FillRect(MosaicMaskRect(ctx, *curDrawing));
+                dirty = dirty.Union(ctx->mosaicLiveBox);
             }
-            int n = (int)(segLen / step + 0.5);
-            if (n < 1) n = 1;
-            for (int k = 1; k <= n; k++) {
-                double t = (double)k / n;
-                addCircle(x0 + dx * t, y0 + dy * t);
+        } else {
+            // 新笔画（起点 / 半径变化、点数回退）从头开始，否则只补画新到达的点
+            bool restart = ctx->mosaicLiveKey.rect || ctx->mosaicLiveBox.Empty()
+                || ctx->mosaicLiveStroke.radius() != curDrawing->brushRadius
+                || (int)curDrawing->pts.size() < ctx->mosaicLiveStroke.done()
+                || key.first.x != ctx->mosaicLiveKey.first.x || key.first.y != ctx->mosaicLiveKey.first.y;
+            if (restart) {
+                dirty = dirty.Union(ctx->mosaicLiveBox);
+                ctx->mosaicLiveMask.ClearAll();
+                ctx->mosaicLiveBox = ztools::IntRect();
+                ctx->mosaicLiveStroke.Begin(curDrawing->brushRadius);
             }
+            std::vector<ztools::MaskPoint> pts = MosaicMaskPoints(ctx, *curDrawing);
+            ztools::IntRect added = ctx->mosaicLiveStroke.Extend(ctx->mosaicLiveMask, pts.data(), (int)pts.size());
+            ctx->mosaicLiveBox = ctx->mosaicLiveBox.Union(added);
+            dirty = dirty.Union(added);
         }
-        return rgn;
+        ctx->mosaicLiveKey = key;
+    } else if (!ctx->mosaicLiveBox.Empty()) {
+        // 笔画被取消（或提交时点数已变化、按新标注重画）：清空 live 蒙版
+        dirty = dirty.Union(ctx->mosaicLiveBox);
+        ctx->mosaicLiveMask.ClearAll();
+        ctx->mosaicLiveBox = ztools::IntRect();
+        ctx->mosaicLiveKey = MosaicMaskKey();
+    }
+
+    int blockPx = CurrentMosaicBlockPx(ctx);
+    if (blockPx != ctx->mosaicRevealBlockPx) {
+        dirty = dirty.Union(ctx->mosaicMask.Touched()).Union(ctx->mosaicLiveBox);
+        ctx->mosaicRevealBlockPx = blockPx;
     }
+    if (dirty.Empty()) return;
+    ctx->mosaicTiles.Ensure(blockPx, dirty);
+    GdiFlush();  // 揭示层可能仍有未完成的 GDI 读取
+    ztools::ComposeMosaicReveal(ctx->mosaicTiles, blockPx, ctx->mosaicMask, &ctx->mosaicLiveMask,
+                                ctx->mosaicRevealView, dirty);
 }
 
-// 揭示马赛克：把 mosaicBase 中由 masks（已提交标注）+ curDrawing（正在绘制）覆盖的区域
-// BitBlt 到 targetDC（覆盖层 backDC）。
-// 全屏 base 用虚拟屏幕绝对坐标（原点=虚拟左上角，与 backDC 同坐标系），
-// 故 base 与 targetDC 1:1 对应，蒙版用绝对坐标（ox/oy=0）直接作为裁剪区，BitBlt 同位置拷贝。
-// ox/oy：标注坐标 → 目标局部坐标偏移（覆盖层=0；导出 finalDC 时=-rect.left/-rect.top）。
-static void RevealMosaicToTarget(HDC targetDC, HDC mosaicBase,
-                                 const std::vector<Annotation>& annotations,
-                                 const Annotation* curDrawing,
-                                 float ox, float oy) {
-    // 合并所有马赛克标注的蒙版区域（目标局部坐标）
-    HRGN mask = CreateRectRgn(0, 0, 0, 0);
-    bool any = false;
-    for (const Annotation& a : annotations) {
-        if (a.type != AT_Mosaic) continue;
-        HRGN r = BuildMosaicMaskRegion(a, ox, oy);
-        CombineRgn(mask, mask, r, RGN_OR);
-        DeleteObject(r);
-        any = true;
-    }
-    if (curDrawing && curDrawing->type == AT_Mosaic) {
-        HRGN r = BuildMosaicMaskRegion(*curDrawing, ox, oy);
-        CombineRgn(mask, mask, r, RGN_OR);
-        DeleteObject(r);
-        any = true;
-    }
-    if (any) {
-        // 用 SaveDC 保护调用方的裁剪区（P1 局部帧时为 dirtyRect）：
-        // 此处设置 mask 裁剪区做马赛克揭示 BitBlt，结束后 RestoreDC 恢复，
-        // 避免清除调用方的 dirtyRect 裁剪区导致后续绘制越界。
-        int saved = SaveDC(targetDC);
-        // mask 与现有裁剪区（dirtyRect）求交，揭示只发生在 dirtyRect∩蒙版 区域
-        ExtSelectClipRgn(targetDC, mask, RGN_AND);
-        // base 与 targetDC 同坐标系，1:1 拷贝
-        BitBlt(targetDC, 0, 0, 0x7FFF, 0x7FFF, mosaicBase, 0, 0, SRCCOPY);
-        if (saved) RestoreDC(targetDC, saved);
-    }
-    DeleteObject(mask);
+// 揭示马赛克：把揭示层（已按蒙版覆盖率预乘的 base）AlphaBlend 到 targetDC。
+// 只处理 已覆盖范围 ∩ 目标现有裁剪区（局部帧时为损伤矩形之并），调用方的裁剪区保持不变。
+// baseX/baseY：targetDC 原点在揭示层（backDC 坐标系）中的位置（覆盖层=0；导出时=选区相对虚拟屏幕左上角的偏移）。
+static void RevealMosaicToTarget(HDC targetDC, CaptureContext* ctx, int baseX = 0, int baseY = 0) {
+    if (!ctx->mosaicRevealDC) return;
+    ztools::IntRect covered = ctx->mosaicMask.Touched().Union(ctx->mosaicLiveBox);
+    RECT clip = {0, 0, 0, 0};
+    if (GetClipBox(targetDC, &clip) == NULLREGION) return;
+    ztools::IntRect r = covered.Intersect(ztools::IntRect::FromLTRB(clip.left + baseX, clip.top + baseY,
+                                                                    clip.right + baseX, clip.bottom + baseY));
+    if (r.Empty()) return;
+    BLENDFUNCTION bf = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    AlphaBlend(targetDC, r.x - baseX, r.y - baseY, r.w, r.h, ctx->mosaicRevealDC, r.x, r.y, r.w, r.h, bf);
+}
+
+// ==================== 已提交标注缓存层 ====================
+// 已提交的矢量/文字标注压平到一张选区大小的预乘 alpha DIB（GDI+ 以 32bppPARGB 直接画在 DIB 位上；
+// 标注只在选区内可见，层不必覆盖整个虚拟屏幕）。标注集合变化时按修订号比对出新增 / 改动 / 删除的标注，
+// 只清空并重画它们新旧绘制范围的并集；每帧只把有内容的格子 AlphaBlend 到 backDC，再单独绘制
+// 正在拖拽/缩放的那一个标注和 curDrawing。拖拽中的标注临时画在最上层（松开后回到缓存层里原来的层次）。
+
+// 正在被拖拽/缩放的标注（每帧变化，不进缓存层），-1 表示无
+static int LiveAnnotationIndex(const CaptureContext* ctx) {
+    if (ctx->resizingAnnotation >= 0) return ctx->resizingAnnotation;
+    if (ctx->draggingAnnotation >= 0) return ctx->draggingAnnotation;
+    return ctx->draggingTextAnnotation;
+}
+
+// 缓存层状态签名：标注每次改动都会递增 annotationsVersion，再加上不进缓存层的 liveIdx
+static uint64_t AnnotationLayerKey(const CaptureContext* ctx, int liveIdx) {
+    ztools::ContentHasher h;
+    h.UpdateU64(ctx->annotationsVersion);
+    h.UpdateU32((uint32_t)liveIdx);
+    return h.Digest();
+}
+
+static void FreeAnnotationLayer(CaptureContext* ctx) {
+    ctx->annotationLayer.Detach();
+    if (ctx->annotationLayerDC) { DeleteDC(ctx->annotationLayerDC); ctx->annotationLayerDC = NULL; }
+    if (ctx->annotationLayerBitmap) { DeleteObject(ctx->annotationLayerBitmap); ctx->annotationLayerBitmap = NULL; }
+    ctx->annotationLayerRect = ztools::IntRect();
+}
+
+// 保证缓存层覆盖 area（选区，backDC 坐标）：已有的层装得下就沿用，否则重新创建（内容随后整层重画）。
+// 新层向四周各留选区 1/8 的余量（不超出虚拟屏幕），拖动 / 微调选区时不必每次都重建
+static bool PrepareAnnotationLayer(CaptureContext* ctx, const ztools::IntRect& area) {
+    if (area.Empty()) return false;
+    if (ctx->annotationLayerDC && area.Intersect(ctx->annotationLayerRect) == area) return true;
+    FreeAnnotationLayer(ctx);
+    int mx = area.w / 8, my = area.h / 8;
+    ztools::IntRect rect = ztools::IntRect::FromLTRB(area.x - mx, area.y - my, area.Right() + mx, area.Bottom() + my)
+        .Intersect(ztools::IntRect(0, 0, ctx->virtualW, ctx->virtualH)).Union(area);
+    ztools::ImageView view;
+    ctx->annotationLayerBitmap = CreateSurfaceBitmap(rect.w, rect.h, view);
+    ctx->annotationLayerDC = ctx->annotationLayerBitmap ? CreateCompatibleDC(ctx->memDC) : NULL;
+    if (!ctx->annotationLayerDC) {
+        if (ctx->annotationLayerBitmap) { DeleteObject(ctx->annotationLayerBitmap); ctx->annotationLayerBitmap = NULL; }
+        return false;
+    }
+    SelectObject(ctx->annotationLayerDC, ctx->annotationLayerBitmap);
+    ctx->annotationLayer.Attach(view);
+    ctx->annotationLayerRect = rect;
+    return true;
+}
+
+// 单个标注的包围盒（定义在下方「通用标注几何」），用于登记缓存层的绘制范围
+static RECT MeasureAnnotationBounds(Annotation& a, HDC hdc);
+
+// 标注变化时更新缓存层；返回 false 表示缓存层不可用（调用方回退为逐个直接绘制）
+static bool SyncAnnotationLayer(CaptureContext* ctx, int liveIdx, const ztools::IntRect& area) {
+    if (!PrepareAnnotationLayer(ctx, area)) return false;
+    uint64_t key = AnnotationLayerKey(ctx, liveIdx);
+    if (ctx->annotationLayer.IsValid(key)) return true;
+
+    // 新的绘制清单：修订号没变的标注沿用上次量好的范围；新增 / 改动的标注与
+    // 不再出现的旧标注（删除、撤销、被拖起）的范围并起来就是要重画的损伤区
+    std::unordered_map<uint64_t, ztools::IntRect> previous;
+    previous.reserve(ctx->annotationLayerEntries.size());
+    for (const AnnotationLayerEntry& e : ctx->annotationLayerEntries) previous.emplace(e.revision, e.bounds);
+    std::vector<AnnotationLayerEntry> entries;
+    std::vector<size_t> entryAnnotation;  // entries[k] 对应的标注下标
+    entries.reserve(ctx->annotations.size());
+    entryAnnotation.reserve(ctx->annotations.size());
+    ztools::IntRect damage;
+    for (size_t i = 0; i < ctx->annotations.size(); i++) {
+        Annotation& a = ctx->annotations[i];
+        if (a.type == AT_Mosaic || (int)i == liveIdx) continue;
+        AnnotationLayerEntry e = { a.revision, ztools::IntRect() };
+        auto it = previous.find(a.revision);
+        if (it != previous.end()) {
+            e.bounds = it->second;
+            previous.erase(it);
+        } else {
+            RECT b = MeasureAnnotationBounds(a, ctx->memDC);
+            int pad = a.type == AT_Text ? 2 : a.thickness / 2 + 3;
+            e.bounds = ztools::IntRect::FromLTRB(b.left - pad, b.top - pad, b.right + pad, b.bottom + pad)
+                .Offset(-ctx->virtualX, -ctx->virtualY);
+            damage = damage.Union(e.bounds);
+        }
+        entries.push_back(e);
+        entryAnnotation.push_back(i);
+    }
+    for (const auto& gone : previous) damage = damage.Union(gone.second);
+    ctx->annotationLayerEntries.swap(entries);
+
+    // 层刚创建（或从未建好）时整层重画，否则只重画损伤区；以下都换算到层坐标
+    const ztools::IntRect& layerRect = ctx->annotationLayerRect;
+    bool partial = ctx->annotationLayer.Built();
+    ztools::IntRect redraw = (partial ? damage.Intersect(layerRect) : layerRect).Offset(-layerRect.x, -layerRect.y);
+    if (partial && redraw.Empty()) {
+        ctx->annotationLayer.BeginUpdate(key, redraw);  // 改动都在层外（或只是马赛克）：只更新签名
+        return true;
+    }
+    GdiFlush();  // 清零 DIB 位之前确保上一帧的 AlphaBlend 已完成
+    ztools::ImageView view = ctx->annotationLayer.BeginUpdate(key, redraw);
+    {
+        Gdiplus::Bitmap bmp(view.width, view.height, view.stride, PixelFormat32bppPARGB, view.data);
+        Gdiplus::Graphics graphics(&bmp);
+        graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+        // 透明底上不能用 ClearType（子像素着色依赖底色），用灰度抗锯齿；
+        // 覆盖层直接绘制与导出合成使用同一提示，预览与成品的文字逐像素一致
+        graphics.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAlias);
+        graphics.SetClip(Gdiplus::Rect(redraw.x, redraw.y, redraw.w, redraw.h));
+        float ox = (float)(-ctx->virtualX - layerRect.x);
+        float oy = (float)(-ctx->virtualY - layerRect.y);
+        for (size_t k = 0; k < ctx->annotationLayerEntries.size(); k++) {
+            if (ctx->annotationLayerEntries[k].bounds.Offset(-layerRect.x, -layerRect.y).Intersect(redraw).Empty()) {
+                continue;
+            }
+            DrawOneAnnotation(graphics, ctx->annotations[entryAnnotation[k]], ox, oy);
+        }
+        graphics.Flush(Gdiplus::FlushIntentionSync);
+    }
+    // 只扫描重画区内各标注的绘制范围，不扫整张层
+    for (const AnnotationLayerEntry& e : ctx->annotationLayerEntries) {
+        ztools::IntRect drawn = e.bounds.Offset(-layerRect.x, -layerRect.y).Intersect(redraw);
+        if (!drawn.Empty()) ctx->annotationLayer.MarkDrawnByAlpha(drawn);
+    }
+    return true;
 }
 
 // 覆盖层渲染矢量/文字标注（不含马赛克，马赛克由 reveal-mask 单独处理）。
 // selRel：选区在 backDC 局部坐标的矩形；标注为绝对虚拟屏幕坐标，偏移 = -virtualX/-virtualY。
-// 用 SetClip 限制到选区内部，避免画到遮罩区。
-static void DrawAnnotations(HDC hdc, const RECT& selRel, int virtualX, int virtualY,
-                            const std::vector<Annotation>& annotations,
-                            const Annotation* curDrawing) {
+// 已提交标注经缓存层合成，只有正在拖拽/缩放的标注与 curDrawing 每帧用 GDI+ 绘制；
+// 两者都限制在选区 ∩ hdc 当前裁剪区（局部帧的损伤区）内，避免画到遮罩区。
+static void DrawAnnotations(HDC hdc, CaptureContext* ctx, const RECT& selRel, const Annotation* curDrawing) {
+    const std::vector<Annotation>& annotations = ctx->annotations;
+    int liveIdx = LiveAnnotationIndex(ctx);
+    if (liveIdx >= (int)annotations.size()) liveIdx = -1;
+    ztools::IntRect sel = ztools::IntRect::FromLTRB(selRel.left, selRel.top, selRel.right, selRel.bottom);
+    bool layered = SyncAnnotationLayer(ctx, liveIdx, sel);
+    if (layered) {
+        RECT clip = {0, 0, 0, 0};
+        if (GetClipBox(hdc, &clip) != NULLREGION) {
+            ztools::IntRect area = sel.Intersect(ztools::IntRect::FromLTRB(clip.left, clip.top, clip.right, clip.bottom));
+            BLENDFUNCTION bf = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+            // 层像素 (x, y) 落在 backDC 的 (x + layerRect.x, y + layerRect.y)
+            const ztools::IntRect& layerRect = ctx->annotationLayerRect;
+            ctx->annotationLayer.ForEachRun(layerRect.x, layerRect.y, area, [&](const ztools::IntRect& r) {
+                AlphaBlend(hdc, r.x, r.y, r.w, r.h, ctx->annotationLayerDC,
+                           r.x - layerRect.x, r.y - layerRect.y, r.w, r.h, bf);
+            });
+        }
+    }
+
+    const Annotation* live = liveIdx >= 0 && annotations[liveIdx].type != AT_Mosaic ? &annotations[liveIdx] : nullptr;
+    const Annotation* cur = curDrawing && curDrawing->type != AT_Mosaic ? curDrawing : nullptr;
+    if (layered && !live && !cur) return;
+
     // GDI+ 已由会话级 InitGdipResources 启动，此处直接使用（Graphics 按 hdc 新建）。
     {
         Gdiplus::Graphics graphics(hdc);
         graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+        graphics.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAlias);  // 与缓存层一致
         // 限制绘制范围在选区内
         Gdiplus::Rect clipRect(selRel.left, selRel.top,
                                selRel.right - selRel.left,
                                selRel.bottom - selRel.top);
-        // 限制绘制范围在选区内（与选区矩形求交；局部帧时还会与 backDC 裁剪区 dirtyRect 求交，
-        // 因 Graphics(backDC) 继承 GDI 裁剪区，CombineModeIntersect 保证标注不超出 dirtyRect∩选区）。
+        // 限制绘制范围在选区内（与选区矩形求交；局部帧时还会与 backDC 裁剪区（损伤区）求交，
+        // 因 Graphics(backDC) 继承 GDI 裁剪区，CombineModeIntersect 保证标注不超出损伤区∩选区）。
         graphics.SetClip(clipRect, Gdiplus::CombineModeIntersect);
 
-        float ox = (float)-virtualX;
-        float oy = (float)-virtualY;
+        float ox = (float)-ctx->virtualX;
+        float oy = (float)-ctx->virtualY;
 
-        for (const Annotation& a : annotations) {
-            if (a.type == AT_Mosaic) continue;  // 马赛克单独渲染
-            DrawOneAnnotation(graphics, a, ox, oy);
-        }
-        if (curDrawing && curDrawing->type != AT_Mosaic) {
-            DrawOneAnnotation(graphics, *curDrawing, ox, oy);
+        if (!layered) {
+            // 缓存层创建失败（内存不足等）：回退为逐个直接绘制
+            for (const Annotation& a : annotations) {
+                if (a.type == AT_Mosaic) continue;  // 马赛克单独渲染
+                DrawOneAnnotation(graphics, a, ox, oy);
+            }
+        } else if (live) {
+            DrawOneAnnotation(graphics, *live, ox, oy);
         }
+        if (cur) DrawOneAnnotation(graphics, *cur, ox, oy);
     }
 }
 
 
 // 合成标注进最终 PNG：finalDC 原点 = 选区左上角，故偏移 = -rect.left/-rect.top。
-// srcDC = memDC（原始屏幕位图，物理像素），用于马赛克像素化取源。
-// mosaicBlockPx：马赛克块大小（与编辑器当前全局块大小保持一致，保证导出与所见一致）。
-static void CompositeAnnotations(HDC finalDC, HDC srcDC,
+// 马赛克直接复用会话的 base 瓦片缓存（块大小 = 编辑器当前全局块大小、网格锚定虚拟屏幕原点），
+// 保证导出与所见逐像素一致；ctx 为空（无会话）时不渲染马赛克。
+static void CompositeAnnotations(HDC finalDC, CaptureContext* ctx,
                                  const std::vector<Annotation>& annotations,
-                                 const RECT& rect, int virtualX, int virtualY,
-                                 double dpiScale, int mosaicBlockPx) {
+                                 const RECT& rect) {
     if (annotations.empty()) return;
 
     // 马赛克先渲染到底图上，后续矢量/文字标注保持清晰覆盖在其上方。
-    bool hasMosaic = false;
-    for (const Annotation& a : annotations) {
-        if (a.type == AT_Mosaic) { hasMosaic = true; break; }
-    }
-    if (hasMosaic) {
-        int blockPx = mosaicBlockPx;
-        if (blockPx < 2) blockPx = 2;
-        int w = rect.right - rect.left;
-        int h = rect.bottom - rect.top;
-        HDC screenDC = GetDC(NULL);
-        if (screenDC) {
-            HDC baseDC = CreateCompatibleDC(screenDC);
-            HBITMAP baseBmp = CreateCompatibleBitmap(screenDC, w, h);
-            HGDIOBJ oldBase = SelectObject(baseDC, baseBmp);
-            MosaicBlitRect(baseDC, srcDC, 0, 0, w, h,
-                           rect.left, rect.top, blockPx, virtualX, virtualY, dpiScale);
-            // 揭示蒙版区域（finalDC 原点 = 选区左上角，base 同为选区相对，ox=-rect.left）
-            float ox = (float)-rect.left;
-            float oy = (float)-rect.top;
-            RevealMosaicToTarget(finalDC, baseDC, annotations, nullptr, ox, oy);
-            SelectObject(baseDC, oldBase);
-            DeleteObject(baseBmp);
-            DeleteDC(baseDC);
-            ReleaseDC(NULL, screenDC);
-        }
+    if (ctx && HasMosaicToRender(annotations, nullptr)) {
+        // finalDC 原点 = 选区左上角，对应揭示层中 (rect.left - virtualX, rect.top - virtualY)
+        SyncMosaicReveal(ctx, annotations, nullptr);
+        RevealMosaicToTarget(finalDC, ctx, rect.left - ctx->virtualX, rect.top - ctx->virtualY);
     }
 
     // GDI+ 已由会话级 InitGdipResources 启动，此处直接使用。
     {
         Gdiplus::Graphics graphics(finalDC);
         graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+        graphics.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAlias);  // 与预览的缓存层一致
         float ox = (float)-rect.left;
         float oy = (float)-rect.top;
         for (const Annotation& a : annotations) {
@@ -2642,130 +3427,499 @@ static void CompositeAnnotations(HDC finalDC, HDC srcDC,
     }
 }
 
-// 将 HBITMAP 转换为 PNG base64 字符串
-static std::string BitmapToBase64Png(HBITMAP hBitmap) {
-    // GDI+ 已由会话级 InitGdipResources 启动，此处直接使用。
-    std::string result;
-    {
-        Gdiplus::Bitmap* bmp = Gdiplus::Bitmap::FromHBITMAP(hBitmap, NULL);
-        if (bmp) {
-            CLSID pngClsid;
-            if (GetPngEncoderClsid(&pngClsid) >= 0) {
-                IStream* stream = NULL;
-                CreateStreamOnHGlobal(NULL, TRUE, &stream);
-                if (stream && bmp->Save(stream, &pngClsid, NULL) == Gdiplus::Ok) {
-                    HGLOBAL hMem = NULL;
-                    GetHGlobalFromStream(stream, &hMem);
-                    size_t len = GlobalSize(hMem);
-                    BYTE* ptr = (BYTE*)GlobalLock(hMem);
-                    if (ptr && len > 0) {
-                        result = "data:image/png;base64," + Base64Encode(ptr, len);
-                    }
-                    GlobalUnlock(hMem);
-                }
-                if (stream) stream->Release();
+// 在 DIB 像素上直接构造 GDI+ 位图供编码器读取，不经 FromHBITMAP 复制一份。
+// 32bppRGB 忽略 GDI 绘制后未定义的 alpha 字节，输出与 FromHBITMAP 相同；位图须先于 view 的内存释放
+static Gdiplus::Bitmap* WrapSurfaceForEncode(const ztools::ImageView& view) {
+    if (view.Empty()) return nullptr;
+    GdiFlush();  // 编码器直接读像素：先让 GDI 批处理落到 DIB 上
+    return new Gdiplus::Bitmap(view.width, view.height, view.stride, PixelFormat32bppRGB, view.data);
+}
+
+// 编码时自己持有一次 GDI+ Startup：导出工作线程上会话级 GDI+ 可能已随覆盖层关闭而 Shutdown
+// （GDI+ 按 Startup 次数计数，与会话级启动嵌套无妨）
+struct ScopedGdiplusStartup {
+    ULONG_PTR token = 0;
+    bool ok = false;
+    ScopedGdiplusStartup() {
+        Gdiplus::GdiplusStartupInput input;
+        ok = Gdiplus::GdiplusStartup(&token, &input, NULL) == Gdiplus::Ok;
+    }
+    ~ScopedGdiplusStartup() {
+        if (ok) Gdiplus::GdiplusShutdown(token);
+    }
+};
+
+// GDI+ 编码器（PNG / JPEG），直接读 DIB 像素编码到内存流；JPEG 按 options.quality 设置质量
+class GdiplusImageEncoder : public ztools::ImageEncoder {
+public:
+    GdiplusImageEncoder(const char* name, const wchar_t* mimeW, const char* mime, const char* ext, bool lossy)
+        : name_(name), mimeW_(mimeW), mime_(mime), ext_(ext), lossy_(lossy) {}
+
+    const char* Name() const override { return name_; }
+    const char* MimeType() const override { return mime_; }
+    const char* Extension() const override { return ext_; }
+    bool Lossy() const override { return lossy_; }
+
+    bool Encode(const ztools::ImageView& view, const ztools::EncodeOptions& options,
+                std::vector<std::uint8_t>& out) const override {
+        out.clear();
+        ScopedGdiplusStartup gdiplus;
+        if (!gdiplus.ok) return false;
+        Gdiplus::Bitmap* bmp = WrapSurfaceForEncode(view);
+        if (!bmp) return false;
+        CLSID clsid;
+        IStream* stream = NULL;
+        ULONG quality = (ULONG)(std::max)(1, (std::min)(100, options.quality));
+        Gdiplus::EncoderParameters params;
+        params.Count = 1;
+        params.Parameter[0].Guid = Gdiplus::EncoderQuality;
+        params.Parameter[0].Type = Gdiplus::EncoderParameterValueTypeLong;
+        params.Parameter[0].NumberOfValues = 1;
+        params.Parameter[0].Value = &quality;
+        if (GetEncoderClsid(mimeW_, &clsid) >= 0 && SUCCEEDED(CreateStreamOnHGlobal(NULL, TRUE, &stream)) &&
+            bmp->Save(stream, &clsid, lossy_ ? &params : NULL) == Gdiplus::Ok) {
+            // 流按块增长，HGLOBAL 可能比实际写入的长：以流的当前位置为准
+            LARGE_INTEGER zero = {};
+            ULARGE_INTEGER end = {};
+            HGLOBAL hMem = NULL;
+            if (SUCCEEDED(stream->Seek(zero, STREAM_SEEK_CUR, &end)) && SUCCEEDED(GetHGlobalFromStream(stream, &hMem))) {
+                const BYTE* ptr = (const BYTE*)GlobalLock(hMem);
+                if (ptr && end.QuadPart > 0) out.assign(ptr, ptr + (size_t)end.QuadPart);
+                GlobalUnlock(hMem);
             }
-            delete bmp;
         }
+        if (stream) stream->Release();
+        delete bmp;
+        return !out.empty();
     }
-    return result;
+
+private:
+    const char* name_;
+    const wchar_t* mimeW_;
+    const char* mime_;
+    const char* ext_;
+    bool lossy_;
+};
+
+// 截图可用的输出格式：png、jpeg（GDI+），qoi、raw（core 内置）。WIC / GDI+ 没有 WebP 编码器，有损输出用 JPEG
+static const ztools::EncoderRegistry& ScreenshotEncoders() {
+    static const ztools::EncoderRegistry* registry = [] {
+        ztools::EncoderRegistry* r = new ztools::EncoderRegistry();
+        r->Register(std::unique_ptr<ztools::ImageEncoder>(
+            new GdiplusImageEncoder("png", L"image/png", "image/png", "png", false)));
+        r->Register(std::unique_ptr<ztools::ImageEncoder>(
+            new GdiplusImageEncoder("jpeg", L"image/jpeg", "image/jpeg", "jpg", true)));
+        ztools::RegisterBuiltinEncoders(*r);
+        return r;
+    }();
+    return *registry;
 }
 
-// 保存位图到剪贴板
-static bool SaveBitmapToClipboard(HBITMAP hBitmap) {
-    if (!OpenClipboard(NULL)) return false;
-    EmptyClipboard();
-    BITMAP bm;
-    GetObject(hBitmap, sizeof(BITMAP), &bm);
-    HBITMAP hCopy = (HBITMAP)CopyImage(hBitmap, IMAGE_BITMAP, bm.bmWidth, bm.bmHeight, LR_COPYRETURNORG);
-    SetClipboardData(CF_BITMAP, hCopy);
-    CloseClipboard();
-    return true;
+static bool IsPngEncoder(const ztools::ImageEncoder* encoder) {
+    return encoder && std::strcmp(encoder->Name(), "png") == 0;
 }
 
-// 从预截屏位图提取区域，生成 base64 并复制到剪贴板。
-// anns：可选的标注列表，会合成进最终 PNG（选区相对坐标，finalDC 原点 = 选区原点）。
-static ScreenshotResult* ExtractRegionResult(HDC memDC, const RECT& rect,
-    int vx, int vy, double dpiScale, const std::vector<Annotation>& anns) {
-    ScreenshotResult* result = new ScreenshotResult();
-    result->success = false;
+// 浏览器可直接显示的格式以 data URL 交给 JS（与以往的 base64 字段兼容），其余格式以 Buffer 交出
+static bool DeliversDataUrl(const ztools::ImageEncoder* encoder) {
+    return IsPngEncoder(encoder) || std::strcmp(encoder->Name(), "jpeg") == 0;
+}
+
+// 从物理截屏位图取出选区，按逻辑尺寸生成 32bpp DIB 并合成标注；outDC 已选入 outBmp，由调用方释放，
+// outView 指向 outBmp 的像素。DPI 缩小由 core/raster 的面积平均完成（与原 HALFTONE StretchBlt 等价，细线不丢）。
+// 截屏位图是 DIB section 时直接从其像素复制 / 缩放，不再先 BitBlt 出一份物理尺寸的选区副本。
+static bool RenderRegionBitmap(HDC memDC, const RECT& rect, int vx, int vy, double dpiScale,
+                               const std::vector<Annotation>& anns, HDC& outDC, HBITMAP& outBmp,
+                               ztools::ImageView& outView) {
+    outDC = NULL;
+    outBmp = NULL;
+    outView = ztools::ImageView();
     int width = rect.right - rect.left;
     int height = rect.bottom - rect.top;
-    result->x = rect.left;
-    result->y = rect.top;
-    result->x2 = rect.right;
-    result->y2 = rect.bottom;
-    result->width = width;
-    result->height = height;
-
-    if (width <= 0 || height <= 0) return result;
+    if (width <= 0 || height <= 0) return false;
+
+    ztools::IntRect logical(rect.left - vx, rect.top - vy, width, height);
+    ztools::IntRect physical = ztools::IsUnitScale(dpiScale) ? logical : ztools::ScaleRect(logical, dpiScale);
+
+    ztools::ImageView screenView;
+    HBITMAP physBmp = NULL;
+    ztools::ImageView physView;
+    if (SurfaceViewOf((HBITMAP)GetCurrentObject(memDC, OBJ_BITMAP), screenView) &&
+        screenView.Bounds().Intersect(physical) == physical) {
+        GdiFlush();
+        physView = screenView.Sub(physical);
+    } else {
+        physBmp = ReadDCToSurfaceBitmap(memDC, physical.x, physical.y, physical.w, physical.h, physView);
+        if (!physBmp) return false;
+    }
 
-    // 从物理尺寸位图提取区域
-    int lx = rect.left - vx;
-    int ly = rect.top - vy;
-    int px = (int)(lx * dpiScale + 0.5);
-    int py = (int)(ly * dpiScale + 0.5);
-    int pw = (int)(width * dpiScale + 0.5);
-    int ph = (int)(height * dpiScale + 0.5);
+    ztools::ImageView finalView;
+    HBITMAP finalBmp = NULL;
+    if (physBmp && physical.w == width && physical.h == height) {
+        finalBmp = physBmp;  // 选区副本已是最终尺寸
+        finalView = physView;
+    } else {
+        finalBmp = CreateSurfaceBitmap(width, height, finalView);
+        if (finalBmp) {
+            if (physical.w == width && physical.h == height) {
+                ztools::Copy(physView, 0, 0, finalView, finalView.Bounds());
+            } else {
+                ztools::Scale(physView, physView.Bounds(), finalView, finalView.Bounds(), ztools::ScaleFilter::Box);
+            }
+        }
+        if (physBmp) DeleteObject(physBmp);
+        if (!finalBmp) return false;
+    }
 
-    HDC screenDC = GetDC(NULL);
-    HDC regionDC = CreateCompatibleDC(screenDC);
-    HBITMAP regionBmp = CreateCompatibleBitmap(screenDC, pw, ph);
-    SelectObject(regionDC, regionBmp);
-    BitBlt(regionDC, 0, 0, pw, ph, memDC, px, py, SRCCOPY);
-
-    // 如果有 DPI 缩放，缩放回逻辑尺寸
-    HBITMAP finalBmp = regionBmp;
-    HDC finalDC = regionDC;
-    if (dpiScale > 1.01 || dpiScale < 0.99) {
-        HDC scaledDC = CreateCompatibleDC(screenDC);
-        HBITMAP scaledBmp = CreateCompatibleBitmap(screenDC, width, height);
-        SelectObject(scaledDC, scaledBmp);
-        SetStretchBltMode(scaledDC, HALFTONE);
-        SetBrushOrgEx(scaledDC, 0, 0, NULL);
-        StretchBlt(scaledDC, 0, 0, width, height, regionDC, 0, 0, pw, ph, SRCCOPY);
-        DeleteDC(regionDC);
-        DeleteObject(regionBmp);
-        finalBmp = scaledBmp;
-        finalDC = scaledDC;
+    HDC finalDC = CreateCompatibleDC(memDC);
+    if (!finalDC) {
+        DeleteObject(finalBmp);
+        return false;
     }
+    SelectObject(finalDC, finalBmp);
 
     // 合成标注进最终图像（finalDC 原点 = 选区原点，标注为绝对坐标，偏移 = -rect.left/top）
-    CompositeAnnotations(finalDC, memDC, anns, rect, vx, vy, dpiScale,
-                         SC_MOSAIC_SIZES[g_captureCtx ? g_captureCtx->mosaicSizeIdx : SC_DEFAULT_MOSAIC_IDX]);
+    CompositeAnnotations(finalDC, g_captureCtx, anns, rect);
+    outDC = finalDC;
+    outBmp = finalBmp;
+    outView = finalView;
+    return true;
+}
 
-    // 生成 base64
-    result->base64 = BitmapToBase64Png(finalBmp);
-    // 复制到剪贴板
-    result->success = SaveBitmapToClipboard(finalBmp);
+// ==== 剪贴板延迟渲染 ====
+// 发布截图时只声明 CF_DIBV5 与注册格式 "PNG"（SetClipboardData(format, NULL)），有程序真正粘贴时
+// 才在 WM_RENDERFORMAT 里生成：CF_DIBV5 由 core/clipboard_image 从成品像素一次复制进 HGLOBAL，
+// PNG 复用导出时编码好的字节；CF_DIB / CF_BITMAP 由系统按需从 CF_DIBV5 合成，不再 CopyImage 复制位图。
+// 剪贴板所有者是专用线程上的消息窗口：别的程序接管剪贴板（WM_DESTROYCLIPBOARD）时释放像素，
+// 插件卸载前（env cleanup hook）渲染全部格式，截图在本进程退出后仍可粘贴。
 
-    DeleteDC(finalDC);
-    DeleteObject(finalBmp);
-    ReleaseDC(NULL, screenDC);
+static const UINT WM_SC_OFFER_CLIPBOARD = WM_APP + 1;  // lParam = std::shared_ptr<ClipboardImageOffer>*
+static const UINT WM_SC_FLUSH_CLIPBOARD = WM_APP + 2;
+static const DWORD SC_CLIPBOARD_PNG_WAIT_MS = 5000;    // 粘贴 PNG 时编码尚未完成：最多等这么久
+static const int SC_CLIPBOARD_OPEN_RETRIES = 10;       // 剪贴板被其他进程占用时的重试次数（间隔 20ms）
 
-    return result;
+// 成品位图的共享所有权：导出流水线与剪贴板延迟渲染谁最后用完谁释放
+struct SurfaceBitmapHolder {
+    HBITMAP bitmap = NULL;
+    ztools::ImageView view;
+    SurfaceBitmapHolder(HBITMAP bmp, const ztools::ImageView& v) : bitmap(bmp), view(v) {}
+    ~SurfaceBitmapHolder() {
+        if (bitmap) DeleteObject(bitmap);
+    }
+};
+
+// 一次截图的剪贴板内容：像素立即可用，PNG 字节在导出编码完成后补上
+struct ClipboardImageOffer {
+    std::shared_ptr<SurfaceBitmapHolder> pixels;
+    bool hasPng = true;  // 输出格式为 PNG 时才声明 PNG 格式（复用导出的编码结果），否则只有 CF_DIBV5
+    std::mutex mutex;
+    std::condition_variable pngCv;
+    bool pngDone = false;  // 编码已结束（成功或失败）
+    std::vector<BYTE> png;
+
+    void SetPng(std::vector<BYTE> bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            png = std::move(bytes);
+            pngDone = true;
+        }
+        pngCv.notify_all();
+    }
+};
+
+static HWND g_clipboardOwnerWindow = NULL;
+static std::shared_ptr<ClipboardImageOffer> g_clipboardOffer;  // 仅在所有者线程上访问
+
+static UINT PngClipboardFormat() {
+    static const UINT format = RegisterClipboardFormatA(ztools::kPngClipboardFormatName);
+    return format;
+}
+
+static HGLOBAL RenderDibV5Global(const ztools::ImageView& view) {
+    const size_t size = ztools::DibV5ByteSize(view.width, view.height);
+    if (size == 0) return NULL;
+    HGLOBAL h = GlobalAlloc(GMEM_MOVEABLE, size);
+    if (!h) return NULL;
+    void* dst = GlobalLock(h);
+    bool ok = dst && ztools::WriteDibV5(view, ztools::DibAlpha::Opaque, (std::uint8_t*)dst, size);
+    GlobalUnlock(h);
+    if (!ok) {
+        GlobalFree(h);
+        return NULL;
+    }
+    return h;
+}
+
+static HGLOBAL RenderPngGlobal(ClipboardImageOffer& offer) {
+    std::unique_lock<std::mutex> lock(offer.mutex);
+    offer.pngCv.wait_for(lock, std::chrono::milliseconds(SC_CLIPBOARD_PNG_WAIT_MS), [&] { return offer.pngDone; });
+    if (offer.png.empty()) return NULL;
+    HGLOBAL h = GlobalAlloc(GMEM_MOVEABLE, offer.png.size());
+    if (!h) return NULL;
+    void* dst = GlobalLock(h);
+    if (dst) memcpy(dst, offer.png.data(), offer.png.size());
+    GlobalUnlock(h);
+    if (!dst) {
+        GlobalFree(h);
+        return NULL;
+    }
+    return h;
+}
+
+// WM_RENDERFORMAT / WM_RENDERALLFORMATS 内调用（剪贴板已由系统或调用方打开）
+static void RenderClipboardFormat(UINT format) {
+    if (!g_clipboardOffer || !g_clipboardOffer->pixels) return;
+    HGLOBAL h = NULL;
+    if (format == CF_DIBV5) {
+        h = RenderDibV5Global(g_clipboardOffer->pixels->view);
+    } else if (format == PngClipboardFormat()) {
+        h = RenderPngGlobal(*g_clipboardOffer);
+    }
+    if (h && !SetClipboardData(format, h)) GlobalFree(h);
+}
+
+static void RenderAllClipboardFormats(HWND hwnd) {
+    if (!g_clipboardOffer) return;
+    if (OpenClipboard(hwnd)) {
+        if (GetClipboardOwner() == hwnd) {
+            RenderClipboardFormat(CF_DIBV5);
+            if (g_clipboardOffer->hasPng) RenderClipboardFormat(PngClipboardFormat());
+        }
+        CloseClipboard();
+    }
+    g_clipboardOffer.reset();
+}
+
+static bool OfferClipboardImage(HWND hwnd, const std::shared_ptr<ClipboardImageOffer>& offer) {
+    bool opened = false;
+    for (int i = 0; i < SC_CLIPBOARD_OPEN_RETRIES && !(opened = OpenClipboard(hwnd) != FALSE); i++) Sleep(20);
+    if (!opened) return false;
+    EmptyClipboard();  // 上一次截图仍在剪贴板上时，会先同步收到 WM_DESTROYCLIPBOARD
+    g_clipboardOffer = offer;
+    SetClipboardData(CF_DIBV5, NULL);
+    if (offer->hasPng) SetClipboardData(PngClipboardFormat(), NULL);
+    CloseClipboard();
+    return true;
+}
+
+static LRESULT CALLBACK ClipboardOwnerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    switch (msg) {
+    case WM_SC_OFFER_CLIPBOARD:
+        return OfferClipboardImage(hwnd, *reinterpret_cast<std::shared_ptr<ClipboardImageOffer>*>(lParam)) ? 1 : 0;
+    case WM_RENDERFORMAT:
+        RenderClipboardFormat((UINT)wParam);
+        return 0;
+    case WM_RENDERALLFORMATS:
+    case WM_SC_FLUSH_CLIPBOARD:
+        RenderAllClipboardFormats(hwnd);
+        return 0;
+    case WM_DESTROYCLIPBOARD:
+        g_clipboardOffer.reset();
+        return 0;
+    }
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+static void ClipboardOwnerThread(HANDLE ready) {
+    WNDCLASSEXW wc = {};
+    wc.cbSize = sizeof(wc);
+    wc.lpfnWndProc = ClipboardOwnerWndProc;
+    wc.hInstance = GetModuleHandle(NULL);
+    wc.lpszClassName = L"ZToolsClipboardOwner";
+    RegisterClassExW(&wc);
+    g_clipboardOwnerWindow = CreateWindowExW(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL,
+                                             wc.hInstance, NULL);
+    SetEvent(ready);
+    if (!g_clipboardOwnerWindow) return;
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+}
+
+// 剪贴板所有者窗口（首次发布时创建，进程内常驻）
+static HWND ClipboardOwnerWindow() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        HANDLE ready = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (!ready) return;
+        std::thread(ClipboardOwnerThread, ready).detach();
+        WaitForSingleObject(ready, 5000);
+        CloseHandle(ready);
+    });
+    return g_clipboardOwnerWindow;
+}
+
+// 在导出工作线程上调用：把截图声明到剪贴板（数据延迟生成）
+static bool PublishClipboardImage(std::shared_ptr<ClipboardImageOffer> offer) {
+    HWND owner = ClipboardOwnerWindow();
+    if (!owner) return false;
+    return SendMessageW(owner, WM_SC_OFFER_CLIPBOARD, 0, reinterpret_cast<LPARAM>(&offer)) != 0;
+}
+
+// 插件卸载前把仍在剪贴板上的截图渲染成真实数据（进程退出后延迟渲染的格式会丢失）
+static void FlushClipboardOwner(void*) {
+    if (g_clipboardOwnerWindow) {
+        SendMessageTimeoutW(g_clipboardOwnerWindow, WM_SC_FLUSH_CLIPBOARD, 0, 0, SMTO_BLOCK,
+                            SC_CLIPBOARD_PNG_WAIT_MS + 1000, NULL);
+    }
+}
+
+// ==== 后台导出 ====
+// 确认截图时覆盖层线程只渲染成品位图（裁剪 / 缩放 / 合成标注），立即回报尺寸并关闭窗口；
+// 按输出格式编码与写剪贴板由 core/export_pipeline 在常驻工作线程上并行完成，再以第二个事件交出编码结果。
+
+// 进程级导出流水线；与持久帧一样进程退出时不析构（不在加载器锁内等待工作线程）
+static ztools::ExportPipeline& ExportPipelineInstance() {
+    static ztools::ExportPipeline* pipeline = new ztools::ExportPipeline(2);
+    return *pipeline;
+}
+
+static double ToMs(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static void SubmitScreenshotExport(napi_threadsafe_function tsfn, std::uint64_t exportId,
+                                   std::chrono::steady_clock::time_point confirmedAt,
+                                   HBITMAP finalBmp, const ztools::ImageView& finalView);
+
+// 确认截图：回报选区与尺寸（渲染失败时 success = false），成品位图交给导出流水线，由其释放。
+// 尺寸事件先于提交入队，编码事件必然排在它之后。
+static void ConfirmRegionCapture(CaptureContext* ctx) {
+    const auto confirmedAt = std::chrono::steady_clock::now();
+    const napi_threadsafe_function tsfn = g_screenshotTsfn;
+    const RECT& rect = ctx->selection;
+
+    ScreenshotResult* result = new ScreenshotResult();
+    result->success = false;
+    result->x = rect.left;
+    result->y = rect.top;
+    result->x2 = rect.right;
+    result->y2 = rect.bottom;
+    result->width = rect.right - rect.left;
+    result->height = rect.bottom - rect.top;
+
+    HDC finalDC = NULL;
+    HBITMAP finalBmp = NULL;
+    ztools::ImageView finalView;
+    if (RenderRegionBitmap(ctx->memDC, rect, ctx->virtualX, ctx->virtualY, ctx->dpiScale, ctx->annotations,
+                           finalDC, finalBmp, finalView)) {
+        GdiFlush();  // 本线程的 GDI 批处理落到 DIB 上，工作线程才能直接读像素
+        DeleteDC(finalDC);
+        result->success = true;
+        result->previewReady = true;
+        result->exportId = g_nextExportId++;
+    }
+    const std::uint64_t exportId = result->exportId;
+    if (tsfn != nullptr) {
+        napi_call_threadsafe_function(tsfn, result, napi_tsfn_nonblocking);
+    } else {
+        delete result;
+    }
+    if (!finalBmp) return;
+    SubmitScreenshotExport(tsfn, exportId, confirmedAt, finalBmp, finalView);
+}
+
+// 成品位图按本次输出格式编码并写入剪贴板（导出流水线上并行），完成后以同一 exportId 的编码事件交给 JS；
+// 位图所有权转交流水线（与剪贴板延迟渲染共享）
+static void SubmitScreenshotExport(napi_threadsafe_function tsfn, std::uint64_t exportId,
+                                   std::chrono::steady_clock::time_point confirmedAt,
+                                   HBITMAP finalBmp, const ztools::ImageView& finalView) {
+    // 剪贴板延迟渲染可能比导出任务活得久：位图由二者共享
+    auto pixels = std::make_shared<SurfaceBitmapHolder>(finalBmp, finalView);
+    auto offer = std::make_shared<ClipboardImageOffer>();
+    offer->pixels = pixels;
+    const ScreenshotOutput output = g_screenshotOutput;
+    offer->hasPng = IsPngEncoder(output.encoder);
+
+    ztools::ExportJob job;
+    job.image = finalView;
+    job.confirmedAt = confirmedAt;
+    job.encode = [offer, output](const ztools::ImageView& view, std::string& out) {
+        std::vector<std::uint8_t> bytes;
+        bool ok = output.encoder->Encode(view, output.options, bytes);
+        if (ok && DeliversDataUrl(output.encoder)) {
+            out = std::string("data:") + output.encoder->MimeType() + ";base64," + Base64Encode(bytes.data(), bytes.size());
+        } else if (ok) {
+            out.assign(bytes.begin(), bytes.end());
+        }
+        // 失败时为空：粘贴 PNG 的程序拿不到数据，改用 CF_DIBV5
+        if (offer->hasPng) offer->SetPng(ok ? std::move(bytes) : std::vector<std::uint8_t>());
+        return ok;
+    };
+    job.publish = [offer](const ztools::ImageView&) { return PublishClipboardImage(offer); };
+    job.deliver = [tsfn, exportId, output](ztools::ExportResult&& r) {
+        if (tsfn == nullptr) return;
+        ScreenshotResult* payload = new ScreenshotResult();
+        payload->success = r.encoded;
+        payload->x = payload->y = payload->x2 = payload->y2 = 0;
+        payload->width = r.width;
+        payload->height = r.height;
+        payload->base64 = std::move(r.payload);
+        payload->format = output.encoder->Name();
+        payload->mimeType = output.encoder->MimeType();
+        payload->binary = !DeliversDataUrl(output.encoder);
+        payload->exportId = exportId;
+        payload->isPayload = true;
+        payload->clipboard = r.published;
+        payload->submittedMs = ToMs(r.timings.submitted);
+        payload->encodedMs = ToMs(r.timings.encoded);
+        payload->deliveredMs = ToMs(r.timings.delivered);
+        napi_call_threadsafe_function(tsfn, payload, napi_tsfn_nonblocking);
+    };
+    job.release = [pixels]() mutable { pixels.reset(); };
+    ExportPipelineInstance().Submit(std::move(job));
 }
 
 // ---- 窗口过程和线程 ----
 
-// 生成默认保存文件名：Screenshot_YYYYMMDD_HHMMSS.png
-static std::wstring MakeDefaultScreenshotName() {
+// 保存对话框提供的文件格式，顺序与 lpstrFilter 一致（raw 没有文件头，不提供保存）
+struct SaveFileFormat {
+    const char* format;
+    const wchar_t* ext;
+};
+static const SaveFileFormat kSaveFileFormats[] = {
+    {"png", L"png"},
+    {"jpeg", L"jpg"},
+    {"qoi", L"qoi"},
+};
+
+// 生成默认保存文件名：Screenshot_YYYYMMDD_HHMMSS.<ext>
+static std::wstring MakeDefaultScreenshotName(const wchar_t* ext) {
     time_t now = time(NULL);
     struct tm lt;
     localtime_s(&lt, &now);
     wchar_t buf[64];
-    wsprintfW(buf, L"Screenshot_%04d%02d%02d_%02d%02d%02d.png",
+    wsprintfW(buf, L"Screenshot_%04d%02d%02d_%02d%02d%02d.%s",
               lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday,
-              lt.tm_hour, lt.tm_min, lt.tm_sec);
+              lt.tm_hour, lt.tm_min, lt.tm_sec, ext);
     return std::wstring(buf);
 }
 
-// 弹出系统保存对话框，返回用户选择的文件完整路径（含 .png 后缀）；
+// 按保存路径的扩展名选择编码器（.png / .jpg / .jpeg / .qoi），无法识别时返回 nullptr
+static const ztools::ImageEncoder* EncoderForPath(const std::wstring& path) {
+    size_t dot = path.find_last_of(L'.');
+    if (dot == std::wstring::npos || path.find_first_of(L"\\/", dot) != std::wstring::npos) return nullptr;
+    std::string ext;
+    for (size_t i = dot + 1; i < path.size(); i++) {
+        if (path[i] > 0x7F) return nullptr;
+        ext.push_back((char)path[i]);
+    }
+    const ztools::ImageEncoder* encoder = ScreenshotEncoders().Find(ext);  // "jpg" 视同 "jpeg"
+    for (const SaveFileFormat& f : kSaveFileFormats) {
+        if (encoder && std::strcmp(encoder->Name(), f.format) == 0) return encoder;
+    }
+    return nullptr;
+}
+
+// 弹出系统保存对话框，返回用户选择的文件完整路径；
 // 用户取消或失败时返回空字符串。
 // hwndOwner：父窗口句柄（截图覆盖层），用于模态居中。
+// encoder：传入时为默认格式（本次截图的输出格式，不可保存时退回 PNG），返回用户最终选择的格式——
+//          以文件扩展名为准，扩展名无法识别时按对话框里选中的类型。
 // 注意：覆盖层是 WS_EX_TOPMOST 全屏窗口，通用对话框可能被遮挡。
 //       弹出前临时移除其 TOPMOST（让对话框自然置顶），关闭后恢复，保证对话框可见可交互。
-static std::wstring PromptSaveFilePath(HWND hwndOwner) {
+static std::wstring PromptSaveFilePath(HWND hwndOwner, const ztools::ImageEncoder*& encoder) {
     // 默认目录：图片库（FOLDERID_Pictures），获取失败则退化为桌面
     wchar_t* defaultDir = nullptr;
     HRESULT hr = SHGetKnownFolderPath(FOLDERID_Pictures, 0, NULL, &defaultDir);
@@ -2781,7 +3935,11 @@ static std::wstring PromptSaveFilePath(HWND hwndOwner) {
         }
     }
 
-    std::wstring defaultName = MakeDefaultScreenshotName();
+    DWORD filterIndex = 1;
+    for (DWORD i = 0; i < ARRAYSIZE(kSaveFileFormats); i++) {
+        if (encoder && std::strcmp(encoder->Name(), kSaveFileFormats[i].format) == 0) filterIndex = i + 1;
+    }
+    std::wstring defaultName = MakeDefaultScreenshotName(kSaveFileFormats[filterIndex - 1].ext);
 
     wchar_t fileBuf[MAX_PATH] = {0};
     wcsncpy_s(fileBuf, MAX_PATH, defaultName.c_str(), _TRUNCATE);
@@ -2797,9 +3955,9 @@ static std::wstring PromptSaveFilePath(HWND hwndOwner) {
     ofn.hwndOwner = hwndOwner;
     ofn.lpstrFile = fileBuf;
     ofn.nMaxFile = MAX_PATH;
-    ofn.lpstrFilter = L"PNG 图像 (*.png)\0*.png\0";
-    ofn.nFilterIndex = 1;
-    ofn.lpstrDefExt = L"png";  // 用户未输扩展名时自动补 .png
+    ofn.lpstrFilter = L"PNG 图像 (*.png)\0*.png\0JPEG 图像 (*.jpg)\0*.jpg;*.jpeg\0QOI 图像 (*.qoi)\0*.qoi\0";
+    ofn.nFilterIndex = filterIndex;
+    ofn.lpstrDefExt = kSaveFileFormats[filterIndex - 1].ext;  // 用户未输扩展名时按选中的类型补全
     if (!initDir.empty()) {
         ofn.lpstrInitialDir = initDir.c_str();
     }
@@ -2815,75 +3973,99 @@ static std::wstring PromptSaveFilePath(HWND hwndOwner) {
     }
 
     if (ok) {
-        return std::wstring(fileBuf);
+        std::wstring path(fileBuf);
+        encoder = EncoderForPath(path);
+        if (!encoder) {
+            DWORD chosen = (std::max)((DWORD)1, (std::min)(ofn.nFilterIndex, (DWORD)ARRAYSIZE(kSaveFileFormats)));
+            encoder = ScreenshotEncoders().Find(kSaveFileFormats[chosen - 1].format);
+        }
+        return path;
     }
     return std::wstring();
 }
 
-// 将已合成标注的选区 HBITMAP 保存为 PNG 文件。
+// 将已合成标注的选区按 encoder 的格式保存到文件（JPEG 质量取本次截图的输出选项）。
 // 返回 true 表示保存成功。
-static bool SaveRegionToPngFile(HDC memDC, const RECT& rect, int vx, int vy,
-                                double dpiScale, const std::vector<Annotation>& anns,
-                                const std::wstring& filePath) {
+static bool SaveRegionToFile(HDC memDC, const RECT& rect, int vx, int vy,
+                             double dpiScale, const std::vector<Annotation>& anns,
+                             const ztools::ImageEncoder* encoder, const std::wstring& filePath) {
     int width = rect.right - rect.left;
     int height = rect.bottom - rect.top;
-    if (width <= 0 || height <= 0 || filePath.empty()) return false;
+    if (width <= 0 || height <= 0 || filePath.empty() || !encoder) return false;
 
-    // 复用 ExtractRegionResult 的合成逻辑生成 finalBmp（含标注、按逻辑尺寸）
-    int lx = rect.left - vx;
-    int ly = rect.top - vy;
-    int px = (int)(lx * dpiScale + 0.5);
-    int py = (int)(ly * dpiScale + 0.5);
-    int pw = (int)(width * dpiScale + 0.5);
-    int ph = (int)(height * dpiScale + 0.5);
-
-    HDC screenDC = GetDC(NULL);
-    HDC regionDC = CreateCompatibleDC(screenDC);
-    HBITMAP regionBmp = CreateCompatibleBitmap(screenDC, pw, ph);
-    SelectObject(regionDC, regionBmp);
-    BitBlt(regionDC, 0, 0, pw, ph, memDC, px, py, SRCCOPY);
-
-    HBITMAP finalBmp = regionBmp;
-    HDC finalDC = regionDC;
-    if (dpiScale > 1.01 || dpiScale < 0.99) {
-        HDC scaledDC = CreateCompatibleDC(screenDC);
-        HBITMAP scaledBmp = CreateCompatibleBitmap(screenDC, width, height);
-        SelectObject(scaledDC, scaledBmp);
-        SetStretchBltMode(scaledDC, HALFTONE);
-        SetBrushOrgEx(scaledDC, 0, 0, NULL);
-        StretchBlt(scaledDC, 0, 0, width, height, regionDC, 0, 0, pw, ph, SRCCOPY);
-        DeleteDC(regionDC);
-        DeleteObject(regionBmp);
-        finalBmp = scaledBmp;
-        finalDC = scaledDC;
-    }
-    CompositeAnnotations(finalDC, memDC, anns, rect, vx, vy, dpiScale,
-                         SC_MOSAIC_SIZES[g_captureCtx ? g_captureCtx->mosaicSizeIdx : SC_DEFAULT_MOSAIC_IDX]);
-
-    // 用 GDI+ 保存为 PNG 文件（GDI+ 已由会话级 InitGdipResources 启动）
-    bool ok = false;
-    {
-        Gdiplus::Bitmap* bmp = Gdiplus::Bitmap::FromHBITMAP(finalBmp, NULL);
-        if (bmp) {
-            CLSID pngClsid;
-            if (GetPngEncoderClsid(&pngClsid) >= 0) {
-                ok = (bmp->Save(filePath.c_str(), &pngClsid, NULL) == Gdiplus::Ok);
-            }
-            delete bmp;
-        }
-    }
+    // 与确认截图共用选区渲染（含标注、按逻辑尺寸）
+    HDC finalDC = NULL;
+    HBITMAP finalBmp = NULL;
+    ztools::ImageView finalView;
+    if (!RenderRegionBitmap(memDC, rect, vx, vy, dpiScale, anns, finalDC, finalBmp, finalView)) return false;
 
+    // 编码器直接读 DIB 像素，编码结果一次写入文件
+    std::vector<std::uint8_t> bytes;
+    bool ok = encoder->Encode(finalView, g_screenshotOutput.options, bytes);
     DeleteDC(finalDC);
     DeleteObject(finalBmp);
-    ReleaseDC(NULL, screenDC);
+    if (!ok) return false;
+
+    HANDLE file = CreateFileW(filePath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    ok = WriteFile(file, bytes.data(), (DWORD)bytes.size(), &written, NULL) && written == bytes.size();
+    CloseHandle(file);
+    if (!ok) DeleteFileW(filePath.c_str());
     return ok;
 }
 
-// 在主线程调用 JS 回调（截图完成）
+// 编码事件：{ type: 'encoded', exportId, success, format, mimeType, base64 | data, clipboard, width, height,
+//            submittedMs, encodedMs, deliveredMs }；PNG / JPEG 为 base64（data URL），其余格式为 data（Buffer）
+static napi_value CreateScreenshotPayloadObject(napi_env env, const ScreenshotResult* result) {
+    napi_value obj, value;
+    napi_create_object(env, &obj);
+    napi_create_string_utf8(env, "encoded", NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, obj, "type", value);
+    napi_create_double(env, (double)result->exportId, &value);
+    napi_set_named_property(env, obj, "exportId", value);
+    napi_get_boolean(env, result->success, &value);
+    napi_set_named_property(env, obj, "success", value);
+    napi_create_string_utf8(env, result->format, NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, obj, "format", value);
+    napi_create_string_utf8(env, result->mimeType, NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, obj, "mimeType", value);
+    if (result->binary) {
+        napi_create_buffer_copy(env, result->base64.size(), result->base64.data(), nullptr, &value);
+        napi_set_named_property(env, obj, "data", value);
+    } else {
+        napi_create_string_utf8(env, result->base64.c_str(), result->base64.size(), &value);
+        napi_set_named_property(env, obj, "base64", value);
+    }
+    napi_get_boolean(env, result->clipboard, &value);
+    napi_set_named_property(env, obj, "clipboard", value);
+    napi_create_int32(env, result->width, &value);
+    napi_set_named_property(env, obj, "width", value);
+    napi_create_int32(env, result->height, &value);
+    napi_set_named_property(env, obj, "height", value);
+    napi_create_double(env, result->submittedMs, &value);
+    napi_set_named_property(env, obj, "submittedMs", value);
+    napi_create_double(env, result->encodedMs, &value);
+    napi_set_named_property(env, obj, "encodedMs", value);
+    napi_create_double(env, result->deliveredMs, &value);
+    napi_set_named_property(env, obj, "deliveredMs", value);
+    return obj;
+}
+
+// 在主线程调用 JS 回调（截图完成 / 编码完成）
 static void CallScreenshotJs(napi_env env, napi_value js_callback, void* context, void* data) {
     if (env != nullptr && js_callback != nullptr && data != nullptr) {
         ScreenshotResult* result = static_cast<ScreenshotResult*>(data);
 
+        if (result->isPayload) {
+            napi_value payloadObj = CreateScreenshotPayloadObject(env, result);
+            napi_value global;
+            napi_get_global(env, &global);
+            napi_call_function(env, global, js_callback, 1, &payloadObj, nullptr);
+            delete result;
+            return;
+        }
+
         napi_value resultObj;
         napi_create_object(env, &resultObj);
 
@@ -2892,7 +4074,7 @@ static void CallScreenshotJs(napi_env env, napi_value js_callback, void* context
         napi_set_named_property(env, resultObj, "success", success);
 
         if (result->success) {
-            napi_value x, y, x2, y2, width, height, base64;
+            napi_value x, y, x2, y2, width, height, exportId, previewReady;
             napi_create_int32(env, result->x, &x);
             napi_set_named_property(env, resultObj, "x", x);
             napi_create_int32(env, result->y, &y);
@@ -2905,8 +4087,10 @@ static void CallScreenshotJs(napi_env env, napi_value js_callback, void* context
             napi_set_named_property(env, resultObj, "width", width);
             napi_create_int32(env, result->height, &height);
             napi_set_named_property(env, resultObj, "height", height);
-            napi_create_string_utf8(env, result->base64.c_str(), result->base64.size(), &base64);
-            napi_set_named_property(env, resultObj, "base64", base64);
+            napi_create_double(env, (double)result->exportId, &exportId);
+            napi_set_named_property(env, resultObj, "exportId", exportId);
+            napi_get_boolean(env, result->previewReady, &previewReady);
+            napi_set_named_property(env, resultObj, "previewReady", previewReady);
         }
 
         napi_value global;
@@ -3098,25 +4282,11 @@ static RECT MeasureTextAnnotation(HDC hdc, Annotation& a) {
     int glyphTop  = a.y1 + (int)floorf(offY);
     int glyphRight = a.x1 + (int)ceilf(offX + w);
     int glyphBottom = a.y1 + (int)ceilf(offY + h);
-    rect.left   = glyphLeft - padding;
-    rect.top    = glyphTop - padding;
-    rect.right  = glyphRight + padding;
-    rect.bottom = glyphBottom + padding;
-    return rect;
-}
-
-// 命中测试文字标注，返回标注索引（-1 表示未命中）
-// 非常量引用：MeasureTextAnnotation 会回填文字测量缓存。
-static int HitTestTextAnnotations(std::vector<Annotation>& anns, int x, int y, HDC hdc) {
-    for (int i = (int)anns.size() - 1; i >= 0; i--) {
-        if (anns[i].type == AT_Text) {
-            RECT rect = MeasureTextAnnotation(hdc, anns[i]);
-            if (PointInRect(x, y, rect)) {
-                return i;
-            }
-        }
-    }
-    return -1;
+    rect.left   = glyphLeft - padding;
+    rect.top    = glyphTop - padding;
+    rect.right  = glyphRight + padding;
+    rect.bottom = glyphBottom + padding;
+    return rect;
 }
 
 // ==================== 通用标注几何（选中/拖拽/缩放） ====================
@@ -3141,14 +4311,18 @@ static double PointToSegmentDist(double px, double py, double ax, double ay, dou
 }
 
 // 点 (px,py) 到折线 pts 的最短距离（像素）。
-static double PointToPolylineDist(double px, double py, const std::vector<POINT>& pts) {
+// first/last 限定只测点区间 [first, last] 内的线段（命中索引给出的候选部件），默认整条折线。
+static double PointToPolylineDist(double px, double py, const std::vector<POINT>& pts,
+                                  int first = 0, int last = -1) {
     if (pts.empty()) return 1e18;
-    if (pts.size() == 1) {
-        double ex = px - pts[0].x, ey = py - pts[0].y;
+    if (last < 0 || last >= (int)pts.size()) last = (int)pts.size() - 1;
+    if (first < 0) first = 0;
+    if (first >= last) {
+        double ex = px - pts[first].x, ey = py - pts[first].y;
         return std::sqrt(ex * ex + ey * ey);
     }
     double best = 1e18;
-    for (size_t i = 0; i + 1 < pts.size(); i++) {
+    for (int i = first; i < last; i++) {
         double d = PointToSegmentDist(px, py, pts[i].x, pts[i].y, pts[i + 1].x, pts[i + 1].y);
         if (d < best) best = d;
     }
@@ -3209,83 +4383,161 @@ static RECT MeasureAnnotationBounds(Annotation& a, HDC hdc) {
     return r;
 }
 
-// 命中测试任意标注，返回索引（-1 表示未命中）。
-// 从顶层（数组末尾，绘制最上层）向底层遍历，命中第一个即返回（与视觉 z-order 一致）。
-// 容差按线宽自适应：细线给 6px 余量，粗线给半个线宽，避免细线难以点中。
-// 非常量引用：AT_Text/AT_Mosaic 分支会回填文字测量缓存。
-static int HitTestAnnotation(std::vector<Annotation>& anns, int x, int y, HDC hdc) {
-    for (int i = (int)anns.size() - 1; i >= 0; i--) {
-        Annotation& a = anns[i];
-        // 马赛克区域（框选/涂抹）不可选中、不可拖拽，直接跳过命中测试。
-        if (a.type == AT_Mosaic) continue;
-        double tol = (std::max)(6.0, a.thickness / 2.0 + 2.0);
-        switch (a.type) {
-            case AT_Rect: {
-                // 仅命中矩形四条边轮廓（空心框），内部空白不选中。
-                // 到任一边线段的最短距离 ≤ tol 即命中（容差向外扩散几像素辅助探测）。
-                double d1 = PointToSegmentDist((double)x, (double)y, a.x1, a.y1, a.x2, a.y1);
-                double d2 = PointToSegmentDist((double)x, (double)y, a.x2, a.y2, a.x1, a.y2);
-                double d3 = PointToSegmentDist((double)x, (double)y, a.x1, a.y2, a.x1, a.y1);
-                double d4 = PointToSegmentDist((double)x, (double)y, a.x2, a.y1, a.x2, a.y2);
-                double dm = (std::min)((std::min)(d1, d2), (std::min)(d3, d4));
-                if (dm <= tol) return i;
-                break;
-            }
-            case AT_Circle: {
-                // 椭圆（由包围盒定义）轮廓命中：用归一化径向距离近似。
-                // r = hypot((x-cx)/a, (y-cy)/b)，r≈1 即落在椭圆上。
-                double cx = (a.x1 + a.x2) * 0.5;
-                double cy = (a.y1 + a.y2) * 0.5;
-                double aax = std::fabs((double)a.x2 - a.x1) * 0.5;
-                double aay = std::fabs((double)a.y2 - a.y1) * 0.5;
-                if (aax < 0.5 && aay < 0.5) {
-                    // 退化为点：直接点距
-                    double ex = x - cx, ey = y - cy;
-                    if (std::sqrt(ex * ex + ey * ey) <= tol) return i;
-                } else if (aax < 0.5) {
-                    // 退化为竖直线段
-                    if (PointToSegmentDist((double)x, (double)y, cx, a.y1, cx, a.y2) <= tol) return i;
-                } else if (aay < 0.5) {
-                    // 退化为水平线段
-                    if (PointToSegmentDist((double)x, (double)y, a.x1, cy, a.x2, cy) <= tol) return i;
-                } else {
-                    double r = std::sqrt(((x - cx) / aax) * ((x - cx) / aax)
-                                         + ((y - cy) / aay) * ((y - cy) / aay));
-                    // (r-1)*min(a,b) 把归一化距离换算回像素（用短半轴近似像素半径，保守且足够命中探测）
-                    double minAxis = (std::min)(aax, aay);
-                    if (std::fabs(r - 1.0) * minAxis <= tol) return i;
-                }
-                break;
-            }
-            case AT_Arrow: {
-                if (PointToSegmentDist((double)x, (double)y, a.x1, a.y1, a.x2, a.y2) <= tol)
-                    return i;
-                break;
-            }
-            case AT_Brush: {
-                if (PointToPolylineDist((double)x, (double)y, a.pts) <= tol) return i;
-                break;
-            }
-            case AT_Mosaic: {
-                if (a.mosaicRect) {
-                    RECT box = MeasureAnnotationBounds(a, hdc);
-                    if (PointInRect(x, y, box)) return i;
-                } else {
-                    // 涂抹：路径 + 半径
-                    if (PointToPolylineDist((double)x, (double)y, a.pts) <= a.brushRadius) return i;
-                }
-                break;
-            }
-            case AT_Text: {
-                RECT box = MeasureTextAnnotation(hdc, a);
-                if (PointInRect(x, y, box)) return i;
-                break;
+// 线条型标注的命中容差：细线给 6px 余量，粗线给半个线宽，避免细线难以点中。
+static double AnnotationHitTolerance(const Annotation& a) {
+    return (std::max)(6.0, a.thickness / 2.0 + 2.0);
+}
+
+// 单个标注的精确命中测试（坐标为绝对虚拟屏幕坐标）。
+// part 为命中索引给出的候选部件：画笔只测部件覆盖的点区间，其余类型整体测试。
+// 非常量引用：AT_Text 分支会回填文字测量缓存。
+static bool HitAnnotationExact(Annotation& a, int x, int y, HDC hdc, const ztools::HitPart& part) {
+    double tol = AnnotationHitTolerance(a);
+    switch (a.type) {
+        case AT_Rect: {
+            // 仅命中矩形四条边轮廓（空心框），内部空白不选中。
+            // 到任一边线段的最短距离 ≤ tol 即命中（容差向外扩散几像素辅助探测）。
+            double d1 = PointToSegmentDist((double)x, (double)y, a.x1, a.y1, a.x2, a.y1);
+            double d2 = PointToSegmentDist((double)x, (double)y, a.x2, a.y2, a.x1, a.y2);
+            double d3 = PointToSegmentDist((double)x, (double)y, a.x1, a.y2, a.x1, a.y1);
+            double d4 = PointToSegmentDist((double)x, (double)y, a.x2, a.y1, a.x2, a.y2);
+            double dm = (std::min)((std::min)(d1, d2), (std::min)(d3, d4));
+            return dm <= tol;
+        }
+        case AT_Circle: {
+            // 椭圆（由包围盒定义）轮廓命中：用归一化径向距离近似。
+            // r = hypot((x-cx)/a, (y-cy)/b)，r≈1 即落在椭圆上。
+            double cx = (a.x1 + a.x2) * 0.5;
+            double cy = (a.y1 + a.y2) * 0.5;
+            double aax = std::fabs((double)a.x2 - a.x1) * 0.5;
+            double aay = std::fabs((double)a.y2 - a.y1) * 0.5;
+            if (aax < 0.5 && aay < 0.5) {
+                // 退化为点：直接点距
+                double ex = x - cx, ey = y - cy;
+                return std::sqrt(ex * ex + ey * ey) <= tol;
+            } else if (aax < 0.5) {
+                // 退化为竖直线段
+                return PointToSegmentDist((double)x, (double)y, cx, a.y1, cx, a.y2) <= tol;
+            } else if (aay < 0.5) {
+                // 退化为水平线段
+                return PointToSegmentDist((double)x, (double)y, a.x1, cy, a.x2, cy) <= tol;
             }
+            double r = std::sqrt(((x - cx) / aax) * ((x - cx) / aax)
+                                 + ((y - cy) / aay) * ((y - cy) / aay));
+            // (r-1)*min(a,b) 把归一化距离换算回像素（用短半轴近似像素半径，保守且足够命中探测）
+            double minAxis = (std::min)(aax, aay);
+            return std::fabs(r - 1.0) * minAxis <= tol;
+        }
+        case AT_Arrow:
+            return PointToSegmentDist((double)x, (double)y, a.x1, a.y1, a.x2, a.y2) <= tol;
+        case AT_Brush:
+            return PointToPolylineDist((double)x, (double)y, a.pts, part.first, part.last) <= tol;
+        case AT_Text:
+            return PointInRect(x, y, MeasureTextAnnotation(hdc, a));
+        case AT_Mosaic:
+            // 马赛克区域（框选/涂抹）不可选中、不可拖拽，不进入命中索引。
+            return false;
+    }
+    return false;
+}
+
+static AnnotationHitKey MakeAnnotationHitKey(const Annotation& a) {
+    AnnotationHitKey k;
+    k.type = a.type;
+    k.thickness = a.thickness;
+    k.x1 = a.x1; k.y1 = a.y1; k.x2 = a.x2; k.y2 = a.y2;
+    k.mosaicRect = a.mosaicRect;
+    k.count = a.pts.size();
+    POINT zero = { 0, 0 };
+    k.first = a.pts.empty() ? zero : a.pts.front();
+    k.mid = a.pts.empty() ? zero : a.pts[a.pts.size() / 2];
+    k.last = a.pts.empty() ? zero : a.pts.back();
+    if (a.type == AT_Text) k.text = a.text;
+    return k;
+}
+
+// 线段 (ax,ay)-(bx,by) 外扩 pad 后的候选框（半开区间，含端点）
+static ztools::HitPart SegmentHitPart(int ax, int ay, int bx, int by, int pad) {
+    ztools::HitPart part;
+    part.box = ztools::IntRect::FromLTRB((std::min)(ax, bx) - pad, (std::min)(ay, by) - pad,
+                                         (std::max)(ax, bx) + pad + 1, (std::max)(ay, by) + pad + 1);
+    return part;
+}
+
+// 标注在命中索引中的候选部件：候选框必须覆盖 HitAnnotationExact 可能命中的全部点（容差向上取整）
+static std::vector<ztools::HitPart> AnnotationHitParts(Annotation& a, HDC hdc) {
+    std::vector<ztools::HitPart> parts;
+    int pad = (int)std::ceil(AnnotationHitTolerance(a)) + 1;
+    switch (a.type) {
+        case AT_Rect:
+            // 空心框：四条边各一个部件，框内部不产生候选
+            parts.push_back(SegmentHitPart(a.x1, a.y1, a.x2, a.y1, pad));
+            parts.push_back(SegmentHitPart(a.x2, a.y2, a.x1, a.y2, pad));
+            parts.push_back(SegmentHitPart(a.x1, a.y2, a.x1, a.y1, pad));
+            parts.push_back(SegmentHitPart(a.x2, a.y1, a.x2, a.y2, pad));
+            break;
+        case AT_Circle:
+        case AT_Arrow:
+            parts.push_back(SegmentHitPart(a.x1, a.y1, a.x2, a.y2, pad));
+            break;
+        case AT_Brush:
+            ztools::AppendPolylineParts(a.pts.data(), (int)a.pts.size(), pad, parts);
+            break;
+        case AT_Text: {
+            RECT r = MeasureTextAnnotation(hdc, a);
+            ztools::HitPart part;
+            part.box = ztools::IntRect::FromLTRB(r.left, r.top, r.right, r.bottom);
+            parts.push_back(part);
+            break;
         }
+        case AT_Mosaic:
+            break;
+    }
+    return parts;
+}
+
+// 让命中索引与 ctx->annotations 一致：版本未变时直接返回（悬停不再逐个构造签名）；
+// 否则逐个比对签名，只重登记改动的标注（删除 / 撤销导致的索引整体后移会让后续标注都重登记一次），多出的尾部截断
+static void SyncHitIndex(CaptureContext* ctx, HDC hdc) {
+    if (ctx->hitIndexVersion == ctx->annotationsVersion) return;
+    ctx->hitIndexVersion = ctx->annotationsVersion;
+    std::vector<Annotation>& anns = ctx->annotations;
+    if (ctx->hitKeys.size() > anns.size()) ctx->hitKeys.resize(anns.size());
+    ctx->hitIndex.Truncate((int)anns.size());
+    for (size_t i = 0; i < anns.size(); i++) {
+        AnnotationHitKey key = MakeAnnotationHitKey(anns[i]);
+        if (i < ctx->hitKeys.size() && ctx->hitKeys[i] == key) continue;
+        ctx->hitIndex.SetItem((int)i, AnnotationHitParts(anns[i], hdc));
+        if (i < ctx->hitKeys.size()) ctx->hitKeys[i] = key;
+        else ctx->hitKeys.push_back(key);
+    }
+}
+
+// 按索引候选（顶层优先）做精确命中；textOnly 时只考虑文字标注
+static int HitTestIndexed(CaptureContext* ctx, int x, int y, HDC hdc, bool textOnly) {
+    SyncHitIndex(ctx, hdc);
+    std::vector<ztools::HitCandidate> candidates;
+    ctx->hitIndex.Query(x, y, candidates);
+    for (const ztools::HitCandidate& c : candidates) {
+        Annotation& a = ctx->annotations[c.item];
+        if (textOnly && a.type != AT_Text) continue;
+        if (HitAnnotationExact(a, x, y, hdc, ctx->hitIndex.Parts(c.item)[c.part])) return c.item;
     }
     return -1;
 }
 
+// 命中测试任意标注，返回索引（-1 表示未命中）。
+// 候选按顶层（数组末尾，绘制最上层）优先排序，命中第一个即返回（与视觉 z-order 一致）。
+// 马赛克区域不可选中，不参与命中。
+static int HitTestAnnotation(CaptureContext* ctx, int x, int y, HDC hdc) {
+    return HitTestIndexed(ctx, x, y, hdc, false);
+}
+
+// 命中测试文字标注，返回标注索引（-1 表示未命中）
+static int HitTestTextAnnotations(CaptureContext* ctx, int x, int y, HDC hdc) {
+    return HitTestIndexed(ctx, x, y, hdc, true);
+}
+
 // 命中测试标注包围盒的 8 个手柄（4 角 + 4 边中点），返回 ResizeHandle 或 RH_None。
 // 容差沿用选区手柄的 SC_HANDLE_SIZE，保证与选区手柄一致的可点击范围。
 static int HitTestAnnotationHandle(int x, int y, const RECT& box) {
@@ -3498,14 +4750,15 @@ static void InvalidateAnnotationOp(HWND hwnd, CaptureContext* ctx, const RECT& c
     b.left -= ctx->virtualX; b.top -= ctx->virtualY;
     b.right -= ctx->virtualX; b.bottom -= ctx->virtualY;
     const int handleMargin = SC_HANDLE_SIZE / 2 + 4;  // 手柄半径 + 描边/抗锯齿余量
-    InvalidateRect(hwnd, &InflateRectBy(b, handleMargin), FALSE);
+    RECT dirty = InflateRectBy(b, handleMargin);
+    InvalidateDamage(hwnd, ctx, &dirty);
 }
 
 // 选中/取消选中覆盖物时的精确脏区计算。
 // 根据当前 selectedAnnotation / selectedTextAnnotation 的包围盒算出需重绘的脏区
 // （含 resize 手柄半径余量），可选合并工具栏 + popup 旧位置（切换不同类型工具时）。
 // 调用时机：必须在调用方清空 selected*/hovered* 之前调用，否则读不到旧选中项的包围盒。
-// 坐标基准：返回 backDC/客户区坐标（已减 virtualX/Y），可直接用于 InvalidateRect(hwnd, &r, FALSE)。
+// 坐标基准：返回 backDC/客户区坐标（已减 virtualX/Y），可直接用于 InvalidateDamage(hwnd, ctx, &r)。
 // 参数 includeToolbar：true 时并集工具栏矩形和 popup 矩形（覆盖 activeTool 切换导致的高亮按钮
 //   位移 + popup 打开/关闭/切换），用于「切换到不同类型工具」场景。
 // 返回值可能为无效矩形（{0,0,0,0}）：表示当前无任何选中项，调用方据此决定是否全屏重绘兜底。
@@ -3546,7 +4799,7 @@ static RECT CalcSelectionDirty(CaptureContext* ctx, bool includeToolbar) {
 // 坐标基准：backDC 坐标 = 客户区坐标（已减 virtualX/Y），与 InvalidateRect 一致。
 static void InvalidateTextLine(HWND hwnd, CaptureContext* ctx) {
     if (!ctx->hasLastCaret) {
-        InvalidateRect(hwnd, NULL, FALSE);
+        InvalidateDamage(hwnd, ctx, NULL);
         return;
     }
     // 文字行矩形：选区宽度 × 光标行高（backDC 坐标）
@@ -3556,7 +4809,109 @@ static void InvalidateTextLine(HWND hwnd, CaptureContext* ctx) {
         ctx->selection.right - ctx->virtualX,
         ctx->lastCaretRect.bottom
     };
-    InvalidateRect(hwnd, &InflateRectBy(line, 4), FALSE);
+    RECT dirty = InflateRectBy(line, 4);
+    InvalidateDamage(hwnd, ctx, &dirty);
+}
+
+// 当前选区（backDC 坐标）：拖出中取起止点，其余有选区的状态取 selection；Idle 为空矩形
+static RECT CurrentSelectionRel(const CaptureContext* ctx) {
+    RECT r = {0, 0, 0, 0};
+    if (ctx->state == CS_Selecting) {
+        r.left = (std::min)(ctx->startX, ctx->endX) - ctx->virtualX;
+        r.top = (std::min)(ctx->startY, ctx->endY) - ctx->virtualY;
+        r.right = (std::max)(ctx->startX, ctx->endX) - ctx->virtualX;
+        r.bottom = (std::max)(ctx->startY, ctx->endY) - ctx->virtualY;
+    } else if (ctx->state == CS_Confirmed || ctx->state == CS_Resizing
+               || ctx->state == CS_Moving || ctx->state == CS_Drawing
+               || ctx->state == CS_TextEditing) {
+        r.left = ctx->selection.left - ctx->virtualX;
+        r.top = ctx->selection.top - ctx->virtualY;
+        r.right = ctx->selection.right - ctx->virtualX;
+        r.bottom = ctx->selection.bottom - ctx->virtualY;
+    }
+    return r;
+}
+
+// 当前子菜单矩形（与 WM_PAINT 的绘制分支一致）：马赛克工具为模式 / 块大小菜单，
+// 其余可显示样式菜单的工具为粗细 / 颜色菜单；未打开时返回空矩形。
+static RECT CalcPopupRectFor(const CaptureContext* ctx, const RECT& toolbarRect) {
+    RECT r = {0, 0, 0, 0};
+    if (!ctx->popupOpen) return r;
+    if (ctx->popupTool == TB_Mosaic) {
+        int mpw, mph;
+        CalcMosaicPopupSize(ctx->popupMetrics, mpw, mph);
+        CalcPopupPlacement(toolbarRect, ctx->virtualW, ctx->virtualH, ctx->popupMetrics, mpw, mph, r);
+    } else if (CanShowStylePopupTool(ctx->popupTool)) {
+        CalcPopupPosition(toolbarRect, ctx->virtualW, ctx->virtualH, ctx->popupMetrics, r);
+    }
+    return r;
+}
+
+// 拖出 / 调整 / 移动选区一帧的损伤（取代这三种状态原先的每帧整屏重绘）：
+// 新旧选区的对称差（遮罩明暗翻转）+ 新旧边框边带；重叠部分的画面不变（底图、马赛克、
+// 已提交标注都按绝对坐标绘制，只是被裁剪到选区内）。再加上随之移动的尺寸标签 / 信息面板 /
+// 工具栏 / 子菜单的上帧位置与本帧位置，本帧位置用与 WM_PAINT 同源的布局函数预算。
+// oldSelRel 为更新 ctx 之前的 CurrentSelectionRel。
+static void InvalidateSelectionChange(HWND hwnd, CaptureContext* ctx, const RECT& oldSelRel) {
+    RECT sel = CurrentSelectionRel(ctx);
+    const int edge = SC_HANDLE_SIZE / 2 + 4;  // 边框 + 手柄半径 + 抗锯齿余量
+    ztools::AddRectChange(ctx->damage, ToIntRect(oldSelRel), ToIntRect(sel), edge);
+
+    RECT chrome[6];
+    int count = 0;
+    chrome[count++] = ctx->lastLabelRect;
+    chrome[count++] = ctx->lastToolbarRect;
+    chrome[count++] = ctx->lastPopupRect;
+    if (ctx->state == CS_Selecting) {
+        wchar_t sizeBuf[64];
+        chrome[count++] = LayoutSizeLabel(ctx->backDC, sel.right - sel.left, sel.bottom - sel.top,
+            sel.left, sel.top, sel.right, sel.bottom, ctx->virtualW, ctx->virtualH,
+            ctx->gdi, ctx->panelMetrics, sizeBuf);
+        int px, py;
+        CalcPanelPosition(ctx->mouseX, ctx->mouseY,
+            ctx->virtualX, ctx->virtualY, ctx->virtualW, ctx->virtualH, ctx->panelMetrics, px, py);
+        RECT panel = { px - ctx->virtualX, py - ctx->virtualY,
+                       px - ctx->virtualX + ctx->panelMetrics.w, py - ctx->virtualY + ctx->panelMetrics.h };
+        chrome[count++] = panel;
+        chrome[count++] = ctx->lastPanelRect;  // 信息面板只在 Idle/Selecting 绘制
+    } else if (ctx->state == CS_Moving) {
+        RECT toolbar;
+        CalcToolbarPosition(sel, ctx->virtualW, ctx->virtualH, ctx->toolbarMetrics, toolbar);
+        chrome[count++] = toolbar;
+        chrome[count++] = CalcPopupRectFor(ctx, toolbar);
+    }
+    for (int i = 0; i < count; i++) {
+        if (IsValidRect(chrome[i])) ctx->damage.Add(ToIntRect(InflateRectBy(chrome[i], 2)));
+    }
+    // 把累积的损伤矩形逐个并入系统更新区（触发 WM_PAINT）
+    for (const ztools::IntRect& r : ctx->damage.Rects()) {
+        RECT rc = ToRect(r);
+        InvalidateRect(hwnd, &rc, FALSE);
+    }
+}
+
+// 把系统更新区（被其他窗口遮挡后露出等）拆成矩形并入损伤
+static void AddUpdateRegionDamage(HWND hwnd, CaptureContext* ctx) {
+    HRGN rgn = CreateRectRgn(0, 0, 0, 0);
+    if (!rgn) {
+        ctx->damage.AddAll();
+        return;
+    }
+    int kind = GetUpdateRgn(hwnd, rgn, FALSE);
+    if (kind == SIMPLEREGION || kind == COMPLEXREGION) {
+        DWORD bytes = GetRegionData(rgn, 0, NULL);
+        std::vector<BYTE> buf(bytes);
+        RGNDATA* data = reinterpret_cast<RGNDATA*>(buf.data());
+        if (bytes > 0 && GetRegionData(rgn, bytes, data)) {
+            const RECT* rects = reinterpret_cast<const RECT*>(data->Buffer);
+            for (DWORD i = 0; i < data->rdh.nCount; i++) ctx->damage.Add(ToIntRect(rects[i]));
+        } else {
+            RECT box;
+            GetRgnBox(rgn, &box);
+            ctx->damage.Add(ToIntRect(box));
+        }
+    }
+    DeleteObject(rgn);
 }
 
 // 截图覆盖层窗口过程（双缓冲渲染）
@@ -3566,9 +4921,28 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
 
     switch (msg) {
     case WM_PAINT: {
+        HDC backDC = ctx->backDC;
+
+        // ==== 本帧损伤 ====
+        // 重绘区域 = 各交互经 InvalidateDamage / InvalidateSelectionChange 上报的矩形 ∪ 系统更新区；
+        // needFullRedraw（进入 / 退出状态、切换工具等）整屏。损伤可能超出系统更新区，
+        // 须在 BeginPaint 之前补进更新区，否则 BeginPaint 的裁剪会挡住这部分的呈现。
+        if (ctx->needFullRedraw) {
+            ctx->damage.AddAll();
+            ctx->needFullRedraw = false;
+        }
+        AddUpdateRegionDamage(hwnd, ctx);
+        for (const ztools::IntRect& r : ctx->damage.Rects()) {
+            RECT rc = ToRect(r);
+            InvalidateRect(hwnd, &rc, FALSE);
+        }
+
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
-        HDC backDC = ctx->backDC;
+        if (ctx->damage.Empty()) {
+            EndPaint(hwnd, &ps);
+            return 0;
+        }
 
         // 计算浮窗位置
         int panelX, panelY;
@@ -3582,20 +4956,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             panelXRel + ctx->panelMetrics.w, panelYRel + ctx->panelMetrics.h };
 
         // 当前选区矩形
-        RECT curSelRect = {0,0,0,0};
-        if (ctx->state == CS_Selecting) {
-            curSelRect.left = (std::min)(ctx->startX, ctx->endX) - ctx->virtualX;
-            curSelRect.top = (std::min)(ctx->startY, ctx->endY) - ctx->virtualY;
-            curSelRect.right = (std::max)(ctx->startX, ctx->endX) - ctx->virtualX;
-            curSelRect.bottom = (std::max)(ctx->startY, ctx->endY) - ctx->virtualY;
-        } else if (ctx->state == CS_Confirmed || ctx->state == CS_Resizing
-                   || ctx->state == CS_Moving || ctx->state == CS_Drawing
-                   || ctx->state == CS_TextEditing) {
-            curSelRect.left = ctx->selection.left - ctx->virtualX;
-            curSelRect.top = ctx->selection.top - ctx->virtualY;
-            curSelRect.right = ctx->selection.right - ctx->virtualX;
-            curSelRect.bottom = ctx->selection.bottom - ctx->virtualY;
-        }
+        RECT curSelRect = CurrentSelectionRel(ctx);
 
         // 当前高亮窗口矩形
         RECT curHlRect = {0,0,0,0};
@@ -3605,55 +4966,42 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 wr.right - ctx->virtualX, wr.bottom - ctx->virtualY };
         }
 
-        double ds = ctx->dpiScale;
+        HDC baseDC = PaintBaseDC(ctx);
+        double ds = PaintBaseScale(ctx);
         int physW = (int)(ctx->virtualW * ds + 0.5);
         int physH = (int)(ctx->virtualH * ds + 0.5);
 
-        // P1 脏区域优化：仅"选区正在移动/缩放"的状态（Selecting/Resizing/Moving）
-        // 因遮罩边界大范围变化，必须整屏恢复背景。其余 confirmedMode 状态（Confirmed/Drawing/
-        // TextEditing）选区静止，可用 ps.rcPaint 局部刷新（由各调用点 InvalidateRect 传精确矩形）。
-        if (ctx->state == CS_Selecting || ctx->state == CS_Resizing || ctx->state == CS_Moving) {
-            ctx->needFullRedraw = true;
-        }
-
-        // 本帧脏区域：fullFrame 时为全屏，否则取 ps.rcPaint（由 InvalidateRect 矩形决定）。
-        // 客户区坐标 = backDC 坐标（窗口原点 = 虚拟屏幕左上角），可直接用于背景恢复与裁剪。
-        bool fullFrame = ctx->needFullRedraw;
-        RECT dirtyRect;
+        // 恢复背景：整屏帧一次恢复；否则逐块恢复损伤矩形（其余区域保留上帧最终画面）。
+        // 后续渲染管线会对这些区域重画遮罩/标注等，因 AlphaBlend 作用于已恢复的清晰背景，
+        // 结果与全屏渲染一致。裁剪区设为各块之并，后续所有 GDI/GDI+ 绘制只落在损伤区内
+        // （GDI+ Graphics(backDC) 会继承此裁剪区）。
+        const std::vector<ztools::IntRect>& damageRects = ctx->damage.Rects();
         HRGN dirtyRgn = NULL;
-        if (fullFrame) {
-            dirtyRect = { 0, 0, ctx->virtualW, ctx->virtualH };
-        } else {
-            // ps.rcPaint 在 InvalidateRect(NULL) 时为整个客户区（等价全屏），传矩形时为该矩形。
-            dirtyRect = ps.rcPaint;
-            // 限定到虚拟屏幕范围内（防御性：ps.rcPaint 理论上不会超出客户区=虚拟屏幕）
-            if (dirtyRect.left < 0) dirtyRect.left = 0;
-            if (dirtyRect.top < 0) dirtyRect.top = 0;
-            if (dirtyRect.right > ctx->virtualW) dirtyRect.right = ctx->virtualW;
-            if (dirtyRect.bottom > ctx->virtualH) dirtyRect.bottom = ctx->virtualH;
-        }
-
-        // 恢复背景：fullFrame 全屏恢复；局部帧只恢复 dirtyRect（其余区域保留上帧最终画面）。
-        if (fullFrame) {
+        if (ctx->damage.Full()) {
             if (ds > 1.01 || ds < 0.99) {
                 StretchBlt(backDC, 0, 0, ctx->virtualW, ctx->virtualH,
-                    ctx->memDC, 0, 0, physW, physH, SRCCOPY);
+                    baseDC, 0, 0, physW, physH, SRCCOPY);
             } else {
                 BitBlt(backDC, 0, 0, ctx->virtualW, ctx->virtualH,
-                    ctx->memDC, 0, 0, SRCCOPY);
+                    baseDC, 0, 0, SRCCOPY);
             }
-            ctx->needFullRedraw = false;
         } else {
-            // 局部恢复脏区域为原始背景（后续渲染管线会对该区域重画遮罩/标注等，
-            // 因 AlphaBlend 作用于已恢复的清晰背景，结果与全屏渲染一致）。
-            RestoreDirtyRegion(backDC, ctx->memDC, dirtyRect, ds);
-            // 设置裁剪区：后续所有 GDI/GDI+ 绘制自动限制在 dirtyRect 内，
-            // 避免重绘未变化区域（GDI+ Graphics(backDC) 会继承此裁剪区）。
-            dirtyRgn = CreateRectRgn(dirtyRect.left, dirtyRect.top,
-                                     dirtyRect.right, dirtyRect.bottom);
+            dirtyRgn = CreateRectRgn(0, 0, 0, 0);
+            for (const ztools::IntRect& r : damageRects) {
+                RECT rc = ToRect(r);
+                RestoreDirtyRegion(backDC, baseDC, rc, ds);
+                HRGN piece = CreateRectRgn(rc.left, rc.top, rc.right, rc.bottom);
+                CombineRgn(dirtyRgn, dirtyRgn, piece, RGN_OR);
+                DeleteObject(piece);
+            }
             SelectClipRgn(backDC, dirtyRgn);
         }
 
+        // ==== 按层合成 ====
+        // 底图（上面已恢复）→ 选区外遮罩 → 马赛克 → 标注（含正在绘制 / 编辑的）→ 界面元素
+        // （选区边框与手柄、标注选中框、工具栏与子菜单、尺寸标签、信息面板）。
+        // Idle 态只有底图上的窗口高亮、尺寸标签与信息面板。
+
         // 绘制窗口高亮（Idle 状态）
         if (ctx->state == CS_Idle) {
             if (ctx->hoveredWindow >= 0 && ctx->hoveredWindow < (int)ctx->windows.size()) {
@@ -3684,31 +5032,19 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                               || ctx->state == CS_TextEditing);
         if (confirmedMode) {
             // 选区外遮罩（选区内部保持清晰）
-            DrawDimMask(backDC, ctx->gdi,
-                curSelRect.left, curSelRect.top, curSelRect.right, curSelRect.bottom,
-                ctx->virtualW, ctx->virtualH);
-            // 确认态边框
-            DrawConfirmedBorder(backDC, curSelRect, ctx->gdi);
-            // 调整手柄（拖拽选区/调整选区/文字编辑时不绘制，避免遮挡；确认态/绘制标注时绘制）
-            if (ctx->state == CS_Confirmed || ctx->state == CS_Drawing) {
-                DrawResizeHandles(backDC, curSelRect);
-            }
+            DrawDimMask(ctx->backPixels, ctx->damage, curSelRect);
             // 已提交标注 + 正在绘制的标注（绘制范围 clip 在选区内）
             // 调整选区时也保持显示，便于看清内容是否会被裁掉。
             if (ctx->state == CS_Confirmed || ctx->state == CS_Drawing || ctx->state == CS_Resizing) {
                 const Annotation* cur = ctx->hasCurDrawing ? &ctx->curDrawing : nullptr;
                 // 马赛克（reveal-mask 模型）：先确保 base（整选区马赛克）已生成，
                 // 再把所有马赛克标注（含正在绘制的）的蒙版区域从 base 揭示到 backDC。
-                // base 预计算后每帧只做带区域裁剪的 BitBlt，无逐标注像素化，连续无闪烁。
+                // 蒙版增量维护、揭示层只重合成变化部分，每帧只剩一次带裁剪的 AlphaBlend，连续无闪烁。
                 if (HasMosaicToRender(ctx->annotations, cur)) {
-                    if (MosaicBaseNeedsRebuild(ctx)) RebuildMosaicBase(ctx);
-                    if (ctx->mosaicBaseDC) {
-                        // base 与 backDC 同为虚拟屏幕绝对坐标，蒙版 ox/oy = 0
-                        RevealMosaicToTarget(backDC, ctx->mosaicBaseDC,
-                                             ctx->annotations, cur, 0.0f, 0.0f);
-                    }
+                    SyncMosaicReveal(ctx, ctx->annotations, cur);
+                    RevealMosaicToTarget(backDC, ctx);
                 }
-                DrawAnnotations(backDC, curSelRect, ctx->virtualX, ctx->virtualY, ctx->annotations, cur);
+                DrawAnnotations(backDC, ctx, curSelRect, cur);
                 // 缓存正在绘制标注的包围盒（绝对虚拟屏幕坐标），供 CS_Drawing 局部刷新计算旧位置
                 if (ctx->state == CS_Drawing && ctx->hasCurDrawing) {
                     ctx->lastDrawingBox = MeasureAnnotationBounds(ctx->curDrawing, backDC);
@@ -3742,14 +5078,11 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             // 文字编辑态：绘制输入光标和选中文字标注的边框
             if (ctx->state == CS_TextEditing) {
                 if (HasMosaicToRender(ctx->annotations, nullptr)) {
-                    if (MosaicBaseNeedsRebuild(ctx)) RebuildMosaicBase(ctx);
-                    if (ctx->mosaicBaseDC) {
-                        RevealMosaicToTarget(backDC, ctx->mosaicBaseDC,
-                                             ctx->annotations, nullptr, 0.0f, 0.0f);
-                    }
+                    SyncMosaicReveal(ctx, ctx->annotations, nullptr);
+                    RevealMosaicToTarget(backDC, ctx);
                 }
                 // 绘制已提交的标注
-                DrawAnnotations(backDC, curSelRect, ctx->virtualX, ctx->virtualY, ctx->annotations, nullptr);
+                DrawAnnotations(backDC, ctx, curSelRect, nullptr);
 
                 // 绘制当前输入的文字和光标（统一用 GDI+，与提交态 DrawString 完全一致，
                 // 避免旧 GDI TextOutW 导致的文字偏靠下、右侧间距偏大的问题）
@@ -3881,6 +5214,13 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     }
                 }
             }
+            // ---- 界面元素 ----
+            // 确认态边框
+            DrawConfirmedBorder(backDC, curSelRect, ctx->gdi);
+            // 调整手柄（拖拽选区/调整选区/文字编辑时不绘制，避免遮挡；确认态/绘制标注时绘制）
+            if (ctx->state == CS_Confirmed || ctx->state == CS_Drawing) {
+                DrawResizeHandles(backDC, curSelRect);
+            }
             // 确认态和文字编辑态：文字标注的选中边框
             // - selectedTextAnnotation：已选中的标注（点击后持久保持），实线高亮边框
             // 注：文字悬浮辅助边框已移除（确认态下悬浮高亮与选中边框语义重叠且干扰视觉）。
@@ -3997,12 +5337,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 DrawToolbar(backDC, curToolbarRect, ctx->hoverToolbarBtn, ctx->activeTool,
                     ctx->gdi, ctx->toolbarMetrics, ctx->iconCache);
                 int popupTool = ctx->popupTool;
+                curPopupRect = CalcPopupRectFor(ctx, curToolbarRect);
                 // 马赛克子菜单：模式切换 + 块大小
                 if (ctx->popupOpen && popupTool == TB_Mosaic) {
-                    int mpw, mph;
-                    CalcMosaicPopupSize(ctx->popupMetrics, mpw, mph);
-                    CalcPopupPlacement(curToolbarRect, ctx->virtualW, ctx->virtualH,
-                        ctx->popupMetrics, mpw, mph, curPopupRect);
                     ctx->popupRect = curPopupRect;
                     int modeIdx = ctx->mosaicRectMode ? 1 : 0;
                     DrawMosaicPopup(backDC, curPopupRect, modeIdx, ctx->mosaicSizeIdx,
@@ -4010,8 +5347,6 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 }
                 // 粗细/颜色子菜单：文字工具激活时始终显示（含文字编辑态）
                 else if (ctx->popupOpen && CanShowStylePopupTool(popupTool)) {
-                    CalcPopupPosition(curToolbarRect, ctx->virtualW, ctx->virtualH,
-                        ctx->popupMetrics, curPopupRect);
                     ctx->popupRect = curPopupRect;
                     bool isText = (popupTool == TB_Text);
                     int firstIdx = isText ? ctx->fontSizeIdx : ctx->drawThickIdx;
@@ -4026,9 +5361,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             // ---- Idle/Selecting 态：原有逻辑 ----
             // 绘制选区外遮罩（微信风格，仅 Selecting 状态），选区内部保持清晰
             if (ctx->state == CS_Selecting) {
-                DrawDimMask(backDC, ctx->gdi,
-                    curSelRect.left, curSelRect.top, curSelRect.right, curSelRect.bottom,
-                    ctx->virtualW, ctx->virtualH);
+                DrawDimMask(ctx->backPixels, ctx->damage, curSelRect);
             }
 
             // 绘制选区或窗口尺寸标签
@@ -4068,8 +5401,8 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
 
             // 绘制放大镜信息面板
             DrawInfoPanel(backDC, panelXRel, panelYRel, ctx->currentColor,
-                ctx->memDC, ctx->virtualX, ctx->virtualY,
-                ctx->mouseX, ctx->mouseY, ctx->dpiScale, ctx->gdi, ctx->panelMetrics);
+                ctx->magnifier, ctx->screenPixels, ctx->memDC, ctx->dpiScale,
+                ctx->virtualX, ctx->virtualY, ctx->mouseX, ctx->mouseY, ctx->gdi, ctx->panelMetrics);
         }
 
         // 更新脏区域追踪
@@ -4086,15 +5419,18 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             DeleteObject(dirtyRgn);
         }
 
-        // 后台缓冲 -> 窗口（局部帧只拷脏区域，fullFrame 拷全屏）
-        BitBlt(hdc, dirtyRect.left, dirtyRect.top,
-               dirtyRect.right - dirtyRect.left, dirtyRect.bottom - dirtyRect.top,
-               backDC, dirtyRect.left, dirtyRect.top, SRCCOPY);
+        // 后台缓冲 -> 窗口：只呈现损伤矩形（整屏帧即一次整屏拷贝）
+        for (const ztools::IntRect& r : damageRects) {
+            BitBlt(hdc, r.x, r.y, r.w, r.h, backDC, r.x, r.y, SRCCOPY);
+        }
+        ctx->repaintMeter.Record(ctx->damage);
+        ctx->damage.Clear();
         EndPaint(hwnd, &ps);
         return 0;
     }
 
     case WM_LBUTTONDOWN: {
+        ctx->repaintMeter.Begin();  // 一次交互 = 按下到松开
         if (ctx->state == CS_Idle) {
             // 开始新的框选
             ctx->startX = ctx->mouseX;
@@ -4124,6 +5460,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         textAnnotation.y1 = ctx->textAnchorY;
                         textAnnotation.text = ctx->textBuf;
                         PushAnnotationHistory(ctx);
+                        TouchAnnotation(ctx, textAnnotation);
                         ctx->annotations.push_back(textAnnotation);
                     }
                     ctx->textBuf.clear();
@@ -4132,7 +5469,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->textSelEnd = -1;
                     ctx->state = CS_Confirmed;
                     ctx->needFullRedraw = true;
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 if (hit < 0) {
@@ -4148,6 +5485,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         textAnnotation.y1 = ctx->textAnchorY;
                         textAnnotation.text = ctx->textBuf;
                         PushAnnotationHistory(ctx);
+                        TouchAnnotation(ctx, textAnnotation);
                         ctx->annotations.push_back(textAnnotation);
                     }
                     ctx->textBuf.clear();
@@ -4156,7 +5494,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->textSelEnd = -1;
                     ctx->state = CS_Confirmed;
                     ctx->needFullRedraw = true;
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
             }
@@ -4174,6 +5512,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     textAnnotation.y1 = ctx->textAnchorY;
                     textAnnotation.text = ctx->textBuf;
                     PushAnnotationHistory(ctx);
+                    TouchAnnotation(ctx, textAnnotation);
                     ctx->annotations.push_back(textAnnotation);
                 }
                 ctx->textBuf.clear();
@@ -4182,7 +5521,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->textSelEnd = -1;
                 ctx->state = CS_Confirmed;
                 ctx->needFullRedraw = true;
-                InvalidateRect(hwnd, NULL, FALSE);
+                InvalidateDamage(hwnd, ctx, NULL);
                 return 0;
             }
 
@@ -4215,7 +5554,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->textSelStart = caretPos;
                 ctx->textSelEnd = caretPos;
                 ctx->textDraggingSelection = true;
-                InvalidateRect(hwnd, NULL, FALSE);
+                InvalidateDamage(hwnd, ctx, NULL);
                 return 0;
             }
 
@@ -4230,6 +5569,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     textAnnotation.y1 = ctx->textAnchorY;
                     textAnnotation.text = ctx->textBuf;
                     PushAnnotationHistory(ctx);
+                    TouchAnnotation(ctx, textAnnotation);
                     ctx->annotations.push_back(textAnnotation);
                 }
                 ctx->textBuf.clear();
@@ -4239,7 +5579,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->textSelStart = -1;
                 ctx->textSelEnd = -1;
                 ctx->needFullRedraw = true;
-                InvalidateRect(hwnd, NULL, FALSE);
+                InvalidateDamage(hwnd, ctx, NULL);
                 return 0;
             }
 
@@ -4253,6 +5593,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 textAnnotation.y1 = ctx->textAnchorY;
                 textAnnotation.text = ctx->textBuf;
                 PushAnnotationHistory(ctx);
+                TouchAnnotation(ctx, textAnnotation);
                 ctx->annotations.push_back(textAnnotation);
             }
             ctx->textBuf.clear();
@@ -4261,7 +5602,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             ctx->textSelEnd = -1;
             ctx->state = CS_Confirmed;
             ctx->needFullRedraw = true;
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateDamage(hwnd, ctx, NULL);
             return 0;
         } else if (ctx->state == CS_Confirmed) {
             // 实时命中测试（不依赖 hover 缓存值）。
@@ -4305,19 +5646,15 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->hoveredTextAnnotation = -1;
                     if (hadAnnSel || hadTextSel) {
                         if (IsValidRect(dirty)) {
-                            InvalidateRect(hwnd, &dirty, FALSE);
+                            InvalidateDamage(hwnd, ctx, &dirty);
                         } else {
-                            InvalidateRect(hwnd, NULL, FALSE);
+                            InvalidateDamage(hwnd, ctx, NULL);
                         }
                     }
                 }
                 // 确定：提取选区并完成截图
                 if (b == TB_Confirm) {
-                    ScreenshotResult* result = ExtractRegionResult(ctx->memDC, ctx->selection,
-                        ctx->virtualX, ctx->virtualY, ctx->dpiScale, ctx->annotations);
-                    if (g_screenshotTsfn != nullptr) {
-                        napi_call_threadsafe_function(g_screenshotTsfn, result, napi_tsfn_nonblocking);
-                    }
+                    ConfirmRegionCapture(ctx);
                     ctx->state = CS_Done;
                     DestroyWindow(hwnd);
                     return 0;
@@ -4356,7 +5693,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                             }
                         }
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 // 文字工具：切换激活态 + 打开/关闭子菜单（字号+颜色）
@@ -4382,7 +5719,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                             }
                         }
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 // 马赛克工具：切换激活态 + 打开/关闭子菜单（模式+块大小）
@@ -4397,7 +5734,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         ctx->popupTool = b;
                         ctx->popupOpen = true;
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 if (b == TB_Drag) {
@@ -4432,30 +5769,31 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                             ctx->popupOpen = false;
                         }
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 // 撤销：恢复上一份标注快照
                 if (b == TB_Undo) {
                     if (UndoAnnotations(ctx)) {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
                 // 重做：恢复下一份标注快照
                 if (b == TB_Redo) {
                     if (RedoAnnotations(ctx)) {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
-                // 保存到本地：弹出系统保存对话框，保存为 PNG 后关闭截图
+                // 保存到本地：弹出系统保存对话框，按所选格式保存后关闭截图
                 if (b == TB_Save) {
-                    std::wstring filePath = PromptSaveFilePath(hwnd);
+                    const ztools::ImageEncoder* encoder = g_screenshotOutput.encoder;
+                    std::wstring filePath = PromptSaveFilePath(hwnd, encoder);
                     if (!filePath.empty()) {
-                        bool saved = SaveRegionToPngFile(ctx->memDC, ctx->selection,
+                        bool saved = SaveRegionToFile(ctx->memDC, ctx->selection,
                             ctx->virtualX, ctx->virtualY, ctx->dpiScale,
-                            ctx->annotations, filePath);
+                            ctx->annotations, encoder, filePath);
                         // 无论保存成功与否，均关闭截图窗口（用户已选择保存路径）
                         // 通过回调告知 JS 结果（成功/失败），不回传路径
                         ScreenshotResult* result = new ScreenshotResult();
@@ -4498,25 +5836,25 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 if (hit == 1) {
                     ctx->mosaicRectMode = false;  // 涂抹模式
                     { RECT d = clearSel();
-                      if (IsValidRect(d)) InvalidateRect(hwnd, &d, FALSE); else InvalidateRect(hwnd, NULL, FALSE); }
+                      if (IsValidRect(d)) InvalidateDamage(hwnd, ctx, &d); else InvalidateDamage(hwnd, ctx, NULL); }
                     return 0;
                 }
                 if (hit == 2) {
                     ctx->mosaicRectMode = true;   // 框选模式
                     { RECT d = clearSel();
-                      if (IsValidRect(d)) InvalidateRect(hwnd, &d, FALSE); else InvalidateRect(hwnd, NULL, FALSE); }
+                      if (IsValidRect(d)) InvalidateDamage(hwnd, ctx, &d); else InvalidateDamage(hwnd, ctx, NULL); }
                     return 0;
                 }
                 if (hit >= 101 && hit < 200) {
                     ctx->mosaicSizeIdx = hit - 101;
                     { RECT d = clearSel();
-                      if (IsValidRect(d)) InvalidateRect(hwnd, &d, FALSE); else InvalidateRect(hwnd, NULL, FALSE); }
+                      if (IsValidRect(d)) InvalidateDamage(hwnd, ctx, &d); else InvalidateDamage(hwnd, ctx, NULL); }
                     return 0;
                 }
                 if (hit >= 201) {
                     ctx->mosaicRadiusIdx = hit - 201;
                     { RECT d = clearSel();
-                      if (IsValidRect(d)) InvalidateRect(hwnd, &d, FALSE); else InvalidateRect(hwnd, NULL, FALSE); }
+                      if (IsValidRect(d)) InvalidateDamage(hwnd, ctx, &d); else InvalidateDamage(hwnd, ctx, NULL); }
                     return 0;
                 }
             }
@@ -4535,6 +5873,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                                 PushAnnotationHistory(ctx);
                                 ctx->annotations[ctx->selectedTextAnnotation].thickness = newSize;
                                 ctx->annotations[ctx->selectedTextAnnotation].textCacheValid = false;
+                                TouchAnnotation(ctx, ctx->annotations[ctx->selectedTextAnnotation]);
                             }
                         }
                     } else {
@@ -4546,10 +5885,11 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                             if (ctx->annotations[ctx->selectedAnnotation].thickness != newThickness) {
                                 PushAnnotationHistory(ctx);
                                 ctx->annotations[ctx->selectedAnnotation].thickness = newThickness;
+                                TouchAnnotation(ctx, ctx->annotations[ctx->selectedAnnotation]);
                             }
                         }
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
                 if (hit < 0) {
@@ -4561,6 +5901,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         if (ctx->annotations[ctx->selectedTextAnnotation].color != newColor) {
                             PushAnnotationHistory(ctx);
                             ctx->annotations[ctx->selectedTextAnnotation].color = newColor;
+                            TouchAnnotation(ctx, ctx->annotations[ctx->selectedTextAnnotation]);
                         }
                     }
                     // 矢量工具改颜色：若已选中矢量标注，则作用于该标注（保持选中）；
@@ -4571,9 +5912,10 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         if (ctx->annotations[ctx->selectedAnnotation].color != newColor) {
                             PushAnnotationHistory(ctx);
                             ctx->annotations[ctx->selectedAnnotation].color = newColor;
+                            TouchAnnotation(ctx, ctx->annotations[ctx->selectedAnnotation]);
                         }
                     }
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                     return 0;
                 }
             }
@@ -4603,7 +5945,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             }
             // 2) 文字标注命中 -> 优先选中并可拖动
             //    文字与画笔/矩形等覆盖物重叠时，优先进入文字选中逻辑，避免被非文字命中分支吞掉。
-            int hitText = HitTestTextAnnotations(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC);
+            int hitText = HitTestTextAnnotations(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC);
             if (hitText >= 0) {
                 if (ctx->activeTool == TB_Text) {
                     // 选中文字标注，保持确认态。
@@ -4635,9 +5977,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->dragStartY = ctx->annotations[hitText].y1;
                     ctx->annotationOpHistoryPushed = false;
                     if (IsValidRect(dirty)) {
-                        InvalidateRect(hwnd, &dirty, FALSE);
+                        InvalidateDamage(hwnd, ctx, &dirty);
                     } else {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 } else {
@@ -4671,9 +6013,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->dragStartY = ctx->annotations[hitText].y1;
                     ctx->annotationOpHistoryPushed = false;
                     if (IsValidRect(dirty)) {
-                        InvalidateRect(hwnd, &dirty, FALSE);
+                        InvalidateDamage(hwnd, ctx, &dirty);
                     } else {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
@@ -4681,7 +6023,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
 
             // 3) 任意非文字标注命中 -> 选中并可拖拽
             //    工具激活时也优先选中已有对象（与 Figma/PowerPoint 一致），点空白才绘制。
-            int hitAnn = HitTestAnnotation(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC);
+            int hitAnn = HitTestAnnotation(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC);
             if (hitAnn >= 0 && ctx->annotations[hitAnn].type != AT_Text) {
                 // 切换选中目标：脏区 = 旧选中项（清掉其边框/手柄）∪ 新目标（显示新边框/手柄）
                 // ∪ 工具栏+popup（activeTool 可能变化导致高亮按钮位移）。
@@ -4717,9 +6059,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->annotationOpHistoryPushed = false;
                 // 触发重绘：needFullRedraw 仅是 WM_PAINT 内的提示，必须有 InvalidateRect 才会触发 WM_PAINT。
                 if (IsValidRect(dirty)) {
-                    InvalidateRect(hwnd, &dirty, FALSE);
+                    InvalidateDamage(hwnd, ctx, &dirty);
                 } else {
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                 }
                 return 0;
             }
@@ -4801,9 +6143,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     // ctx->activeTool 保持为 TB_Text
                     // 不置 needFullRedraw：进入编辑态仅改变选中边框，用局部脏区即可，避免全屏重绘。
                     if (IsValidRect(dirty)) {
-                        InvalidateRect(hwnd, &dirty, FALSE);
+                        InvalidateDamage(hwnd, ctx, &dirty);
                     } else {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
@@ -4836,9 +6178,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                         ctx->hoveredAnnotation = -1;
                         ctx->hoveredTextAnnotation = -1;
                         if (IsValidRect(dirty)) {
-                            InvalidateRect(hwnd, &dirty, FALSE);
+                            InvalidateDamage(hwnd, ctx, &dirty);
                         } else {
-                            InvalidateRect(hwnd, NULL, FALSE);
+                            InvalidateDamage(hwnd, ctx, NULL);
                         }
                     }
                     return 0;
@@ -4862,9 +6204,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->hoveredAnnotation = -1;
                 ctx->hoveredTextAnnotation = -1;
                 if (IsValidRect(dirty)) {
-                    InvalidateRect(hwnd, &dirty, FALSE);
+                    InvalidateDamage(hwnd, ctx, &dirty);
                 } else {
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                 }
             }
             return 0;
@@ -4878,21 +6220,28 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
         bool moved = (pt.x != ctx->mouseX || pt.y != ctx->mouseY);
         ctx->mouseX = pt.x;
         ctx->mouseY = pt.y;
+        if (moved && (ctx->state == CS_Idle || ctx->state == CS_Selecting) && ApplyPanelDpiForCursor(ctx)) {
+            InvalidateDamage(hwnd, ctx, NULL);
+        }
         // P2 优化：currentColor 仅用于放大镜信息面板（DrawInfoPanel），而该面板只
         // 在 CS_Idle/CS_Selecting 态绘制。其余状态读不到 currentColor，故取色惰性化，
         // 仅在这两种态更新像素色，避免每帧无谓的 GetPixel（DC 锁定读取）开销。
+        // 截屏像素可直接读时读数取自放大镜中心格，这里只为退回 StretchBlt 的情形取色。
         // 启动时已取一次初值（见线程函数），其余态保持上次值即可。
-        if (ctx->state == CS_Idle || ctx->state == CS_Selecting) {
-            ctx->currentColor = GetPixelColorFromBitmap(ctx->memDC,
-                ctx->mouseX, ctx->mouseY, ctx->virtualX, ctx->virtualY, ctx->dpiScale);
+        if ((ctx->state == CS_Idle || ctx->state == CS_Selecting) && ctx->screenPixels.Empty()) {
+            ctx->currentColor = GetPixelColorFromBitmap(ctx, ctx->mouseX, ctx->mouseY);
         }
 
         if (ctx->state == CS_Selecting) {
+            RECT oldSel = CurrentSelectionRel(ctx);
             ctx->endX = ctx->mouseX;
             ctx->endY = ctx->mouseY;
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateSelectionChange(hwnd, ctx, oldSel);
         } else if (ctx->state == CS_Idle) {
-            int newHovered = FindWindowAtPoint(ctx->windows, ctx->mouseX, ctx->mouseY);
+            int newHovered = FindWindowAtPoint(ctx->windowIndex, ctx->mouseX, ctx->mouseY);
+            if (newHovered >= 0 && newHovered != ctx->hoveredWindow) {
+                EnsureWindowTitle(ctx->windows[newHovered]);  // 标题推迟到首次悬停才读取
+            }
             ctx->hoveredWindow = newHovered;
             // 像素信息浮窗跟随鼠标：刷新旧面板位置 ∪ 新面板位置（放大镜跟随，两块都需重绘）。
             // 新面板位置在此预算（与 WM_PAINT 的 CalcPanelPosition 同源）。
@@ -4910,8 +6259,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 dirty = UnionRectSafe(dirty, InflateRectBy(hr, 5));
             }
             dirty = UnionRectSafe(dirty, InflateRectBy(ctx->lastHighlightRect, 5));
-            InvalidateRect(hwnd, &dirty, FALSE);
+            InvalidateDamage(hwnd, ctx, &dirty);
         } else if (ctx->state == CS_Resizing) {
+            RECT oldSel = CurrentSelectionRel(ctx);
             // 根据手柄调整选区边
             RECT& s = ctx->selection;
             const RECT& o = ctx->dragStartSelection;
@@ -4957,8 +6307,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     }
                 }
             }
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateSelectionChange(hwnd, ctx, oldSel);
         } else if (ctx->state == CS_Moving) {
+            RECT oldSel = CurrentSelectionRel(ctx);
             // 整体平移
             int dx = pt.x - ctx->dragStartX;
             int dy = pt.y - ctx->dragStartY;
@@ -4975,7 +6326,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             ctx->selection.top = nt;
             ctx->selection.right = nl + sw;
             ctx->selection.bottom = nt + sh;
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateSelectionChange(hwnd, ctx, oldSel);
         } else if (ctx->state == CS_Drawing) {
             // 更新正在绘制的标注终点/路径（选区相对坐标）
             if (ctx->hasCurDrawing) {
@@ -4989,7 +6340,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->curDrawing.pts.push_back(p);
                 } else if (ctx->curDrawing.type == AT_Mosaic && !ctx->curDrawing.mosaicRect) {
                     // 马赛克涂抹模式：记录路径点。揭示由 WM_PAINT 统一处理（reveal-mask 模型，
-                    // 每帧从预计算的 base 揭示蒙版区域，无需增量绘制）。
+                    // SyncMosaicReveal 只光栅化新到达的线段）。
                     POINT p = { ax, ay };
                     ctx->curDrawing.pts.push_back(p);
                 } else {
@@ -5010,7 +6361,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 } else {
                     drawDirty = InflateRectBy(mouseBox, 4);
                 }
-                InvalidateRect(hwnd, &drawDirty, FALSE);
+                InvalidateDamage(hwnd, ctx, &drawDirty);
             }
         } else if (ctx->state == CS_TextEditing) {
             // 文字编辑态：拖动选择文字
@@ -5067,6 +6418,8 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 if (n.bottom - n.top < 2) n.bottom = n.top + 2;
                 TransformAnnotationByBox(a, o, n);
             }
+            TouchAnnotation(ctx, a);
+            MarkAnnotationsChanged(ctx);
             InvalidateAnnotationOp(hwnd, ctx, MeasureAnnotationBounds(ctx->annotations[idx], ctx->backDC));
         } else if (ctx->draggingAnnotation >= 0) {
             // 非文字标注整体拖拽：对按下时快照做 dx/dy 平移后写回（避免累积误差）
@@ -5097,6 +6450,8 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     a.x1 += dx; a.y1 += dy;
                     break;
             }
+            TouchAnnotation(ctx, a);
+            MarkAnnotationsChanged(ctx);
             InvalidateAnnotationOp(hwnd, ctx, MeasureAnnotationBounds(ctx->annotations[idx], ctx->backDC));
         } else if (ctx->draggingTextAnnotation >= 0) {
             // 拖动文字标注位置
@@ -5108,6 +6463,8 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             }
             ctx->annotations[ctx->draggingTextAnnotation].x1 = ctx->dragStartX + dx;
             ctx->annotations[ctx->draggingTextAnnotation].y1 = ctx->dragStartY + dy;
+            TouchAnnotation(ctx, ctx->annotations[ctx->draggingTextAnnotation]);
+            MarkAnnotationsChanged(ctx);
             InvalidateAnnotationOp(hwnd, ctx, MeasureAnnotationBounds(ctx->annotations[ctx->draggingTextAnnotation], ctx->backDC));
         } else if (ctx->state == CS_Confirmed) {
             // hover 手柄/工具栏/文字/非文字标注变化需重绘以更新光标提示与高亮
@@ -5115,7 +6472,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             int mxRel = ctx->mouseX - ctx->virtualX;
             int myRel = ctx->mouseY - ctx->virtualY;
             int tb = HitTestToolbar(mxRel, myRel, ctx->toolbarRect, ctx->toolbarMetrics);
-            int ht = HitTestTextAnnotations(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC);
+            int ht = HitTestTextAnnotations(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC);
             // 非文字标注 hover：优先用选中项的手柄命中（箭头=端点；矩形/圆=8 手柄；画笔=无），否则普通命中
             int ha = -1;
             if (ctx->selectedAnnotation >= 0 && ctx->selectedAnnotation < (int)ctx->annotations.size()) {
@@ -5127,7 +6484,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 }
             }
             if (ha < 0) {
-                ha = HitTestAnnotation(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC);
+                ha = HitTestAnnotation(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC);
             }
             // 仅当 hover 状态真正变化时才重绘（去掉纯 moved 无变化的重绘，减少无意义全屏帧）。
             // 脏区域 = 各变化项的旧位置 ∪ 新位置（工具栏/标注边框高亮变化）。
@@ -5176,10 +6533,10 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->hoveredTextAnnotation = ht;
                 ctx->hoveredAnnotation = ha;
                 if (IsValidRect(dirty)) {
-                    InvalidateRect(hwnd, &dirty, FALSE);
+                    InvalidateDamage(hwnd, ctx, &dirty);
                 } else {
                     // 兜底（理论上不会到这里）
-                    InvalidateRect(hwnd, NULL, FALSE);
+                    InvalidateDamage(hwnd, ctx, NULL);
                 }
             }
         }
@@ -5187,6 +6544,11 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
     }
 
     case WM_LBUTTONUP: {
+        if (ctx->repaintMeter.Active()) {
+            ztools::RepaintStats repaint = ctx->repaintMeter.End();
+            std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+            g_lastRepaint = repaint;
+        }
         if (ctx->state == CS_Selecting) {
             int w = abs(ctx->endX - ctx->startX);
             int h = abs(ctx->endY - ctx->startY);
@@ -5194,7 +6556,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             RECT finalRect;
             if (w <= 1 && h <= 1) {
                 // 点击 -> 使用悬停窗口矩形
-                int idx = FindWindowAtPoint(ctx->windows, ctx->mouseX, ctx->mouseY);
+                int idx = FindWindowAtPoint(ctx->windowIndex, ctx->mouseX, ctx->mouseY);
                 if (idx >= 0) {
                     finalRect = ctx->windows[idx].rect;
                 } else {
@@ -5226,11 +6588,11 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
 
             // 进入确认态（可调整/拖动/工具栏），而非直接完成
             EnterConfirmed(ctx, finalRect);
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateDamage(hwnd, ctx, NULL);
         } else if (ctx->state == CS_Resizing || ctx->state == CS_Moving) {
             // 调整/拖动结束 -> 回到确认态
             EnterConfirmed(ctx, ctx->selection);
-            InvalidateRect(hwnd, NULL, FALSE);
+            InvalidateDamage(hwnd, ctx, NULL);
         } else if (ctx->state == CS_Drawing) {
             // 绘制结束 -> 提交标注（仅在有有效尺寸时）
             bool valid = false;
@@ -5253,12 +6615,12 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             }
             if (valid) {
                 PushAnnotationHistory(ctx);
+                TouchAnnotation(ctx, ctx->curDrawing);
                 ctx->annotations.push_back(ctx->curDrawing);
                 // reveal-mask 模型：base 与标注无关，下一帧 WM_PAINT 自动把新蒙版揭示出来。
             }
             ctx->hasCurDrawing = false;
             ctx->curDrawing = {};
-            ctx->mosaicDrawLastIdx = 0;
             ctx->state = CS_Confirmed;
             ctx->needFullRedraw = true;
         } else if (ctx->state == CS_TextEditing) {
@@ -5294,11 +6656,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
     case WM_LBUTTONDBLCLK: {
         // 确认态下双击选区内部 -> 确认截图
         if ((ctx->state == CS_Confirmed) && PointInRect(ctx->mouseX, ctx->mouseY, ctx->selection)) {
-            ScreenshotResult* result = ExtractRegionResult(ctx->memDC, ctx->selection,
-                ctx->virtualX, ctx->virtualY, ctx->dpiScale, ctx->annotations);
-            if (g_screenshotTsfn != nullptr) {
-                napi_call_threadsafe_function(g_screenshotTsfn, result, napi_tsfn_nonblocking);
-            }
+            ConfirmRegionCapture(ctx);
             ctx->state = CS_Done;
             DestroyWindow(hwnd);
         }
@@ -5327,7 +6685,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                 ctx->textCaretPos = 0;
                 ctx->state = CS_Confirmed;
                 ctx->needFullRedraw = true;
-                InvalidateRect(hwnd, NULL, FALSE);
+                InvalidateDamage(hwnd, ctx, NULL);
                 return 0;
             }
             // 其它状态：ESC 取消截图
@@ -5352,22 +6710,19 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     textAnnotation.y1 = ctx->textAnchorY;
                     textAnnotation.text = ctx->textBuf;
                     PushAnnotationHistory(ctx);
+                    TouchAnnotation(ctx, textAnnotation);
                     ctx->annotations.push_back(textAnnotation);
                 }
                 ctx->textBuf.clear();
                 ctx->textCaretPos = 0;
                 ctx->state = CS_Confirmed;
                 ctx->needFullRedraw = true;
-                InvalidateRect(hwnd, NULL, FALSE);
+                InvalidateDamage(hwnd, ctx, NULL);
                 return 0;
             }
             // 确认态：Enter 确认截图
             if (ctx->state == CS_Confirmed) {
-                ScreenshotResult* result = ExtractRegionResult(ctx->memDC, ctx->selection,
-                    ctx->virtualX, ctx->virtualY, ctx->dpiScale, ctx->annotations);
-                if (g_screenshotTsfn != nullptr) {
-                    napi_call_threadsafe_function(g_screenshotTsfn, result, napi_tsfn_nonblocking);
-                }
+                ConfirmRegionCapture(ctx);
                 ctx->state = CS_Done;
                 DestroyWindow(hwnd);
             }
@@ -5400,9 +6755,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->popupTool = -1;
                     ctx->popupOpen = false;
                     if (IsValidRect(dirty)) {
-                        InvalidateRect(hwnd, &dirty, FALSE);
+                        InvalidateDamage(hwnd, ctx, &dirty);
                     } else {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
@@ -5420,9 +6775,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
                     ctx->popupTool = -1;
                     ctx->popupOpen = false;
                     if (IsValidRect(dirty)) {
-                        InvalidateRect(hwnd, &dirty, FALSE);
+                        InvalidateDamage(hwnd, ctx, &dirty);
                     } else {
-                        InvalidateRect(hwnd, NULL, FALSE);
+                        InvalidateDamage(hwnd, ctx, NULL);
                     }
                     return 0;
                 }
@@ -5583,7 +6938,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             }
             // 非文字标注悬停 -> 四向箭头（可拖动/选中），与下方文字悬停判定并列
             {
-                int hit = HitTestAnnotation(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC);
+                int hit = HitTestAnnotation(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC);
                 if (hit >= 0 && ctx->annotations[hit].type != AT_Text) {
                     SetCursor(LoadCursorW(NULL, (LPCWSTR)IDC_SIZEALL));
                     return TRUE;
@@ -5595,7 +6950,7 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
             // hoveredTextAnnotation 存在滞后，导致 WM_SETCURSOR 看到过期值。
             // 文字工具未激活时，悬停已确认文字 -> 拖动光标；
             // 文字工具激活时，悬停已确认文字 -> 仍为拖动光标（可选中改属性）。
-            if (HitTestTextAnnotations(ctx->annotations, ctx->mouseX, ctx->mouseY, ctx->backDC) >= 0) {
+            if (HitTestTextAnnotations(ctx, ctx->mouseX, ctx->mouseY, ctx->backDC) >= 0) {
                 SetCursor(LoadCursorW(NULL, (LPCWSTR)IDC_SIZEALL));
                 return TRUE;
             }
@@ -5641,15 +6996,9 @@ static LRESULT CALLBACK ScreenshotOverlayWndProc(HWND hwnd, UINT msg, WPARAM wPa
 
 // 截图线程（预截屏 + 双缓冲架构）
 static void ScreenshotCaptureThread() {
+    const auto sessionStart = std::chrono::steady_clock::now();
     // 设置 DPI 感知
-    typedef DPI_AWARENESS_CONTEXT (WINAPI *SetThreadDpiAwarenessContextProc)(DPI_AWARENESS_CONTEXT);
-    HMODULE user32 = GetModuleHandleW(L"user32.dll");
-    if (user32) {
-        auto setDpiProc = (SetThreadDpiAwarenessContextProc)GetProcAddress(user32, "SetThreadDpiAwarenessContext");
-        if (setDpiProc) {
-            setDpiProc(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
-        }
-    }
+    SetThreadPerMonitorDpiAware();
 
     double uiScale = GetDpiScaleFactor();
     double dpiScale = uiScale;
@@ -5658,18 +7007,19 @@ static void ScreenshotCaptureThread() {
     HDC memDC = NULL;
     HBITMAP screenBitmap = NULL;
     int vx, vy, vw, vh;
-    if (!AcquireScreenshotBase(memDC, screenBitmap, vx, vy, vw, vh, dpiScale)) {
-        g_isCapturing = false;
+    if (!AcquireScreenshotBase(memDC, screenBitmap, vx, vy, vw, vh, dpiScale, g_screenshotCursorMonitorOnly)) {
+        FinishCaptureSession();
         return;
     }
 
     // 创建双缓冲
     HDC backDC = NULL;
     HBITMAP backBmp = NULL;
-    if (!CreateBackBuffer(backDC, backBmp, vw, vh)) {
+    ztools::ImageView backPixels;
+    if (!CreateBackBuffer(backDC, backBmp, backPixels, vw, vh)) {
         DeleteDC(memDC);
         DeleteObject(screenBitmap);
-        g_isCapturing = false;
+        FinishCaptureSession();
         return;
     }
 
@@ -5680,8 +7030,6 @@ static void ScreenshotCaptureThread() {
     SCPanelMetrics panelMetrics = CalcPanelMetrics(uiScale);
     SCGdiResources gdi;
     gdi.Init(panelMetrics.fontPx, panelMetrics.crosshair);
-    // 创建选区外遮罩缓冲（需虚拟屏幕尺寸）
-    gdi.InitMask(vw, vh);
 
     // 初始化上下文
     CaptureContext ctx = {};
@@ -5695,6 +7043,7 @@ static void ScreenshotCaptureThread() {
     ctx.memDC = memDC;
     ctx.backDC = backDC;
     ctx.backBitmap = backBmp;
+    ctx.backPixels = backPixels;
     ctx.lastPanelRect = {0,0,0,0};
     ctx.lastSelectionRect = {0,0,0,0};
     ctx.lastLabelRect = {0,0,0,0};
@@ -5716,10 +7065,14 @@ static void ScreenshotCaptureThread() {
     ctx.activeTool = -1;
     ctx.popupTool = -1;
     ctx.needFullRedraw = true;
+    ctx.damage.Reset(ztools::IntRect(0, 0, vw, vh));
     ctx.dpiScale = dpiScale;
     ctx.gdi = gdi;
     ctx.panelMetrics = panelMetrics;
+    ctx.monitors = EnumerateMonitorLayout();
+    ctx.panelDpi = (int)(uiScale * 96 + 0.5);
     ctx.windows = std::move(windows);
+    BuildWindowIndex(ctx.windowIndex, ctx.windows);
 
     // 工具栏几何（按 DPI 缩放）+ 图标位图缓存（按 DPI 预渲染）
     ctx.toolbarMetrics = CalcToolbarMetrics(uiScale);
@@ -5727,12 +7080,12 @@ static void ScreenshotCaptureThread() {
     // GDI+ 会话级初始化（必须在 InitMosaicBrushCursors 及任何 GDI+ 调用之前）：
     // 会话内单次 Startup，避免每帧反复初始化导致拖拽卡顿。
     if (!InitGdipResources(&ctx)) {
-        gdi.Cleanup();
+        ctx.gdi.Cleanup();
         ctx.iconCache.Cleanup();
         DeleteDC(backDC); DeleteObject(backBmp);
         DeleteDC(memDC); DeleteObject(screenBitmap);
         g_captureCtx = nullptr;
-        g_isCapturing = false;
+        FinishCaptureSession();
         return;
     }
     // 涂抹光标缓存（按半径预生成，DPI 缩放半径）
@@ -5749,12 +7102,16 @@ static void ScreenshotCaptureThread() {
     ctx.mosaicSizeIdx = SC_DEFAULT_MOSAIC_IDX;
     ctx.mosaicRadiusIdx = SC_DEFAULT_MOSAIC_RADIUS_IDX;
     ctx.mosaicRectMode = false;  // 默认涂抹模式
-    ctx.mosaicBaseDC = NULL;
-    ctx.mosaicBaseBitmap = NULL;
-    ctx.mosaicBaseW = 0;
-    ctx.mosaicBaseH = 0;
-    ctx.mosaicBaseBlockPx = 0;
-    ctx.mosaicDrawLastIdx = 0;
+    ctx.screenDib = NULL;
+    ctx.logicalBaseBitmap = NULL;
+    ctx.logicalBaseDC = NULL;
+    ctx.mosaicRevealDC = NULL;
+    ctx.mosaicRevealBitmap = NULL;
+    ctx.annotationLayerDC = NULL;
+    ctx.annotationLayerBitmap = NULL;
+    ctx.annotationLayerRect = ztools::IntRect();
+    ctx.annotationLayerEntries.clear();
+    ctx.mosaicRevealBlockPx = 0;
     ctx.hasCurDrawing = false;
     // 文字编辑初始化
     ctx.textBuf.clear();
@@ -5780,15 +7137,24 @@ static void ScreenshotCaptureThread() {
     ctx.annotationDragStartX = 0;
     ctx.annotationDragStartY = 0;
     ctx.annotationOpHistoryPushed = false;
+    ctx.annotationsVersion = 1;
+    ctx.annotationRevision = 0;
+    ctx.hitIndexVersion = 0;
     ctx.dragStartAnnotation = {};
     ctx.annotationResizeStartBox = { 0, 0, 0, 0 };
 
+    // 截屏位图是 DIB section：映射其像素，取色从第一帧起就是内存读取
+    EnsureScreenPixels(&ctx);
+    // 高 DPI：窗口出现前一次性生成逻辑分辨率底图，首帧起背景即为 1:1 BitBlt
+    PrepareLogicalBase(&ctx);
+
     // 获取初始鼠标位置和颜色
     POINT pt;
     GetCursorPos(&pt);
     ctx.mouseX = pt.x;
     ctx.mouseY = pt.y;
-    ctx.currentColor = GetPixelColorFromBitmap(memDC, pt.x, pt.y, vx, vy, dpiScale);
+    ctx.currentColor = GetPixelColorFromBitmap(&ctx, pt.x, pt.y);
+    ApplyPanelDpiForCursor(&ctx);
 
     g_captureCtx = &ctx;
 
@@ -5801,12 +7167,14 @@ static void ScreenshotCaptureThread() {
     wc.lpszClassName = L"ZToolsScreenshotOverlay";
 
     if (!RegisterClassExW(&wc)) {
-        gdi.Cleanup();
+        ctx.gdi.Cleanup();
         ctx.iconCache.Cleanup();
+        FreeLogicalBase(&ctx);
+        FreeScreenPixels(&ctx);
         DeleteDC(backDC); DeleteObject(backBmp);
         DeleteDC(memDC); DeleteObject(screenBitmap);
         g_captureCtx = nullptr;
-        g_isCapturing = false;
+        FinishCaptureSession();
         return;
     }
 
@@ -5822,18 +7190,31 @@ static void ScreenshotCaptureThread() {
 
     if (g_screenshotOverlayWindow == NULL) {
         UnregisterClassW(L"ZToolsScreenshotOverlay", GetModuleHandle(NULL));
-        gdi.Cleanup();
+        ctx.gdi.Cleanup();
         ctx.iconCache.Cleanup();
+        FreeLogicalBase(&ctx);
+        FreeScreenPixels(&ctx);
         DeleteDC(backDC); DeleteObject(backBmp);
         DeleteDC(memDC); DeleteObject(screenBitmap);
         g_captureCtx = nullptr;
-        g_isCapturing = false;
+        FinishCaptureSession();
         return;
     }
 
     ShowWindow(g_screenshotOverlayWindow, SW_SHOW);
     SetForegroundWindow(g_screenshotOverlayWindow);
 
+    // 启动耗时（截屏到覆盖层出现），按本次截到的显示器数量记录
+    {
+        const ztools::IntRect captured(vx, vy, vw, vh);
+        int capturedMonitors = 0;
+        for (const ztools::MonitorDesc& m : ctx.monitors.monitors()) {
+            if (!m.bounds.Intersect(captured).Empty()) capturedMonitors++;
+        }
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        g_captureStartMeter.Record(capturedMonitors, std::chrono::steady_clock::now() - sessionStart);
+    }
+
     // 消息循环
     MSG msg;
     while (true) {
@@ -5853,9 +7234,9 @@ static void ScreenshotCaptureThread() {
                     // 仅刷新光标区域（光标位置不变，只切换可见性）。首次无缓存时全屏。
                     if (ctx.hasLastCaret) {
                         RECT r = InflateRectBy(ctx.lastCaretRect, 2);
-                        InvalidateRect(g_screenshotOverlayWindow, &r, FALSE);
+                        InvalidateDamage(g_screenshotOverlayWindow, &ctx, &r);
                     } else {
-                        InvalidateRect(g_screenshotOverlayWindow, NULL, FALSE);
+                        InvalidateDamage(g_screenshotOverlayWindow, &ctx, NULL);
                     }
                 }
             }
@@ -5881,37 +7262,191 @@ static void ScreenshotCaptureThread() {
 
     // 清理
     g_captureCtx = nullptr;
-    gdi.Cleanup();
+    ctx.gdi.Cleanup();
     ctx.iconCache.Cleanup();
     FreeMosaicBase(&ctx);
+    FreeAnnotationLayer(&ctx);
+    FreeLogicalBase(&ctx);
+    FreeScreenPixels(&ctx);
     FreeMosaicBrushCursors(&ctx);
     DeleteDC(backDC); DeleteObject(backBmp);
     DeleteDC(memDC); DeleteObject(screenBitmap);
     // GDI+ 会话级资源最后释放（所有 GDI+ 调用均已结束后才可 Shutdown）
     ShutdownGdipResources(&ctx);
     UnregisterClassW(L"ZToolsScreenshotOverlay", GetModuleHandle(NULL));
-    g_isCapturing = false;
+    FinishCaptureSession();
 }
 
-// 启动区域截图
-Napi::Value StartRegionCapture(const Napi::CallbackInfo& info) {
-    return StartRegionCaptureWithPrimedFrame(info);
+// ==================== 滚动长截图 ====================
+// 选区（物理像素屏幕坐标，通常取自区域截图结果的 x / y / width / height）由 JS 给出。
+// 工作线程把鼠标移到选区中心，反复注入滚轮、等画面稳定后截取选区，交给 core/scroll_stitch 增量拼接；
+// 到底、达到高度上限、调用 stopScrollingCapture 时结束并输出，按 Esc 取消。
+// 拼接过程中结果按瓦片增长，只在输出时落成一张 DIB，再走与区域截图相同的导出流水线（编码 + 剪贴板）。
+
+struct ScrollingCaptureRequest {
+    ztools::IntRect region;
+    ztools::ScrollStitchOptions stitch;
+};
+
+static std::atomic<bool> g_scrollingCaptureStop(false);
+
+static const int SC_SCROLL_POLL_MS = 30;          // 等待滚动动画结束时的截帧间隔
+static const int SC_SCROLL_SETTLE_MS = 600;       // 单步等待画面稳定的上限
+static const int SC_SCROLL_END_STEPS = 2;         // 连续这么多步画面不动视为到底
+static const int SC_SCROLL_MAX_MISSES = 3;        // 连续找不到重叠（已减小步长重试）的次数上限
+static const int SC_SCROLL_MAX_TICKS = 10;        // 每步滚轮格数上限
+static const int SC_SCROLLBAR_WIDTH = 17;         // 96 DPI 下的系统滚动条宽度，行签名忽略选区右侧这么多列
+
+static bool GrabScreenRegion(HDC screenDC, HDC memDC, const ztools::IntRect& r) {
+    const BOOL ok = BitBlt(memDC, 0, 0, r.w, r.h, screenDC, r.x, r.y, SRCCOPY | CAPTUREBLT);
+    GdiFlush();
+    return ok != FALSE;
 }
 
-// 供 JS 主动触发首帧预抓取。
-Napi::Value PrimeScreenshotFrame(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    const bool success = PrimeScreenshotFrameNow();
-    return Napi::Boolean::New(env, success);
+// 向鼠标下的窗口注入 ticks 格滚轮（正数向下）
+static void SendWheelTicks(int ticks) {
+    INPUT input = {};
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+    input.mi.mouseData = static_cast<DWORD>(-WHEEL_DELTA * ticks);
+    SendInput(1, &input, sizeof(INPUT));
 }
 
-Napi::Value StartRegionCaptureWithPrimedFrame(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
+// 反复截取选区直到相邻两次逐行相同（平滑滚动的动画结束）或超时；frame 留下最后一次的画面，
+// next 留下它的行签名（与拼接用同样的忽略列，拼接时直接复用；渐隐的滚动条也不会拖到超时）
+static bool WaitForStableRegion(HDC screenDC, HDC memDC, const ztools::IntRect& r, const ztools::ImageView& frame,
+                                const ztools::ScrollStitchOptions& stitch,
+                                std::vector<std::uint64_t>& last, std::vector<std::uint64_t>& next) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SC_SCROLL_SETTLE_MS);
+    Sleep(SC_SCROLL_POLL_MS);
+    if (!GrabScreenRegion(screenDC, memDC, r)) return false;
+    ztools::HashRows(frame, stitch.ignoreLeft, stitch.ignoreRight, last);
+    for (;;) {
+        Sleep(SC_SCROLL_POLL_MS);
+        if (!GrabScreenRegion(screenDC, memDC, r)) return false;
+        ztools::HashRows(frame, stitch.ignoreLeft, stitch.ignoreRight, next);
+        if (next == last || std::chrono::steady_clock::now() >= deadline) return true;
+        last.swap(next);
+    }
+}
 
-    if (g_isCapturing) {
-        Napi::Error::New(env, "Screenshot already in progress").ThrowAsJavaScriptException();
-        return env.Undefined();
+static void ScrollingCaptureThread(ScrollingCaptureRequest request) {
+    SetThreadPerMonitorDpiAware();
+    const napi_threadsafe_function tsfn = g_screenshotTsfn;
+    const ztools::IntRect r = request.region;
+    // 滚动条宽度按选区所在显示器的 DPI 换算
+    const ztools::MonitorLayout monitors = EnumerateMonitorLayout();
+    request.stitch.ignoreRight = ztools::ScaleForDpi(SC_SCROLLBAR_WIDTH, monitors.DpiAt(r.x + r.w / 2, r.y + r.h / 2));
+
+    HDC screenDC = GetDC(NULL);
+    HDC memDC = screenDC ? CreateCompatibleDC(screenDC) : NULL;
+    ztools::ImageView frame;
+    HBITMAP frameBmp = memDC ? CreateSurfaceBitmap(r.w, r.h, frame) : NULL;
+    HGDIOBJ oldBmp = frameBmp ? SelectObject(memDC, frameBmp) : NULL;
+
+    ztools::ScrollStitcher stitcher(request.stitch);
+    ztools::ScrollPacer pacer(r.h, SC_SCROLL_MAX_TICKS);
+    POINT savedCursor = {};
+    GetCursorPos(&savedCursor);
+    SetCursorPos(r.x + r.w / 2, r.y + r.h / 2);
+
+    bool ok = frameBmp != NULL && GrabScreenRegion(screenDC, memDC, r);
+    if (ok) ok = stitcher.Begin(frame).status != ztools::StitchStatus::NoOverlap;
+    bool cancelled = false;
+    int still = 0, misses = 0;
+    std::vector<std::uint64_t> settleA, settleB;
+    while (ok && !stitcher.full() && !g_scrollingCaptureStop) {
+        if (GetAsyncKeyState(VK_ESCAPE) & 0x8000) {
+            cancelled = true;
+            break;
+        }
+        const int ticks = pacer.ticks();
+        SendWheelTicks(ticks);
+        if (!WaitForStableRegion(screenDC, memDC, r, frame, request.stitch, settleA, settleB)) break;
+        const ztools::StitchStep step = stitcher.Append(frame, settleB);
+        pacer.OnStep(step, ticks);
+        if (step.status == ztools::StitchStatus::Unchanged) {
+            if (++still >= SC_SCROLL_END_STEPS) break;
+            continue;
+        }
+        still = 0;
+        if (step.status == ztools::StitchStatus::NoOverlap) {
+            // 滚过头：滚回上一帧的位置，按减半后的步长重试
+            if (++misses > SC_SCROLL_MAX_MISSES) break;
+            SendWheelTicks(-ticks);
+            if (!WaitForStableRegion(screenDC, memDC, r, frame, request.stitch, settleA, settleB)) break;
+            continue;
+        }
+        misses = 0;
+    }
+    SetCursorPos(savedCursor.x, savedCursor.y);
+    if (oldBmp) SelectObject(memDC, oldBmp);
+    if (frameBmp) DeleteObject(frameBmp);
+    if (memDC) DeleteDC(memDC);
+    if (screenDC) ReleaseDC(NULL, screenDC);
+
+    // 输出：尺寸事件带选区与拼接后的尺寸，随后与区域截图一样在后台编码、写剪贴板
+    const auto confirmedAt = std::chrono::steady_clock::now();
+    const ztools::TiledImage& image = stitcher.image();
+    ScreenshotResult* result = new ScreenshotResult();
+    result->success = false;
+    result->x = r.x;
+    result->y = r.y;
+    result->x2 = r.Right();
+    result->y2 = r.Bottom();
+    result->width = image.width();
+    result->height = image.height();
+    HBITMAP finalBmp = NULL;
+    ztools::ImageView finalView;
+    if (ok && !cancelled && image.height() > 0) {
+        finalBmp = CreateSurfaceBitmap(image.width(), image.height(), finalView);
+    }
+    if (finalBmp) {
+        image.CopyTo(0, finalView);
+        result->success = true;
+        result->previewReady = true;
+        result->exportId = g_nextExportId++;
+    }
+    const std::uint64_t exportId = result->exportId;
+    if (tsfn != nullptr) {
+        napi_call_threadsafe_function(tsfn, result, napi_tsfn_nonblocking);
+    } else {
+        delete result;
+    }
+    if (finalBmp) SubmitScreenshotExport(tsfn, exportId, confirmedAt, finalBmp, finalView);
+    FinishCaptureSession();
+}
+
+// 解析 info[index] 中的输出选项 { format?, quality? }（默认 PNG）；非法时抛出 TypeError 并返回 false
+static bool ParseScreenshotOutput(Napi::Env env, const Napi::CallbackInfo& info, size_t index, ScreenshotOutput& output) {
+    output.encoder = ScreenshotEncoders().Find("png");
+    if (info.Length() <= index || !info[index].IsObject()) return true;
+    Napi::Object options = info[index].As<Napi::Object>();
+    Napi::Value format = options.Get("format");
+    if (format.IsString()) {
+        output.encoder = ScreenshotEncoders().Find(format.As<Napi::String>().Utf8Value());
+        if (!output.encoder) {
+            Napi::TypeError::New(env, "Unsupported screenshot format (expected png, jpeg, qoi or raw)")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    Napi::Value quality = options.Get("quality");
+    if (quality.IsNumber()) {
+        output.options.quality = (std::max)(1, (std::min)(100, quality.As<Napi::Number>().Int32Value()));
+    } else if (quality.IsString() &&
+               !ztools::ParseQualityPreset(quality.As<Napi::String>().Utf8Value(), output.options.quality)) {
+        Napi::TypeError::New(env, "Unknown quality preset (expected high, balanced or small)")
+            .ThrowAsJavaScriptException();
+        return false;
     }
+    return true;
+}
+
+// 区域截图与滚动长截图共用的会话开始：记下输出格式、为 info[0] 的回调建立线程安全函数、暂停首帧保温。
+// 失败时抛出异常并返回 false；成功后由工作线程在结束时调用 FinishCaptureSession
+static bool BeginScreenshotSession(Napi::Env env, const Napi::CallbackInfo& info, const ScreenshotOutput& output) {
+    g_screenshotOutput = output;
 
     // 可选的回调函数
     if (info.Length() > 0 && info[0].IsFunction()) {
@@ -5927,14 +7462,212 @@ Napi::Value StartRegionCaptureWithPrimedFrame(const Napi::CallbackInfo& info) {
 
         if (status != napi_ok) {
             Napi::Error::New(env, "Failed to create threadsafe function").ThrowAsJavaScriptException();
-            return env.Undefined();
+            return false;
         }
     }
 
+    {
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        g_warmFramePolicy.Suspend();
+    }
+    // 卸载前把延迟渲染的剪贴板截图落成真实数据（每个 env 注册一次）
+    static bool clipboardFlushHookAdded = false;
+    if (!clipboardFlushHookAdded) {
+        clipboardFlushHookAdded = napi_add_env_cleanup_hook(env, FlushClipboardOwner, nullptr) == napi_ok;
+    }
     g_isCapturing = true;
+    return true;
+}
+
+// 启动区域截图
+Napi::Value StartRegionCapture(const Napi::CallbackInfo& info) {
+    return StartRegionCaptureWithPrimedFrame(info);
+}
+
+// 供 JS 主动触发首帧预抓取。
+Napi::Value PrimeScreenshotFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const bool success = PrimeScreenshotFrameNow();
+    return Napi::Boolean::New(env, success);
+}
+
+Napi::Value StartRegionCaptureWithPrimedFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (g_isCapturing) {
+        Napi::Error::New(env, "Screenshot already in progress").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // 可选的输出选项 { format?: 'png' | 'jpeg' | 'qoi' | 'raw', quality?: 1..100 | 'high' | 'balanced' | 'small',
+    //                  monitor?: 'all' | 'cursor' }
+    ScreenshotOutput output;
+    bool cursorMonitorOnly = false;
+    if (!ParseScreenshotOutput(env, info, 1, output)) return env.Undefined();
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Value monitor = info[1].As<Napi::Object>().Get("monitor");
+        if (monitor.IsString()) {
+            std::string scope = monitor.As<Napi::String>().Utf8Value();
+            if (scope != "all" && scope != "cursor") {
+                Napi::TypeError::New(env, "Unknown monitor scope (expected all or cursor)").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            cursorMonitorOnly = scope == "cursor";
+        }
+    }
+    if (!BeginScreenshotSession(env, info, output)) return env.Undefined();
+    g_screenshotCursorMonitorOnly = cursorMonitorOnly;
 
     g_screenshotThread = std::thread(ScreenshotCaptureThread);
     g_screenshotThread.detach();
 
     return env.Undefined();
 }
+
+// 滚动长截图：startScrollingCapture(callback, { x, y, width, height, maxHeight?, format?, quality? })。
+// 选区为物理像素屏幕坐标；回调事件与区域截图相同（先尺寸事件，后编码事件）
+Napi::Value StartScrollingCapture(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (g_isCapturing) {
+        Napi::Error::New(env, "Screenshot already in progress").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected region { x, y, width, height }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Object options = info[1].As<Napi::Object>();
+    int values[4] = {};
+    const char* keys[4] = {"x", "y", "width", "height"};
+    for (int i = 0; i < 4; i++) {
+        Napi::Value v = options.Get(keys[i]);
+        if (!v.IsNumber()) {
+            Napi::TypeError::New(env, "Expected region { x, y, width, height }").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        values[i] = v.As<Napi::Number>().Int32Value();
+    }
+    ScrollingCaptureRequest request;
+    request.region = ztools::IntRect(values[0], values[1], values[2], values[3]);
+    if (request.region.w < SC_MIN_SELECTION || request.region.h < SC_MIN_SELECTION) {
+        Napi::RangeError::New(env, "Scrolling capture region is too small").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Value maxHeight = options.Get("maxHeight");
+    if (maxHeight.IsNumber()) {
+        request.stitch.maxHeight = (std::max)(request.region.h, maxHeight.As<Napi::Number>().Int32Value());
+    }
+
+    ScreenshotOutput output;
+    if (!ParseScreenshotOutput(env, info, 1, output)) return env.Undefined();
+    if (!BeginScreenshotSession(env, info, output)) return env.Undefined();
+
+    g_scrollingCaptureStop = false;
+    std::thread(ScrollingCaptureThread, request).detach();
+    return env.Undefined();
+}
+
+// 结束滚动长截图并输出已拼接的部分（没有进行中的滚动截图时无效果）
+Napi::Value StopScrollingCapture(const Napi::CallbackInfo& info) {
+    g_scrollingCaptureStop = true;
+    return info.Env().Undefined();
+}
+
+// 保温模式：setScreenshotWarmMode(enabled, { ttlMs?, intervalMs?, cpuBudget? })。
+// 开启后后台按速率 / CPU 预算持续刷新首帧，截图开始时直接使用；ttlMs 同时作用于显式预抓取的帧。
+Napi::Value SetScreenshotWarmMode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Expected enabled boolean").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const bool enabled = info[0].As<Napi::Boolean>().Value();
+    ztools::WarmFrameConfig config;
+    {
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        config = g_warmFramePolicy.config();
+    }
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        auto readMs = [&](const char* key, ztools::WarmFrameConfig::Duration& out) {
+            Napi::Value v = options.Get(key);
+            if (v.IsNumber()) {
+                out = std::chrono::duration_cast<ztools::WarmFrameConfig::Duration>(
+                    std::chrono::duration<double, std::milli>(v.As<Napi::Number>().DoubleValue()));
+            }
+        };
+        readMs("ttlMs", config.ttl);
+        readMs("intervalMs", config.minInterval);
+        Napi::Value budget = options.Get("cpuBudget");
+        if (budget.IsNumber()) config.cpuBudget = budget.As<Napi::Number>().DoubleValue();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        g_warmFramePolicy.Configure(config);
+        g_warmFramePolicy.SetWarm(enabled, std::chrono::steady_clock::now());
+        if (enabled && !g_warmFrameThreadStarted) {
+            g_warmFrameThreadStarted = true;
+            std::thread(WarmFrameThread).detach();
+        }
+    }
+    g_warmFrameCv.notify_all();
+    return env.Undefined();
+}
+
+// 首帧统计：刷新 / 失败 / 丢弃次数，截图开始时的命中 / 过期 / 无帧次数与帧年龄（毫秒），
+// 按截取显示器数量分组的截图启动耗时，以及最近一次交互（按下到松开）的重绘量
+Napi::Value GetScreenshotFrameStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ztools::WarmFrameStats stats;
+    ztools::WarmFrameConfig config;
+    std::vector<ztools::CaptureStartMeter::Bucket> captureStart;
+    ztools::RepaintStats repaint;
+    bool warm = false;
+    {
+        std::lock_guard<std::mutex> lock(g_primedScreenshotFrameMutex);
+        stats = g_warmFramePolicy.stats();
+        config = g_warmFramePolicy.config();
+        warm = g_warmFramePolicy.warm();
+        captureStart = g_captureStartMeter.buckets();
+        repaint = g_lastRepaint;
+    }
+    auto ms = [](ztools::WarmFrameStats::Duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("warm", Napi::Boolean::New(env, warm));
+    result.Set("ttlMs", Napi::Number::New(env, ms(config.ttl)));
+    result.Set("intervalMs", Napi::Number::New(env, ms(config.minInterval)));
+    result.Set("cpuBudget", Napi::Number::New(env, config.cpuBudget));
+    result.Set("refreshes", Napi::Number::New(env, stats.refreshes));
+    result.Set("failures", Napi::Number::New(env, stats.failures));
+    result.Set("dropped", Napi::Number::New(env, stats.dropped));
+    result.Set("hits", Napi::Number::New(env, stats.hits));
+    result.Set("stale", Napi::Number::New(env, stats.stale));
+    result.Set("empty", Napi::Number::New(env, stats.empty));
+    result.Set("busyMs", Napi::Number::New(env, ms(stats.busy)));
+    result.Set("lastAgeMs", Napi::Number::New(env, ms(stats.lastAge)));
+    result.Set("maxAgeMs", Napi::Number::New(env, ms(stats.maxAge)));
+    result.Set("averageAgeMs", Napi::Number::New(env, ms(stats.AverageAge())));
+    Napi::Array starts = Napi::Array::New(env, captureStart.size());
+    for (size_t i = 0; i < captureStart.size(); i++) {
+        const ztools::CaptureStartMeter::Bucket& b = captureStart[i];
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("monitors", Napi::Number::New(env, b.monitors));
+        item.Set("count", Napi::Number::New(env, b.count));
+        item.Set("lastMs", Napi::Number::New(env, ms(b.last)));
+        item.Set("averageMs", Napi::Number::New(env, ms(b.Average())));
+        item.Set("maxMs", Napi::Number::New(env, ms(b.max)));
+        starts.Set(static_cast<uint32_t>(i), item);
+    }
+    result.Set("captureStart", starts);
+    Napi::Object repaintObj = Napi::Object::New(env);
+    repaintObj.Set("frames", Napi::Number::New(env, repaint.frames));
+    repaintObj.Set("fullFrames", Napi::Number::New(env, repaint.fullFrames));
+    repaintObj.Set("maxRects", Napi::Number::New(env, repaint.maxRects));
+    repaintObj.Set("paintedPixels", Napi::Number::New(env, static_cast<double>(repaint.paintedPixels)));
+    repaintObj.Set("coverage", Napi::Number::New(env, repaint.Coverage()));
+    result.Set("repaint", repaintObj);
+    return result;
+}
@@ -7,10 +7,15 @@
 Napi::Value StartRegionCapture(const Napi::CallbackInfo& info);
 Napi::Value PrimeScreenshotFrame(const Napi::CallbackInfo& info);
 Napi::Value StartRegionCaptureWithPrimedFrame(const Napi::CallbackInfo& info);
+Napi::Value SetScreenshotWarmMode(const Napi::CallbackInfo& info);
+Napi::Value GetScreenshotFrameStats(const Napi::CallbackInfo& info);
+Napi::Value StartScrollingCapture(const Napi::CallbackInfo& info);
+Napi::Value StopScrollingCapture(const Napi::CallbackInfo& info);
 
 // 供其他原生模块在截图触发前预抓取首帧。
 bool PrimeScreenshotFrameNow();
 
-// 获取 PNG 编码器 CLSID
+// 获取 GDI+ 编码器 CLSID（按 MIME 类型 / PNG）
 // 实际定义在 binding_windows.cpp（应用图标提取模块也在使用），截图模块复用
+int GetEncoderClsid(const wchar_t* mimeType, CLSID* pClsid);
 int GetPngEncoderClsid(CLSID* pClsid);
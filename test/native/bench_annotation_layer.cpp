@@ -0,0 +1,99 @@
+// 标注缓存层基准：已提交标注数量 vs 每帧耗时（2560x1440 逻辑画布，选区 1600x900）。
+// 「逐个重画」对应旧模型每帧把所有已提交标注重新光栅化到画面上；
+// 「缓存层」只在标注集合变化时重建一次，每帧合成缓存层（裁剪到选区）+ 重画一个正在编辑的标注。
+#include "core/brush_mask.h"
+#include "core/layer_cache.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using ztools::CoverageMask;
+using ztools::IntRect;
+using ztools::MaskPoint;
+using ztools::Surface;
+
+namespace {
+
+const int kLogW = 2560, kLogH = 1440;
+const IntRect kSelection(480, 270, 1600, 900);
+
+struct Stroke {
+    std::vector<MaskPoint> pts;
+    int radius;
+    std::uint32_t color;
+};
+
+// 混合箭头 / 矩形边框般的短折线与画笔长路径，散布在选区内
+std::vector<Stroke> MakeStrokes(int count) {
+    std::vector<Stroke> strokes;
+    for (int i = 0; i < count; i++) {
+        Stroke s;
+        s.radius = 1 + i % 3;
+        s.color = ztools::PackBgra(static_cast<std::uint8_t>(40 * i), 0x88, static_cast<std::uint8_t>(200 - i));
+        int cx = kSelection.x + 60 + (i * 397) % (kSelection.w - 120);
+        int cy = kSelection.y + 60 + (i * 211) % (kSelection.h - 120);
+        int n = i % 4 == 0 ? 80 : 5;
+        for (int k = 0; k < n; k++) {
+            double t = k * 0.15 + i;
+            s.pts.push_back({cx + static_cast<int>(50 * std::sin(t)), cy + static_cast<int>(40 * std::cos(t * 1.3))});
+        }
+        strokes.push_back(s);
+    }
+    return strokes;
+}
+
+void DrawStroke(const Stroke& s, CoverageMask& scratch, const ztools::ImageView& dst) {
+    scratch.ClearAll();
+    IntRect dirty = ztools::RasterizeStroke(scratch, s.pts.data(), static_cast<int>(s.pts.size()), s.radius);
+    ztools::BlendCoverage(scratch, s.color, dst, dirty.Intersect(kSelection));
+}
+
+}  // namespace
+
+int main() {
+    Surface screen(kLogW, kLogH);
+    ztest::FillScreenLike(screen.view(), 1);
+    Surface frame(kLogW, kLogH);
+    Surface layerPixels(kLogW, kLogH);
+    CoverageMask scratch;
+    scratch.Reset(kLogW, kLogH);
+
+    for (int count : {10, 50, 200}) {
+        std::vector<Stroke> strokes = MakeStrokes(count + 1);
+        const Stroke& live = strokes.back();  // 正在拖拽 / 绘制的那一个
+        std::string suffix = " " + std::to_string(count) + " anns";
+
+        zbench::Samples redraw;
+        for (int i = 0; i < 7; i++) {
+            ztools::Copy(screen.view(), 0, 0, frame.view(), kSelection);
+            zbench::Stopwatch sw;
+            for (int k = 0; k < count; k++) DrawStroke(strokes[k], scratch, frame.view());
+            DrawStroke(live, scratch, frame.view());
+            redraw.Add(sw.ElapsedMs());
+        }
+        zbench::Report(("annotations/redraw per frame" + suffix).c_str(), "median", redraw.Percentile(50), "ms");
+
+        ztools::LayerCache layer;
+        layer.Attach(layerPixels.view());
+        zbench::Stopwatch rebuildSw;
+        ztools::ImageView lv = layer.BeginRebuild(static_cast<std::uint64_t>(count));
+        for (int k = 0; k < count; k++) DrawStroke(strokes[k], scratch, lv);
+        layer.MarkDrawnByAlpha(kSelection);
+        zbench::Report(("annotations/layer rebuild" + suffix).c_str(), "once", rebuildSw.ElapsedMs(), "ms");
+
+        zbench::Samples cached;
+        for (int i = 0; i < 7; i++) {
+            ztools::Copy(screen.view(), 0, 0, frame.view(), kSelection);
+            zbench::Stopwatch sw;
+            layer.CompositeOnto(frame.view(), 0, 0, kSelection);
+            DrawStroke(live, scratch, frame.view());
+            cached.Add(sw.ElapsedMs());
+        }
+        zbench::Report(("annotations/cached per frame" + suffix).c_str(), "median", cached.Percentile(50), "ms");
+        zbench::DoNotOptimize(frame.view().At(kSelection.x, kSelection.y));
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// 马赛克涂抹基准：笔画长度 vs 每帧耗时（4K 物理屏、150% DPI、中号笔刷）。
+// 「整条重画」对应旧模型每帧重建整条笔画蒙版并揭示其包围盒；「增量」只光栅化新线段并重新合成其包围盒。
+#include "core/brush_mask.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using ztools::CoverageMask;
+using ztools::IntRect;
+using ztools::MaskPoint;
+using ztools::Surface;
+
+namespace {
+
+const int kPhysW = 3840, kPhysH = 2160;
+const double kDpi = 1.5;
+const int kLogW = 2560, kLogH = 1440;
+const int kBlockPx = 10;
+const int kRadius = 22;  // SC_MOSAIC_RADIUS 中号
+
+// 来回涂抹的轨迹：鼠标每帧移动约 6px
+std::vector<MaskPoint> ScribblePath(int count) {
+    std::vector<MaskPoint> pts;
+    pts.reserve(count);
+    for (int i = 0; i < count; i++) {
+        double t = i * 0.02;
+        pts.push_back({static_cast<int>(1280 + 600 * std::sin(t * 3.1)), static_cast<int>(720 + 400 * std::sin(t * 1.7))});
+    }
+    return pts;
+}
+
+}  // namespace
+
+int main() {
+    Surface phys(kPhysW, kPhysH);
+    ztest::FillScreenLike(phys.view(), 1);
+    ztools::MosaicTileCache tiles;
+    tiles.Reset(phys.view(), kDpi, kLogW, kLogH);
+    tiles.Ensure(kBlockPx, IntRect(0, 0, kLogW, kLogH));  // base 预热，只测蒙版与合成
+    Surface reveal(kLogW, kLogH);
+    CoverageMask mask;
+    mask.Reset(kLogW, kLogH);
+
+    for (int length : {100, 500, 2000, 5000}) {
+        std::vector<MaskPoint> pts = ScribblePath(length + 20);
+        std::string suffix = " " + std::to_string(length) + " pts";
+
+        zbench::Samples rebuild;
+        for (int i = 0; i < 5; i++) {
+            zbench::Stopwatch sw;
+            mask.ClearAll();
+            IntRect dirty = ztools::RasterizeStroke(mask, pts.data(), length, kRadius);
+            ztools::ComposeMosaicReveal(tiles, kBlockPx, mask, nullptr, reveal.view(), dirty);
+            rebuild.Add(sw.ElapsedMs());
+        }
+        zbench::Report(("brush/rebuild per frame" + suffix).c_str(), "median", rebuild.Percentile(50), "ms");
+
+        mask.ClearAll();
+        ztools::StrokeRasterizer stroke;
+        stroke.Begin(kRadius);
+        stroke.Extend(mask, pts.data(), length);
+        zbench::Samples incremental;
+        for (int n = length + 1; n <= length + 20; n++) {
+            zbench::Stopwatch sw;
+            IntRect dirty = stroke.Extend(mask, pts.data(), n);
+            ztools::ComposeMosaicReveal(tiles, kBlockPx, mask, nullptr, reveal.view(), dirty);
+            incremental.Add(sw.ElapsedMs());
+        }
+        zbench::Report(("brush/incremental per frame" + suffix).c_str(), "median", incremental.Percentile(50), "ms");
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// 捕获后端基准：双 4K 虚拟桌面上四种桌面活动（静止、打字光标、播放视频、滚动网页），
+// 对比每次预截屏整帧读取（旧 BitBlt 路径的读取量）与持久帧只应用增量的耗时，
+// 以及预截屏交出快照（持久帧整帧复制到新位图）的耗时。
+#include "core/capture_backend.h"
+#include "core/parallel.h"
+#include "bench_harness.h"
+#include "synthetic_capture.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using ztest::SyntheticCaptureBackend;
+using ztools::IntRect;
+
+namespace {
+
+const int kW = 3840 * 2, kH = 2160;
+const int kFrames = 60;
+
+void Scenario(const char* name, const std::function<void(SyntheticCaptureBackend&, int)>& activity) {
+    ztools::DuplicationCapture capture;
+    auto owned = std::make_unique<SyntheticCaptureBackend>(kW, kH);
+    SyntheticCaptureBackend* backend = owned.get();
+    capture.Reset(std::move(owned));
+    capture.Update();
+
+    ztools::Surface full(kW, kH);
+    zbench::Samples fullRead, incremental;
+    for (int i = 0; i < kFrames; i++) {
+        activity(*backend, i);
+        zbench::Stopwatch sw;
+        backend->Read(full.view().Bounds(), full.view());
+        fullRead.Add(sw.ElapsedMs());
+        zbench::Stopwatch sw2;
+        capture.Update();
+        incremental.Add(sw2.ElapsedMs());
+    }
+    const ztools::CaptureStats& s = capture.stats();
+    std::string base = std::string("capture/") + name;
+    zbench::Report(base.c_str(), "full read p50", fullRead.Percentile(50), "ms");
+    zbench::Report(base.c_str(), "incremental p50", incremental.Percentile(50), "ms");
+    zbench::Report(base.c_str(), "incremental p99", incremental.Percentile(99), "ms");
+    double perUpdate = double(s.pixelsRead - std::int64_t(kW) * kH) / kFrames;
+    zbench::Report(base.c_str(), "read per update", perUpdate * 100.0 / (double(kW) * kH), "% of full");
+}
+
+}  // namespace
+
+int main() {
+    Scenario("idle", [](SyntheticCaptureBackend&, int) {});
+    Scenario("typing", [](SyntheticCaptureBackend& b, int i) {
+        b.Paint(IntRect(900 + (i % 40) * 9, 600, 2, 18), 1);  // 光标
+        b.Paint(IntRect(900 + (i % 40) * 9 - 9, 600, 9, 18), 2);  // 新字符
+    });
+    Scenario("video", [](SyntheticCaptureBackend& b, int i) {
+        b.Paint(IntRect(4200, 700, 1280, 720), static_cast<std::uint32_t>(i));
+    });
+    Scenario("scrolling", [](SyntheticCaptureBackend& b, int i) {
+        b.Scroll(IntRect(400, 160, 1800, 1900), 48, static_cast<std::uint32_t>(i));
+    });
+
+    // 预截屏交出快照：持久帧整帧复制到会话私有的位图（会话期间持久帧继续被更新）
+    ztools::DuplicationCapture capture;
+    capture.Reset(std::make_unique<SyntheticCaptureBackend>(kW, kH));
+    capture.Update();
+    ztools::Surface snapshot(kW, kH);
+    std::vector<int> threadCounts(1, 1);
+    if (ztools::DefaultThreadCount() > 1) threadCounts.push_back(ztools::DefaultThreadCount());
+    for (int threads : threadCounts) {
+        zbench::Samples copy;
+        for (int i = 0; i < 20; i++) {
+            zbench::Stopwatch sw;
+            capture.Snapshot(snapshot.view(), threads);
+            copy.Add(sw.ElapsedMs());
+        }
+        std::string name = "capture/snapshot " + std::to_string(threads) + " threads";
+        zbench::Report(name.c_str(), "p50", copy.Percentile(50), "ms");
+    }
+    return 0;
+}
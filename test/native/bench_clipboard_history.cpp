@@ -0,0 +1,114 @@
+// 剪贴板历史存储基准：插入吞吐（含去重与压缩）与按哈希 / 前缀查询的延迟分位数
+#include "core/clipboard_history.h"
+#include "bench_harness.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using ztools::ClipboardHistoryStore;
+using ztools::HistoryItem;
+using ztools::HistoryKind;
+
+namespace {
+
+std::string RandomText(std::mt19937& rng, size_t minLen, size_t maxLen) {
+    static const char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 \n";
+    std::uniform_int_distribution<size_t> len(minLen, maxLen);
+    std::uniform_int_distribution<int> ch(0, sizeof(kAlphabet) - 2);
+    std::string s(len(rng), ' ');
+    for (char& c : s) c = kAlphabet[ch(rng)];
+    return s;
+}
+
+void BenchStore(const char* label, const std::string& path) {
+    const size_t kCapacity = 32 * 1024 * 1024;
+    const int kInserts = 200000;
+
+    std::mt19937 rng(42);
+    std::vector<std::string> corpus;
+    corpus.reserve(kInserts);
+    for (int i = 0; i < kInserts; i++) {
+        // 约 20% 的复制是重复内容，贴近真实剪贴板历史
+        if (i > 0 && rng() % 5 == 0) {
+            corpus.push_back(corpus[rng() % corpus.size()]);
+        } else {
+            corpus.push_back(RandomText(rng, 16, 512));
+        }
+    }
+
+    ClipboardHistoryStore store;
+    if (!store.Open({path, kCapacity})) {
+        std::printf("  ⚠️  %s: open failed\n", label);
+        return;
+    }
+
+    std::vector<std::uint64_t> hashes;
+    hashes.reserve(kInserts);
+    zbench::Stopwatch sw;
+    for (int i = 0; i < kInserts; i++) {
+        hashes.push_back(store.Insert(HistoryKind::Text, corpus[i].data(), corpus[i].size(), 1000 + i));
+    }
+    double insertMs = sw.ElapsedMs();
+
+    std::string name = std::string("history/") + label;
+    zbench::Report(name.c_str(), "inserts/s", kInserts / (insertMs / 1000.0), "");
+    zbench::Report(name.c_str(), "entries", static_cast<double>(store.Count()), "");
+    zbench::Report(name.c_str(), "dedup hits", static_cast<double>(store.stats().dedupHits), "");
+    zbench::Report(name.c_str(), "compactions", static_cast<double>(store.stats().compactions), "");
+
+    zbench::Samples get;
+    get.Reserve(100000);
+    HistoryItem item;
+    for (int i = 0; i < 100000; i++) {
+        std::uint64_t h = hashes[rng() % hashes.size()];
+        zbench::Stopwatch one;
+        bool found = store.Get(h, item);
+        get.Add(one.ElapsedNs());
+        zbench::DoNotOptimize(found);
+    }
+    zbench::Report(name.c_str(), "get p50", get.Percentile(50), "ns");
+    zbench::Report(name.c_str(), "get p99", get.Percentile(99), "ns");
+
+    zbench::Samples prefix;
+    prefix.Reserve(20000);
+    for (int i = 0; i < 20000; i++) {
+        std::string p = RandomText(rng, 3, 3);
+        zbench::Stopwatch one;
+        auto items = store.QueryTextPrefix(p, 20);
+        prefix.Add(one.ElapsedNs());
+        zbench::DoNotOptimize(items.size());
+    }
+    zbench::Report(name.c_str(), "prefix p50", prefix.Percentile(50), "ns");
+    zbench::Report(name.c_str(), "prefix p99", prefix.Percentile(99), "ns");
+
+    zbench::Samples recent;
+    for (int i = 0; i < 2000; i++) {
+        zbench::Stopwatch one;
+        auto items = store.QueryRecent(rng() % 1000, 50);
+        recent.Add(one.ElapsedNs());
+        zbench::DoNotOptimize(items.size());
+    }
+    zbench::Report(name.c_str(), "recent(50) p99", recent.Percentile(99), "ns");
+    store.Close();
+}
+
+}  // namespace
+
+int main() {
+    BenchStore("memory", "");
+
+    // 文件映射版本的临时文件用 mkstemp 创建，只在 POSIX 下运行
+#ifndef _WIN32
+    char path[] = "/tmp/ztools-history-bench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    BenchStore("mmap", path);
+    std::remove(path);
+#endif
+    return 0;
+}
@@ -0,0 +1,111 @@
+// 覆盖层损伤区域基准：在双 4K 虚拟桌面上回放三段录制的拖拽轨迹（拖出选区 / 拖动选区 / 拖角缩放），
+// 每帧按覆盖层的上报方式生成损伤（选区对称差 + 边框边带 + 尺寸标签 / 信息面板 / 工具栏新旧位置），
+// 统计每帧追踪耗时、重绘面积占整屏的比例（旧实现这三种交互每帧都整屏重绘，即 100%）与单帧矩形数。
+#include "core/damage.h"
+#include "bench_harness.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using ztools::AddRectChange;
+using ztools::DamageTracker;
+using ztools::IntRect;
+using ztools::RepaintMeter;
+
+namespace {
+
+const IntRect kCanvas(0, 0, 3840 * 2, 2160);
+const int kEdge = 8;  // 边框 + 手柄半径
+
+struct Frame {
+    IntRect selection;
+    IntRect chrome[2];  // 随选区 / 鼠标移动的界面元素（尺寸标签、信息面板、工具栏）
+};
+
+// 录制的鼠标轨迹：先快后慢的缓动，叠加手抖
+std::vector<std::pair<int, int>> Track(int x0, int y0, int x1, int y1, int frames) {
+    std::vector<std::pair<int, int>> pts;
+    for (int i = 0; i <= frames; i++) {
+        double t = double(i) / frames;
+        double e = 1.0 - (1.0 - t) * (1.0 - t);
+        int jitter = (i * 7919) % 5 - 2;
+        pts.push_back({x0 + int((x1 - x0) * e) + jitter, y0 + int((y1 - y0) * e) - jitter});
+    }
+    return pts;
+}
+
+IntRect Label(const IntRect& sel) { return IntRect(sel.x, sel.y - 34, 132, 28); }
+IntRect Panel(int mx, int my) { return IntRect(mx + 20, my + 20, 200, 260); }
+IntRect Toolbar(const IntRect& sel) { return IntRect(sel.x + sel.w / 2 - 270, sel.Bottom() + 8, 540, 44); }
+
+std::vector<Frame> SelectSession() {
+    std::vector<Frame> frames;
+    for (const auto& p : Track(900, 380, 3500, 1750, 120)) {
+        Frame f;
+        f.selection = IntRect::FromLTRB(900, 380, p.first, p.second);
+        f.chrome[0] = Label(f.selection);
+        f.chrome[1] = Panel(p.first, p.second);
+        frames.push_back(f);
+    }
+    return frames;
+}
+
+std::vector<Frame> MoveSession() {
+    std::vector<Frame> frames;
+    for (const auto& p : Track(1200, 500, 5200, 900, 150)) {
+        Frame f;
+        f.selection = IntRect(p.first, p.second, 1600, 900);
+        f.chrome[0] = Toolbar(f.selection);
+        frames.push_back(f);
+    }
+    return frames;
+}
+
+std::vector<Frame> ResizeSession() {
+    std::vector<Frame> frames;
+    for (const auto& p : Track(2400, 1300, 1700, 900, 100)) {
+        Frame f;
+        f.selection = IntRect::FromLTRB(1000, 600, p.first, p.second);
+        frames.push_back(f);
+    }
+    return frames;
+}
+
+void Replay(const char* name, const std::vector<Frame>& frames) {
+    DamageTracker damage;
+    damage.Reset(kCanvas);
+    RepaintMeter meter;
+    meter.Begin();
+    zbench::Samples perFrame;
+    for (size_t i = 1; i < frames.size(); i++) {
+        const Frame& prev = frames[i - 1];
+        const Frame& cur = frames[i];
+        zbench::Stopwatch sw;
+        damage.Clear();
+        AddRectChange(damage, prev.selection, cur.selection, kEdge);
+        for (int c = 0; c < 2; c++) {
+            if (prev.chrome[c] == cur.chrome[c]) continue;
+            damage.Add(prev.chrome[c]);
+            damage.Add(cur.chrome[c]);
+        }
+        perFrame.Add(sw.ElapsedNs());
+        meter.Record(damage);
+    }
+    ztools::RepaintStats s = meter.End();
+    std::string base = std::string("damage/") + name;
+    zbench::Report(base.c_str(), "track p50", perFrame.Percentile(50), "ns");
+    zbench::Report(base.c_str(), "track p99", perFrame.Percentile(99), "ns");
+    zbench::Report(base.c_str(), "repaint", s.Coverage() * 100.0, "% of full");
+    zbench::Report(base.c_str(), "full frames", s.fullFrames, "frames");
+    zbench::Report(base.c_str(), "max rects", s.maxRects, "rects");
+}
+
+}  // namespace
+
+int main() {
+    Replay("select drag", SelectSession());
+    Replay("move drag", MoveSession());
+    Replay("resize drag", ResizeSession());
+    return 0;
+}
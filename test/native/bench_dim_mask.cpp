@@ -0,0 +1,62 @@
+// 选区外遮罩基准：双 4K 虚拟屏（7680x2160）
+// 整屏帧：标量 BlendSolidOutside（近似旧路径逐像素的 AlphaBlend）对比 SIMD 单线程 / 多线程；
+// 拖动选区边缘的典型帧：只处理损伤矩形与选区外部的交集。
+// 同时给出不再分配的整屏遮罩位图大小。
+#include "core/damage.h"
+#include "core/dim_mask.h"
+#include "core/parallel.h"
+#include "core/simd.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <functional>
+#include <string>
+
+using ztools::IntRect;
+using ztools::PackBgra;
+using ztools::Surface;
+
+namespace {
+
+const int kW = 7680, kH = 2160;
+const std::uint8_t kAlpha = 120;
+
+void Run(const std::string& name, int iterations, const std::function<void()>& fn) {
+    fn();
+    zbench::Samples samples;
+    for (int i = 0; i < iterations; i++) {
+        zbench::Stopwatch sw;
+        fn();
+        samples.Add(sw.ElapsedMs());
+    }
+    zbench::Report(name.c_str(), "median", samples.Percentile(50), "ms");
+}
+
+}  // namespace
+
+int main() {
+    Surface back(kW, kH);
+    ztest::FillScreenLike(back.view(), 3);
+    const IntRect selection(2400, 600, 1800, 1000);
+    const int threads = ztools::DefaultThreadCount();
+    const std::string isa = ztools::SimdIsa();
+
+    zbench::Report("dim/mask bitmap", "not allocated", kW * double(kH) * 4 / (1024 * 1024), "MB");
+
+    Run("dim/full frame scalar reference", 10,
+        [&] { ztools::BlendSolidOutside(back.view(), selection, PackBgra(0, 0, 0), kAlpha); });
+    Run("dim/full frame " + isa + " 1 thread", 20,
+        [&] { ztools::DimOutside(back.view(), selection, back.view().Bounds(), PackBgra(0, 0, 0), kAlpha, 1); });
+    Run("dim/full frame " + isa + " " + std::to_string(threads) + " threads", 20,
+        [&] { ztools::DimOutside(back.view(), selection, back.view().Bounds(), PackBgra(0, 0, 0), kAlpha, 0); });
+
+    // 右边缘向右拖 12px：对称差加上新旧边带
+    ztools::DamageTracker damage;
+    damage.Reset(back.view().Bounds());
+    ztools::AddRectChange(damage, selection, IntRect(2400, 600, 1812, 1000), 6);
+    zbench::Report("dim/drag edge", "damaged", 100.0 * damage.Area() / (double(kW) * kH), "% of screen");
+    Run("dim/drag edge " + isa + " damage only", 50, [&] {
+        for (const IntRect& r : damage.Rects()) ztools::DimOutside(back.view(), selection, r, PackBgra(0, 0, 0), kAlpha);
+    });
+    return 0;
+}
@@ -0,0 +1,75 @@
+// 逻辑分辨率底图基准：4K / 5K 物理屏在 150% / 200% DPI 下，会话开始时一次性缩放的耗时
+// （参考实现 Scale Box 对比 SIMD 单线程 / 多线程），以及每帧恢复背景的耗时
+// （旧路径：每帧从物理截图按比例缩放取回脏区，相当于 StretchBlt；新路径：从逻辑底图 1:1 复制，相当于 BitBlt）
+#include "core/downscale.h"
+#include "core/parallel.h"
+#include "core/simd.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <functional>
+#include <string>
+
+using ztools::IntRect;
+using ztools::Surface;
+
+namespace {
+
+void Run(const std::string& name, double megapixels, int iterations, const std::function<void()>& fn) {
+    fn();
+    zbench::Samples samples;
+    for (int i = 0; i < iterations; i++) {
+        zbench::Stopwatch sw;
+        fn();
+        samples.Add(sw.ElapsedMs());
+    }
+    double median = samples.Percentile(50);
+    zbench::Report(name.c_str(), "median", median, "ms");
+    zbench::Report(name.c_str(), "per MP", median / megapixels, "ms/MP");
+}
+
+void Screen(const char* name, int physW, int physH, double dpi) {
+    Surface phys(physW, physH);
+    ztest::FillScreenLike(phys.view(), static_cast<std::uint32_t>(physW));
+    const int logW = ztools::ScaleCoord(physW, 1.0 / dpi), logH = ztools::ScaleCoord(physH, 1.0 / dpi);
+    Surface logical(logW, logH);
+    const double logicalMP = logW * logH / 1e6;
+    const int threads = ztools::DefaultThreadCount();
+    const std::string base = std::string("downscale/") + name + " " + std::to_string(int(dpi * 100 + 0.5)) + "% ";
+    const std::string isa = ztools::SimdIsa();
+
+    Run(base + "prescale reference", logicalMP, 5, [&] {
+        ztools::Scale(phys.view(), phys.view().Bounds(), logical.view(), logical.view().Bounds(),
+                      ztools::ScaleFilter::Box);
+    });
+    Run(base + "prescale " + isa + " 1 thread", logicalMP, 10,
+        [&] { ztools::DownscaleBox(phys.view(), logical.view(), 1); });
+    Run(base + "prescale " + isa + " " + std::to_string(threads) + " threads", logicalMP, 10,
+        [&] { ztools::DownscaleBox(phys.view(), logical.view(), threads); });
+
+    // 每帧恢复：整屏重绘，以及拖动选区时典型的一块脏区（约 1/6 屏）
+    Surface back(logW, logH);
+    const IntRect full = back.view().Bounds();
+    const IntRect dirty(logW / 5, logH / 4, logW * 2 / 5, logH * 2 / 5);
+    const struct {
+        const char* label;
+        IntRect rect;
+    } frames[] = {{"full frame", full}, {"dirty rect", dirty}};
+    for (const auto& f : frames) {
+        const double mp = f.rect.w * double(f.rect.h) / 1e6;
+        Run(base + f.label + " stretch from physical", mp, 10,
+            [&] { ztools::CopyFromPhysical(phys.view(), dpi, back.view(), f.rect); });
+        Run(base + f.label + " copy from logical", mp, 20,
+            [&] { ztools::Copy(logical.view(), f.rect.x, f.rect.y, back.view(), f.rect); });
+    }
+}
+
+}  // namespace
+
+int main() {
+    for (double dpi : {1.5, 2.0}) {
+        Screen("4K", 3840, 2160, dpi);
+        Screen("5K", 5120, 2880, dpi);
+    }
+    return 0;
+}
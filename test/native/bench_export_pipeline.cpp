@@ -0,0 +1,108 @@
+// 导出流水线基准：无界面截图会话（双 4K 合成桌面）上确认三种大小的选区，
+// 对比旧流程（覆盖层线程上编码 + 发布完才关闭）与流水线（提交即关闭）从确认到关闭覆盖层的耗时，
+// 以及流水线交出编码结果的耗时。编码用「逐行差分 + Adler-32 + base64」近似 PNG 编码的逐像素开销，
+// 发布为整图复制（近似剪贴板写入 DIB）。
+#include "core/export_pipeline.h"
+#include "bench_harness.h"
+#include "headless_capture.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using ztest::HeadlessRegionSession;
+using ztools::ExportJob;
+using ztools::ExportResult;
+using ztools::ImageView;
+using ztools::IntRect;
+
+namespace {
+
+const int kW = 3840 * 2, kH = 2160;
+const int kRounds = 12;
+
+bool StandInEncode(const ImageView& image, std::string& out) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    std::vector<std::uint8_t> filtered(rowBytes * image.height);
+    std::uint32_t a = 1, b = 0;
+    for (int y = 0; y < image.height; y++) {
+        const std::uint8_t* row = reinterpret_cast<const std::uint8_t*>(image.Row(y));
+        std::uint8_t* f = filtered.data() + rowBytes * y;
+        for (size_t i = 0; i < rowBytes; i++) {
+            f[i] = static_cast<std::uint8_t>(row[i] - (i >= 4 ? row[i - 4] : 0));
+            a = (a + f[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    out.clear();
+    out.reserve((filtered.size() + 2) / 3 * 4 + 8);
+    for (size_t i = 0; i + 2 < filtered.size(); i += 3) {
+        std::uint32_t v = (filtered[i] << 16) | (filtered[i + 1] << 8) | filtered[i + 2];
+        out.push_back(kAlphabet[(v >> 18) & 63]);
+        out.push_back(kAlphabet[(v >> 12) & 63]);
+        out.push_back(kAlphabet[(v >> 6) & 63]);
+        out.push_back(kAlphabet[v & 63]);
+    }
+    out += std::to_string((b << 16) | a);
+    return true;
+}
+
+bool StandInPublish(const ImageView& image) {
+    std::vector<std::uint32_t> clip(static_cast<size_t>(image.width) * image.height);
+    for (int y = 0; y < image.height; y++) {
+        std::memcpy(clip.data() + static_cast<size_t>(y) * image.width, image.Row(y), static_cast<size_t>(image.width) * 4);
+    }
+    zbench::DoNotOptimize(clip.back());
+    return true;
+}
+
+double Ms(std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+void Scenario(const char* name, const IntRect& selection) {
+    HeadlessRegionSession session(kW, kH);
+    session.Begin();
+    ExportJob stages;
+    stages.encode = StandInEncode;
+    stages.publish = StandInPublish;
+
+    zbench::Samples syncClose, pipeClose, pipeEncoded;
+    for (int i = 0; i < kRounds; i++) {
+        ExportResult r = session.ConfirmSync(selection, stages);
+        zbench::DoNotOptimize(r.payload.size());
+        syncClose.Add(Ms(session.closeLatency()));
+    }
+
+    ztools::ExportPipeline pipeline;
+    std::mutex m;
+    std::vector<ExportResult> results;
+    for (int i = 0; i < kRounds; i++) {
+        ExportJob job = stages;
+        job.deliver = [&](ExportResult&& r) {
+            std::lock_guard<std::mutex> lock(m);
+            results.push_back(std::move(r));
+        };
+        session.Confirm(selection, pipeline, std::move(job));
+        pipeClose.Add(Ms(session.closeLatency()));
+        pipeline.Drain();  // 一次截图一次导出：不让上一轮的编码占用下一轮的 CPU
+    }
+    for (const ExportResult& r : results) pipeEncoded.Add(Ms(r.timings.delivered));
+
+    std::string base = std::string("export/") + name;
+    zbench::Report(base.c_str(), "sync confirm->close p50", syncClose.Percentile(50), "ms");
+    zbench::Report(base.c_str(), "pipeline confirm->close p50", pipeClose.Percentile(50), "ms");
+    zbench::Report(base.c_str(), "pipeline confirm->close p99", pipeClose.Percentile(99), "ms");
+    zbench::Report(base.c_str(), "pipeline confirm->payload p50", pipeEncoded.Percentile(50), "ms");
+}
+
+}  // namespace
+
+int main() {
+    Scenario("800x600", IntRect(1200, 400, 800, 600));
+    Scenario("1920x1080", IntRect(3000, 500, 1920, 1080));
+    Scenario("3840x2160", IntRect(3840, 0, 3840, 2160));
+    return 0;
+}
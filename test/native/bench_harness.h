@@ -0,0 +1,64 @@
+#pragma once
+
+// 原生基准测试的最小工具：计时、分位数统计与统一的结果输出
+// 每个 bench_*.cpp 独立编译为一个可执行文件，由 scripts/test-native.js --bench 驱动。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace zbench {
+
+using Clock = std::chrono::steady_clock;
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(Clock::now()) {}
+    void Restart() { start_ = Clock::now(); }
+    double ElapsedMs() const { return std::chrono::duration<double, std::milli>(Clock::now() - start_).count(); }
+    double ElapsedNs() const { return std::chrono::duration<double, std::nano>(Clock::now() - start_).count(); }
+
+private:
+    Clock::time_point start_;
+};
+
+// 收集单次耗时样本（纳秒）并给出分位数
+class Samples {
+public:
+    void Reserve(size_t n) { values_.reserve(n); }
+    void Add(double ns) { values_.push_back(ns); }
+    size_t Count() const { return values_.size(); }
+
+    double Percentile(double p) {
+        if (values_.empty()) return 0;
+        std::sort(values_.begin(), values_.end());
+        size_t idx = static_cast<size_t>(p / 100.0 * (values_.size() - 1) + 0.5);
+        return values_[(std::min)(idx, values_.size() - 1)];
+    }
+
+    double Mean() const {
+        if (values_.empty()) return 0;
+        double sum = 0;
+        for (double v : values_) sum += v;
+        return sum / values_.size();
+    }
+
+private:
+    std::vector<double> values_;
+};
+
+inline void Report(const char* name, const char* metric, double value, const char* unit) {
+    std::printf("  📊 %-36s %-14s %12.2f %s\n", name, metric, value, unit);
+}
+
+// 防止编译器把基准里的计算当作死代码删掉：地址写入命名空间级的 volatile 指针，写入不能省略
+inline const void* volatile g_doNotOptimizeSink = nullptr;
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    g_doNotOptimizeSink = &value;
+}
+
+}  // namespace zbench
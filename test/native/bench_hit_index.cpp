@@ -0,0 +1,202 @@
+// 标注命中测试基准：标注数量 / 画笔长度 vs 每次悬停查询耗时（2560x1440 画布）。
+// 「线性」对应旧实现逐个标注、逐个画笔点求距离；「索引」先查网格得到候选部件，只对其点区间求距离。
+// 「+sync」把查询前的索引同步计入（每 100 次悬停拖动一个标注）：逐个构造签名比对（含文字拷贝）
+// 与按改动版本号跳过比对两种方式。
+#include "core/hit_index.h"
+#include "bench_harness.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using ztools::HitCandidate;
+using ztools::HitGrid;
+using ztools::HitPart;
+
+namespace {
+
+struct Pt {
+    int x, y;
+};
+
+const double kTol = 6.0;
+
+double SegmentDist(double px, double py, const Pt& a, const Pt& b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double len2 = dx * dx + dy * dy;
+    double t = len2 > 0 ? ((px - a.x) * dx + (py - a.y) * dy) / len2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    double ex = px - (a.x + t * dx), ey = py - (a.y + t * dy);
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+double PolylineDist(double px, double py, const std::vector<Pt>& pts, int first, int last) {
+    if (first == last) return SegmentDist(px, py, pts[first], pts[first]);
+    double best = 1e18;
+    for (int i = first; i < last; i++) best = (std::min)(best, SegmentDist(px, py, pts[i], pts[i + 1]));
+    return best;
+}
+
+std::vector<std::vector<Pt>> MakeStrokes(int count, int length) {
+    std::vector<std::vector<Pt>> strokes(count);
+    for (int s = 0; s < count; s++) {
+        int cx = 200 + (s * 397) % 2160, cy = 150 + (s * 211) % 1140;
+        for (int i = 0; i < length; i++) {
+            double t = i * 0.05 + s;
+            strokes[s].push_back({cx + static_cast<int>(150 * std::sin(t)), cy + static_cast<int>(100 * std::sin(t * 1.7))});
+        }
+    }
+    return strokes;
+}
+
+// 与覆盖层的 AnnotationHitKey 相同的签名：点数 + 首 / 中 / 尾点 + 文字拷贝
+struct StrokeKey {
+    size_t count = 0;
+    Pt first{0, 0}, mid{0, 0}, last{0, 0};
+    std::wstring text;
+
+    bool operator==(const StrokeKey& o) const {
+        return count == o.count && first.x == o.first.x && first.y == o.first.y && mid.x == o.mid.x &&
+               mid.y == o.mid.y && last.x == o.last.x && last.y == o.last.y && text == o.text;
+    }
+};
+
+StrokeKey MakeKey(const std::vector<Pt>& pts, const std::wstring& text) {
+    StrokeKey k;
+    k.count = pts.size();
+    k.first = pts.front();
+    k.mid = pts[pts.size() / 2];
+    k.last = pts.back();
+    k.text = text;
+    return k;
+}
+
+void RegisterStroke(HitGrid& grid, int item, const std::vector<Pt>& pts) {
+    std::vector<HitPart> parts;
+    ztools::AppendPolylineParts(pts.data(), static_cast<int>(pts.size()), static_cast<int>(kTol) + 1, parts);
+    grid.SetItem(item, parts);
+}
+
+// 悬停查询前先同步索引；versioned 时版本号未变直接跳过，否则逐个构造签名比对、只重登记改动的标注
+zbench::Samples MeasureSyncedHover(const std::vector<std::vector<Pt>>& original, const std::vector<Pt>& hovers,
+                                   bool versioned, int& hits) {
+    std::vector<std::vector<Pt>> strokes = original;
+    const int count = static_cast<int>(strokes.size());
+    std::vector<std::wstring> labels(count);
+    for (int s = 0; s < count; s += 5) labels[s] = L"annotation label #" + std::to_wstring(s);
+
+    HitGrid grid;
+    std::vector<StrokeKey> keys;
+    for (int s = 0; s < count; s++) {
+        RegisterStroke(grid, s, strokes[s]);
+        keys.push_back(MakeKey(strokes[s], labels[s]));
+    }
+    std::uint64_t version = 1, synced = 1;
+
+    zbench::Samples samples;
+    std::vector<HitCandidate> candidates;
+    hits = 0;
+    for (size_t i = 0; i < hovers.size(); i++) {
+        if (i % 100 == 50) {
+            // 拖动一个标注：整体平移 3px
+            for (Pt& p : strokes[i % count]) p.x += 3;
+            version++;
+        }
+        const Pt& h = hovers[i];
+        zbench::Stopwatch sw;
+        if (!versioned || synced != version) {
+            synced = version;
+            for (int s = 0; s < count; s++) {
+                StrokeKey key = MakeKey(strokes[s], labels[s]);
+                if (keys[s] == key) continue;
+                RegisterStroke(grid, s, strokes[s]);
+                keys[s] = key;
+            }
+        }
+        int hit = -1;
+        grid.Query(h.x, h.y, candidates);
+        for (const HitCandidate& c : candidates) {
+            const HitPart& part = grid.Parts(c.item)[c.part];
+            if (PolylineDist(h.x, h.y, strokes[c.item], part.first, part.last) <= kTol) {
+                hit = c.item;
+                break;
+            }
+        }
+        samples.Add(sw.ElapsedNs());
+        hits += hit >= 0;
+    }
+    return samples;
+}
+
+}  // namespace
+
+int main() {
+    for (int count : {20, 100, 400}) {
+        for (int length : {100, 1000}) {
+            std::vector<std::vector<Pt>> strokes = MakeStrokes(count, length);
+            std::string suffix = " " + std::to_string(count) + "x" + std::to_string(length) + "pt";
+
+            HitGrid grid;
+            zbench::Stopwatch buildSw;
+            for (int s = 0; s < count; s++) {
+                std::vector<HitPart> parts;
+                ztools::AppendPolylineParts(strokes[s].data(), length, static_cast<int>(kTol) + 1, parts);
+                grid.SetItem(s, parts);
+            }
+            zbench::Report(("hit/index build" + suffix).c_str(), "once", buildSw.ElapsedMs(), "ms");
+
+            // 鼠标在画布上扫过的一串悬停位置
+            std::vector<Pt> hovers;
+            for (int i = 0; i < 2000; i++) hovers.push_back({(i * 37) % 2560, (i * 53) % 1440});
+
+            int hitsLinear = 0, hitsIndexed = 0;
+            zbench::Samples linear;
+            for (const Pt& h : hovers) {
+                zbench::Stopwatch sw;
+                int hit = -1;
+                for (int s = count - 1; s >= 0 && hit < 0; s--) {
+                    if (PolylineDist(h.x, h.y, strokes[s], 0, length - 1) <= kTol) hit = s;
+                }
+                linear.Add(sw.ElapsedNs());
+                hitsLinear += hit >= 0;
+            }
+            zbench::Samples indexed;
+            std::vector<HitCandidate> candidates;
+            for (const Pt& h : hovers) {
+                zbench::Stopwatch sw;
+                int hit = -1;
+                grid.Query(h.x, h.y, candidates);
+                for (const HitCandidate& c : candidates) {
+                    if (c.item == hit) continue;
+                    const HitPart& part = grid.Parts(c.item)[c.part];
+                    if (PolylineDist(h.x, h.y, strokes[c.item], part.first, part.last) <= kTol) {
+                        hit = c.item;
+                        break;
+                    }
+                }
+                indexed.Add(sw.ElapsedNs());
+                hitsIndexed += hit >= 0;
+            }
+            zbench::Report(("hit/linear hover" + suffix).c_str(), "p50", linear.Percentile(50) / 1000.0, "us");
+            zbench::Report(("hit/indexed hover" + suffix).c_str(), "p50", indexed.Percentile(50) / 1000.0, "us");
+            zbench::Report(("hit/indexed hover" + suffix).c_str(), "p99", indexed.Percentile(99) / 1000.0, "us");
+            if (hitsLinear != hitsIndexed) {
+                std::printf("  ❌ hit count mismatch: %d vs %d\n", hitsLinear, hitsIndexed);
+                return 1;
+            }
+
+            int hitsKeyed = 0, hitsVersioned = 0;
+            zbench::Samples keyed = MeasureSyncedHover(strokes, hovers, false, hitsKeyed);
+            zbench::Samples versioned = MeasureSyncedHover(strokes, hovers, true, hitsVersioned);
+            zbench::Report(("hit/hover+sync signatures" + suffix).c_str(), "p50", keyed.Percentile(50) / 1000.0, "us");
+            zbench::Report(("hit/hover+sync versioned" + suffix).c_str(), "p50", versioned.Percentile(50) / 1000.0, "us");
+            zbench::Report(("hit/hover+sync versioned" + suffix).c_str(), "p99", versioned.Percentile(99) / 1000.0, "us");
+            if (hitsKeyed != hitsVersioned) {
+                std::printf("  ❌ synced hit count mismatch: %d vs %d\n", hitsKeyed, hitsVersioned);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// 截图输出编码器基准：1920x1080 选区，两种内容（界面类：大面积纯色 + 文字笔画；照片类：渐变 + 噪点），
+// 对比各内置格式的编码耗时、吞吐与输出大小（占原始 BGRA 的比例）。
+// PNG / JPEG 由 Win32 的 GDI+ 编码器提供，不在本基准内，Windows 上可从截图结果的 encodedMs 对照。
+#include "core/image_encoder.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using ztools::ImageView;
+
+namespace {
+
+const int kW = 1920, kH = 1080;
+const int kRounds = 20;
+
+// 界面类内容：窗口底色、侧栏、标题栏，加上按行排列的「文字」短笔画
+void FillUiLike(const ImageView& view) {
+    ztools::Fill(view, view.Bounds(), ztools::PackBgra(243, 243, 243, 0));
+    ztools::Fill(view, ztools::IntRect(0, 0, 280, view.height), ztools::PackBgra(32, 32, 36, 0));
+    ztools::Fill(view, ztools::IntRect(280, 0, view.width - 280, 48), ztools::PackBgra(255, 255, 255, 0));
+    std::uint32_t state = 12345;
+    for (int line = 72; line + 14 < view.height; line += 22) {
+        int x = 300;
+        while (x < view.width - 40) {
+            state = state * 1664525u + 1013904223u;
+            const int word = 12 + (state >> 27);
+            for (int y = line; y < line + 14; y++) {
+                std::uint32_t* row = view.Row(y);
+                for (int i = 0; i < word; i += 2) row[x + i] = ztools::PackBgra(30, 30, 30, 0);
+            }
+            x += word + 8;
+        }
+    }
+}
+
+void Measure(const char* content, const ImageView& image, const ztools::ImageEncoder& encoder) {
+    std::vector<std::uint8_t> out;
+    zbench::Samples ms;
+    for (int i = 0; i < kRounds; i++) {
+        zbench::Stopwatch sw;
+        encoder.Encode(image, ztools::EncodeOptions(), out);
+        ms.Add(sw.ElapsedMs());
+        zbench::DoNotOptimize(out.back());
+    }
+    const double rawBytes = static_cast<double>(image.width) * image.height * 4;
+    const double p50 = ms.Percentile(50);
+    std::string name = std::string("encode/") + content + "/" + encoder.Name();
+    zbench::Report(name.c_str(), "p50", p50, "ms");
+    zbench::Report(name.c_str(), "throughput", rawBytes / 1e6 / (p50 / 1e3), "MB/s");
+    zbench::Report(name.c_str(), "size", 100.0 * out.size() / rawBytes, "% of raw");
+}
+
+}  // namespace
+
+int main() {
+    ztools::EncoderRegistry registry;
+    ztools::RegisterBuiltinEncoders(registry);
+
+    ztools::Surface ui(kW, kH), photo(kW, kH);
+    FillUiLike(ui.view());
+    ztest::FillScreenLike(photo.view(), 7);
+
+    for (const std::string& format : registry.Names()) {
+        const ztools::ImageEncoder* encoder = registry.Find(format);
+        Measure("ui", ui.view(), *encoder);
+        Measure("photo", photo.view(), *encoder);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// 放大镜基准：4K 截屏上模拟一段鼠标轨迹，每次移动做一次完整的面板更新（取样放大 + HEX / RGB / HSL + 坐标读数）。
+// 截图信息面板（136x72，zoom 4）与取色器（9x9 格，每格 16px）两种规格，对比旧路径的等价实现：
+// 每次移动新分配放大缓冲、逐像素按比例取样、snprintf 后再转成宽字符串。
+// 全局 operator new 计数，给出每次移动的分配次数（新路径应为 0）。
+#include "core/magnifier.h"
+#include "core/simd.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<long long> g_allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using ztools::ImageView;
+
+namespace {
+
+const int kScreenW = 3840, kScreenH = 2160;
+const int kMoves = 20000;
+
+struct Point {
+    int x;
+    int y;
+};
+
+// 伪随机游走的鼠标轨迹，偶尔贴到屏幕边缘（放大镜越界填充）
+std::vector<Point> MakeTrack() {
+    std::vector<Point> track;
+    track.reserve(kMoves);
+    std::uint32_t state = 4242;
+    int x = kScreenW / 2, y = kScreenH / 2;
+    for (int i = 0; i < kMoves; i++) {
+        state = state * 1664525u + 1013904223u;
+        x += static_cast<int>((state >> 24) % 17) - 8;
+        y += static_cast<int>((state >> 16) % 17) - 8;
+        if (i % 2000 == 0) x = (i / 2000) % 2 ? 0 : kScreenW - 1;
+        x = (std::max)(0, (std::min)(x, kScreenW - 1));
+        y = (std::max)(0, (std::min)(y, kScreenH - 1));
+        track.push_back({x, y});
+    }
+    return track;
+}
+
+// 旧路径的等价实现：放大缓冲按次分配，逐输出像素按比例回算源坐标，读数经 snprintf 与 std::wstring
+struct LegacyPanel {
+    int width, height, zoom;
+    std::size_t Update(const ImageView& src, Point p) {
+        std::vector<std::uint32_t> out(static_cast<size_t>(width) * height);
+        const int srcW = width / zoom, srcH = height / zoom;
+        for (int y = 0; y < height; y++) {
+            const int sy = p.y - srcH / 2 + y * srcH / height;
+            for (int x = 0; x < width; x++) {
+                const int sx = p.x - srcW / 2 + x * srcW / width;
+                const bool inside = sx >= 0 && sy >= 0 && sx < src.width && sy < src.height;
+                out[static_cast<size_t>(y) * width + x] = inside ? src.Row(sy)[sx] : 0;
+            }
+        }
+        const std::uint32_t c = src.Row(p.y)[p.x];
+        char hex[32], rgb[32], pos[64];
+        std::snprintf(hex, sizeof(hex), "#%02X%02X%02X", (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+        std::snprintf(rgb, sizeof(rgb), "%u, %u, %u", (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+        std::snprintf(pos, sizeof(pos), "%d, %d", p.x, p.y);
+        std::wstring hexW(hex, hex + std::strlen(hex));
+        std::wstring rgbW(rgb, rgb + std::strlen(rgb));
+        std::wstring posW(pos, pos + std::strlen(pos));
+        return out[out.size() / 2] + hexW.size() + rgbW.size() + posW.size();
+    }
+};
+
+template <typename Fn>
+void Run(const std::string& name, const std::vector<Point>& track, Fn&& move) {
+    zbench::Samples samples;
+    samples.Reserve(track.size());
+    long long allocations = 0;
+    for (const Point& p : track) {
+        const long long before = g_allocations.load(std::memory_order_relaxed);
+        zbench::Stopwatch sw;
+        move(p);
+        const double ns = sw.ElapsedNs();
+        allocations += g_allocations.load(std::memory_order_relaxed) - before;
+        samples.Add(ns);
+    }
+    zbench::Report(name.c_str(), "p50", samples.Percentile(50) / 1000.0, "us/move");
+    zbench::Report(name.c_str(), "p99", samples.Percentile(99) / 1000.0, "us/move");
+    zbench::Report(name.c_str(), "allocations", static_cast<double>(allocations) / track.size(), "per move");
+}
+
+void Measure(const char* label, const ImageView& screen, const std::vector<Point>& track, int w, int h, int zoom) {
+    ztools::Magnifier mag;
+    mag.Configure(w, h, zoom);
+    ztools::ColorReadout readout;
+    char pos[24];
+    Run(std::string("magnifier/") + label + " " + ztools::SimdIsa(), track, [&](Point p) {
+        mag.Configure(w, h, zoom);
+        mag.Render(screen, p.x, p.y, 0);
+        ztools::FormatColorReadout(mag.Center(), readout);
+        ztools::FormatPoint(p.x, p.y, pos);
+        zbench::DoNotOptimize(readout.hsl[0]);
+    });
+
+    LegacyPanel legacy{w, h, zoom};
+    Run(std::string("magnifier/") + label + " legacy", track,
+        [&](Point p) { zbench::DoNotOptimize(legacy.Update(screen, p)); });
+}
+
+}  // namespace
+
+int main() {
+    ztools::Surface screen(kScreenW, kScreenH);
+    ztest::FillScreenLike(screen.view(), 48);
+    const std::vector<Point> track = MakeTrack();
+
+    Measure("info panel 136x72 x4", screen.view(), track, 136, 72, 4);
+    Measure("picker 9x9 x16", screen.view(), track, 144, 144, 16);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// 截图启动的抓屏量随显示器数量的变化：1~4 块错位排列的混合显示器（4K 高 DPI + 2K + 1080p），
+// 以整块内存复制代替 BitBlt，对比三种抓法的启动耗时与抓取量：
+// 整个外包矩形（旧路径）、只抓显示器覆盖区（外包矩形里的空洞不抓）、只抓鼠标所在显示器（monitor: 'cursor'）。
+#include "core/monitor_layout.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <string>
+#include <vector>
+
+using ztools::IntRect;
+using ztools::MonitorDesc;
+using ztools::MonitorLayout;
+using ztools::Surface;
+
+namespace {
+
+const int kRounds = 10;
+
+MonitorDesc Monitor(int x, int y, int w, int h, int dpi) {
+    MonitorDesc m;
+    m.bounds = IntRect(x, y, w, h);
+    m.dpi = dpi;
+    return m;
+}
+
+// 把 rects（虚拟屏坐标）从桌面复制进以 origin 为左上角的会话截图
+void CaptureInto(const Surface& desktop, const IntRect& desktopBounds, const std::vector<IntRect>& rects,
+                 const IntRect& target, Surface& session) {
+    session.Allocate(target.w, target.h);
+    for (const IntRect& r : rects) {
+        const IntRect dst = r.Offset(-target.x, -target.y);
+        ztools::Copy(desktop.view(), r.x - desktopBounds.x, r.y - desktopBounds.y, session.view(), dst);
+    }
+}
+
+void Measure(const std::string& name, const Surface& desktop, const IntRect& desktopBounds,
+             const std::vector<IntRect>& rects, const IntRect& target) {
+    Surface session;
+    zbench::Samples samples;
+    long long pixels = 0;
+    for (const IntRect& r : rects) pixels += static_cast<long long>(r.w) * r.h;
+    for (int i = 0; i < kRounds; i++) {
+        session.Release();
+        zbench::Stopwatch sw;
+        CaptureInto(desktop, desktopBounds, rects, target, session);
+        samples.Add(sw.ElapsedMs());
+        zbench::DoNotOptimize(session.view().Row(0)[0]);
+    }
+    zbench::Report(name.c_str(), "p50", samples.Percentile(50), "ms");
+    zbench::Report(name.c_str(), "captured", pixels * 4.0 / (1024 * 1024), "MB");
+}
+
+}  // namespace
+
+int main() {
+    const std::vector<MonitorDesc> all = {
+        Monitor(0, 0, 2560, 1440, 96),           // 主屏
+        Monitor(-3840, 0, 3840, 2160, 192),      // 左侧 4K 高 DPI
+        Monitor(2560, 360, 1920, 1080, 96),      // 右侧下沉
+        Monitor(0, -1080, 1920, 1080, 120),      // 主屏上方
+    };
+    for (int n = 1; n <= static_cast<int>(all.size()); n++) {
+        const MonitorLayout layout(std::vector<MonitorDesc>(all.begin(), all.begin() + n));
+        const IntRect bounds = layout.Bounds();
+        Surface desktop(bounds.w, bounds.h);
+        ztest::FillScreenLike(desktop.view(), n);
+
+        const std::string prefix = "capture start/" + std::to_string(n) + " monitor" + (n > 1 ? "s" : "") + " ";
+        Measure(prefix + "bounding box", desktop, bounds, std::vector<IntRect>(1, bounds), bounds);
+        std::vector<IntRect> coverage;
+        layout.Coverage(bounds, coverage);
+        Measure(prefix + "coverage", desktop, bounds, coverage, bounds);
+        const IntRect cursor = layout[layout.IndexAt(100, 100)].bounds;
+        Measure(prefix + "cursor monitor", desktop, bounds, std::vector<IntRect>(1, cursor), cursor);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+// 光栅核心基准：按截图编辑器的典型工作负载（4K 物理屏、150% DPI）测量各原语的吞吐
+#include "core/raster.h"
+#include "bench_harness.h"
+#include "raster_fixtures.h"
+
+#include <functional>
+#include <string>
+
+using ztools::ImageView;
+using ztools::IntRect;
+using ztools::ScaleFilter;
+using ztools::Surface;
+
+namespace {
+
+const int kPhysW = 3840, kPhysH = 2160;
+const double kDpi = 1.5;
+const int kLogW = 2560, kLogH = 1440;
+
+// 运行 fn 若干次，报告中位耗时与每百万像素耗时
+void Run(const char* name, double megapixels, int iterations, const std::function<void()>& fn) {
+    fn();  // 预热（首次触页）
+    zbench::Samples samples;
+    for (int i = 0; i < iterations; i++) {
+        zbench::Stopwatch sw;
+        fn();
+        samples.Add(sw.ElapsedMs());
+    }
+    double median = samples.Percentile(50);
+    zbench::Report(name, "median", median, "ms");
+    zbench::Report(name, "per MP", median / megapixels, "ms/MP");
+}
+
+}  // namespace
+
+int main() {
+    Surface phys(kPhysW, kPhysH);
+    ztest::FillScreenLike(phys.view(), 1);
+    Surface logical(kLogW, kLogH);
+    const double logicalMP = kLogW * kLogH / 1e6;
+
+    Run("raster/copy full", logicalMP, 20,
+        [&] { ztools::Copy(phys.view(), 0, 0, logical.view(), logical.view().Bounds()); });
+    Run("raster/dpi box 150%", logicalMP, 10,
+        [&] { ztools::CopyFromPhysical(phys.view(), kDpi, logical.view(), logical.view().Bounds()); });
+    Run("raster/dpi bilinear 150%", logicalMP, 10, [&] {
+        ztools::CopyFromPhysical(phys.view(), kDpi, logical.view(), logical.view().Bounds(), ScaleFilter::Bilinear);
+    });
+    Run("raster/dim outside", logicalMP, 20, [&] {
+        ztools::BlendSolidOutside(logical.view(), IntRect(800, 400, 900, 600), ztools::PackBgra(0, 0, 0), 120);
+    });
+
+    Surface magnifier(240, 160);
+    Run("raster/magnifier nearest", magnifier.width() * magnifier.height() / 1e6, 200, [&] {
+        ztools::Scale(phys.view(), IntRect(1900, 1060, 60, 40), magnifier.view(), magnifier.view().Bounds(),
+                      ScaleFilter::Nearest);
+    });
+
+    for (int block : {6, 10, 16}) {
+        std::string name = "raster/mosaic " + std::to_string(block) + "px";
+        Run(name.c_str(), logicalMP, 5,
+            [&] { ztools::Mosaic(phys.view(), kDpi, logical.view(), logical.view().Bounds(), block); });
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// 滚动长截图基准：1280x900 的选区在 30000 行的合成长页面上按不规则步长下滚（固定表头 / 表尾 + 移动的滚动条），
+// 1. 偏移匹配：行签名 + 锚点投票（本帧按需哈希 / 整帧先哈希 / 签名已由等待画面稳定时算好），
+//    对比逐偏移逐行 memcmp 的穷举匹配（文字页、滚动过头、大段空白的稀疏页）；
+// 2. 拼接（含匹配）：瓦片长图逐帧追加，对比整幅连续缓冲随帧扩容（std::vector 追加），给出单帧耗时、总耗时与内存峰值。
+#include "core/scroll_stitch.h"
+#include "bench_harness.h"
+#include "scroll_fixtures.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using ztools::ImageView;
+using ztools::Surface;
+
+namespace {
+
+const int kFrameW = 1280, kFrameH = 900;
+const int kPageH = 30000;
+const ztest::ScrollFrameLayout kLayout = {64, 40, 14};
+
+// 每步 120~420 行的伪随机滚动距离，直到页面末尾
+std::vector<int> MakeScrollPositions() {
+    std::vector<int> positions(1, 0);
+    const int last = kPageH - (kFrameH - kLayout.header - kLayout.footer);
+    std::uint32_t state = 77;
+    while (positions.back() < last) {
+        state = state * 1664525u + 1013904223u;
+        positions.push_back((std::min)(last, positions.back() + 120 + static_cast<int>((state >> 16) % 301)));
+    }
+    return positions;
+}
+
+// 穷举匹配：从小到大逐个偏移比较重叠段（表头 / 表尾已知，滚动条列不比较），第一行不等即换下一个偏移
+int BruteForceOffset(const ImageView& prev, const ImageView& cur) {
+    const int top = kLayout.header, end = kFrameH - kLayout.footer;
+    const size_t bytes = static_cast<size_t>(kFrameW - kLayout.scrollbar) * 4;
+    for (int offset = 1; offset < end - top - 24; offset++) {
+        bool same = true;
+        for (int y = top; y < end - offset && same; y++) same = std::memcmp(cur.Row(y), prev.Row(y + offset), bytes) == 0;
+        if (same) return offset;
+    }
+    return -1;
+}
+
+std::vector<Surface> ComposeFrames(const ImageView& page, const std::vector<int>& positions) {
+    std::vector<Surface> frames(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        frames[i].Allocate(kFrameW, kFrameH);
+        ztest::ComposeScrollFrame(page, positions[i], kLayout, frames[i].view());
+    }
+    return frames;
+}
+
+// 相邻帧（stride = 1）或隔几帧（滚动过头、没有重叠，期望找不到）两两匹配
+void MeasureMatch(const char* label, const std::vector<Surface>& frames, const std::vector<int>& positions, int stride) {
+    const int viewH = kFrameH - kLayout.header - kLayout.footer;
+    auto expected = [&](size_t i) {
+        const int offset = positions[i] - positions[i - stride];
+        return offset < viewH ? offset : -1;
+    };
+    ztools::ScrollMatcher matcher;
+    std::vector<std::uint64_t> prev, cur;
+    // wrong：给出了错误的偏移（会拼错）；unresolved：该有重叠却没给出（调用方缩小步长重试）
+    auto report = [](const std::string& name, zbench::Samples& samples, int wrong, int unresolved) {
+        zbench::Report(name.c_str(), "p50", samples.Percentile(50) / 1000.0, "us/frame");
+        zbench::Report(name.c_str(), "p99", samples.Percentile(99) / 1000.0, "us/frame");
+        zbench::Report(name.c_str(), "wrong", wrong, "frames");
+        zbench::Report(name.c_str(), "unresolved", unresolved, "frames");
+    };
+    // lazy：本帧按需哈希；full：整帧先 HashRows 再匹配；reused：本帧签名已算好（Windows 侧等待画面稳定时），只计匹配
+    enum Mode { kLazy, kFull, kReused };
+    auto measure = [&](Mode mode, const char* suffix) {
+        zbench::Samples samples;
+        int wrong = 0, unresolved = 0;
+        for (size_t i = stride; i < frames.size(); i += stride) {
+            ztools::HashRows(frames[i - stride].view(), 0, kLayout.scrollbar, prev);  // 上一帧的签名在拼接时已缓存，不计时
+            if (mode == kReused) ztools::HashRows(frames[i].view(), 0, kLayout.scrollbar, cur);
+            zbench::Stopwatch sw;
+            ztools::ScrollMatch m;
+            if (mode == kLazy) {
+                m = matcher.Match(prev, frames[i].view(), 0, kLayout.scrollbar, cur);
+            } else {
+                if (mode == kFull) ztools::HashRows(frames[i].view(), 0, kLayout.scrollbar, cur);
+                m = matcher.Match(prev, cur);
+            }
+            samples.Add(sw.ElapsedNs());
+            // offset 0 只在内容区完全相同时出现（整屏空白），拼接器会结合滚动条判为没有重叠
+            const int offset = m.found && m.offset > 0 ? m.offset : -1;
+            wrong += offset >= 0 && offset != expected(i);
+            unresolved += offset < 0 && expected(i) >= 0;
+        }
+        report(std::string("scroll match/") + label + " row hash " + suffix, samples, wrong, unresolved);
+    };
+    measure(kLazy, "lazy");
+    measure(kFull, "full");
+    measure(kReused, "reused");
+
+    zbench::Samples brute;
+    int wrong = 0, unresolved = 0;
+    for (size_t i = stride; i < frames.size(); i += stride) {
+        zbench::Stopwatch sw;
+        const int offset = BruteForceOffset(frames[i - stride].view(), frames[i].view());
+        brute.Add(sw.ElapsedNs());
+        wrong += offset >= 0 && offset != expected(i);
+        unresolved += offset < 0 && expected(i) >= 0;
+    }
+    report(std::string("scroll match/") + label + " brute force", brute, wrong, unresolved);
+}
+
+}  // namespace
+
+int main() {
+    Surface page(kFrameW - kLayout.scrollbar, kPageH);
+    ztest::FillDocumentLike(page.view(), 21);
+    Surface pageFull(kFrameW, kPageH);
+    ztools::Copy(page.view(), 0, 0, pageFull.view(), page.view().Bounds());
+    const std::vector<int> positions = MakeScrollPositions();
+
+    // 预先合成全部帧，计时只含匹配 / 拼接
+    const std::vector<Surface> frames = ComposeFrames(pageFull.view(), positions);
+
+    // ---- 偏移匹配 ----
+    // 文字页；每 3 帧取一帧（滚动过头，没有重叠）；大段空白相间的稀疏页（聊天记录、代码留白）
+    MeasureMatch("text", frames, positions, 1);
+    MeasureMatch("overshoot", frames, positions, 3);
+    {
+        Surface sparse(kFrameW, kPageH);
+        ztools::Copy(pageFull.view(), 0, 0, sparse.view(), sparse.view().Bounds());
+        for (int y = 0; y < kPageH; y += 1200) {
+            ztools::Fill(sparse.view(), ztools::IntRect(0, y + 400, kFrameW, 800), ztest::kPageBackground);
+        }
+        MeasureMatch("sparse", ComposeFrames(sparse.view(), positions), positions, 1);
+    }
+
+    // ---- 拼接 ----
+    {
+        ztools::ScrollStitchOptions options;
+        options.ignoreRight = kLayout.scrollbar;
+        options.maxHeight = kPageH + kFrameH;
+        ztools::ScrollStitcher stitcher(options);
+        zbench::Samples samples;
+        zbench::Stopwatch total;
+        stitcher.Begin(frames[0].view());
+        for (size_t i = 1; i < frames.size(); i++) {
+            const ztools::StitchStep step = stitcher.Append(frames[i].view());
+            samples.Add(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(step.elapsed).count()));
+        }
+        const double ms = total.ElapsedMs();
+        const ztools::TiledImage& image = stitcher.image();
+        zbench::Report("scroll stitch/tiled", "frames", static_cast<double>(frames.size()), "");
+        zbench::Report("scroll stitch/tiled", "height", image.height(), "rows");
+        zbench::Report("scroll stitch/tiled", "append p50", samples.Percentile(50) / 1000.0, "us/frame");
+        zbench::Report("scroll stitch/tiled", "append p99", samples.Percentile(99) / 1000.0, "us/frame");
+        zbench::Report("scroll stitch/tiled", "total", ms, "ms");
+        zbench::Report("scroll stitch/tiled", "peak", image.ByteSize() / (1024.0 * 1024.0), "MB");
+        zbench::DoNotOptimize(image.Row(image.height() - 1)[0]);
+
+        // 整幅连续缓冲：同样的按需签名匹配，每帧把新滚入的行追加到同一个 vector，容量不足时整体搬移
+        ztools::ScrollMatcher matcher;
+        std::vector<std::uint64_t> prev, cur;
+        std::vector<std::uint32_t> flat;
+        size_t peak = 0;
+        int moves = 0;
+        zbench::Samples flatSamples;
+        zbench::Stopwatch flatTotal;
+        auto append = [&](const ImageView& src, int from, int rows) {
+            const size_t need = flat.size() + static_cast<size_t>(rows) * kFrameW;
+            if (need > flat.capacity()) {
+                peak = (std::max)(peak, (flat.capacity() + (std::max)(need, flat.capacity() * 2)) * 4);
+                moves++;
+            }
+            for (int y = from; y < from + rows; y++) flat.insert(flat.end(), src.Row(y), src.Row(y) + kFrameW);
+        };
+        ztools::HashRows(frames[0].view(), 0, kLayout.scrollbar, prev, 0);
+        append(frames[0].view(), 0, kFrameH - kLayout.footer);
+        for (size_t i = 1; i < frames.size(); i++) {
+            zbench::Stopwatch sw;
+            const ztools::ScrollMatch m = matcher.Match(prev, frames[i].view(), 0, kLayout.scrollbar, cur, 0);
+            const int offset = m.found ? m.offset : 0;
+            if (m.found) prev.swap(cur);
+            append(frames[i].view(), kFrameH - kLayout.footer - offset, offset);
+            flatSamples.Add(sw.ElapsedNs());
+        }
+        append(frames.back().view(), kFrameH - kLayout.footer, kLayout.footer);
+        const double flatMs = flatTotal.ElapsedMs();
+        peak = (std::max)(peak, flat.capacity() * 4);
+        zbench::Report("scroll stitch/contiguous", "append p50", flatSamples.Percentile(50) / 1000.0, "us/frame");
+        zbench::Report("scroll stitch/contiguous", "append p99", flatSamples.Percentile(99) / 1000.0, "us/frame");
+        zbench::Report("scroll stitch/contiguous", "total", flatMs, "ms");
+        zbench::Report("scroll stitch/contiguous", "peak", peak / (1024.0 * 1024.0), "MB");
+        zbench::Report("scroll stitch/contiguous", "reallocations", moves, "");
+        zbench::DoNotOptimize(flat.back());
+    }
+    return 0;
+}
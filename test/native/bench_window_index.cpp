@@ -0,0 +1,87 @@
+// 截图待选窗口查找基准：窗口数量 vs 建索引耗时（进入截图时一次）与每次鼠标移动的查找耗时。
+// 「线性」对应旧实现按 z 序逐个比较窗口矩形；「网格」为 256px 均匀网格上的 FirstItemAt。
+// 合成窗口：前几个最大化 / 大窗口在顶层，其余大小不一的窗口散布在三屏虚拟桌面上（可为负坐标）。
+#include "core/hit_index.h"
+#include "bench_harness.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using ztools::HitGrid;
+using ztools::HitPart;
+using ztools::IntRect;
+
+namespace {
+
+const IntRect kDesktop(-1920, 0, 1920 + 2560 + 1920, 1440);
+
+std::vector<IntRect> MakeWindows(int count) {
+    std::vector<IntRect> windows;
+    std::uint32_t seed = 3;
+    auto next = [&seed](int mod) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<int>((seed >> 8) % static_cast<std::uint32_t>(mod));
+    };
+    for (int i = 0; i < count; i++) {
+        if (i % 50 == 49) {
+            windows.push_back(IntRect(-1920 + (i % 3) * 1920, 0, 1920, 1040));  // 某屏最大化
+        } else {
+            int w = 50 + next(900), h = 50 + next(600);
+            windows.push_back(IntRect(kDesktop.x + next(kDesktop.w - w), next(kDesktop.h - h), w, h));
+        }
+    }
+    return windows;
+}
+
+}  // namespace
+
+int main() {
+    for (int count : {50, 500, 2000, 5000}) {
+        std::vector<IntRect> windows = MakeWindows(count);
+        std::string suffix = " " + std::to_string(count) + " wnds";
+
+        zbench::Stopwatch buildSw;
+        HitGrid grid(256);
+        std::vector<HitPart> parts(1);
+        for (int i = 0; i < count; i++) {
+            parts[0].box = windows[i];
+            grid.SetItem(i, parts);
+        }
+        zbench::Report(("windows/index build" + suffix).c_str(), "once", buildSw.ElapsedMs(), "ms");
+
+        // 鼠标沿对角线扫过三屏（每步 7px 左右，相当于快速移动）
+        std::vector<std::pair<int, int>> moves;
+        for (int i = 0; i < 20000; i++) moves.push_back({kDesktop.x + (i * 7) % kDesktop.w, (i * 3) % kDesktop.h});
+
+        zbench::Samples linear, indexed;
+        std::int64_t sumLinear = 0, sumIndexed = 0;
+        for (const auto& m : moves) {
+            zbench::Stopwatch sw;
+            int hit = -1;
+            for (int i = 0; i < count; i++) {
+                if (windows[i].Contains(m.first, m.second)) {
+                    hit = i;
+                    break;
+                }
+            }
+            linear.Add(sw.ElapsedNs());
+            sumLinear += hit;
+        }
+        for (const auto& m : moves) {
+            zbench::Stopwatch sw;
+            int hit = grid.FirstItemAt(m.first, m.second);
+            indexed.Add(sw.ElapsedNs());
+            sumIndexed += hit;
+        }
+        zbench::Report(("windows/linear per move" + suffix).c_str(), "p50", linear.Percentile(50), "ns");
+        zbench::Report(("windows/linear per move" + suffix).c_str(), "p99", linear.Percentile(99), "ns");
+        zbench::Report(("windows/grid per move" + suffix).c_str(), "p50", indexed.Percentile(50), "ns");
+        zbench::Report(("windows/grid per move" + suffix).c_str(), "p99", indexed.Percentile(99), "ns");
+        if (sumLinear != sumIndexed) {
+            std::printf("  ❌ lookup mismatch\n");
+            return 1;
+        }
+    }
+    return 0;
+}
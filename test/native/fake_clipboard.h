@@ -0,0 +1,209 @@
+#pragma once
+
+// 测试用假剪贴板：
+// - 假时钟 + 按时间排队的写入，模拟目标应用在注入 Ctrl+C 后延迟（或分批）写剪贴板；
+// - 同时实现 ClipboardBackend，按写入顺序枚举格式，可模拟打不开剪贴板、无法按字节读取的格式。
+
+#include "core/clipboard_snapshot.h"
+#include "core/selection_capture.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ztest {
+
+class FakeClipboard : public ztools::ClipboardChangeSource, public ztools::ClipboardBackend {
+public:
+    using Bytes = std::vector<std::uint8_t>;
+    using Formats = std::vector<std::pair<std::uint32_t, Bytes>>;
+
+    TimePoint now{};
+    std::uint32_t sequence = 1;
+    Formats formats;                     // 按 SetClipboardData 顺序
+    std::set<std::uint32_t> opaque;      // 模拟 GDI 句柄等无法按字节读取的格式
+    std::map<std::uint32_t, std::string> names;  // 注册格式名
+    int failOpens = 0;                   // 接下来 N 次 Open 失败（被其他进程占用）
+    int waitCalls = 0;
+    int openCalls = 0;
+    int writeCalls = 0;
+    bool isOpen = false;
+
+    // ---- ClipboardChangeSource ----
+    TimePoint Now() override { return now; }
+
+    std::uint32_t SequenceNumber() override {
+        ApplyDue();
+        return sequence;
+    }
+
+    std::uint32_t WaitForChange(std::uint32_t since, TimePoint deadline) override {
+        ++waitCalls;
+        ApplyDue();
+        while (sequence == since) {
+            if (pending_.empty() || pending_.begin()->first > deadline) {
+                if (deadline > now) now = deadline;
+                break;
+            }
+            now = std::max(now, pending_.begin()->first);
+            ApplyDue();
+        }
+        return sequence;
+    }
+
+    // ---- ClipboardBackend ----
+    bool Open() override {
+        ++openCalls;
+        if (failOpens > 0) {
+            --failOpens;
+            return false;
+        }
+        isOpen = true;
+        return true;
+    }
+
+    void Close() override { isOpen = false; }
+
+    std::vector<std::uint32_t> EnumFormats() override {
+        std::vector<std::uint32_t> ids;
+        for (const auto& f : formats) ids.push_back(f.first);
+        return ids;
+    }
+
+    std::string FormatName(std::uint32_t format) override {
+        auto it = names.find(format);
+        return it == names.end() ? std::string() : it->second;
+    }
+
+    int reads = 0;
+
+    bool ReadFormat(std::uint32_t format, const std::uint8_t*& data, size_t& size) override {
+        if (!isOpen || opaque.count(format)) return false;
+        const Bytes* bytes = Get(format);
+        if (!bytes) return false;
+        ++reads;
+        data = bytes->data();
+        size = bytes->size();
+        return true;
+    }
+
+    void ReleaseFormat(std::uint32_t) override {}
+
+    bool EmptyClipboard() override {
+        if (!isOpen) return false;
+        formats.clear();
+        ++sequence;
+        return true;
+    }
+
+    bool WriteFormat(std::uint32_t format, const std::uint8_t* data, size_t size) override {
+        if (!isOpen) return false;
+        ++writeCalls;
+        Put(format, Bytes(data, data + size));
+        ++sequence;
+        return true;
+    }
+
+    // ---- 测试辅助 ----
+    void Advance(Duration d) {
+        now += d;
+        ApplyDue();
+    }
+
+    // 立即替换全部内容（相当于 EmptyClipboard + 若干 SetClipboardData）
+    void Set(Formats next) {
+        formats = std::move(next);
+        ++sequence;
+    }
+
+    // 安排在 when 时刻追加/覆盖一个格式（empty=true 时先清空）
+    void WriteAt(TimePoint when, std::uint32_t format, Bytes data, bool empty = false) {
+        pending_.emplace(when, Write{format, std::move(data), empty});
+    }
+
+    bool Has(std::uint32_t format) const { return Get(format) != nullptr; }
+
+    const Bytes* Get(std::uint32_t format) const {
+        for (const auto& f : formats) {
+            if (f.first == format) return &f.second;
+        }
+        return nullptr;
+    }
+
+    static Bytes Text(const std::string& s) { return Bytes(s.begin(), s.end()); }
+
+    // ASCII 文本 -> 带结尾 NUL 的 UTF-16LE（CF_UNICODETEXT）
+    static Bytes Utf16(const std::u16string& s) {
+        Bytes b;
+        for (char16_t c : s) {
+            b.push_back(static_cast<std::uint8_t>(c & 0xFF));
+            b.push_back(static_cast<std::uint8_t>(c >> 8));
+        }
+        b.push_back(0);
+        b.push_back(0);
+        return b;
+    }
+
+    // BITMAPINFOHEADER + 32bpp 像素（CF_DIB）
+    static Bytes Dib(int width, int height, std::uint8_t fill = 0x80) {
+        Bytes b(40 + static_cast<size_t>(width) * height * 4, fill);
+        std::uint32_t header[3] = {40, static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height)};
+        std::memcpy(b.data(), header, sizeof(header));
+        std::uint16_t planes = 1, bits = 32;
+        std::memcpy(b.data() + 12, &planes, 2);
+        std::memcpy(b.data() + 14, &bits, 2);
+        std::memset(b.data() + 16, 0, 24);
+        return b;
+    }
+
+    // DROPFILES + 宽字符路径列表（CF_HDROP）
+    static Bytes DropFiles(const std::vector<std::u16string>& paths) {
+        Bytes b(20, 0);
+        std::uint32_t offset = 20, wide = 1;
+        std::memcpy(b.data(), &offset, 4);
+        std::memcpy(b.data() + 16, &wide, 4);
+        for (const auto& p : paths) {
+            Bytes w = Utf16(p);
+            b.insert(b.end(), w.begin(), w.end());
+        }
+        b.push_back(0);
+        b.push_back(0);
+        return b;
+    }
+
+private:
+    struct Write {
+        std::uint32_t format;
+        Bytes data;
+        bool empty;
+    };
+
+    void Put(std::uint32_t format, Bytes data) {
+        for (auto& f : formats) {
+            if (f.first == format) {
+                f.second = std::move(data);
+                return;
+            }
+        }
+        formats.emplace_back(format, std::move(data));
+    }
+
+    void ApplyDue() {
+        while (!pending_.empty() && pending_.begin()->first <= now) {
+            Write& w = pending_.begin()->second;
+            if (w.empty) formats.clear();
+            Put(w.format, std::move(w.data));
+            ++sequence;
+            pending_.erase(pending_.begin());
+        }
+    }
+
+    std::multimap<TimePoint, Write> pending_;
+};
+
+}  // namespace ztest
@@ -0,0 +1,92 @@
+#pragma once
+
+// 测试 / 基准用无界面区域截图会话：按覆盖层的流程走一遍，只是没有窗口。
+// 开始时从持久帧（合成后端）取整屏截图；确认时在调用线程上把选区裁成成品像素，
+// 交给导出流水线（或同步导出）后「关闭覆盖层」，记录从确认到关闭的耗时。
+
+#include "core/capture_backend.h"
+#include "core/export_pipeline.h"
+#include "synthetic_capture.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace ztest {
+
+class HeadlessRegionSession {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    HeadlessRegionSession(int width, int height) {
+        auto backend = std::make_unique<SyntheticCaptureBackend>(width, height);
+        backend_ = backend.get();
+        capture_.Reset(std::move(backend));
+    }
+
+    SyntheticCaptureBackend& backend() { return *backend_; }
+    const ztools::Surface& screen() const { return screen_; }
+
+    // 截图开始：刷新持久帧并复制出本次会话的整屏截图
+    bool Begin() {
+        closed_ = false;
+        if (!capture_.Update()) return false;
+        screen_.Allocate(capture_.Bounds().w, capture_.Bounds().h);
+        return capture_.Snapshot(screen_.view(), 1);
+    }
+
+    // 确认选区：裁出成品像素，交给流水线后关闭；stages 中 image / release 由这里填写
+    ztools::ExportId Confirm(const ztools::IntRect& selection, ztools::ExportPipeline& pipeline,
+                             ztools::ExportJob stages) {
+        const Clock::time_point confirmedAt = Clock::now();
+        auto image = Render(selection);
+        stages.confirmedAt = confirmedAt;
+        stages.image = image->view();
+        stages.release = [image]() mutable { image.reset(); };
+        ztools::ExportId id = pipeline.Submit(std::move(stages));
+        Close(confirmedAt);
+        return id;
+    }
+
+    // 旧流程：在调用线程上编码、发布完再关闭
+    ztools::ExportResult ConfirmSync(const ztools::IntRect& selection, const ztools::ExportJob& stages) {
+        const Clock::time_point confirmedAt = Clock::now();
+        auto image = Render(selection);
+        ztools::ExportResult r;
+        r.width = image->width();
+        r.height = image->height();
+        r.encoded = stages.encode(image->view(), r.payload);
+        r.timings.encoded = Clock::now() - confirmedAt;
+        if (stages.publish) {
+            r.published = stages.publish(image->view());
+            r.timings.published = Clock::now() - confirmedAt;
+        }
+        Close(confirmedAt);
+        r.timings.delivered = closeLatency_;
+        return r;
+    }
+
+    bool closed() const { return closed_; }
+    Clock::duration closeLatency() const { return closeLatency_; }
+
+private:
+    std::shared_ptr<ztools::Surface> Render(const ztools::IntRect& selection) {
+        ztools::IntRect r = selection.Intersect(screen_.view().Bounds());
+        auto image = std::make_shared<ztools::Surface>(r.w, r.h);
+        ztools::Copy(screen_.view(), r.x, r.y, image->view(), image->view().Bounds());
+        return image;
+    }
+
+    void Close(Clock::time_point confirmedAt) {
+        closed_ = true;
+        closeLatency_ = Clock::now() - confirmedAt;
+    }
+
+    ztools::DuplicationCapture capture_;
+    SyntheticCaptureBackend* backend_ = nullptr;
+    ztools::Surface screen_;
+    bool closed_ = false;
+    Clock::duration closeLatency_{};
+};
+
+}  // namespace ztest
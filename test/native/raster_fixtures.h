@@ -0,0 +1,39 @@
+#pragma once
+
+// 光栅核心测试 / 基准共用的确定性图像与校验工具
+
+#include "core/content_hash.h"
+#include "core/raster.h"
+
+#include <cstdint>
+
+namespace ztest {
+
+// 类似屏幕内容的确定性图案：渐变背景 + 细线 + 伪随机噪点（alpha 为 0，与 BitBlt 截屏一致）
+inline void FillScreenLike(const ztools::ImageView& view, std::uint32_t seed = 1) {
+    std::uint32_t state = seed * 2654435761u + 1;
+    for (int y = 0; y < view.height; y++) {
+        std::uint32_t* row = view.Row(y);
+        for (int x = 0; x < view.width; x++) {
+            state = state * 1664525u + 1013904223u;
+            std::uint8_t r = static_cast<std::uint8_t>(x * 255 / (view.width > 1 ? view.width - 1 : 1));
+            std::uint8_t g = static_cast<std::uint8_t>(y * 255 / (view.height > 1 ? view.height - 1 : 1));
+            std::uint8_t b = static_cast<std::uint8_t>(state >> 24);
+            if (x % 17 == 0 || y % 23 == 0) r = g = b = 20;  // 1px 细线，缩放时最容易丢
+            row[x] = ztools::PackBgra(r, g, b, 0);
+        }
+    }
+}
+
+// 逐行哈希（忽略 stride 填充字节）
+inline std::uint64_t ViewHash(const ztools::ImageView& view) {
+    ztools::ContentHasher hasher;
+    for (int y = 0; y < view.height; y++) hasher.Update(view.Row(y), static_cast<size_t>(view.width) * 4);
+    return hasher.Digest();
+}
+
+inline std::uint8_t Channel(std::uint32_t px, int c) {
+    return static_cast<std::uint8_t>((px >> (c * 8)) & 0xFF);
+}
+
+}  // namespace ztest
@@ -0,0 +1,72 @@
+#pragma once
+
+// 滚动长截图测试 / 基准共用的合成内容：类似网页 / 文档的长页面（成段的文字行 + 大量相同的空白行），
+// 以及从中按滚动位置截出的一帧（固定表头 / 表尾 + 右侧随滚动移动的滚动条）
+
+#include "core/raster.h"
+
+#include <cstdint>
+
+namespace ztest {
+
+const std::uint32_t kPageBackground = 0x00FFFFFFu;
+
+// 每 24 行一行文字（14 行字形 + 10 行空白），每 8 行文字后空出一段；字形为伪随机深色点阵
+inline void FillDocumentLike(const ztools::ImageView& page, std::uint32_t seed = 1) {
+    std::uint32_t state = seed * 2654435761u + 7;
+    for (int y = 0; y < page.height; y++) {
+        std::uint32_t* row = page.Row(y);
+        const int line = y / 24;
+        const bool glyphRow = y % 24 < 14 && line % 9 != 8;
+        const int indent = 16 + (line % 3) * 24;
+        const int length = page.width - indent - 40 - static_cast<int>((line * 37u) % (page.width / 3 + 1));
+        for (int x = 0; x < page.width; x++) {
+            std::uint32_t px = kPageBackground;
+            if (glyphRow && x >= indent && x < indent + length && (x - indent) % 9 < 7) {
+                state = state * 1664525u + 1013904223u;
+                if ((state >> 28) < 6) {
+                    const std::uint8_t v = static_cast<std::uint8_t>(30 + (state >> 20) % 60);
+                    px = ztools::PackBgra(v, v, static_cast<std::uint8_t>(v + 20), 0);
+                }
+            }
+            row[x] = px;
+        }
+    }
+}
+
+struct ScrollFrameLayout {
+    int header = 0;     // 固定表头行数
+    int footer = 0;     // 固定表尾行数
+    int scrollbar = 0;  // 右侧滚动条列数
+};
+
+// 把 page 从 scrollY 开始的内容截成 frame：表头 / 表尾为固定图案，滚动条滑块位置随 scrollY 变化
+inline void ComposeScrollFrame(const ztools::ImageView& page, int scrollY, const ScrollFrameLayout& layout,
+                               const ztools::ImageView& frame) {
+    const int contentW = frame.width - layout.scrollbar;
+    const int viewH = frame.height - layout.header - layout.footer;
+    const int range = page.height > viewH ? page.height - viewH : 1;
+    const int thumbH = viewH * viewH / (page.height > 0 ? page.height : 1) + 20;
+    const int thumbY = layout.header + (viewH - thumbH) * scrollY / range;
+    for (int y = 0; y < frame.height; y++) {
+        std::uint32_t* row = frame.Row(y);
+        const bool header = y < layout.header;
+        const bool footer = y >= frame.height - layout.footer;
+        const int sy = scrollY + y - layout.header;
+        for (int x = 0; x < frame.width; x++) {
+            std::uint32_t px;
+            if (header) {
+                px = ztools::PackBgra(40, static_cast<std::uint8_t>(60 + y), static_cast<std::uint8_t>((x * 3) & 0xFF), 0);
+            } else if (footer) {
+                px = ztools::PackBgra(static_cast<std::uint8_t>(200 - y % 50), 90, static_cast<std::uint8_t>(x & 0xFF), 0);
+            } else if (x >= contentW) {
+                px = y >= thumbY && y < thumbY + thumbH ? 0x00808080u : 0x00F0F0F0u;
+            } else {
+                px = sy >= 0 && sy < page.height ? page.Row(sy)[x] : kPageBackground;
+            }
+            row[x] = px;
+        }
+    }
+}
+
+}  // namespace ztest
@@ -0,0 +1,102 @@
+#pragma once
+
+// 测试 / 基准用合成捕获后端：内部保存一张「真实桌面」，通过 Paint / Scroll / Resize 改动它，
+// 并像 Desktop Duplication 一样累积移动 / 脏矩形，直到下一次 Acquire 一并交出。
+// 可模拟访问丢失（下一次 Acquire 失败），统计后端被读取的像素数。
+
+#include "core/capture_backend.h"
+#include "raster_fixtures.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ztest {
+
+class SyntheticCaptureBackend : public ztools::CaptureBackend {
+public:
+    SyntheticCaptureBackend(int width, int height) { Resize(width, height); }
+
+    ztools::Surface desktop;   // 真实画面（测试直接与持久帧比较）
+    int failAcquires = 0;      // 接下来 N 次 Acquire 失败
+    std::int64_t pixelsRead = 0;
+    int acquires = 0;
+
+    // 尺寸变化（显示器插拔 / 分辨率切换）：下一帧整帧失效
+    void Resize(int width, int height) {
+        desktop.Allocate(width, height);
+        FillScreenLike(desktop.view(), static_cast<std::uint32_t>(width + height));
+        pending_.Clear();
+        pending_.full = true;
+    }
+
+    // 一块区域内容变化（视频、光标闪烁、重绘）
+    void Paint(const ztools::IntRect& rect, std::uint32_t seed) {
+        ztools::IntRect r = rect.Intersect(desktop.view().Bounds());
+        if (r.Empty()) return;
+        FillScreenLike(desktop.view().Sub(r), seed);
+        pending_.dirty.push_back(r);
+    }
+
+    // rect 内内容上移 dy 像素（dy < 0 为下移），露出的一条重绘：报告为移动 + 脏矩形。
+    // 尚未交出的脏矩形落在 rect 内时，移动的源已不是上一帧内容，改为整块脏
+    void Scroll(const ztools::IntRect& rect, int dy, std::uint32_t seed) {
+        ztools::IntRect r = rect.Intersect(desktop.view().Bounds());
+        int shift = dy < 0 ? -dy : dy;
+        if (r.Empty() || shift == 0) return;
+        if (shift >= r.h) {
+            Paint(r, seed);
+            return;
+        }
+        const ztools::ImageView view = desktop.view();
+        ztools::IntRect from(r.x, dy > 0 ? r.y + shift : r.y, r.w, r.h - shift);
+        int toY = dy > 0 ? r.y : r.y + shift;
+        ztools::Surface tmp(from.w, from.h);
+        ztools::Copy(view, from.x, from.y, tmp.view(), tmp.view().Bounds());
+        ztools::Copy(tmp.view(), 0, 0, view, ztools::IntRect(from.x, toY, from.w, from.h));
+        ztools::IntRect exposed(r.x, dy > 0 ? r.Bottom() - shift : r.y, r.w, shift);
+        FillScreenLike(view.Sub(exposed), seed);
+
+        bool tainted = false;
+        for (const ztools::IntRect& d : pending_.dirty) tainted = tainted || !d.Intersect(r).Empty();
+        if (tainted) {
+            pending_.dirty.push_back(r);
+            return;
+        }
+        ztools::FrameMove move;
+        move.source = from;
+        move.x = from.x;
+        move.y = toY;
+        pending_.moves.push_back(move);
+        pending_.dirty.push_back(exposed);
+    }
+
+    // ---- CaptureBackend ----
+    const char* Name() const override { return "synthetic"; }
+    ztools::IntRect Bounds() const override { return desktop.view().Bounds(); }
+
+    bool Acquire(ztools::FrameDelta& delta, int /*timeoutMs*/) override {
+        acquires++;
+        if (failAcquires > 0) {
+            failAcquires--;
+            pending_.Clear();
+            pending_.full = true;  // 重新建立后第一帧整帧
+            return false;
+        }
+        delta = pending_;
+        pending_.Clear();
+        return true;
+    }
+
+    bool Read(const ztools::IntRect& rect, const ztools::ImageView& dst) override {
+        ztools::Copy(desktop.view(), rect.x, rect.y, dst, rect);
+        pixelsRead += static_cast<std::int64_t>(rect.w) * rect.h;
+        return true;
+    }
+
+    void Release() override {}
+
+private:
+    ztools::FrameDelta pending_;
+};
+
+}  // namespace ztest
@@ -0,0 +1,123 @@
+// 马赛克蒙版光栅化测试：胶囊覆盖率、增量与一次性结果一致、脏矩形、揭示层合成
+#include "core/brush_mask.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <algorithm>
+#include <vector>
+
+using ztools::CoverageMask;
+using ztools::IntRect;
+using ztools::MaskPoint;
+using ztools::Surface;
+
+namespace {
+
+std::vector<MaskPoint> Zigzag(int count) {
+    std::vector<MaskPoint> pts;
+    for (int i = 0; i < count; i++) pts.push_back({20 + i * 3, 40 + ((i / 5) % 2 ? 15 : -15) + (i % 5) * 2});
+    return pts;
+}
+
+bool SameMask(const CoverageMask& a, const CoverageMask& b) {
+    if (a.width() != b.width() || a.height() != b.height()) return false;
+    for (int y = 0; y < a.height(); y++)
+        for (int x = 0; x < a.width(); x++)
+            if (a.At(x, y) != b.At(x, y)) return false;
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(SinglePointIsADisc) {
+    CoverageMask mask;
+    mask.Reset(40, 40);
+    IntRect dirty = mask.StampCapsule({20, 20}, {20, 20}, 6);
+    CHECK_EQ(mask.At(20, 20), 255);
+    CHECK_EQ(mask.At(15, 20), 255);  // 中心距 ≈ 4.53 <= r - 0.5
+    CHECK_EQ(mask.At(13, 20), 0);    // 中心距 ≈ 6.52 >= r + 0.5
+    CHECK(mask.At(24, 24) > 0 && mask.At(24, 24) < 255);  // 中心距 ≈ 6.36：抗锯齿边
+    CHECK(dirty == IntRect(14, 14, 12, 12));
+    CHECK(mask.Touched() == dirty);
+}
+
+TEST_CASE(CapsuleCoversSegmentWithoutGaps) {
+    CoverageMask mask;
+    mask.Reset(100, 40);
+    mask.StampCapsule({10, 20}, {90, 20}, 3);
+    bool solid = true;
+    for (int x = 8; x < 92; x++) solid &= mask.At(x, 19) == 255 && mask.At(x, 20) == 255;
+    CHECK(solid);
+    CHECK_EQ(mask.At(50, 24), 0);
+    CHECK_EQ(mask.At(50, 15), 0);
+}
+
+TEST_CASE(IncrementalStrokeMatchesOneShot) {
+    std::vector<MaskPoint> pts = Zigzag(60);
+    CoverageMask whole, incremental;
+    whole.Reset(260, 90);
+    incremental.Reset(260, 90);
+    ztools::RasterizeStroke(whole, pts.data(), static_cast<int>(pts.size()), 9);
+
+    ztools::StrokeRasterizer stroke;
+    stroke.Begin(9);
+    for (int n = 1; n <= static_cast<int>(pts.size()); n++) {
+        IntRect dirty = stroke.Extend(incremental, pts.data(), n);
+        // 新线段的脏矩形只包住最后一段胶囊
+        const MaskPoint& a = pts[n > 1 ? n - 2 : 0];
+        const MaskPoint& b = pts[n - 1];
+        IntRect segment = IntRect::FromLTRB((std::min)(a.x, b.x) - 10, (std::min)(a.y, b.y) - 10,
+                                            (std::max)(a.x, b.x) + 10, (std::max)(a.y, b.y) + 10);
+        CHECK(dirty.Intersect(segment) == dirty);
+    }
+    CHECK_EQ(stroke.done(), 60);
+    CHECK(SameMask(whole, incremental));
+    // 没有新点时不触及任何像素
+    CHECK(stroke.Extend(incremental, pts.data(), 60).Empty());
+}
+
+TEST_CASE(FillClearAndMerge) {
+    CoverageMask a, b;
+    a.Reset(50, 50);
+    b.Reset(50, 50);
+    CHECK(a.FillRect(IntRect(-5, -5, 20, 20)) == IntRect(0, 0, 15, 15));
+    b.StampCapsule({40, 40}, {40, 40}, 4);
+    a.MaxWith(b, b.Touched());
+    CHECK_EQ(a.At(40, 40), 255);
+    CHECK(a.Touched() == IntRect(0, 0, 15, 15).Union(b.Touched()));
+    a.Clear(IntRect(0, 0, 10, 10));
+    CHECK_EQ(a.At(5, 5), 0);
+    CHECK_EQ(a.At(12, 12), 255);
+    a.ClearAll();
+    CHECK_EQ(a.At(12, 12), 0);
+    CHECK_EQ(a.At(40, 40), 0);
+    CHECK(a.Touched().Empty());
+}
+
+TEST_CASE(RevealLayerIsPremultipliedBase) {
+    Surface phys(64, 64);
+    ztest::FillScreenLike(phys.view(), 3);
+    ztools::MosaicTileCache tiles;
+    tiles.Reset(phys.view(), 1.0, 64, 64);
+    tiles.Ensure(8, IntRect(0, 0, 64, 64));
+    Surface base(64, 64);
+    ztools::Mosaic(phys.view(), 1.0, base.view(), base.view().Bounds(), 8);
+
+    CoverageMask committed, live;
+    committed.Reset(64, 64);
+    live.Reset(64, 64);
+    committed.FillRect(IntRect(0, 0, 16, 16));
+    live.StampCapsule({40, 40}, {40, 40}, 5);
+
+    Surface out(64, 64);
+    ztools::ComposeMosaicReveal(tiles, 8, committed, &live, out.view(), out.view().Bounds());
+    CHECK_EQ(out.view().At(3, 3), base.view().At(3, 3) | 0xFF000000u);
+    CHECK_EQ(out.view().At(30, 30), 0u);
+    std::uint32_t edge = out.view().At(43, 43);
+    std::uint8_t c = live.At(43, 43);
+    CHECK(c > 0 && c < 255);
+    CHECK_EQ(ztest::Channel(edge, 3), c);
+    CHECK(ztest::Channel(edge, 2) <= ztest::Channel(base.view().At(43, 43), 2));
+}
+
+TEST_MAIN()
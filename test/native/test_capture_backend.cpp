@@ -0,0 +1,131 @@
+// 持久帧缓冲：首帧整帧读取、静止不读、只读脏区、移动（滚动）搬移、尺寸变化 / 访问丢失后整帧重读
+#include "core/capture_backend.h"
+#include "raster_fixtures.h"
+#include "synthetic_capture.h"
+#include "test_harness.h"
+
+#include <memory>
+#include <random>
+
+using ztest::SyntheticCaptureBackend;
+using ztools::DuplicationCapture;
+using ztools::IntRect;
+
+namespace {
+
+// 建立持有合成后端的持久帧；返回后端指针供测试改动画面
+SyntheticCaptureBackend* Attach(DuplicationCapture& capture, int width, int height) {
+    auto backend = std::make_unique<SyntheticCaptureBackend>(width, height);
+    SyntheticCaptureBackend* raw = backend.get();
+    capture.Reset(std::move(backend));
+    return raw;
+}
+
+bool InSync(const DuplicationCapture& capture, SyntheticCaptureBackend& backend) {
+    return capture.Valid() && ztest::ViewHash(capture.frame()) == ztest::ViewHash(backend.desktop.view());
+}
+
+}  // namespace
+
+TEST_CASE(FirstUpdateReadsWholeFrameThenIdleReadsNothing) {
+    DuplicationCapture capture;
+    CHECK(!capture.Update());  // 没有后端
+    SyntheticCaptureBackend* backend = Attach(capture, 640, 360);
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+    CHECK_EQ(capture.stats().fullReads, 1);
+    CHECK_EQ(backend->pixelsRead, 640 * 360);
+    CHECK(capture.Bounds() == IntRect(0, 0, 640, 360));
+
+    CHECK(capture.Update());
+    CHECK(capture.Update());
+    CHECK_EQ(backend->pixelsRead, 640 * 360);
+    CHECK_EQ(capture.stats().updates, 3);
+}
+
+TEST_CASE(OnlyDirtyRectsAreRead) {
+    DuplicationCapture capture;
+    SyntheticCaptureBackend* backend = Attach(capture, 800, 600);
+    CHECK(capture.Update());
+    backend->pixelsRead = 0;
+    backend->Paint(IntRect(10, 20, 30, 40), 7);
+    backend->Paint(IntRect(790, 590, 50, 50), 8);  // 超出画面的部分被裁掉
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+    CHECK_EQ(backend->pixelsRead, 30 * 40 + 10 * 10);
+    CHECK_EQ(capture.stats().fullReads, 1);
+}
+
+TEST_CASE(ScrollIsAppliedAsMoveInBothDirections) {
+    DuplicationCapture capture;
+    SyntheticCaptureBackend* backend = Attach(capture, 500, 400);
+    CHECK(capture.Update());
+    backend->pixelsRead = 0;
+    backend->Scroll(IntRect(50, 40, 300, 280), 24, 11);  // 向上滚：内容上移
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+    CHECK_EQ(backend->pixelsRead, 300 * 24);
+    CHECK_EQ(capture.stats().pixelsMoved, 300 * (280 - 24));
+
+    backend->Scroll(IntRect(50, 40, 300, 280), -37, 12);  // 向下滚：源、目标重叠且目标在下
+    backend->Scroll(IntRect(380, 0, 120, 400), 5, 13);
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+}
+
+TEST_CASE(PaintThenScrollFallsBackToDirty) {
+    DuplicationCapture capture;
+    SyntheticCaptureBackend* backend = Attach(capture, 300, 300);
+    CHECK(capture.Update());
+    backend->Paint(IntRect(100, 100, 20, 20), 3);
+    backend->Scroll(IntRect(0, 0, 300, 300), 15, 4);  // 移动的源含未交出的变化：整块重读
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+}
+
+TEST_CASE(ResizeAndAccessLossForceFullRead) {
+    DuplicationCapture capture;
+    SyntheticCaptureBackend* backend = Attach(capture, 320, 200);
+    CHECK(capture.Update());
+    backend->Resize(400, 250);
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+    CHECK_EQ(capture.stats().fullReads, 2);
+
+    backend->failAcquires = 1;
+    backend->Paint(IntRect(0, 0, 10, 10), 5);
+    CHECK(!capture.Update());
+    CHECK(!capture.Valid());
+    backend->Paint(IntRect(50, 50, 10, 10), 6);
+    CHECK(capture.Update());
+    CHECK(InSync(capture, *backend));
+    CHECK_EQ(capture.stats().fullReads, 3);
+
+    capture.Invalidate();
+    CHECK(capture.Update());
+    CHECK_EQ(capture.stats().fullReads, 4);
+}
+
+TEST_CASE(RandomActivityStaysInSync) {
+    std::mt19937 rng(41);
+    std::uniform_int_distribution<int> pos(-40, 700), size(1, 300), shift(-120, 120), batch(1, 6), kind(0, 2);
+    DuplicationCapture capture;
+    SyntheticCaptureBackend* backend = Attach(capture, 720, 480);
+    CHECK(capture.Update());
+    for (int round = 0; round < 60; round++) {
+        int n = batch(rng);
+        for (int i = 0; i < n; i++) {
+            IntRect r(pos(rng), pos(rng), size(rng), size(rng));
+            if (kind(rng) == 0) {
+                backend->Paint(r, static_cast<std::uint32_t>(round * 10 + i));
+            } else {
+                backend->Scroll(r, shift(rng), static_cast<std::uint32_t>(round * 10 + i));
+            }
+        }
+        CHECK(capture.Update());
+        CHECK(InSync(capture, *backend));
+    }
+    CHECK_EQ(capture.stats().fullReads, 1);
+}
+
+TEST_MAIN()
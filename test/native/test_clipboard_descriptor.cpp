@@ -0,0 +1,138 @@
+// 剪贴板变化描述符测试：经假剪贴板后端一次打开收集全部字段
+#include "core/clipboard_descriptor.h"
+#include "fake_clipboard.h"
+#include "test_harness.h"
+
+using ztest::FakeClipboard;
+using ztools::ClipboardDescriptor;
+namespace cf = ztools::cf;
+
+namespace {
+const std::uint32_t kHtml = 0xC0F1;
+}
+
+TEST_CASE(TextDescriptor) {
+    FakeClipboard cb;
+    cb.names[kHtml] = "HTML Format";
+    // "aé中😀"：1 + 2 + 3 + 4 = 10 字节 UTF-8
+    cb.Set({{cf::kUnicodeText, FakeClipboard::Utf16(u"a\u00e9\u4e2d\U0001F600")},
+            {kHtml, FakeClipboard::Text("<p>a</p>")},
+            {cf::kLocale, FakeClipboard::Bytes{4, 8, 0, 0}}});
+
+    ClipboardDescriptor d;
+    CHECK(ztools::BuildClipboardDescriptor(cb, 42, d));
+    CHECK_EQ(cb.openCalls, 1);
+    CHECK(!cb.isOpen);
+    CHECK_EQ(d.sequence, 42u);
+    CHECK_EQ(d.formatIds.size(), (size_t)3);
+    CHECK_EQ(d.formatNames[0], std::string("CF_UNICODETEXT"));
+    CHECK_EQ(d.formatNames[1], std::string("HTML Format"));
+    CHECK_EQ(d.formatNames[2], std::string("CF_LOCALE"));
+    CHECK_EQ(d.textBytes, (size_t)10);
+    CHECK(d.hasText());
+    CHECK(!d.hasImage());
+    CHECK_EQ(d.fileCount, 0);
+    // 只读取主格式，不触碰 HTML/LOCALE
+    CHECK_EQ(cb.reads, 1);
+}
+
+TEST_CASE(ImageDescriptor) {
+    FakeClipboard cb;
+    auto dib = FakeClipboard::Dib(64, 32);
+    // 自下而上的 DIB 高度为正，自上而下为负：都报告绝对值
+    std::int32_t negHeight = -32;
+    std::memcpy(dib.data() + 8, &negHeight, 4);
+    cb.Set({{cf::kDib, dib}, {cf::kBitmap, {}}, {cf::kDibV5, FakeClipboard::Dib(1, 1)}});
+    cb.opaque.insert(cf::kBitmap);
+
+    ClipboardDescriptor d;
+    CHECK(ztools::BuildClipboardDescriptor(cb, 7, d));
+    CHECK_EQ(d.imageWidth, 64);
+    CHECK_EQ(d.imageHeight, 32);
+    CHECK(d.hasImage());
+    CHECK_EQ(d.formatNames[1], std::string("CF_BITMAP"));
+    CHECK_EQ(cb.reads, 1);  // CF_DIBV5 是合成格式，不再读取
+}
+
+TEST_CASE(FileDescriptor) {
+    FakeClipboard cb;
+    cb.Set({{cf::kHdrop, FakeClipboard::DropFiles({u"C:\\a.txt", u"C:\\dir", u"D:\\b.png"})}});
+
+    ClipboardDescriptor d;
+    CHECK(ztools::BuildClipboardDescriptor(cb, 1, d));
+    CHECK_EQ(d.fileCount, 3);
+    CHECK(d.hasFiles());
+    CHECK(!d.hasText());
+}
+
+TEST_CASE(HashIgnoresPrivateFormatsButTracksContent) {
+    FakeClipboard a;
+    a.Set({{cf::kUnicodeText, FakeClipboard::Utf16(u"same")}, {kHtml, FakeClipboard::Text("<i>1</i>")}});
+    FakeClipboard b;
+    b.Set({{cf::kUnicodeText, FakeClipboard::Utf16(u"same")}, {kHtml, FakeClipboard::Text("<b>2</b>")}});
+    FakeClipboard c;
+    c.Set({{cf::kUnicodeText, FakeClipboard::Utf16(u"diff")}});
+
+    ClipboardDescriptor da, db, dc;
+    CHECK(ztools::BuildClipboardDescriptor(a, 1, da));
+    CHECK(ztools::BuildClipboardDescriptor(b, 2, db));
+    CHECK(ztools::BuildClipboardDescriptor(c, 3, dc));
+    CHECK_EQ(da.hash, db.hash);
+    CHECK(da.hash != dc.hash);
+}
+
+TEST_CASE(LargeImageHashIsBoundedFingerprint) {
+    // 512x512 的 32 位 DIB 约 1MB：只哈希长度、开头（含信息头）与抽样段
+    FakeClipboard::Bytes base = FakeClipboard::Dib(512, 512);
+    auto describe = [](const FakeClipboard::Bytes& dib) {
+        FakeClipboard cb;
+        cb.Set({{cf::kDib, dib}});
+        ClipboardDescriptor d;
+        CHECK(ztools::BuildClipboardDescriptor(cb, 1, d));
+        return d.hash;
+    };
+    std::uint64_t h = describe(base);
+    CHECK_EQ(describe(base), h);
+
+    FakeClipboard::Bytes head = base;
+    head[100] ^= 1;  // 开头的像素
+    CHECK(describe(head) != h);
+    FakeClipboard::Bytes tail = base;
+    tail.back() ^= 1;  // 最后一个像素
+    CHECK(describe(tail) != h);
+    CHECK(describe(FakeClipboard::Dib(512, 513)) != h);  // 尺寸不同
+
+    // 抽样段之间的字节不参与：哈希开销与图像大小无关
+    FakeClipboard::Bytes gap = base;
+    gap[base.size() / 2 + 5000] ^= 1;
+    CHECK_EQ(describe(gap), h);
+}
+
+TEST_CASE(EmptyAndLockedClipboard) {
+    FakeClipboard cb;
+    ClipboardDescriptor d;
+    CHECK(ztools::BuildClipboardDescriptor(cb, 5, d));
+    CHECK(d.formatIds.empty());
+    CHECK(!d.hasText() && !d.hasImage() && !d.hasFiles());
+
+    cb.failOpens = 1;
+    CHECK(!ztools::BuildClipboardDescriptor(cb, 6, d));
+}
+
+TEST_CASE(MalformedPayloadsAreTolerated) {
+    const std::uint8_t shortDib[] = {40, 0, 0};
+    int w = 0, h = 0;
+    CHECK(!ztools::ParseDibDimensions(shortDib, sizeof(shortDib), w, h));
+
+    auto drop = FakeClipboard::DropFiles({u"C:\\a"});
+    drop.resize(drop.size() - 4);  // 截掉结尾两个 NUL
+    CHECK_EQ(ztools::CountDropFiles(drop.data(), drop.size()), 1);
+    std::uint32_t badOffset = 0xFFFF;
+    std::memcpy(drop.data(), &badOffset, 4);
+    CHECK_EQ(ztools::CountDropFiles(drop.data(), drop.size()), 0);
+
+    const std::uint8_t oddText[] = {'a', 0, 'b'};
+    CHECK_EQ(ztools::Utf16ToUtf8Length(oddText, sizeof(oddText)), (size_t)1);
+}
+
+TEST_MAIN()
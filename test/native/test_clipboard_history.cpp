@@ -0,0 +1,394 @@
+// 剪贴板历史存储测试：去重、容量淘汰、重启恢复、前缀 / 时间范围查询、剪贴板内容规范化
+#include "core/clipboard_descriptor.h"
+#include "core/clipboard_history.h"
+#include "fake_clipboard.h"
+#include "test_harness.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+using ztest::FakeClipboard;
+using ztools::ClipboardHistoryOptions;
+using ztools::ClipboardHistoryStore;
+using ztools::HistoryItem;
+using ztools::HistoryKind;
+
+namespace {
+
+std::uint64_t InsertText(ClipboardHistoryStore& store, const std::string& text, std::uint64_t ts,
+                         bool* isNew = nullptr) {
+    return store.Insert(HistoryKind::Text, text.data(), text.size(), ts, isNew);
+}
+
+std::string TempHistoryPath() {
+    char path[] = "/tmp/ztools-history-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    return path;
+}
+
+}  // namespace
+
+TEST_CASE(InsertDeduplicatesByContent) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 64 * 1024}));
+
+    bool isNew = false;
+    std::uint64_t a = InsertText(store, "hello", 1000, &isNew);
+    CHECK(isNew);
+    InsertText(store, "world", 2000);
+    std::uint64_t again = InsertText(store, "hello", 3000, &isNew);
+    CHECK(!isNew);
+    CHECK_EQ(again, a);
+    CHECK_EQ(store.Count(), (size_t)2);
+    CHECK_EQ(store.stats().dedupHits, (std::uint64_t)1);
+
+    // 去重命中把条目移到最前，并刷新时间与次数
+    auto recent = store.QueryRecent(0, 10);
+    CHECK_EQ(recent.size(), (size_t)2);
+    CHECK_EQ(recent[0].payload, std::string("hello"));
+    CHECK_EQ(recent[0].timestampMs, (std::uint64_t)3000);
+    CHECK_EQ(recent[0].copyCount, (std::uint32_t)2);
+    CHECK_EQ(recent[1].payload, std::string("world"));
+}
+
+TEST_CASE(SameBytesWithDifferentKindAreDistinct) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 64 * 1024}));
+    std::string path = "C:\\a.txt";
+    std::uint64_t asText = store.Insert(HistoryKind::Text, path.data(), path.size(), 1);
+    std::uint64_t asFiles = store.Insert(HistoryKind::Files, path.data(), path.size(), 2);
+    CHECK(asText != asFiles);
+    CHECK_EQ(store.Count(), (size_t)2);
+}
+
+TEST_CASE(RecentPaginationIsNewestFirst) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 256 * 1024}));
+    for (int i = 0; i < 20; i++) InsertText(store, "item" + std::to_string(i), 100 + i);
+
+    auto page = store.QueryRecent(5, 3);
+    CHECK_EQ(page.size(), (size_t)3);
+    CHECK_EQ(page[0].payload, std::string("item14"));
+    CHECK_EQ(page[2].payload, std::string("item12"));
+    CHECK(store.QueryRecent(20, 5).empty());
+}
+
+TEST_CASE(TimeRangeQuery) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 256 * 1024}));
+    for (int i = 0; i < 10; i++) InsertText(store, "t" + std::to_string(i), 1000 * (i + 1));
+
+    auto items = store.QueryTimeRange(3000, 5000, 100);
+    CHECK_EQ(items.size(), (size_t)3);
+    CHECK_EQ(items[0].timestampMs, (std::uint64_t)5000);
+    CHECK_EQ(items[2].timestampMs, (std::uint64_t)3000);
+    CHECK_EQ(store.QueryTimeRange(3000, 5000, 2).size(), (size_t)2);
+}
+
+TEST_CASE(TextPrefixQuery) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 256 * 1024}));
+    InsertText(store, "git status", 1);
+    InsertText(store, "git commit -m \"fix\"", 2);
+    InsertText(store, "npm install", 3);
+    std::string longA = std::string(40, 'x') + "-alpha";
+    std::string longB = std::string(40, 'x') + "-beta";
+    InsertText(store, longA, 4);
+    InsertText(store, longB, 5);
+    std::string files = "git-files";
+    store.Insert(HistoryKind::Files, files.data(), files.size(), 6);
+
+    auto git = store.QueryTextPrefix("git", 10);
+    CHECK_EQ(git.size(), (size_t)2);  // 文件记录不参与文本前缀查询
+    CHECK_EQ(git[0].payload, std::string("git commit -m \"fix\""));
+    CHECK_EQ(git[1].payload, std::string("git status"));
+
+    // 超过索引键长的前缀需要全文校验
+    auto beta = store.QueryTextPrefix(std::string(40, 'x') + "-b", 10);
+    CHECK_EQ(beta.size(), (size_t)1);
+    CHECK_EQ(beta[0].payload, longB);
+    CHECK_EQ(store.QueryTextPrefix(std::string(40, 'x'), 10).size(), (size_t)2);
+    CHECK(store.QueryTextPrefix("zzz", 10).empty());
+}
+
+TEST_CASE(FullLogCompactsKeepingNewest) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 16 * 1024}));
+
+    std::string body(200, 'p');
+    std::uint64_t first = 0;
+    for (int i = 0; i < 200; i++) {
+        std::string text = std::to_string(i) + body;
+        std::uint64_t h = InsertText(store, text, i);
+        if (i == 0) first = h;
+        CHECK(store.UsedBytes() <= store.CapacityBytes());
+    }
+    CHECK(store.stats().compactions > 0);
+    CHECK(store.stats().evicted > 0);
+    CHECK(!store.Contains(first));
+    CHECK_EQ(store.Count(), (size_t)(200 - store.stats().evicted));
+
+    // 最新的一条一定保留，且前缀索引与内容一致
+    auto recent = store.QueryRecent(0, 1);
+    CHECK_EQ(recent.size(), (size_t)1);
+    CHECK_EQ(recent[0].payload, "199" + body);
+    CHECK_EQ(store.QueryTextPrefix("199", 10).size(), (size_t)1);
+    CHECK(store.QueryTextPrefix("0ppp", 10).empty());
+}
+
+TEST_CASE(RecentlyTouchedEntriesSurviveCompaction) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 16 * 1024}));
+    std::string body(300, 'q');
+    std::uint64_t pinned = InsertText(store, "pinned" + body, 0);
+    for (int i = 1; i < 100; i++) {
+        InsertText(store, std::to_string(i) + body, i);
+        InsertText(store, "pinned" + body, i);  // 反复复制同一内容
+    }
+    CHECK(store.stats().compactions > 0);
+    HistoryItem item;
+    CHECK(store.Get(pinned, item));
+    CHECK_EQ(item.copyCount, (std::uint32_t)100);
+}
+
+TEST_CASE(RecopyingOldestEntryIntoFullLogKeepsIt) {
+    std::string path = TempHistoryPath();
+    ClipboardHistoryStore store;
+    CHECK(store.Open({path, 16 * 1024}));
+
+    // 写满日志，恰好没有空间再追加一条 Touch 记录
+    std::string body(200, 'f');
+    std::uint64_t oldest = InsertText(store, "000" + body, 0);
+    int i = 1;
+    while (store.CapacityBytes() - store.UsedBytes() >= 272) {
+        char prefix[16];
+        std::snprintf(prefix, sizeof(prefix), "%03d", i);
+        InsertText(store, prefix + body, i++);
+    }
+    size_t pad = store.CapacityBytes() - store.UsedBytes() - 32;
+    InsertText(store, std::string(pad, 'z'), i++);
+    CHECK_EQ(store.UsedBytes(), store.CapacityBytes());
+    CHECK_EQ(store.stats().compactions, (std::uint64_t)0);
+
+    // 再次复制最旧的一条：触发压缩，但它是最近使用的，必须保留
+    bool isNew = true;
+    CHECK_EQ(InsertText(store, "000" + body, 1000, &isNew), oldest);
+    CHECK(!isNew);
+    CHECK_EQ(store.stats().compactions, (std::uint64_t)1);
+    HistoryItem item;
+    CHECK(store.Get(oldest, item));
+    CHECK_EQ(item.copyCount, (std::uint32_t)2);
+    CHECK_EQ(item.timestampMs, (std::uint64_t)1000);
+    auto recent = store.QueryRecent(0, 1);
+    CHECK_EQ(recent.size(), (size_t)1);
+    CHECK_EQ(recent[0].hash, oldest);
+    store.Close();
+
+    // 压缩时写回的时间与次数在重启后仍在
+    CHECK(store.Open({path, 16 * 1024}));
+    CHECK(store.Get(oldest, item));
+    CHECK_EQ(item.copyCount, (std::uint32_t)2);
+    recent = store.QueryRecent(0, 1);
+    CHECK_EQ(recent.size(), (size_t)1);
+    CHECK_EQ(recent[0].hash, oldest);
+    store.Close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE(OversizedPayloadIsRejected) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 16 * 1024}));
+    InsertText(store, "keep", 1);
+    std::string huge(8 * 1024, 'h');
+    CHECK_EQ(store.Insert(HistoryKind::Image, huge.data(), huge.size(), 2), (std::uint64_t)0);
+    CHECK_EQ(store.stats().rejected, (std::uint64_t)1);
+    CHECK_EQ(store.Count(), (size_t)1);
+}
+
+TEST_CASE(ReopenRecoversIndexFromMappedFile) {
+    std::string path = TempHistoryPath();
+    std::uint64_t hashA = 0;
+    {
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 64 * 1024}));
+        CHECK_EQ(store.Count(), (size_t)0);
+        hashA = InsertText(store, "alpha", 10);
+        InsertText(store, "beta", 20);
+        InsertText(store, "alpha", 30);  // Touch 记录
+        std::string dib(64, '\x7f');
+        store.Insert(HistoryKind::Image, dib.data(), dib.size(), 40);
+        store.Close();
+    }
+    {
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 64 * 1024}));
+        CHECK_EQ(store.Count(), (size_t)3);
+        auto recent = store.QueryRecent(0, 10);
+        CHECK_EQ(recent.size(), (size_t)3);
+        CHECK(recent[0].kind == HistoryKind::Image);
+        CHECK_EQ(recent[1].payload, std::string("alpha"));
+        CHECK_EQ(recent[1].timestampMs, (std::uint64_t)30);
+        CHECK_EQ(recent[1].copyCount, (std::uint32_t)2);
+        CHECK_EQ(recent[1].hash, hashA);
+        CHECK_EQ(store.QueryTextPrefix("be", 10).size(), (size_t)1);
+
+        // 恢复后继续去重
+        bool isNew = true;
+        InsertText(store, "beta", 50, &isNew);
+        CHECK(!isNew);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE(ReopenAfterCompactionAndTornTail) {
+    std::string path = TempHistoryPath();
+    size_t count = 0;
+    {
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 16 * 1024}));
+        std::string body(150, 'r');
+        for (int i = 0; i < 150; i++) InsertText(store, std::to_string(i) + body, i);
+        CHECK(store.stats().compactions > 0);
+        count = store.Count();
+        store.Close();
+    }
+    {
+        // 模拟写到一半崩溃：尾指针之后残留半条记录不影响恢复
+        ztools::MappedFile raw;
+        CHECK(raw.Open(path, 16 * 1024));
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, raw.data() + 16, sizeof(tail));
+        if (tail + 8 <= raw.size()) std::memset(raw.data() + tail, 0x5A, 8);
+        raw.Close();
+    }
+    {
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 16 * 1024}));
+        CHECK_EQ(store.Count(), count);
+        auto recent = store.QueryRecent(0, 1);
+        CHECK_EQ(recent.size(), (size_t)1);
+        CHECK_EQ(recent[0].payload.substr(0, 3), std::string("149"));
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE(ReopenWithSmallerCapacityKeepsLog) {
+    std::string path = TempHistoryPath();
+    {
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 64 * 1024}));
+        std::string body(500, 's');
+        for (int i = 0; i < 60; i++) InsertText(store, std::to_string(i) + body, i);
+        CHECK(store.UsedBytes() > 16 * 1024);
+        store.Close();
+    }
+    {
+        // 容量调小：文件不截断，按原大小打开，记录全部恢复
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 16 * 1024}));
+        CHECK_EQ(store.CapacityBytes(), (size_t)64 * 1024);
+        CHECK_EQ(store.Count(), (size_t)60);
+        auto recent = store.QueryRecent(0, 1);
+        CHECK_EQ(recent.size(), (size_t)1);
+        CHECK_EQ(recent[0].payload.substr(0, 2), std::string("59"));
+    }
+    {
+        // 容量调大：文件扩展，记录保留
+        ClipboardHistoryStore store;
+        CHECK(store.Open({path, 128 * 1024}));
+        CHECK_EQ(store.CapacityBytes(), (size_t)128 * 1024);
+        CHECK_EQ(store.Count(), (size_t)60);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE(CorruptFileStartsEmpty) {
+    std::string path = TempHistoryPath();
+    {
+        ztools::MappedFile raw;
+        CHECK(raw.Open(path, 16 * 1024));
+        std::memset(raw.data(), 0xAB, raw.size());
+        raw.Close();
+    }
+    ClipboardHistoryStore store;
+    CHECK(store.Open({path, 16 * 1024}));
+    CHECK_EQ(store.Count(), (size_t)0);
+    InsertText(store, "fresh", 1);
+    CHECK_EQ(store.Count(), (size_t)1);
+    store.Close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE(NormalizeTextFoldsCrLfAndDecodesSurrogates) {
+    auto bytes = FakeClipboard::Utf16(u"a\r\nb\U0001F600\u4E2D");
+    std::string text = ztools::NormalizeClipboardText(bytes.data(), bytes.size());
+    CHECK_EQ(text, std::string("a\nb\xF0\x9F\x98\x80\xE4\xB8\xAD"));
+}
+
+constexpr size_t kNoLimit = ~size_t(0);
+
+TEST_CASE(ExtractPrefersFilesThenTextThenImage) {
+    FakeClipboard cb;
+    cb.Set({{ztools::cf::kUnicodeText, FakeClipboard::Utf16(u"C:\\a.txt")},
+            {ztools::cf::kHdrop, FakeClipboard::DropFiles({u"C:\\a.txt", u"D:\\\u6587\u4EF6.png"})}});
+    HistoryKind kind;
+    std::string payload;
+    CHECK(cb.Open());
+    CHECK(ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), kNoLimit, kind, payload));
+    cb.Close();
+    CHECK(kind == HistoryKind::Files);
+    CHECK_EQ(payload, std::string("C:\\a.txt\nD:\\\xE6\x96\x87\xE4\xBB\xB6.png"));
+
+    cb.Set({{ztools::cf::kDib, FakeClipboard::Dib(2, 2)}, {ztools::cf::kUnicodeText, FakeClipboard::Utf16(u"x")}});
+    CHECK(cb.Open());
+    CHECK(ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), kNoLimit, kind, payload));
+    cb.Close();
+    CHECK(kind == HistoryKind::Text);
+    CHECK_EQ(payload, std::string("x"));
+
+    cb.Set({{ztools::cf::kDib, FakeClipboard::Dib(2, 2)}});
+    CHECK(cb.Open());
+    CHECK(ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), kNoLimit, kind, payload));
+    cb.Close();
+    CHECK(kind == HistoryKind::Image);
+    CHECK_EQ(payload.size(), (size_t)(40 + 16));
+
+    cb.Set({{0xC0F1, FakeClipboard::Text("<b>x</b>")}});
+    CHECK(cb.Open());
+    CHECK(!ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), kNoLimit, kind, payload));
+    cb.Close();
+}
+
+TEST_CASE(ExtractSkipsPayloadAboveStoreLimit) {
+    ClipboardHistoryStore store;
+    CHECK(store.Open({"", 64 * 1024}));
+    size_t limit = store.MaxPayloadBytes();
+    CHECK(limit > 0 && limit < 16 * 1024);
+    // 上限正好可以入库，超过一个字节即被拒收（与 Extract 的判定一致）
+    std::string fits(limit, 'f');
+    CHECK(store.Insert(HistoryKind::Image, fits.data(), fits.size(), 1) != 0);
+    std::string over(limit + 1, 'o');
+    CHECK_EQ(store.Insert(HistoryKind::Image, over.data(), over.size(), 2), (std::uint64_t)0);
+
+    // 64x64 的 32 位 DIB 约 16KB：超过上限，不产生任何内容
+    FakeClipboard cb;
+    cb.Set({{ztools::cf::kDib, FakeClipboard::Dib(64, 64)}});
+    HistoryKind kind;
+    std::string payload = "stale";
+    CHECK(cb.Open());
+    CHECK(!ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), limit, kind, payload));
+    cb.Close();
+    CHECK(payload.empty());
+
+    // 小图仍照常提取
+    cb.Set({{ztools::cf::kDib, FakeClipboard::Dib(8, 8)}});
+    CHECK(cb.Open());
+    CHECK(ztools::ExtractHistoryPayload(cb, cb.EnumFormats(), limit, kind, payload));
+    cb.Close();
+    CHECK(kind == HistoryKind::Image);
+}
+
+TEST_MAIN()
@@ -0,0 +1,122 @@
+// 截图剪贴板负载：CF_DIBV5 与参考字节逐字节一致、行序自下而上、alpha 处理、源 stride、
+// 与剪贴板描述符的解析互通、空图像 / 空间不足
+#include "core/clipboard_descriptor.h"
+#include "core/clipboard_image.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using ztools::DibAlpha;
+using ztools::ImageView;
+
+namespace {
+
+// 参考负载：3x2 图像，第 0 行 = 红 / 绿 / 蓝，第 1 行 = 白 / 黑 / 半透明灰（源 alpha 均为 0x00 或 0x80）
+const std::uint32_t kSource[2][3] = {
+    {0x00FF0000, 0x0000FF00, 0x000000FF},
+    {0x00FFFFFF, 0x00000000, 0x80808080},
+};
+
+const std::uint8_t kReferenceHeader[124] = {
+    0x7C, 0x00, 0x00, 0x00,  // bV5Size = 124
+    0x03, 0x00, 0x00, 0x00,  // bV5Width = 3
+    0x02, 0x00, 0x00, 0x00,  // bV5Height = 2（自下而上）
+    0x01, 0x00,              // bV5Planes
+    0x20, 0x00,              // bV5BitCount = 32
+    0x03, 0x00, 0x00, 0x00,  // BI_BITFIELDS
+    0x18, 0x00, 0x00, 0x00,  // bV5SizeImage = 24
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // X/Y PelsPerMeter
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ClrUsed / ClrImportant
+    0x00, 0x00, 0xFF, 0x00,  // RedMask
+    0x00, 0xFF, 0x00, 0x00,  // GreenMask
+    0xFF, 0x00, 0x00, 0x00,  // BlueMask
+    0x00, 0x00, 0x00, 0xFF,  // AlphaMask
+    0x42, 0x47, 0x52, 0x73,  // LCS_sRGB
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Endpoints（36 字节）
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Gamma R/G/B
+    0x04, 0x00, 0x00, 0x00,  // LCS_GM_IMAGES
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ProfileData / ProfileSize
+    0x00, 0x00, 0x00, 0x00,  // Reserved
+};
+
+// 像素区：先写源第 1 行，再写第 0 行；字节序 B G R A
+const std::uint8_t kReferenceOpaquePixels[24] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x80, 0x80, 0x80, 0xFF,
+    0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF,
+};
+const std::uint8_t kReferenceKeepPixels[24] = {
+    0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00,
+};
+
+ImageView SourceView(std::vector<std::uint32_t>& storage, int stridePixels) {
+    storage.assign(static_cast<size_t>(stridePixels) * 2, 0xDEADBEEF);  // 行尾填充不应出现在输出里
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 3; x++) storage[static_cast<size_t>(y) * stridePixels + x] = kSource[y][x];
+    }
+    return ImageView(storage.data(), 3, 2, stridePixels * 4);
+}
+
+bool Matches(const std::vector<std::uint8_t>& payload, const std::uint8_t* pixels) {
+    return payload.size() == 124 + 24 && std::memcmp(payload.data(), kReferenceHeader, 124) == 0 &&
+           std::memcmp(payload.data() + 124, pixels, 24) == 0;
+}
+
+}  // namespace
+
+TEST_CASE(OpaquePayloadMatchesReference) {
+    std::vector<std::uint32_t> storage;
+    std::vector<std::uint8_t> payload = ztools::BuildDibV5(SourceView(storage, 3), DibAlpha::Opaque);
+    CHECK_EQ(payload.size(), ztools::DibV5ByteSize(3, 2));
+    CHECK(Matches(payload, kReferenceOpaquePixels));
+}
+
+TEST_CASE(KeepAlphaPayloadMatchesReference) {
+    std::vector<std::uint32_t> storage;
+    std::vector<std::uint8_t> payload = ztools::BuildDibV5(SourceView(storage, 3), DibAlpha::Keep);
+    CHECK(Matches(payload, kReferenceKeepPixels));
+}
+
+TEST_CASE(SourceStridePaddingIsSkipped) {
+    std::vector<std::uint32_t> storage;
+    std::vector<std::uint8_t> payload = ztools::BuildDibV5(SourceView(storage, 5), DibAlpha::Opaque);
+    CHECK(Matches(payload, kReferenceOpaquePixels));
+}
+
+TEST_CASE(WritesIntoCallerMemoryAndParsesBack) {
+    std::vector<std::uint32_t> pixels(640 * 480);
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = static_cast<std::uint32_t>(i * 2654435761u) & 0x00FFFFFF;
+    ImageView view(pixels.data(), 640, 480, 640 * 4);
+
+    std::vector<std::uint8_t> global(ztools::DibV5ByteSize(640, 480) + 16, 0xAA);
+    CHECK(ztools::WriteDibV5(view, DibAlpha::Opaque, global.data(), global.size()));
+    CHECK_EQ(global[ztools::DibV5ByteSize(640, 480)], 0xAA);  // 不越界写
+
+    int w = 0, h = 0;
+    CHECK(ztools::ParseDibDimensions(global.data(), global.size(), w, h));
+    CHECK_EQ(w, 640);
+    CHECK_EQ(h, 480);
+    // 最后一行像素区对应源第 0 行
+    const std::uint8_t* lastRow = global.data() + 124 + static_cast<size_t>(479) * 640 * 4;
+    std::uint32_t px;
+    std::memcpy(&px, lastRow + 4 * 7, 4);
+    CHECK_EQ(px, pixels[7] | 0xFF000000u);
+}
+
+TEST_CASE(RejectsEmptyImageAndShortBuffer) {
+    CHECK_EQ(ztools::DibV5ByteSize(0, 10), (size_t)0);
+    CHECK(ztools::BuildDibV5(ImageView(), DibAlpha::Opaque).empty());
+    std::vector<std::uint32_t> storage;
+    ImageView view = SourceView(storage, 3);
+    std::vector<std::uint8_t> small(ztools::DibV5ByteSize(3, 2) - 1);
+    CHECK(!ztools::WriteDibV5(view, DibAlpha::Opaque, small.data(), small.size()));
+    CHECK(!ztools::WriteDibV5(view, DibAlpha::Opaque, nullptr, 1000));
+    CHECK_EQ(std::string(ztools::kPngClipboardFormatName), std::string("PNG"));
+}
+
+TEST_MAIN()
@@ -0,0 +1,178 @@
+// 剪贴板原始快照测试：经假剪贴板后端的无损往返
+#include "core/clipboard_snapshot.h"
+#include "fake_clipboard.h"
+#include "test_harness.h"
+
+using ztest::FakeClipboard;
+using ztools::ClipboardSnapshot;
+
+namespace {
+
+const std::uint32_t kUnicodeText = 13;
+const std::uint32_t kDib = 8;
+const std::uint32_t kBitmap = 2;
+const std::uint32_t kHtml = 0xC0F1;
+
+FakeClipboard::Bytes Pattern(size_t n, std::uint8_t seed) {
+    FakeClipboard::Bytes b(n);
+    for (size_t i = 0; i < n; i++) b[i] = static_cast<std::uint8_t>(seed + i * 7);
+    return b;
+}
+
+void FillRichClipboard(FakeClipboard& cb) {
+    cb.Set({{kHtml, FakeClipboard::Text("<b>hi</b>")},
+            {kUnicodeText, FakeClipboard::Bytes{'h', 0, 'i', 0, 0, 0}},
+            {kDib, Pattern(4 * 1024 * 1024 + 40, 3)},
+            {kBitmap, {}}});
+    cb.opaque.insert(kBitmap);  // HBITMAP 不能按字节复制，由系统从 CF_DIB 合成
+}
+
+}  // namespace
+
+TEST_CASE(CaptureCopiesEveryByteFormatInOrder) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+
+    ClipboardSnapshot snap;
+    CHECK(snap.Capture(cb));
+    CHECK(!cb.isOpen);
+    CHECK_EQ(snap.entries().size(), (size_t)3);
+    CHECK_EQ(snap.entries()[0].format, kHtml);
+    CHECK_EQ(snap.entries()[1].format, kUnicodeText);
+    CHECK_EQ(snap.entries()[2].format, kDib);
+    CHECK(snap.Find(kBitmap) == nullptr);
+    CHECK_EQ(snap.ByteSize(), (size_t)(9 + 6 + 4 * 1024 * 1024 + 40));
+}
+
+TEST_CASE(RestoreIsByteExact) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+    FakeClipboard::Bytes dib = *cb.Get(kDib);
+
+    ClipboardSnapshot snap;
+    CHECK(snap.Capture(cb));
+
+    // 模拟复制操作覆盖了剪贴板
+    cb.Set({{kUnicodeText, FakeClipboard::Bytes{'x', 0, 0, 0}}});
+    CHECK(snap.Restore(cb));
+
+    CHECK_EQ(cb.formats.size(), (size_t)3);
+    CHECK_EQ(cb.formats[0].first, kHtml);
+    CHECK(*cb.Get(kHtml) == FakeClipboard::Text("<b>hi</b>"));
+    CHECK(*cb.Get(kDib) == dib);
+
+    ClipboardSnapshot again;
+    CHECK(again.Capture(cb));
+    CHECK(again.SameContentAs(snap));
+}
+
+TEST_CASE(HashDetectsAnyChange) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+    ClipboardSnapshot before;
+    CHECK(before.Capture(cb));
+
+    ClipboardSnapshot same;
+    CHECK(same.Capture(cb));
+    CHECK(same.SameContentAs(before));
+
+    // 大图中只改一个字节
+    FakeClipboard::Bytes dib = *cb.Get(kDib);
+    dib[dib.size() / 2] ^= 1;
+    cb.WriteAt(cb.now, kDib, dib);
+    cb.Advance({});
+    ClipboardSnapshot after;
+    CHECK(after.Capture(cb));
+    CHECK(!after.SameContentAs(before));
+    CHECK(after.Hash() != before.Hash());
+}
+
+TEST_CASE(StreamingHashMatchesSnapshotHash) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+    ClipboardSnapshot snap;
+    CHECK(snap.Capture(cb));
+
+    std::uint64_t hash = 0;
+    CHECK(ztools::HashClipboard(cb, hash));
+    CHECK_EQ(hash, snap.Hash());
+    CHECK(!cb.isOpen);
+
+    cb.Set({});
+    CHECK(ztools::HashClipboard(cb, hash));
+    CHECK(hash != snap.Hash());
+}
+
+TEST_CASE(EmptySnapshotRestoresEmptyClipboard) {
+    FakeClipboard cb;
+    ClipboardSnapshot snap;
+    CHECK(snap.Capture(cb));
+    CHECK(snap.Empty());
+
+    cb.Set({{kUnicodeText, FakeClipboard::Text("copied")}});
+    CHECK(snap.Restore(cb));
+    CHECK(cb.formats.empty());
+}
+
+TEST_CASE(OpenFailureIsReported) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+    cb.failOpens = 1;
+    ClipboardSnapshot snap;
+    CHECK(!snap.Capture(cb));
+    CHECK(snap.Empty());
+
+    CHECK(snap.Capture(cb));
+    cb.failOpens = 1;
+    CHECK(!snap.Restore(cb));
+    CHECK_EQ(cb.writeCalls, 0);
+}
+
+TEST_CASE(SerializeRoundTrip) {
+    FakeClipboard cb;
+    FillRichClipboard(cb);
+    ClipboardSnapshot snap;
+    CHECK(snap.Capture(cb));
+
+    auto bytes = snap.Serialize();
+    ClipboardSnapshot copy;
+    CHECK(copy.Deserialize(bytes.data(), bytes.size()));
+    CHECK(copy.SameContentAs(snap));
+    CHECK_EQ(copy.entries().size(), snap.entries().size());
+    for (size_t i = 0; i < snap.entries().size(); i++) {
+        const auto& a = snap.entries()[i];
+        const auto& b = copy.entries()[i];
+        CHECK_EQ(a.format, b.format);
+        CHECK_EQ(a.size, b.size);
+        CHECK(std::equal(snap.Data(a), snap.Data(a) + a.size, copy.Data(b)));
+    }
+
+    FakeClipboard target;
+    CHECK(copy.Restore(target));
+    CHECK(*target.Get(kDib) == *cb.Get(kDib));
+}
+
+TEST_CASE(DeserializeRejectsCorruption) {
+    ClipboardSnapshot snap;
+    const std::uint8_t text[] = {'a', 'b', 'c'};
+    snap.Append(kUnicodeText, text, sizeof(text));
+    auto bytes = snap.Serialize();
+
+    ClipboardSnapshot out;
+    auto truncated = bytes;
+    truncated.pop_back();
+    CHECK(!out.Deserialize(truncated.data(), truncated.size()));
+
+    auto flipped = bytes;
+    flipped.back() ^= 0xFF;
+    CHECK(!out.Deserialize(flipped.data(), flipped.size()));
+
+    auto badMagic = bytes;
+    badMagic[0] ^= 1;
+    CHECK(!out.Deserialize(badMagic.data(), badMagic.size()));
+    CHECK(out.Empty());
+
+    CHECK(out.Deserialize(bytes.data(), bytes.size()));
+}
+
+TEST_MAIN()
@@ -0,0 +1,37 @@
+// XXH64 内容哈希测试
+#include "core/content_hash.h"
+#include "test_harness.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST_CASE(KnownVectors) {
+    CHECK_EQ(ztools::HashBytes("", 0), 0xEF46DB3751D8E999ULL);
+    CHECK_EQ(ztools::HashBytes("abc", 3), 0x44BC2CF5AD770999ULL);
+    const char* s = "Nobody inspects the spammish repetition";
+    CHECK_EQ(ztools::HashBytes(s, std::strlen(s)), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST_CASE(StreamingMatchesOneShot) {
+    std::vector<unsigned char> data(1000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<unsigned char>(i * 131 + 7);
+
+    const std::uint64_t expected = ztools::HashBytes(data.data(), data.size(), 42);
+    for (size_t chunk : {1, 3, 31, 32, 33, 100, 999}) {
+        ztools::ContentHasher hasher(42);
+        for (size_t off = 0; off < data.size(); off += chunk) {
+            hasher.Update(data.data() + off, std::min(chunk, data.size() - off));
+        }
+        CHECK_EQ(hasher.Digest(), expected);
+    }
+}
+
+TEST_CASE(SeedAndContentChangeHash) {
+    std::string a = "clipboard";
+    std::string b = "clipboarD";
+    CHECK(ztools::HashBytes(a.data(), a.size()) != ztools::HashBytes(b.data(), b.size()));
+    CHECK(ztools::HashBytes(a.data(), a.size(), 1) != ztools::HashBytes(a.data(), a.size(), 2));
+}
+
+TEST_MAIN()
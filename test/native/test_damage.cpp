@@ -0,0 +1,187 @@
+// 损伤区域追踪：裁剪、包含 / 贴近合并、相交切分、数量上限、整屏退化、选区变化损伤、重绘统计
+#include "core/damage.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using ztools::AddRectChange;
+using ztools::DamageTracker;
+using ztools::IntRect;
+using ztools::RepaintMeter;
+
+namespace {
+
+bool Covered(const DamageTracker& d, int x, int y) {
+    for (const IntRect& r : d.Rects()) {
+        if (r.Contains(x, y)) return true;
+    }
+    return false;
+}
+
+bool PairwiseDisjoint(const DamageTracker& d) {
+    const std::vector<IntRect>& rs = d.Rects();
+    for (size_t a = 0; a < rs.size(); a++) {
+        for (size_t b = a + 1; b < rs.size(); b++) {
+            if (!rs[a].Intersect(rs[b]).Empty()) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(AddClipsToCanvas) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 1000, 800));
+    d.Add(IntRect(-50, -50, 100, 100));
+    CHECK_EQ(d.Rects().size(), 1u);
+    CHECK(d.Rects()[0] == IntRect(0, 0, 50, 50));
+    d.Add(IntRect(2000, 2000, 10, 10));  // 完全在画布外
+    d.Add(IntRect(10, 10, 0, 5));        // 空矩形
+    CHECK_EQ(d.Rects().size(), 1u);
+    CHECK_EQ(d.Area(), 2500);
+    d.Clear();
+    CHECK(d.Empty());
+}
+
+TEST_CASE(ContainedAndContainingRectsCollapse) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 4000, 2000));
+    d.Add(IntRect(100, 100, 400, 300));
+    d.Add(IntRect(150, 150, 50, 50));  // 被包含：丢弃
+    CHECK_EQ(d.Rects().size(), 1u);
+    d.Add(IntRect(1500, 1000, 30, 30));
+    d.Add(IntRect(1400, 900, 300, 300));  // 包含上一块：替换
+    CHECK_EQ(d.Rects().size(), 2u);
+    CHECK_EQ(d.Area(), 400 * 300 + 300 * 300);
+}
+
+TEST_CASE(NearbyRectsMergeIntoBoundingBox) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 4000, 2000));
+    d.Add(IntRect(100, 100, 100, 100));
+    d.Add(IntRect(210, 100, 100, 100));  // 间隔 10px，合并只多 1000px
+    CHECK_EQ(d.Rects().size(), 1u);
+    CHECK(d.Rects()[0] == IntRect(100, 100, 210, 100));
+    d.Add(IntRect(3000, 1500, 100, 100));  // 离得远：单独一块
+    CHECK_EQ(d.Rects().size(), 2u);
+}
+
+TEST_CASE(CrossingBandsAreSplitNotMerged) {
+    // 选区边框的横、竖边带在角上相交：外包矩形会把整个选区内部也算进去，应切分而非合并
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 4000, 2000));
+    d.Add(IntRect(500, 500, 1200, 20));  // 上边带
+    d.Add(IntRect(500, 500, 20, 900));   // 左边带
+    CHECK(PairwiseDisjoint(d));
+    CHECK_EQ(d.Area(), 1200 * 20 + 20 * 880);
+    CHECK(Covered(d, 510, 510));
+    CHECK(Covered(d, 510, 1390));
+    CHECK(Covered(d, 1690, 510));
+    CHECK(!Covered(d, 1000, 1000));
+}
+
+TEST_CASE(RectCountIsCapped) {
+    DamageTracker d(4);
+    d.Reset(IntRect(0, 0, 4000, 4000));
+    std::vector<IntRect> inputs;
+    for (int i = 0; i < 10; i++) inputs.push_back(IntRect(i * 390, (i % 3) * 1300, 20, 20));
+    for (const IntRect& r : inputs) d.Add(r);
+    CHECK(d.Rects().size() <= 4u);
+    CHECK(PairwiseDisjoint(d));
+    for (const IntRect& r : inputs) {
+        CHECK(Covered(d, r.x, r.y));
+        CHECK(Covered(d, r.Right() - 1, r.Bottom() - 1));
+    }
+}
+
+TEST_CASE(LargeDamageBecomesFullFrame) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 1000, 1000));
+    d.Add(IntRect(0, 0, 1000, 400));
+    CHECK(!d.Full());
+    d.Add(IntRect(0, 600, 1000, 400));  // 合计 80%
+    CHECK(d.Full());
+    CHECK_EQ(d.Rects().size(), 1u);
+    d.Add(IntRect(10, 10, 10, 10));
+    CHECK(d.Full());
+    d.Reset(IntRect(0, 0, 1000, 1000));
+    d.AddAll();
+    CHECK(d.Full());
+    CHECK_EQ(d.Area(), 1000000);
+}
+
+TEST_CASE(RectChangeCoversSymmetricDifferenceAndEdges) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 3840, 2160));
+    IntRect before(400, 300, 1200, 800);
+    IntRect after = before.Offset(30, 20);  // 拖动选区
+    AddRectChange(d, before, after, 8);
+    CHECK(PairwiseDisjoint(d));
+    // 对称差：原来在选区内、现在在外的一条
+    CHECK(Covered(d, 410, 700));
+    CHECK(Covered(d, 1620, 700));
+    // 新旧边框附近
+    CHECK(Covered(d, 400 - 8, 300 - 8));
+    CHECK(Covered(d, after.Right() + 7, after.Bottom() + 7));
+    // 重叠区内部不重画
+    CHECK(!Covered(d, 1000, 700));
+    CHECK(d.Area() < before.w * before.h / 4);
+
+    d.Clear();
+    AddRectChange(d, before, before, 8);
+    CHECK(d.Empty());
+    AddRectChange(d, IntRect(), IntRect(100, 100, 10, 10), 4);  // 从无到有：整块 + 边带
+    CHECK(Covered(d, 96, 96));
+    CHECK(Covered(d, 105, 105));
+}
+
+TEST_CASE(RandomDamageStaysDisjointAndCoversInputs) {
+    std::mt19937 rng(39);
+    std::uniform_int_distribution<int> pos(-100, 2000), size(1, 400);
+    for (int round = 0; round < 50; round++) {
+        DamageTracker d(8);
+        d.Reset(IntRect(0, 0, 1920, 1080));
+        std::vector<IntRect> inputs;
+        for (int i = 0; i < 30; i++) {
+            IntRect r(pos(rng), pos(rng), size(rng), size(rng));
+            inputs.push_back(r);
+            d.Add(r);
+        }
+        CHECK(d.Rects().size() <= 8u);
+        CHECK(PairwiseDisjoint(d));
+        for (const IntRect& r : d.Rects()) CHECK(r.Intersect(d.canvas()) == r);
+        for (const IntRect& in : inputs) {
+            IntRect c = in.Intersect(d.canvas());
+            if (c.Empty()) continue;
+            CHECK(Covered(d, c.x, c.y));
+            CHECK(Covered(d, c.Right() - 1, c.Bottom() - 1));
+            CHECK(Covered(d, c.x + c.w / 2, c.y + c.h / 2));
+        }
+    }
+}
+
+TEST_CASE(RepaintMeterAccumulatesPerInteraction) {
+    DamageTracker d;
+    d.Reset(IntRect(0, 0, 100, 100));
+    RepaintMeter meter;
+    d.Add(IntRect(0, 0, 10, 10));
+    meter.Record(d);  // 未开始：忽略
+    CHECK_EQ(meter.stats().frames, 0);
+    meter.Begin();
+    CHECK(meter.Active());
+    meter.Record(d);
+    d.AddAll();
+    meter.Record(d);
+    ztools::RepaintStats s = meter.End();
+    CHECK(!meter.Active());
+    CHECK_EQ(s.frames, 2);
+    CHECK_EQ(s.fullFrames, 1);
+    CHECK_EQ(s.paintedPixels, 100 + 10000);
+    CHECK_EQ(s.canvasPixels, 20000);
+    CHECK(s.Coverage() > 0.50 && s.Coverage() < 0.51);
+}
+
+TEST_MAIN()
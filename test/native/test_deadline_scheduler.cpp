@@ -0,0 +1,111 @@
+// 截止时间调度核心测试（假时钟驱动）
+#include "core/deadline_scheduler.h"
+#include "test_harness.h"
+
+#include <vector>
+
+using namespace std::chrono;
+using ztools::DeadlineScheduler;
+using ztools::LongPressDetector;
+
+namespace {
+
+// 假时钟：只在测试显式 Advance 时前进
+struct FakeClock {
+    DeadlineScheduler::TimePoint now{};
+    void Advance(DeadlineScheduler::Duration d) { now += d; }
+};
+
+}  // namespace
+
+TEST_CASE(EmptySchedulerWaitsForever) {
+    DeadlineScheduler s;
+    FakeClock clock;
+    CHECK(!s.TimeUntilNext(clock.now).has_value());
+    CHECK_EQ(ztools::ToWaitMilliseconds(s.TimeUntilNext(clock.now)), 0xFFFFFFFFu);
+}
+
+TEST_CASE(FiresInDeadlineOrder) {
+    DeadlineScheduler s;
+    FakeClock clock;
+    auto late = s.Schedule(clock.now + milliseconds(30));
+    auto early = s.Schedule(clock.now + milliseconds(10));
+    auto mid = s.Schedule(clock.now + milliseconds(20));
+    CHECK(s.TimeUntilNext(clock.now) == DeadlineScheduler::Duration(milliseconds(10)));
+
+    std::vector<DeadlineScheduler::TimerId> fired;
+    clock.Advance(milliseconds(25));
+    CHECK_EQ(s.PopExpired(clock.now, [&](DeadlineScheduler::TimerId id) { fired.push_back(id); }), (size_t)2);
+    CHECK_EQ(fired.size(), (size_t)2);
+    CHECK_EQ(fired[0], early);
+    CHECK_EQ(fired[1], mid);
+    CHECK(s.TimeUntilNext(clock.now) == DeadlineScheduler::Duration(milliseconds(5)));
+    CHECK(s.Cancel(late));
+    CHECK(!s.Cancel(late));
+    CHECK(s.Empty());
+}
+
+TEST_CASE(WaitMillisecondsRoundsUp) {
+    CHECK_EQ(ztools::ToWaitMilliseconds(DeadlineScheduler::Duration(microseconds(1))), 1u);
+    CHECK_EQ(ztools::ToWaitMilliseconds(DeadlineScheduler::Duration(microseconds(2500))), 3u);
+    CHECK_EQ(ztools::ToWaitMilliseconds(DeadlineScheduler::Duration::zero()), 0u);
+}
+
+TEST_CASE(LongPressFiresExactlyAtThreshold) {
+    FakeClock clock;
+    LongPressDetector d(milliseconds(200));
+    CHECK(!d.TimeUntilDeadline(clock.now).has_value());
+
+    d.OnPress(clock.now);
+    CHECK(d.TimeUntilDeadline(clock.now) == LongPressDetector::Duration(milliseconds(200)));
+
+    clock.Advance(milliseconds(199) + microseconds(999));
+    CHECK(!d.OnTimer(clock.now));
+    CHECK(d.TimeUntilDeadline(clock.now) == LongPressDetector::Duration(microseconds(1)));
+
+    clock.Advance(microseconds(1));
+    CHECK(d.OnTimer(clock.now));
+    CHECK(d.triggered());
+    // 到期后不再有截止时间：按住不放也不会再唤醒
+    CHECK(!d.TimeUntilDeadline(clock.now).has_value());
+    clock.Advance(seconds(5));
+    CHECK(!d.OnTimer(clock.now));
+    CHECK(d.OnRelease());
+}
+
+TEST_CASE(ReleaseBeforeThresholdCancels) {
+    FakeClock clock;
+    LongPressDetector d(milliseconds(300));
+    d.OnPress(clock.now);
+    clock.Advance(milliseconds(120));
+    CHECK(!d.OnRelease());
+    CHECK(!d.TimeUntilDeadline(clock.now).has_value());
+    clock.Advance(milliseconds(500));
+    CHECK(!d.OnTimer(clock.now));
+    CHECK(!d.triggered());
+}
+
+TEST_CASE(RepressRestartsDeadline) {
+    FakeClock clock;
+    LongPressDetector d(milliseconds(100));
+    d.OnPress(clock.now);
+    clock.Advance(milliseconds(80));
+    d.OnRelease();
+    d.OnPress(clock.now);
+    clock.Advance(milliseconds(80));
+    CHECK(!d.OnTimer(clock.now));
+    clock.Advance(milliseconds(20));
+    CHECK(d.OnTimer(clock.now));
+}
+
+TEST_CASE(ClickModeNeverSchedules) {
+    FakeClock clock;
+    LongPressDetector d;
+    d.OnPress(clock.now);
+    CHECK(!d.TimeUntilDeadline(clock.now).has_value());
+    clock.Advance(seconds(10));
+    CHECK(!d.OnTimer(clock.now));
+    CHECK(!d.OnRelease());
+}
+
+TEST_MAIN()
@@ -0,0 +1,117 @@
+// 选区外遮罩：SIMD 内核与 BlendSolid 逐字节一致（全部 alpha、任意颜色、奇数宽度的尾部），
+// 按不相交的损伤矩形分块调用与整屏 BlendSolidOutside 一致且不碰损伤区外的像素，多线程不改变结果
+#include "core/damage.h"
+#include "core/dim_mask.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using ztools::IntRect;
+using ztools::PackBgra;
+using ztools::Surface;
+
+namespace {
+
+void FillNoise(const ztools::ImageView& view, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (int y = 0; y < view.height; y++) {
+        for (int x = 0; x < view.width; x++) view.Row(y)[x] = rng();
+    }
+}
+
+}  // namespace
+
+TEST_CASE(MatchesBlendSolidForEveryAlpha) {
+    Surface src(37, 3);  // 37 = 9 组向量 + 1 个尾部像素
+    FillNoise(src.view(), 47);
+    src.view().Row(0)[0] = 0x00000000;
+    src.view().Row(0)[1] = 0xFFFFFFFF;
+    const std::uint32_t colors[] = {PackBgra(0, 0, 0, 0), PackBgra(255, 255, 255, 255), PackBgra(12, 200, 99, 7)};
+    int mismatches = 0;
+    for (std::uint32_t color : colors) {
+        for (int alpha = 0; alpha <= 255; alpha++) {
+            Surface expect(37, 3), actual(37, 3);
+            ztools::Copy(src.view(), 0, 0, expect.view(), expect.view().Bounds());
+            ztools::Copy(src.view(), 0, 0, actual.view(), actual.view().Bounds());
+            ztools::BlendSolid(expect.view(), IntRect(1, 0, 36, 3), color, static_cast<std::uint8_t>(alpha));
+            ztools::DimRect(actual.view(), IntRect(1, 0, 36, 3), color, static_cast<std::uint8_t>(alpha));
+            if (ztest::ViewHash(expect.view()) != ztest::ViewHash(actual.view())) mismatches++;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST_CASE(DisjointDamageClipsMatchFullOutsideBlend) {
+    Surface original(640, 400);
+    ztest::FillScreenLike(original.view(), 47);
+    const IntRect selection(200, 120, 260, 170);
+
+    Surface full(640, 400);
+    ztools::Copy(original.view(), 0, 0, full.view(), full.view().Bounds());
+    ztools::BlendSolidOutside(full.view(), selection, PackBgra(0, 0, 0), 120);
+
+    // 拖动选区边缘时的典型损伤：跨越选区边界的若干块，经 DamageTracker 整理成两两不相交
+    ztools::DamageTracker damage;
+    damage.Reset(original.view().Bounds());
+    damage.Add(IntRect(150, 100, 120, 60));
+    damage.Add(IntRect(180, 130, 90, 200));
+    damage.Add(IntRect(440, 0, 60, 400));
+    damage.Add(IntRect(0, 390, 640, 30));
+    damage.Add(IntRect(250, 150, 40, 40));  // 完全在选区内
+    Surface partial(640, 400);
+    ztools::Copy(original.view(), 0, 0, partial.view(), partial.view().Bounds());
+    for (const IntRect& r : damage.Rects()) ztools::DimOutside(partial.view(), selection, r, PackBgra(0, 0, 0), 120);
+
+    int wrongInside = 0, touchedOutside = 0;
+    for (int y = 0; y < 400; y++) {
+        for (int x = 0; x < 640; x++) {
+            bool damaged = false;
+            for (const IntRect& r : damage.Rects()) damaged = damaged || r.Contains(x, y);
+            const std::uint32_t got = partial.view().Row(y)[x];
+            if (damaged && got != full.view().Row(y)[x]) wrongInside++;
+            if (!damaged && got != original.view().Row(y)[x]) touchedOutside++;
+        }
+    }
+    CHECK_EQ(wrongInside, 0);
+    CHECK_EQ(touchedOutside, 0);
+}
+
+TEST_CASE(ThreadsAndStridedViewsDoNotChangeResult) {
+    Surface big(1500, 1100);
+    FillNoise(big.view(), 48);
+    ztools::ImageView sub = big.view().Sub(IntRect(11, 5, 1301, 1033));
+    Surface expect(1301, 1033);
+    ztools::Copy(sub, 0, 0, expect.view(), expect.view().Bounds());
+    ztools::BlendSolidOutside(expect.view(), IntRect(400, 300, 500, 400), PackBgra(0, 0, 0), 120);
+    for (int threads : {1, 3, 0}) {
+        Surface actual(1301, 1033);
+        ztools::Copy(sub, 0, 0, actual.view(), actual.view().Bounds());
+        ztools::DimOutside(actual.view(), IntRect(400, 300, 500, 400), actual.view().Bounds(), PackBgra(0, 0, 0), 120,
+                           threads);
+        CHECK(ztest::ViewHash(expect.view()) == ztest::ViewHash(actual.view()));
+    }
+    // 直接在带 stride 的子视图上处理：子视图外的像素不动
+    const std::uint64_t before = ztest::ViewHash(big.view().Sub(IntRect(0, 0, 11, 1100)));
+    ztools::DimOutside(sub, IntRect(400, 300, 500, 400), sub.Bounds(), PackBgra(0, 0, 0), 120, 4);
+    CHECK(ztest::ViewHash(sub) == ztest::ViewHash(expect.view()));
+    CHECK(ztest::ViewHash(big.view().Sub(IntRect(0, 0, 11, 1100))) == before);
+}
+
+TEST_CASE(DegenerateInputs) {
+    Surface s(8, 8);
+    ztools::Fill(s.view(), s.view().Bounds(), PackBgra(100, 100, 100));
+    const std::uint64_t before = ztest::ViewHash(s.view());
+    ztools::DimRect(s.view(), s.view().Bounds(), PackBgra(0, 0, 0), 0);
+    ztools::DimRect(s.view(), IntRect(20, 20, 5, 5), PackBgra(0, 0, 0), 120);
+    ztools::DimOutside(s.view(), IntRect(0, 0, 8, 8), s.view().Bounds(), PackBgra(0, 0, 0), 120);  // 选区覆盖全部
+    ztools::DimRect(ztools::ImageView(), IntRect(0, 0, 4, 4), PackBgra(0, 0, 0), 120);
+    CHECK(ztest::ViewHash(s.view()) == before);
+    ztools::DimRect(s.view(), IntRect(0, 0, 2, 2), PackBgra(1, 2, 3, 4), 255);
+    CHECK_EQ(s.view().Row(1)[1], PackBgra(1, 2, 3, 4));
+    CHECK_EQ(s.view().Row(2)[2], PackBgra(100, 100, 100));
+}
+
+TEST_MAIN()
@@ -0,0 +1,83 @@
+// 整幅面积平均缩放：SIMD / 多线程版本必须与参考实现 Scale(..., ScaleFilter::Box) 逐像素一致
+#include "core/downscale.h"
+#include "core/simd.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <random>
+
+using ztools::IntRect;
+using ztools::Surface;
+
+namespace {
+
+// 四个通道都取满 0..255（含 alpha），覆盖饱和与舍入边界
+void FillNoise(const ztools::ImageView& view, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (int y = 0; y < view.height; y++) {
+        for (int x = 0; x < view.width; x++) view.Row(y)[x] = rng();
+    }
+}
+
+bool MatchesReference(const ztools::ImageView& src, int dstW, int dstH, int threads) {
+    Surface expect(dstW, dstH), actual(dstW, dstH);
+    ztools::Scale(src, src.Bounds(), expect.view(), expect.view().Bounds(), ztools::ScaleFilter::Box);
+    ztools::DownscaleBox(src, actual.view(), threads);
+    return ztest::ViewHash(expect.view()) == ztest::ViewHash(actual.view());
+}
+
+}  // namespace
+
+TEST_CASE(MatchesReferenceAcrossDpiScales) {
+    for (double scale : {1.25, 1.5, 1.75, 2.0, 2.5}) {
+        int dstW = 211, dstH = 97;
+        Surface phys(ztools::ScaleCoord(dstW, scale), ztools::ScaleCoord(dstH, scale));
+        ztest::FillScreenLike(phys.view(), static_cast<std::uint32_t>(scale * 100));
+        CHECK(MatchesReference(phys.view(), dstW, dstH, 1));
+        FillNoise(phys.view(), static_cast<std::uint32_t>(scale * 10));
+        CHECK(MatchesReference(phys.view(), dstW, dstH, 1));
+    }
+}
+
+TEST_CASE(MatchesReferenceOnOddSizesAndUpscale) {
+    Surface src(317, 203);
+    FillNoise(src.view(), 40);
+    CHECK(MatchesReference(src.view(), 1, 1, 1));
+    CHECK(MatchesReference(src.view(), 3, 202, 1));
+    CHECK(MatchesReference(src.view(), 316, 7, 1));
+    CHECK(MatchesReference(src.view(), 400, 260, 1));  // 放大（逻辑分辨率大于物理分辨率的异常配置）
+    CHECK(MatchesReference(src.view(), 317, 203, 1));  // 同尺寸：直接复制
+}
+
+TEST_CASE(ThreadsAndStridedViewsDoNotChangeResult) {
+    Surface big(1200, 900);
+    FillNoise(big.view(), 41);
+    ztools::ImageView sub = big.view().Sub(IntRect(13, 7, 961, 641));  // 行跨度大于宽度
+    CHECK(MatchesReference(sub, 641, 427, 1));
+    CHECK(MatchesReference(sub, 641, 427, 3));
+    CHECK(MatchesReference(sub, 641, 427, 8));
+    CHECK(MatchesReference(big.view(), 600, 450, 0));
+}
+
+TEST_CASE(SolidImagesStaySolid) {
+    for (std::uint32_t color : {0x00000000u, 0xFFFFFFFFu, 0x80FF0001u}) {
+        Surface src(301, 151), dst(200, 100);
+        ztools::Fill(src.view(), src.view().Bounds(), color);
+        ztools::DownscaleBox(src.view(), dst.view(), 2);
+        bool solid = true;
+        for (int y = 0; y < dst.height(); y++) {
+            for (int x = 0; x < dst.width(); x++) solid = solid && dst.view().Row(y)[x] == color;
+        }
+        CHECK(solid);
+    }
+}
+
+TEST_CASE(EmptyViewsAreIgnored) {
+    Surface src(10, 10), dst;
+    ztools::DownscaleBox(src.view(), dst.view(), 1);
+    ztools::DownscaleBox(dst.view(), src.view(), 1);
+    CHECK(ztools::SimdIsa() != nullptr);
+}
+
+TEST_MAIN()
@@ -0,0 +1,242 @@
+// 导出流水线：提交即返回、编码与发布并行、结果交付与像素释放、失败统计、析构等待、
+// 以及无界面截图会话中「确认 -> 关闭覆盖层」不等待编码
+#include "core/export_pipeline.h"
+#include "headless_capture.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+using ztest::HeadlessRegionSession;
+using ztools::ExportJob;
+using ztools::ExportPipeline;
+using ztools::ExportResult;
+using ztools::ImageView;
+using ztools::IntRect;
+
+namespace {
+
+// 一次性闸门：Wait 阻塞到 Open（带超时，防止实现有误时测试卡死）
+class Gate {
+public:
+    void Open() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            open_ = true;
+        }
+        cv_.notify_all();
+    }
+    bool Wait(milliseconds timeout = milliseconds(5000)) {
+        std::unique_lock<std::mutex> lock(m_);
+        return cv_.wait_for(lock, timeout, [this] { return open_; });
+    }
+    bool IsOpen() {
+        std::lock_guard<std::mutex> lock(m_);
+        return open_;
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// 收集工作线程交付的结果
+struct Sink {
+    std::mutex m;
+    std::vector<ExportResult> results;
+    int released = 0;
+
+    void Deliver(ExportResult&& r) {
+        std::lock_guard<std::mutex> lock(m);
+        results.push_back(std::move(r));
+    }
+    void Release() {
+        std::lock_guard<std::mutex> lock(m);
+        released++;
+    }
+};
+
+// 假编码：像素哈希写成十六进制字符串
+bool HashEncode(const ImageView& image, std::string& out) {
+    out = std::to_string(ztest::ViewHash(image));
+    return true;
+}
+
+ExportJob MakeJob(ztools::Surface& image, Sink& sink) {
+    ExportJob job;
+    job.image = image.view();
+    job.confirmedAt = ExportPipeline::Clock::now();
+    job.encode = HashEncode;
+    job.deliver = [&sink](ExportResult&& r) { sink.Deliver(std::move(r)); };
+    job.release = [&sink] { sink.Release(); };
+    return job;
+}
+
+}  // namespace
+
+TEST_CASE(DeliversEncodedPayloadAndReleasesPixels) {
+    ztools::Surface image(320, 200);
+    ztest::FillScreenLike(image.view(), 44);
+    Sink sink;
+    ExportPipeline pipeline;
+    ExportJob job = MakeJob(image, sink);
+    job.publish = [](const ImageView& v) { return v.width == 320; };
+    ztools::ExportId id = pipeline.Submit(std::move(job));
+    CHECK(id != 0);
+    pipeline.Drain();
+
+    CHECK_EQ(sink.results.size(), 1u);
+    const ExportResult& r = sink.results[0];
+    CHECK_EQ(r.id, id);
+    CHECK_EQ(r.width, 320);
+    CHECK_EQ(r.height, 200);
+    CHECK(r.encoded);
+    CHECK(r.published);
+    CHECK(r.payload == std::to_string(ztest::ViewHash(image.view())));
+    CHECK(r.timings.submitted <= r.timings.encoded);
+    CHECK(r.timings.encoded <= r.timings.delivered);
+    CHECK(r.timings.published <= r.timings.delivered);
+    CHECK_EQ(sink.released, 1);
+    CHECK_EQ(pipeline.InFlight(), 0);
+    CHECK_EQ(pipeline.stats().delivered, 1);
+}
+
+TEST_CASE(SubmitReturnsBeforeStagesRun) {
+    ztools::Surface image(64, 64);
+    Sink sink;
+    Gate gate;
+    ExportPipeline pipeline;
+    ExportJob job = MakeJob(image, sink);
+    job.encode = [&gate](const ImageView& v, std::string& out) {
+        if (!gate.Wait()) return false;
+        return HashEncode(v, out);
+    };
+    pipeline.Submit(std::move(job));
+    CHECK_EQ(pipeline.InFlight(), 1);
+    {
+        std::lock_guard<std::mutex> lock(sink.m);
+        CHECK(sink.results.empty());
+        CHECK_EQ(sink.released, 0);
+    }
+    gate.Open();
+    pipeline.Drain();
+    CHECK_EQ(sink.results.size(), 1u);
+    CHECK(sink.results[0].encoded);
+}
+
+TEST_CASE(EncodeAndPublishRunConcurrently) {
+    // 编码要等发布开始后才继续：两个阶段若串行执行，编码会等到超时而失败
+    ztools::Surface image(64, 64);
+    Sink sink;
+    Gate publishStarted, encodeDone;
+    ExportPipeline pipeline(2);
+    ExportJob job = MakeJob(image, sink);
+    job.encode = [&](const ImageView& v, std::string& out) {
+        bool overlapped = publishStarted.Wait(milliseconds(2000));
+        encodeDone.Open();
+        return overlapped && HashEncode(v, out);
+    };
+    job.publish = [&](const ImageView&) {
+        publishStarted.Open();
+        return encodeDone.Wait(milliseconds(2000));
+    };
+    pipeline.Submit(std::move(job));
+    pipeline.Drain();
+    CHECK_EQ(sink.results.size(), 1u);
+    CHECK(sink.results[0].encoded);
+    CHECK(sink.results[0].published);
+}
+
+TEST_CASE(FailuresAreReportedAndCounted) {
+    ztools::Surface image(16, 16);
+    Sink sink;
+    ExportPipeline pipeline(1);
+    ExportJob job = MakeJob(image, sink);
+    job.encode = [](const ImageView&, std::string& out) {
+        out = "partial";
+        return false;
+    };
+    job.publish = [](const ImageView&) { return false; };
+    pipeline.Submit(std::move(job));
+    pipeline.Submit(MakeJob(image, sink));  // 无发布阶段
+    pipeline.Drain();
+
+    CHECK_EQ(sink.results.size(), 2u);
+    for (const ExportResult& r : sink.results) {
+        if (r.id == 1) {
+            CHECK(!r.encoded);
+            CHECK(r.payload.empty());
+            CHECK(!r.published);
+        } else {
+            CHECK(r.encoded);
+            CHECK(!r.published);
+        }
+    }
+    ztools::ExportStats s = pipeline.stats();
+    CHECK_EQ(s.submitted, 2);
+    CHECK_EQ(s.delivered, 2);
+    CHECK_EQ(s.encodeFailures, 1);
+    CHECK_EQ(s.publishFailures, 1);
+    CHECK_EQ(sink.released, 2);
+}
+
+TEST_CASE(DestructorFinishesSubmittedJobs) {
+    ztools::Surface image(32, 32);
+    Sink sink;
+    {
+        ExportPipeline pipeline(1);
+        for (int i = 0; i < 6; i++) {
+            ExportJob job = MakeJob(image, sink);
+            job.publish = [](const ImageView&) { return true; };
+            pipeline.Submit(std::move(job));
+        }
+        CHECK(pipeline.stats().maxInFlight >= 1);
+    }
+    CHECK_EQ(sink.results.size(), 6u);
+    CHECK_EQ(sink.released, 6);
+}
+
+TEST_CASE(HeadlessSessionClosesBeforeEncodingFinishes) {
+    HeadlessRegionSession session(1280, 720);
+    CHECK(session.Begin());
+    const IntRect selection(100, 80, 640, 360);
+
+    Sink sink;
+    Gate gate;
+    ExportPipeline pipeline;
+    ExportJob stages;
+    stages.encode = [&gate](const ImageView& v, std::string& out) {
+        if (!gate.Wait()) return false;
+        return HashEncode(v, out);
+    };
+    stages.publish = [](const ImageView& v) { return !v.Empty(); };
+    stages.deliver = [&sink](ExportResult&& r) { sink.Deliver(std::move(r)); };
+    ztools::ExportId id = session.Confirm(selection, pipeline, std::move(stages));
+
+    // 覆盖层已关闭，编码仍被闸门挡着
+    CHECK(session.closed());
+    CHECK(!gate.IsOpen());
+    CHECK_EQ(pipeline.InFlight(), 1);
+    gate.Open();
+    pipeline.Drain();
+
+    CHECK_EQ(sink.results.size(), 1u);
+    const ExportResult& r = sink.results[0];
+    CHECK_EQ(r.id, id);
+    CHECK_EQ(r.width, 640);
+    CHECK_EQ(r.height, 360);
+    CHECK(r.encoded);
+    CHECK(r.published);
+    // 交付的是选区像素（会话截图的对应子区）
+    CHECK(r.payload == std::to_string(ztest::ViewHash(session.screen().view().Sub(selection))));
+    CHECK(session.closeLatency() <= r.timings.delivered);
+}
+
+TEST_MAIN()
@@ -0,0 +1,90 @@
+#pragma once
+
+// 可移植核心（src/core）单元测试的最小断言框架：
+// 每个 test_*.cpp 独立编译为一个可执行文件，由 scripts/test-native.js 驱动。
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ztest {
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& FailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*fn)()) { Registry().push_back({name, fn}); }
+};
+
+inline void ReportFailure(const char* file, int line, const std::string& what) {
+    ++FailureCount();
+    std::fprintf(stderr, "  ❌ %s:%d: %s\n", file, line, what.c_str());
+}
+
+template <typename T>
+std::string Show(const T& v) {
+    if constexpr (std::is_enum_v<T>) {
+        return std::to_string(static_cast<long long>(v));
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return std::to_string(v);
+    } else if constexpr (std::is_convertible_v<T, std::string>) {
+        return "\"" + std::string(v) + "\"";
+    } else {
+        return "<?>";
+    }
+}
+
+inline int RunAll() {
+    int failedCases = 0;
+    for (const auto& tc : Registry()) {
+        int before = FailureCount();
+        tc.fn();
+        if (FailureCount() == before) {
+            std::printf("  ✅ %s\n", tc.name);
+        } else {
+            std::printf("  ❌ %s\n", tc.name);
+            ++failedCases;
+        }
+    }
+    std::printf("  %d/%d passed\n", (int)Registry().size() - failedCases, (int)Registry().size());
+    return failedCases == 0 ? 0 : 1;
+}
+
+}  // namespace ztest
+
+#define TEST_CASE(name)                                               \
+    static void name();                                               \
+    static ztest::Registrar name##_registrar(#name, name);            \
+    static void name()
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) ztest::ReportFailure(__FILE__, __LINE__, #cond); \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                   \
+    do {                                                                                 \
+        const auto& _va = (a);                                                           \
+        const auto& _vb = (b);                                                           \
+        if (!(_va == _vb))                                                               \
+            ztest::ReportFailure(__FILE__, __LINE__,                                     \
+                                 std::string(#a " == " #b " (") + ztest::Show(_va) + " vs " \
+                                     + ztest::Show(_vb) + ")");                          \
+    } while (0)
+
+#define TEST_MAIN() \
+    int main() { return ztest::RunAll(); }
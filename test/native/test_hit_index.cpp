@@ -0,0 +1,177 @@
+// 命中测试空间索引：查询与暴力包围盒扫描一致、顶层优先顺序、增量替换 / 截断、折线分段
+#include "core/hit_index.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <vector>
+
+using ztools::HitCandidate;
+using ztools::HitGrid;
+using ztools::HitPart;
+using ztools::IntRect;
+
+namespace {
+
+struct Pt {
+    int x, y;
+};
+
+HitPart Box(int x, int y, int w, int h) {
+    HitPart p;
+    p.box = IntRect(x, y, w, h);
+    return p;
+}
+
+std::vector<HitCandidate> BruteForce(const HitGrid& grid, int x, int y) {
+    std::vector<HitCandidate> out;
+    for (int i = grid.ItemCount() - 1; i >= 0; i--) {
+        const std::vector<HitPart>& parts = grid.Parts(i);
+        for (int p = 0; p < static_cast<int>(parts.size()); p++) {
+            if (parts[p].box.Contains(x, y)) out.push_back({i, p});
+        }
+    }
+    return out;
+}
+
+bool Same(const std::vector<HitCandidate>& a, const std::vector<HitCandidate>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].item != b[i].item || a[i].part != b[i].part) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(QueryReturnsTopmostFirst) {
+    HitGrid grid;
+    grid.SetItem(0, {Box(0, 0, 100, 100)});
+    grid.SetItem(1, {Box(50, 50, 100, 100)});
+    grid.SetItem(2, {Box(500, 500, 10, 10)});
+    std::vector<HitCandidate> out;
+    grid.Query(60, 60, out);
+    CHECK_EQ(out.size(), 2u);
+    CHECK_EQ(out[0].item, 1);
+    CHECK_EQ(out[1].item, 0);
+    grid.Query(10, 10, out);
+    CHECK_EQ(out.size(), 1u);
+    grid.Query(100, 20, out);  // 右边界不含
+    CHECK(out.empty());
+    grid.Query(505, 505, out);
+    CHECK_EQ(out.size(), 1u);
+    CHECK_EQ(out[0].item, 2);
+}
+
+TEST_CASE(NegativeCoordinatesAcrossCells) {
+    // 多显示器虚拟屏幕坐标可以为负
+    HitGrid grid(64);
+    grid.SetItem(0, {Box(-130, -70, 80, 20)});
+    std::vector<HitCandidate> out;
+    grid.Query(-129, -51, out);
+    CHECK_EQ(out.size(), 1u);
+    grid.Query(-51, -70, out);
+    CHECK_EQ(out.size(), 1u);
+    grid.Query(-50, -60, out);
+    CHECK(out.empty());
+    grid.Query(-131, -60, out);
+    CHECK(out.empty());
+}
+
+TEST_CASE(SetItemReplacesAndTruncateRemoves) {
+    HitGrid grid;
+    grid.SetItem(0, {Box(0, 0, 10, 10)});
+    grid.SetItem(1, {Box(0, 0, 10, 10)});
+    std::vector<HitCandidate> out;
+    grid.SetItem(0, {Box(300, 300, 10, 10)});  // 拖走
+    grid.Query(5, 5, out);
+    CHECK_EQ(out.size(), 1u);
+    CHECK_EQ(out[0].item, 1);
+    grid.Query(305, 305, out);
+    CHECK_EQ(out.size(), 1u);
+    CHECK_EQ(out[0].item, 0);
+
+    grid.Truncate(1);
+    CHECK_EQ(grid.ItemCount(), 1);
+    grid.Query(5, 5, out);
+    CHECK(out.empty());
+    grid.SetItem(0, {});
+    CHECK_EQ(grid.CellCount(), 0u);  // 空格子被回收
+}
+
+TEST_CASE(PolylinePartsCoverEverySegment) {
+    std::vector<Pt> pts;
+    for (int i = 0; i < 50; i++) pts.push_back({i * 7, (i % 9) * 5});
+    std::vector<HitPart> parts;
+    ztools::AppendPolylineParts(pts.data(), static_cast<int>(pts.size()), 3, parts);
+    CHECK_EQ(parts.size(), 4u);  // 49 段 / 16 = 4 个部件
+    CHECK_EQ(parts.front().first, 0);
+    CHECK_EQ(parts.back().last, 49);
+    for (size_t p = 1; p < parts.size(); p++) CHECK_EQ(parts[p].first, parts[p - 1].last);
+    for (const HitPart& part : parts) {
+        for (int i = part.first; i <= part.last; i++) {
+            CHECK(part.box.Contains(pts[i].x - 3, pts[i].y - 3));
+            CHECK(part.box.Contains(pts[i].x + 3, pts[i].y + 3));
+        }
+    }
+
+    std::vector<HitPart> single;
+    Pt one = {4, 4};
+    ztools::AppendPolylineParts(&one, 1, 2, single);
+    CHECK_EQ(single.size(), 1u);
+    CHECK(single[0].box == IntRect(2, 2, 5, 5));
+}
+
+TEST_CASE(MatchesBruteForceUnderEdits) {
+    HitGrid grid(48);
+    std::uint32_t seed = 7;
+    auto next = [&seed](int mod) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<int>((seed >> 8) % static_cast<std::uint32_t>(mod));
+    };
+    for (int round = 0; round < 300; round++) {
+        int op = next(10);
+        if (op < 7) {
+            std::vector<HitPart> parts;
+            int n = 1 + next(3);
+            for (int k = 0; k < n; k++) parts.push_back(Box(next(900) - 300, next(700) - 200, 1 + next(200), 1 + next(120)));
+            grid.SetItem(next(grid.ItemCount() + 2), parts);
+        } else if (op < 9 && grid.ItemCount() > 0) {
+            grid.SetItem(next(grid.ItemCount()), {});
+        } else {
+            grid.Truncate(next(grid.ItemCount() + 1));
+        }
+        std::vector<HitCandidate> out;
+        for (int q = 0; q < 20; q++) {
+            int x = next(1000) - 350, y = next(800) - 250;
+            grid.Query(x, y, out);
+            CHECK(Same(out, BruteForce(grid, x, y)));
+        }
+    }
+}
+
+TEST_CASE(FirstItemAtMatchesLinearWindowScan) {
+    // 截图待选窗口：编号 = z 序（0 为最上层），取第一个包含鼠标的窗口
+    std::vector<IntRect> windows;
+    std::uint32_t seed = 11;
+    auto next = [&seed](int mod) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<int>((seed >> 8) % static_cast<std::uint32_t>(mod));
+    };
+    for (int i = 0; i < 400; i++) windows.push_back(IntRect(next(3000) - 1000, next(1600) - 200, 50 + next(1200), 50 + next(800)));
+    windows.push_back(IntRect(-1920, 0, 1920 + 2560, 1440));  // 最底层的整桌面窗口
+    HitGrid grid(256);
+    for (int i = 0; i < static_cast<int>(windows.size()); i++) grid.SetItem(i, {Box(windows[i].x, windows[i].y, windows[i].w, windows[i].h)});
+    for (int q = 0; q < 3000; q++) {
+        int x = next(5000) - 2200, y = next(1800) - 200;
+        int expected = -1;
+        for (int i = 0; i < static_cast<int>(windows.size()); i++) {
+            if (windows[i].Contains(x, y)) {
+                expected = i;
+                break;
+            }
+        }
+        CHECK_EQ(grid.FirstItemAt(x, y), expected);
+    }
+}
+
+TEST_MAIN()
@@ -0,0 +1,206 @@
+// 截图输出编码器：QOI 文件头与逐字节参考流、按规范解码的往返一致、长游程、源 stride；
+// raw 紧凑排列与 alpha；登记表的查找 / 别名 / 替换；质量预设
+#include "core/image_encoder.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using ztools::EncodeOptions;
+using ztools::ImageView;
+
+namespace {
+
+std::uint32_t GetU32Be(const std::uint8_t* p) {
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+}
+
+// 按 QOI 规范写的参考解码器（支持全部 op），输出 0xAARRGGBB
+bool DecodeQoi(const std::vector<std::uint8_t>& data, int& w, int& h, std::vector<std::uint32_t>& pixels) {
+    if (data.size() < 22 || std::memcmp(data.data(), "qoif", 4) != 0) return false;
+    w = static_cast<int>(GetU32Be(data.data() + 4));
+    h = static_cast<int>(GetU32Be(data.data() + 8));
+    pixels.assign(static_cast<size_t>(w) * h, 0);
+    std::uint8_t r = 0, g = 0, b = 0, a = 255;
+    std::uint8_t index[64][4] = {};
+    size_t p = 14;
+    const size_t end = data.size() - 8;
+    int run = 0;
+    for (size_t i = 0; i < pixels.size(); i++) {
+        if (run > 0) {
+            run--;
+        } else if (p < end) {
+            const std::uint8_t b1 = data[p++];
+            if (b1 == 0xFE) {
+                r = data[p++];
+                g = data[p++];
+                b = data[p++];
+            } else if (b1 == 0xFF) {
+                r = data[p++];
+                g = data[p++];
+                b = data[p++];
+                a = data[p++];
+            } else if ((b1 & 0xC0) == 0x00) {
+                r = index[b1][0];
+                g = index[b1][1];
+                b = index[b1][2];
+                a = index[b1][3];
+            } else if ((b1 & 0xC0) == 0x40) {
+                r += ((b1 >> 4) & 3) - 2;
+                g += ((b1 >> 2) & 3) - 2;
+                b += (b1 & 3) - 2;
+            } else if ((b1 & 0xC0) == 0x80) {
+                const std::uint8_t b2 = data[p++];
+                const int vg = (b1 & 0x3F) - 32;
+                r += vg - 8 + ((b2 >> 4) & 0x0F);
+                g += vg;
+                b += vg - 8 + (b2 & 0x0F);
+            } else {
+                run = b1 & 0x3F;
+            }
+            const int slot = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+            index[slot][0] = r;
+            index[slot][1] = g;
+            index[slot][2] = b;
+            index[slot][3] = a;
+        } else {
+            return false;
+        }
+        pixels[i] = (std::uint32_t(a) << 24) | (std::uint32_t(r) << 16) | (std::uint32_t(g) << 8) | b;
+    }
+    static const std::uint8_t kEnd[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    return p == end && std::memcmp(data.data() + end, kEnd, 8) == 0;
+}
+
+bool RoundTrips(const ImageView& view) {
+    std::vector<std::uint8_t> qoi;
+    if (!ztools::MakeQoiEncoder()->Encode(view, EncodeOptions(), qoi)) return false;
+    int w = 0, h = 0;
+    std::vector<std::uint32_t> decoded;
+    if (!DecodeQoi(qoi, w, h, decoded) || w != view.width || h != view.height) return false;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (decoded[static_cast<size_t>(y) * w + x] != (view.Row(y)[x] | 0xFF000000u)) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(QoiStreamMatchesReferenceBytes) {
+    // 4x1：黑（与初始前一像素相同 -> RUN）、小差分（源 alpha 为 0x80，按不透明处理）、
+    // 大差分（LUMA）、回到第二个像素（索引表命中）
+    std::uint32_t px[4] = {0x00000000, 0x80010101, 0x00191E19, 0x00010101};
+    std::vector<std::uint8_t> out;
+    CHECK(ztools::MakeQoiEncoder()->Encode(ImageView(px, 4, 1, 16), EncodeOptions(), out));
+    const std::uint8_t expected[] = {
+        'q', 'o', 'i', 'f', 0, 0, 0, 4, 0, 0, 0, 1, 3, 0,  // 4x1，RGB，sRGB
+        0xC0,                                               // RUN 1
+        0x7F,                                               // DIFF +1 +1 +1
+        0xBD, 0x33,                                         // LUMA vg = 29，vr - vg = vb - vg = -5
+        0x04,                                               // INDEX 4 = (1*3 + 1*5 + 1*7 + 255*11) % 64
+        0, 0, 0, 0, 0, 0, 0, 1,
+    };
+    CHECK_EQ(out.size(), sizeof(expected));
+    CHECK(out.size() == sizeof(expected) && std::memcmp(out.data(), expected, sizeof(expected)) == 0);
+}
+
+TEST_CASE(QoiRoundTripsScreenContentThroughStride) {
+    ztools::Surface screen(257, 131);
+    ztest::FillScreenLike(screen.view(), 46);
+    CHECK(RoundTrips(screen.view()));
+    CHECK(RoundTrips(screen.view().Sub(ztools::IntRect(13, 7, 100, 90))));  // stride 大于行宽
+}
+
+TEST_CASE(QoiSplitsLongRunsAt62) {
+    ztools::Surface image(200, 1);
+    ztools::Fill(image.view(), image.view().Bounds(), 0x00FFFFFF);
+    std::vector<std::uint8_t> out;
+    CHECK(ztools::MakeQoiEncoder()->Encode(image.view(), EncodeOptions(), out));
+    // 白色相对初始黑色各通道差 -1（回绕）-> 1 字节 DIFF；余下 199 像素 = 62 + 62 + 62 + 13 -> 4 个 RUN
+    CHECK_EQ(out.size(), (size_t)(14 + 1 + 4 + 8));
+    CHECK_EQ(out[15], 0xC0 | 61);
+    CHECK_EQ(out[18], 0xC0 | 12);
+    CHECK(RoundTrips(image.view()));
+}
+
+TEST_CASE(RawPacksRowsAndForcesAlpha) {
+    std::vector<std::uint32_t> storage(5 * 2, 0xDEADBEEF);
+    storage[0] = 0x00102030;
+    storage[1] = 0x40506070;
+    storage[5] = 0x00A0B0C0;
+    storage[6] = 0x00D0E0F0;
+    std::vector<std::uint8_t> out;
+    auto raw = ztools::MakeRawBgraEncoder();
+    CHECK(raw->Encode(ImageView(storage.data(), 2, 2, 5 * 4), EncodeOptions(), out));
+    CHECK_EQ(out.size(), (size_t)16);
+    std::uint32_t px[4];
+    std::memcpy(px, out.data(), 16);
+    CHECK_EQ(px[0], 0xFF102030u);
+    CHECK_EQ(px[1], 0xFF506070u);
+    CHECK_EQ(px[2], 0xFFA0B0C0u);
+    CHECK_EQ(px[3], 0xFFD0E0F0u);
+    CHECK(!raw->Encode(ImageView(), EncodeOptions(), out));
+    CHECK(!ztools::MakeQoiEncoder()->Encode(ImageView(), EncodeOptions(), out));
+}
+
+namespace {
+
+class FakeJpegEncoder : public ztools::ImageEncoder {
+public:
+    explicit FakeJpegEncoder(int tag) : tag_(tag) {}
+    const char* Name() const override { return "jpeg"; }
+    const char* MimeType() const override { return "image/jpeg"; }
+    const char* Extension() const override { return "jpg"; }
+    bool Lossy() const override { return true; }
+    bool Encode(const ImageView&, const EncodeOptions& options, std::vector<std::uint8_t>& out) const override {
+        out.assign(1, static_cast<std::uint8_t>(tag_ * 100 + options.quality));
+        return true;
+    }
+
+private:
+    int tag_;
+};
+
+}  // namespace
+
+TEST_CASE(RegistryFindsByNameAliasAndReplaces) {
+    ztools::EncoderRegistry registry;
+    ztools::RegisterBuiltinEncoders(registry);
+    CHECK(registry.Names() == std::vector<std::string>({"qoi", "raw"}));
+    CHECK(registry.Find("QOI") != nullptr);
+    CHECK(std::string(registry.Find("raw")->MimeType()) == "application/octet-stream");
+    CHECK(registry.Find("jpg") == nullptr);
+    CHECK(registry.Find("webp") == nullptr);
+
+    registry.Register(std::unique_ptr<ztools::ImageEncoder>(new FakeJpegEncoder(0)));
+    registry.Register(std::unique_ptr<ztools::ImageEncoder>(new FakeJpegEncoder(1)));  // 同名替换
+    CHECK_EQ(registry.Names().size(), (size_t)3);
+    const ztools::ImageEncoder* jpeg = registry.Find("jpg");
+    CHECK(jpeg != nullptr && jpeg == registry.Find("JPEG"));
+    CHECK(jpeg->Lossy());
+    EncodeOptions options;
+    options.quality = 42;
+    std::vector<std::uint8_t> out;
+    std::uint32_t px = 0;
+    CHECK(jpeg->Encode(ImageView(&px, 1, 1, 4), options, out));
+    CHECK_EQ(out[0], 142);
+}
+
+TEST_CASE(QualityPresets) {
+    int q = 7;
+    CHECK(ztools::ParseQualityPreset("high", q));
+    CHECK_EQ(q, 92);
+    CHECK(ztools::ParseQualityPreset("Balanced", q));
+    CHECK_EQ(q, 80);
+    CHECK(ztools::ParseQualityPreset("small", q));
+    CHECK_EQ(q, 60);
+    CHECK(!ztools::ParseQualityPreset("ultra", q));
+    CHECK_EQ(q, 60);
+}
+
+TEST_MAIN()
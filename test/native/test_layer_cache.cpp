@@ -0,0 +1,202 @@
+// 标注缓存层测试：有效性 / 重建清空、内容范围登记、合成与逐个直接绘制结果一致
+#include "core/brush_mask.h"
+#include "core/layer_cache.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <vector>
+
+using ztools::CoverageMask;
+using ztools::IntRect;
+using ztools::LayerCache;
+using ztools::MaskPoint;
+using ztools::Surface;
+
+namespace {
+
+struct Stroke {
+    std::vector<MaskPoint> pts;
+    int radius;
+    std::uint32_t color;
+};
+
+std::vector<Stroke> SampleStrokes() {
+    return {
+        {{{10, 10}, {60, 30}, {90, 12}}, 3, ztools::PackBgra(0xE5, 0x39, 0x35)},
+        {{{30, 50}, {30, 90}}, 2, ztools::PackBgra(0x1E, 0x88, 0xE5)},
+        {{{50, 20}, {20, 70}, {100, 80}}, 5, ztools::PackBgra(0xFD, 0xD8, 0x35)},
+    };
+}
+
+void DrawStroke(const Stroke& s, CoverageMask& scratch, const ztools::ImageView& dst) {
+    scratch.ClearAll();
+    IntRect dirty = ztools::RasterizeStroke(scratch, s.pts.data(), static_cast<int>(s.pts.size()), s.radius);
+    ztools::BlendCoverage(scratch, s.color, dst, dirty);
+}
+
+}  // namespace
+
+TEST_CASE(ValidityFollowsKey) {
+    Surface pixels(32, 32);
+    LayerCache layer;
+    CHECK(!layer.IsValid(1));
+    layer.Attach(pixels.view());
+    CHECK(!layer.IsValid(1));
+    layer.BeginRebuild(1);
+    CHECK(layer.IsValid(1));
+    CHECK(!layer.IsValid(2));
+    CHECK_EQ(layer.Rebuilds(), 1u);
+    layer.Invalidate();
+    CHECK(!layer.IsValid(1));
+    layer.BeginRebuild(1);
+    layer.Attach(pixels.view());  // 重新绑定后内容未知
+    CHECK(!layer.IsValid(1));
+}
+
+TEST_CASE(RebuildClearsPreviousContent) {
+    Surface pixels(64, 48);
+    ztools::Fill(pixels.view(), pixels.view().Bounds(), 0x80402010u);  // 绑定前的残留内容
+    LayerCache layer;
+    layer.Attach(pixels.view());
+    ztools::ImageView v = layer.BeginRebuild(7);
+    for (int y = 0; y < v.height; y++)
+        for (int x = 0; x < v.width; x++) CHECK_EQ(v.At(x, y), 0u);
+
+    ztools::Fill(v, IntRect(5, 6, 10, 4), 0xFF00FF00u);
+    layer.MarkDrawn(IntRect(5, 6, 10, 4));
+    CHECK(layer.ContentBounds() == IntRect(5, 6, 10, 4));
+
+    v = layer.BeginRebuild(8);
+    CHECK(layer.ContentBounds().Empty());
+    CHECK_EQ(v.At(5, 6), 0u);
+    CHECK_EQ(v.At(14, 9), 0u);
+}
+
+TEST_CASE(UpdateClearsOnlyTheDamage) {
+    Surface pixels(256, 128);
+    LayerCache layer;
+    layer.Attach(pixels.view());
+    ztools::ImageView v = layer.BeginUpdate(1, IntRect(0, 0, 8, 8));  // 还没建过：整层重建
+    CHECK(layer.Built());
+    CHECK_EQ(layer.Rebuilds(), 1u);
+    ztools::Fill(v, IntRect(10, 10, 20, 20), 0xFF0000FFu);
+    ztools::Fill(v, IntRect(150, 70, 30, 30), 0xFF00FF00u);
+    layer.MarkDrawn(IntRect(10, 10, 20, 20));
+    layer.MarkDrawn(IntRect(150, 70, 30, 30));
+
+    // 第二个图形移走：只清它原来所在的格子范围，第一个图形不动
+    v = layer.BeginUpdate(2, IntRect(128, 64, 64, 64));
+    CHECK(layer.IsValid(2));
+    CHECK_EQ(layer.Rebuilds(), 1u);
+    CHECK_EQ(layer.Updates(), 1u);
+    CHECK_EQ(v.At(15, 15), 0xFF0000FFu);
+    CHECK_EQ(v.At(160, 80), 0u);
+    int runs = 0;
+    layer.ForEachRun(0, 0, v.Bounds(), [&](const IntRect& r) {
+        runs++;
+        CHECK(r.Intersect(IntRect(128, 64, 64, 64)).Empty());  // 清空的格子不再参与合成
+    });
+    CHECK_EQ(runs, 1);
+
+    // 失效后退化为整层重建
+    layer.Invalidate();
+    v = layer.BeginUpdate(3, IntRect(0, 0, 4, 4));
+    CHECK_EQ(layer.Rebuilds(), 2u);
+    CHECK_EQ(v.At(15, 15), 0u);
+}
+
+TEST_CASE(MarkDrawnByAlphaFindsTightBounds) {
+    Surface pixels(50, 40);
+    LayerCache layer;
+    layer.Attach(pixels.view());
+    ztools::ImageView v = layer.BeginRebuild(1);
+    v.At(12, 7) = 0x40101010u;
+    v.At(30, 22) = 0xFF0000FFu;
+    v.At(3, 39) = 0x00FFFFFFu;  // alpha = 0 不算内容
+    layer.MarkDrawnByAlpha(v.Bounds());
+    CHECK(layer.ContentBounds() == IntRect::FromLTRB(12, 7, 31, 23));
+    layer.MarkDrawn(IntRect(45, 35, 20, 20));  // 超出层的部分裁掉
+    CHECK(layer.ContentBounds() == IntRect::FromLTRB(12, 7, 50, 40));
+}
+
+TEST_CASE(CompositeMatchesDirectDrawing) {
+    const int w = 120, h = 100;
+    std::vector<Stroke> strokes = SampleStrokes();
+    CoverageMask scratch;
+    scratch.Reset(w, h);
+
+    Surface direct(w, h);
+    ztest::FillScreenLike(direct.view(), 3);
+    Surface cached(w, h);
+    ztools::Copy(direct.view(), 0, 0, cached.view(), cached.view().Bounds());
+
+    for (const Stroke& s : strokes) DrawStroke(s, scratch, direct.view());
+
+    Surface layerPixels(w, h);
+    LayerCache layer;
+    layer.Attach(layerPixels.view());
+    ztools::ImageView lv = layer.BeginRebuild(42);
+    for (const Stroke& s : strokes) DrawStroke(s, scratch, lv);
+    layer.MarkDrawnByAlpha(lv.Bounds());
+    layer.CompositeOnto(cached.view(), 0, 0, cached.view().Bounds());
+
+    // 预乘 src-over 满足结合律，逐像素误差只来自两次 /255 取整
+    int maxDiff = 0;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            for (int c = 0; c < 3; c++) {
+                int d = ztest::Channel(direct.view().At(x, y), c) - ztest::Channel(cached.view().At(x, y), c);
+                if (d < 0) d = -d;
+                if (d > maxDiff) maxDiff = d;
+            }
+        }
+    }
+    CHECK(maxDiff <= 2);
+}
+
+TEST_CASE(RunsSkipEmptyCells) {
+    const int cell = LayerCache::kCellSize;
+    Surface pixels(cell * 4, cell * 2);
+    LayerCache layer;
+    layer.Attach(pixels.view());
+    ztools::ImageView v = layer.BeginRebuild(1);
+    v.At(5, 5) = 0xFF000000u;                 // 格 (0,0)
+    v.At(cell * 3 + 1, cell + 2) = 0xFF000000u;  // 格 (3,1)
+    layer.MarkDrawnByAlpha(v.Bounds());
+    std::vector<IntRect> runs;
+    layer.ForEachRun(0, 0, v.Bounds(), [&](const IntRect& r) { runs.push_back(r); });
+    CHECK_EQ(runs.size(), 2u);
+    // 段被裁剪到内容外包，且中间的空格子不参与合成
+    CHECK(runs[0] == IntRect(5, 5, cell - 5, cell - 5));
+    CHECK(runs[1] == IntRect(cell * 3, cell, 2, 3));
+
+    // 下次重建只清零登记过的格子
+    v.At(cell * 2, 0) = 0xFF000000u;  // 未登记的像素保留（调用方约定只在登记范围内绘制）
+    layer.BeginRebuild(2);
+    CHECK_EQ(v.At(5, 5), 0u);
+    CHECK_EQ(v.At(cell * 3 + 1, cell + 2), 0u);
+    CHECK_EQ(v.At(cell * 2, 0), 0xFF000000u);
+}
+
+TEST_CASE(CompositeHonoursOffsetAndClip) {
+    Surface layerPixels(20, 20);
+    LayerCache layer;
+    layer.Attach(layerPixels.view());
+    ztools::ImageView lv = layer.BeginRebuild(1);
+    ztools::Fill(lv, IntRect(0, 0, 20, 20), 0xFFFF0000u);
+    layer.MarkDrawn(lv.Bounds());
+
+    Surface dst(60, 60);
+    IntRect clip(30, 30, 5, 5);
+    CHECK(layer.CompositeRect(25, 28, clip) == IntRect(30, 30, 5, 5));
+    layer.CompositeOnto(dst.view(), 25, 28, clip);
+    CHECK_EQ(dst.view().At(30, 30), 0xFFFF0000u);
+    CHECK_EQ(dst.view().At(34, 34), 0xFFFF0000u);
+    CHECK_EQ(dst.view().At(35, 34), 0u);   // clip 外
+    CHECK_EQ(dst.view().At(26, 29), 0u);   // 层内但 clip 外
+
+    layer.Invalidate();
+    CHECK(layer.CompositeRect(25, 28, clip).Empty());
+}
+
+TEST_MAIN()
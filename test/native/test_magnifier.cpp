@@ -0,0 +1,157 @@
+// 放大镜：与逐像素的朴素最近邻放大一致（各种 zoom / 奇偶尺寸 / 贴边越界），中心格就是鼠标处像素，
+// 参数不变时不重新分配；取色读数与 snprintf 结果一致，HSL 取值与常见取色器一致
+#include "core/magnifier.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using ztools::ImageView;
+using ztools::PackBgra;
+using ztools::Surface;
+
+namespace {
+
+// 参照实现：输出像素 (x, y) 落在哪个源像素上直接按定义算
+std::uint32_t NaiveSample(const ImageView& src, int cx, int cy, int zoom, int width, int height, std::uint32_t outside,
+                          int x, int y) {
+    auto cellOf = [&](int v, int size) {
+        const int first = size / 2 - zoom / 2;  // 中心块的起点
+        const int d = v - first;
+        return d >= 0 ? d / zoom : -((-d + zoom - 1) / zoom);
+    };
+    const int sx = cx + cellOf(x, width);
+    const int sy = cy + cellOf(y, height);
+    if (sx < 0 || sy < 0 || sx >= src.width || sy >= src.height) return outside;
+    return src.Row(sy)[sx];
+}
+
+int CountMismatches(const ztools::Magnifier& mag, const ImageView& src, int cx, int cy, std::uint32_t outside) {
+    const ImageView out = mag.view();
+    int bad = 0;
+    for (int y = 0; y < out.height; y++) {
+        for (int x = 0; x < out.width; x++) {
+            if (out.Row(y)[x] != NaiveSample(src, cx, cy, mag.zoom(), out.width, out.height, outside, x, y)) bad++;
+        }
+    }
+    return bad;
+}
+
+}  // namespace
+
+TEST_CASE(MatchesNaiveNearestNeighbour) {
+    Surface src(97, 61);
+    std::mt19937 rng(48);
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) src.view().Row(y)[x] = rng();
+    }
+    const std::uint32_t outside = PackBgra(1, 2, 3);
+    const int sizes[][2] = {{136, 72}, {144, 144}, {137, 73}, {5, 5}, {1, 1}, {31, 2}};
+    const int points[][2] = {{48, 30}, {0, 0}, {96, 60}, {-3, 70}, {2, 58}};
+    int mismatches = 0;
+    for (int zoom : {1, 2, 3, 4, 5, 8, 16, 40}) {
+        for (const auto& size : sizes) {
+            ztools::Magnifier mag;
+            mag.Configure(size[0], size[1], zoom);
+            for (const auto& p : points) {
+                mag.Render(src.view(), p[0], p[1], outside);
+                mismatches += CountMismatches(mag, src.view(), p[0], p[1], outside);
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST_CASE(CenterCellIsCursorPixelAndGridCoversOutput) {
+    Surface src(40, 40);
+    ztest::FillScreenLike(src.view(), 48);
+    ztools::Magnifier mag;
+    mag.Configure(144, 144, 16);  // 取色器：9x9 格，每格 16px，正好铺满
+    CHECK_EQ(mag.columns(), 9);
+    CHECK_EQ(mag.rows(), 9);
+    CHECK_EQ(mag.centerColumn(), 4);
+    mag.Render(src.view(), 20, 7, 0);
+    CHECK_EQ(mag.Center(), src.view().Row(7)[20]);
+    CHECK_EQ(mag.Cell(0, 0), src.view().Row(3)[16]);
+    CHECK_EQ(mag.view().Row(72)[72], src.view().Row(7)[20]);
+
+    // 截图信息面板：136x72、zoom 4，中心块包含输出中心
+    mag.Configure(136, 72, 4);
+    mag.Render(src.view(), 0, 39, PackBgra(9, 9, 9));
+    CHECK_EQ(mag.view().Row(36)[68], src.view().Row(39)[0]);
+    CHECK_EQ(mag.view().Row(36)[66], src.view().Row(39)[0]);  // 中心块 [66, 70)
+    CHECK_EQ(mag.view().Row(36)[65], PackBgra(9, 9, 9));  // 左侧越界
+    CHECK_EQ(mag.view().Row(40)[68], PackBgra(9, 9, 9));  // 下方越界
+    CHECK_EQ(mag.columns() * mag.zoom() >= 136, true);
+}
+
+TEST_CASE(ConfigureKeepsBufferWhenUnchanged) {
+    ztools::Magnifier mag;
+    mag.Configure(136, 72, 4);
+    const std::uint8_t* before = mag.view().data;
+    Surface src(8, 8);
+    for (int i = 0; i < 100; i++) {
+        mag.Configure(136, 72, 4);
+        mag.Render(src.view(), i % 8, i % 5, 0);
+    }
+    CHECK(mag.view().data == before);
+    mag.Configure(0, 0, 4);
+    CHECK(mag.view().Empty());
+    mag.Render(src.view(), 1, 1, 0);  // 空输出时什么都不做
+    mag.Configure(3, 3, 2);
+    mag.Render(ImageView(), 0, 0, PackBgra(7, 7, 7));
+    CHECK_EQ(mag.view().Row(2)[2], PackBgra(7, 7, 7));
+}
+
+TEST_CASE(ReadoutMatchesPrintf) {
+    std::mt19937 rng(480);
+    int mismatches = 0;
+    for (int i = 0; i < 2000; i++) {
+        const std::uint32_t px = rng();
+        const int r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+        ztools::ColorReadout readout;
+        ztools::FormatColorReadout(px, readout);
+        char hex[16], rgb[32], hsl[32];
+        std::snprintf(hex, sizeof(hex), "#%02X%02X%02X", r, g, b);
+        std::snprintf(rgb, sizeof(rgb), "%d, %d, %d", r, g, b);
+        const ztools::Hsl h = ztools::RgbToHsl(r, g, b);
+        std::snprintf(hsl, sizeof(hsl), "%d, %d%%, %d%%", h.h, h.s, h.l);
+        if (std::strcmp(hex, readout.hex) != 0 || std::strcmp(rgb, readout.rgb) != 0 ||
+            std::strcmp(hsl, readout.hsl) != 0) {
+            mismatches++;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+
+    char point[24];
+    CHECK_EQ(ztools::FormatPoint(-1920, 1079, point), 11);
+    CHECK(std::strcmp(point, "-1920, 1079") == 0);
+    ztools::FormatPoint(0, -2147483647 - 1, point);
+    CHECK(std::strcmp(point, "0, -2147483648") == 0);
+}
+
+TEST_CASE(HslKnownValues) {
+    auto check = [](int r, int g, int b, int h, int s, int l) {
+        const ztools::Hsl v = ztools::RgbToHsl(r, g, b);
+        return v.h == h && v.s == s && v.l == l;
+    };
+    CHECK(check(255, 0, 0, 0, 100, 50));
+    CHECK(check(0, 255, 0, 120, 100, 50));
+    CHECK(check(0, 0, 255, 240, 100, 50));
+    CHECK(check(128, 128, 128, 0, 0, 50));
+    CHECK(check(255, 255, 255, 0, 0, 100));
+    CHECK(check(0, 0, 0, 0, 0, 0));
+    CHECK(check(0x33, 0x66, 0x99, 210, 50, 40));
+    CHECK(check(255, 0, 1, 0, 100, 50));  // -0.2 度四舍五入后回绕到 0
+
+    ztools::ColorReadout readout;
+    ztools::FormatColorReadout(PackBgra(0x33, 0x66, 0x99), readout);
+    CHECK(std::strcmp(readout.hex, "#336699") == 0);
+    CHECK(std::strcmp(readout.rgb, "51, 102, 153") == 0);
+    CHECK(std::strcmp(readout.hsl, "210, 50%, 40%") == 0);
+}
+
+TEST_MAIN()
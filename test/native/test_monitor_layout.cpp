@@ -0,0 +1,169 @@
+// 多显示器布局：布局取自 xrandr --listmonitors 的输出（与 Xvfb 下用 xrandr --setmonitor 搭出的多屏一致），
+// 外包矩形 / 主显示器、点与矩形归属（含显示器之间的空洞与负坐标）、DPI 换算、截屏覆盖区不重不漏，
+// 以及按显示器数量分组的启动耗时统计
+#include "core/monitor_layout.h"
+#include "test_harness.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using ztools::IntRect;
+using ztools::MonitorDesc;
+using ztools::MonitorLayout;
+
+namespace {
+
+// 解析 xrandr --listmonitors：" 0: +*DP-1 2560/597x1440/336+0+0  DP-1"，
+// DPI 由像素数与物理毫米数算出（水平方向），'*' 为主显示器
+MonitorLayout ParseXrandrMonitors(const std::string& text) {
+    std::vector<MonitorDesc> monitors;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const size_t colon = line.find(": +");
+        if (colon == std::string::npos) continue;
+        std::istringstream fields(line.substr(colon + 3));
+        std::string name, geometry;
+        fields >> name >> geometry;
+        int w = 0, wmm = 0, h = 0, hmm = 0, x = 0, y = 0;
+        char sx = '+', sy = '+';
+        if (std::sscanf(geometry.c_str(), "%d/%dx%d/%d%c%d%c%d", &w, &wmm, &h, &hmm, &sx, &x, &sy, &y) != 8) continue;
+        MonitorDesc m;
+        m.bounds = IntRect(sx == '-' ? -x : x, sy == '-' ? -y : y, w, h);
+        m.dpi = wmm > 0 ? static_cast<int>(std::lround(w * 25.4 / wmm)) : 96;
+        m.primary = !name.empty() && name[0] == '*';
+        monitors.push_back(m);
+    }
+    return MonitorLayout(monitors);
+}
+
+// 4K 笔记本屏在左（负坐标、高 DPI），2K 主屏居中，1080p 副屏在右且下沉 360px：外包矩形里有空洞
+const char* kMixedDpi =
+    "Monitors: 3\n"
+    " 0: +*DP-1 2560/597x1440/336+0+0  DP-1\n"
+    " 1: +HDMI-1 1920/527x1080/296+2560+360  HDMI-1\n"
+    " 2: +eDP-1 3840/344x2160/194-3840+0  eDP-1\n";
+
+long long Area(const IntRect& r) { return static_cast<long long>(r.w) * r.h; }
+
+}  // namespace
+
+TEST_CASE(ParsesXrandrLayout) {
+    const MonitorLayout layout = ParseXrandrMonitors(kMixedDpi);
+    CHECK_EQ(layout.count(), 3);
+    CHECK(layout.Bounds() == IntRect::FromLTRB(-3840, 0, 4480, 2160));
+    CHECK_EQ(layout.Primary(), 0);
+    CHECK_EQ(layout[0].dpi, 109);
+    CHECK_EQ(layout[1].dpi, 93);
+    CHECK_EQ(layout[2].dpi, 284);
+    CHECK(!layout.UniformDpi());
+
+    const MonitorLayout single = ParseXrandrMonitors("Monitors: 1\n 0: +*screen 1920/508x1080/286+0+0  screen\n");
+    CHECK_EQ(single.count(), 1);
+    CHECK(single.UniformDpi());
+    CHECK(single.Bounds() == IntRect(0, 0, 1920, 1080));
+
+    // 空矩形丢弃、非法 DPI 视为 96、无主显示器标记时取第一个
+    MonitorDesc bad;
+    bad.bounds = IntRect(0, 0, 0, 100);
+    MonitorDesc zeroDpi;
+    zeroDpi.bounds = IntRect(10, 10, 100, 100);
+    zeroDpi.dpi = 0;
+    const MonitorLayout cleaned({bad, zeroDpi});
+    CHECK_EQ(cleaned.count(), 1);
+    CHECK_EQ(cleaned[0].dpi, 96);
+    CHECK_EQ(cleaned.Primary(), 0);
+    CHECK_EQ(MonitorLayout().Primary(), -1);
+}
+
+TEST_CASE(PointAndRectOwnershipFollowNearestMonitor) {
+    const MonitorLayout layout = ParseXrandrMonitors(kMixedDpi);
+    CHECK_EQ(layout.IndexAt(0, 0), 0);
+    CHECK_EQ(layout.IndexAt(-1, 0), 2);          // 负坐标的左屏
+    CHECK_EQ(layout.IndexAt(2559, 1439), 0);
+    CHECK_EQ(layout.IndexAt(2560, 360), 1);
+    CHECK_EQ(layout.IndexAt(3000, 100), 1);      // 右屏上方的空洞：离右屏 260px、离主屏 441px
+    CHECK_EQ(layout.IndexAt(2600, 100), 0);      // 同一空洞靠左：离主屏 41px
+    CHECK_EQ(layout.IndexAt(100000, -5), 1);
+    CHECK_EQ(layout.DpiAt(-100, 2000), 284);
+    CHECK_EQ(layout.DpiAt(4000, 2000), 93);
+    CHECK_EQ(MonitorLayout().IndexAt(0, 0), -1);
+    CHECK_EQ(MonitorLayout().DpiAt(0, 0), 96);
+
+    // 跨两屏的选区归面积大的一侧；不与任何显示器相交时归最近的
+    CHECK_EQ(layout.IndexForRect(IntRect(2400, 400, 400, 200)), 1);
+    CHECK_EQ(layout.IndexForRect(IntRect(2200, 400, 400, 200)), 0);
+    CHECK_EQ(layout.IndexForRect(IntRect(-200, 100, 300, 100)), 2);
+    CHECK_EQ(layout.IndexForRect(IntRect(2700, 0, 100, 100)), 0);   // 空洞里：离主屏 140px、离右屏 260px
+    CHECK_EQ(layout.IndexForRect(IntRect(3000, 0, 100, 100)), 1);
+    CHECK_EQ(layout.IndexForRect(IntRect(2600, 1500, 10, 10)), 1);
+}
+
+TEST_CASE(CoverageSkipsHolesAndCountsOverlapOnce) {
+    const MonitorLayout layout = ParseXrandrMonitors(kMixedDpi);
+    std::vector<IntRect> rects;
+    layout.Coverage(layout.Bounds(), rects);
+    long long total = 0;
+    for (size_t i = 0; i < rects.size(); i++) {
+        total += Area(rects[i]);
+        for (size_t j = i + 1; j < rects.size(); j++) CHECK(rects[i].Intersect(rects[j]).Empty());
+    }
+    const long long expected = 2560LL * 1440 + 1920LL * 1080 + 3840LL * 2160;
+    CHECK_EQ(total, expected);
+    CHECK_EQ(layout.CoveredArea(layout.Bounds()), expected);
+    CHECK(total < Area(layout.Bounds()));
+
+    // 只截一部分：裁到请求矩形
+    CHECK_EQ(layout.CoveredArea(IntRect(2000, 0, 1000, 500)), 560LL * 500 + 440LL * 140);
+
+    // 克隆 / 部分重叠的显示器只算一次，且追加不影响 out 里已有的内容
+    std::vector<MonitorDesc> overlapping(2);
+    overlapping[0].bounds = IntRect(0, 0, 1920, 1080);
+    overlapping[1].bounds = IntRect(960, 540, 1920, 1080);
+    const MonitorLayout clone(overlapping);
+    std::vector<IntRect> out(1, IntRect(0, 0, 5, 5));
+    clone.Coverage(clone.Bounds(), out);
+    long long area = 0;
+    for (size_t i = 1; i < out.size(); i++) {
+        area += Area(out[i]);
+        for (size_t j = i + 1; j < out.size(); j++) CHECK(out[i].Intersect(out[j]).Empty());
+    }
+    CHECK_EQ(area, 2 * 1920LL * 1080 - 960LL * 540);
+    CHECK(out[0] == IntRect(0, 0, 5, 5));
+}
+
+TEST_CASE(ScaleForDpiRoundsLikeWindows) {
+    CHECK_EQ(ztools::ScaleForDpi(140, 96), 140);
+    CHECK_EQ(ztools::ScaleForDpi(140, 144), 210);
+    CHECK_EQ(ztools::ScaleForDpi(74, 120), 93);   // 92.5 向上取整
+    CHECK_EQ(ztools::ScaleForDpi(15, 168), 26);   // 26.25
+    CHECK_EQ(ztools::ScaleForDpi(-15, 168), -26);
+    const MonitorLayout layout = ParseXrandrMonitors(kMixedDpi);
+    CHECK_EQ(ztools::ScaleForDpi(140, layout.DpiAt(-10, 10)), 414);
+}
+
+TEST_CASE(CaptureStartMeterGroupsByMonitorCount) {
+    using std::chrono::milliseconds;
+    ztools::CaptureStartMeter meter;
+    meter.Record(3, milliseconds(60));
+    meter.Record(1, milliseconds(20));
+    meter.Record(3, milliseconds(40));
+    meter.Record(2, milliseconds(30));
+    meter.Record(1, milliseconds(10));
+    CHECK_EQ(meter.buckets().size(), static_cast<size_t>(3));
+    CHECK_EQ(meter.buckets()[0].monitors, 1);
+    CHECK_EQ(meter.buckets()[1].monitors, 2);
+    CHECK_EQ(meter.buckets()[2].monitors, 3);
+    CHECK_EQ(meter.buckets()[0].count, 2);
+    CHECK(meter.buckets()[0].last == milliseconds(10));
+    CHECK(meter.buckets()[0].max == milliseconds(20));
+    CHECK(meter.buckets()[2].Average() == milliseconds(50));
+    meter.Reset();
+    CHECK(meter.buckets().empty());
+}
+
+TEST_MAIN()
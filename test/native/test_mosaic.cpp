@@ -0,0 +1,141 @@
+// 马赛克内核测试：SIMD / 多线程版本与瓦片缓存都必须与参考实现 Mosaic() 逐像素一致
+#include "core/mosaic.h"
+#include "core/mosaic_tiles.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+using ztools::IntRect;
+using ztools::Surface;
+
+namespace {
+
+// 分别用参考实现与内核在同一张（预先填充过的）目标图上绘制，比较整图哈希
+bool MatchesReference(int physW, int physH, double scale, int dstW, int dstH, const IntRect& rect, int blockPx,
+                      int threads) {
+    Surface phys(physW, physH);
+    ztest::FillScreenLike(phys.view(), static_cast<std::uint32_t>(physW * 31 + blockPx));
+    Surface expect(dstW, dstH), actual(dstW, dstH);
+    ztest::FillScreenLike(expect.view(), 3);
+    ztest::FillScreenLike(actual.view(), 3);
+    ztools::Mosaic(phys.view(), scale, expect.view(), rect, blockPx);
+    ztools::MosaicParallel(phys.view(), scale, actual.view(), rect, blockPx, threads);
+    return ztest::ViewHash(expect.view()) == ztest::ViewHash(actual.view());
+}
+
+}  // namespace
+
+TEST_CASE(MatchesReferenceAcrossScalesAndBlocks) {
+    for (double scale : {1.0, 1.25, 1.5, 1.75, 2.0}) {
+        for (int block : {1, 2, 6, 10, 16, 33}) {
+            int dstW = 203, dstH = 117;
+            int physW = ztools::ScaleCoord(dstW, scale), physH = ztools::ScaleCoord(dstH, scale);
+            CHECK(MatchesReference(physW, physH, scale, dstW, dstH, IntRect(0, 0, dstW, dstH), block, 1));
+        }
+    }
+}
+
+TEST_CASE(MatchesReferenceOnSubRectsAndThreads) {
+    CHECK(MatchesReference(301, 187, 1.5, 201, 125, IntRect(17, 9, 120, 77), 10, 1));
+    CHECK(MatchesReference(301, 187, 1.5, 201, 125, IntRect(17, 9, 120, 77), 10, 4));
+    CHECK(MatchesReference(301, 187, 1.5, 201, 125, IntRect(-30, -30, 500, 500), 6, 3));
+    CHECK(MatchesReference(301, 187, 1.5, 201, 125, IntRect(199, 123, 5, 5), 16, 2));
+    CHECK(MatchesReference(640, 480, 1.25, 512, 384, IntRect(0, 0, 512, 384), 6, 0));
+}
+
+TEST_CASE(SourceSmallerThanDestinationFallsBackToEdgePixel) {
+    // src 没能覆盖整个 dst（例如物理尺寸被截断）：越界块取最近的单个像素
+    CHECK(MatchesReference(100, 60, 1.5, 120, 80, IntRect(0, 0, 120, 80), 10, 2));
+    CHECK(MatchesReference(40, 30, 1.0, 64, 64, IntRect(0, 0, 64, 64), 8, 1));
+}
+
+TEST_CASE(TallBandsUse32BitColumnSums) {
+    // 块在物理像素上高于 257 行时列和会溢出 16 位
+    CHECK(MatchesReference(400, 600, 2.0, 200, 300, IntRect(0, 0, 200, 300), 150, 2));
+    Surface white(300, 300);
+    ztools::Fill(white.view(), white.view().Bounds(), 0xFFFFFFFFu);
+    Surface dst(300, 300);
+    ztools::MosaicParallel(white.view(), 1.0, dst.view(), dst.view().Bounds(), 300, 1);
+    CHECK_EQ(dst.view().At(150, 150), 0xFFFFFFFFu);
+}
+
+TEST_CASE(GoldenHash) {
+    Surface phys(301, 187);
+    ztest::FillScreenLike(phys.view(), 42);
+    Surface mosaic(201, 125);
+    ztools::MosaicParallel(phys.view(), 1.5, mosaic.view(), mosaic.view().Bounds(), 10);
+    CHECK_EQ(ztest::ViewHash(mosaic.view()), 0xd82510a0bb02c44dull);
+}
+
+TEST_CASE(MosaicIntoWritesWindowOfCanvas) {
+    // dst 只是画布的一个窗口：结果等于整画布计算后取同一窗口
+    Surface phys(301, 187);
+    ztest::FillScreenLike(phys.view(), 7);
+    Surface whole(201, 125);
+    ztools::Mosaic(phys.view(), 1.5, whole.view(), whole.view().Bounds(), 10);
+    Surface window(64, 48);
+    ztools::MosaicInto(phys.view(), 1.5, 201, 125, IntRect(0, 0, 201, 125), window.view(), 150, 90, 10, 2);
+    bool same = true;
+    for (int y = 0; y < 35; y++)
+        for (int x = 0; x < 51; x++) same &= window.view().At(x, y) == whole.view().At(150 + x, 90 + y);
+    CHECK(same);
+}
+
+TEST_CASE(TileCacheMatchesFullFrame) {
+    const int w = 700, h = 530;
+    Surface phys(ztools::ScaleCoord(w, 1.25), ztools::ScaleCoord(h, 1.25));
+    ztest::FillScreenLike(phys.view(), 11);
+    Surface whole(w, h);
+    ztools::Mosaic(phys.view(), 1.25, whole.view(), whole.view().Bounds(), 6);
+
+    ztools::MosaicTileCache cache;
+    cache.Reset(phys.view(), 1.25, w, h);
+    CHECK_EQ(cache.Ensure(6, IntRect(0, 0, w, h), 3), 9);
+    Surface assembled(w, h);
+    cache.ForEachTile(6, IntRect(0, 0, w, h), [&](const IntRect& r, const ztools::ImageView& tile) {
+        ztools::Copy(tile, 0, 0, assembled.view(), r);
+    });
+    CHECK_EQ(ztest::ViewHash(assembled.view()), ztest::ViewHash(whole.view()));
+}
+
+TEST_CASE(TileCacheIsSparseAndKeepsLayersPerBlockSize) {
+    Surface phys(1500, 900);
+    ztest::FillScreenLike(phys.view(), 4);
+    ztools::MosaicTileCache cache;
+    cache.Reset(phys.view(), 1.5, 1000, 600);
+
+    // 一次小范围涂抹只计算覆盖到的瓦片（跨越 256 边界 → 2x1）
+    CHECK_EQ(cache.Ensure(10, IntRect(240, 20, 40, 30)), 2);
+    CHECK_EQ(cache.TileCount(), 2u);
+    CHECK_EQ(cache.Ensure(10, IntRect(250, 30, 10, 10)), 0);
+
+    // 切换块大小建新层，切回时不重算
+    CHECK_EQ(cache.Ensure(16, IntRect(240, 20, 40, 30)), 2);
+    CHECK_EQ(cache.Ensure(10, IntRect(240, 20, 40, 30)), 0);
+    CHECK_EQ(cache.TileCount(), 4u);
+    CHECK_EQ(cache.ByteSize(), 4u * 256 * 256 * 4);
+
+    int visited = 0;
+    cache.ForEachTile(16, IntRect(0, 0, 1000, 600), [&](const IntRect&, const ztools::ImageView&) { visited++; });
+    CHECK_EQ(visited, 2);
+
+    // 画布外的请求与 Reset 后的状态
+    CHECK_EQ(cache.Ensure(10, IntRect(2000, 2000, 10, 10)), 0);
+    cache.Reset(phys.view(), 1.5, 1000, 600);
+    CHECK_EQ(cache.TileCount(), 0u);
+}
+
+TEST_CASE(TileCacheEdgeTilesAreClipped) {
+    Surface phys(300, 300);
+    ztest::FillScreenLike(phys.view(), 8);
+    ztools::MosaicTileCache cache;
+    cache.Reset(phys.view(), 1.0, 300, 300);
+    cache.Ensure(16, IntRect(290, 290, 100, 100));
+    cache.ForEachTile(16, IntRect(290, 290, 100, 100), [&](const IntRect& r, const ztools::ImageView& tile) {
+        CHECK(r == IntRect(256, 256, 44, 44));
+        CHECK_EQ(tile.width, 44);
+        // 最后一块（288..300）按画布边界裁剪后整块平均
+        CHECK_EQ(tile.At(40, 40), ztools::AverageColor(phys.view(), IntRect(288, 288, 12, 12)));
+    });
+}
+
+TEST_MAIN()
@@ -0,0 +1,254 @@
+// 光栅核心测试：裁剪语义、逐像素结果与固定图案上的回归哈希
+#include "core/raster.h"
+#include "raster_fixtures.h"
+#include "test_harness.h"
+
+#include <algorithm>
+
+using ztools::ImageView;
+using ztools::IntRect;
+using ztools::PackBgra;
+using ztools::ScaleFilter;
+using ztools::Surface;
+
+namespace {
+
+const std::uint32_t kRed = PackBgra(255, 0, 0);
+const std::uint32_t kBlue = PackBgra(0, 0, 255);
+
+}  // namespace
+
+TEST_CASE(RectIntersectAndUnion) {
+    IntRect a(0, 0, 10, 10);
+    IntRect b(5, 6, 10, 10);
+    CHECK(a.Intersect(b) == IntRect(5, 6, 5, 4));
+    CHECK(a.Intersect(IntRect(10, 0, 5, 5)).Empty());
+    CHECK(a.Union(b) == IntRect(0, 0, 15, 16));
+    CHECK(a.Union(IntRect()) == a);
+    CHECK(ztools::ScaleRect(IntRect(3, 5, 7, 9), 1.5) == IntRect(5, 8, 11, 14));
+}
+
+TEST_CASE(Div255RoundsExactly) {
+    // 两个 8 位量的乘积再加一个同范围的乘积也不超过 65535：全范围与 round(v / 255) 一致
+    int mismatches = 0;
+    for (std::uint32_t v = 0; v <= 65535; v++) {
+        if (ztools::Div255(v) != (v * 2 + 255) / 510) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(ztools::ClampInt(-3, 0, 9), 0);
+    CHECK_EQ(ztools::ClampInt(12, 0, 9), 9);
+}
+
+TEST_CASE(FillAndCopyClipToBounds) {
+    Surface s(8, 8);
+    ztools::Fill(s.view(), IntRect(-2, -2, 4, 4), kRed);
+    CHECK_EQ(s.view().At(0, 0), kRed);
+    CHECK_EQ(s.view().At(1, 1), kRed);
+    CHECK_EQ(s.view().At(2, 2), 0u);
+
+    Surface d(4, 4);
+    ztools::Copy(s.view(), 0, 0, d.view(), IntRect(2, 2, 10, 10));
+    CHECK_EQ(d.view().At(2, 2), kRed);
+    CHECK_EQ(d.view().At(3, 3), kRed);
+    CHECK_EQ(d.view().At(1, 1), 0u);
+
+    // 源起点为负：只拷贝源内部分
+    Surface e(4, 4);
+    ztools::Fill(e.view(), e.view().Bounds(), kBlue);
+    ztools::Copy(s.view(), -1, -1, e.view(), IntRect(0, 0, 4, 4));
+    CHECK_EQ(e.view().At(0, 0), kBlue);
+    CHECK_EQ(e.view().At(1, 1), kRed);
+}
+
+TEST_CASE(SubViewSharesPixels) {
+    Surface s(6, 6);
+    ImageView sub = s.view().Sub(IntRect(2, 3, 10, 10));
+    CHECK_EQ(sub.width, 4);
+    CHECK_EQ(sub.height, 3);
+    ztools::Fill(sub, sub.Bounds(), kRed);
+    CHECK_EQ(s.view().At(2, 3), kRed);
+    CHECK_EQ(s.view().At(5, 5), kRed);
+    CHECK_EQ(s.view().At(1, 3), 0u);
+}
+
+TEST_CASE(NearestUpscaleReplicatesPixels) {
+    Surface src(2, 2);
+    src.view().At(0, 0) = 1;
+    src.view().At(1, 0) = 2;
+    src.view().At(0, 1) = 3;
+    src.view().At(1, 1) = 4;
+    Surface dst(8, 8);
+    ztools::Scale(src.view(), src.view().Bounds(), dst.view(), dst.view().Bounds(), ScaleFilter::Nearest);
+    CHECK_EQ(dst.view().At(0, 0), 1u);
+    CHECK_EQ(dst.view().At(3, 3), 1u);
+    CHECK_EQ(dst.view().At(4, 3), 2u);
+    CHECK_EQ(dst.view().At(3, 4), 3u);
+    CHECK_EQ(dst.view().At(7, 7), 4u);
+}
+
+TEST_CASE(BoxDownscaleAveragesExactly) {
+    Surface src(4, 2);
+    // 每个 2x2 块：0/100/200/100 -> 平均 100
+    std::uint8_t v[2][4] = {{0, 100, 10, 30}, {200, 100, 50, 70}};
+    for (int y = 0; y < 2; y++)
+        for (int x = 0; x < 4; x++) src.view().At(x, y) = PackBgra(v[y][x], v[y][x], v[y][x], 255);
+    Surface dst(2, 1);
+    ztools::Scale(src.view(), src.view().Bounds(), dst.view(), dst.view().Bounds(), ScaleFilter::Box);
+    CHECK_EQ(dst.view().At(0, 0), PackBgra(100, 100, 100, 255));
+    CHECK_EQ(dst.view().At(1, 0), PackBgra(40, 40, 40, 255));
+}
+
+TEST_CASE(BoxFractionalScaleKeepsThinLines) {
+    // 1.5x DPI：1px 黑线在缩小后仍然可见（最近邻会整条丢掉）
+    Surface src(30, 30);
+    ztools::Fill(src.view(), src.view().Bounds(), PackBgra(255, 255, 255));
+    ztools::Fill(src.view(), IntRect(0, 9, 30, 1), PackBgra(0, 0, 0));
+    Surface dst(20, 20);
+    ztools::Scale(src.view(), src.view().Bounds(), dst.view(), dst.view().Bounds(), ScaleFilter::Box);
+    int darkest = 255;
+    for (int y = 0; y < 20; y++) darkest = (std::min)(darkest, (int)ztest::Channel(dst.view().At(5, y), 0));
+    CHECK(darkest < 128);
+}
+
+TEST_CASE(ScaleSameSizeIsCopy) {
+    Surface src(16, 16);
+    ztest::FillScreenLike(src.view(), 7);
+    for (ScaleFilter f : {ScaleFilter::Nearest, ScaleFilter::Bilinear, ScaleFilter::Box}) {
+        Surface dst(16, 16);
+        ztools::Scale(src.view(), src.view().Bounds(), dst.view(), dst.view().Bounds(), f);
+        CHECK_EQ(ztest::ViewHash(dst.view()), ztest::ViewHash(src.view()));
+    }
+}
+
+TEST_CASE(BilinearMidpointBlends) {
+    Surface src(2, 1);
+    src.view().At(0, 0) = PackBgra(0, 0, 0, 0);
+    src.view().At(1, 0) = PackBgra(200, 100, 50, 255);
+    Surface dst(4, 1);
+    ztools::Scale(src.view(), src.view().Bounds(), dst.view(), dst.view().Bounds(), ScaleFilter::Bilinear);
+    CHECK_EQ(dst.view().At(0, 0), PackBgra(0, 0, 0, 0));
+    CHECK_EQ(dst.view().At(3, 0), PackBgra(200, 100, 50, 255));
+    CHECK_EQ(ztest::Channel(dst.view().At(1, 0), 2), (std::uint8_t)50);  // 1/4 处
+    CHECK_EQ(ztest::Channel(dst.view().At(2, 0), 2), (std::uint8_t)150);
+}
+
+TEST_CASE(CopyFromPhysicalMapsLogicalRect) {
+    Surface phys(30, 30);
+    ztest::FillScreenLike(phys.view(), 3);
+    Surface logical(20, 20);
+    ztools::CopyFromPhysical(phys.view(), 1.5, logical.view(), IntRect(4, 4, 8, 8));
+    Surface expect(8, 8);
+    ztools::Scale(phys.view(), IntRect(6, 6, 12, 12), expect.view(), expect.view().Bounds(), ScaleFilter::Box);
+    bool same = true;
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++) same &= logical.view().At(4 + x, 4 + y) == expect.view().At(x, y);
+    CHECK(same);
+    CHECK_EQ(logical.view().At(3, 3), 0u);
+
+    // 100% 缩放是逐字节拷贝
+    Surface unit(30, 30);
+    ztools::CopyFromPhysical(phys.view(), 1.0, unit.view(), unit.view().Bounds());
+    CHECK_EQ(ztest::ViewHash(unit.view()), ztest::ViewHash(phys.view()));
+}
+
+TEST_CASE(BlendSolidMatchesConstantAlphaFormula) {
+    Surface s(2, 1);
+    s.view().At(0, 0) = PackBgra(255, 255, 255, 0);
+    s.view().At(1, 0) = PackBgra(10, 20, 30, 0);
+    ztools::BlendSolid(s.view(), s.view().Bounds(), PackBgra(0, 0, 0, 0), 120);
+    // 255 * 135 / 255 = 135；10 * 135 / 255 = 5.29 -> 5
+    CHECK_EQ(s.view().At(0, 0), PackBgra(135, 135, 135, 0));
+    CHECK_EQ(s.view().At(1, 0), PackBgra(5, 11, 16, 0));
+}
+
+TEST_CASE(BlendSolidOutsideLeavesSelectionUntouched) {
+    Surface s(10, 10);
+    ztools::Fill(s.view(), s.view().Bounds(), PackBgra(200, 200, 200));
+    ztools::BlendSolidOutside(s.view(), IntRect(3, 3, 4, 4), PackBgra(0, 0, 0), 128);
+    int dimmed = 0, kept = 0;
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            if (s.view().At(x, y) == PackBgra(200, 200, 200)) kept++;
+            else if (s.view().At(x, y) == PackBgra(100, 100, 100)) dimmed++;
+        }
+    }
+    CHECK_EQ(kept, 16);
+    CHECK_EQ(dimmed, 84);  // 每个像素只混合一次
+}
+
+TEST_CASE(BlendOverPremultiplied) {
+    Surface src(3, 1);
+    src.view().At(0, 0) = PackBgra(0, 0, 0, 0);          // 全透明：不变
+    src.view().At(1, 0) = PackBgra(100, 50, 0, 128);     // 半透明预乘
+    src.view().At(2, 0) = PackBgra(10, 20, 30, 255);     // 不透明：覆盖
+    Surface dst(3, 1);
+    ztools::Fill(dst.view(), dst.view().Bounds(), PackBgra(200, 200, 200, 255));
+    ztools::BlendOver(src.view(), 0, 0, dst.view(), dst.view().Bounds());
+    CHECK_EQ(dst.view().At(0, 0), PackBgra(200, 200, 200, 255));
+    CHECK_EQ(dst.view().At(1, 0), PackBgra(200, 150, 100, 255));
+    CHECK_EQ(dst.view().At(2, 0), PackBgra(10, 20, 30, 255));
+}
+
+TEST_CASE(MosaicBlocksAreUniformAverages) {
+    Surface src(12, 12);
+    ztest::FillScreenLike(src.view(), 5);
+    Surface dst(12, 12);
+    ztools::Mosaic(src.view(), 1.0, dst.view(), dst.view().Bounds(), 4);
+    for (int by = 0; by < 12; by += 4) {
+        for (int bx = 0; bx < 12; bx += 4) {
+            std::uint32_t expect = ztools::AverageColor(src.view(), IntRect(bx, by, 4, 4));
+            bool uniform = true;
+            for (int y = by; y < by + 4; y++)
+                for (int x = bx; x < bx + 4; x++) uniform &= dst.view().At(x, y) == expect;
+            CHECK(uniform);
+        }
+    }
+}
+
+TEST_CASE(MosaicIsIndependentOfRectSplit) {
+    // 分区域多次调用与整屏一次调用逐像素一致（块永远按整块取平均、网格锚定在原点）
+    Surface phys(150, 120);
+    ztest::FillScreenLike(phys.view(), 9);
+    Surface whole(100, 80), parts(100, 80);
+    ztools::Mosaic(phys.view(), 1.5, whole.view(), whole.view().Bounds(), 6);
+    ztools::Mosaic(phys.view(), 1.5, parts.view(), IntRect(0, 0, 37, 80), 6);
+    ztools::Mosaic(phys.view(), 1.5, parts.view(), IntRect(37, 0, 63, 41), 6);
+    ztools::Mosaic(phys.view(), 1.5, parts.view(), IntRect(37, 41, 63, 39), 6);
+    CHECK_EQ(ztest::ViewHash(parts.view()), ztest::ViewHash(whole.view()));
+}
+
+TEST_CASE(MosaicOnlyWritesInsideRect) {
+    Surface src(20, 20);
+    ztest::FillScreenLike(src.view(), 2);
+    Surface dst(20, 20);
+    ztools::Mosaic(src.view(), 1.0, dst.view(), IntRect(5, 5, 3, 3), 10);
+    CHECK_EQ(dst.view().At(4, 4), 0u);
+    CHECK_EQ(dst.view().At(8, 8), 0u);
+    CHECK_EQ(dst.view().At(5, 5), ztools::AverageColor(src.view(), IntRect(0, 0, 10, 10)));
+}
+
+// 固定图案上的回归哈希：任何优化（SIMD / 多线程 / 分块）都必须保持逐像素一致
+TEST_CASE(GoldenHashes) {
+    Surface phys(301, 187);
+    ztest::FillScreenLike(phys.view(), 42);
+
+    Surface box(201, 125);
+    ztools::Scale(phys.view(), phys.view().Bounds(), box.view(), box.view().Bounds(), ScaleFilter::Box);
+    Surface bilinear(400, 250);
+    ztools::Scale(phys.view(), phys.view().Bounds(), bilinear.view(), bilinear.view().Bounds(), ScaleFilter::Bilinear);
+    Surface nearest(97, 61);
+    ztools::Scale(phys.view(), IntRect(13, 7, 40, 25), nearest.view(), nearest.view().Bounds(), ScaleFilter::Nearest);
+    Surface mosaic(201, 125);
+    ztools::Mosaic(phys.view(), 1.5, mosaic.view(), mosaic.view().Bounds(), 10);
+    Surface dim(301, 187);
+    ztools::Copy(phys.view(), 0, 0, dim.view(), dim.view().Bounds());
+    ztools::BlendSolidOutside(dim.view(), IntRect(40, 30, 100, 80), PackBgra(0, 0, 0), 120);
+
+    CHECK_EQ(ztest::ViewHash(box.view()), 0xdd9cd7e906ee0cd9ull);
+    CHECK_EQ(ztest::ViewHash(bilinear.view()), 0x584809a7a244abcaull);
+    CHECK_EQ(ztest::ViewHash(nearest.view()), 0xfd2c5f4fe25e306bull);
+    CHECK_EQ(ztest::ViewHash(mosaic.view()), 0xd82510a0bb02c44dull);
+    CHECK_EQ(ztest::ViewHash(dim.view()), 0xab5314d56e82b1ccull);
+}
+
+TEST_MAIN()
@@ -0,0 +1,339 @@
+// 滚动长截图：行签名忽略滚动条列、偏移匹配（固定表头 / 表尾、到底不动、等距重复内容没有锚点、滚动过头、按需哈希本帧），
+// 逐帧拼接结果与原页面逐行一致、瓦片增删跨块边界、高度上限、空白页滚动不误判为到底，以及滚轮步长自适应
+#include "core/scroll_stitch.h"
+#include "test_harness.h"
+#include "scroll_fixtures.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using ztools::ImageView;
+using ztools::ScrollMatch;
+using ztools::ScrollMatcher;
+using ztools::ScrollStitcher;
+using ztools::StitchStatus;
+using ztools::Surface;
+using ztools::TiledImage;
+
+namespace {
+
+const ztest::ScrollFrameLayout kLayout = {48, 32, 12};
+
+std::vector<std::uint64_t> Hashes(const ImageView& frame, int right = kLayout.scrollbar) {
+    std::vector<std::uint64_t> out;
+    ztools::HashRows(frame, 0, right, out);
+    return out;
+}
+
+bool SameRow(const std::uint32_t* a, const std::uint32_t* b, int width) {
+    return std::memcmp(a, b, static_cast<size_t>(width) * 4) == 0;
+}
+
+}  // namespace
+
+TEST_CASE(RowHashesIgnoreScrollbarColumns) {
+    Surface page(400, 600);
+    ztest::FillDocumentLike(page.view());
+    Surface a(400, 200), b(400, 200);
+    ztest::ComposeScrollFrame(page.view(), 0, kLayout, a.view());
+    ztest::ComposeScrollFrame(page.view(), 0, kLayout, b.view());
+    b.view().At(399, 100) ^= 0xFFu;  // 滚动条列的变化不影响签名
+
+    const std::vector<std::uint64_t> ha = Hashes(a.view()), hb = Hashes(b.view());
+    CHECK_EQ(ha.size(), static_cast<size_t>(200));
+    CHECK(ha == hb);
+    CHECK(Hashes(a.view(), 0)[100] != Hashes(b.view(), 0)[100]);
+
+    // 忽略列数不小于宽度时整行参与；空帧没有签名
+    CHECK(Hashes(a.view(), 400) == Hashes(a.view(), 0));
+    std::vector<std::uint64_t> out(3);
+    ztools::HashRows(ImageView(), 0, 0, out);
+    CHECK(out.empty());
+}
+
+TEST_CASE(MatcherFindsOffsetAcrossFixedHeaderAndFooter) {
+    Surface page(640, 4000);
+    ztest::FillDocumentLike(page.view(), 3);
+    Surface prev(640, 480), cur(640, 480);
+    ScrollMatcher matcher;
+
+    for (int offset : {1, 57, 120, 240, 360}) {
+        ztest::ComposeScrollFrame(page.view(), 500, kLayout, prev.view());
+        ztest::ComposeScrollFrame(page.view(), 500 + offset, kLayout, cur.view());
+        const ScrollMatch m = matcher.Match(Hashes(prev.view()), Hashes(cur.view()));
+        CHECK(m.found);
+        CHECK_EQ(m.offset, offset);
+        CHECK(m.top >= kLayout.header);
+        CHECK(m.bottom >= kLayout.footer);
+        CHECK_EQ(m.matched, m.overlap);
+    }
+
+    // 画面没动（已到底）：offset 为 0
+    ztest::ComposeScrollFrame(page.view(), 500, kLayout, cur.view());
+    const ScrollMatch still = matcher.Match(Hashes(prev.view()), Hashes(cur.view()));
+    CHECK(still.found);
+    CHECK_EQ(still.offset, 0);
+
+    // 滚动超过一屏：没有重叠
+    ztest::ComposeScrollFrame(page.view(), 500 + 420, kLayout, cur.view());
+    CHECK(!matcher.Match(Hashes(prev.view()), Hashes(cur.view())).found);
+
+    // 向上滚动不识别
+    ztest::ComposeScrollFrame(page.view(), 400, kLayout, cur.view());
+    CHECK(!matcher.Match(Hashes(prev.view()), Hashes(cur.view())).found);
+
+    // 行数不同
+    Surface shorter(640, 300);
+    ztest::ComposeScrollFrame(page.view(), 500, kLayout, shorter.view());
+    CHECK(!matcher.Match(Hashes(prev.view()), Hashes(shorter.view())).found);
+}
+
+TEST_CASE(MatcherRejectsAmbiguousAndToleratesLocalRedraw) {
+    // 等距重复的横线（表格、信纸）：每行在上一帧都出现多次，没有唯一的锚点行，不猜偏移
+    Surface ruled(300, 3000);
+    ztools::Fill(ruled.view(), ruled.view().Bounds(), ztest::kPageBackground);
+    for (int y = 0; y < ruled.height(); y += 24) ztools::Fill(ruled.view(), ztools::IntRect(0, y, 300, 2), 0x00303030u);
+    Surface prev(300, 300), cur(300, 300);
+    ztest::ComposeScrollFrame(ruled.view(), 100, kLayout, prev.view());
+    ztest::ComposeScrollFrame(ruled.view(), 180, kLayout, cur.view());
+    ScrollMatcher matcher;
+    const ScrollMatch ambiguous = matcher.Match(Hashes(prev.view()), Hashes(cur.view()));
+    CHECK(!ambiguous.found);
+    CHECK(ambiguous.top >= kLayout.header);
+
+    // 整页空白时除滚动条外两帧完全相同，只能视为没有滚动
+    Surface blank(300, 3000);
+    ztools::Fill(blank.view(), blank.view().Bounds(), ztest::kPageBackground);
+    ztest::ComposeScrollFrame(blank.view(), 100, kLayout, prev.view());
+    ztest::ComposeScrollFrame(blank.view(), 180, kLayout, cur.view());
+    const ScrollMatch still = matcher.Match(Hashes(prev.view()), Hashes(cur.view()));
+    CHECK(still.found);
+    CHECK_EQ(still.offset, 0);
+
+    // 鼠标悬停高亮只改了几行：仍按多数行匹配
+    Surface page(300, 3000);
+    ztest::FillDocumentLike(page.view(), 9);
+    ztest::ComposeScrollFrame(page.view(), 100, kLayout, prev.view());
+    ztest::ComposeScrollFrame(page.view(), 180, kLayout, cur.view());
+    for (int y = 120; y < 126; y++) cur.view().At(150, y) ^= 0x00101010u;
+    const ScrollMatch m = matcher.Match(Hashes(prev.view()), Hashes(cur.view()));
+    CHECK(m.found);
+    CHECK_EQ(m.offset, 80);
+    CHECK_EQ(m.overlap - m.matched, 6);
+
+    // 要求完全一致时拒绝
+    ztools::ScrollMatchOptions strict;
+    strict.minMatchRatio = 1.0;
+    ScrollMatcher exact(strict);
+    CHECK(!exact.Match(Hashes(prev.view()), Hashes(cur.view())).found);
+}
+
+TEST_CASE(FrameMatcherHashesOnDemandAndCompletesSignatures) {
+    Surface page(640, 4000);
+    ztest::FillDocumentLike(page.view(), 5);
+    Surface prev(640, 480), cur(640, 480);
+    ScrollMatcher matcher;
+    std::vector<std::uint64_t> hashes;
+
+    // 找到偏移后补全的签名与整帧 HashRows 一致，可直接作下一帧的比对基准
+    for (int offset : {1, 90, 200, 360}) {
+        ztest::ComposeScrollFrame(page.view(), 700, kLayout, prev.view());
+        ztest::ComposeScrollFrame(page.view(), 700 + offset, kLayout, cur.view());
+        const ScrollMatch m = matcher.Match(Hashes(prev.view()), cur.view(), 0, kLayout.scrollbar, hashes);
+        CHECK(m.found);
+        CHECK_EQ(m.offset, offset);
+        CHECK(m.top >= kLayout.header);
+        CHECK(m.bottom >= kLayout.footer);
+        CHECK(hashes == Hashes(cur.view()));
+    }
+
+    // 画面没动、滚动过头、行数不同：与先整帧哈希再匹配的结果相同
+    ztest::ComposeScrollFrame(page.view(), 700, kLayout, cur.view());
+    const ScrollMatch still = matcher.Match(Hashes(prev.view()), cur.view(), 0, kLayout.scrollbar, hashes);
+    CHECK(still.found);
+    CHECK_EQ(still.offset, 0);
+    CHECK(hashes == Hashes(cur.view()));
+    ztest::ComposeScrollFrame(page.view(), 700 + 420, kLayout, cur.view());
+    CHECK(!matcher.Match(Hashes(prev.view()), cur.view(), 0, kLayout.scrollbar, hashes).found);
+    Surface shorter(640, 300);
+    ztest::ComposeScrollFrame(page.view(), 700, kLayout, shorter.view());
+    CHECK(!matcher.Match(Hashes(prev.view()), shorter.view(), 0, kLayout.scrollbar, hashes).found);
+}
+
+TEST_CASE(TiledImageAppendsAndTruncatesAcrossTiles) {
+    Surface src(20, 100);
+    for (int y = 0; y < 100; y++) ztools::Fill(src.view(), ztools::IntRect(0, y, 20, 1), 0x00010000u * y + y);
+    TiledImage image(16);
+    image.Reset(20);
+    CHECK_EQ(image.AppendRows(src.view(), 10, 40), 40);
+    CHECK_EQ(image.height(), 40);
+    CHECK_EQ(image.tileCount(), 3);
+    CHECK_EQ(image.Tile(2).height, 8);
+    CHECK_EQ(image.Row(17)[5], src.view().At(5, 27));
+
+    image.TruncateRows(25);  // 跨两块边界
+    CHECK_EQ(image.height(), 15);
+    CHECK_EQ(image.tileCount(), 1);
+    CHECK_EQ(image.ByteSize(), static_cast<size_t>(2 * 16 * 20 * 4));  // 留一块备用
+    CHECK_EQ(image.AppendRows(src.view(), 90, 50), 10);                // 越界部分忽略
+    CHECK_EQ(image.height(), 25);
+    CHECK_EQ(image.Row(15)[0], src.view().At(0, 90));
+    CHECK_EQ(image.Row(14)[0], src.view().At(0, 24));
+
+    Surface flat(20, 30);
+    ztools::Fill(flat.view(), flat.view().Bounds(), 0xDEADBEEFu);
+    image.CopyTo(-2, flat.view());
+    CHECK_EQ(flat.view().At(0, 0), 0xDEADBEEFu);
+    CHECK_EQ(flat.view().At(0, 2), src.view().At(0, 10));
+    CHECK_EQ(flat.view().At(0, 26), src.view().At(0, 99));
+    CHECK_EQ(flat.view().At(0, 27), 0xDEADBEEFu);
+
+    Surface wrong(21, 5);
+    CHECK_EQ(image.AppendRows(wrong.view(), 0, 5), 0);
+    image.TruncateRows(1000);
+    CHECK_EQ(image.height(), 0);
+    CHECK(image.Tile(0).Empty());
+}
+
+TEST_CASE(StitcherRebuildsPageWithHeaderAndFooter) {
+    const int frameW = 500, frameH = 360;
+    const int viewH = frameH - kLayout.header - kLayout.footer;
+    Surface page(frameW, 5000);
+    ztest::FillDocumentLike(page.view(), 5);
+    Surface frame(frameW, frameH);
+
+    ztools::ScrollStitchOptions options;
+    options.ignoreRight = kLayout.scrollbar;
+    ScrollStitcher stitcher(options);
+    ScrollStitcher given(options);  // 每帧签名由调用方算好
+    ztest::ComposeScrollFrame(page.view(), 0, kLayout, frame.view());
+    CHECK(stitcher.Begin(frame.view()).status == StitchStatus::Started);
+    given.Begin(frame.view());
+
+    // 不规则的滚动距离，夹一次滚动过头（丢弃后从上一帧继续）与一次原地不动
+    const int steps[] = {90, 140, 17, 200, 600, 0, 133, 180, 64, 250};
+    int scrollY = 0, accepted = 0;
+    for (int step : steps) {
+        ztest::ComposeScrollFrame(page.view(), accepted + step, kLayout, frame.view());
+        const ztools::StitchStep r = stitcher.Append(frame.view());
+        CHECK(given.Append(frame.view(), Hashes(frame.view())).status == r.status);
+        if (step >= viewH) {
+            CHECK(r.status == StitchStatus::NoOverlap);
+            continue;
+        }
+        if (step == 0) {
+            CHECK(r.status == StitchStatus::Unchanged);
+            continue;
+        }
+        CHECK(r.status == StitchStatus::Appended);
+        CHECK_EQ(r.match.offset, step);
+        CHECK_EQ(r.added, step);
+        accepted += step;
+        scrollY = accepted;
+    }
+    CHECK_EQ(stitcher.stats().misses, 1);
+    CHECK_EQ(stitcher.stats().unchanged, 1);
+
+    // 结果 = 表头 + 页面 [0, scrollY + viewH) + 表尾（滚动条列不比较）
+    const TiledImage& image = stitcher.image();
+    CHECK_EQ(image.height(), kLayout.header + scrollY + viewH + kLayout.footer);
+    Surface first(frameW, frameH);
+    ztest::ComposeScrollFrame(page.view(), 0, kLayout, first.view());
+    const int contentW = frameW - kLayout.scrollbar;
+    bool same = true;
+    for (int y = 0; y < image.height(); y++) {
+        const std::uint32_t* expected;
+        if (y < kLayout.header) {
+            expected = first.view().Row(y);
+        } else if (y < kLayout.header + scrollY + viewH) {
+            expected = page.view().Row(y - kLayout.header);
+        } else {
+            expected = frame.view().Row(frameH - (image.height() - y));
+        }
+        same = same && SameRow(image.Row(y), expected, contentW);
+    }
+    CHECK(same);
+    const int givenH = given.image().height();
+    CHECK_EQ(givenH, image.height());
+    for (int y = 0; y < image.height() && givenH == image.height(); y++) {
+        same = same && SameRow(given.image().Row(y), image.Row(y), frameW);
+    }
+    CHECK(same);
+    CHECK(image.tileCount() > 1);
+    CHECK(image.ByteSize() <= static_cast<size_t>(image.tileCount() + 1) * image.tileRows() * frameW * 4);
+}
+
+TEST_CASE(StitcherStopsAtMaxHeightAndRejectsUnreadableFrames) {
+    Surface page(200, 3000);
+    ztest::FillDocumentLike(page.view(), 11);
+    Surface frame(200, 200);
+    ztools::ScrollStitchOptions options;
+    options.ignoreRight = kLayout.scrollbar;
+    options.maxHeight = 330;
+    ScrollStitcher stitcher(options);
+    ztest::ComposeScrollFrame(page.view(), 0, kLayout, frame.view());
+    stitcher.Begin(frame.view());
+    ztest::ComposeScrollFrame(page.view(), 80, kLayout, frame.view());
+    CHECK(stitcher.Append(frame.view()).status == StitchStatus::Appended);
+    ztest::ComposeScrollFrame(page.view(), 160, kLayout, frame.view());
+    const ztools::StitchStep r = stitcher.Append(frame.view());
+    CHECK(r.status == StitchStatus::Full);
+    CHECK_EQ(r.added, 50);
+    CHECK(stitcher.full());
+    CHECK_EQ(stitcher.image().height(), 330);
+    // 表尾仍在末尾
+    CHECK(SameRow(stitcher.image().Row(329), frame.view().Row(199), 200 - kLayout.scrollbar));
+    ztest::ComposeScrollFrame(page.view(), 200, kLayout, frame.view());
+    CHECK(stitcher.Append(frame.view()).status == StitchStatus::Full);
+    CHECK_EQ(stitcher.image().height(), 330);
+
+    // 整页空白：内容区不变而滚动条动了，是滚动了但看不出距离，不能当作已到底
+    Surface blank(200, 3000);
+    ztools::Fill(blank.view(), blank.view().Bounds(), ztest::kPageBackground);
+    ScrollStitcher blankStitcher(options);
+    ztest::ComposeScrollFrame(blank.view(), 0, kLayout, frame.view());
+    blankStitcher.Begin(frame.view());
+    ztest::ComposeScrollFrame(blank.view(), 300, kLayout, frame.view());
+    CHECK(blankStitcher.Append(frame.view()).status == StitchStatus::NoOverlap);
+    ztest::ComposeScrollFrame(blank.view(), 0, kLayout, frame.view());
+    CHECK(blankStitcher.Append(frame.view()).status == StitchStatus::Unchanged);
+    CHECK_EQ(blankStitcher.image().height(), 200);
+
+    // 帧尺寸变化：丢弃；空帧不开始
+    Surface other(200, 199);
+    ScrollStitcher fresh(options);
+    CHECK(fresh.Begin(ImageView()).status == StitchStatus::NoOverlap);
+    CHECK(!fresh.started());
+    fresh.Begin(frame.view());
+    CHECK(fresh.Append(other.view()).status == StitchStatus::NoOverlap);
+}
+
+TEST_CASE(PacerAimsForHalfAFramePerStep) {
+    ztools::ScrollPacer pacer(600, 8);
+    CHECK_EQ(pacer.ticks(), 1);
+    ztools::StitchStep step;
+    step.status = StitchStatus::Appended;
+    step.match.offset = 100;  // 1 格 = 100px，半帧 300px -> 3 格
+    pacer.OnStep(step, 1);
+    CHECK_EQ(pacer.ticks(), 3);
+    step.match.offset = 300;
+    pacer.OnStep(step, 3);
+    CHECK_EQ(pacer.ticks(), 3);
+
+    // 滚动过头：减半；原地不动不改变步长
+    step.status = StitchStatus::NoOverlap;
+    pacer.OnStep(step, 3);
+    CHECK_EQ(pacer.ticks(), 1);
+    step.status = StitchStatus::Unchanged;
+    pacer.OnStep(step, 1);
+    CHECK_EQ(pacer.ticks(), 1);
+
+    // 每格像素很少时不超过上限
+    step.status = StitchStatus::Appended;
+    step.match.offset = 2;
+    for (int i = 0; i < 8; i++) pacer.OnStep(step, 1);
+    CHECK_EQ(pacer.ticks(), 8);
+}
+
+TEST_MAIN()
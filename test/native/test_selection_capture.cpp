@@ -0,0 +1,133 @@
+// 选中内容捕获时序测试：假剪贴板 + 模拟不同响应速度的目标应用
+#include "core/selection_capture.h"
+#include "fake_clipboard.h"
+#include "test_harness.h"
+
+#include <vector>
+
+using namespace std::chrono;
+using ztest::FakeClipboard;
+using ztools::SelectionCaptureOptions;
+using ztools::SelectionCaptureStatus;
+
+namespace {
+
+const std::uint32_t kText = 13;  // CF_UNICODETEXT
+const std::uint32_t kHtml = 49300;
+
+// 假按键注入：收到 Ctrl+C 后按给定延迟向剪贴板写入（延迟为空表示应用没有可复制的选中内容）
+struct SlowApp : ztools::CopyKeyInjector {
+    FakeClipboard& clipboard;
+    std::vector<milliseconds> writeDelays;
+    bool fail = false;
+    int copies = 0;
+
+    SlowApp(FakeClipboard& cb, std::vector<milliseconds> delays) : clipboard(cb), writeDelays(std::move(delays)) {}
+
+    bool SendCopy() override {
+        if (fail) return false;
+        ++copies;
+        auto base = clipboard.now;
+        for (size_t i = 0; i < writeDelays.size(); i++) {
+            clipboard.WriteAt(base + writeDelays[i], i == 0 ? kText : kHtml + (std::uint32_t)i,
+                              FakeClipboard::Text("selected"), i == 0);
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
+TEST_CASE(FastAppResolvesRightAfterSettle) {
+    FakeClipboard cb;
+    SlowApp app(cb, {milliseconds(3)});
+    SelectionCaptureOptions opts;
+    opts.settle = milliseconds(8);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Changed);
+    CHECK_EQ(app.copies, 1);
+    CHECK_EQ(out.changeCount, 1);
+    CHECK(out.firstChangeLatency == ztools::ClipboardChangeSource::Duration(milliseconds(3)));
+    CHECK(out.totalLatency == ztools::ClipboardChangeSource::Duration(milliseconds(11)));
+    CHECK(out.sequenceAfter != out.sequenceBefore);
+    CHECK(cb.Has(kText));
+}
+
+TEST_CASE(SlowAppIsAwaitedUpToTimeout) {
+    FakeClipboard cb;
+    SlowApp app(cb, {milliseconds(240)});
+    SelectionCaptureOptions opts;
+    opts.timeout = milliseconds(300);
+    opts.settle = milliseconds(0);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Changed);
+    CHECK(out.totalLatency == ztools::ClipboardChangeSource::Duration(milliseconds(240)));
+}
+
+TEST_CASE(MultiBatchWritesAreCoalesced) {
+    // Edge 地址栏复制：三次分开写入，间隔小于静默期
+    FakeClipboard cb;
+    SlowApp app(cb, {milliseconds(5), milliseconds(9), milliseconds(14)});
+    SelectionCaptureOptions opts;
+    opts.settle = milliseconds(8);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Changed);
+    CHECK_EQ(out.changeCount, 3);
+    CHECK_EQ(out.sequenceAfter, out.sequenceBefore + 3);
+    CHECK(out.totalLatency == ztools::ClipboardChangeSource::Duration(milliseconds(22)));
+    CHECK_EQ(cb.formats.size(), (size_t)3);
+}
+
+TEST_CASE(NothingSelectedTimesOut) {
+    FakeClipboard cb;
+    SlowApp app(cb, {});
+    SelectionCaptureOptions opts;
+    opts.timeout = milliseconds(150);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Timeout);
+    CHECK_EQ(out.changeCount, 0);
+    CHECK_EQ(out.sequenceAfter, out.sequenceBefore);
+    CHECK(out.totalLatency == ztools::ClipboardChangeSource::Duration(milliseconds(150)));
+}
+
+TEST_CASE(WriteAfterTimeoutIsIgnored) {
+    FakeClipboard cb;
+    SlowApp app(cb, {milliseconds(400)});
+    SelectionCaptureOptions opts;
+    opts.timeout = milliseconds(300);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Timeout);
+    CHECK(out.totalLatency == ztools::ClipboardChangeSource::Duration(milliseconds(300)));
+}
+
+TEST_CASE(SettleIsBoundedByHardDeadline) {
+    // 应用持续不断地写剪贴板：最多等到 timeout + settle
+    FakeClipboard cb;
+    std::vector<milliseconds> delays;
+    for (int i = 1; i <= 100; i++) delays.push_back(milliseconds(i * 5));
+    SlowApp app(cb, delays);
+    SelectionCaptureOptions opts;
+    opts.timeout = milliseconds(100);
+    opts.settle = milliseconds(10);
+
+    auto out = ztools::WaitForCopiedSelection(cb, app, opts);
+    CHECK(out.status == SelectionCaptureStatus::Changed);
+    CHECK(out.totalLatency <= ztools::ClipboardChangeSource::Duration(milliseconds(110)));
+}
+
+TEST_CASE(InjectFailureReturnsImmediately) {
+    FakeClipboard cb;
+    SlowApp app(cb, {milliseconds(1)});
+    app.fail = true;
+
+    auto out = ztools::WaitForCopiedSelection(cb, app);
+    CHECK(out.status == SelectionCaptureStatus::InjectFailed);
+    CHECK_EQ(cb.waitCalls, 0);
+}
+
+TEST_MAIN()
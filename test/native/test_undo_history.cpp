@@ -0,0 +1,235 @@
+// 结构共享撤销历史测试：撤销 / 重做正确性、每步只新建改动节点、内存与步数上限
+#include "core/undo_history.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 模拟标注：自由路径点 + 文字 + 不参与比较的缓存字段
+struct Item {
+    int id = 0;
+    std::vector<int> pts;
+    std::string text;
+    int cache = 0;
+};
+
+struct ItemEq {
+    bool operator()(const Item& a, const Item& b) const { return a.id == b.id && a.pts == b.pts && a.text == b.text; }
+};
+
+struct ItemSize {
+    size_t operator()(const Item& a) const { return a.pts.size() * sizeof(int) + a.text.size(); }
+};
+
+using History = ztools::SharedUndoHistory<Item, ItemEq, ItemSize>;
+
+Item Stroke(int id, int points) {
+    Item item;
+    item.id = id;
+    item.pts.assign(points, id);
+    return item;
+}
+
+bool Same(const std::vector<Item>& a, const std::vector<Item>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (!ItemEq()(a[i], b[i])) return false;
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(UndoRedoRestoresEachStep) {
+    History history;
+    std::vector<Item> items;
+    history.Reset(items);
+    std::vector<std::vector<Item>> states = {items};
+
+    history.Checkpoint(items);
+    items.push_back(Stroke(1, 10));
+    states.push_back(items);
+    history.Checkpoint(items);
+    items.push_back(Stroke(2, 10));
+    states.push_back(items);
+    history.Checkpoint(items);
+    items[0].text = "edited";  // 原地修改
+    states.push_back(items);
+    history.Checkpoint(items);
+    items.erase(items.begin());  // 删除
+    states.push_back(items);
+
+    for (int i = 3; i >= 0; i--) {
+        CHECK(history.Undo(items));
+        CHECK(Same(items, states[i]));
+    }
+    CHECK(!history.Undo(items));
+    for (int i = 1; i <= 4; i++) {
+        CHECK(history.Redo(items));
+        CHECK(Same(items, states[i]));
+    }
+    CHECK(!history.Redo(items));
+}
+
+TEST_CASE(EachStepOnlyCreatesChangedNodes) {
+    History history;
+    std::vector<Item> items;
+    history.Reset(items);
+    for (int i = 0; i < 100; i++) {
+        history.Checkpoint(items);
+        items.push_back(Stroke(i, 1000));
+    }
+    // 第 k 次 Checkpoint 只为上一步新增的那一笔建节点：总计 99 个，而不是 0+1+...+99
+    CHECK_EQ(history.NodesCreated(), 99u);
+    size_t before = history.NodesCreated();
+    history.Checkpoint(items);
+    items[50].pts[0] = -1;
+    history.Checkpoint(items);
+    CHECK_EQ(history.NodesCreated() - before, 2u);  // 第 100 笔 + 被改的第 50 笔
+    // 100 笔各约 4KB：共享后总占用与一份列表同级，远小于 100 个完整快照
+    CHECK(history.Bytes() < 110u * 4096);
+}
+
+TEST_CASE(UndoKeepsUntouchedElementsInPlace) {
+    History history;
+    std::vector<Item> items = {Stroke(1, 4), Stroke(2, 4), Stroke(3, 4)};
+    history.Reset(items);
+    items[0].cache = 7;
+    items[2].cache = 9;
+    history.Checkpoint(items);
+    items[1].text = "x";
+    CHECK(history.Undo(items));
+    CHECK(items[1].text.empty());
+    // 未改动的元素原样保留（缓存字段不被快照覆盖）
+    CHECK_EQ(items[0].cache, 7);
+    CHECK_EQ(items[2].cache, 9);
+}
+
+TEST_CASE(MiddleInsertAndEraseAlign) {
+    History history;
+    std::vector<Item> items = {Stroke(1, 2), Stroke(2, 2), Stroke(3, 2), Stroke(4, 2)};
+    history.Reset(items);
+    std::vector<Item> original = items;
+    history.Checkpoint(items);
+    items.erase(items.begin() + 1, items.begin() + 3);
+    items.insert(items.begin() + 1, Stroke(9, 2));
+    std::vector<Item> edited = items;
+    CHECK(history.Undo(items));
+    CHECK(Same(items, original));
+    CHECK(history.Redo(items));
+    CHECK(Same(items, edited));
+}
+
+TEST_CASE(CheckpointClearsRedo) {
+    History history;
+    std::vector<Item> items;
+    history.Reset(items);
+    history.Checkpoint(items);
+    items.push_back(Stroke(1, 1));
+    CHECK(history.Undo(items));
+    CHECK(history.CanRedo());
+    history.Checkpoint(items);
+    items.push_back(Stroke(2, 1));
+    CHECK(!history.CanRedo());
+}
+
+TEST_CASE(LimitsDropOldestSteps) {
+    ztools::UndoHistoryLimits limits;
+    limits.maxSteps = 5;
+    History history(limits);
+    std::vector<Item> items;
+    history.Reset(items);
+    for (int i = 0; i < 20; i++) {
+        history.Checkpoint(items);
+        items.push_back(Stroke(i, 1));
+    }
+    CHECK_EQ(history.UndoDepth(), 5u);
+
+    // 内存上限：每笔 40KB，上限 200KB → 旧撤销点被丢弃，节点随之释放
+    limits.maxSteps = 1000;
+    limits.maxBytes = 200 * 1024;
+    History capped(limits);
+    std::vector<Item> big;
+    capped.Reset(big);
+    for (int i = 0; i < 30; i++) {
+        capped.Checkpoint(big);
+        big.push_back(Stroke(i, 10000));
+        big.erase(big.begin(), big.end() - 1);  // 只保留最新一笔，旧笔画只被历史引用
+    }
+    CHECK(capped.UndoDepth() < 30u);
+    CHECK(capped.UndoDepth() >= 1u);
+    CHECK(capped.Bytes() <= 200u * 1024 + 50000);
+    CHECK(capped.Undo(big));
+}
+
+namespace {
+
+// 带修订号的标注：编辑代码每次改动都换新修订号，Eq 统计内容比较次数
+struct RevItem {
+    uint64_t rev = 0;
+    std::vector<int> pts;
+};
+
+size_t g_contentCompares = 0;
+
+struct RevItemEq {
+    bool operator()(const RevItem& a, const RevItem& b) const {
+        ++g_contentCompares;
+        return a.pts == b.pts;
+    }
+};
+
+struct RevItemSize {
+    size_t operator()(const RevItem& a) const { return a.pts.size() * sizeof(int); }
+};
+
+struct RevItemRevision {
+    uint64_t operator()(const RevItem& a) const { return a.rev; }
+};
+
+using RevHistory = ztools::SharedUndoHistory<RevItem, RevItemEq, RevItemSize, RevItemRevision>;
+
+}  // namespace
+
+TEST_CASE(RevisionLimitsContentComparesToChangedElements) {
+    RevHistory history;
+    std::vector<RevItem> items(3000);
+    uint64_t nextRev = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        items[i].rev = ++nextRev;
+        items[i].pts.assign(2000, (int)i);
+    }
+    history.Reset(items);
+
+    history.Checkpoint(items);
+    items[1234].pts[7] = -1;
+    items[1234].rev = ++nextRev;
+    g_contentCompares = 0;
+    history.Checkpoint(items);
+    // 只有被改的那一笔修订号不同，需要比较内容
+    size_t compares = g_contentCompares;
+    CHECK_EQ(compares, 1u);
+
+    // 追加一笔后撤销：前缀全部按修订号对齐，不做内容比较
+    RevItem extra;
+    extra.rev = ++nextRev;
+    extra.pts.assign(2000, -2);
+    items.push_back(extra);
+    g_contentCompares = 0;
+    CHECK(history.Undo(items));
+    compares = g_contentCompares;
+    CHECK_EQ(compares, 0u);
+    CHECK_EQ(items.size(), 3000u);
+    CHECK_EQ(items[1234].pts[7], -1);
+
+    CHECK(history.Undo(items));
+    CHECK_EQ(items[1234].pts[7], 1234);
+    CHECK(history.Redo(items));
+    CHECK_EQ(items[1234].pts[7], -1);
+    CHECK(history.Redo(items));
+    CHECK_EQ(items.size(), 3001u);
+}
+
+TEST_MAIN()
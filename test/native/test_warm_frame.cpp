@@ -0,0 +1,202 @@
+// 预截屏保温策略测试（假时钟 + 假抓帧驱动）：有效期、速率上限、CPU 预算、会话暂停、失败退避、帧年龄统计
+#include "core/warm_frame.h"
+#include "test_harness.h"
+
+#include <random>
+
+using namespace std::chrono;
+using ztools::WarmFrameConfig;
+using ztools::WarmFramePolicy;
+
+namespace {
+
+struct FakeClock {
+    WarmFramePolicy::TimePoint now{};
+    void Advance(WarmFramePolicy::Duration d) { now += d; }
+};
+
+// 假抓帧：每次耗时 cost，可模拟失败
+struct FakeCaptureSource {
+    WarmFramePolicy::Duration cost = milliseconds(5);
+    int failNext = 0;
+    int calls = 0;
+
+    bool Capture(FakeClock& clock) {
+        calls++;
+        clock.Advance(cost);
+        if (failNext > 0) {
+            failNext--;
+            return false;
+        }
+        return true;
+    }
+};
+
+// 一次抓帧（保温刷新或显式预抓取），返回策略是否保留这一帧
+bool CaptureOnce(WarmFramePolicy& policy, FakeClock& clock, FakeCaptureSource& source) {
+    auto start = clock.now;
+    bool ok = source.Capture(clock);
+    return policy.OnCaptured(start, clock.now, ok);
+}
+
+// 模拟保温线程运行到 until：到期就抓帧，否则睡到下一次刷新（或 until）
+void RunWarmThread(WarmFramePolicy& policy, FakeClock& clock, FakeCaptureSource& source,
+                   WarmFramePolicy::TimePoint until) {
+    while (clock.now < until) {
+        auto wait = policy.TimeUntilRefresh(clock.now);
+        if (!wait) {
+            clock.now = until;
+        } else if (*wait > WarmFramePolicy::Duration::zero()) {
+            clock.now = (std::min)(until, clock.now + *wait);
+        } else {
+            CaptureOnce(policy, clock, source);
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE(ColdModeOnlyUsesExplicitPrimes) {
+    WarmFramePolicy policy;
+    FakeClock clock;
+    FakeCaptureSource source;
+    CHECK(!policy.NextRefresh().has_value());
+    CHECK(!policy.Consume(clock.now));  // 没有帧
+    CHECK(CaptureOnce(policy, clock, source));
+    clock.Advance(milliseconds(100));
+    CHECK(policy.Consume(clock.now));
+    CHECK(!policy.HasFrame());  // 用过即取走
+    CHECK(!policy.Consume(clock.now));
+    CHECK_EQ(policy.stats().hits, 1);
+    CHECK_EQ(policy.stats().empty, 2);
+    CHECK(policy.stats().lastAge == WarmFramePolicy::Duration(milliseconds(105)));
+}
+
+TEST_CASE(FramesExpireAfterConfiguredTtl) {
+    WarmFramePolicy policy;
+    WarmFrameConfig config;
+    config.ttl = milliseconds(200);
+    policy.Configure(config);
+    FakeClock clock;
+    FakeCaptureSource source;
+    CaptureOnce(policy, clock, source);
+    clock.Advance(milliseconds(300));
+    CHECK(policy.FrameAge(clock.now) == WarmFramePolicy::Duration(milliseconds(305)));
+    CHECK(!policy.Consume(clock.now));
+    CHECK_EQ(policy.stats().stale, 1);
+    CHECK(policy.stats().maxAge == WarmFramePolicy::Duration(milliseconds(305)));
+}
+
+TEST_CASE(InvalidConfigValuesAreIgnored) {
+    WarmFramePolicy policy;
+    WarmFrameConfig bad;
+    bad.ttl = milliseconds(0);
+    bad.minInterval = milliseconds(-5);
+    bad.cpuBudget = 1.5;
+    policy.Configure(bad);
+    WarmFrameConfig defaults;
+    CHECK(policy.config().ttl == defaults.ttl);
+    CHECK(policy.config().minInterval == defaults.minInterval);
+    CHECK(policy.config().cpuBudget == defaults.cpuBudget);
+}
+
+TEST_CASE(WarmRefreshIsRateLimited) {
+    WarmFramePolicy policy;  // 250ms 间隔，5% 预算；5ms 的抓帧受间隔限制
+    FakeClock clock;
+    FakeCaptureSource source;
+    policy.SetWarm(true, clock.now);
+    CHECK(policy.TimeUntilRefresh(clock.now) == WarmFramePolicy::Duration::zero());
+    RunWarmThread(policy, clock, source, clock.now + seconds(10));
+    CHECK(source.calls >= 40 && source.calls <= 41);
+    CHECK(policy.HasFrame());
+    CHECK(policy.FrameAge(clock.now) <= WarmFramePolicy::Duration(milliseconds(250)));
+}
+
+TEST_CASE(SlowCapturesStayWithinCpuBudget) {
+    WarmFramePolicy policy;
+    WarmFrameConfig config;
+    config.cpuBudget = 0.10;
+    config.ttl = seconds(1);  // 有效期足够长，节奏只受预算限制
+    policy.Configure(config);
+    FakeClock clock;
+    FakeCaptureSource source;
+    source.cost = milliseconds(60);  // 预算要求每次间隔 >= 600ms
+    auto begin = clock.now;
+    policy.SetWarm(true, clock.now);
+    RunWarmThread(policy, clock, source, clock.now + seconds(12));
+    double fraction = duration<double>(policy.stats().busy).count() / duration<double>(clock.now - begin).count();
+    CHECK(fraction <= 0.10 + 1e-9);
+    CHECK(source.calls >= 19 && source.calls <= 21);
+}
+
+TEST_CASE(WarmFrameIsAlwaysFreshAcrossSessions) {
+    WarmFramePolicy policy;
+    FakeClock clock;
+    FakeCaptureSource source;
+    policy.SetWarm(true, clock.now);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> idle(300, 5000), session(500, 8000);
+    for (int i = 0; i < 50; i++) {
+        RunWarmThread(policy, clock, source, clock.now + milliseconds(idle(rng)));
+        policy.Suspend();
+        CHECK(!policy.NextRefresh().has_value());
+        CHECK(policy.Consume(clock.now));
+        clock.Advance(milliseconds(session(rng)));
+        policy.Resume(clock.now);
+        CHECK(policy.TimeUntilRefresh(clock.now) == WarmFramePolicy::Duration::zero());
+    }
+    CHECK_EQ(policy.stats().hits, 50);
+    CHECK(policy.stats().maxAge <= WarmFramePolicy::Duration(milliseconds(255)));
+    CHECK(policy.stats().AverageAge() > WarmFramePolicy::Duration::zero());
+}
+
+TEST_CASE(SlowCapturesStillKeepTheFrameFresh) {
+    WarmFramePolicy policy;  // 默认 500ms 有效期、5% 预算：40ms 的抓帧按预算要隔 800ms
+    FakeClock clock;
+    FakeCaptureSource source;
+    source.cost = milliseconds(40);
+    policy.SetWarm(true, clock.now);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> idle(600, 3000);
+    for (int i = 0; i < 30; i++) {
+        RunWarmThread(policy, clock, source, clock.now + milliseconds(idle(rng)));
+        policy.Suspend();
+        CHECK(policy.Consume(clock.now));
+        policy.Resume(clock.now);
+    }
+    CHECK_EQ(policy.stats().hits, 30);
+    CHECK_EQ(policy.stats().stale, 0);
+    CHECK(policy.stats().maxAge <= WarmFramePolicy::Duration(milliseconds(500)));
+}
+
+TEST_CASE(CaptureFinishingDuringSessionIsDropped) {
+    WarmFramePolicy policy;
+    FakeClock clock;
+    policy.SetWarm(true, clock.now);
+    auto start = clock.now;
+    policy.Suspend();  // 刷新进行中截图开始：这一帧可能含覆盖层
+    clock.Advance(milliseconds(30));
+    CHECK(!policy.OnCaptured(start, clock.now, true));
+    CHECK(!policy.HasFrame());
+    CHECK_EQ(policy.stats().dropped, 1);
+    policy.Resume(clock.now);
+    // 恢复后仍受节奏限制：30ms / 5% = 600ms 超过有效期，收紧到 500 - 30 = 上一次开始 + 470ms
+    CHECK(policy.TimeUntilRefresh(clock.now) == WarmFramePolicy::Duration(milliseconds(440)));
+}
+
+TEST_CASE(FailuresKeepTheCadenceAndFrame) {
+    WarmFramePolicy policy;
+    FakeClock clock;
+    FakeCaptureSource source;
+    policy.SetWarm(true, clock.now);
+    CHECK(CaptureOnce(policy, clock, source));
+    source.failNext = 3;
+    RunWarmThread(policy, clock, source, clock.now + milliseconds(800));
+    CHECK_EQ(policy.stats().failures, 3);
+    CHECK_EQ(source.calls, 4);
+    CHECK(policy.HasFrame());  // 失败不影响手上的旧帧，由 ttl 决定能否使用
+    policy.SetWarm(false, clock.now);
+    CHECK(!policy.NextRefresh().has_value());
+}
+
+TEST_MAIN()
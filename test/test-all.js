@@ -48,10 +48,14 @@ console.log('  提示: 复制一些文本测试');
 console.log('');
 
 const clipboardMonitor = new ClipboardMonitor();
-clipboardMonitor.start(() => {
+clipboardMonitor.start((info) => {
   clipboardEvents++;
   const time = new Date().toLocaleTimeString();
   console.log(`  [${time}] 剪贴板变化 #${clipboardEvents}`);
+  if (info) {
+    console.log(`     格式: ${info.formats.join(', ')}`);
+    console.log(`     文本 ${info.textBytes} 字节, 图像 ${info.imageWidth}x${info.imageHeight}, 文件 ${info.fileCount} 个, hash ${info.hash}`);
+  }
 });
 
 // 倒计时显示
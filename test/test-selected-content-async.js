@@ -0,0 +1,23 @@
+const { getSelectedContent, getSelectedContentAsync } = require('../index.js');
+
+console.log('=== 测试异步获取选中内容（对比同步版耗时）===\n');
+console.log('请在任意应用中选中一些内容（文本/文件/图像）...');
+console.log('将在 3 秒后分别用同步版和异步版获取\n');
+
+setTimeout(async () => {
+  let start = Date.now();
+  const syncContents = getSelectedContent();
+  console.log(`同步版: ${syncContents.length} 项, 耗时 ${Date.now() - start}ms`);
+
+  start = Date.now();
+  let ticks = 0;
+  const ticker = setInterval(() => ticks++, 1);
+  const asyncContents = await getSelectedContentAsync({ timeout: 500 });
+  clearInterval(ticker);
+  console.log(`异步版: ${asyncContents.length} 项, 耗时 ${Date.now() - start}ms（期间 JS 线程跑了 ${ticks} 次定时器）`);
+
+  asyncContents.forEach((item, index) => {
+    const preview = item.type === 'file' ? item.data.join(', ') : String(item.data).substring(0, 60);
+    console.log(`  [${index + 1}] ${item.type}: ${preview}`);
+  });
+}, 3000);